@@ -1,4 +1,5 @@
 # First argument is the build directory
 # Second argument (optional) the size of the inputs for the benchmarks
+# Third argument (optional) more cmake options, f.ex. -DCLUSTER_SIM=1
 
-cd $1 && cmake .. -DCMAKE_TOOLCHAIN_FILE=toolchain-llvm -DLMQ_SIZE=$2 && cmake --build . -j
\ No newline at end of file
+cd $1 && cmake .. -DCMAKE_TOOLCHAIN_FILE=toolchain-llvm -DLMQ_SIZE=$2 $3 && cmake --build . -j
\ No newline at end of file
@@ -0,0 +1,70 @@
+import os
+import sys
+import json
+from statistics import median
+
+import matplotlib.pyplot as plt
+import seaborn as sns
+
+from plotloader import arg_parse, arg_filter
+
+'''
+Accuracy against speed: the max relative error (report_accuracy, plots/data/accuracy) of every approximating
+kernel over its cycles (plots/data/*_runtime.json) at the largest size with both, f.ex. sin_ssr_frep against
+sin_ssr_frep_fast or the lookup tables against the FP only kernels.
+'''
+
+relpath = "data/"
+fullpath = os.path.dirname(__file__) + "/" + relpath
+
+if ".git" not in os.listdir(os.getcwd()):
+    print("please run this script from the project root")
+    sys.exit()
+
+include, exclude, savepath, _, _, _ = arg_parse()
+
+# function -> {size: cycles}
+runtimes = {}
+for filename in os.listdir(fullpath):
+    if filename.endswith("_runtime.json"):
+        data = json.load(open(fullpath + filename, "r"))
+        for name, cycles in data.items():
+            if name != "n":
+                runtimes[name] = {n: median(c) if isinstance(c, list) else c for n, c in zip(data["n"], cycles)}
+
+# function -> {size: accuracy}
+accuracy = {}
+accuracypath = fullpath + "accuracy/"
+if os.path.isdir(accuracypath):
+    for filename in os.listdir(accuracypath):
+        if filename.endswith(".json"):
+            for name, sizes in json.load(open(accuracypath + filename, "r")).items():
+                accuracy[name] = {int(n): a for n, a in sizes.items()}
+
+print("{:30} {:>8} {:>10} {:>8} {:>12} {:>10}".format("kernel", "n", "cycles", "max ulp", "max rel", "mismatches"))
+points = []
+for name in arg_filter(sorted(accuracy.keys()), include, exclude):
+    sizes = [n for n in accuracy[name] if n in runtimes.get(name, {})]
+    if not sizes:
+        print("[    ACCURACY]     no runtime for {}".format(name))
+        continue
+    n = max(sizes)
+    a = accuracy[name][n]
+    points.append((name, runtimes[name][n], max(a["max_rel"], 1e-17)))
+    print("{:30} {:>8} {:>10} {:>8.0f} {:>12.3e} {:>10}".format(name, n, runtimes[name][n], a["max_ulp"], a["max_rel"], a["mismatches"]))
+
+sns.set_style("dark")
+fig, ax = plt.subplots()
+ax.set_xscale('log', base=2)
+ax.set_yscale('log', base=10)
+for name, cycles, err in points:
+    ax.scatter(cycles, err, zorder=3)
+    ax.annotate(name, (cycles, err), fontsize=6, xytext=(2, 2), textcoords="offset points")
+
+ax.set(xlabel='runtime [cycles]', ylabel='max relative error')
+ax.set(title=(include[0] + ' Accuracy Plot' if include else 'Accuracy Plot'))
+
+if savepath:
+    plt.savefig(os.path.join(os.getcwd(), savepath), pad_inches=0.1,  bbox_inches='tight', dpi=300)
+else:
+    plt.show()
@@ -0,0 +1,136 @@
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+from statistics import median
+
+from roofline_model import split_name
+
+'''
+Correlation of banshee with the cycle accurate snitch_cluster.vlt: runs the same benchmarks with plots/scraper.py
+on both (banshee builds into build_banshee_<size>, the vlt builds with -DCLUSTER_SIM=1 into build_rtl_<size>)
+and prints for every function and size the cycles of both and their ratio. For every op the speedups of the
+variants over its baseline are compared, an optimisation banshee reports but the RTL does not is flagged.
+All arguments it does not know (-include, -exclude, -jobs, ...) are passed on to the scraper, f.ex.
+    python3 plots/correlate.py -include gemm dot -sizes 256 1024
+The RTL simulation is slow, so keep the -include list and the sizes small.
+'''
+
+if ".git" not in os.listdir(os.getcwd()):
+    print("please run this script from the project root")
+    sys.exit()
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-sizes", type=int, nargs="*", dest="sizes", default=[256],
+                    help="LMQ_SIZE of the builds, default 256")
+parser.add_argument("-local", action="store_true", dest="local",
+                    help="Build locally instead of in the docker container")
+parser.add_argument("-tolerance", type=float, dest="tolerance", default=0.1,
+                    help="Allowed difference of the speedups on both backends as a fraction, default 0.1")
+parser.add_argument("-output", type=str, dest="output", default="plots/data/correlate/",
+                    help="Directory of the runtimes of both backends and the report, default plots/data/correlate/")
+parser.add_argument("-no-run", action="store_true", dest="no_run",
+                    help="Only compare the runtimes already in the output directory")
+args, scraper_args = parser.parse_known_args()
+
+prefix = "" if args.local else "d"
+backends = {
+    "banshee": (prefix + "build_dir_size {dir} {size}", "run", "build_banshee_"),
+    "rtl": (prefix + "build_sim_dir_size {dir} {size}", "run_sim", "build_rtl_"),
+}
+
+if not args.no_run:
+    scraper = os.path.join(os.path.dirname(__file__), "scraper.py")
+    for backend, (builder, runner, build_prefix) in backends.items():
+        command = [sys.executable, scraper, "-sizes"] + [str(s) for s in args.sizes] + [
+            "-builder", builder, "-runner", runner, "-build-prefix", build_prefix,
+            "-output", os.path.join(args.output, backend)] + scraper_args
+        if subprocess.run(command).returncode != 0:
+            print("[ERROR]  the scraper failed for {}".format(backend))
+            sys.exit(1)
+
+
+def load_runtimes(directory):
+    ''' {(function, size): median cycles} of all *_runtime.json files of the scraper in directory. '''
+    runtimes = {}
+    if not os.path.isdir(directory):
+        return runtimes
+    for filename in sorted(os.listdir(directory)):
+        if not filename.endswith("_runtime.json"):
+            continue
+        data = json.load(open(os.path.join(directory, filename), "r"))
+        for name, cycles in data.items():
+            if name == "n":
+                continue
+            for n, c in zip(data["n"], cycles):
+                c = median(c) if isinstance(c, list) else c
+                if c > 0:
+                    runtimes[(name, n)] = c
+    return runtimes
+
+
+def spearman(xs, ys):
+    ''' Rank correlation of xs and ys (no ties handling, the cycles rarely tie). '''
+    if len(xs) < 2:
+        return float("nan")
+    rank = lambda v: {i: r for r, i in enumerate(sorted(range(len(v)), key=lambda i: v[i]))}
+    rx, ry = rank(xs), rank(ys)
+    d = sum((rx[i] - ry[i]) ** 2 for i in range(len(xs)))
+    return 1 - 6 * d / (len(xs) * (len(xs) ** 2 - 1))
+
+
+banshee = load_runtimes(os.path.join(args.output, "banshee"))
+rtl = load_runtimes(os.path.join(args.output, "rtl"))
+common = sorted(set(banshee.keys()) & set(rtl.keys()))
+
+print("{:45} {:>8} {:>12} {:>12} {:>9}".format("function", "n", "banshee", "rtl", "rtl/bsh"))
+for name, n in common:
+    print("{:45} {:>8} {:>12} {:>12} {:>8.3f}x".format(name, n, banshee[(name, n)], rtl[(name, n)],
+                                                         rtl[(name, n)] / banshee[(name, n)]))
+
+# speedup of every variant over the baseline of its op, the decision an optimisation is based on
+speedups = []
+for name, n in common:
+    op, variant = split_name(name)
+    base = (op + "_baseline", n)
+    if variant in ("", "baseline") or base not in banshee or base not in rtl:
+        continue
+    s_banshee = banshee[base] / banshee[(name, n)]
+    s_rtl = rtl[base] / rtl[(name, n)]
+    flag = ""
+    if s_banshee > 1 >= s_rtl:
+        flag = "  NOT REAL"
+    elif abs(s_rtl - s_banshee) > args.tolerance * s_banshee:
+        flag = "  DIFFERS"
+    speedups.append({"function": name, "n": n, "banshee": s_banshee, "rtl": s_rtl, "flag": flag.strip()})
+
+print()
+print("{:45} {:>8} {:>12} {:>12}".format("speedup over baseline", "n", "banshee", "rtl"))
+for s in sorted(speedups, key=lambda s: s["rtl"] / s["banshee"]):
+    print("{:45} {:>8} {:>11.3f}x {:>11.3f}x{}".format(s["function"], s["n"], s["banshee"], s["rtl"],
+                                                      "  " + s["flag"] if s["flag"] else ""))
+
+ratios = [rtl[k] / banshee[k] for k in common]
+log_b = [math.log(banshee[k]) for k in common]
+log_r = [math.log(rtl[k]) for k in common]
+for name in sorted(set(k[0] for k in banshee.keys()) ^ set(k[0] for k in rtl.keys())):
+    print("[WARNING]    {} was only measured on one backend".format(name))
+
+result = {
+    "measurements": len(common),
+    "median_ratio": median(ratios) if ratios else float("nan"),
+    "min_ratio": min(ratios) if ratios else float("nan"),
+    "max_ratio": max(ratios) if ratios else float("nan"),
+    "rank_correlation": spearman(log_b, log_r),
+    "flagged": [s for s in speedups if s["flag"]],
+    "cycles": [{"function": name, "n": n, "banshee": banshee[(name, n)], "rtl": rtl[(name, n)]} for name, n in common],
+    "speedups": speedups,
+}
+os.makedirs(args.output, exist_ok=True)
+json.dump(result, open(os.path.join(args.output, "report.json"), "w"), indent=4)
+
+print("[RESULT]     {} measurements, rtl/banshee median {:.3f} (min {:.3f}, max {:.3f}), rank correlation {:.3f}, "
+      "{} speedups flagged".format(result["measurements"], result["median_ratio"], result["min_ratio"],
+                                  result["max_ratio"], result["rank_correlation"], len(result["flagged"])))
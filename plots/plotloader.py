@@ -165,7 +165,7 @@ def load_plot_dataframe(abspath, include=[], exclude=[], group=True):
     print("[    DATA LOADER]     loaded data for the plots {}".format(func_names))
     return func_names, data
 
-def arg_parse():
+def arg_parser():
     # add argparse to specify function names that should either be included or excluded
     parser = argparse.ArgumentParser()
     parser.add_argument("-include", type=str, nargs="*", dest="include",
@@ -192,7 +192,10 @@ def arg_parse():
                         dest="runner",
                         default="run",
                         help="Which run commant to use (run, sim)")
-    args = parser.parse_args()
+    return parser
+
+def arg_parse():
+    args = arg_parser().parse_args()
 
     return (args.include, args.exclude, args.save, args.builder, args.runner, not args.no_group)
 
@@ -0,0 +1,80 @@
+import argparse
+import json
+import os
+import subprocess
+import sys
+from statistics import median
+
+'''
+Regression gate: re-runs benchmarks with plots/scraper.py into plots/data/regress/ and compares the cycles of
+every function and size with the stored runtimes in plots/data. Prints a table of speedups and slowdowns and
+exits with 1 if any function got slower than the tolerance allows.
+All arguments it does not know (-include, -builder, -sizes, ...) are passed on to the scraper, f.ex.
+    python3 plots/regress.py -include gemm conv -tolerance 0.02 -builder 'dbuild_size 1024'
+'''
+
+if ".git" not in os.listdir(os.getcwd()):
+    print("please run this script from the project root")
+    sys.exit()
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-tolerance", type=float, dest="tolerance", default=0.05,
+                    help="Allowed slowdown as a fraction of the stored cycles, default 0.05")
+parser.add_argument("-baseline", type=str, dest="baseline", default="plots/data/",
+                    help="Directory of the stored runtimes, default plots/data/")
+parser.add_argument("-output", type=str, dest="output", default="plots/data/regress/",
+                    help="Directory the new runtimes are written to, default plots/data/regress/")
+parser.add_argument("-no-run", action="store_true", dest="no_run",
+                    help="Only compare the runtimes already in the output directory")
+args, scraper_args = parser.parse_known_args()
+
+if not args.no_run:
+    scraper = os.path.join(os.path.dirname(__file__), "scraper.py")
+    if subprocess.run([sys.executable, scraper, "-output", args.output] + scraper_args).returncode != 0:
+        print("[ERROR]  the scraper failed")
+        sys.exit(1)
+
+
+def load_runtimes(filename):
+    ''' {function: {size: median cycles}} of a *_runtime.json file of the scraper. '''
+    data = json.load(open(filename, "r"))
+    runtimes = {}
+    for name, cycles in data.items():
+        if name == "n":
+            continue
+        runtimes[name] = {n: median(c) if isinstance(c, list) else c for n, c in zip(data["n"], cycles)}
+    return runtimes
+
+
+rows = []
+missing = []
+for filename in sorted(os.listdir(args.output)):
+    if not filename.endswith("_runtime.json"):
+        continue
+    stored = os.path.join(args.baseline, filename)
+    if not os.path.exists(stored):
+        print("[INFO]   no stored runtimes for {}".format(filename))
+        continue
+    old = load_runtimes(stored)
+    new = load_runtimes(os.path.join(args.output, filename))
+    for name in sorted(old.keys()):
+        if name not in new:
+            missing.append(name)
+            continue
+        for n in sorted(old[name].keys()):
+            if n in new[name] and new[name][n] > 0:
+                rows.append((name, n, old[name][n], new[name][n]))
+
+regressions = [r for r in rows if r[3] > r[2] * (1 + args.tolerance)]
+
+print("{:45} {:>8} {:>12} {:>12} {:>9}".format("function", "n", "stored", "new", "speedup"))
+for name, n, old_cycles, new_cycles in sorted(rows, key=lambda r: r[2] / r[3]):
+    flag = "  SLOWER" if (name, n, old_cycles, new_cycles) in regressions else ""
+    print("{:45} {:>8} {:>12} {:>12} {:>8.3f}x{}".format(name, n, old_cycles, new_cycles, old_cycles / new_cycles, flag))
+
+for name in missing:
+    print("[WARNING]    {} is stored but was not measured".format(name))
+
+print("[RESULT]     {} measurements, {} slower than {:.1%} of the stored cycles".format(
+    len(rows), len(regressions), args.tolerance))
+sys.exit(1 if regressions else 0)
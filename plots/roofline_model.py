@@ -0,0 +1,169 @@
+import json
+import os
+
+'''
+FLOP and byte model of the benchmarked kernels and the ceilings of the snitch cluster for plots/roofline_plot.py.
+
+A FLOP is one double (or packed float) operation, an fmadd counts as two. The elementwise math kernels count
+the FP instructions of their bodies per element (range reduction and polynomial), so their intensity is that
+of the implementation and not of a textbook formula. The bytes are the compulsory traffic of the buffers in
+global memory: every input read once, every output written once.
+'''
+
+# Words which start the variant part of a function name, the same as bench_variants in src/benchmark/benchmark.h
+VARIANTS = ["baseline", "ssr", "parallel", "omp", "lut", "tiled", "blocked", "dma",
+            "snitch", "winograd", "dispatch", "unfused", "naive", "fused", "graph", "task"]
+
+# One fmadd per cycle and core, packed float SIMD does two
+FLOPS_PER_CYCLE_CORE = 2.0
+
+# Ceilings (bytes per cycle) used when plots/data has no bandwidth measurement (benchmark_bandwidth)
+ASSUMED_L1_BYTES_PER_CYCLE_CORE = 24.0  # two read and one write SSR of 8 bytes
+ASSUMED_MEM_BYTES_PER_CYCLE = 8.0       # one 64 bit access per cycle
+COMPUTE_CORES = 8
+
+# Accesses of every run of benchmark_bandwidth (BW_ELEMENTS in src/benchmark/benchmark_bandwidth.c)
+BW_ELEMENTS = 8192
+
+
+def split_name(name):
+    ''' (op, variant) of a function name, split at the "_" before the first variant word. '''
+    parts = name.split("_")
+    for i in range(1, len(parts)):
+        if parts[i] in VARIANTS:
+            return "_".join(parts[:i]), "_".join(parts[i:])
+    return name, ""
+
+
+def cores_of(variant):
+    return COMPUTE_CORES if "parallel" in variant or "omp" in variant else 1
+
+
+def sqrt_approx(a):
+    ''' sqrt_approx of src/lmq/lmq.c, the benchmarks derive their shapes with it. '''
+    x = 1.0
+    for _ in range(5):
+        x = 0.5 * (x + a / x)
+    return x
+
+
+# FLOPs per element of the elementwise kernels and the number of input buffers
+ELEMENTWISE = {
+    "fabs": (1, 1), "abs": (1, 1), "relu": (1, 1), "leakyrelu": (2, 1), "clip": (2, 1), "hardsigmoid": (4, 1),
+    "prelu": (3, 2), "add": (1, 2), "sub": (1, 2), "mul": (1, 2), "div": (1, 2), "copy": (0, 1),
+    "exp": (20, 1), "sigmoid": (23, 1), "tanh": (25, 1), "softplus": (25, 1), "erf": (30, 1), "gelu": (34, 1),
+    "sin": (22, 1), "cos": (22, 1), "sin_approx": (12, 1), "acos": (30, 1), "acosh": (32, 1), "asinh": (32, 1),
+    "dropout": (1, 1), "dropout_counter": (1, 1), "masked_dropout": (2, 2), "masked_dropout_bits": (2, 1),
+    "broadcast": (1, 2), "batchnorm_nchw_inference": (2, 1),
+}
+
+# FLOPs per element and bytes per element of reductions and scans, which write (almost) nothing or n elements
+STREAMING = {
+    "sum": (1, 8), "max": (1, 8), "argmax": (1, 8), "argmax_axis": (1, 8), "dot": (2, 16),
+    "cumsum": (1, 16), "cumsum_onnx": (1, 16), "cumsum_axis": (1, 16), "softmax": (23, 16),
+    "layernorm": (8, 16), "batchnorm": (3, 8), "batchnorm_nchw_training": (5, 16), "reduce_axes": (1, 8),
+    "transpose": (0, 16), "transpose_nd": (0, 16), "fuse": (6, 16),
+}
+
+
+def element_bytes(variant):
+    return 4 if "f32" in variant else 8
+
+
+def gemm_shape(n, shape):
+    if "M" in shape:
+        return shape["M"], shape["N"], shape.get("K", 1)
+    s = int(sqrt_approx(n))
+    return s // 2, s * 2, s // 2
+
+
+def model(name, n, shape={}):
+    '''
+    (flops, bytes) of one call of function name for benchmark size n and the shape fields of its record
+    (src/benchmark/benchmark.h, bench_shape). Without a record the shape of the first benchmark section is taken.
+    Returns None for kernels without a model.
+    '''
+    op, variant = split_name(name)
+    b = element_bytes(variant)
+
+    if op in ELEMENTWISE:
+        flops, inputs = ELEMENTWISE[op]
+        return flops * n, (inputs + 1) * b * n
+    if op in STREAMING:
+        flops, bytes_per_element = STREAMING[op]
+        return flops * n, bytes_per_element * b / 8 * n
+
+    if op in ("gemm", "gemm_onnx"):
+        m, k, j = gemm_shape(n, shape)
+        flops = 2 * m * k * j + (3 * m * j if op == "gemm_onnx" else 0)
+        return flops, b * (m * k + k * j + m * j * (2 if op == "gemm_onnx" else 1))
+    if op == "gemm_batched":
+        batch, dim = shape.get("batch", n // 16), shape.get("dim", 4)
+        return batch * 2 * dim ** 3, b * batch * 3 * dim * dim
+    if op == "gemv":
+        m, k = shape.get("M", n // 32 + 3), shape.get("N", 32)
+        return 2 * m * k, b * (m * k + k + m)
+
+    if op == "conv" or op == "conv_nchw":
+        f = shape.get("filter", 5)
+        stride, dilation = shape.get("stride", 2), shape.get("dilation", 2)
+        input_size = shape.get("n", (n - 1) * stride + 1 + (f - 1) * dilation)
+        return 2 * n * f, b * (input_size + f + n)
+    if op == "conv2d":
+        f0, f1 = shape.get("f0", 5), shape.get("f1", 4)
+        s0, s1 = shape.get("s0", 3), shape.get("s1", 2)
+        d0, d1 = shape.get("d0", 2), shape.get("d1", 1)
+        outn = int(sqrt_approx(n))
+        n0, n1 = shape.get("n0", (outn - 1) * s0 + 1 + (f0 - 1) * d0), shape.get("n1", (outn - 1) * s1 + 1 + (f1 - 1) * d1)
+        out0, out1 = (n0 - 1 - (f0 - 1) * d0) // s0 + 1, (n1 - 1 - (f1 - 1) * d1) // s1 + 1
+        return 2 * out0 * out1 * f0 * f1, b * (n0 * n1 + f0 * f1 + out0 * out1)
+
+    if op in ("maxpool", "avgpool2d", "maxpool2d", "maxpool2d_onnx", "global_maxpool", "global_avgpool"):
+        # one comparison or addition per input element, small outputs
+        return n, b * n
+    return None
+
+
+def flops_ceiling(variant):
+    return FLOPS_PER_CYCLE_CORE * cores_of(variant) * (2 if "f32" in variant else 1)
+
+
+def bandwidth_ceilings(datapath):
+    '''
+    Bytes per cycle of L1 and global memory for 1 and COMPUTE_CORES cores: the best SSR+FREP copy of
+    benchmark_bandwidth (plots/data/bandwidth_runtime.json) or the assumed ceilings.
+    '''
+    ceilings = {("l1", 1): ASSUMED_L1_BYTES_PER_CYCLE_CORE,
+                ("l1", COMPUTE_CORES): ASSUMED_L1_BYTES_PER_CYCLE_CORE * COMPUTE_CORES,
+                ("mem", 1): ASSUMED_MEM_BYTES_PER_CYCLE,
+                ("mem", COMPUTE_CORES): ASSUMED_MEM_BYTES_PER_CYCLE}
+    measured = False
+    filename = os.path.join(datapath, "bandwidth_runtime.json")
+    if not os.path.exists(filename):
+        return ceilings, measured
+
+    data = json.load(open(filename, "r"))
+    best = {}
+    for name, cycles in data.items():
+        # bw_<mode>_<method>_<l1|mem>_c<cores>_s<stride>, see src/benchmark/benchmark_bandwidth.c
+        parts = name.split("_")
+        if name == "n" or len(parts) != 6 or parts[0] != "bw" or parts[5] != "s1":
+            continue
+        mode, location, cores = parts[1], parts[3], int(parts[4][1:])
+        # the buffers (powers of two up to the L1 limit) are repeated to BW_ELEMENTS accesses in every run
+        traffic = BW_ELEMENTS * 8 * (2 if mode == "copy" else 1)
+        for c in cycles:
+            for c in (c if isinstance(c, list) else [c]):
+                bw = traffic / c if c > 0 else 0.0
+                best[(location, cores)] = max(best.get((location, cores), 0.0), bw)
+    for key in ceilings:
+        if key in best:
+            ceilings[key] = best[key]
+            measured = True
+    return ceilings, measured
+
+
+def attainable(intensity, variant, ceilings, location="mem"):
+    ''' FLOP per cycle of the roofline at intensity (FLOP per byte). '''
+    cores = cores_of(variant)
+    return min(flops_ceiling(variant), intensity * ceilings[(location, cores)])
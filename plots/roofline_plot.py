@@ -0,0 +1,114 @@
+import os
+import sys
+import json
+from collections import defaultdict
+
+import numpy as np
+import matplotlib.pyplot as plt
+import seaborn as sns
+
+from plotloader import arg_parse, arg_filter
+from roofline_model import model, split_name, cores_of, flops_ceiling, bandwidth_ceilings, attainable, COMPUTE_CORES
+
+'''
+Places every benchmarked kernel (its largest size) on the roofline of the cluster: FLOP per cycle over FLOP per
+byte, with the compute ceiling of 1 and 8 cores and the bandwidth ceilings of global memory and L1 measured by
+benchmark_bandwidth. The kernels furthest below their roof are printed first.
+Takes the shapes from plots/data/records (-DLMQ_RECORD) and falls back to the runtimes in plots/data.
+'''
+
+relpath = "data/"
+fullpath = os.path.dirname(__file__) + "/" + relpath
+
+if ".git" not in os.listdir(os.getcwd()):
+    print("please run this script from the project root")
+    sys.exit()
+
+include, exclude, savepath, _, _, _ = arg_parse()
+
+# (function name, size) -> (list of cycles, shape)
+measurements = defaultdict(lambda: ([], {}))
+
+recordpath = fullpath + "records/"
+if os.path.isdir(recordpath):
+    for filename in sorted(os.listdir(recordpath)):
+        if not filename.endswith(".json"):
+            continue
+        for record in json.load(open(recordpath + filename, "r")):
+            if "core" in record or "cycles" not in record:
+                continue
+            name = record["op"] + ("_" + record["variant"] if record["variant"] else "")
+            shape = {k: v for k, v in record.items()
+                     if k not in ("op", "variant", "size", "cores", "cycles", "rc", "run")}
+            key = (name, record["size"])
+            measurements[key][0].append(record["cycles"])
+            measurements[key][1].update(shape)
+
+if not measurements:
+    for filename in sorted(os.listdir(fullpath)):
+        if not filename.endswith("_runtime.json") or filename.startswith("bandwidth"):
+            continue
+        data = json.load(open(fullpath + filename, "r"))
+        for name, cycles in data.items():
+            if name == "n":
+                continue
+            for n, c in zip(data["n"], cycles):
+                measurements[(name, n)][0].extend(c if isinstance(c, list) else [c])
+
+names = arg_filter(sorted(set(name for name, _ in measurements.keys())), include, exclude)
+ceilings, measured = bandwidth_ceilings(fullpath)
+print("[    ROOFLINE]     bandwidth ceilings ({}): {}".format("measured" if measured else "assumed", ceilings))
+
+points = []
+for name in names:
+    n = max(size for fn, size in measurements.keys() if fn == name)
+    cycles, shape = measurements[(name, n)]
+    counts = model(name, n, shape)
+    if counts is None:
+        print("[    ROOFLINE]     no model for {}".format(name))
+        continue
+    if counts[0] == 0:
+        # copies and transposes only move data, benchmark_bandwidth covers them
+        continue
+    flops, bytes = counts
+    op, variant = split_name(name)
+    intensity = flops / bytes
+    performance = flops / np.median(cycles)
+    roof = attainable(intensity, variant, ceilings)
+    bound = "compute" if roof >= flops_ceiling(variant) else "memory"
+    points.append({"name": name, "op": op, "cores": cores_of(variant), "n": n, "intensity": intensity,
+                   "performance": performance, "roof": roof, "bound": bound})
+
+# the furthest below their roof first, they gain the most from FREP or more accumulators
+print("{:40} {:>8} {:>10} {:>12} {:>10} {:>7} {:>8}".format("kernel", "n", "FLOP/B", "FLOP/cycle", "roof", "%", "bound"))
+for p in sorted(points, key=lambda p: p["performance"] / p["roof"]):
+    print("{:40} {:>8} {:>10.3f} {:>12.3f} {:>10.3f} {:>6.1f}% {:>8}".format(
+        p["name"], p["n"], p["intensity"], p["performance"], p["roof"], 100 * p["performance"] / p["roof"], p["bound"]))
+
+sns.set_style("dark")
+fig, ax = plt.subplots()
+ax.set_xscale('log', base=2)
+ax.set_yscale('log', base=2)
+
+intensities = [p["intensity"] for p in points] or [1.0]
+x = np.logspace(np.log2(min(intensities) / 4), np.log2(max(intensities) * 4), 200, base=2)
+for cores, color in ((1, "gray"), (COMPUTE_CORES, "black")):
+    variant = "parallel" if cores > 1 else ""
+    for location, style in (("mem", "-"), ("l1", "--")):
+        ax.plot(x, [attainable(i, variant, ceilings, location) for i in x], style, color=color, linewidth=1,
+                label="{} core{}, {}".format(cores, "s" if cores > 1 else "", "global memory" if location == "mem" else "L1"))
+
+markers = {1: "o", COMPUTE_CORES: "^"}
+palette = dict(zip(sorted(set(p["op"] for p in points)), sns.color_palette("husl", len(set(p["op"] for p in points)))))
+for p in points:
+    ax.scatter(p["intensity"], p["performance"], color=palette[p["op"]], marker=markers[p["cores"]], zorder=3)
+    ax.annotate(p["name"], (p["intensity"], p["performance"]), fontsize=5, xytext=(2, 2), textcoords="offset points")
+
+ax.set(xlabel='arithmetic intensity [FLOP/byte]', ylabel='performance [FLOP/cycle]')
+ax.set(title=(include[0] + ' Roofline' if include else 'Roofline'))
+ax.legend(fontsize=6)
+
+if savepath:
+    plt.savefig(os.path.join(os.getcwd(), savepath), pad_inches=0.1,  bbox_inches='tight', dpi=300)
+else:
+    plt.show()
@@ -1,90 +1,153 @@
-from pwn import *
 from collections import defaultdict
+from concurrent.futures import ThreadPoolExecutor
+import subprocess
+import hashlib
 import re
-import csv
 import os
 import sys
-import argparse
 import json
-from itertools import compress
-from plotloader import arg_parse, arg_filter
+from plotloader import arg_parser, arg_filter
 
 if ".git" not in os.listdir(os.getcwd()):
     print("please run this script from the project root")
     sys.exit()
 
-include, exclude, save, builder, runner, _ = arg_parse()
 # add argparse to specify function names that should either be included or excluded
+parser = arg_parser()
+parser.add_argument("-sizes", type=int, nargs="*", dest="sizes",
+                    help="Build every LMQ_SIZE once into build_<size> (concurrently) and run all benchmarks of every size")
+parser.add_argument("-jobs", type=int, dest="jobs", default=os.cpu_count(),
+                    help="Number of simulations run at once, default the number of host cores")
+parser.add_argument("-no-cache", action="store_true", dest="no_cache",
+                    help="Simulate even if the output of an identical binary is in plots/data/cache")
+parser.add_argument("-build-prefix", type=str, dest="build_prefix", default="build_",
+                    help="With -sizes the build directories are <prefix><size>, default build_")
+parser.add_argument("-output", type=str, dest="output", default="plots/data/",
+                    help="Directory the json files are written to, default plots/data/ (plots/regress.py uses another)")
+args = parser.parse_args()
+include, exclude, builder, runner = args.include, args.exclude, args.builder, args.runner
+
+# With -sizes the builder gets the build directory and the size, the default builders of scripts/env.sh only take the size
+if args.sizes and builder == parser.get_default("builder"):
+    builder = "dbuild_dir_size {dir} {size}"
+if args.sizes and "{dir}" not in builder:
+    print("[ERROR]  with -sizes the builder must take {dir} and {size}, f.ex. 'build_dir_size {dir} {size}'")
+    sys.exit()
 
-# finds all relevant benchmark names
-benchmarks = []
-fullpath = os.path.dirname(__file__) + "/../build"
-for filename in os.listdir(fullpath):
-    if "benchmark" in filename and not (filename.endswith(".a") or filename.endswith(".s")):
-        benchmarks.append(filename.replace("benchmark_", ""))
-
-# filter benchmark names based on include, exclude
-benchmarks = arg_filter(benchmarks, include, exclude)
-
-# start simulator for each of the names in benchmarks
-print("[INFO]   simulating the operators: ", benchmarks)
-for i, benchmark in enumerate(benchmarks):
-    print(f"Running benchmark \"{benchmark}\"")
-    def create_shell():
-        p = process(["/bin/bash"])  # env.sh relies on bash. sh is not sufficient
-
-        p.sendline(b"pwd")          # print execution path
-        print("pwd: ", p.recvline().decode())
-
-        p.sendline(b"source ./scripts/env.sh")
-        print("sourcing: ", p.recvline().decode())
- 
-        # This enables expansion of aliases (normally only in interactive shells)
-        # p.sendline(b"shopt -s expand_aliases")
-        return p
-    
-    p = create_shell()
-    # start bash shell subprocess
-    print("[SUBPROCESS]  starting bash shell")
-
-    p.sendline(b"echo $PROOT")          # print project root
-    print("proot: ", p.recvline().decode())
-
-    # use shell to compile and run simulator
-    print(f"[COMPILING] with builder: {builder}")
-    
-    p.sendline(bytes(f"{builder}; echo \"FINISHED COMPILING\""
-, encoding="utf-8"))
-    p.recvuntil(bytes("FINISHED COMPILING", encoding="utf-8"))
-
-    print(f"[RUNNING]: {runner} (this takes a couple of minutes)")
-    p.sendline(bytes(f"{runner} $PROOT/build/benchmark_{benchmark}; echo \"---SIMULATOR DONE---\"", encoding="utf-8"))
-
-    result = p.recvuntil(b"---SIMULATOR DONE---").decode()
-
-    # prints the console output of the benchmark. groups duplicate outputs
-    unique_printer = defaultdict(int)
-    for r in result.split("\n"):
-        unique_printer[r] += 1
-    for k, v in unique_printer.items():
-        print("\t", v, "x", k)
+# one build directory per size, or the single build of the builder in build/
+builds = [(args.build_prefix + str(size), size) for size in args.sizes] if args.sizes else [("build", None)]
+
+cachepath = "plots/data/cache/"
+# benchmarks whose runtimes go to a subfolder of the output: plotloader only loads the files of plots/data
+SWEEPS = ["shapes", "dispatch"]
+outpath = os.path.join(args.output, "")
+os.makedirs(outpath, exist_ok=True)
+
+def run(command):
+    """ Runs command in bash after sourcing scripts/env.sh (it relies on bash, sh is not sufficient). """
+    process = subprocess.run(["/bin/bash", "-c", f"source ./scripts/env.sh > /dev/null && {command}"],
+                             stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    return process.returncode, process.stdout.decode(errors="replace")
+
+def shell(command):
+    """ Output of command (see run). """
+    return run(command)[1]
+
+def has_benchmark_lines(result):
+    """ Whether result has a runtime line, of BENCH_VO or of -DLMQ_RECORD. """
+    return re.search(r'\w+, size: \d+: \d+ cycles', result) is not None or "@lmq " in result
+
+def build(directory, size):
+    command = builder.format(dir=directory, size=size) if size is not None else builder
+    print(f"[COMPILING] {command}")
+    output = shell(command)
+    print(f"[COMPILED]  {command}")
+    return output
+
+def simulate(binary):
+    """
+    Output of runner on binary. The output is cached under the hash of the binary and the runner,
+    so benchmarks whose code did not change since the last sweep are not simulated again.
+    Failed runs (an exit code other than 0 or no benchmark lines) are not cached.
+    """
+    with open(binary, "rb") as f:
+        key = hashlib.sha256(f.read() + runner.encode()).hexdigest()
+    cached = cachepath + key + ".txt"
+    if not args.no_cache and os.path.exists(cached):
+        print(f"[CACHED]    {binary}")
+        return open(cached, "r").read()
+
+    print(f"[RUNNING]   {runner} {binary}")
+    returncode, result = run(f"{runner} $PROOT/{binary}")
+    if returncode != 0 or not has_benchmark_lines(result):
+        print(f"[FAILED]    {runner} {binary} (exit code {returncode}), not cached")
+        return result
+    os.makedirs(cachepath, exist_ok=True)
+    with open(cached, "w") as f:
+        f.write(result)
+    return result
+
+def save_results(benchmark, result, outpath):
+    """ Parses the output of all runs of benchmark and writes the json files to outpath. """
+    # records of -DLMQ_RECORD (src/benchmark/benchmark.h): "@lmq key=value ...", numbers are converted
+    records = []
+    for line in result.split("\n"):
+        line = line.strip()
+        if not line.startswith("@lmq "):
+            continue
+        record = dict()
+        for field in line.split(" ")[1:]:
+            if "=" not in field:
+                continue
+            key, value = field.split("=", 1)
+            try:
+                record[key] = int(value)
+            except ValueError:
+                try:
+                    record[key] = float(value)
+                except ValueError:
+                    record[key] = value
+        records.append(record)
 
     # parse result and values into dict
     sizes = set()
     data = dict()
-    split_result = re.findall(r'\w+, \bsize: \b\d+: \b\d+\b cycles', result)
     tmp = defaultdict(lambda: defaultdict(list))
-    for r in split_result:
-        # parse a single line of the output and put it into tmp
-        s = r.split(" ")
-        cycles = int(s[-2])
-        size = int(s[-3][:-1])
-        name = s[0][:-1]
-
-        sizes.add(size)
-        # print("Adding size: " + str(size))
-        tmp[name][size].append(cycles)
-    
+    if records:
+        # the runtimes are the records of whole calls, the per core ones have a "core" field
+        def record_name(record):
+            return record["op"] + ("_" + record["variant"] if record["variant"] else "")
+
+        # BENCH_VO_MULTI records every number of clusters under the same name, like its plain lines only the run
+        # on the most clusters is a runtime (the scaling stays in the records json)
+        widest = defaultdict(int)
+        for record in records:
+            if "clusters" in record:
+                widest[record_name(record)] = max(widest[record_name(record)], record["clusters"])
+        for record in records:
+            if "core" in record or "cycles" not in record:
+                continue
+            name = record_name(record)
+            if "clusters" in record and record["clusters"] != widest[name]:
+                continue
+            sizes.add(record["size"])
+            tmp[name][record["size"]].append(record["cycles"])
+        os.makedirs(outpath + "records", exist_ok=True)
+        with open(outpath + "records/" + benchmark + "_records.json", "w") as jsonfile:
+            jsonfile.write(json.dumps(records, indent=4))
+    else:
+        split_result = re.findall(r'\w+, \bsize: \b\d+: \b\d+\b cycles', result)
+        for r in split_result:
+            # parse a single line of the output and put it into tmp
+            s = r.split(" ")
+            cycles = int(s[-2])
+            size = int(s[-3][:-1])
+            name = s[0][:-1]
+
+            sizes.add(size)
+            # print("Adding size: " + str(size))
+            tmp[name][size].append(cycles)
+
     # restructure tmp-dict into data-dict
     for k in tmp.keys():
         for l in tmp[k].keys():
@@ -98,14 +161,83 @@ for i, benchmark in enumerate(benchmarks):
     for k in tmp.keys():
         # data[k].append(tmp[k])
         data[k] = [tmp[k][l] for l in sorted(tmp[k].keys())] # would technically work without sorting, but I dont like relying on the implementation detail that dict-keys are sorted by insertion order in python
-    
-    # print progress
-    full = len(benchmarks)
-    print("[PROGRESS]   {:3.2%} Done ({}/{})".format((i+1) / full ,i+1 ,full))
-    
+
+    # summaries of BENCH_STATS (-DLMQ_STATS), their cycles are the medians and already in data
+    stats = defaultdict(dict)
+    for r in re.findall(r'\w+, size: \d+: \d+ cycles\. Return code: -?\d+\. min \d+, mean [\d.]+, stddev [\d.]+, runs \d+', result):
+        m = re.match(r'(\w+), size: (\d+): (\d+) cycles\. Return code: -?\d+\. min (\d+), mean ([\d.]+), stddev ([\d.]+), runs (\d+)', r)
+        stats[m[1]][int(m[2])] = {"min": int(m[4]), "median": int(m[3]), "mean": float(m[5]),
+                                  "stddev": float(m[6]), "runs": int(m[7])}
+    if stats:
+        # in a subfolder (like the records), plotloader only loads the runtimes of plots/data
+        os.makedirs(outpath + "stats", exist_ok=True)
+        with open(outpath + "stats/" + benchmark + "_stats.json", "w") as jsonfile:
+            jsonfile.write(json.dumps(stats, indent=4))
+
+    # load balance of BENCH_VO_PARALLEL (bench_imbalance_print in src/benchmark/benchmark.h)
+    imbalance = defaultdict(dict)
+    for m in re.finditer(r'(\w+) imbalance, size: (\d+): compute max (\d+), min (\d+), mean ([\d.]+), barrier wait max (\d+), mean ([\d.]+), idle ([\d.]+)%, dm wait (\d+)', result):
+        imbalance[m[1]][int(m[2])] = {"compute_max": int(m[3]), "compute_min": int(m[4]), "compute_mean": float(m[5]),
+                                      "wait_max": int(m[6]), "wait_mean": float(m[7]), "idle": float(m[8]),
+                                      "dm_wait": int(m[9])}
+    if imbalance:
+        os.makedirs(outpath + "imbalance", exist_ok=True)
+        with open(outpath + "imbalance/" + benchmark + "_imbalance.json", "w") as jsonfile:
+            jsonfile.write(json.dumps(imbalance, indent=4))
+
+    # accuracy lines of report_accuracy (src/benchmark/benchmark.h)
+    accuracy = defaultdict(dict)
+    for m in re.finditer(r'(\w+) accuracy, size: (\d+): max ulp (\S+), mean ulp (\S+), max rel (\S+), mean rel (\S+), max abs (\S+), mismatches (\d+)', result):
+        accuracy[m[1]][int(m[2])] = {"max_ulp": float(m[3].rstrip(",")), "mean_ulp": float(m[4].rstrip(",")),
+                                     "max_rel": float(m[5].rstrip(",")), "mean_rel": float(m[6].rstrip(",")),
+                                     "max_abs": float(m[7].rstrip(",")), "mismatches": int(m[8])}
+    if accuracy:
+        os.makedirs(outpath + "accuracy", exist_ok=True)
+        with open(outpath + "accuracy/" + benchmark + "_accuracy.json", "w") as jsonfile:
+            jsonfile.write(json.dumps(accuracy, indent=4))
+
     # save data as json file
-    filename = "plots/data/" + benchmark + "_runtime.json"
+    os.makedirs(outpath, exist_ok=True)
+    filename = outpath + benchmark + "_runtime.json"
     with open(filename, "w") as jsonfile:
         jsonfile.write(json.dumps(data, indent=4))
 
-    p.sendline(bytes(f"exit 0", encoding="utf-8"))
+# build every size once for all benchmarks, the sizes concurrently
+with ThreadPoolExecutor(max_workers=len(builds)) as pool:
+    list(pool.map(lambda b: build(*b), builds))
+
+# finds all relevant benchmark names
+benchmarks = set()
+for directory, _ in builds:
+    for filename in os.listdir(directory):
+        if filename.startswith("benchmark_") and not (filename.endswith(".a") or filename.endswith(".s")):
+            benchmarks.add(filename.replace("benchmark_", ""))
+
+# filter benchmark names based on include, exclude
+benchmarks = arg_filter(sorted(benchmarks), include, exclude)
+
+# simulate every benchmark of every build in a pool across the host cores
+print("[INFO]   simulating the operators: ", benchmarks)
+runs = [(benchmark, directory + "/benchmark_" + benchmark) for benchmark in benchmarks for directory, _ in builds
+        if os.path.exists(directory + "/benchmark_" + benchmark)]
+with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+    results = list(pool.map(lambda r: simulate(r[1]), runs))
+
+for i, benchmark in enumerate(benchmarks):
+    # the outputs of all sizes, a larger LMQ_SIZE also runs the smaller sizes
+    result = "\n".join(r for (b, _), r in zip(runs, results) if b == benchmark)
+    print(f"Results of benchmark \"{benchmark}\"")
+
+    # prints the console output of the benchmark. groups duplicate outputs
+    unique_printer = defaultdict(int)
+    for r in result.split("\n"):
+        unique_printer[r] += 1
+    for k, v in unique_printer.items():
+        print("\t", v, "x", k)
+
+    # the sweeps run the functions of the other benchmarks with other sizes, keep them apart
+    save_results(benchmark, result, outpath + benchmark + "/" if benchmark in SWEEPS else outpath)
+
+    # print progress
+    full = len(benchmarks)
+    print("[PROGRESS]   {:3.2%} Done ({}/{})".format((i+1) / full ,i+1 ,full))
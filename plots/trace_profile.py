@@ -0,0 +1,278 @@
+import argparse
+import bisect
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+from collections import defaultdict
+
+'''
+Instruction trace profiler: attributes the cycles of every core to kernels, phases and source lines.
+It runs a benchmark on banshee with --trace (or reads a trace written before, or the trace_hart_*.txt of the RTL
+simulation), disassembles the ELF with objdump and maps the PCs to source lines with addr2line (the build uses -g).
+The cycles of an instruction are the cycles until the next instruction of the same core, everything above one
+is counted as stall. The kernel of an instruction is the function main called (f.ex. gemm_ssr_frep for its
+helpers too), its phase comes from the instruction:
+    ssr_setup   scfgw(i) and the SSR enable/disable CSR
+    frep        frep and the instructions of its body
+    barrier     the cluster barrier CSR and functions with barrier in their name
+    fpu_sync    fmv.x.w (snrt_fpu_fence)
+    dma         the DMA instructions
+    fp_scalar   floating point instructions outside of a FREP body (remainders, epilogues, baselines)
+    int_memory  integer loads and stores
+    int_control all other integer instructions (loop counters, address arithmetic, branches)
+F.ex.
+    python3 plots/trace_profile.py build/benchmark_gemm -include gemm_ssr_frep -lines 10
+    python3 plots/trace_profile.py build/benchmark_gemm -trace plots/data/profile/benchmark_gemm.trace
+Banshee is not cycle accurate, for stalls that match the hardware use the RTL traces (-rtl-logs logs/).
+'''
+
+if ".git" not in os.listdir(os.getcwd()):
+    print("please run this script from the project root")
+    sys.exit()
+
+parser = argparse.ArgumentParser()
+parser.add_argument("binary", type=str, help="The benchmark ELF, f.ex. build/benchmark_gemm")
+parser.add_argument("-trace", type=str, dest="trace",
+                    help="Analyse this banshee trace instead of running the binary")
+parser.add_argument("-rtl-logs", type=str, dest="rtl_logs",
+                    help="Analyse the trace_hart_*.txt of snitch_cluster.vlt in this directory instead of running banshee")
+parser.add_argument("-runner", type=str, dest="runner",
+                    default="banshee --configuration $SNITCH_ROOT/sw/banshee/config/snitch_cluster.yaml --trace -l {binary}",
+                    help="Command (run after sourcing scripts/env.sh) which writes the trace to stdout or stderr")
+parser.add_argument("-include", type=str, nargs="*", dest="include", default=[],
+                    help="Only report the kernels containing one of these strings")
+parser.add_argument("-lines", type=int, dest="lines", default=5,
+                    help="Number of source lines of the flat profile of every kernel, default 5")
+parser.add_argument("-objdump", type=str, dest="objdump", help="objdump of the RISC-V toolchain, default the first one found")
+parser.add_argument("-addr2line", type=str, dest="addr2line", help="addr2line of the RISC-V toolchain, default the first one found")
+parser.add_argument("-output", type=str, dest="output", default="plots/data/profile/",
+                    help="Directory of the trace and of the json profile, default plots/data/profile/")
+args = parser.parse_args()
+
+PHASES = ["ssr_setup", "frep", "barrier", "fpu_sync", "dma", "fp_scalar", "int_memory", "int_control"]
+
+# banshee: "<cycle> <hart> <pc> <instruction> ..." ; RTL: "<time> <cycle> <priv> 0x<pc> <instruction> ..."
+BANSHEE_LINE = re.compile(r"^\s*(\d+)\s+(\d+)\s+([0-9a-fA-F]{8})\b")
+RTL_LINE = re.compile(r"^\s*\d+\s+(\d+)\s+\w+\s+0x([0-9a-fA-F]+)\b")
+SYMBOL_LINE = re.compile(r"^([0-9a-f]+) <(.+)>:$")
+INSTRUCTION_LINE = re.compile(r"^\s*([0-9a-f]+):(.*)$")
+
+INT_MEMORY = {"lb", "lbu", "lh", "lhu", "lw", "sb", "sh", "sw", "lr.w", "sc.w"}
+SSR_CSRS = ("0x7c0", "ssr")
+BARRIER_CSRS = ("0x7c2", "barrier")
+
+
+def tool(name, given):
+    ''' The given tool or the first of the RISC-V, LLVM and host variants on the PATH. '''
+    if given:
+        return given
+    for candidate in ["riscv32-unknown-elf-" + name, "llvm-" + name, name]:
+        if shutil.which(candidate):
+            return candidate
+    print("[ERROR]  no {} found, give it with -{}".format(name, name))
+    sys.exit(1)
+
+
+def disassemble(binary):
+    ''' {pc: (mnemonic, operands)} and the sorted (start, name) of the functions of binary. '''
+    output = subprocess.run([tool("objdump", args.objdump), "-d", binary],
+                            stdout=subprocess.PIPE, stderr=subprocess.DEVNULL).stdout.decode(errors="replace")
+    instructions, symbols = {}, []
+    for line in output.split("\n"):
+        m = SYMBOL_LINE.match(line)
+        if m:
+            symbols.append((int(m[1], 16), m[2]))
+            continue
+        m = INSTRUCTION_LINE.match(line)
+        if not m:
+            continue
+        # "<bytes>\t<mnemonic>\t<operands>" of GNU and LLVM objdump
+        fields = [f.strip() for f in m[2].split("\t") if f.strip()]
+        if len(fields) >= 2:
+            text = " ".join(fields[1:]).split(None, 1)
+            instructions[int(m[1], 16)] = (text[0], text[1].strip() if len(text) > 1 else "")
+    symbols.sort()
+    return instructions, symbols
+
+
+def frep_bodies(instructions):
+    ''' The PCs of the instructions repeated by a frep: the n_instr instructions following it. '''
+    pcs = sorted(instructions)
+    body = set()
+    for i, pc in enumerate(pcs):
+        mnemonic, operands = instructions[pc]
+        if mnemonic.startswith("frep"):
+            ops = [o.strip() for o in operands.split(",")]
+            count = int(ops[1], 0) if len(ops) > 1 and re.match(r"^(0x)?[0-9a-f]+$", ops[1]) else 1
+            body.update(pcs[i + 1:i + 1 + count])
+    return body
+
+
+def source_lines(binary, pcs):
+    ''' {pc: "file:line"} of the innermost (inlined) source location of every pc. '''
+    pcs = sorted(pcs)
+    output = subprocess.run([tool("addr2line", args.addr2line), "-e", binary],
+                            input="\n".join(hex(pc) for pc in pcs).encode(),
+                            stdout=subprocess.PIPE, stderr=subprocess.DEVNULL).stdout.decode(errors="replace")
+    lines = {}
+    for pc, location in zip(pcs, output.strip().split("\n")):
+        location = location.split(" (discriminator")[0]
+        path, _, line = location.rpartition(":")
+        lines[pc] = "{}:{}".format(os.path.relpath(path) if path.startswith("/") else path, line)
+    return lines
+
+
+def phase(pc, function, instructions, body):
+    mnemonic, operands = instructions.get(pc, ("?", ""))
+    if mnemonic.startswith("scfg") or (mnemonic.startswith("csr") and any(c in operands for c in SSR_CSRS)):
+        return "ssr_setup"
+    if mnemonic.startswith("frep") or pc in body:
+        return "frep"
+    if "barrier" in function or (mnemonic.startswith("csr") and any(c in operands for c in BARRIER_CSRS)):
+        return "barrier"
+    if mnemonic == "fmv.x.w":
+        return "fpu_sync"
+    if mnemonic.startswith("dm"):
+        return "dma"
+    if mnemonic.startswith("f") and mnemonic != "fence":
+        return "fp_scalar"
+    if mnemonic in INT_MEMORY:
+        return "int_memory"
+    return "int_control"
+
+
+def is_call(pc, instructions):
+    mnemonic, operands = instructions.get(pc, ("?", ""))
+    return mnemonic in ("jal", "jalr", "call") and not operands.startswith(("zero", "x0"))
+
+
+def trace_records():
+    ''' (hart, cycle, pc) of every traced instruction in the order of the trace. '''
+    if args.rtl_logs:
+        for filename in sorted(os.listdir(args.rtl_logs)):
+            m = re.match(r"trace_hart_0*(\d+)\.txt$", filename)
+            if not m:
+                continue
+            for line in open(os.path.join(args.rtl_logs, filename), "r", errors="replace"):
+                r = RTL_LINE.match(line)
+                if r:
+                    yield int(m[1]), int(r[1]), int(r[2], 16)
+        return
+
+    trace = args.trace
+    if not trace:
+        os.makedirs(args.output, exist_ok=True)
+        trace = os.path.join(args.output, os.path.basename(args.binary) + ".trace")
+        command = args.runner.format(binary="$PROOT/" + args.binary)
+        print("[RUNNING]   {} > {}".format(command, trace))
+        with open(trace, "w") as f:
+            subprocess.run(["/bin/bash", "-c", "source ./scripts/env.sh > /dev/null && " + command],
+                           stdout=f, stderr=subprocess.STDOUT)
+    for line in open(trace, "r", errors="replace"):
+        r = BANSHEE_LINE.match(line)
+        if r:
+            yield int(r[2]), int(r[1]), int(r[3], 16)
+
+
+instructions, symbols = disassemble(args.binary)
+if not instructions:
+    print("[ERROR]  no instructions in {}".format(args.binary))
+    sys.exit(1)
+starts = [s for s, _ in symbols]
+body = frep_bodies(instructions)
+
+
+def function_of(pc):
+    i = bisect.bisect_right(starts, pc) - 1
+    return symbols[i] if i >= 0 else (0, "?")
+
+
+# per hart: the call stack of function names, the last (cycle, pc, kernel) not yet charged
+stacks = defaultdict(list)
+pending = {}
+# (hart, kernel, pc) -> [instructions, cycles, stalls]
+counts = defaultdict(lambda: [0, 0, 0])
+
+
+def charge(hart, cycle):
+    last_cycle, last_pc, kernel = pending[hart]
+    cycles = max(cycle - last_cycle, 1)
+    c = counts[(hart, kernel, last_pc)]
+    c[0] += 1
+    c[1] += cycles
+    c[2] += cycles - 1
+
+
+for hart, cycle, pc in trace_records():
+    start, function = function_of(pc)
+    stack = stacks[hart]
+    if hart in pending:
+        charge(hart, cycle)
+        called = is_call(pending[hart][1], instructions) and pc == start
+    else:
+        called = False
+
+    # calls push, returns (and missed returns) unwind to the function, jumps into another function replace it
+    if called or not stack:
+        stack.append(function)
+    elif stack[-1] != function:
+        if function in stack:
+            del stack[stack.index(function) + 1:]
+        else:
+            stack[-1] = function
+
+    kernel = stack[stack.index("main") + 1] if "main" in stack[:-1] else ("main" if "main" in stack else "(runtime)")
+    pending[hart] = (cycle, pc, kernel)
+
+for hart in list(pending):
+    charge(hart, pending[hart][0] + 1)
+
+if not counts:
+    print("[ERROR]  no trace lines found")
+    sys.exit(1)
+
+lines = source_lines(args.binary, {pc for _, _, pc in counts})
+
+# (hart, kernel) -> totals, phases and lines
+profile = defaultdict(lambda: {"instructions": 0, "cycles": 0, "stalls": 0,
+                               "phases": defaultdict(lambda: [0, 0]), "lines": defaultdict(lambda: [0, 0, 0])})
+for (hart, kernel, pc), (n, cycles, stalls) in counts.items():
+    p = profile[(hart, kernel)]
+    p["instructions"] += n
+    p["cycles"] += cycles
+    p["stalls"] += stalls
+    ph = p["phases"][phase(pc, function_of(pc)[1], instructions, body)]
+    ph[0] += cycles
+    ph[1] += stalls
+    l = p["lines"][lines.get(pc, "?")]
+    l[0] += n
+    l[1] += cycles
+    l[2] += stalls
+
+selected = sorted((k for k in profile if not args.include or any(i in k[1] for i in args.include)),
+                  key=lambda k: (k[0], -profile[k]["cycles"]))
+for hart, kernel in selected:
+    p = profile[(hart, kernel)]
+    print("hart {} {}: {} cycles, {} instructions, {} stall cycles ({:.1%})".format(
+        hart, kernel, p["cycles"], p["instructions"], p["stalls"], p["stalls"] / p["cycles"]))
+    for name in PHASES:
+        if name in p["phases"]:
+            cycles, stalls = p["phases"][name]
+            print("    {:<12} {:>10} cycles {:>6.1%}, {:>10} stalls".format(name, cycles, cycles / p["cycles"], stalls))
+    for location, (n, cycles, stalls) in sorted(p["lines"].items(), key=lambda l: -l[1][1])[:args.lines]:
+        print("    {:>10} cycles {:>6.1%} {:>8} instr {:>8} stalls  {}".format(
+            cycles, cycles / p["cycles"], n, stalls, location))
+
+os.makedirs(args.output, exist_ok=True)
+filename = os.path.join(args.output, os.path.basename(args.binary) + "_profile.json")
+with open(filename, "w") as jsonfile:
+    jsonfile.write(json.dumps([{"hart": hart, "kernel": kernel, "instructions": p["instructions"],
+                                "cycles": p["cycles"], "stalls": p["stalls"],
+                                "phases": {k: {"cycles": v[0], "stalls": v[1]} for k, v in p["phases"].items()},
+                                "lines": {k: {"instructions": v[0], "cycles": v[1], "stalls": v[2]}
+                                          for k, v in p["lines"].items()}}
+                               for (hart, kernel), p in sorted(profile.items())], indent=4))
+print("[INFO]   profile written to {}".format(filename))
@@ -0,0 +1,67 @@
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+'''
+Writes the thresholds of the *_dispatch kernels (src/lmq/dispatch_table.h) from a run of benchmark_dispatch,
+which measures the crossover points of the variants on the simulated configuration, f.ex.
+    python3 plots/tune_dispatch.py -builder 'dbuild_size 4096'
+    python3 plots/tune_dispatch.py -no-build -runner run_sim
+Rebuild afterwards, the kernels take the table at compile time.
+'''
+
+if ".git" not in os.listdir(os.getcwd()):
+    print("please run this script from the project root")
+    sys.exit()
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-builder", type=str, dest="builder", default="dbuild",
+                    help="Build command of scripts/env.sh, default dbuild")
+parser.add_argument("-no-build", action="store_true", dest="no_build",
+                    help="Use the benchmark_dispatch of build/ as it is")
+parser.add_argument("-runner", type=str, dest="runner", default="run",
+                    help="Simulator command of scripts/env.sh, default run (banshee)")
+parser.add_argument("-output", type=str, dest="output", default="src/lmq/dispatch_table.h",
+                    help="Header to write, default src/lmq/dispatch_table.h")
+args = parser.parse_args()
+
+
+def shell(command):
+    """ Runs command in bash after sourcing scripts/env.sh, like plots/scraper.py. """
+    return subprocess.run(["/bin/bash", "-c", f"source ./scripts/env.sh > /dev/null && {command}"],
+                          stdout=subprocess.PIPE, stderr=subprocess.STDOUT).stdout.decode(errors="replace")
+
+
+if not args.no_build:
+    print(f"[COMPILING] {args.builder}")
+    shell(args.builder)
+
+print(f"[RUNNING]   {args.runner} build/benchmark_dispatch")
+output = shell(f"{args.runner} $PROOT/build/benchmark_dispatch")
+defines = re.findall(r'@dispatch #define (DISPATCH_\w+) (.+)', output)
+if not defines:
+    print(output)
+    print("[ERROR]  benchmark_dispatch printed no thresholds")
+    sys.exit(1)
+
+lines = ["#ifndef LMQ_DISPATCH_TABLE_H", "#define LMQ_DISPATCH_TABLE_H", "",
+         "/*",
+         " * Thresholds of the *_dispatch kernels (src/lmq/dispatch.h): the size from which a variant is used.",
+         " * Written by plots/tune_dispatch.py from the crossover points benchmark_dispatch measured with",
+         " * '{}'. Every value may be overridden with -D.".format(args.runner),
+         " */"]
+op = None
+for name, value in defines:
+    if name.split("_")[1] != op:
+        op = name.split("_")[1]
+        lines.append("")
+    value = value.strip()
+    lines += ["#ifndef " + name, "#define {} {}".format(name, value), "#endif"]
+    print("[THRESHOLD] {} {}".format(name, value))
+lines += ["", "#endif", ""]
+
+with open(args.output, "w") as header:
+    header.write("\n".join(lines))
+print(f"[WRITTEN]   {args.output}")
@@ -32,6 +32,12 @@ run() {
 }
 export run
 
+# Runs using banshee with $1 clusters, f.ex. run_clusters 4 benchmark_multi
+run_clusters() {
+    banshee --configuration $SNITCH_ROOT/sw/banshee/config/snitch_cluster.yaml --num-clusters $1 -l $2
+}
+export run_clusters
+
 # Builds locally
 build() {
     cd $PROOT/build && cmake -DCMAKE_TOOLCHAIN_FILE=$TOOLCHAIN_LLVM_FILE .. && cmake --build . -j
@@ -80,6 +86,47 @@ pbuild_size() {
 }
 export pbuild_size
 
+# Builds locally into the directory $1 (relative to the project root, f.ex. build_1024) for input size $2
+# Builds of different directories may run concurrently (plots/scraper.py -sizes)
+build_dir_size() {
+    mkdir -p $PROOT/$1 && cd $PROOT/$1 && cmake -DCMAKE_TOOLCHAIN_FILE=$TOOLCHAIN_LLVM_FILE -DLMQ_SIZE=$2 .. && cmake --build . -j
+}
+export build_dir_size
+
+# Builds using docker into the directory $1 for input size $2
+dbuild_dir_size() {
+    mkdir -p $PROOT/$1 && docker run --rm -v $PROOT:/repo -w /repo --name snitch_build_$1 ghcr.io/pulp-platform/snitch /bin/bash ./container_build.sh $1 $2
+}
+export dbuild_dir_size
+
+# Builds using podman into the directory $1 for input size $2
+pbuild_dir_size() {
+    mkdir -p $PROOT/$1 && podman run --rm -v $PROOT:/repo -w /repo --name snitch_build_$1 ghcr.io/pulp-platform/snitch /bin/bash ./container_build.sh $1 $2
+}
+export pbuild_dir_size
+
+# Builds against the vlt simulator into the directory $1 for input size $2 (locally, with docker or podman)
+build_sim_dir_size() {
+    mkdir -p $PROOT/$1 && cd $PROOT/$1 && cmake -DCMAKE_TOOLCHAIN_FILE=$TOOLCHAIN_LLVM_FILE -DCLUSTER_SIM=1 -DLMQ_SIZE=$2 .. && cmake --build . -j
+}
+export build_sim_dir_size
+
+dbuild_sim_dir_size() {
+    mkdir -p $PROOT/$1 && docker run --rm -v $PROOT:/repo -w /repo --name snitch_build_$1 ghcr.io/pulp-platform/snitch /bin/bash ./container_build.sh $1 $2 -DCLUSTER_SIM=1
+}
+export dbuild_sim_dir_size
+
+pbuild_sim_dir_size() {
+    mkdir -p $PROOT/$1 && podman run --rm -v $PROOT:/repo -w /repo --name snitch_build_$1 ghcr.io/pulp-platform/snitch /bin/bash ./container_build.sh $1 $2 -DCLUSTER_SIM=1
+}
+export pbuild_sim_dir_size
+
+# Runs using the vlt simulator (binaries of build_sim*)
+run_sim() {
+    $SIM $1
+}
+export run_sim
+
 # Remove all built files
 alias clean='rm -r "$PROOT"build/*'
 
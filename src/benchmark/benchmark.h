@@ -5,6 +5,9 @@
 #include <snrt.h>
 #include "printf.h"
 #include <math.h>
+#include <stdarg.h>
+
+#include "lmq.h"
 
 #ifndef LMQ_START_SIZE
 #define LMQ_START_SIZE 10
@@ -19,10 +22,95 @@
 #define LMQ_RUNS 20
 #endif
 
+// Untimed runs before the LMQ_RUNS timed runs of the BENCH_STATS macros
+#ifndef LMQ_WARMUP
+#define LMQ_WARMUP 2
+#endif
+
 size_t* cycles_count;
 
 volatile size_t size = LMQ_SIZE;
 volatile size_t runs = LMQ_RUNS;
+volatile size_t warmup = LMQ_WARMUP;
+
+/*
+ * Records: with LMQ_RECORD every measurement is additionally printed as one line of space separated
+ * key=value fields after LMQ_RECORD_PREFIX, which plots/scraper.py parses without knowing the fields:
+ *     @lmq op=gemm variant=ssr_frep_parallel size=1024 M=16 N=64 K=16 cores=8 cycles=12345 rc=0
+ * op and variant are split from the function name at the first variant word (bench_variants).
+ * The shape fields are the ones of the last bench_shape, the fields after cores depend on the macro.
+ */
+#define LMQ_RECORD_PREFIX "@lmq"
+
+#define BENCH_MAX_SHAPE 8
+
+const char* bench_shape_names[BENCH_MAX_SHAPE];
+size_t bench_shape_values[BENCH_MAX_SHAPE];
+size_t bench_shape_num = 0;
+
+/*
+ * Sets the shape parameters of the following measurements as num pairs of a name and a size_t value,
+ * f.ex. bench_shape(3, "M", M, "N", N, "K", K). bench_shape(0) clears them.
+ */
+static inline void bench_shape(size_t num, ...) {
+    va_list args;
+    va_start(args, num);
+    bench_shape_num = num < BENCH_MAX_SHAPE ? num : BENCH_MAX_SHAPE;
+    for (size_t i = 0; i < bench_shape_num; i++) {
+        bench_shape_names[i] = va_arg(args, const char*);
+        bench_shape_values[i] = va_arg(args, size_t);
+    }
+    va_end(args);
+}
+
+// The words which start the variant part of a function name
+const char* bench_variants[] = {"baseline", "ssr", "parallel", "omp", "lut", "tiled", "blocked", "dma",
+                                "snitch", "winograd", "dispatch", "unfused", "naive", "fused", "graph", "task"};
+
+// Length of the op part of name: up to the '_' before the first variant word
+static inline size_t bench_op_len(const char* name) {
+    for (size_t i = 0; name[i] != '\0'; i++) {
+        if (name[i] != '_') {
+            continue;
+        }
+        for (size_t v = 0; v < sizeof(bench_variants) / sizeof(bench_variants[0]); v++) {
+            const char* word = bench_variants[v];
+            size_t j = 0;
+            while (word[j] != '\0' && name[i + 1 + j] == word[j]) {
+                j++;
+            }
+            if (word[j] == '\0' && (name[i + 1 + j] == '_' || name[i + 1 + j] == '\0')) {
+                return i;
+            }
+        }
+    }
+    return (size_t) -1;
+}
+
+// Prints the fields up to cores, the caller ends the line
+static inline void bench_record_begin(const char* name, size_t n, size_t cores) {
+    size_t op_len = bench_op_len(name);
+    if (op_len == (size_t) -1) {
+        printf(LMQ_RECORD_PREFIX " op=%s variant=", name);
+    } else {
+        printf(LMQ_RECORD_PREFIX " op=%.*s variant=%s", op_len, name, name + op_len + 1);
+    }
+    printf(" size=%d", n);
+    for (size_t i = 0; i < bench_shape_num; i++) {
+        printf(" %s=%d", bench_shape_names[i], bench_shape_values[i]);
+    }
+    printf(" cores=%d", cores);
+}
+
+#ifdef LMQ_RECORD
+#define BENCH_RECORD(name, n, cores, format, ...)       \
+    do {                                                \
+        bench_record_begin(name, n, cores);             \
+        printf(format "\n", __VA_ARGS__);               \
+    } while(0)
+#else
+#define BENCH_RECORD(name, n, cores, format, ...)
+#endif
 
 /*
  * Benchmarks a function with a single double output and prints the result.
@@ -40,6 +128,7 @@ volatile size_t runs = LMQ_RUNS;
         if (snrt_cluster_core_idx() == 0) {             \
             printf(#func_name", size: %d: %lu cycles. Return code: %d\n", \
                 size, _end_ - _start_, _result_code_); \
+            BENCH_RECORD(#func_name, size, 1, " cycles=%lu rc=%d", _end_ - _start_, _result_code_); \
         }                                           \
     } while(0);
 
@@ -55,12 +144,51 @@ volatile size_t runs = LMQ_RUNS;
             size_t _end_ = read_csr(mcycle);                \
             printf(#func_name", size: %d: %lu cycles. Return code: %d\n", \
                     size, _end_ - _start_, _result_code_);        \
+            BENCH_RECORD(#func_name, size, snrt_cluster_core_num() - 1, " run=%d cycles=%lu rc=%d", \
+                    cur_run, _end_ - _start_, _result_code_);     \
         }                                           \
     } while(0);
 
+#ifndef LMQ_MAX_CORES
+#define LMQ_MAX_CORES 16
+#endif
+
+// Cycles every core spent inside func_name and waiting in the barriers in the last BENCH_VO_PARALLEL*
+size_t core_cycles[LMQ_MAX_CORES];
+size_t core_barrier_wait[LMQ_MAX_CORES];
+
+/*
+ * Prints the load balance of the last BENCH_VO_PARALLEL over the compute cores 0..cores-1: max, min and
+ * mean of the cycles inside the function, max and mean of the barrier wait, the share of the timed cycles
+ * the compute cores were idle in the barriers and the wait of the DM core (index cores).
+ */
+static inline void bench_imbalance_print(const char* name, size_t n, size_t cores) {
+    size_t max = 0, min = (size_t)-1, wait_max = 0;
+    double mean = 0.0, wait_mean = 0.0, total = 0.0;
+    for (size_t c = 0; c < cores; c++) {
+        max = core_cycles[c] > max ? core_cycles[c] : max;
+        min = core_cycles[c] < min ? core_cycles[c] : min;
+        wait_max = core_barrier_wait[c] > wait_max ? core_barrier_wait[c] : wait_max;
+        mean += core_cycles[c];
+        wait_mean += core_barrier_wait[c];
+        total += core_cycles[c] + core_barrier_wait[c];
+    }
+    double idle = total > 0.0 ? 100.0 * wait_mean / total : 0.0;
+    mean /= cores;
+    wait_mean /= cores;
+    printf("%s imbalance, size: %d: compute max %lu, min %lu, mean %.1f, barrier wait max %lu, mean %.1f, "
+           "idle %.1f%%, dm wait %lu\n", name, n, max, min, mean, wait_max, wait_mean, idle,
+           core_barrier_wait[cores]);
+    BENCH_RECORD(name, n, cores, " imbalance=1 compute_max=%lu compute_min=%lu compute_mean=%.1f wait_max=%lu "
+                 "wait_mean=%.1f idle=%.1f dm_wait=%lu", max, min, mean, wait_max, wait_mean, idle,
+                 core_barrier_wait[cores]);
+}
+
 /*
  * Benchmarks a vector operation which has no single result.
  * Is deterministic as long as no software barriers are used.
+ * Every core stores its cycles inside func_name and in the barriers, after a third (untimed) barrier
+ * core 0 prints them with bench_imbalance_print.
  */
 #define BENCH_VO_PARALLEL(func_name, ...)               \
     do {                                                \
@@ -75,37 +203,379 @@ volatile size_t runs = LMQ_RUNS;
         size_t _end_ = read_csr(mcycle);                \
         size_t cycles = _end_ - _start_;                \
         size_t cycles2 = _end2_ - _start2_;             \
-        /* printf("core %d inner: %d\n", core_idx, cycles2);*/ \
-        /* printf("core %d outer: %d\n", core_idx, cycles); */ \
-        /* for debugging purposes */                    \
-        /* printf("(%d): %d\n ", snrt_cluster_core_idx(), cycles);                                      */  \
-        if (snrt_cluster_core_idx() == 0) {             \
+        core_cycles[core_idx] = cycles2;                \
+        core_barrier_wait[core_idx] = cycles - cycles2; \
+        snrt_cluster_hw_barrier();                      \
+        if (core_idx == 0) {                            \
             printf(#func_name", size: %d: %lu cycles. Return code: %d\n", \
                     size, cycles, _result_code_);       \
+            BENCH_RECORD(#func_name, size, core_num, " cycles=%lu rc=%d", cycles, _result_code_); \
+            bench_imbalance_print(#func_name, size, core_num); \
+        }                                               \
+    } while(0);
+
+/*
+ * Cycles of the timed runs of the last BENCH_STATS*.
+ */
+size_t bench_samples[LMQ_RUNS];
+
+/*
+ * Prints the summary of the count samples: the median as the cycles (which plots/scraper.py reads
+ * like the cycles of BENCH_VO) followed by min, mean and standard deviation.
+ * Sorts samples.
+ */
+static inline void bench_report(const char* name, size_t n, size_t cores, int result_code, size_t* samples,
+                                size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    double mean = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        size_t v = samples[i];
+        size_t j = i;
+        for (; j > 0 && samples[j - 1] > v; j--) {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = v;
+        mean += v;
+    }
+    mean /= count;
+
+    double var = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        var += (samples[i] - mean) * (samples[i] - mean);
+    }
+    var /= count;
+
+    // Cycle variances reach millions, sqrt_fast is accurate for any of them
+    double stddev = sqrt_fast(var);
+
+    size_t median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    printf("%s, size: %d: %lu cycles. Return code: %d. min %lu, mean %.1f, stddev %.1f, runs %d\n",
+           name, n, median, result_code, samples[0], mean, stddev, count);
+    BENCH_RECORD(name, n, cores, " cycles=%lu rc=%d min=%lu median=%lu mean=%.1f stddev=%.1f runs=%d",
+                 median, result_code, samples[0], median, mean, stddev, count);
+}
+
+/*
+ * BENCH_VO, BENCH_VO_PARALLEL and BENCH_VO_OMP with warmup untimed runs followed by runs timed runs
+ * (LMQ_WARMUP and LMQ_RUNS), summarised by bench_report. func_name must give the same result every
+ * run, f.ex. it must not work in place. The parallel version must be called by all cores and times
+ * every run from barrier to barrier like BENCH_VO_PARALLEL.
+ * cores is the number of cores func_name runs on, for the records.
+ */
+#define BENCH_STATS_SERIAL(func_name, cores, ...)       \
+    do {                                                \
+        int _result_code_ = 0;                          \
+        for (size_t _run_ = 0; _run_ < warmup + runs; _run_++) { \
+            size_t _start_ = read_csr(mcycle);          \
+            _result_code_ = func_name(__VA_ARGS__);     \
+            size_t _end_ = read_csr(mcycle);            \
+            if (_run_ >= warmup) {                      \
+                bench_samples[_run_ - warmup] = _end_ - _start_; \
+            }                                           \
+        }                                               \
+        if (snrt_cluster_core_idx() == 0) {             \
+            bench_report(#func_name, size, cores, _result_code_, bench_samples, runs); \
+        }                                               \
+    } while(0);
+
+#define BENCH_STATS(func_name, ...) BENCH_STATS_SERIAL(func_name, 1, __VA_ARGS__)
+
+#define BENCH_STATS_PARALLEL(func_name, ...)            \
+    do {                                                \
+        int _result_code_ = 0;                          \
+        for (size_t _run_ = 0; _run_ < warmup + runs; _run_++) { \
+            size_t _start_ = read_csr(mcycle);          \
+            snrt_cluster_hw_barrier();                  \
+            _result_code_ = func_name(__VA_ARGS__);     \
+            snrt_cluster_hw_barrier();                  \
+            size_t _end_ = read_csr(mcycle);            \
+            if (_run_ >= warmup && snrt_cluster_core_idx() == 0) { \
+                bench_samples[_run_ - warmup] = _end_ - _start_; \
+            }                                           \
+        }                                               \
+        if (snrt_cluster_core_idx() == 0) {             \
+            bench_report(#func_name, size, snrt_cluster_core_num() - 1, _result_code_, bench_samples, runs); \
+        }                                               \
+    } while(0);
+
+// Under OMP only the main thread runs the benchmark
+#define BENCH_STATS_OMP(func_name, ...) BENCH_STATS_SERIAL(func_name, snrt_cluster_core_num() - 1, __VA_ARGS__)
+
+/*
+ * With LMQ_STATS the BENCH_VO macros of all benchmarks report statistics instead of a single run.
+ */
+#ifdef LMQ_STATS
+#undef BENCH_VO
+#undef BENCH_VO_PARALLEL
+#undef BENCH_VO_OMP
+#define BENCH_VO(func_name, ...) BENCH_STATS(func_name, __VA_ARGS__)
+#define BENCH_VO_PARALLEL(func_name, ...) BENCH_STATS_PARALLEL(func_name, __VA_ARGS__)
+#define BENCH_VO_OMP(func_name, ...) BENCH_STATS_OMP(func_name, __VA_ARGS__)
+#endif
+
+/*
+ * Like BENCH_VO_PARALLEL, but core 0 additionally prints the cycles every core
+ * spent inside func_name, f.ex. to check the load balance.
+ */
+#define BENCH_VO_PARALLEL_CORES(func_name, ...)         \
+    do {                                                \
+        size_t _start_ = read_csr(mcycle);              \
+        snrt_cluster_hw_barrier();                      \
+        size_t _start2_ = read_csr(mcycle);             \
+        int _result_code_ = func_name(__VA_ARGS__);     \
+        size_t _end2_ = read_csr(mcycle);               \
+        core_cycles[snrt_cluster_core_idx()] = _end2_ - _start2_; \
+        snrt_cluster_hw_barrier();                      \
+        size_t _end_ = read_csr(mcycle);                \
+        if (snrt_cluster_core_idx() == 0) {             \
+            printf(#func_name", size: %d: %lu cycles. Return code: %d\n", \
+                    size, _end_ - _start_, _result_code_); \
+            BENCH_RECORD(#func_name, size, snrt_cluster_core_num() - 1, " cycles=%lu rc=%d", \
+                    _end_ - _start_, _result_code_);    \
+            for (size_t _c_ = 0; _c_ < snrt_cluster_core_num() - 1; _c_++) { \
+                printf(#func_name" (core %d), size: %d: %lu cycles\n", \
+                        _c_, size, core_cycles[_c_]);   \
+                BENCH_RECORD(#func_name, size, snrt_cluster_core_num() - 1, " core=%d cycles=%lu", \
+                        _c_, core_cycles[_c_]);         \
+            }                                           \
+        }                                               \
+    } while(0);
+
+/*
+ * Benchmarks a multi-cluster operation (see src/lmq/multi.h) on clusters clusters, from global barrier to
+ * global barrier. Must be called by all cores of all clusters. Global core 0 prints the cycles as
+ * "func_name (clusters c)" and, with all clusters, also as the plain line plots/scraper.py reads. The records
+ * carry clusters=c, the scraper only takes the run on the most clusters as the runtime.
+ */
+#define BENCH_VO_MULTI(func_name, clusters, ...)        \
+    do {                                                \
+        size_t _start_ = read_csr(mcycle);              \
+        snrt_global_barrier();                          \
+        int _result_code_ = func_name(__VA_ARGS__);     \
+        snrt_global_barrier();                          \
+        size_t _end_ = read_csr(mcycle);                \
+        if (snrt_global_core_idx() == 0) {              \
+            printf(#func_name" (clusters %d), size: %d: %lu cycles. Return code: %d\n", \
+                    clusters, size, _end_ - _start_, _result_code_); \
+            BENCH_RECORD(#func_name, size, (clusters) * (snrt_cluster_core_num() - 1), \
+                    " clusters=%d cycles=%lu rc=%d", clusters, _end_ - _start_, _result_code_); \
+            if ((clusters) == snrt_cluster_num()) {     \
+                printf(#func_name", size: %d: %lu cycles. Return code: %d\n", \
+                        size, _end_ - _start_, _result_code_); \
+            }                                           \
         }                                               \
-                                                    \
     } while(0);
 
+// Events of every core in the last BENCH_VO*_PERF
+perf_counters_t perf_cores[LMQ_MAX_CORES];
+
+// perf_print and its record
+static inline void bench_perf_print(const char* name, size_t n, size_t cores, size_t core_idx,
+                                    const perf_counters_t* counters) {
+    perf_print(name, n, core_idx, counters);
+    BENCH_RECORD(name, n, cores, " core=%d cycles=%lu fpu_issued=%lu retired=%lu tcdm_accessed=%lu "
+                 "tcdm_congested=%lu dma_busy=%lu barrier_wait=%lu", core_idx, counters->cycles,
+                 counters->fpu_issued, counters->retired, counters->tcdm_accessed, counters->tcdm_congested,
+                 counters->dma_busy, counters->barrier_wait);
+}
+
+/*
+ * BENCH_VO, BENCH_VO_OMP and BENCH_VO_PARALLEL which additionally print the events of every core
+ * (perf_print in src/lmq/lmq.h) after the cycle line. The two cluster counters count two events of
+ * one core per run, so func_name runs PERF_PASSES times per core and must give the same result every run.
+ * BENCH_VO_PERF counts the calling core, BENCH_VO_OMP_PERF the compute cores.
+ */
+#define BENCH_PERF_SERIAL(func_name, first_core, num_cores, ...)    \
+    do {                                                \
+        int _result_code_ = 0;                          \
+        for (size_t _core_ = (first_core); _core_ < (first_core) + (num_cores); _core_++) { \
+            perf_cores[_core_] = (perf_counters_t){0};  \
+            for (size_t _pass_ = 0; _pass_ < PERF_PASSES - 1; _pass_++) { \
+                perf_start(_pass_, _core_);             \
+                size_t _start_ = read_csr(mcycle);      \
+                _result_code_ = func_name(__VA_ARGS__); \
+                size_t _end_ = read_csr(mcycle);        \
+                perf_stop(_pass_, &perf_cores[_core_]); \
+                if (_pass_ == 0) {                      \
+                    perf_cores[_core_].cycles = _end_ - _start_; \
+                }                                       \
+            }                                           \
+        }                                               \
+        printf(#func_name", size: %d: %lu cycles. Return code: %d\n", \
+                size, perf_cores[first_core].cycles, _result_code_); \
+        BENCH_RECORD(#func_name, size, num_cores, " cycles=%lu rc=%d", perf_cores[first_core].cycles, _result_code_); \
+        for (size_t _core_ = (first_core); _core_ < (first_core) + (num_cores); _core_++) { \
+            bench_perf_print(#func_name, size, num_cores, _core_, &perf_cores[_core_]); \
+        }                                               \
+    } while(0);
+
+#define BENCH_VO_PERF(func_name, ...)                   \
+    BENCH_PERF_SERIAL(func_name, snrt_cluster_core_idx(), 1, __VA_ARGS__)
+
+// Under OMP the cycles of every core are the ones of the whole call
+#define BENCH_VO_OMP_PERF(func_name, ...)               \
+    BENCH_PERF_SERIAL(func_name, 0, snrt_cluster_core_num() - 1, __VA_ARGS__)
+
+/*
+ * Must be called by all cores. The DM core is counted too, with the cycles its DMA was busy.
+ * The first run of every core also takes the cycles and barrier wait of all cores.
+ */
+#define BENCH_VO_PARALLEL_PERF(func_name, ...)          \
+    do {                                                \
+        size_t _cores_ = snrt_cluster_core_num();       \
+        size_t _cycles_ = 0;                            \
+        int _result_code_ = 0;                          \
+        if (snrt_cluster_core_idx() == 0) {             \
+            for (size_t _c_ = 0; _c_ < _cores_; _c_++) { \
+                perf_cores[_c_] = (perf_counters_t){0}; \
+            }                                           \
+        }                                               \
+        for (size_t _core_ = 0; _core_ < _cores_; _core_++) { \
+            /* the last pass counts the DMA, which only the DM core (the last one) drives */ \
+            size_t _passes_ = _core_ == _cores_ - 1 ? PERF_PASSES : PERF_PASSES - 1; \
+            for (size_t _pass_ = 0; _pass_ < _passes_; _pass_++) { \
+                snrt_cluster_hw_barrier();              \
+                if (snrt_cluster_core_idx() == 0) {     \
+                    perf_start(_pass_, _core_);         \
+                }                                       \
+                snrt_cluster_hw_barrier();              \
+                size_t _start_ = read_csr(mcycle);      \
+                _result_code_ = func_name(__VA_ARGS__); \
+                size_t _end_ = read_csr(mcycle);        \
+                snrt_cluster_hw_barrier();              \
+                size_t _end2_ = read_csr(mcycle);       \
+                if (snrt_cluster_core_idx() == 0) {     \
+                    perf_stop(_pass_, &perf_cores[_core_]); \
+                }                                       \
+                if (_core_ == 0 && _pass_ == 0) {       \
+                    perf_cores[snrt_cluster_core_idx()].cycles = _end_ - _start_; \
+                    perf_cores[snrt_cluster_core_idx()].barrier_wait = _end2_ - _end_; \
+                    _cycles_ = _end2_ - _start_;        \
+                }                                       \
+            }                                           \
+        }                                               \
+        snrt_cluster_hw_barrier();                      \
+        if (snrt_cluster_core_idx() == 0) {             \
+            printf(#func_name", size: %d: %lu cycles. Return code: %d\n", \
+                    size, _cycles_, _result_code_);     \
+            BENCH_RECORD(#func_name, size, _cores_ - 1, " cycles=%lu rc=%d", _cycles_, _result_code_); \
+            for (size_t _c_ = 0; _c_ < _cores_; _c_++) { \
+                bench_perf_print(#func_name, size, _cores_ - 1, _c_, &perf_cores[_c_]); \
+            }                                           \
+        }                                               \
+    } while(0);
+
+/*
+ * With LMQ_PERF the BENCH_VO macros of all benchmarks print the events of every core.
+ */
+#ifdef LMQ_PERF
+#undef BENCH_VO
+#undef BENCH_VO_PARALLEL
+#undef BENCH_VO_OMP
+#define BENCH_VO(func_name, ...) BENCH_VO_PERF(func_name, __VA_ARGS__)
+#define BENCH_VO_PARALLEL(func_name, ...) BENCH_VO_PARALLEL_PERF(func_name, __VA_ARGS__)
+#define BENCH_VO_OMP(func_name, ...) BENCH_VO_OMP_PERF(func_name, __VA_ARGS__)
+#endif
+
+/*
+ * Runs the reference func_name of a benchmark, which writes its output to ref. With LMQ_GOLDEN the output of
+ * func_name for the current size is copied from the golden references instead (golden_data.h of the host build,
+ * see src/lmq/golden.h), so the simulator only runs the optimized versions. Without a reference for the size
+ * func_name is benchmarked as without LMQ_GOLDEN. ref is a double or an int (argmax) pointer.
+ */
+#ifdef LMQ_GOLDEN
+#include "golden_data.h"
+
+#define BENCH_REF(ref, func_name, ...)                  \
+    do {                                                \
+        const golden_t* _golden_ = golden_find(golden_table, GOLDEN_COUNT, #func_name, size); \
+        if (_golden_ == NULL) {                         \
+            BENCH_VO(func_name, __VA_ARGS__);           \
+        } else {                                        \
+            for (size_t _i_ = 0; _i_ < _golden_->n; _i_++) { \
+                (ref)[_i_] = _golden_->data[_i_];       \
+            }                                           \
+        }                                               \
+    } while(0);
+#else
+#define BENCH_REF(ref, func_name, ...) BENCH_VO(func_name, __VA_ARGS__)
+#endif
+
 #define VERIFY_INT(value, reference, ...)           \
     do { if (value != reference) {                  \
         printf(__VA_ARGS__);                        \
     } } while(0);
 
 #define VERIFY_INT_APPROX(value, reference, ...)           \
-    do { if (value - reference > reference*0.0005) {                  \
+    do { if (fabs((value) - (reference)) > fabs(reference)*0.0005) {  \
         printf(__VA_ARGS__);                        \
     } } while(0);
 
+/*
+ * The verify_vector functions print the first LMQ_MAX_MISMATCHES mismatches and then only their number,
+ * printing every element of a long vector slows the simulation down a lot.
+ */
+#ifndef LMQ_MAX_MISMATCHES
+#define LMQ_MAX_MISMATCHES 8
+#endif
+
+static inline void verify_summary(const size_t mismatches) {
+    if (mismatches > LMQ_MAX_MISMATCHES) {
+        printf("... %d mismatches in total\n", mismatches);
+    }
+}
+
 /*
  * Compares the vector starting at value element wise with the vector at reference.
     Prints if they do not match.
  */
 static inline void verify_vector(const double* value, const double* reference, const size_t n) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (value[i] != reference[i] && mismatches++ < LMQ_MAX_MISMATCHES) {
+            printf("MISMATCH at i=%d: expected %.10f, but got %.10f\n", i, reference[i], value[i]);
+        }
+    }
+    verify_summary(mismatches);
+};
+
+/*
+ * verify_vector for float32 vectors.
+ */
+static inline void verify_vector_f32(const float* value, const float* reference, const size_t n) {
+    size_t mismatches = 0;
     for (size_t i = 0; i < n; ++i) {
-        if (value[i] != reference[i]) {
+        if (value[i] != reference[i] && mismatches++ < LMQ_MAX_MISMATCHES) {
             printf("MISMATCH at i=%d: expected %.10f, but got %.10f\n", i, reference[i], value[i]);
         }
     }
+    verify_summary(mismatches);
+};
+
+/*
+ * verify_vector for int8 and int32 vectors (f.ex. of the quantized kernels of src/onnx/quant.h).
+ */
+static inline void verify_vector_i8(const int8_t* value, const int8_t* reference, const size_t n) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (value[i] != reference[i] && mismatches++ < LMQ_MAX_MISMATCHES) {
+            printf("MISMATCH at i=%d: expected %d, but got %d\n", i, reference[i], value[i]);
+        }
+    }
+    verify_summary(mismatches);
+};
+
+static inline void verify_vector_i32(const int32_t* value, const int32_t* reference, const size_t n) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (value[i] != reference[i] && mismatches++ < LMQ_MAX_MISMATCHES) {
+            printf("MISMATCH at i=%d: expected %d, but got %d\n", i, reference[i], value[i]);
+        }
+    }
+    verify_summary(mismatches);
 };
 
 /*
@@ -113,11 +583,119 @@ static inline void verify_vector(const double* value, const double* reference, c
     Prints if they do not match.
  */
 static inline void verify_vector_approx(const double* value, const double* reference, const size_t n) {
+    size_t mismatches = 0;
     for (size_t i = 0; i < n; ++i) {
-        if (fabs(value[i] - reference[i]) > reference[i]*0.0005) {
+        if (fabs(value[i] - reference[i]) > fabs(reference[i])*0.0005 && mismatches++ < LMQ_MAX_MISMATCHES) {
             printf("MISMATCH at i=%d: expected %.10f, but got %.10f\n", i, reference[i], value[i]);
         }
     }
+    verify_summary(mismatches);
+};
+
+/*
+ * Accuracy of an approximation: ULP distance and relative error against the reference. The mismatches are the
+ * elements with |value - reference| > tolerance * max(|reference|, 1), i.e. a relative bound which becomes an
+ * absolute one below 1; NaN against a number is a mismatch too.
+ */
+#ifndef LMQ_ACCURACY_INDICES
+#define LMQ_ACCURACY_INDICES 4
+#endif
+
+typedef struct {
+    double max_ulp;
+    double mean_ulp;
+    double max_rel;
+    double mean_rel;
+    double max_abs;
+    size_t mismatches;
+    size_t first[LMQ_ACCURACY_INDICES];
+} accuracy_t;
+
+// Maps the bits of x to integers which are ordered like the doubles, -0.0 and 0.0 map to 0
+static inline int64_t ulp_order(double x) {
+    union { double d; int64_t i; } u = { .d = x };
+    return u.i < 0 ? INT64_MIN - u.i : u.i;
+}
+
+static inline int32_t ulp_order_f32(float x) {
+    union { float f; int32_t i; } u = { .f = x };
+    return u.i < 0 ? INT32_MIN - u.i : u.i;
+}
+
+// Adds the element at i with the error err (in ULP) to acc, NaN only against NaN
+static inline void accuracy_add(accuracy_t* acc, size_t i, double value, double reference, double ulp, double tolerance) {
+    double err = fabs(value - reference);
+    double rel = reference != 0.0 ? err / fabs(reference) : err;
+    int nan = isnan(value) || isnan(reference);
+    if (nan && !(isnan(value) && isnan(reference))) {
+        err = rel = ulp = INFINITY;
+    } else if (nan) {
+        err = rel = ulp = 0.0;
+    }
+
+    acc->max_ulp = fmax(acc->max_ulp, ulp);
+    acc->mean_ulp += ulp;
+    acc->max_rel = fmax(acc->max_rel, rel);
+    acc->mean_rel += rel;
+    acc->max_abs = fmax(acc->max_abs, err);
+    if (err > tolerance * fmax(fabs(reference), 1.0)) {
+        if (acc->mismatches < LMQ_ACCURACY_INDICES) {
+            acc->first[acc->mismatches] = i;
+        }
+        acc->mismatches++;
+    }
+}
+
+// Prints acc of n elements as one line (and a record under LMQ_RECORD)
+static inline void accuracy_print(const char* name, const size_t n, accuracy_t* acc) {
+    acc->mean_ulp /= n > 0 ? n : 1;
+    acc->mean_rel /= n > 0 ? n : 1;
+    printf("%s accuracy, size: %d: max ulp %.0f, mean ulp %.2f, max rel %e, mean rel %e, max abs %e, mismatches %d",
+           name, n, acc->max_ulp, acc->mean_ulp, acc->max_rel, acc->mean_rel, acc->max_abs, acc->mismatches);
+    if (acc->mismatches > 0) {
+        printf(" (at");
+        for (size_t i = 0; i < acc->mismatches && i < LMQ_ACCURACY_INDICES; i++) {
+            printf(" %d", acc->first[i]);
+        }
+        printf(")");
+    }
+    printf("\n");
+    BENCH_RECORD(name, n, 1, " max_ulp=%.0f mean_ulp=%.2f max_rel=%e mean_rel=%e max_abs=%e mismatches=%d",
+                 acc->max_ulp, acc->mean_ulp, acc->max_rel, acc->mean_rel, acc->max_abs, acc->mismatches);
+}
+
+/*
+ * Prints the accuracy of the vector at value against the vector at reference as
+ * "<name> accuracy, size: <n>: max ulp .., mean ulp .., max rel .., mean rel .., max abs .., mismatches .. (at i ..)".
+ * report_accuracy_f32 counts the ULP of floats.
+ */
+static inline void report_accuracy(const char* name, const double* value, const double* reference, const size_t n,
+                                   const double tolerance) {
+    accuracy_t acc = {0};
+    for (size_t i = 0; i < n; ++i) {
+        int64_t a = ulp_order(value[i]);
+        int64_t b = ulp_order(reference[i]);
+        double ulp = a > b ? (double) ((uint64_t) a - (uint64_t) b) : (double) ((uint64_t) b - (uint64_t) a);
+        accuracy_add(&acc, i, value[i], reference[i], ulp, tolerance);
+    }
+    accuracy_print(name, n, &acc);
+};
+
+static inline void report_accuracy_f32(const char* name, const float* value, const float* reference, const size_t n,
+                                       const double tolerance) {
+    accuracy_t acc = {0};
+    for (size_t i = 0; i < n; ++i) {
+        int32_t a = ulp_order_f32(value[i]);
+        int32_t b = ulp_order_f32(reference[i]);
+        double ulp = a > b ? (double) ((uint32_t) a - (uint32_t) b) : (double) ((uint32_t) b - (uint32_t) a);
+        accuracy_add(&acc, i, value[i], reference[i], ulp, tolerance);
+    }
+    accuracy_print(name, n, &acc);
+};
+
+// report_accuracy with the tolerance of verify_vector_approx
+static inline void report_error(const char* name, const double* value, const double* reference, const size_t n) {
+    report_accuracy(name, value, reference, n, 0.0005);
 };
 
 /*
@@ -125,11 +703,13 @@ static inline void verify_vector_approx(const double* value, const double* refer
     Prints if they do not match.
  */
 static inline void verify_vector_int(const int* value, const int* reference, const size_t n) {
+    size_t mismatches = 0;
     for (size_t i = 0; i < n; ++i) {
-        if (value[i] != reference[i]) {
+        if (value[i] != reference[i] && mismatches++ < LMQ_MAX_MISMATCHES) {
             printf("At i=%d: expected %.10i, but got %.10i\n", i, reference[i], value[i]);
         }
     }
+    verify_summary(mismatches);
 };
 
 /*
@@ -6,12 +6,17 @@
 #include "benchmark.h"
 
 double *x, *result, *result_ref;
+float *xf, *result_f, *result_ref_f;
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
     uint32_t core_num = snrt_cluster_core_num() - 1; // -1 as there is one DM core
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         // benchmark ssr+frep on a single core
         printf("Running benchmark_abs\n");
 
@@ -28,6 +33,20 @@ int main() {
         BENCH_VO(fabs_ssr_frep, x, size, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        // float32 (packed SIMD)
+        xf = allocate(size, sizeof(float));
+        result_ref_f = allocate(size, sizeof(float));
+        result_f = allocate(size, sizeof(float));
+
+        for (size_t i = 0; i < size; i++) {
+            xf[i] = (float)i - (float)size / 2;
+        }
+
+        BENCH_VO(fabs_baseline_f32, xf, size, result_ref_f);
+
+        BENCH_VO(fabs_ssr_frep_f32, xf, size, result_f);
+        verify_vector_f32(result_f, result_ref_f, size);
     }
 
     snrt_cluster_hw_barrier();
@@ -52,6 +71,12 @@ int main() {
             verify_vector(result, result_ref, size);
             clear_vector(result, size);
         }
+
+        BENCH_VO_PARALLEL(fabs_ssr_frep_tiled, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
     }
 
     // Benchmark OMP
@@ -33,11 +33,51 @@ int main() {
 
         BENCH_VO(acos_baseline, x, size, result_ref);
         
+        // The baseline is float precision, the ssr versions are double precision
         BENCH_VO(acos_ssr, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(acos_ssr_frep, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    BENCH_VO_PARALLEL(acos_parallel, x, size, result);
+    if (core_idx == 0) {
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
     }
 
+    BENCH_VO_PARALLEL(acos_ssr_parallel, x, size, result);
+    if (core_idx == 0) {
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    BENCH_VO_PARALLEL(acos_ssr_frep_parallel, x, size, result);
+    if (core_idx == 0) {
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    BENCH_VO_OMP(acos_omp, x, size, result);
+    verify_vector(result, result_ref, size);
+    clear_vector(result, size);
+
+    BENCH_VO_OMP(acos_ssr_omp, x, size, result);
+    verify_vector_approx(result, result_ref, size);
+    clear_vector(result, size);
+
+    BENCH_VO_OMP(acos_ssr_frep_omp, x, size, result);
+    verify_vector_approx(result, result_ref, size);
+    clear_vector(result, size);
+
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
-
@@ -4,9 +4,11 @@
 #include "lmq.h"
 #include "add.h"
 #include "benchmark.h"
+#include "golden.h"
 #include <math.h>
 
 double *x, *y, *result_ref, *result;
+float *xf, *yf, *result_ref_f, *result_f;
 
 int main() {
     uint32_t core_idx = snrt_cluster_core_idx();
@@ -14,7 +16,11 @@ int main() {
 
     // benchmark ssr+frep on a single core
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_add\n");
 
         // Initialize the input data
@@ -28,7 +34,7 @@ int main() {
             y[i] = (double)i;
         }
         
-        BENCH_VO(add_baseline, x, y, size, result_ref);
+        BENCH_REF(result_ref, add_baseline, x, y, size, result_ref);
 
         BENCH_VO(add_ssr, x, y, size, result);
         verify_vector(result, result_ref, size);
@@ -37,6 +43,22 @@ int main() {
         BENCH_VO(add_ssr_frep, x, y, size, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        // float32 (packed SIMD)
+        xf = allocate(size, sizeof(float));
+        yf = allocate(size, sizeof(float));
+        result_ref_f = allocate(size, sizeof(float));
+        result_f = allocate(size, sizeof(float));
+
+        for (unsigned i = 0; i < size; i++) {
+            xf[i] = (float)i;
+            yf[i] = (float)i;
+        }
+
+        BENCH_VO(add_baseline_f32, xf, yf, size, result_ref_f);
+
+        BENCH_VO(add_ssr_frep_f32, xf, yf, size, result_f);
+        verify_vector_f32(result_f, result_ref_f, size);
     }
 
     snrt_cluster_hw_barrier();
@@ -49,6 +71,11 @@ int main() {
             clear_vector(result, size);
         }
 
+        BENCH_VO_PARALLEL(add_ssr_frep_parallel_f32, xf, yf, size, result_f);
+        if (core_idx == 0){
+            verify_vector_f32(result_f, result_ref_f, size);
+        }
+
         BENCH_VO_PARALLEL(add_ssr_parallel, x, y, size, result);
         if (core_idx == 0){
             verify_vector(result, result_ref, size);
@@ -60,6 +87,12 @@ int main() {
             verify_vector(result, result_ref, size);
             clear_vector(result, size);
         }
+
+        BENCH_VO_PARALLEL(add_ssr_frep_tiled, x, y, size, result);
+        if (core_idx == 0){
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
     }
 
     // ======== Parallel benchmarks with OMP =================
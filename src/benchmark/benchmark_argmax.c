@@ -5,38 +5,44 @@
 #include "lmq.h"
 #include "argmax.h"
 #include "benchmark.h"
+#include "golden.h"
+#include "tile.h"
 
-double *x;
+#define NUM_CLASSES 10
+
+double *x, *x_tiles;
 int result, result_ref;
+int indices[LMQ_SIZE], indices_ref[LMQ_SIZE];
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_argmax\n");
 
         // x is input; result is output of the optimized functions
         x = allocate(size, sizeof(double));
 
-        srandom(2);
-        for (size_t i = 0; core_idx == 0 && i < size; i++) {
-            x[i] = 1.0 * size * (1.0 * random() / __LONG_MAX__);
-        }
+        golden_fill(x, size, 0, size);
 
         // For debugging purposes
         // for (size_t i = 0; i < size; i++) {
         //     printf("Input at index %d is %f\n", i, x[i]);
         // }
 
-        BENCH_VO(argmax_baseline, x, size, &result_ref);
+        BENCH_REF(&result_ref, argmax_baseline, x, size, &result_ref);
         
         BENCH_VO(argmax_ssr, x, size, &result);
         VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d (ref: %f; actual: %f)\n", result_ref, result, x[result_ref], x[result]);
         result = -1;
 
-        // BENCH_VO(argmax_ssr_frep, x, size, &result);
-        // VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
-        // This is expected as no FREP implementation exists (for now)
+        BENCH_VO(argmax_ssr_frep, x, size, &result);
+        VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d (ref: %f; actual: %f)\n", result_ref, result, x[result_ref], x[result]);
+        result = -1;
     }
 
     for (size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
@@ -53,7 +59,88 @@ int main() {
             VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d (ref: %f; actual: %f)\n", result_ref, result, x[result_ref], x[result]);
             result = -1;
         }
+
+        BENCH_VO_PARALLEL(argmax_ssr_frep_parallel, x, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d (ref: %f; actual: %f)\n", result_ref, result, x[result_ref], x[result]);
+            result = -1;
+        }
+
+        BENCH_VO_PARALLEL(argmax_ssr_frep_tiled, x, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d (ref: %f; actual: %f)\n", result_ref, result, x[result_ref], x[result]);
+            result = -1;
+        }
+    }
+
+    /*
+     * A maximum repeated in two tiles of argmax_ssr_frep_tiled: a tile holds about half of the L1 size, the
+     * first maximum is in the part of core 1 of tile 0 and the second in the part of core 0 of tile 1.
+     */
+    size_t tiles_n = LMQ_TILE_L1_SIZE / sizeof(double);
+    size_t first_max = tiles_n / 16 + tiles_n / 32;
+    if (core_idx == 0) {
+        x_tiles = allocate(tiles_n, sizeof(double));
+        for (size_t i = 0; i < tiles_n; i++) {
+            x_tiles[i] = (double) (i % 7);
+        }
+        x_tiles[first_max] = 8.0;
+        x_tiles[tiles_n / 2 + tiles_n / 32] = 8.0;
+        result = -1;
+    }
+    snrt_cluster_hw_barrier();
+    argmax_ssr_frep_tiled(x_tiles, tiles_n, &result);
+    if (core_idx == 0) {
+        VERIFY_INT(result, (int) first_max, "Mismatch: expected %d but got %d (repeated maximum in two tiles)\n",
+                   (int) first_max, result);
+        result = -1;
+    }
+    snrt_cluster_hw_barrier();
+
+    /* ArgMax along an axis of a [batch, classes] tensor */
+    for (size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
+        size_t shape[2] = {size / NUM_CLASSES, NUM_CLASSES};
+        size_t batch = shape[0];
+
+        for (int axis = -1; axis >= -2; axis--) {
+            size_t out_len = axis == -1 ? batch : NUM_CLASSES;
+
+            if (core_idx == 0) {
+                printf("Running benchmark_argmax axis %d of [%d, %d]\n", axis, batch, NUM_CLASSES);
+
+                BENCH_VO(argmax_axis_baseline, x, shape, 2, axis, 0, indices_ref);
+
+                BENCH_VO(argmax_axis_ssr_frep, x, shape, 2, axis, 0, indices);
+                verify_vector_int(indices, indices_ref, out_len);
+
+                BENCH_VO(argmax_axis_ssr_frep, x, shape, 2, axis, 1, indices);
+                verify_vector_int(indices, indices_ref, out_len);
+            }
+            snrt_cluster_hw_barrier();
+
+            BENCH_VO_PARALLEL(argmax_axis_ssr_frep_parallel, x, shape, 2, axis, 0, indices);
+            if (core_idx == 0) {
+                verify_vector_int(indices, indices_ref, out_len);
+            }
+            snrt_cluster_hw_barrier();
+        }
     }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for (size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
+        argmax_baseline(x, size, &result_ref);
+
+        BENCH_VO_OMP(argmax_omp, x, size, &result);
+        VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d (ref: %f; actual: %f)\n", result_ref, result, x[result_ref], x[result]);
+        result = -1;
+
+        BENCH_VO_OMP(argmax_ssr_frep_omp, x, size, &result);
+        VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d (ref: %f; actual: %f)\n", result_ref, result, x[result_ref], x[result]);
+        result = -1;
+    }
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
 
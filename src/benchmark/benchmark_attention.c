@@ -0,0 +1,76 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "attention.h"
+#include "gemm.h"
+#include "softmax.h"
+#include "benchmark.h"
+
+/*
+ * Self attention of HEADS heads of dimension DIM over size / 4 tokens: the fused kernels against
+ * gemm -> softmax -> gemm with the full (seq, seq) score matrix of every head in global memory.
+ */
+#define HEADS 2
+#define DIM 16
+
+double *q, *k, *v, *scores, *probs, *result, *result_ref;
+size_t seq;
+
+static int attention_unfused(double* q, double* k, double* v, size_t heads, size_t seq, size_t d, double scale, double* result) {
+    for (size_t h = 0; h < heads; h++) {
+        gemm_onnx_ssr_frep(q + h * seq * d, k + h * seq * d, NULL, seq, d, seq, 0, 1, scale, 0.0, scores);
+        softmax_ssr_frep(scores, seq, seq, probs);
+        gemm_ssr_frep(probs, v + h * seq * d, seq, seq, d, result + h * seq * d);
+    }
+    return 0;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+    double scale = 0.25; // 1 / sqrt(DIM)
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        seq = size / 4;
+        size_t len = HEADS * seq * DIM;
+        bench_shape(3, "heads", HEADS, "seq", seq, "d", DIM);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            q = allocate(len, sizeof(double));
+            k = allocate(len, sizeof(double));
+            v = allocate(len, sizeof(double));
+            scores = allocate(seq * seq, sizeof(double));
+            probs = allocate(seq * seq, sizeof(double));
+            result = allocate(len, sizeof(double));
+            result_ref = allocate(len, sizeof(double));
+
+            for (size_t i = 0; i < len; i++) {
+                q[i] = (double)(i % 11) / 4.0 - 1.0;
+                k[i] = (double)(i % 7) / 3.0 - 1.0;
+                v[i] = (double)(i % 5) - 2.0;
+            }
+
+            BENCH_VO(attention_baseline, q, k, v, HEADS, seq, seq, DIM, DIM, scale, result_ref);
+
+            // The online softmax sums in a different order
+            BENCH_VO(attention_unfused, q, k, v, HEADS, seq, DIM, scale, result);
+            report_accuracy("attention_unfused", result, result_ref, len, 1e-12);
+            clear_vector(result, len);
+
+            BENCH_VO(attention_ssr_frep, q, k, v, HEADS, seq, seq, DIM, DIM, scale, result);
+            report_accuracy("attention_ssr_frep", result, result_ref, len, 1e-12);
+            clear_vector(result, len);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(attention_ssr_frep_parallel, q, k, v, HEADS, seq, seq, DIM, DIM, scale, result);
+        if (core_idx == 0) {
+            report_accuracy("attention_ssr_frep_parallel", result, result_ref, len, 1e-12);
+            clear_vector(result, len);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "maxpool.h"
+#include "avgpool.h"
+#include "benchmark.h"
+
+double *x, *result_ref, *result;
+
+int main() {
+    uint32_t core_idx = snrt_global_core_idx();
+
+    // channels * n0 * n1 is about size
+    size_t channels = 8;
+    size_t f0 = 3;
+    size_t f1 = 2;
+    size_t s0 = 2;
+    size_t s1 = 2;
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t outn = sqrt_approx(size / channels) / 2 + 1;
+        size_t n0 = (outn - 1) * s0 + f0;
+        size_t n1 = (outn - 1) * s1 + f1;
+        size_t out_len = channels * outn * outn;
+        size_t n = n0 * n1;
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(channels * n, sizeof(double));
+            result_ref = allocate(out_len, sizeof(double));
+            result = allocate(out_len, sizeof(double));
+
+            for (size_t i = 0; i < channels * n; i++) {
+                x[i] = (double)((i * 7) % 13);
+            }
+
+            // AveragePool
+            BENCH_VO(avgpool2d_baseline, x, channels, n0, n1, f0, f1, s0, s1, result_ref);
+
+            BENCH_VO(avgpool2d_ssr_frep, x, channels, n0, n1, f0, f1, s0, s1, result);
+            verify_vector(result, result_ref, out_len);
+            clear_vector(result, out_len);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(avgpool2d_ssr_frep_parallel, x, channels, n0, n1, f0, f1, s0, s1, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, out_len);
+            clear_vector(result, out_len);
+
+            // GlobalAveragePool
+            BENCH_VO(global_avgpool_baseline, x, channels, n, result_ref);
+
+            BENCH_VO(global_avgpool_ssr_frep, x, channels, n, result);
+            verify_vector(result, result_ref, channels);
+            clear_vector(result, channels);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(global_avgpool_ssr_frep_parallel, x, channels, n, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, channels);
+            clear_vector(result, channels);
+
+            // GlobalMaxPool
+            BENCH_VO(global_maxpool_baseline, x, channels, n, result_ref);
+
+            BENCH_VO(global_maxpool_ssr_frep, x, channels, n, result);
+            verify_vector(result, result_ref, channels);
+            clear_vector(result, channels);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(global_maxpool_ssr_frep_parallel, x, channels, n, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, channels);
+            clear_vector(result, channels);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "fpmath.h"
+#include "benchmark.h"
+
+/*
+ * Bandwidth of the memory hierarchy: 1 to 8 compute cores with scalar loads and stores, SSR and SSR+FREP
+ * reading, writing or copying buffers in L1 or global memory with a sweep of strides, and DMA copies between
+ * L1 and global memory for tiles up to the L1 limit.
+ *
+ * Every line is "<name>, size: <bytes of a buffer>: <cycles> cycles (<bytes/cycle>)" so plots/scraper.py picks it up,
+ * the bytes are all bytes read and written. The names are bw_<mode>_<method>_<location>_c<cores>_s<stride>
+ * and bw_dma_<from>_to_<to>.
+ */
+
+// Every measurement accesses BW_ELEMENTS elements of each buffer (repeating the strided ones)
+#define BW_ELEMENTS 8192
+
+// Buffer size of the core and stride sweeps
+#define BW_BYTES 8192
+
+#define NUM_STRIDES 7
+const size_t strides[NUM_STRIDES] = {1, 2, 3, 4, 8, 16, 32};
+
+typedef enum { BW_READ, BW_WRITE, BW_COPY } bw_mode_t;
+typedef enum { BW_SCALAR, BW_SSR, BW_FREP } bw_method_t;
+
+const char* mode_names[] = {"read", "write", "copy"};
+const char* method_names[] = {"scalar", "ssr", "frep"};
+
+// Buffers in L1 and in global memory. l1_bytes is the size of the L1 buffers
+double *l1_src, *l1_dst, *mem_src, *mem_dst;
+size_t l1_bytes;
+
+/*
+ * Accesses n elements stride apart starting at src (and dst), reps times, with the method of the core.
+ * The SSR streams are 2D (n, reps) with a zero outer stride, so the repetitions need no new setup.
+ */
+static void bw_core(bw_mode_t mode, bw_method_t method, double* src, double* dst, size_t n, size_t stride, size_t reps) {
+    if (n == 0 || reps == 0) {
+        return;
+    }
+
+    if (method == BW_SCALAR) {
+        double acc = 0.0;
+        for (size_t r = 0; r < reps; r++) {
+            for (size_t i = 0; i < n; i++) {
+                if (mode == BW_READ) {
+                    acc += src[i * stride];
+                } else if (mode == BW_WRITE) {
+                    dst[i * stride] = 1.0;
+                } else {
+                    dst[i * stride] = src[i * stride];
+                }
+            }
+        }
+        asm volatile("" :: "f"(acc));
+        return;
+    }
+
+    if (mode != BW_WRITE) {
+        snrt_ssr_loop_2d(SNRT_SSR_DM0, n, reps, stride * sizeof(double), 0);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, src);
+    }
+    if (mode != BW_READ) {
+        snrt_ssr_loop_2d(SNRT_SSR_DM2, n, reps, stride * sizeof(double), 0);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, dst);
+    }
+    snrt_ssr_enable();
+
+    int frep = method == BW_FREP;
+    size_t count = n * reps;
+    // The moves do not depend on each other, so the streams set the pace
+    if (mode == BW_READ) {
+        FPMATH_PASS(frep, count, 1, "fmv.d ft3, ft0 \n", [one] "f"(1.0));
+    } else if (mode == BW_WRITE) {
+        FPMATH_PASS(frep, count, 1, "fmv.d ft2, %[one] \n", [one] "f"(1.0));
+    } else {
+        FPMATH_PASS(frep, count, 1, "fmv.d ft2, ft0 \n", [one] "f"(1.0));
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+static double bytes_per_cycle(size_t traffic, size_t cycles) {
+    return cycles > 0 ? (double) traffic / cycles : 0.0;
+}
+
+/*
+ * Runs bw_core on the first cores compute cores, core c on its contiguous part of the buffers of bytes bytes.
+ * The buffers hold bytes / 8 / stride elements stride apart, which are repeated to reach BW_ELEMENTS.
+ * Must be called by all cores.
+ */
+static void bw_run(bw_mode_t mode, bw_method_t method, int l1, size_t cores, size_t stride, size_t bytes) {
+    uint32_t core_idx = snrt_cluster_core_idx();
+    size_t elements = bytes / sizeof(double) / stride;
+    size_t reps = elements < BW_ELEMENTS ? BW_ELEMENTS / elements : 1;
+    double* src = l1 ? l1_src : mem_src;
+    double* dst = l1 ? l1_dst : mem_dst;
+
+    size_t first;
+    size_t count = local_range(elements, core_idx, cores, &first);
+
+    snrt_cluster_hw_barrier();
+    size_t start = read_csr(mcycle);
+    if (!snrt_is_dm_core() && core_idx < cores) {
+        bw_core(mode, method, src + first * stride, dst + first * stride, count, stride, reps);
+    }
+    snrt_cluster_hw_barrier();
+    size_t end = read_csr(mcycle);
+
+    if (core_idx == 0) {
+        size_t traffic = elements * reps * sizeof(double) * (mode == BW_COPY ? 2 : 1);
+        printf("bw_%s_%s_%s_c%d_s%d, size: %d: %lu cycles (%.3f bytes/cycle)\n", mode_names[mode],
+               method_names[method], l1 ? "l1" : "mem", cores, stride, bytes, end - start,
+               bytes_per_cycle(traffic, end - start));
+    }
+}
+
+/*
+ * DMA copy of bytes bytes from src to dst by the DM core. Must be called by all cores.
+ */
+static void bw_dma(const char* name, double* src, double* dst, size_t bytes) {
+    snrt_cluster_hw_barrier();
+    size_t start = read_csr(mcycle);
+    if (snrt_is_dm_core()) {
+        snrt_dma_start_1d(dst, src, bytes);
+        snrt_dma_wait_all();
+    }
+    snrt_cluster_hw_barrier();
+    size_t end = read_csr(mcycle);
+
+    if (snrt_cluster_core_idx() == 0) {
+        printf("%s, size: %d: %lu cycles (%.3f bytes/cycle)\n", name, bytes, end - start,
+               bytes_per_cycle(2 * bytes, end - start));
+    }
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+
+    if (core_idx == 0) {
+        printf("Running benchmark_bandwidth\n");
+
+        // The largest power of two for which both L1 buffers fit
+        size_t l1_start = arena_mark(arena_l1());
+        for (l1_bytes = LMQ_L1_ARENA_SIZE / 2; l1_bytes >= sizeof(double); l1_bytes /= 2) {
+            arena_reset(arena_l1(), l1_start);
+            l1_src = arena_alloc(arena_l1(), l1_bytes / sizeof(double), sizeof(double), LMQ_ALIGN_TCDM_BANK);
+            l1_dst = arena_alloc(arena_l1(), l1_bytes / sizeof(double), sizeof(double), LMQ_ALIGN_TCDM_BANK);
+            if (l1_src != NULL && l1_dst != NULL) {
+                break;
+            }
+        }
+        mem_src = allocate(l1_bytes / sizeof(double), sizeof(double));
+        mem_dst = allocate(l1_bytes / sizeof(double), sizeof(double));
+
+        for (size_t i = 0; i < l1_bytes / sizeof(double); i++) {
+            l1_src[i] = (double) i;
+            mem_src[i] = (double) i;
+        }
+        printf("L1 buffers of %d bytes\n", l1_bytes);
+    }
+    snrt_cluster_hw_barrier();
+
+    size_t bytes = BW_BYTES < l1_bytes ? BW_BYTES : l1_bytes;
+
+    /* 1 to 8 cores, every method and mode, L1 and memory */
+    for (int l1 = 1; l1 >= 0; l1--) {
+        for (bw_mode_t mode = BW_READ; mode <= BW_COPY; mode++) {
+            for (bw_method_t method = BW_SCALAR; method <= BW_FREP; method++) {
+                for (size_t cores = 1; cores <= core_num; cores++) {
+                    bw_run(mode, method, l1, cores, 1, bytes);
+                }
+            }
+        }
+    }
+
+    /* Strides on all cores in L1, a stride of 32 doubles puts every access of a core into the same bank */
+    for (bw_mode_t mode = BW_READ; mode <= BW_COPY; mode++) {
+        for (size_t s = 0; s < NUM_STRIDES; s++) {
+            bw_run(mode, BW_FREP, 1, core_num, strides[s], bytes);
+        }
+    }
+
+    /* Tile sizes up to the L1 buffers, DMA against SSR+FREP copies of all cores */
+    for (size_t tile = 256; tile <= l1_bytes; tile *= 2) {
+        bw_dma("bw_dma_mem_to_l1", mem_src, l1_dst, tile);
+        bw_dma("bw_dma_l1_to_mem", l1_src, mem_dst, tile);
+        bw_dma("bw_dma_l1_to_l1", l1_src, l1_dst, tile);
+        bw_dma("bw_dma_mem_to_mem", mem_src, mem_dst, tile);
+        bw_run(BW_COPY, BW_FREP, 1, core_num, 1, tile);
+        bw_run(BW_COPY, BW_FREP, 0, core_num, 1, tile);
+    }
+
+    if (core_idx == 0) {
+        verify_vector(l1_dst, l1_src, 32);
+        verify_vector(mem_dst, mem_src, 32);
+    }
+
+    return 0;
+}
@@ -2,24 +2,27 @@
 #include "printf.h"
 
 #include "lmq.h"
-#include "add.h"
+#include "batchnorm.h"
 #include "benchmark.h"
 
-__attribute__((noinline))
-int batchnorm_baseline(double *a, const size_t n, double* result);
-__attribute__((noinline))
-int batchnorm_ssr(double *a, const size_t n, double* result);
-__attribute__((noinline))
-int batchnorm_ssr_frep(double *a, const size_t n, double* result);
+#define CHANNELS 8
+
+double scale[CHANNELS], bias[CHANNELS], mean[CHANNELS], var[CHANNELS];
+double running_mean[CHANNELS], running_var[CHANNELS], running_mean_ref[CHANNELS], running_var_ref[CHANNELS];
+double *x, *result, *result_ref;
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         // Initialize the input data
-        double* x = allocate(size, sizeof(double));
-        double* result_ref = allocate(size, sizeof(double));
-        double* result = allocate(size, sizeof(double));
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
 
         for (size_t i = 0; i < size; i++) {
             x[i] = (double)i;
@@ -36,8 +39,97 @@ int main() {
         BENCH_VO(batchnorm_ssr_frep, x, size, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        BENCH_VO(batchnorm_ssr_frep_staggered, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+
+    /* Benchmark NCHW with per channel parameters */
+    if (core_idx == 0) {
+        for (size_t ch = 0; ch < CHANNELS; ch++) {
+            scale[ch] = 0.5 + 0.25 * ch;
+            // Keeps the outputs positive for verify_vector_approx
+            bias[ch] = 8.0 + 0.125 * ch;
+            mean[ch] = 1.5;
+            var[ch] = 0.5 + 0.125 * ch;
+        }
+    }
+
+    arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t n = 2;
+        size_t hw = size / (n * CHANNELS) + 1;
+        size_t len = n * CHANNELS * hw;
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(len, sizeof(double));
+            result = allocate(len, sizeof(double));
+            result_ref = allocate(len, sizeof(double));
+
+            for (size_t i = 0; i < len; i++) {
+                x[i] = 4.0 + (double)((i * 7) % 13) / 4;
+            }
+
+            printf("Running benchmark_batchnorm (NCHW)\n");
+
+            BENCH_VO(batchnorm_nchw_inference_baseline, x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, result_ref);
+
+            BENCH_VO(batchnorm_nchw_inference_ssr_frep, x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, result);
+            verify_vector_approx(result, result_ref, len);
+            clear_vector(result, len);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(batchnorm_nchw_inference_ssr_frep_parallel, x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, len);
+            clear_vector(result, len);
+
+            BENCH_VO(batchnorm_nchw_training_baseline, x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, 0.9,
+                     result_ref, running_mean_ref, running_var_ref);
+
+            BENCH_VO(batchnorm_nchw_training_ssr_frep, x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, 0.9,
+                     result, running_mean, running_var);
+            verify_vector_approx(result, result_ref, len);
+            verify_vector_approx(running_mean, running_mean_ref, CHANNELS);
+            verify_vector_approx(running_var, running_var_ref, CHANNELS);
+            clear_vector(result, len);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(batchnorm_nchw_training_ssr_frep_parallel, x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, 0.9,
+                          result, running_mean, running_var);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, len);
+            verify_vector_approx(running_mean, running_mean_ref, CHANNELS);
+            verify_vector_approx(running_var, running_var_ref, CHANNELS);
+            clear_vector(result, len);
+        }
+        snrt_cluster_hw_barrier();
     }
 
+    /* Benchmark OMP parallel, on the buffers of the last size */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t n = 2;
+        size_t hw = size / (n * CHANNELS) + 1;
+        size_t len = n * CHANNELS * hw;
+
+        batchnorm_nchw_training_baseline(x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, 0.9,
+                                         result_ref, running_mean_ref, running_var_ref);
+
+        BENCH_VO_OMP(batchnorm_nchw_training_ssr_frep_omp, x, n, CHANNELS, hw, scale, bias, mean, var, 1e-5, 0.9,
+                     result, running_mean, running_var);
+        verify_vector_approx(result, result_ref, len);
+        verify_vector_approx(running_mean, running_mean_ref, CHANNELS);
+        verify_vector_approx(running_var, running_var_ref, CHANNELS);
+        clear_vector(result, len);
+    }
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
-
@@ -0,0 +1,122 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "broadcast.h"
+#include "benchmark.h"
+
+double *x, *y, *result_ref, *result;
+
+/*
+ * Bias add (r, 16) + (16), per channel scale (4, n / 4) * (4, 1), scalar (n) / () and outer (r, 1) - (1, 16).
+ */
+#define NUM_CASES 4
+const broadcast_kind_t kinds[NUM_CASES] = {BROADCAST_ADD, BROADCAST_MUL, BROADCAST_DIV, BROADCAST_SUB};
+size_t a_shapes[NUM_CASES][2];
+size_t b_shapes[NUM_CASES][2];
+const size_t a_ndims[NUM_CASES] = {2, 2, 1, 2};
+const size_t b_ndims[NUM_CASES] = {1, 2, 0, 2};
+size_t out_sizes[NUM_CASES];
+
+static void set_cases(size_t size) {
+    size_t r = size / 16;
+
+    a_shapes[0][0] = r;
+    a_shapes[0][1] = 16;
+    b_shapes[0][0] = 16;
+    out_sizes[0] = r * 16;
+
+    a_shapes[1][0] = 4;
+    a_shapes[1][1] = size / 4;
+    b_shapes[1][0] = 4;
+    b_shapes[1][1] = 1;
+    out_sizes[1] = 4 * (size / 4);
+
+    a_shapes[2][0] = size;
+    out_sizes[2] = size;
+
+    a_shapes[3][0] = r;
+    a_shapes[3][1] = 1;
+    b_shapes[3][0] = 1;
+    b_shapes[3][1] = 16;
+    out_sizes[3] = r * 16;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_broadcast\n");
+
+        x = allocate(size, sizeof(double));
+        y = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
+
+        for (unsigned i = 0; i < size; i++) {
+            x[i] = (double)i;
+            y[i] = (double)i + 1.0; // no division by 0
+        }
+
+        set_cases(size);
+        for (size_t c = 0; c < NUM_CASES; c++) {
+            BENCH_VO(broadcast_baseline, kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result_ref);
+
+            BENCH_VO(broadcast_ssr, kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result);
+            verify_vector(result, result_ref, out_sizes[c]);
+            clear_vector(result, size);
+
+            BENCH_VO(broadcast_ssr_frep, kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result);
+            verify_vector(result, result_ref, out_sizes[c]);
+            clear_vector(result, size);
+        }
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        for (size_t c = 0; c < NUM_CASES; c++) {
+            if (core_idx == 0) {
+                set_cases(size);
+                broadcast_baseline(kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result_ref);
+            }
+
+            BENCH_VO_PARALLEL(broadcast_parallel, kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result);
+            if (core_idx == 0) {
+                verify_vector(result, result_ref, out_sizes[c]);
+                clear_vector(result, size);
+            }
+
+            BENCH_VO_PARALLEL(broadcast_ssr_frep_parallel, kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result);
+            if (core_idx == 0) {
+                verify_vector(result, result_ref, out_sizes[c]);
+                clear_vector(result, size);
+            }
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        set_cases(size);
+        for (size_t c = 0; c < NUM_CASES; c++) {
+            broadcast_baseline(kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result_ref);
+
+            BENCH_VO_OMP(broadcast_omp, kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result);
+            verify_vector(result, result_ref, out_sizes[c]);
+            clear_vector(result, size);
+
+            BENCH_VO_OMP(broadcast_ssr_frep_omp, kinds[c], x, a_shapes[c], a_ndims[c], y, b_shapes[c], b_ndims[c], result);
+            verify_vector(result, result_ref, out_sizes[c]);
+            clear_vector(result, size);
+        }
+    }
+
+    __snrt_omp_destroy(core_idx);
+
+    return 0;
+}
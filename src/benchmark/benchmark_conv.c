@@ -3,27 +3,20 @@
 
 #include "lmq.h"
 #include "add.h"
+#include "conv.h"
 #include "benchmark.h"
 
-__attribute__((noinline))
-int conv_baseline(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
-__attribute__((noinline))
-int conv_ssr(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
-__attribute__((noinline))
-int conv_ssr_frep(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
-
-__attribute__((noinline))
-int conv_parallel(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
-__attribute__((noinline))
-int conv_ssr_parallel(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
-__attribute__((noinline))
-int conv_ssr_frep_parallel(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
-
-size_t conv_output_size(size_t n, size_t filter_size, size_t stride, size_t dilation);
-// void print_pattern(double *a, size_t n, size_t filter_size, size_t stride, double* result);
-
 double *x, *result, *result_ref, *filter;
 
+// Activations of the fused convolutions
+conv_activation_t activations[] = {
+    { CONV_ACT_RELU, 0.0, 0.0, 0.0 },
+    { CONV_ACT_LEAKYRELU, 0.1, 0.0, 0.0 },
+    { CONV_ACT_SIGMOID, 0.0, 0.0, 0.0 },
+    { CONV_ACT_CLIP, 0.0, -20.0, 20.0 },
+};
+#define NUM_ACTIVATIONS (sizeof(activations) / sizeof(activations[0]))
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
     uint32_t core_num = snrt_cluster_core_num() - 1; // -1 as there is one DM core
@@ -32,8 +25,13 @@ int main() {
     size_t stride = 2;
     size_t dilation = 2;
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; size<=LMQ_SIZE && core_idx == 0;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         size_t input_size = (size - 1) * stride + (1 + (filter_size - 1) * dilation);
+        bench_shape(4, "n", input_size, "filter", filter_size, "stride", stride, "dilation", dilation);
 
         // Initialize the input data
         x = allocate(input_size, sizeof(double));
@@ -59,6 +57,29 @@ int main() {
         BENCH_VO(conv_ssr_frep, x, filter, input_size, filter_size, stride, dilation, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        // auto_pad SAME_UPPER: ceil(input_size / stride) outputs without a padded copy of x
+        size_t pad_begin, pad_end;
+        conv_auto_pads(input_size, filter_size, stride, dilation, CONV_AUTO_PAD_SAME_UPPER, &pad_begin, &pad_end);
+        size_t same_size = conv_output_size(input_size + pad_begin + pad_end, filter_size, stride, dilation);
+        double* same_ref = allocate(same_size, sizeof(double));
+        double* same = allocate(same_size, sizeof(double));
+
+        BENCH_VO(conv_pad_baseline, x, filter, input_size, filter_size, stride, dilation, pad_begin, pad_end, same_ref);
+
+        BENCH_VO(conv_pad_ssr_frep, x, filter, input_size, filter_size, stride, dilation, pad_begin, pad_end, same);
+        verify_vector(same, same_ref, same_size);
+
+        // conv, bias and activation in one pass
+        for (size_t act = 0; act < NUM_ACTIVATIONS; act++) {
+            printf("activation: %d\n", activations[act].kind);
+
+            BENCH_VO(conv_baseline_fused, x, filter, input_size, filter_size, stride, dilation, 1.5, &activations[act], result_ref);
+
+            BENCH_VO(conv_ssr_frep_fused, x, filter, input_size, filter_size, stride, dilation, 1.5, &activations[act], result);
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
     }
 
     snrt_cluster_hw_barrier();
@@ -66,6 +87,7 @@ int main() {
     /* Benchmark parallel */
     for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
         size_t input_size = (size - 1) * stride + (1 + (filter_size - 1) * dilation);
+        bench_shape(4, "n", input_size, "filter", filter_size, "stride", stride, "dilation", dilation);
         conv_baseline(x, filter, input_size, filter_size, stride, dilation, result_ref);
 
         BENCH_VO_PARALLEL(conv_parallel, x, filter, input_size, filter_size, stride, dilation, result);
@@ -2,27 +2,29 @@
 #include "printf.h"
 
 #include "lmq.h"
-#include "add.h"
+#include "conv.h"
+#include "winograd.h"
 #include "benchmark.h"
 
-__attribute__((noinline))
-int conv2d_baseline(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
-__attribute__((noinline))
-int conv2d_ssr(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
-__attribute__((noinline))
-int conv2d_ssr_frep(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+double *x, *w, *bias, *result_ref, *result, *x_padded;
 
-size_t conv_output_size(size_t n, size_t filter_size, size_t stride, size_t dilation);
-// void print_pattern(double *a, size_t n, size_t filter_size, size_t stride, double* result);
+// Activations of the fused convolutions
+conv_activation_t activations[] = {
+    { CONV_ACT_RELU, 0.0, 0.0, 0.0 },
+    { CONV_ACT_LEAKYRELU, 0.1, 0.0, 0.0 },
+    { CONV_ACT_SIGMOID, 0.0, 0.0, 0.0 },
+    { CONV_ACT_CLIP, 0.0, -20.0, 20.0 },
+};
+#define NUM_ACTIVATIONS (sizeof(activations) / sizeof(activations[0]))
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
-    if (core_idx != 0) {
-        return 0;
-    }
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
 
-    for(size_t size=LMQ_START_SIZE; size<=LMQ_SIZE;size*=2){
         size_t f0 = 5;
         size_t f1 = 4;
         size_t s0 = 3;
@@ -35,6 +37,7 @@ int main() {
 
         size_t n0 = (outn0 - 1) * s0 + (1 + (f0 - 1) * d0);
         size_t n1 = (outn1 - 1) * s1 + (1 + (f1 - 1) * d1);
+        bench_shape(8, "n0", n0, "n1", n1, "f0", f0, "f1", f1, "s0", s0, "s1", s1, "d0", d0, "d1", d1);
 
         double* x = allocate(n0 * n1, sizeof(double));
         double* result_ref = allocate(outn0 * outn1, sizeof(double));
@@ -58,10 +61,252 @@ int main() {
         BENCH_VO(conv2d_ssr_frep, x, filter, n0, n1, f0, f1, s0, s1, d0, d1, result);
         verify_vector(result, result_ref, outn0 * outn1);
         clear_vector(result, outn0 * outn1);
+
+        BENCH_VO(conv2d_ssr_frep_blocked, x, filter, n0, n1, f0, f1, s0, s1, d0, d1, result);
+        verify_vector(result, result_ref, outn0 * outn1);
+        clear_vector(result, outn0 * outn1);
+
+        // conv, bias and activation in one pass
+        for (size_t act = 0; act < NUM_ACTIVATIONS; act++) {
+            printf("activation: %d\n", activations[act].kind);
+
+            BENCH_VO(conv2d_baseline_fused, x, filter, n0, n1, f0, f1, s0, s1, d0, d1, 1.5, &activations[act], result_ref);
+
+            BENCH_VO(conv2d_ssr_frep_fused, x, filter, n0, n1, f0, f1, s0, s1, d0, d1, 1.5, &activations[act], result);
+            verify_vector(result, result_ref, outn0 * outn1);
+            clear_vector(result, outn0 * outn1);
+        }
     }
 
-    return 0;
-}
+    snrt_cluster_hw_barrier();
+
+    /* conv2d with the output rows split over the cores */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t f0 = 3;
+        size_t f1 = 3;
+        size_t s0 = 1;
+        size_t s1 = 1;
+        size_t d0 = 1;
+        size_t d1 = 1;
+
+        size_t outn0 = sqrt_approx(size);
+        size_t outn1 = sqrt_approx(size);
+
+        size_t n0 = (outn0 - 1) * s0 + (1 + (f0 - 1) * d0);
+        size_t n1 = (outn1 - 1) * s1 + (1 + (f1 - 1) * d1);
+        bench_shape(8, "n0", n0, "n1", n1, "f0", f0, "f1", f1, "s0", s0, "s1", s1, "d0", d0, "d1", d1);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(n0 * n1, sizeof(double));
+            w = allocate(f0 * f1, sizeof(double));
+            result_ref = allocate(outn0 * outn1, sizeof(double));
+            result = allocate(outn0 * outn1, sizeof(double));
+
+            for (size_t i = 0; i < n0 * n1; i++) {
+                x[i] = (double)i;
+            }
+            for (size_t i = 0; i < f0 * f1; ++i) {
+                w[i] = 10.f - i;
+            }
+            conv2d_baseline(x, w, n0, n1, f0, f1, s0, s1, d0, d1, result_ref);
+
+            BENCH_VO(conv2d_winograd, x, w, n0, n1, f0, f1, s0, s1, d0, d1, result);
+            verify_vector(result, result_ref, outn0 * outn1);
+            clear_vector(result, outn0 * outn1);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(conv2d_parallel, x, w, n0, n1, f0, f1, s0, s1, d0, d1, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, outn0 * outn1);
+            clear_vector(result, outn0 * outn1);
+        }
+
+        BENCH_VO_PARALLEL(conv2d_ssr_frep_parallel, x, w, n0, n1, f0, f1, s0, s1, d0, d1, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, outn0 * outn1);
+            clear_vector(result, outn0 * outn1);
+        }
+
+        BENCH_VO_PARALLEL(conv2d_ssr_frep_blocked_parallel, x, w, n0, n1, f0, f1, s0, s1, d0, d1, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, outn0 * outn1);
+            clear_vector(result, outn0 * outn1);
+        }
+    }
+
+    /* 3x3 conv with "same" zero padding, the padded copy of the input against the clamped windows */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t f = 3;
+        size_t n = sqrt_approx(size);
+        size_t padded = n + 2;
+        bench_shape(3, "n0", n, "n1", n, "f0", f);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(n * n, sizeof(double));
+            x_padded = allocate(padded * padded, sizeof(double));
+            w = allocate(f * f, sizeof(double));
+            result_ref = allocate(n * n, sizeof(double));
+            result = allocate(n * n, sizeof(double));
+
+            for (size_t i = 0; i < n * n; i++) {
+                x[i] = (double)i;
+            }
+            for (size_t i = 0; i < f * f; ++i) {
+                w[i] = 10.f - i;
+            }
+            conv2d_pad_baseline(x, w, n, n, f, f, 1, 1, 1, 1, 1, 1, 1, 1, result_ref);
 
+            // Pad into a copy, then the plain conv
+            clear_vector(x_padded, padded * padded);
+            for (size_t r = 0; r < n; r++) {
+                for (size_t c = 0; c < n; c++) {
+                    x_padded[(r + 1) * padded + c + 1] = x[r * n + c];
+                }
+            }
+            BENCH_VO(conv2d_ssr_frep, x_padded, w, padded, padded, f, f, 1, 1, 1, 1, result);
+            verify_vector(result, result_ref, n * n);
+            clear_vector(result, n * n);
 
+            BENCH_VO(conv2d_pad_ssr_frep, x, w, n, n, f, f, 1, 1, 1, 1, 1, 1, 1, 1, result);
+            verify_vector(result, result_ref, n * n);
+            clear_vector(result, n * n);
 
+            // auto_pad SAME_LOWER with stride 2 and dilation 2, the odd pad element goes before the input
+            size_t p_begin, p_end;
+            conv_auto_pads(n, f, 2, 2, CONV_AUTO_PAD_SAME_LOWER, &p_begin, &p_end);
+            size_t outn = conv_output_size(n + p_begin + p_end, f, 2, 2);
+            conv2d_pad_baseline(x, w, n, n, f, f, 2, 2, 2, 2, p_begin, p_begin, p_end, p_end, result_ref);
+            BENCH_VO(conv2d_pad_ssr_frep, x, w, n, n, f, f, 2, 2, 2, 2, p_begin, p_begin, p_end, p_end, result);
+            verify_vector(result, result_ref, outn * outn);
+            clear_vector(result, n * n);
+            conv2d_pad_baseline(x, w, n, n, f, f, 1, 1, 1, 1, 1, 1, 1, 1, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(conv2d_pad_ssr_frep_parallel, x, w, n, n, f, f, 1, 1, 1, 1, 1, 1, 1, 1, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, n * n);
+            clear_vector(result, n * n);
+        }
+    }
+
+    /* NCHW conv: 3x3 filters, once dense and once grouped with stride and dilation */
+    size_t batch = 2;
+    size_t f = 3;
+    size_t configs[2][5] = {
+        // c_in, c_out, groups, stride, dilation
+        { 3, 8, 1, 1, 1 },
+        { 4, 6, 2, 2, 2 },
+    };
+
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        for (size_t c = 0; c < 2; c++) {
+            size_t c_in = configs[c][0];
+            size_t c_out = configs[c][1];
+            size_t groups = configs[c][2];
+            size_t s = configs[c][3];
+            size_t d = configs[c][4];
+
+            // About size output elements in total
+            size_t outn = sqrt_approx(size / (batch * c_out)) + 1;
+            size_t n = (outn - 1) * s + (1 + (f - 1) * d);
+            size_t out_len = batch * c_out * outn * outn;
+            bench_shape(8, "batch", batch, "c_in", c_in, "c_out", c_out, "groups", groups, "n", n, "filter", f,
+                        "stride", s, "dilation", d);
+
+            if (core_idx == 0) {
+                arena_reset(arena_global(), arena_start);
+                x = allocate(batch * c_in * n * n, sizeof(double));
+                w = allocate(c_out * (c_in / groups) * f * f, sizeof(double));
+                bias = allocate(c_out, sizeof(double));
+                result_ref = allocate(out_len, sizeof(double));
+                result = allocate(out_len, sizeof(double));
+
+                for (size_t i = 0; i < batch * c_in * n * n; i++) {
+                    x[i] = (double)(i % 13);
+                }
+                for (size_t i = 0; i < c_out * (c_in / groups) * f * f; i++) {
+                    w[i] = 3.0 - (double)(i % 7);
+                }
+                for (size_t i = 0; i < c_out; i++) {
+                    bias[i] = (double)i;
+                }
+
+                BENCH_VO(conv_nchw_baseline, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, result_ref);
+
+                BENCH_VO(conv_nchw_ssr_frep, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, result);
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+
+                // Winograd only applies to the dense config, the dispatcher falls back for the other
+                if (groups == 1 && s == 1 && d == 1) {
+                    BENCH_VO(conv_nchw_winograd, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, result);
+                    verify_vector(result, result_ref, out_len);
+                    clear_vector(result, out_len);
+                }
+
+                BENCH_VO(conv_nchw_dispatch, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, result);
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+            }
+            snrt_cluster_hw_barrier();
+
+            BENCH_VO_PARALLEL(conv_nchw_ssr_frep_parallel, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, result);
+            if (core_idx == 0) {
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+            }
+
+            // Fused with leaky relu
+            if (core_idx == 0) {
+                BENCH_VO(conv_nchw_baseline_fused, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, &activations[1], result_ref);
+
+                BENCH_VO(conv_nchw_ssr_frep_fused, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, &activations[1], result);
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+            }
+            snrt_cluster_hw_barrier();
+
+            BENCH_VO_PARALLEL(conv_nchw_ssr_frep_parallel_fused, x, w, bias, batch, c_in, n, n, c_out, groups, f, f, s, s, d, d, &activations[1], result);
+            if (core_idx == 0) {
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+            }
+        }
+    }
+
+    // Benchmark OMP
+    __snrt_omp_bootstrap(core_idx);
+
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t f = 3;
+        size_t outn = sqrt_approx(size);
+        size_t n = outn + f - 1;
+        bench_shape(2, "n", n, "filter", f);
+
+        arena_reset(arena_global(), arena_start);
+        x = allocate(n * n, sizeof(double));
+        w = allocate(f * f, sizeof(double));
+        result_ref = allocate(outn * outn, sizeof(double));
+        result = allocate(outn * outn, sizeof(double));
+
+        for (size_t i = 0; i < n * n; i++) {
+            x[i] = (double)i;
+        }
+        for (size_t i = 0; i < f * f; ++i) {
+            w[i] = 10.f - i;
+        }
+        conv2d_baseline(x, w, n, n, f, f, 1, 1, 1, 1, result_ref);
+
+        BENCH_VO_OMP(conv2d_ssr_frep_omp, x, w, n, n, f, f, 1, 1, 1, 1, result);
+        verify_vector(result, result_ref, outn * outn);
+        clear_vector(result, outn * outn);
+    }
+
+    __snrt_omp_destroy(core_idx);
+
+    return 0;
+}
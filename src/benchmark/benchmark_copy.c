@@ -7,11 +7,32 @@
 
 double *x, *result, *result_ref;
 
+// Strided copies view x as a matrix of COLS columns
+#define COLS 10
+#define SLICE_COLS 5
+
+/*
+ * Checks that result holds planes blocks of rows rows of the first SLICE_COLS columns of x,
+ * the blocks are pad rows apart in result.
+ */
+static void verify_slice(const double* result, size_t rows, size_t planes, size_t pad) {
+    for (size_t p = 0; p < planes; p++) {
+        for (size_t r = 0; r < rows; r++) {
+            const double* row = result + (p * (rows + pad) + r) * SLICE_COLS;
+            verify_vector(row, x + (p * rows + r) * COLS, SLICE_COLS);
+        }
+    }
+}
+
 int main() {
     uint32_t core_idx = snrt_cluster_core_idx();
     uint32_t core_num = snrt_cluster_core_num() - 1; // -1 as there is one DM core
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_copy\n");
 
         x = allocate(size, sizeof(double));
@@ -67,6 +88,28 @@ int main() {
             verify_vector(result, result_ref, size);
             clear_vector(result, size);
         }
+
+        BENCH_VO_PARALLEL(copy_dma, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        // Slice of the first SLICE_COLS columns of x as a matrix of COLS columns into a compact matrix
+        size_t rows = size / COLS;
+        BENCH_VO_PARALLEL(copy_dma_2d, x, SLICE_COLS, rows, COLS, SLICE_COLS, result);
+        if (core_idx == 0) {
+            verify_slice(result, rows, 1, 0);
+            clear_vector(result, size);
+        }
+
+        // The same slice of two planes of rows / 2 rows, the planes are one row apart in result
+        BENCH_VO_PARALLEL(copy_dma_3d, x, SLICE_COLS, rows / 2, 2, COLS, SLICE_COLS,
+                          rows / 2 * COLS, (rows / 2 + 1) * SLICE_COLS, result);
+        if (core_idx == 0) {
+            verify_slice(result, rows / 2, 2, 1);
+            clear_vector(result, size);
+        }
     }
 
     // Benchmark OMP
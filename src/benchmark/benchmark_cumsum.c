@@ -5,14 +5,30 @@
 #include "lmq.h"
 #include "cumsum.h"
 #include "benchmark.h"
+#include "golden.h"
 
 double *x, *result, *result_ref;
 
+/*
+ * Axis and attributes of a benchmarked N-D cumsum of a [batch, time, features] tensor.
+ */
+typedef struct {
+    int axis;
+    int exclusive;
+    int reverse;
+} cumsum_axis_config_t;
+
+#define NUM_AXIS_CONFIGS 4
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
     uint32_t core_num = snrt_cluster_core_num() - 1; // -1 as there is one DM core
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_cumsum\n");
 
         // x is input; result is output of the optimized functions
@@ -20,17 +36,14 @@ int main() {
         result = allocate(size, sizeof(double));
         result_ref = allocate(size, sizeof(double));
 
-        srandom(2);
-        for (size_t i = 0; i < size; i++) {
-            x[i] = 1.0 * random() / __LONG_MAX__;
-        }
+        golden_fill(x, size, 0, 1.0);
 
         // For debugging purposes
         // for (size_t i = 0; i < size; i++) {
         //     printf("Input at index %d is %f\n", i, x[i]);
         // }
 
-        BENCH_VO(cumsum_baseline, x, size, result_ref);
+        BENCH_REF(result_ref, cumsum_baseline, x, size, result_ref);
         
         BENCH_VO(cumsum_ssr, x, size, result);
         // for (size_t i = 0; i < size; i++) {
@@ -42,13 +55,24 @@ int main() {
         BENCH_VO(cumsum_ssr_frep, x, size, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        // ONNX exclusive and reverse
+        BENCH_VO(cumsum_onnx_baseline, x, size, 1, 1, result_ref);
+
+        BENCH_VO(cumsum_onnx_ssr_frep, x, size, 1, 1, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
     }
 
     snrt_cluster_hw_barrier();
 
     /* Benchmark parallel */
+    arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
         if (core_idx == 0) {
+            // Free the buffers of the previous size
+            arena_reset(arena_global(), arena_start);
+
             x = allocate(size, sizeof(double));
             result = allocate(size, sizeof(double));
             result_ref = allocate(size, sizeof(double));
@@ -61,44 +85,106 @@ int main() {
 
         snrt_cluster_hw_barrier();
 
-        size_t chunk_size = size / core_num;
-        // for (size_t i = 0; core_idx == 0 && i < size; i++) {
-        //     printf("Output at index %d is %f\n", i, result_ref[i]);
-        // }
-
         BENCH_VO_PARALLEL(cumsum_parallel, x, size, result);
-        // for (size_t i = 0; core_idx == 0 && i < size; i++) {
-        //     printf("result at index %d is %f ref: %f\n", i, result[i], result_ref[i]);
-        // }
         if (core_idx == 0) {
             verify_vector_approx(result, result_ref, size);
             clear_vector(result, size);
         }
-        
-        // cumsum_ssr_parallel has the bug that the streams get mixed and thus the results are wrong, so no verification here
+
         BENCH_VO_PARALLEL(cumsum_ssr_parallel, x, size, result);
-        // for (size_t i = 0; core_idx == 0 && i < size; i++) {
-        //     printf("result at index %d is %f ref: %f\n", i, result[i], result_ref[i]);
-        // }
-        // for (size_t i = 0; core_idx == 0 && i < size; i++) {
-        //     printf("input at index %d is %f\n", i, x[i]);
-        // }
         if (core_idx == 0) {
-        //     verify_vector_omp(result, result_ref, size, chunk_size);
+            verify_vector_approx(result, result_ref, size);
             clear_vector(result, size);
         }
 
         BENCH_VO_PARALLEL(cumsum_ssr_frep_parallel, x, size, result);
         if (core_idx == 0) {
-        //     verify_vector_omp(result, result_ref, size, chunk_size);
+            verify_vector_approx(result, result_ref, size);
             clear_vector(result, size);
         }
-        // for (size_t i = 0; core_idx == 0 && i < size; i++) {
-        //     printf("result at index %d is %f ref: %f\n", i, result[i], result_ref[i]);
-        // }
-        // for (size_t i = 0; core_idx == 0 && i < size; i++) {
-        //     printf("input at index %d is %f\n", i, x[i]);
-        // }
+
+        BENCH_VO_PARALLEL(cumsum_ssr_frep_tiled, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    snrt_cluster_hw_barrier();
+
+    /* Benchmark parallel exclusive and reverse */
+    arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        if (core_idx == 0) {
+            // Free the buffers of the previous size
+            arena_reset(arena_global(), arena_start);
+
+            x = allocate(size, sizeof(double));
+            result = allocate(size, sizeof(double));
+            result_ref = allocate(size, sizeof(double));
+
+            for (size_t i = 0; i < size; i++) {
+                x[i] = 1.0 * i;
+            }
+            cumsum_onnx_baseline(x, size, 1, 1, result_ref);
+        }
+
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(cumsum_onnx_ssr_frep_parallel, x, size, 1, 1, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    snrt_cluster_hw_barrier();
+
+    /* Benchmark N-D along an axis */
+    cumsum_axis_config_t configs[NUM_AXIS_CONFIGS] = {
+        // Time axis, features, batch and the time axis backwards
+        {1, 0, 0},
+        {-1, 0, 0},
+        {0, 0, 0},
+        {1, 1, 1},
+    };
+    arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        // One group of CUMSUM_LANES lanes and two left over lanes per time step
+        size_t shape[3] = {2, size / 12 + 1, 6};
+        size_t len = shape[0] * shape[1] * shape[2];
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(len, sizeof(double));
+            result = allocate(len, sizeof(double));
+            result_ref = allocate(len, sizeof(double));
+
+            for (size_t i = 0; i < len; i++) {
+                x[i] = 1.0 * i;
+            }
+        }
+
+        for (size_t c = 0; c < NUM_AXIS_CONFIGS; c++) {
+            cumsum_axis_config_t* cfg = &configs[c];
+            if (core_idx == 0) {
+                printf("Running benchmark_cumsum (axis %d, exclusive %d, reverse %d)\n", cfg->axis, cfg->exclusive, cfg->reverse);
+
+                BENCH_VO(cumsum_axis_baseline, x, shape, 3, cfg->axis, cfg->exclusive, cfg->reverse, result_ref);
+
+                BENCH_VO(cumsum_axis_ssr_frep, x, shape, 3, cfg->axis, cfg->exclusive, cfg->reverse, result);
+                verify_vector(result, result_ref, len);
+                clear_vector(result, len);
+            }
+            snrt_cluster_hw_barrier();
+
+            BENCH_VO_PARALLEL(cumsum_axis_ssr_frep_parallel, x, shape, 3, cfg->axis, cfg->exclusive, cfg->reverse, result);
+            if (core_idx == 0) {
+                verify_vector(result, result_ref, len);
+                clear_vector(result, len);
+            }
+            snrt_cluster_hw_barrier();
+        }
     }
 
     return 0;
@@ -0,0 +1,126 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "conv.h"
+#include "depthwise.h"
+#include "benchmark.h"
+
+/*
+ * MobileNet style 3x3 depthwise convs, once with more channels than output rows and once strided with fewer,
+ * against one conv2d_ssr_frep call per channel and the generic grouped conv_nchw, then fused with a pointwise conv.
+ */
+double *x, *w, *bias, *pw, *pw_bias, *scratch, *result_ref, *result;
+
+conv_activation_t relu = { CONV_ACT_RELU, 0.0, 0.0, 0.0 };
+
+// The depthwise conv as separate single channel convs
+static int depthwise_per_channel(double *x, double* w, size_t batch, size_t c, size_t n0, size_t n1,
+                                 size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t out_plane = conv_output_size(n0, f0, s0, d0) * conv_output_size(n1, f1, s1, d1);
+    for (size_t p = 0; p < batch * c; p++) {
+        conv2d_ssr_frep(x + p * n0 * n1, w + (p % c) * f0 * f1, n0, n1, f0, f1, s0, s1, d0, d1, result + p * out_plane);
+    }
+    return 0;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+    uint32_t core_num = snrt_cluster_core_num() - 1;
+
+    size_t batch = 1;
+    size_t f = 3;
+    size_t configs[2][3] = {
+        // channels, stride, pointwise output channels
+        { 32, 1, 16 },
+        { 8, 2, 16 },
+    };
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        for (size_t k = 0; k < 2; k++) {
+            size_t c = configs[k][0];
+            size_t s = configs[k][1];
+            size_t c_out = configs[k][2];
+
+            // About size output elements of the depthwise conv
+            size_t outn = sqrt_approx(size / c) + 1;
+            size_t n = (outn - 1) * s + f;
+            size_t out_len = batch * c * outn * outn;
+            size_t pw_len = batch * c_out * outn * outn;
+            size_t len = out_len > pw_len ? out_len : pw_len;
+            bench_shape(5, "c", c, "n", n, "filter", f, "stride", s, "c_out", c_out);
+
+            if (core_idx == 0) {
+                arena_reset(arena_global(), arena_start);
+                x = allocate(batch * c * n * n, sizeof(double));
+                w = allocate(c * f * f, sizeof(double));
+                bias = allocate(c, sizeof(double));
+                pw = allocate(c_out * c, sizeof(double));
+                pw_bias = allocate(c_out, sizeof(double));
+                scratch = allocate(DEPTHWISE_SCRATCH(c, outn, core_num), sizeof(double));
+                result_ref = allocate(len, sizeof(double));
+                result = allocate(len, sizeof(double));
+
+                for (size_t i = 0; i < batch * c * n * n; i++) {
+                    x[i] = (double)(i % 13) - 6.0;
+                }
+                for (size_t i = 0; i < c * f * f; i++) {
+                    w[i] = 3.0 - (double)(i % 7);
+                }
+                for (size_t i = 0; i < c_out * c; i++) {
+                    pw[i] = (double)(i % 5) - 2.0;
+                }
+                for (size_t i = 0; i < c; i++) {
+                    bias[i] = (double)i;
+                }
+                for (size_t i = 0; i < c_out; i++) {
+                    pw_bias[i] = 1.0 - (double)i;
+                }
+
+                BENCH_VO(conv_depthwise_baseline, x, w, NULL, batch, c, n, n, f, f, s, s, 1, 1, result_ref);
+
+                BENCH_VO(depthwise_per_channel, x, w, batch, c, n, n, f, f, s, s, 1, 1, result);
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+
+                // The grouped path of conv_nchw, which configures the streams per channel and row
+                BENCH_VO(conv_nchw_ssr_frep_fused, x, w, NULL, batch, c, n, n, c, c, f, f, s, s, 1, 1, NULL, result);
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+
+                BENCH_VO(conv_depthwise_ssr_frep, x, w, NULL, batch, c, n, n, f, f, s, s, 1, 1, result);
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+            }
+            snrt_cluster_hw_barrier();
+
+            BENCH_VO_PARALLEL(conv_depthwise_ssr_frep_parallel, x, w, NULL, batch, c, n, n, f, f, s, s, 1, 1, result);
+            if (core_idx == 0) {
+                verify_vector(result, result_ref, out_len);
+                clear_vector(result, out_len);
+            }
+
+            // Depthwise, relu and pointwise in one pass
+            if (core_idx == 0) {
+                BENCH_VO(conv_depthwise_pointwise_baseline, x, w, bias, &relu, pw, pw_bias, batch, c, n, n, c_out,
+                         f, f, s, s, 1, 1, result_ref);
+
+                BENCH_VO(conv_depthwise_pointwise_ssr_frep, x, w, bias, &relu, pw, pw_bias, batch, c, n, n, c_out,
+                         f, f, s, s, 1, 1, scratch, result);
+                verify_vector(result, result_ref, pw_len);
+                clear_vector(result, pw_len);
+            }
+            snrt_cluster_hw_barrier();
+
+            BENCH_VO_PARALLEL(conv_depthwise_pointwise_ssr_frep_parallel, x, w, bias, &relu, pw, pw_bias, batch, c, n, n, c_out,
+                              f, f, s, s, 1, 1, scratch, result);
+            if (core_idx == 0) {
+                verify_vector(result, result_ref, pw_len);
+                clear_vector(result, pw_len);
+            }
+        }
+    }
+
+    return 0;
+}
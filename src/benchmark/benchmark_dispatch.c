@@ -0,0 +1,192 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "dispatch.h"
+#include "add.h"
+#include "relu.h"
+#include "sigmoid.h"
+#include "dot.h"
+#include "gemm.h"
+
+/*
+ * Tuning of the thresholds of src/lmq/dispatch_table.h: times the baseline, ssr, ssr_frep and
+ * ssr_frep_parallel variant of every op from 1 to LMQ_SIZE elements (gemm: square matrices up to
+ * LMQ_SIZE elements), each from barrier to barrier like the dispatch and its join, and prints the sizes from
+ * which a variant stays faster than all cheaper ones as lines of "@dispatch #define DISPATCH_<OP>_<VARIANT> n".
+ * plots/tune_dispatch.py writes them to the header. Then the *_dispatch kernels are checked and timed.
+ */
+
+#define TUNE_TIERS 4
+#define TUNE_MAX_SIZES 32
+#define TUNE_RUNS 2
+
+typedef int (*tune_run_t)(size_t n);
+
+typedef struct {
+    const char* name;  // the op in the printed function names
+    const char* macro; // the op in the threshold names
+    int cubic;         // n is the dimension of square matrices, the size is n^3
+    tune_run_t tiers[TUNE_TIERS];
+} tune_op_t;
+
+static const char* tier_names[TUNE_TIERS] = {"baseline", "ssr", "ssr_frep", "ssr_frep_parallel"};
+static const char* tier_macros[TUNE_TIERS] = {"", "SSR", "SSR_FREP", "PARALLEL"};
+
+double *x, *y, *result, *result_ref;
+double dot_result, dot_result_ref;
+
+#define TUNE_WRAP(name, call) static int name(size_t n) { return call; }
+
+TUNE_WRAP(tune_add_baseline, add_baseline(x, y, n, result))
+TUNE_WRAP(tune_add_ssr, add_ssr(x, y, n, result))
+TUNE_WRAP(tune_add_ssr_frep, add_ssr_frep(x, y, n, result))
+TUNE_WRAP(tune_add_ssr_frep_parallel, add_ssr_frep_parallel(x, y, n, result))
+TUNE_WRAP(tune_relu_baseline, relu_baseline(x, n, result))
+TUNE_WRAP(tune_relu_ssr, relu_ssr(x, n, result))
+TUNE_WRAP(tune_relu_ssr_frep, relu_ssr_frep(x, n, result))
+TUNE_WRAP(tune_relu_ssr_frep_parallel, relu_ssr_frep_parallel(x, n, result))
+TUNE_WRAP(tune_sigmoid_baseline, sigmoid_baseline(x, n, result))
+TUNE_WRAP(tune_sigmoid_ssr, sigmoid_ssr(x, n, result))
+TUNE_WRAP(tune_sigmoid_ssr_frep, sigmoid_ssr_frep(x, n, result))
+TUNE_WRAP(tune_sigmoid_ssr_frep_parallel, sigmoid_ssr_frep_parallel(x, n, result))
+TUNE_WRAP(tune_dot_baseline, dot_baseline(x, y, n, &dot_result))
+TUNE_WRAP(tune_dot_ssr, dot_ssr(x, y, n, &dot_result))
+TUNE_WRAP(tune_dot_ssr_frep, dot_ssr_frep(x, y, n, &dot_result))
+TUNE_WRAP(tune_dot_ssr_frep_parallel, dot_ssr_frep_parallel(x, y, n, &dot_result))
+TUNE_WRAP(tune_gemm_baseline, gemm_baseline(x, y, n, n, n, result))
+TUNE_WRAP(tune_gemm_ssr, gemm_ssr(x, y, n, n, n, result))
+TUNE_WRAP(tune_gemm_ssr_frep, gemm_ssr_frep(x, y, n, n, n, result))
+TUNE_WRAP(tune_gemm_ssr_frep_parallel, gemm_ssr_frep_parallel(x, y, n, n, n, result))
+
+static const tune_op_t tune_ops[] = {
+    {"add", "ADD", 0, {tune_add_baseline, tune_add_ssr, tune_add_ssr_frep, tune_add_ssr_frep_parallel}},
+    {"relu", "RELU", 0, {tune_relu_baseline, tune_relu_ssr, tune_relu_ssr_frep, tune_relu_ssr_frep_parallel}},
+    {"sigmoid", "SIGMOID", 0, {tune_sigmoid_baseline, tune_sigmoid_ssr, tune_sigmoid_ssr_frep, tune_sigmoid_ssr_frep_parallel}},
+    {"dot", "DOT", 0, {tune_dot_baseline, tune_dot_ssr, tune_dot_ssr_frep, tune_dot_ssr_frep_parallel}},
+    {"gemm", "GEMM", 1, {tune_gemm_baseline, tune_gemm_ssr, tune_gemm_ssr_frep, tune_gemm_ssr_frep_parallel}},
+};
+
+/*
+ * Fewest cycles of TUNE_RUNS runs from barrier to barrier, on core 0. Must be called by all cores,
+ * only core 0 runs the single core tiers.
+ */
+static size_t tune_time(tune_run_t run, size_t n, int parallel) {
+    size_t best = (size_t)-1;
+    for (size_t r = 0; r < TUNE_RUNS; r++) {
+        size_t start = read_csr(mcycle);
+        snrt_cluster_hw_barrier();
+        if (parallel || snrt_cluster_core_idx() == 0) {
+            run(n);
+        }
+        snrt_cluster_hw_barrier();
+        size_t end = read_csr(mcycle);
+        best = end - start < best ? end - start : best;
+    }
+    return best;
+}
+
+/*
+ * The smallest size from which the tiers from tier on are faster than all tiers below on every larger size,
+ * (size_t)-1 if there is none.
+ */
+static size_t tune_threshold(size_t cycles[][TUNE_TIERS], const size_t* sizes, size_t num_sizes, size_t tier) {
+    size_t threshold = (size_t)-1;
+    for (size_t s = num_sizes; s-- > 0;) {
+        size_t below = (size_t)-1, above = (size_t)-1;
+        for (size_t t = 0; t < TUNE_TIERS; t++) {
+            size_t* best = t < tier ? &below : &above;
+            *best = cycles[s][t] < *best ? cycles[s][t] : *best;
+        }
+        if (above >= below) {
+            break;
+        }
+        threshold = sizes[s];
+    }
+    return threshold;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    if (core_idx == 0) {
+        x = allocate(LMQ_SIZE, sizeof(double));
+        y = allocate(LMQ_SIZE, sizeof(double));
+        result = allocate(LMQ_SIZE, sizeof(double));
+        result_ref = allocate(LMQ_SIZE, sizeof(double));
+        for (size_t i = 0; i < LMQ_SIZE; i++) {
+            x[i] = 0.25 * (double)((int)(i % 9) - 4);
+            y[i] = (double)(i % 5);
+        }
+    }
+    snrt_cluster_hw_barrier();
+
+    size_t cycles[TUNE_MAX_SIZES][TUNE_TIERS];
+    size_t sizes[TUNE_MAX_SIZES];
+    for (size_t o = 0; o < sizeof(tune_ops) / sizeof(tune_ops[0]); o++) {
+        const tune_op_t* op = &tune_ops[o];
+        size_t num_sizes = 0;
+        for (size_t n = 1; (op->cubic ? n * n : n) <= LMQ_SIZE && num_sizes < TUNE_MAX_SIZES; n *= 2) {
+            sizes[num_sizes] = op->cubic ? n * n * n : n;
+            for (size_t t = 0; t < TUNE_TIERS; t++) {
+                cycles[num_sizes][t] = tune_time(op->tiers[t], n, t == TUNE_TIERS - 1);
+                if (core_idx == 0) {
+                    printf("%s_%s, size: %d: %lu cycles. Return code: 0\n", op->name, tier_names[t], sizes[num_sizes],
+                           cycles[num_sizes][t]);
+                }
+            }
+            num_sizes++;
+        }
+
+        if (core_idx == 0) {
+            size_t previous = 0;
+            for (size_t t = 1; t < TUNE_TIERS; t++) {
+                size_t threshold = tune_threshold(cycles, sizes, num_sizes, t);
+                // a variant is only used after the cheaper ones
+                threshold = threshold < previous ? previous : threshold;
+                previous = threshold;
+                if (threshold == (size_t)-1) {
+                    printf("@dispatch #define DISPATCH_%s_%s ((size_t)-1)\n", op->macro, tier_macros[t]);
+                } else {
+                    printf("@dispatch #define DISPATCH_%s_%s %d\n", op->macro, tier_macros[t], threshold);
+                }
+            }
+        }
+    }
+
+    // the dispatch with the compiled in table at every size
+    for (size_t n = 1; n <= LMQ_SIZE; n *= 2) {
+        size = n;
+        if (core_idx == 0) {
+            add_baseline(x, y, n, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+        BENCH_VO_PARALLEL(add_dispatch, x, y, n, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, n);
+            clear_vector(result, n);
+            dot_baseline(x, y, n, &dot_result_ref);
+        }
+        snrt_cluster_hw_barrier();
+        BENCH_VO_PARALLEL(dot_dispatch, x, y, n, &dot_result);
+        if (core_idx == 0) {
+            VERIFY_INT(dot_result, dot_result_ref, "Mismatch: expected %f but got %f\n", dot_result_ref, dot_result);
+        }
+    }
+    for (size_t n = 1; n * n <= LMQ_SIZE; n *= 2) {
+        size = n * n * n;
+        bench_shape(3, "M", n, "N", n, "K", n);
+        if (core_idx == 0) {
+            gemm_baseline(x, y, n, n, n, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+        BENCH_VO_PARALLEL(gemm_dispatch, x, y, n, n, n, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, n * n);
+            clear_vector(result, n * n);
+        }
+    }
+
+    return 0;
+}
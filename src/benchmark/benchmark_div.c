@@ -5,16 +5,21 @@
 #include "div.h"
 #include "benchmark.h"
 
+double *x, *y, *result_ref, *result;
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         // Initialize the input data
-        double* x = allocate(size, sizeof(double));
-        double* y = allocate(size, sizeof(double));
-        double* result_ref = allocate(size, sizeof(double));
-        double* result = allocate(size, sizeof(double));
+        x = allocate(size, sizeof(double));
+        y = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
 
         for (int i = 0; i < size; i++) {
             x[i] = (double)i;
@@ -30,8 +35,66 @@ int main() {
         BENCH_VO(div_ssr_frep, x, y, size, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        BENCH_VO(div_ssr_frep_newton, x, y, size, result);
+        verify_vector(result, result_ref, size);
+        report_accuracy("div_ssr_frep_newton", result, result_ref, size, 0.0);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        div_baseline(x, y, size, result_ref);
+
+        BENCH_VO_PARALLEL(div_parallel, x, y, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(div_ssr_parallel, x, y, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(div_ssr_frep_parallel, x, y, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(div_ssr_frep_newton_parallel, x, y, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        div_baseline(x, y, size, result_ref);
+
+        BENCH_VO_OMP(div_omp, x, y, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(div_ssr_omp, x, y, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(div_ssr_frep_omp, x, y, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(div_ssr_frep_newton_omp, x, y, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
     }
+
+    __snrt_omp_destroy(core_idx);
  
     return 0;
 }
-
@@ -5,16 +5,23 @@
 #include "lmq.h"
 #include "dot.h"
 #include "benchmark.h"
+#include "golden.h"
+
+double *x, *y;
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_dot\n");
 
         // x,y,xd,yd is input
-        double* x = allocate(size, sizeof(double));
-        double* y = allocate(size, sizeof(double));
+        x = allocate(size, sizeof(double));
+        y = allocate(size, sizeof(double));
 
         double* xd = allocate(size, sizeof(double));
         double* yd = allocate(size, sizeof(double));
@@ -34,7 +41,7 @@ int main() {
             yd[i] = (double)i + 1.0;
         }
 
-        BENCH_VO(dot_baseline, x, y, size, &result_ref);
+        BENCH_REF(&result_ref, dot_baseline, x, y, size, &result_ref);
         // for (size_t i = 0; i < size; i++) {
         //     printf("Result at index %d is %f\n", i, result_ref[i]);
         // }
@@ -56,8 +63,70 @@ int main() {
         VERIFY_INT(result_ref, result, "Mismatch: expected %f but got %f\n", result_ref, result);
         result = 0.0;
 
+        BENCH_VO(dot_ssr_frep_staggered, x, y, size, &result);
+        VERIFY_INT(result_ref, result, "Mismatch: expected %f but got %f\n", result_ref, result);
+        result = 0.0;
+
+        // float32 (packed SIMD)
+        float* xf = allocate(size, sizeof(float));
+        float* yf = allocate(size, sizeof(float));
+        for (size_t i = 0; i < size; i++) {
+            xf[i] = (float)i + 1.0f;
+            yf[i] = (float)i + 1.0f;
+        }
+        float result_ref_f = 0.0f;
+        float result_f = 0.0f;
+
+        BENCH_VO(dot_baseline_f32, xf, yf, size, &result_ref_f);
+
+        BENCH_VO(dot_ssr_frep_f32, xf, yf, size, &result_f);
+        VERIFY_INT_APPROX(result_f, result_ref_f, "Mismatch: expected %f but got %f\n", result_ref_f, result_f);
+
     }
 
+    /* Benchmark parallel cores on the inputs of the largest size */
+    snrt_cluster_hw_barrier();
+
+    double result = 0.0;
+    double result_ref = 0.0;
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        dot_baseline(x, y, size, &result_ref);
+
+        BENCH_VO_PARALLEL(dot_parallel, x, y, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result_ref, result, "Mismatch: expected %f but got %f\n", result_ref, result);
+            result = 0.0;
+        }
+
+        BENCH_VO_PARALLEL(dot_ssr_frep_parallel, x, y, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result_ref, result, "Mismatch: expected %f but got %f\n", result_ref, result);
+            result = 0.0;
+        }
+
+        BENCH_VO_PARALLEL(dot_ssr_frep_tiled, x, y, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result_ref, result, "Mismatch: expected %f but got %f\n", result_ref, result);
+            result = 0.0;
+        }
+    }
+
+    __snrt_omp_bootstrap(core_idx);
+
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        dot_baseline(x, y, size, &result_ref);
+
+        BENCH_VO_OMP(dot_omp, x, y, size, &result);
+        VERIFY_INT(result_ref, result, "Mismatch: expected %f but got %f\n", result_ref, result);
+        result = 0.0;
+
+        BENCH_VO_OMP(dot_ssr_frep_omp, x, y, size, &result);
+        VERIFY_INT(result_ref, result, "Mismatch: expected %f but got %f\n", result_ref, result);
+        result = 0.0;
+    }
+
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
 
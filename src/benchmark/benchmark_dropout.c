@@ -6,16 +6,26 @@
 #include "dropout.h"
 #include "benchmark.h"
 
+// x is input; result is output of the optimized functions
+double *x, *result_ref, *result;
+// bit packed masks of dropout_counter_mask_*
+uint32_t *mask_ref, *mask;
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_dropout\n");
 
-        // x is input; result is output of the optimized functions
-        double* x = allocate(size, sizeof(double));
-        double* result_ref = allocate(size, sizeof(double));
-        double* result = allocate(size, sizeof(double));
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
+        mask_ref = allocate((size + 31) / 32, sizeof(uint32_t));
+        mask = allocate((size + 31) / 32, sizeof(uint32_t));
 
         const double ratio = 0.5; // probability of dropout
 
@@ -51,8 +61,58 @@ int main() {
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
 
+        BENCH(dropout_counter_baseline, x, size, ratio, 4, result_ref);
+
+        BENCH(dropout_counter_ssr_frep, x, size, ratio, 4, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH(dropout_counter_mask_baseline, x, size, ratio, 4, result, mask_ref);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH(dropout_counter_mask_ssr_frep, x, size, ratio, 4, result, mask);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+        for (size_t i = 0; i < (size + 31) / 32; i++) {
+            if (mask[i] != mask_ref[i]) {
+                printf("Mask word %d differs: %x != %x\n", i, mask[i], mask_ref[i]);
+            }
+        }
     }
 
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel, the counter based mask does not depend on the number of cores */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        if (core_idx == 0) {
+            dropout_counter_baseline(x, size, 0.5, 4, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(dropout_counter_ssr_frep_parallel, x, size, 0.5, 4, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(dropout_counter_mask_ssr_frep_parallel, x, size, 0.5, 4, result, mask);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        dropout_counter_baseline(x, size, 0.5, 4, result_ref);
+
+        BENCH_VO_OMP(dropout_counter_ssr_frep_omp, x, size, 0.5, 4, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
 
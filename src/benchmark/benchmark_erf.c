@@ -0,0 +1,80 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "erf.h"
+#include "benchmark.h"
+
+// x is input; result is output of the optimized functions
+double *x, *result_ref, *result;
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_erf\n");
+
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result  = allocate(size, sizeof(double));
+
+        srandom(2);
+        x[0] = 0.0; // erf(0.0) is 0
+        x[1] = 1.0; // erf(1.0) is 0.843
+        for (size_t i = 2; i < size; i++) {
+            x[i] = -3.0 + 6.0 * random() / __LONG_MAX__;
+        }
+
+        BENCH_VO(erf_baseline, x, size, result_ref);
+
+        BENCH_VO(erf_ssr, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(erf_ssr_frep, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        report_error("erf_ssr_frep", result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        erf_baseline(x, size, result_ref);
+
+        BENCH_VO_PARALLEL(erf_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(erf_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        erf_baseline(x, size, result_ref);
+
+        BENCH_VO_OMP(erf_omp, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(erf_ssr_frep_omp, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    __snrt_omp_destroy(core_idx);
+
+    return 0;
+}
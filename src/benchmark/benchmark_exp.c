@@ -0,0 +1,91 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "exp.h"
+#include "lut.h"
+#include "benchmark.h"
+
+// x is input; result is output of the optimized functions
+double *x, *result_ref, *result;
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_exp\n");
+
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result  = allocate(size, sizeof(double));
+
+        srandom(2);
+        x[0] = 0.0; // exp(0.0) is 1
+        x[1] = 1.0; // exp(1.0) is e
+        for (size_t i = 2; i < size; i++) {
+            x[i] = -20.0 + 40.0 * random() / __LONG_MAX__;
+        }
+
+        BENCH_VO(exp_baseline, x, size, result_ref);
+
+        BENCH_VO(exp_ssr, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(exp_ssr_frep, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        report_error("exp_ssr_frep", result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(exp_lut, x, size, result);
+        report_accuracy("exp_lut", result, result_ref, size, LUT_MAX_ERROR);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        exp_baseline(x, size, result_ref);
+
+        BENCH_VO_PARALLEL(exp_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(exp_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(exp_lut_parallel, x, size, result);
+        if (core_idx == 0) {
+            report_accuracy("exp_lut_parallel", result, result_ref, size, LUT_MAX_ERROR);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        exp_baseline(x, size, result_ref);
+
+        BENCH_VO_OMP(exp_omp, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(exp_ssr_frep_omp, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    __snrt_omp_destroy(core_idx);
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "fixed.h"
+#include "gemm.h"
+#include "conv.h"
+#include "benchmark.h"
+
+/*
+ * The shape specialized kernels of fixed.h against the generic ones for the same shapes. The shapes are
+ * X macro lists of (name, sizes...) entries, a generated header defining the three lists (f.ex. the layers of a
+ * model) replaces the defaults when it is given with -DLMQ_FIXED_FILE=<path>.
+ */
+#ifdef LMQ_FIXED_FILE
+#include LMQ_FIXED_FILE
+#else
+#define FIXED_GEMM_SHAPES(X)                    \
+    X(gemm_fixed_4x4x4, 4, 4, 4)                \
+    X(gemm_fixed_8x8x8, 8, 8, 8)                \
+    X(gemm_fixed_16x16x16, 16, 16, 16)          \
+    X(gemm_fixed_5x24x10, 5, 24, 10)
+
+#define FIXED_GEMV_SHAPES(X)                    \
+    X(gemv_fixed_16x16, 16, 16)                 \
+    X(gemv_fixed_64x64, 64, 64)                 \
+    X(gemv_fixed_10x32, 10, 32)
+
+#define FIXED_CONV2D_SHAPES(X)                                  \
+    X(conv2d_fixed_8x8_3x3, 8, 8, 3, 3, 1, 1, 1, 1)             \
+    X(conv2d_fixed_16x16_3x3, 16, 16, 3, 3, 1, 1, 1, 1)         \
+    X(conv2d_fixed_16x16_3x3_s2, 16, 16, 3, 3, 2, 2, 1, 1)
+#endif
+
+FIXED_GEMM_SHAPES(GEMM_FIXED)
+FIXED_GEMV_SHAPES(GEMV_FIXED)
+FIXED_CONV2D_SHAPES(CONV2D_FIXED)
+
+double *x, *y, *result, *result_ref;
+size_t arena_start;
+
+static void prepare(size_t len_x, size_t len_y, size_t len_result) {
+    arena_reset(arena_global(), arena_start);
+    x = allocate(len_x, sizeof(double));
+    y = allocate(len_y, sizeof(double));
+    result_ref = allocate(len_result, sizeof(double));
+    result = allocate(len_result, sizeof(double));
+    for (size_t i = 0; i < len_x; i++) {
+        x[i] = (double)(i % 13);
+    }
+    for (size_t i = 0; i < len_y; i++) {
+        y[i] = (double)(i % 7) - 3.0;
+    }
+}
+
+#define BENCH_GEMM_FIXED(name, M, N, K)                                 \
+    size = (M) * (N) * (K);                                             \
+    bench_shape(3, "M", (size_t)(M), "N", (size_t)(N), "K", (size_t)(K)); \
+    prepare((M) * (N), (N) * (K), (M) * (K));                           \
+    BENCH_VO(gemm_ssr_frep_blocked, x, y, M, N, K, result_ref);         \
+    BENCH_VO(name, x, y, result);                                       \
+    verify_vector(result, result_ref, (M) * (K));
+
+#define BENCH_GEMV_FIXED(name, M, N)                                    \
+    size = (M) * (N);                                                   \
+    bench_shape(2, "M", (size_t)(M), "N", (size_t)(N));                 \
+    prepare((M) * (N), (N), (M));                                       \
+    BENCH_VO(gemv_ssr_frep, x, y, M, N, result_ref);                    \
+    BENCH_VO(name, x, y, result);                                       \
+    verify_vector(result, result_ref, (M));
+
+#define BENCH_CONV2D_FIXED(name, N0, N1, F0, F1, S0, S1, D0, D1)        \
+    size = FIXED_CONV_OUTPUT_SIZE(N0, F0, S0, D0) * FIXED_CONV_OUTPUT_SIZE(N1, F1, S1, D1); \
+    bench_shape(4, "n0", (size_t)(N0), "n1", (size_t)(N1), "f0", (size_t)(F0), "f1", (size_t)(F1)); \
+    prepare((N0) * (N1), (F0) * (F1), size);                            \
+    BENCH_VO(conv2d_ssr_frep, x, y, N0, N1, F0, F1, S0, S1, D0, D1, result_ref); \
+    BENCH_VO(name, x, y, result);                                       \
+    verify_vector(result, result_ref, size);
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    arena_start = arena_mark(arena_global());
+    // The specialized kernels are single core
+    if (core_idx == 0) {
+        FIXED_GEMM_SHAPES(BENCH_GEMM_FIXED)
+        FIXED_GEMV_SHAPES(BENCH_GEMV_FIXED)
+        FIXED_CONV2D_SHAPES(BENCH_CONV2D_FIXED)
+    }
+    snrt_cluster_hw_barrier();
+
+    return 0;
+}
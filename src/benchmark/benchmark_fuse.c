@@ -0,0 +1,122 @@
+#include <snrt.h>
+#include "printf.h"
+#include <stdlib.h>
+
+#include "lmq.h"
+#include "fuse.h"
+#include "abs.h"
+#include "add.h"
+#include "relu.h"
+#include "sigmoid.h"
+#include "benchmark.h"
+
+double *x, *bias, *tmp, *result_ref, *result;
+
+/*
+ * add -> leakyrelu -> sigmoid (one pass after fpmath_exp), abs -> add (one stage)
+ * and a chain of three passes with two vector operands.
+ */
+#define NUM_CASES 3
+fuse_op_t chains[NUM_CASES][8];
+const size_t chain_lens[NUM_CASES] = {3, 2, 8};
+
+static void set_chains() {
+    chains[0][0] = (fuse_op_t){FUSE_ADD, 0.0, 0.0, bias};
+    chains[0][1] = (fuse_op_t){FUSE_LEAKYRELU, 0.01, 0.0, NULL};
+    chains[0][2] = (fuse_op_t){FUSE_SIGMOID, 0.0, 0.0, NULL};
+
+    chains[1][0] = (fuse_op_t){FUSE_ABS, 0.0, 0.0, NULL};
+    chains[1][1] = (fuse_op_t){FUSE_ADD, 0.0, 0.0, bias};
+
+    chains[2][0] = (fuse_op_t){FUSE_MUL, 2.0, 0.0, NULL};
+    chains[2][1] = (fuse_op_t){FUSE_ADD, 0.5, 0.0, NULL};
+    chains[2][2] = (fuse_op_t){FUSE_RELU, 0.0, 0.0, NULL};
+    chains[2][3] = (fuse_op_t){FUSE_CLIP, 0.0, 6.0, NULL};
+    chains[2][4] = (fuse_op_t){FUSE_MUL, 0.0, 0.0, bias};
+    chains[2][5] = (fuse_op_t){FUSE_ABS, 0.0, 0.0, NULL};
+    chains[2][6] = (fuse_op_t){FUSE_SUB, 0.0, 0.0, x};
+    chains[2][7] = (fuse_op_t){FUSE_LEAKYRELU, 0.1, 0.0, NULL};
+}
+
+/*
+ * The first two chains as separate kernels, each a full pass over memory.
+ */
+__attribute__((noinline))
+int add_leakyrelu_sigmoid_unfused(double* arr, const size_t n, double* result) {
+    add_ssr_frep(arr, bias, n, tmp);
+    leakyrelu_ssr(tmp, n, 0.01, tmp);
+    sigmoid_ssr_frep(tmp, n, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int abs_add_unfused(double* arr, const size_t n, double* result) {
+    fabs_ssr_frep(arr, n, tmp);
+    add_ssr_frep(tmp, bias, n, result);
+    return 0;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_fuse\n");
+
+        x = allocate(size, sizeof(double));
+        bias = allocate(size, sizeof(double));
+        tmp = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
+
+        srandom(2);
+        for (size_t i = 0; i < size; i++) {
+            x[i] = 8.0 * random() / __LONG_MAX__ - 4.0;
+            bias[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+        }
+        set_chains();
+
+        for (size_t c = 0; c < NUM_CASES; c++) {
+            BENCH_VO(fuse_baseline, x, size, chains[c], chain_lens[c], result_ref);
+
+            BENCH_VO(fuse_ssr, x, size, chains[c], chain_lens[c], result);
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+
+            BENCH_VO(fuse_ssr_frep, x, size, chains[c], chain_lens[c], result);
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+
+            if (c == 0) {
+                BENCH_VO(add_leakyrelu_sigmoid_unfused, x, size, result);
+                verify_vector_approx(result, result_ref, size);
+                clear_vector(result, size);
+            } else if (c == 1) {
+                BENCH_VO(abs_add_unfused, x, size, result);
+                verify_vector(result, result_ref, size);
+                clear_vector(result, size);
+            }
+        }
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        for (size_t c = 0; c < NUM_CASES; c++) {
+            if (core_idx == 0) {
+                fuse_baseline(x, size, chains[c], chain_lens[c], result_ref);
+            }
+
+            BENCH_VO_PARALLEL(fuse_ssr_frep_parallel, x, size, chains[c], chain_lens[c], result);
+            if (core_idx == 0) {
+                verify_vector_approx(result, result_ref, size);
+                clear_vector(result, size);
+            }
+        }
+    }
+
+    return 0;
+}
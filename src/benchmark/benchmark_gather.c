@@ -0,0 +1,100 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "gather.h"
+
+/*
+ * An embedding table of (size / DIM, DIM) in global memory: Gather of as many random rows (negative indices
+ * included) as the table has, GatherElements and ScatterElements (add and none) along axis 0 with indices of
+ * (rows / 2, DIM).
+ */
+#define DIM 16
+
+double *table, *updates, *result, *result_ref;
+int32_t *indices;
+size_t rows;
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; core_idx == 0 && size <= LMQ_SIZE; size *= 2) {
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_gather\n");
+
+        rows = size / DIM + 1;
+        table = allocate(rows * DIM, sizeof(double));
+        updates = allocate(rows * DIM, sizeof(double));
+        result = allocate(rows * DIM, sizeof(double));
+        result_ref = allocate(rows * DIM, sizeof(double));
+        indices = allocate(rows * DIM, sizeof(int32_t));
+
+        srandom(2);
+        for (size_t i = 0; i < rows * DIM; i++) {
+            table[i] = (double) i;
+            updates[i] = (double) (i % 7);
+            indices[i] = (int32_t) (random() % (2 * rows)) - (int32_t) rows;
+        }
+        size_t gather_size = size;
+        size = rows * DIM;
+
+        BENCH_VO(gather_baseline, table, 1, rows, DIM, indices, rows, result_ref);
+        BENCH_VO(gather_ssr_frep, table, 1, rows, DIM, indices, rows, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        size = rows / 2 * DIM;
+        BENCH_VO(gather_elements_baseline, table, 1, rows, DIM, indices, rows / 2, result_ref);
+
+        size = rows * DIM;
+        BENCH_VO(scatter_elements_baseline, table, 1, rows, DIM, indices, updates, rows / 2, SCATTER_ADD, result);
+        BENCH_VO(scatter_elements_baseline, table, 1, rows, DIM, indices, updates, rows / 2, SCATTER_NONE, result);
+
+        size = gather_size;
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel, on the buffers of the last size */
+    if (core_idx == 0) {
+        printf("Running benchmark_gather parallel\n");
+        gather_baseline(table, 1, rows, DIM, indices, rows, result_ref);
+    }
+    size = rows * DIM;
+    snrt_cluster_hw_barrier();
+
+    BENCH_VO_PARALLEL(gather_ssr_frep_parallel, table, 1, rows, DIM, indices, rows, result);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+    }
+    BENCH_VO_PARALLEL(gather_dma, table, 1, rows, DIM, indices, rows, result);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+        gather_elements_baseline(table, 1, rows, DIM, indices, rows / 2, result_ref);
+    }
+    snrt_cluster_hw_barrier();
+
+    size = rows / 2 * DIM;
+    BENCH_VO_PARALLEL(gather_elements_parallel, table, 1, rows, DIM, indices, rows / 2, result);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+        scatter_elements_baseline(table, 1, rows, DIM, indices, updates, rows / 2, SCATTER_ADD, result_ref);
+    }
+    snrt_cluster_hw_barrier();
+
+    size = rows * DIM;
+    BENCH_VO_PARALLEL(scatter_elements_parallel, table, 1, rows, DIM, indices, updates, rows / 2, SCATTER_ADD,
+                      result);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, size);
+    }
+
+    return 0;
+}
@@ -3,28 +3,35 @@
 
 #include "lmq.h"
 #include "benchmark.h"
+#include "golden.h"
 #include "gemm.h"
 
 int print_gemm_pattern(const double* a, size_t m, size_t n, size_t k, double* result, size_t result_len);
 int print_other_gemm_pattern(const double* a, size_t m, size_t n, size_t k, double* result, size_t result_len);
 
-double *x, *y, *result_ref, *result;
+double *x, *y, *c, *result_ref, *result;
 
 int main() {
     uint32_t core_idx = snrt_cluster_core_idx();
     uint32_t core_num = snrt_cluster_core_num() - 1; // -1 as there is one DM core
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2) {
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         uint32_t sqrt = sqrt_approx(size);
         size_t M = sqrt / 2;
         size_t N = sqrt * 2;
         size_t K = sqrt / 2;
+        bench_shape(3, "M", M, "N", N, "K", K);
                             // sqrt / 2 * sqrt * 2 --> size
         x = allocate(M * N, sizeof(double));
                             // sqrt * 2 * sqrt / 2 --> size
         y = allocate(N * K, sizeof(double));
         result_ref = allocate(M * K, sizeof(double));
         result = allocate(M * K, sizeof(double));
+        c = allocate(M * K, sizeof(double));
 
         for (size_t i = 0; i < M * N; i++) {
             x[i] = (double)i;
@@ -34,7 +41,11 @@ int main() {
             y[i] = (double)i;
         }
 
-        BENCH_VO(gemm_baseline, x, y, M, N, K, result_ref);
+        for (size_t i = 0; i < M * K; i++) {
+            c[i] = 1.0 * i;
+        }
+
+        BENCH_REF(result_ref, gemm_baseline, x, y, M, N, K, result_ref);
         
         BENCH_VO(gemm_ssr, x, y, M, N, K, result);
         verify_vector(result, result_ref, M * K);
@@ -43,6 +54,44 @@ int main() {
         BENCH_VO(gemm_ssr_frep, x, y, M, N, K, result);
         verify_vector(result, result_ref, M * K);
         clear_vector(result, M * K);
+
+        BENCH_VO(gemm_ssr_frep_blocked, x, y, M, N, K, result);
+        verify_vector(result, result_ref, M * K);
+        clear_vector(result, M * K);
+
+        // float32 (packed SIMD), y is used as the transposed b
+        float* xf = allocate(M * N, sizeof(float));
+        float* yf = allocate(N * K, sizeof(float));
+        float* result_ref_f = allocate(M * K, sizeof(float));
+        float* result_f = allocate(M * K, sizeof(float));
+        for (size_t i = 0; i < M * N; i++) {
+            xf[i] = (float)(i % 16);
+        }
+        for (size_t i = 0; i < N * K; i++) {
+            yf[i] = (float)(i % 16);
+        }
+
+        BENCH_VO(gemm_baseline_f32, xf, yf, M, N, K, result_ref_f);
+
+        BENCH_VO(gemm_ssr_frep_f32, xf, yf, M, N, K, result_f);
+        verify_vector_f32(result_f, result_ref_f, M * K);
+
+        // ONNX Gemm with all combinations of transposes
+        for (int trans = 0; trans < 4; trans++) {
+            int trans_a = trans & 1;
+            int trans_b = trans >> 1;
+            printf("trans_a: %d, trans_b: %d\n", trans_a, trans_b);
+
+            BENCH_VO(gemm_onnx_baseline, x, y, c, M, N, K, trans_a, trans_b, 0.5, 2.0, result_ref);
+
+            BENCH_VO(gemm_onnx_ssr, x, y, c, M, N, K, trans_a, trans_b, 0.5, 2.0, result);
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+
+            BENCH_VO(gemm_onnx_ssr_frep, x, y, c, M, N, K, trans_a, trans_b, 0.5, 2.0, result);
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
     }
  
     for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
@@ -50,6 +99,7 @@ int main() {
         size_t M = sqrt / 2;
         size_t N = sqrt * 2;
         size_t K = sqrt / 2;
+        bench_shape(3, "M", M, "N", N, "K", K);
 
         if (core_idx == 0) {
             for (size_t i = 0; i < M * N; i++) {
@@ -83,13 +133,119 @@ int main() {
             clear_vector(result, M * K);
         }
 
-        BENCH_VO_PARALLEL(gemm_ssr_frep_parallel, x, y, M, N, K, result);
+        BENCH_VO_PARALLEL_CORES(gemm_ssr_frep_parallel, x, y, M, N, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+
+        BENCH_VO_PARALLEL_CORES(gemm_ssr_frep_tiled_parallel, x, y, M, N, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+
+        BENCH_VO_PARALLEL(gemm_ssr_frep_blocked_parallel, x, y, M, N, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+
+        if (core_idx == 0) {
+            gemm_onnx_baseline(x, y, c, M, N, K, 1, 1, 0.5, 2.0, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(gemm_onnx_ssr_frep_parallel, x, y, c, M, N, K, 1, 1, 0.5, 2.0, result);
         if (core_idx == 0) {
             verify_vector(result, result_ref, M * K);
             clear_vector(result, M * K);
         }
     }
 
+    /* Benchmark batches of small 4x4 problems */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
+        size_t dim = 4;
+        size_t batch = size / (dim * dim);
+        size_t stride = dim * dim;
+        bench_shape(2, "batch", batch, "dim", dim);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(batch * stride, sizeof(double));
+            y = allocate(batch * stride, sizeof(double));
+            result_ref = allocate(batch * stride, sizeof(double));
+            result = allocate(batch * stride, sizeof(double));
+
+            for (size_t i = 0; i < batch * stride; i++) {
+                x[i] = (double)i;
+                y[i] = (double)(i % 7);
+            }
+            gemm_batched_baseline(x, y, batch, stride, stride, stride, dim, dim, dim, result_ref);
+
+            BENCH_VO(gemm_batched_ssr_frep, x, y, batch, stride, stride, stride, dim, dim, dim, result);
+            verify_vector(result, result_ref, batch * stride);
+            clear_vector(result, batch * stride);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(gemm_batched_ssr_frep_parallel, x, y, batch, stride, stride, stride, dim, dim, dim, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, batch * stride);
+            clear_vector(result, batch * stride);
+        }
+    }
+
+    /* Benchmark matrix vector products (k = 1) */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
+        size_t N = 32;
+        size_t M = size / N + 3;
+        bench_shape(2, "M", M, "N", N);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(M * N, sizeof(double));
+            y = allocate(N, sizeof(double));
+            result_ref = allocate(M, sizeof(double));
+            result = allocate(M, sizeof(double));
+
+            for (size_t i = 0; i < M * N; i++) {
+                x[i] = (double)(i % 11);
+            }
+            for (size_t i = 0; i < N; i++) {
+                y[i] = (double)(i % 5);
+            }
+
+            BENCH_VO(gemv_baseline, x, y, M, N, result_ref);
+
+            BENCH_VO(gemm_ssr_frep, x, y, M, N, 1, result);
+            verify_vector(result, result_ref, M);
+            clear_vector(result, M);
+
+            BENCH_VO(gemv_ssr_frep, x, y, M, N, result);
+            verify_vector(result, result_ref, M);
+            clear_vector(result, M);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(gemv_ssr_frep_parallel, x, y, M, N, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M);
+            clear_vector(result, M);
+        }
+    }
+
+    // Restore the buffers of the largest size for the OMP benchmarks
+    if (core_idx == 0) {
+        uint32_t sqrt = sqrt_approx(size);
+        arena_reset(arena_global(), arena_start);
+        x = allocate((sqrt / 2) * (sqrt * 2), sizeof(double));
+        y = allocate((sqrt * 2) * (sqrt / 2), sizeof(double));
+        result_ref = allocate((sqrt / 2) * (sqrt / 2), sizeof(double));
+        result = allocate((sqrt / 2) * (sqrt / 2), sizeof(double));
+    }
+    snrt_cluster_hw_barrier();
+
     // Benchmark OMP
     __snrt_omp_bootstrap(core_idx);
 
@@ -98,6 +254,7 @@ int main() {
         size_t M = sqrt / 2;
         size_t N = sqrt * 2;
         size_t K = sqrt / 2;
+        bench_shape(3, "M", M, "N", N, "K", K);
 
         if (core_idx == 0) {
             for (size_t i = 0; i < M * N; i++) {
@@ -127,6 +284,19 @@ int main() {
         BENCH_VO_OMP(gemm_ssr_frep_omp, x, y, M, N, K, result);
         verify_vector(result, result_ref, M * K);
         clear_vector(result, M * K);
+
+        BENCH_VO_OMP(gemm_ssr_frep_blocked_omp, x, y, M, N, K, result);
+        verify_vector(result, result_ref, M * K);
+        clear_vector(result, M * K);
+
+        // x times the first N elements of y
+        if (core_idx == 0) {
+            gemv_baseline(x, y, M, N, result_ref);
+        }
+
+        BENCH_VO_OMP(gemv_ssr_frep_omp, x, y, M, N, result);
+        verify_vector(result, result_ref, M);
+        clear_vector(result, M);
     }
     
     __snrt_omp_destroy(core_idx);
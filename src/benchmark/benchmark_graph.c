@@ -0,0 +1,158 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "graph.h"
+
+#define NUM_ENTRIES(table) (sizeof(table) / sizeof(table[0]))
+
+/*
+ * A 64-32-16-10 MLP with batch 4 and a CNN of one 3x3 convolution, 2x2 max pooling and a dense layer
+ * on an 18x18 image, as a generated header would give them. The printed size is the number of input elements.
+ */
+
+// MLP: x -> gemm -> bias -> relu -> gemm -> bias -> relu -> gemm -> bias -> softmax
+#define MLP_BATCH 4
+graph_tensor_t mlp_tensors[] = {
+    {GRAPH_INPUT, MLP_BATCH * 64, NULL},        // 0 x
+    {GRAPH_CONST, 64 * 32, NULL},               // 1 w1
+    {GRAPH_CONST, 32, NULL},                    // 2 b1
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 32, NULL}, // 3
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 32, NULL}, // 4
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 32, NULL}, // 5
+    {GRAPH_CONST, 32 * 16, NULL},               // 6 w2
+    {GRAPH_CONST, 16, NULL},                    // 7 b2
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 16, NULL}, // 8
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 16, NULL}, // 9
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 16, NULL}, // 10
+    {GRAPH_CONST, 16 * 10, NULL},               // 11 w3
+    {GRAPH_CONST, 10, NULL},                    // 12 b3
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 10, NULL}, // 13
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 10, NULL}, // 14
+    {GRAPH_OUTPUT, MLP_BATCH * 10, NULL},       // 15 probabilities
+};
+
+const graph_node_t mlp_nodes[] = {
+    {GRAPH_GEMM, GRAPH_SPLIT, {0, 1, -1}, 3, {MLP_BATCH, 64, 32}},
+    {GRAPH_BIAS, GRAPH_SPLIT, {3, 2, -1}, 4, {MLP_BATCH, 32}},
+    {GRAPH_RELU, GRAPH_SPLIT, {4, -1, -1}, 5, {MLP_BATCH * 32}},
+    {GRAPH_GEMM, GRAPH_SPLIT, {5, 6, -1}, 8, {MLP_BATCH, 32, 16}},
+    {GRAPH_BIAS, GRAPH_SPLIT, {8, 7, -1}, 9, {MLP_BATCH, 16}},
+    {GRAPH_RELU, GRAPH_SPLIT, {9, -1, -1}, 10, {MLP_BATCH * 16}},
+    {GRAPH_GEMM, GRAPH_SPLIT, {10, 11, -1}, 13, {MLP_BATCH, 16, 10}},
+    {GRAPH_BIAS, GRAPH_SPLIT, {13, 12, -1}, 14, {MLP_BATCH, 10}},
+    {GRAPH_SOFTMAX, GRAPH_SPLIT, {14, -1, -1}, 15, {MLP_BATCH, 10}},
+};
+
+// CNN: image -> conv2d 3x3 -> relu -> maxpool2d 2x2 -> gemm -> bias -> softmax
+graph_tensor_t cnn_tensors[] = {
+    {GRAPH_INPUT, 18 * 18, NULL},       // 0 image
+    {GRAPH_CONST, 3 * 3, NULL},         // 1 filter
+    {GRAPH_INTERMEDIATE, 16 * 16, NULL},// 2
+    {GRAPH_INTERMEDIATE, 16 * 16, NULL},// 3
+    {GRAPH_INTERMEDIATE, 8 * 8, NULL},  // 4
+    {GRAPH_CONST, 64 * 10, NULL},       // 5 w
+    {GRAPH_INTERMEDIATE, 10, NULL},     // 6
+    {GRAPH_CONST, 10, NULL},            // 7 b
+    {GRAPH_INTERMEDIATE, 10, NULL},     // 8
+    {GRAPH_OUTPUT, 10, NULL},           // 9 probabilities
+};
+
+// the dense layer has a single row, it runs on core 0
+const graph_node_t cnn_nodes[] = {
+    {GRAPH_CONV2D, GRAPH_SPLIT, {0, 1, -1}, 2, {18, 18, 3, 3, 1, 1, 1, 1}},
+    {GRAPH_RELU, GRAPH_SPLIT, {2, -1, -1}, 3, {16 * 16}},
+    {GRAPH_MAXPOOL2D, GRAPH_SPLIT, {3, -1, -1}, 4, {16, 16, 2, 2, 2, 2}},
+    {GRAPH_GEMM, GRAPH_SERIAL, {4, 5, -1}, 6, {1, 64, 10}},
+    {GRAPH_BIAS, GRAPH_SERIAL, {6, 7, -1}, 8, {1, 10}},
+    {GRAPH_SOFTMAX, GRAPH_SERIAL, {8, -1, -1}, 9, {1, 10}},
+};
+
+graph_t mlp = {mlp_tensors, NUM_ENTRIES(mlp_tensors), mlp_nodes, NUM_ENTRIES(mlp_nodes)};
+graph_t cnn = {cnn_tensors, NUM_ENTRIES(cnn_tensors), cnn_nodes, NUM_ENTRIES(cnn_nodes)};
+
+double *mlp_result, *mlp_result_ref, *cnn_result, *cnn_result_ref;
+
+static int graph_mlp_baseline(const graph_t* g) {
+    return graph_run_baseline(g);
+}
+
+static int graph_mlp_ssr_frep_parallel(const graph_t* g) {
+    return graph_run(g);
+}
+
+static int graph_cnn_baseline(const graph_t* g) {
+    return graph_run_baseline(g);
+}
+
+static int graph_cnn_ssr_frep_parallel(const graph_t* g) {
+    return graph_run(g);
+}
+
+/*
+ * Allocates the inputs, weights and outputs of g, fills the inputs and weights and plans the intermediates.
+ * Returns the output tensor.
+ */
+static graph_tensor_t* graph_setup(const char* name, graph_t* g) {
+    graph_tensor_t* output = NULL;
+    for (size_t t = 0; t < g->num_tensors; t++) {
+        graph_tensor_t* tensor = &g->tensors[t];
+        if (tensor->kind == GRAPH_INTERMEDIATE) {
+            continue;
+        }
+        tensor->data = allocate(tensor->size, sizeof(double));
+        for (size_t i = 0; i < tensor->size; i++) {
+            tensor->data[i] = tensor->kind == GRAPH_INPUT ? 0.1 * (double)((int)(i % 9) - 4)
+                                                          : 0.05 * (double)((int)((i + t) % 7) - 3);
+        }
+        if (tensor->kind == GRAPH_OUTPUT) {
+            output = tensor;
+        }
+    }
+    int ret = graph_plan(g);
+    printf("graph %s: %d nodes, plan %d: L1 pool %d bytes, global pool %d bytes (allocate per intermediate: %d bytes)\n",
+           name, g->num_nodes, ret, g->l1_bytes, g->global_bytes, g->unplanned_bytes);
+    return output;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    graph_tensor_t* mlp_output = NULL;
+    graph_tensor_t* cnn_output = NULL;
+    if (core_idx == 0) {
+        mlp_output = graph_setup("mlp", &mlp);
+        cnn_output = graph_setup("cnn", &cnn);
+        mlp_result = mlp_output->data;
+        cnn_result = cnn_output->data;
+        mlp_result_ref = allocate(mlp_output->size, sizeof(double));
+        cnn_result_ref = allocate(cnn_output->size, sizeof(double));
+
+        // the reference writes to its own buffer
+        size = mlp_tensors[0].size;
+        mlp_output->data = mlp_result_ref;
+        BENCH_VO(graph_mlp_baseline, &mlp);
+        mlp_output->data = mlp_result;
+
+        size = cnn_tensors[0].size;
+        cnn_output->data = cnn_result_ref;
+        BENCH_VO(graph_cnn_baseline, &cnn);
+        cnn_output->data = cnn_result;
+    }
+    snrt_cluster_hw_barrier();
+
+    size = mlp_tensors[0].size;
+    BENCH_VO_PARALLEL(graph_mlp_ssr_frep_parallel, &mlp);
+    if (core_idx == 0) {
+        verify_vector_approx(mlp_result, mlp_result_ref, mlp_output->size);
+    }
+
+    size = cnn_tensors[0].size;
+    BENCH_VO_PARALLEL(graph_cnn_ssr_frep_parallel, &cnn);
+    if (core_idx == 0) {
+        verify_vector_approx(cnn_result, cnn_result_ref, cnn_output->size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "half.h"
+#include "gemm.h"
+#include "conv.h"
+
+/*
+ * The fp16 and bf16 kernels of src/onnx/half.h against the fp64 kernels on the same shapes, like benchmark_quant:
+ * square matrices of (dim x dim) with dim * dim <= size (the printed size of the gemms is dim^3) and a 3x3
+ * convolution of a (dim x dim) image with values in [-1, 1). The accuracy lines compare the mixed precision
+ * results (rounded inputs, fp64 or with LMQ_XFDOTP fp32 accumulation) with gemm_ssr_frep and conv2d_ssr_frep on
+ * the unrounded doubles, the half outputs are checked bit exact against the rounded baseline.
+ * The footprint line gives the bytes of the operands of a gemm in both types.
+ */
+#define FILTER 3
+
+static const half_format_t formats[] = {HALF_FP16, HALF_BF16};
+static const char* format_names[] = {"fp16", "bf16"};
+
+// The relative errors of the storage formats (2^-11 and 2^-8) times the dot product lengths
+static const double tolerances[] = {1e-2, 5e-2};
+
+double *x, *y, *yt, *filter, *result, *result_ref, *result_half;
+half_t *hx, *hyt, *hfilter, *hresult, *hresult_ref;
+float* fresult;
+
+static void verify_half(const char* name, const half_t* value, const half_t* reference, const size_t n) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; i++) {
+        mismatches += value[i] != reference[i];
+    }
+    if (mismatches > 0) {
+        printf("%s: %d of %d half outputs differ\n", name, mismatches, n);
+    }
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; core_idx == 0 && size <= LMQ_SIZE; size *= 2) {
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_half\n");
+
+        size_t dim = 1;
+        while ((dim + 1) * (dim + 1) <= size) {
+            dim++;
+        }
+        size_t n = dim * dim;
+        x = allocate(n, sizeof(double));
+        y = allocate(n, sizeof(double));
+        yt = allocate(n, sizeof(double));
+        filter = allocate(FILTER * FILTER, sizeof(double));
+        result = allocate(n, sizeof(double));
+        result_ref = allocate(n, sizeof(double));
+        result_half = allocate(n, sizeof(double));
+        fresult = allocate(n, sizeof(float));
+        hx = allocate(n, sizeof(half_t));
+        hyt = allocate(n, sizeof(half_t));
+        hfilter = allocate(FILTER * FILTER, sizeof(half_t));
+        hresult = allocate(n, sizeof(half_t));
+        hresult_ref = allocate(n, sizeof(half_t));
+
+        srandom(2);
+        for (size_t i = 0; i < n; i++) {
+            x[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+            y[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+        }
+        for (size_t i = 0; i < dim; i++) {
+            for (size_t j = 0; j < dim; j++) {
+                yt[j * dim + i] = y[i * dim + j];
+            }
+        }
+        for (size_t i = 0; i < FILTER * FILTER; i++) {
+            filter[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+        }
+
+        size_t conv_size = conv_output_size(dim, FILTER, 1, 1);
+        size_t outputs = conv_size * conv_size;
+        size_t gemm_size = size;
+
+        for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+            half_format_t format = formats[f];
+            printf("half format: %s\n", format_names[f]);
+            size = n;
+            BENCH_VO(cast_to_half_baseline, x, n, format, hx);
+            cast_to_half_baseline(yt, n, format, hyt);
+            cast_to_half_baseline(filter, FILTER * FILTER, format, hfilter);
+
+            size = dim * dim * dim;
+            printf("half footprint, size: %d: fp64 %d bytes, %s %d bytes\n", size, 3 * n * sizeof(double),
+                   format_names[f], 3 * n * sizeof(half_t));
+            bench_shape(3, "M", dim, "N", dim, "K", dim);
+            BENCH_VO(gemm_ssr_frep, x, y, dim, dim, dim, result_ref);
+
+            BENCH_VO(gemm_half_baseline, hx, hyt, dim, dim, dim, format, HALF_FP64, result_half);
+            report_accuracy(format == HALF_FP16 ? "gemm_half_baseline_fp16" : "gemm_half_baseline_bf16",
+                            result_half, result_ref, n, tolerances[f]);
+
+            BENCH_VO(gemm_half_ssr_frep, hx, hyt, dim, dim, dim, format, HALF_FP64, result);
+            verify_vector(result, result_half, n);
+            clear_vector(result, n);
+
+            // The output rounded to the storage format, f.ex. as the input of the next layer
+            cast_to_half_baseline(result_half, n, format, hresult_ref);
+            BENCH_VO(gemm_half_ssr_frep, hx, hyt, dim, dim, dim, format, format, hresult);
+            verify_half("gemm_half_ssr_frep", hresult, hresult_ref, n);
+
+#ifdef LMQ_XFDOTP
+            if (format == HALF_FP16) {
+                BENCH_VO(gemm_half_ssr_frep_dotp, hx, hyt, dim, dim, dim, format, HALF_FP32, fresult);
+                for (size_t i = 0; i < n; i++) {
+                    result[i] = fresult[i];
+                }
+                report_accuracy("gemm_half_ssr_frep_dotp_fp16", result, result_ref, n, tolerances[f]);
+                clear_vector(result, n);
+            }
+#endif
+            bench_shape(0);
+
+            size = outputs;
+            BENCH_VO(conv2d_ssr_frep, x, filter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, result_ref);
+            BENCH_VO(conv2d_half_baseline, hx, hfilter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, format, HALF_FP64,
+                     result_half);
+            report_accuracy(format == HALF_FP16 ? "conv2d_half_baseline_fp16" : "conv2d_half_baseline_bf16",
+                            result_half, result_ref, outputs, tolerances[f]);
+            BENCH_VO(conv2d_half_ssr_frep, hx, hfilter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, format, HALF_FP64,
+                     result);
+            verify_vector_approx(result, result_half, outputs);
+            clear_vector(result, outputs);
+
+            size = gemm_size;
+        }
+    }
+
+    return 0;
+}
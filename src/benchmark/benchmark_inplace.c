@@ -0,0 +1,178 @@
+#include <snrt.h>
+#include "printf.h"
+#include <stdlib.h>
+
+#include "lmq.h"
+#include "abs.h"
+#include "acos.h"
+#include "acosh.h"
+#include "add.h"
+#include "asinh.h"
+#include "cumsum.h"
+#include "div.h"
+#include "erf.h"
+#include "exp.h"
+#include "fuse.h"
+#include "gelu.h"
+#include "masked_dropout.h"
+#include "relu.h"
+#include "sigmoid.h"
+#include "sin.h"
+#include "softmax.h"
+#include "softplus.h"
+#include "tanh.h"
+// Every run needs a fresh copy of the input, so the BENCH_VO macros stay single runs
+#undef LMQ_STATS
+#undef LMQ_PERF
+#include "benchmark.h"
+
+// x in [-4, 4], unit in [-1, 1] (acos), above in [1, 9] (acosh), mask of 0 and 1.
+// tmp is the buffer the kernels run in place on, result_ref the out of place baseline.
+double *x, *unit, *above, *mask, *tmp, *result_ref;
+
+#define CHAIN_LEN 3
+fuse_op_t chain[CHAIN_LEN];
+
+#define SOFTMAX_COLS 16
+
+static inline void copy_vector(const double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = arr[i];
+    }
+}
+
+/*
+ * Runs kernel on a copy of input with result == arr and compares it to baseline run out of place.
+ * The variadic arguments are the ones between n and result, each followed by a comma.
+ */
+#define INPLACE_UNARY(baseline, kernel, input, ...)                 \
+    do {                                                            \
+        baseline(input, size, __VA_ARGS__ result_ref);              \
+        copy_vector(input, size, tmp);                              \
+        BENCH_VO(kernel, tmp, size, __VA_ARGS__ tmp);               \
+        verify_vector_approx(tmp, result_ref, size);                \
+    } while (0);
+
+// Binary kernels with result == a
+#define INPLACE_BINARY(baseline, kernel, a, b)                      \
+    do {                                                            \
+        baseline(a, b, size, result_ref);                           \
+        copy_vector(a, size, tmp);                                  \
+        BENCH_VO(kernel, tmp, b, size, tmp);                        \
+        verify_vector_approx(tmp, result_ref, size);                \
+    } while (0);
+
+// The copy is made by core 0, BENCH_VO_PARALLEL starts with a barrier
+#define INPLACE_UNARY_PARALLEL(baseline, kernel, input, ...)        \
+    do {                                                            \
+        if (core_idx == 0) {                                        \
+            baseline(input, size, __VA_ARGS__ result_ref);          \
+            copy_vector(input, size, tmp);                          \
+        }                                                           \
+        BENCH_VO_PARALLEL(kernel, tmp, size, __VA_ARGS__ tmp);      \
+        if (core_idx == 0) {                                        \
+            verify_vector_approx(tmp, result_ref, size);            \
+        }                                                           \
+    } while (0);
+
+#define INPLACE_BINARY_PARALLEL(baseline, kernel, a, b)             \
+    do {                                                            \
+        if (core_idx == 0) {                                        \
+            baseline(a, b, size, result_ref);                       \
+            copy_vector(a, size, tmp);                              \
+        }                                                           \
+        BENCH_VO_PARALLEL(kernel, tmp, b, size, tmp);               \
+        if (core_idx == 0) {                                        \
+            verify_vector_approx(tmp, result_ref, size);            \
+        }                                                           \
+    } while (0);
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_inplace\n");
+
+        x = allocate(size, sizeof(double));
+        unit = allocate(size, sizeof(double));
+        above = allocate(size, sizeof(double));
+        mask = allocate(size, sizeof(double));
+        tmp = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+
+        srandom(2);
+        for (size_t i = 0; i < size; i++) {
+            x[i] = 8.0 * random() / __LONG_MAX__ - 4.0;
+            unit[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+            above[i] = 1.0 + 8.0 * random() / __LONG_MAX__;
+            mask[i] = random() % 2;
+        }
+        chain[0] = (fuse_op_t){FUSE_ADD, 0.0, 0.0, unit};
+        chain[1] = (fuse_op_t){FUSE_LEAKYRELU, 0.01, 0.0, NULL};
+        chain[2] = (fuse_op_t){FUSE_SIGMOID, 0.0, 0.0, NULL};
+
+        INPLACE_UNARY(fabs_baseline, fabs_ssr_frep, x);
+        INPLACE_UNARY(relu_baseline, relu_ssr_frep, x);
+        INPLACE_UNARY(leakyrelu_baseline, leakyrelu_ssr_frep, x, 0.01,);
+        INPLACE_UNARY(sigmoid_baseline, sigmoid_ssr_frep, x);
+        INPLACE_UNARY(sigmoid_baseline, sigmoid_lut, x);
+        INPLACE_UNARY(exp_baseline, exp_ssr_frep, x);
+        INPLACE_UNARY(erf_baseline, erf_ssr_frep, x);
+        INPLACE_UNARY(gelu_baseline, gelu_ssr_frep, x);
+        INPLACE_UNARY(tanh_baseline, tanh_ssr_frep, x);
+        INPLACE_UNARY(softplus_baseline, softplus_ssr_frep, x);
+        INPLACE_UNARY(sin_baseline, sin_ssr_frep, x);
+        INPLACE_UNARY(cos_baseline, cos_ssr_frep, x);
+        INPLACE_UNARY(acos_baseline, acos_ssr_frep, unit);
+        INPLACE_UNARY(acosh_baseline, acosh_ssr_frep, above);
+        INPLACE_UNARY(asinh_baseline, asinh_ssr_frep, x);
+        INPLACE_UNARY(fuse_baseline, fuse_ssr_frep, x, chain, CHAIN_LEN,);
+        INPLACE_UNARY(cumsum_onnx_baseline, cumsum_onnx_ssr_frep, x, 1, 0,);
+        INPLACE_UNARY(cumsum_onnx_baseline, cumsum_onnx_ssr_frep, x, 1, 1,);
+
+        INPLACE_BINARY(add_baseline, add_ssr_frep, x, unit);
+        INPLACE_BINARY(div_baseline, div_ssr_frep, x, above);
+        INPLACE_BINARY(div_baseline, div_ssr_frep_newton, x, above);
+
+        masked_dropout_baseline(x, mask, size, 0.5, result_ref);
+        copy_vector(x, size, tmp);
+        BENCH_VO(masked_dropout_ssr_frep, tmp, mask, size, 0.5, tmp);
+        verify_vector_approx(tmp, result_ref, size);
+
+        // Rows of SOFTMAX_COLS elements
+        softmax_baseline(x, size / SOFTMAX_COLS, SOFTMAX_COLS, result_ref);
+        copy_vector(x, size, tmp);
+        BENCH_VO(softmax_ssr_frep, tmp, size / SOFTMAX_COLS, SOFTMAX_COLS, tmp);
+        verify_vector_approx(tmp, result_ref, size / SOFTMAX_COLS * SOFTMAX_COLS);
+
+        VERIFY_INT(arena_check(arena_global()), 0, "Guard elements were overwritten at size %d\n", size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        INPLACE_UNARY_PARALLEL(fabs_baseline, fabs_ssr_frep_parallel, x);
+        INPLACE_UNARY_PARALLEL(leakyrelu_baseline, leakyrelu_ssr_frep_parallel, x, 0.01,);
+        INPLACE_UNARY_PARALLEL(sigmoid_baseline, sigmoid_ssr_frep_parallel, x);
+        INPLACE_UNARY_PARALLEL(exp_baseline, exp_ssr_frep_parallel, x);
+        INPLACE_UNARY_PARALLEL(gelu_baseline, gelu_ssr_frep_parallel, x);
+        INPLACE_UNARY_PARALLEL(tanh_baseline, tanh_ssr_frep_parallel, x);
+        INPLACE_UNARY_PARALLEL(sin_baseline, sin_ssr_frep_parallel, x);
+        INPLACE_UNARY_PARALLEL(acos_baseline, acos_ssr_frep_parallel, unit);
+        INPLACE_UNARY_PARALLEL(fuse_baseline, fuse_ssr_frep_parallel, x, chain, CHAIN_LEN,);
+        INPLACE_UNARY_PARALLEL(cumsum_onnx_baseline, cumsum_onnx_ssr_frep_parallel, x, 1, 0,);
+
+        INPLACE_BINARY_PARALLEL(add_baseline, add_ssr_frep_parallel, x, unit);
+        INPLACE_BINARY_PARALLEL(div_baseline, div_ssr_frep_newton_parallel, x, above);
+
+        if (core_idx == 0) {
+            VERIFY_INT(arena_check(arena_global()), 0, "Guard elements were overwritten at size %d\n", size);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "layernorm.h"
+#include "benchmark.h"
+
+#define ROWS 8
+
+double *x, *scale, *bias, *result_ref, *result;
+
+int main() {
+    uint32_t core_idx = snrt_global_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t cols = size / ROWS + 1;
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(ROWS * cols, sizeof(double));
+            scale = allocate(cols, sizeof(double));
+            bias = allocate(cols, sizeof(double));
+            result_ref = allocate(ROWS * cols, sizeof(double));
+            result = allocate(ROWS * cols, sizeof(double));
+
+            for (size_t i = 0; i < ROWS * cols; i++) {
+                x[i] = 4.0 + (double)((i * 7) % 13) / 4;
+            }
+            // Keeps the outputs positive for verify_vector_approx
+            for (size_t j = 0; j < cols; j++) {
+                scale[j] = 0.5 + 0.125 * (j % 8);
+                bias[j] = 8.0 + 0.25 * (j % 4);
+            }
+
+            printf("Running benchmark_layernorm\n");
+
+            BENCH_VO(layernorm_baseline, x, ROWS, cols, scale, bias, 1e-5, result_ref);
+
+            BENCH_VO(layernorm_ssr_frep, x, ROWS, cols, scale, bias, 1e-5, result);
+            verify_vector_approx(result, result_ref, ROWS * cols);
+            clear_vector(result, ROWS * cols);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(layernorm_ssr_frep_parallel, x, ROWS, cols, scale, bias, 1e-5, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, ROWS * cols);
+            clear_vector(result, ROWS * cols);
+        }
+        snrt_cluster_hw_barrier();
+    }
+
+    return 0;
+}
@@ -6,17 +6,26 @@
 #include "masked_dropout.h"
 #include "benchmark.h"
 
+// x is input; result is output of the optimized functions
+double *x, *mask, *result_ref, *result;
+// mask packed to one bit per element
+uint32_t *mask_bits;
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_masked_dropout\n");
 
-        // x is input; result is output of the optimized functions
-        double* x = allocate(size, sizeof(double));
-        double* mask = allocate(size, sizeof(double));
-        double* result_ref = allocate(size, sizeof(double));
-        double* result = allocate(size, sizeof(double));
+        x = allocate(size, sizeof(double));
+        mask = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
+        mask_bits = allocate((size + 31) / 32, sizeof(uint32_t));
 
         const double ratio = 0.5; // probability of dropout
 
@@ -33,6 +42,13 @@ int main() {
             }
         }
 
+        for (size_t i = 0; i < size; i++) {
+            if (i % 32 == 0) {
+                mask_bits[i / 32] = 0;
+            }
+            mask_bits[i / 32] |= (mask[i] != 0) << (i % 32);
+        }
+
         // For debugging purposes
         // for (size_t i = 0; i < size; i++) {
         //     printf("Input at index %d is %f\n", i, x[i]);
@@ -51,6 +67,27 @@ int main() {
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
 
+        BENCH(masked_dropout_bits_baseline, x, mask_bits, size, ratio, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH(masked_dropout_bits_ssr_frep, x, mask_bits, size, ratio, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        if (core_idx == 0) {
+            masked_dropout_baseline(x, mask, size, 0.5, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(masked_dropout_bits_ssr_frep_parallel, x, mask_bits, size, 0.5, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
     }
 
     return 0;
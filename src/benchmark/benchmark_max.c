@@ -5,29 +5,32 @@
 #include "lmq.h"
 #include "max.h"
 #include "benchmark.h"
+#include "golden.h"
+
+// x is input; result is output of the optimized functions
+double *x;
+double result_ref, result;
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_max\n");
 
-        // x is input; result is output of the optimized functions
-        double *x = allocate(size, sizeof(double));
-        double result_ref;
-        double result;
+        x = allocate(size, sizeof(double));
 
-        srandom(2);
-        for (size_t i = 0; i < size; i++) {
-            x[i] = 1.0 * random() / __LONG_MAX__;
-        }
+        golden_fill(x, size, 0, 1.0);
 
         // For debugging purposes
         // for (size_t i = 0; i < size; i++) {
         //     printf("Input at index %d is %f\n", i, x[i]);
         // }
 
-        BENCH(max_baseline, x, size, &result_ref);
+        BENCH_REF(&result_ref, max_baseline, x, size, &result_ref);
         // printf("Result is: %f\n", result_ref);
         
         BENCH(max_ssr, x, size, &result);
@@ -38,8 +41,64 @@ int main() {
         BENCH(max_ssr_frep, x, size, &result);
         VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
         // printf("Result is: %f\n", result);
+        result = -1;
+
+        BENCH(max_ssr_frep_staggered, x, size, &result);
+        VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
     }
 
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        if (core_idx == 0) {
+            max_baseline(x, size, &result_ref);
+        }
+
+        BENCH_VO_PARALLEL(max_parallel, x, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
+            result = -1;
+        }
+
+        BENCH_VO_PARALLEL(max_ssr_parallel, x, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
+            result = -1;
+        }
+
+        BENCH_VO_PARALLEL(max_ssr_frep_parallel, x, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
+            result = -1;
+        }
+
+        BENCH_VO_PARALLEL(max_ssr_frep_tiled, x, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
+            result = -1;
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        max_baseline(x, size, &result_ref);
+
+        BENCH_VO_OMP(max_omp, x, size, &result);
+        VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
+        result = -1;
+
+        BENCH_VO_OMP(max_ssr_omp, x, size, &result);
+        VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
+        result = -1;
+
+        BENCH_VO_OMP(max_ssr_frep_omp, x, size, &result);
+        VERIFY_INT(result, result_ref, "Mismatch: expected %d but got %d\n", result_ref, result);
+        result = -1;
+    }
+
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
 
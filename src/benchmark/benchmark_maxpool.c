@@ -2,30 +2,19 @@
 #include "printf.h"
 
 #include "lmq.h"
-#include "add.h"
+#include "maxpool.h"
 #include "benchmark.h"
 
-__attribute__((noinline))
-int maxpool_baseline(double *a, size_t n, size_t filter_size, size_t stride, double* result);
-__attribute__((noinline))
-int maxpool_ssr(double *a, size_t n, size_t filter_size, size_t stride, double* result);
-__attribute__((noinline))
-int maxpool_ssr_frep(double *a, size_t n, size_t filter_size, size_t stride, double* result);
-
-__attribute__((noinline))
-int maxpool2d_baseline(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
-__attribute__((noinline))
-int maxpool2d_ssr(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
-__attribute__((noinline))
-int maxpool2d_ssr_frep(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
-
-size_t pool_output_size(size_t n, size_t filter_size, size_t stride);
 void print_pattern(double *a, size_t n, size_t filter_size, size_t stride, double* result);
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         size_t filter_size = 5;
         size_t stride = 2;
 
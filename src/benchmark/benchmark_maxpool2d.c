@@ -2,26 +2,19 @@
 #include "printf.h"
 
 #include "lmq.h"
-#include "add.h"
+#include "maxpool.h"
 #include "benchmark.h"
 
-__attribute__((noinline))
-int maxpool2d_baseline(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
-__attribute__((noinline))
-int maxpool2d_ssr(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
-__attribute__((noinline))
-int maxpool2d_ssr_frep(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
-
-size_t pool_output_size(size_t n, size_t filter_size, size_t stride);
+double *x, *result_ref, *result;
 
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
-    if (core_idx != 0) {
-        return 0;
-    }
-
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         size_t f0 = 5;
         size_t f1 = 4;
         size_t s0 = 3;
@@ -50,5 +43,104 @@ int main() {
         BENCH_VO(maxpool2d_ssr_frep, x, n0, n1, f0, f1, s0, s1, result);
         verify_vector(result, result_ref, outn0 * outn1);
         clear_vector(result, outn0 * outn1);
+
+        // ONNX MaxPool: 3x3 window, stride 2, dilation 2 along dim 0, pads 1 and ceil_mode, with indices
+        size_t p = 1;
+        size_t pooled0 = pool_output_size_onnx(n0, 3, 2, 2, p, p, 1);
+        size_t pooled1 = pool_output_size_onnx(n1, 3, 2, 1, p, p, 1);
+        int* indices_ref = allocate(pooled0 * pooled1, sizeof(int));
+        int* indices = allocate(pooled0 * pooled1, sizeof(int));
+        double* pooled_ref = allocate(pooled0 * pooled1, sizeof(double));
+        double* pooled = allocate(pooled0 * pooled1, sizeof(double));
+
+        for (size_t i = 0; i < n0 * n1; i++) {
+            x[i] = (double)((i * 7) % 13);
+        }
+
+        BENCH_VO(maxpool2d_onnx_baseline, x, n0, n1, 3, 3, 2, 2, 2, 1, p, p, p, p, 1, pooled_ref, indices_ref);
+
+        BENCH_VO(maxpool2d_onnx_ssr_frep, x, n0, n1, 3, 3, 2, 2, 2, 1, p, p, p, p, 1, pooled, NULL);
+        verify_vector(pooled, pooled_ref, pooled0 * pooled1);
+        clear_vector(pooled, pooled0 * pooled1);
+
+        BENCH_VO(maxpool2d_onnx_ssr, x, n0, n1, 3, 3, 2, 2, 2, 1, p, p, p, p, 1, pooled, indices);
+        verify_vector(pooled, pooled_ref, pooled0 * pooled1);
+        verify_vector_int(indices, indices_ref, pooled0 * pooled1);
+        clear_vector(pooled, pooled0 * pooled1);
+    }
+
+    snrt_cluster_hw_barrier();
+
+    /* Output rows split over the cores */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t f0 = 5;
+        size_t f1 = 4;
+        size_t s0 = 3;
+        size_t s1 = 2;
+
+        size_t outn0 = sqrt_approx(size);
+        size_t outn1 = sqrt_approx(size);
+
+        size_t n0 = (outn0 - 1) * s0 + f0;
+        size_t n1 = (outn1 - 1) * s1 + f1;
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(n0 * n1, sizeof(double));
+            result_ref = allocate(outn0 * outn1, sizeof(double));
+            result = allocate(outn0 * outn1, sizeof(double));
+
+            for (size_t i = 0; i < n0 * n1; i++) {
+                x[i] = (double)i;
+            }
+            maxpool2d_baseline(x, n0, n1, f0, f1, s0, s1, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(maxpool2d_parallel, x, n0, n1, f0, f1, s0, s1, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, outn0 * outn1);
+            clear_vector(result, outn0 * outn1);
+        }
+
+        BENCH_VO_PARALLEL(maxpool2d_ssr_frep_parallel, x, n0, n1, f0, f1, s0, s1, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, outn0 * outn1);
+            clear_vector(result, outn0 * outn1);
+        }
+    }
+
+    // Benchmark OMP
+    __snrt_omp_bootstrap(core_idx);
+
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t f0 = 5;
+        size_t f1 = 4;
+        size_t s0 = 3;
+        size_t s1 = 2;
+
+        size_t outn0 = sqrt_approx(size);
+        size_t outn1 = sqrt_approx(size);
+
+        size_t n0 = (outn0 - 1) * s0 + f0;
+        size_t n1 = (outn1 - 1) * s1 + f1;
+
+        arena_reset(arena_global(), arena_start);
+        x = allocate(n0 * n1, sizeof(double));
+        result_ref = allocate(outn0 * outn1, sizeof(double));
+        result = allocate(outn0 * outn1, sizeof(double));
+
+        for (size_t i = 0; i < n0 * n1; i++) {
+            x[i] = (double)i;
+        }
+        maxpool2d_baseline(x, n0, n1, f0, f1, s0, s1, result_ref);
+
+        BENCH_VO_OMP(maxpool2d_ssr_frep_omp, x, n0, n1, f0, f1, s0, s1, result);
+        verify_vector(result, result_ref, outn0 * outn1);
+        clear_vector(result, outn0 * outn1);
     }
+
+    __snrt_omp_destroy(core_idx);
+
+    return 0;
 }
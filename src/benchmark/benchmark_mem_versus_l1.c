@@ -2,24 +2,111 @@
 #include "printf.h"
 
 #include "lmq.h"
+#include "add.h"
+#include "gemm.h"
+#include "conv.h"
 #include "benchmark.h"
 
+
+// Every benchmarked kernel has two input streams and one output stream
+#define NUM_STREAMS 3
+
+// Inputs and reference in memory, the buffers of the kernel in L1
+double *x, *y, *result_ref;
+double *l1_buffers[NUM_STREAMS];
+
+/*
+ * Allocates the L1 buffers for the given sizes (in doubles).
+ * If spread is 0, all buffers start at bank 0, which is the worst case for streams
+ * running in lockstep. Otherwise the buffers are placed by arena_alloc_streams.
+ * Returns 0 on success.
+ */
+static int place_buffers(const size_t* sizes, int spread) {
+    if (spread) {
+        return arena_alloc_streams(arena_l1(), NUM_STREAMS, sizes, l1_buffers);
+    }
+
+    for (size_t i = 0; i < NUM_STREAMS; i++) {
+        l1_buffers[i] = arena_alloc(arena_l1(), sizes[i], sizeof(double), LMQ_ALIGN_TCDM_BANK);
+        if (l1_buffers[i] == NULL) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Same kernels under different names, so that both placements show up separately in the output.
+ */
+static int add_ssr_parallel_bank0(double* a, double* b, const size_t n, double* result) {
+    return add_ssr_parallel(a, b, n, result);
+}
+static int add_ssr_parallel_spread(double* a, double* b, const size_t n, double* result) {
+    return add_ssr_parallel(a, b, n, result);
+}
+static int gemm_ssr_parallel_bank0(double* a, double* b, const size_t m, const size_t n, const size_t k, double* result) {
+    return gemm_ssr_parallel(a, b, m, n, k, result);
+}
+static int gemm_ssr_parallel_spread(double* a, double* b, const size_t m, const size_t n, const size_t k, double* result) {
+    return gemm_ssr_parallel(a, b, m, n, k, result);
+}
+static int conv_ssr_parallel_bank0(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result) {
+    return conv_ssr_parallel(a, filter, n, filter_size, stride, dilation, result);
+}
+static int conv_ssr_parallel_spread(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result) {
+    return conv_ssr_parallel(a, filter, n, filter_size, stride, dilation, result);
+}
+
+// Set by core 0 if the buffers do not fit into L1
+int placement_failed;
+
+/*
+ * Places the L1 buffers (see place_buffers) starting from the L1 mark l1_start and
+ * copies the inputs x and y into the first two of them.
+ * Must be called by all cores. Returns 0 on success.
+ */
+static int prepare_buffers(const size_t* sizes, int spread, size_t l1_start) {
+    if (snrt_cluster_core_idx() == 0) {
+        arena_reset(arena_l1(), l1_start);
+        placement_failed = place_buffers(sizes, spread);
+
+        for (size_t i = 0; !placement_failed && i < sizes[0]; i++) {
+            l1_buffers[0][i] = x[i];
+        }
+        for (size_t i = 0; !placement_failed && i < sizes[1]; i++) {
+            l1_buffers[1][i] = y[i];
+        }
+        if (placement_failed) {
+            printf("Buffers of %d, %d and %d doubles do not fit into L1\n", sizes[0], sizes[1], sizes[2]);
+        }
+    }
+    snrt_cluster_hw_barrier();
+
+    return placement_failed;
+}
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
     // only run on 1 core
+    size_t arena_start = arena_mark(arena_global());
+    size_t l1_start = arena_mark(arena_l1());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+        arena_reset(arena_l1(), l1_start);
+
         // memory
         double* memory_x = allocate(size, sizeof(double));
         double* memory_target = allocate(size, sizeof(double));
-        double* l1_x = snrt_l1alloc(size * sizeof(double));
-        double* l1_target = snrt_l1alloc(size * sizeof(double));
-        
+        double* l1_x = arena_alloc(arena_l1(), size, sizeof(double), LMQ_ALIGN_DOUBLE);
+        double* l1_target = arena_alloc(arena_l1(), size, sizeof(double), LMQ_ALIGN_DOUBLE);
+
         for (size_t i = 0; i < size; i++) {
             memory_x[i] = (double)i - 20.0;
             l1_x[i] = (double)i - 20.0;
         }
-        
+
         // copy mem -> mem
         size_t _start_ = read_csr(mcycle);
         for (size_t i = 0; i < size; i++) {
@@ -34,12 +121,120 @@ int main() {
             l1_target[i] = l1_x[i];
         }
         size_t end_l1  = read_csr(mcycle);
-        
+
         printf("copy_l1_to_l1, size: %d: %lu cycles\n", size, end_l1 - start_l1);
 
         verify_vector(memory_target, memory_x, size);
         verify_vector(memory_target, l1_target, size);
     }
- 
+
+    snrt_cluster_hw_barrier();
+
+    /* Benchmark the bank placement of the L1 buffers (on all cores) */
+    size_t filter_size = 5;
+    size_t stride = 2;
+    size_t dilation = 2;
+
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        // add
+        size_t add_sizes[NUM_STREAMS] = { size, size, size };
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(size, sizeof(double));
+            y = allocate(size, sizeof(double));
+            result_ref = allocate(size, sizeof(double));
+            for (size_t i = 0; i < size; i++) {
+                x[i] = (double)i;
+                y[i] = 2.0 * i;
+            }
+            add_baseline(x, y, size, result_ref);
+        }
+
+        for (int spread = 0; spread <= 1; spread++) {
+            if (prepare_buffers(add_sizes, spread, l1_start)) {
+                continue;
+            }
+
+            if (spread) {
+                BENCH_VO_PARALLEL(add_ssr_parallel_spread, l1_buffers[0], l1_buffers[1], size, l1_buffers[2]);
+            } else {
+                BENCH_VO_PARALLEL(add_ssr_parallel_bank0, l1_buffers[0], l1_buffers[1], size, l1_buffers[2]);
+            }
+            if (core_idx == 0) {
+                verify_vector(l1_buffers[2], result_ref, size);
+            }
+        }
+
+        // gemm
+        uint32_t sqrt = sqrt_approx(size);
+        size_t M = sqrt / 2;
+        size_t N = sqrt * 2;
+        size_t K = sqrt / 2;
+        size_t gemm_sizes[NUM_STREAMS] = { M * N, N * K, M * K };
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(M * N, sizeof(double));
+            y = allocate(N * K, sizeof(double));
+            result_ref = allocate(M * K, sizeof(double));
+            for (size_t i = 0; i < M * N; i++) {
+                x[i] = (double)i;
+            }
+            for (size_t i = 0; i < N * K; i++) {
+                y[i] = (double)i;
+            }
+            gemm_baseline(x, y, M, N, K, result_ref);
+        }
+
+        for (int spread = 0; spread <= 1; spread++) {
+            if (prepare_buffers(gemm_sizes, spread, l1_start)) {
+                continue;
+            }
+
+            if (spread) {
+                BENCH_VO_PARALLEL(gemm_ssr_parallel_spread, l1_buffers[0], l1_buffers[1], M, N, K, l1_buffers[2]);
+            } else {
+                BENCH_VO_PARALLEL(gemm_ssr_parallel_bank0, l1_buffers[0], l1_buffers[1], M, N, K, l1_buffers[2]);
+            }
+            if (core_idx == 0) {
+                verify_vector(l1_buffers[2], result_ref, M * K);
+            }
+        }
+
+        // conv
+        size_t input_size = (size - 1) * stride + (1 + (filter_size - 1) * dilation);
+        size_t conv_sizes[NUM_STREAMS] = { input_size, filter_size, size };
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(input_size, sizeof(double));
+            y = allocate(filter_size, sizeof(double));
+            result_ref = allocate(size, sizeof(double));
+            for (size_t i = 0; i < input_size; i++) {
+                x[i] = (double)i;
+            }
+            for (size_t i = 0; i < filter_size; ++i) {
+                y[i] = 3.f - i;
+            }
+            conv_baseline(x, y, input_size, filter_size, stride, dilation, result_ref);
+        }
+
+        for (int spread = 0; spread <= 1; spread++) {
+            if (prepare_buffers(conv_sizes, spread, l1_start)) {
+                continue;
+            }
+
+            if (spread) {
+                BENCH_VO_PARALLEL(conv_ssr_parallel_spread, l1_buffers[0], l1_buffers[1], input_size, filter_size, stride, dilation, l1_buffers[2]);
+            } else {
+                BENCH_VO_PARALLEL(conv_ssr_parallel_bank0, l1_buffers[0], l1_buffers[1], input_size, filter_size, stride, dilation, l1_buffers[2]);
+            }
+            if (core_idx == 0) {
+                verify_vector(l1_buffers[2], result_ref, size);
+            }
+        }
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,518 @@
+#include <snrt.h>
+#include "printf.h"
+#include <math.h>
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "graph.h"
+#include "gemm.h"
+#include "add.h"
+#include "relu.h"
+#include "softmax.h"
+#include "conv.h"
+#include "maxpool.h"
+#include "batchnorm.h"
+#include "layernorm.h"
+#include "argmax.h"
+#include "attention.h"
+
+#define NUM_ENTRIES(table) (sizeof(table) / sizeof(table[0]))
+
+/*
+ * End to end models: an MLP, a LeNet style CNN and a transformer block, each run three ways:
+ *   naive: one call of the parallel kernel per operator, with a cluster barrier after every call and
+ *          every intermediate in its own buffer, like a frontend lowering the ONNX nodes one by one
+ *   fused: the fused kernels, the biases folded into the C of gemm_onnx, the batchnorm folded into the
+ *          weights of conv_nchw_*_fused with the leaky relu as its activation and the attention fused
+ *   graph: the static graph executor of src/lmq/graph.h with its planned intermediates
+ * The total cycles of every version and the cycles of every layer (up to the barrier after it) are printed.
+ * The outputs are checked against graph_run_baseline. The printed size is the number of input elements.
+ */
+#define LEAKY_ALPHA 0.1
+#define EPSILON 1e-5
+#define MODEL_MAX_LAYERS 32
+
+size_t layer_cycles[MODEL_MAX_LAYERS];
+const char* layer_names[MODEL_MAX_LAYERS];
+size_t num_layers;
+
+/*
+ * One layer of the naive and the fused versions, called by all cores. Core 0 records the cycles of the
+ * kernel and the barrier after it.
+ */
+#define MODEL_LAYER(func_name, ...)                                      \
+    do {                                                                 \
+        size_t _start_ = read_csr(mcycle);                               \
+        ret |= func_name(__VA_ARGS__);                                   \
+        snrt_cluster_hw_barrier();                                       \
+        if (snrt_cluster_core_idx() == 0 && num_layers < MODEL_MAX_LAYERS) { \
+            layer_cycles[num_layers] = read_csr(mcycle) - _start_;       \
+            layer_names[num_layers] = #func_name;                        \
+            num_layers++;                                                \
+        }                                                                \
+    } while (0)
+
+/*
+ * The tensors of a graph for the naive and the fused versions: the inputs and weights of the graph and
+ * buffers of their own for the intermediates and the outputs. ref has the baseline outputs.
+ */
+typedef struct {
+    graph_t* graph;
+    double* buf[GRAPH_MAX_TENSORS];
+    double* ref[GRAPH_MAX_TENSORS];
+    int classes_output; // the tensor of the argmax, which the naive and fused versions write to classes, or -1
+} model_t;
+
+// MLP 64-32-16-10 with batch 4: (gemm -> bias -> leakyrelu) x 2 -> gemm -> bias -> argmax of every row
+#define MLP_BATCH 4
+graph_tensor_t mlp_tensors[] = {
+    {GRAPH_INPUT, MLP_BATCH * 64, NULL},        // 0 x
+    {GRAPH_CONST, 64 * 32, NULL},               // 1 w1
+    {GRAPH_CONST, 32, NULL},                    // 2 b1
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 32, NULL}, // 3
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 32, NULL}, // 4
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 32, NULL}, // 5
+    {GRAPH_CONST, 32 * 16, NULL},               // 6 w2
+    {GRAPH_CONST, 16, NULL},                    // 7 b2
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 16, NULL}, // 8
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 16, NULL}, // 9
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 16, NULL}, // 10
+    {GRAPH_CONST, 16 * 10, NULL},               // 11 w3
+    {GRAPH_CONST, 10, NULL},                    // 12 b3
+    {GRAPH_INTERMEDIATE, MLP_BATCH * 10, NULL}, // 13
+    {GRAPH_OUTPUT, MLP_BATCH * 10, NULL},       // 14 logits
+    {GRAPH_OUTPUT, MLP_BATCH, NULL},            // 15 classes
+};
+
+const graph_node_t mlp_nodes[] = {
+    {GRAPH_GEMM, GRAPH_SPLIT, {0, 1, -1}, 3, {MLP_BATCH, 64, 32}},
+    {GRAPH_BIAS, GRAPH_SPLIT, {3, 2, -1}, 4, {MLP_BATCH, 32}},
+    {GRAPH_LEAKYRELU, GRAPH_SPLIT, {4, -1, -1}, 5, {MLP_BATCH * 32}, LEAKY_ALPHA},
+    {GRAPH_GEMM, GRAPH_SPLIT, {5, 6, -1}, 8, {MLP_BATCH, 32, 16}},
+    {GRAPH_BIAS, GRAPH_SPLIT, {8, 7, -1}, 9, {MLP_BATCH, 16}},
+    {GRAPH_LEAKYRELU, GRAPH_SPLIT, {9, -1, -1}, 10, {MLP_BATCH * 16}, LEAKY_ALPHA},
+    {GRAPH_GEMM, GRAPH_SPLIT, {10, 11, -1}, 13, {MLP_BATCH, 16, 10}},
+    {GRAPH_BIAS, GRAPH_SPLIT, {13, 12, -1}, 14, {MLP_BATCH, 10}},
+    {GRAPH_ARGMAX, GRAPH_SPLIT, {14, -1, -1}, 15, {MLP_BATCH, 10}},
+};
+
+// CNN on a 16x16 image: conv 1->8 5x5 -> batchnorm -> leakyrelu -> maxpool 2x2 -> conv 8->16 3x3 -> leakyrelu
+// -> maxpool 2x2 -> gemm -> bias -> argmax. The channels of a maxpool are one image of stacked rows.
+graph_tensor_t cnn_tensors[] = {
+    {GRAPH_INPUT, 16 * 16, NULL},            // 0 image
+    {GRAPH_CONST, 8 * 5 * 5, NULL},          // 1 w1
+    {GRAPH_CONST, 8, NULL},                  // 2 b1
+    {GRAPH_INTERMEDIATE, 8 * 12 * 12, NULL}, // 3
+    {GRAPH_CONST, 4 * 8, NULL},              // 4 scale, bias, mean and var
+    {GRAPH_INTERMEDIATE, 8 * 12 * 12, NULL}, // 5
+    {GRAPH_INTERMEDIATE, 8 * 12 * 12, NULL}, // 6
+    {GRAPH_INTERMEDIATE, 8 * 6 * 6, NULL},   // 7
+    {GRAPH_CONST, 16 * 8 * 3 * 3, NULL},     // 8 w2
+    {GRAPH_CONST, 16, NULL},                 // 9 b2
+    {GRAPH_INTERMEDIATE, 16 * 4 * 4, NULL},  // 10
+    {GRAPH_INTERMEDIATE, 16 * 4 * 4, NULL},  // 11
+    {GRAPH_INTERMEDIATE, 16 * 2 * 2, NULL},  // 12
+    {GRAPH_CONST, 64 * 10, NULL},            // 13 w3
+    {GRAPH_CONST, 10, NULL},                 // 14 b3
+    {GRAPH_INTERMEDIATE, 10, NULL},          // 15
+    {GRAPH_OUTPUT, 10, NULL},                // 16 logits
+    {GRAPH_OUTPUT, 1, NULL},                 // 17 class
+};
+
+// the dense layer has a single row, it runs on core 0
+const graph_node_t cnn_nodes[] = {
+    {GRAPH_CONV, GRAPH_SPLIT, {0, 1, 2}, 3, {1, 16, 16, 8, 5, 5, 1, 1}},
+    {GRAPH_BATCHNORM, GRAPH_SPLIT, {3, 4, -1}, 5, {8, 12 * 12}, EPSILON},
+    {GRAPH_LEAKYRELU, GRAPH_SPLIT, {5, -1, -1}, 6, {8 * 12 * 12}, LEAKY_ALPHA},
+    {GRAPH_MAXPOOL2D, GRAPH_SPLIT, {6, -1, -1}, 7, {12, 8 * 12, 2, 2, 2, 2}},
+    {GRAPH_CONV, GRAPH_SPLIT, {7, 8, 9}, 10, {8, 6, 6, 16, 3, 3, 1, 1}},
+    {GRAPH_LEAKYRELU, GRAPH_SPLIT, {10, -1, -1}, 11, {16 * 4 * 4}, LEAKY_ALPHA},
+    {GRAPH_MAXPOOL2D, GRAPH_SPLIT, {11, -1, -1}, 12, {4, 16 * 4, 2, 2, 2, 2}},
+    {GRAPH_GEMM, GRAPH_SERIAL, {12, 13, -1}, 15, {1, 64, 10}},
+    {GRAPH_BIAS, GRAPH_SERIAL, {15, 14, -1}, 16, {1, 10}},
+    {GRAPH_ARGMAX, GRAPH_SERIAL, {16, -1, -1}, 17, {1, 10}},
+};
+
+// Transformer block of one head over SEQ tokens of DIM: x + attention(x Wq, x Wk, x Wv) Wo -> layernorm = h,
+// h + leakyrelu(h W1 + b1) W2 -> layernorm. The projections but W1 have no bias.
+#define SEQ 16
+#define DIM 16
+#define FFN 32
+graph_tensor_t transformer_tensors[] = {
+    {GRAPH_INPUT, SEQ * DIM, NULL},        // 0 x
+    {GRAPH_CONST, DIM * DIM, NULL},        // 1 wq
+    {GRAPH_CONST, DIM * DIM, NULL},        // 2 wk
+    {GRAPH_CONST, DIM * DIM, NULL},        // 3 wv
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 4 q
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 5 k
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 6 v
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 7
+    {GRAPH_CONST, DIM * DIM, NULL},        // 8 wo
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 9
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 10
+    {GRAPH_CONST, 2 * DIM, NULL},          // 11 scale and bias
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 12 h
+    {GRAPH_CONST, DIM * FFN, NULL},        // 13 w1
+    {GRAPH_CONST, FFN, NULL},              // 14 b1
+    {GRAPH_INTERMEDIATE, SEQ * FFN, NULL}, // 15
+    {GRAPH_INTERMEDIATE, SEQ * FFN, NULL}, // 16
+    {GRAPH_INTERMEDIATE, SEQ * FFN, NULL}, // 17
+    {GRAPH_CONST, FFN * DIM, NULL},        // 18 w2
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 19
+    {GRAPH_INTERMEDIATE, SEQ * DIM, NULL}, // 20
+    {GRAPH_CONST, 2 * DIM, NULL},          // 21 scale and bias
+    {GRAPH_OUTPUT, SEQ * DIM, NULL},       // 22 y
+};
+
+const graph_node_t transformer_nodes[] = {
+    {GRAPH_GEMM, GRAPH_SPLIT, {0, 1, -1}, 4, {SEQ, DIM, DIM}},
+    {GRAPH_GEMM, GRAPH_SPLIT, {0, 2, -1}, 5, {SEQ, DIM, DIM}},
+    {GRAPH_GEMM, GRAPH_SPLIT, {0, 3, -1}, 6, {SEQ, DIM, DIM}},
+    {GRAPH_ATTENTION, GRAPH_CLUSTER, {4, 5, 6}, 7, {1, SEQ, SEQ, DIM, DIM}, 0.25}, // 1 / sqrt(DIM)
+    {GRAPH_GEMM, GRAPH_SPLIT, {7, 8, -1}, 9, {SEQ, DIM, DIM}},
+    {GRAPH_ADD, GRAPH_SPLIT, {9, 0, -1}, 10, {SEQ * DIM}},
+    {GRAPH_LAYERNORM, GRAPH_SPLIT, {10, 11, -1}, 12, {SEQ, DIM}, EPSILON},
+    {GRAPH_GEMM, GRAPH_SPLIT, {12, 13, -1}, 15, {SEQ, DIM, FFN}},
+    {GRAPH_BIAS, GRAPH_SPLIT, {15, 14, -1}, 16, {SEQ, FFN}},
+    {GRAPH_LEAKYRELU, GRAPH_SPLIT, {16, -1, -1}, 17, {SEQ * FFN}, LEAKY_ALPHA},
+    {GRAPH_GEMM, GRAPH_SPLIT, {17, 18, -1}, 19, {SEQ, FFN, DIM}},
+    {GRAPH_ADD, GRAPH_SPLIT, {19, 12, -1}, 20, {SEQ * DIM}},
+    {GRAPH_LAYERNORM, GRAPH_SPLIT, {20, 21, -1}, 22, {SEQ, DIM}, EPSILON},
+};
+
+graph_t mlp_graph = {mlp_tensors, NUM_ENTRIES(mlp_tensors), mlp_nodes, NUM_ENTRIES(mlp_nodes)};
+graph_t cnn_graph = {cnn_tensors, NUM_ENTRIES(cnn_tensors), cnn_nodes, NUM_ENTRIES(cnn_nodes)};
+graph_t transformer_graph = {transformer_tensors, NUM_ENTRIES(transformer_tensors), transformer_nodes,
+                             NUM_ENTRIES(transformer_nodes)};
+
+model_t mlp = {&mlp_graph, {NULL}, {NULL}, -1};
+model_t cnn = {&cnn_graph, {NULL}, {NULL}, -1};
+model_t transformer = {&transformer_graph, {NULL}, {NULL}, -1};
+
+// The biases broadcast to all rows (for add and the C of gemm_onnx), the folded conv weights, the scores of
+// the unfused attention and the argmax indices
+double *mlp_b1, *mlp_b2, *mlp_b3, *cnn_w1, *cnn_b1, *transformer_b1, *scores, *probs;
+int classes[MLP_BATCH];
+
+static double* broadcast_rows(const double* bias, size_t rows, size_t cols) {
+    double* full = allocate(rows * cols, sizeof(double));
+    for (size_t i = 0; i < rows * cols; i++) {
+        full[i] = bias[i % cols];
+    }
+    return full;
+}
+
+static int mlp_naive(model_t* m) {
+    double** t = m->buf;
+    size_t shape[2] = {MLP_BATCH, 10};
+    int ret = 0;
+
+    num_layers = 0;
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[0], t[1], MLP_BATCH, 64, 32, t[3]);
+    MODEL_LAYER(add_ssr_frep_parallel, t[3], mlp_b1, MLP_BATCH * 32, t[4]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[4], MLP_BATCH * 32, LEAKY_ALPHA, t[5]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[5], t[6], MLP_BATCH, 32, 16, t[8]);
+    MODEL_LAYER(add_ssr_frep_parallel, t[8], mlp_b2, MLP_BATCH * 16, t[9]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[9], MLP_BATCH * 16, LEAKY_ALPHA, t[10]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[10], t[11], MLP_BATCH, 16, 10, t[13]);
+    MODEL_LAYER(add_ssr_frep_parallel, t[13], mlp_b3, MLP_BATCH * 10, t[14]);
+    MODEL_LAYER(argmax_axis_ssr_frep_parallel, t[14], shape, 2, 1, 0, classes);
+    return ret;
+}
+
+static int mlp_fused(model_t* m) {
+    double** t = m->buf;
+    size_t shape[2] = {MLP_BATCH, 10};
+    int ret = 0;
+
+    num_layers = 0;
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[0], t[1], mlp_b1, MLP_BATCH, 64, 32, 0, 0, 1.0, 1.0, t[4]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[4], MLP_BATCH * 32, LEAKY_ALPHA, t[5]);
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[5], t[6], mlp_b2, MLP_BATCH, 32, 16, 0, 0, 1.0, 1.0, t[9]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[9], MLP_BATCH * 16, LEAKY_ALPHA, t[10]);
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[10], t[11], mlp_b3, MLP_BATCH, 16, 10, 0, 0, 1.0, 1.0, t[14]);
+    MODEL_LAYER(argmax_axis_ssr_frep_parallel, t[14], shape, 2, 1, 0, classes);
+    return ret;
+}
+
+static int cnn_naive(model_t* m) {
+    double** t = m->buf;
+    double* bn = t[4];
+    size_t shape[2] = {1, 10};
+    int ret = 0;
+
+    num_layers = 0;
+    MODEL_LAYER(conv_nchw_ssr_frep_parallel, t[0], t[1], t[2], 1, 1, 16, 16, 8, 1, 5, 5, 1, 1, 1, 1, t[3]);
+    MODEL_LAYER(batchnorm_nchw_inference_ssr_frep_parallel, t[3], 1, 8, 12 * 12, bn, bn + 8, bn + 16, bn + 24,
+                EPSILON, t[5]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[5], 8 * 12 * 12, LEAKY_ALPHA, t[6]);
+    MODEL_LAYER(maxpool2d_ssr_frep_parallel, t[6], 12, 8 * 12, 2, 2, 2, 2, t[7]);
+    MODEL_LAYER(conv_nchw_ssr_frep_parallel, t[7], t[8], t[9], 1, 8, 6, 6, 16, 1, 3, 3, 1, 1, 1, 1, t[10]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[10], 16 * 4 * 4, LEAKY_ALPHA, t[11]);
+    MODEL_LAYER(maxpool2d_ssr_frep_parallel, t[11], 4, 16 * 4, 2, 2, 2, 2, t[12]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[12], t[13], 1, 64, 10, t[15]);
+    MODEL_LAYER(add_ssr_frep_parallel, t[15], t[14], 10, t[16]);
+    MODEL_LAYER(argmax_axis_ssr_frep_parallel, t[16], shape, 2, 1, 0, classes);
+    return ret;
+}
+
+static int cnn_fused(model_t* m) {
+    double** t = m->buf;
+    size_t shape[2] = {1, 10};
+    conv_activation_t leaky = {CONV_ACT_LEAKYRELU, LEAKY_ALPHA, 0.0, 0.0};
+    int ret = 0;
+
+    num_layers = 0;
+    MODEL_LAYER(conv_nchw_ssr_frep_parallel_fused, t[0], cnn_w1, cnn_b1, 1, 1, 16, 16, 8, 1, 5, 5, 1, 1, 1, 1,
+                &leaky, t[6]);
+    MODEL_LAYER(maxpool2d_ssr_frep_parallel, t[6], 12, 8 * 12, 2, 2, 2, 2, t[7]);
+    MODEL_LAYER(conv_nchw_ssr_frep_parallel_fused, t[7], t[8], t[9], 1, 8, 6, 6, 16, 1, 3, 3, 1, 1, 1, 1,
+                &leaky, t[11]);
+    MODEL_LAYER(maxpool2d_ssr_frep_parallel, t[11], 4, 16 * 4, 2, 2, 2, 2, t[12]);
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[12], t[13], t[14], 1, 64, 10, 0, 0, 1.0, 1.0, t[16]);
+    MODEL_LAYER(argmax_axis_ssr_frep_parallel, t[16], shape, 2, 1, 0, classes);
+    return ret;
+}
+
+static int transformer_naive(model_t* m) {
+    double** t = m->buf;
+    int ret = 0;
+
+    num_layers = 0;
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[0], t[1], SEQ, DIM, DIM, t[4]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[0], t[2], SEQ, DIM, DIM, t[5]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[0], t[3], SEQ, DIM, DIM, t[6]);
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[4], t[5], NULL, SEQ, DIM, SEQ, 0, 1, 0.25, 0.0, scores);
+    MODEL_LAYER(softmax_ssr_frep_parallel, scores, SEQ, SEQ, probs);
+    MODEL_LAYER(gemm_ssr_frep_parallel, probs, t[6], SEQ, SEQ, DIM, t[7]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[7], t[8], SEQ, DIM, DIM, t[9]);
+    MODEL_LAYER(add_ssr_frep_parallel, t[9], t[0], SEQ * DIM, t[10]);
+    MODEL_LAYER(layernorm_ssr_frep_parallel, t[10], SEQ, DIM, t[11], t[11] + DIM, EPSILON, t[12]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[12], t[13], SEQ, DIM, FFN, t[15]);
+    MODEL_LAYER(add_ssr_frep_parallel, t[15], transformer_b1, SEQ * FFN, t[16]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[16], SEQ * FFN, LEAKY_ALPHA, t[17]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[17], t[18], SEQ, FFN, DIM, t[19]);
+    MODEL_LAYER(add_ssr_frep_parallel, t[19], t[12], SEQ * DIM, t[20]);
+    MODEL_LAYER(layernorm_ssr_frep_parallel, t[20], SEQ, DIM, t[21], t[21] + DIM, EPSILON, t[22]);
+    return ret;
+}
+
+// the residuals are the C of the projections
+static int transformer_fused(model_t* m) {
+    double** t = m->buf;
+    int ret = 0;
+
+    num_layers = 0;
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[0], t[1], SEQ, DIM, DIM, t[4]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[0], t[2], SEQ, DIM, DIM, t[5]);
+    MODEL_LAYER(gemm_ssr_frep_parallel, t[0], t[3], SEQ, DIM, DIM, t[6]);
+    MODEL_LAYER(attention_ssr_frep_parallel, t[4], t[5], t[6], 1, SEQ, SEQ, DIM, DIM, 0.25, t[7]);
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[7], t[8], t[0], SEQ, DIM, DIM, 0, 0, 1.0, 1.0, t[10]);
+    MODEL_LAYER(layernorm_ssr_frep_parallel, t[10], SEQ, DIM, t[11], t[11] + DIM, EPSILON, t[12]);
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[12], t[13], transformer_b1, SEQ, DIM, FFN, 0, 0, 1.0, 1.0, t[16]);
+    MODEL_LAYER(leakyrelu_ssr_frep_parallel, t[16], SEQ * FFN, LEAKY_ALPHA, t[17]);
+    MODEL_LAYER(gemm_onnx_ssr_frep_parallel, t[17], t[18], t[12], SEQ, FFN, DIM, 0, 0, 1.0, 1.0, t[20]);
+    MODEL_LAYER(layernorm_ssr_frep_parallel, t[20], SEQ, DIM, t[21], t[21] + DIM, EPSILON, t[22]);
+    return ret;
+}
+
+static int mlp_graph_run(model_t* m) {
+    return graph_run(m->graph);
+}
+
+static int cnn_graph_run(model_t* m) {
+    return graph_run(m->graph);
+}
+
+static int transformer_graph_run(model_t* m) {
+    return graph_run(m->graph);
+}
+
+/*
+ * Allocates and fills the inputs and weights of the graph of m, plans its intermediates, runs the baseline
+ * into ref and allocates the buffers of the naive and fused versions.
+ */
+static void model_setup(const char* name, model_t* m) {
+    graph_t* g = m->graph;
+    for (size_t t = 0; t < g->num_tensors; t++) {
+        graph_tensor_t* tensor = &g->tensors[t];
+        if (tensor->kind == GRAPH_INTERMEDIATE) {
+            continue;
+        }
+        tensor->data = allocate(tensor->size, sizeof(double));
+        for (size_t i = 0; i < tensor->size; i++) {
+            tensor->data[i] = tensor->kind == GRAPH_INPUT ? 0.1 * (double)((int)(i % 9) - 4)
+                                                          : 0.05 * (double)((int)((i + t) % 7) - 3);
+        }
+    }
+    // the variances of the batchnorm and the scales of the layernorms
+    for (size_t i = 0; i < g->num_nodes; i++) {
+        const graph_node_t* node = &g->nodes[i];
+        if (node->op == GRAPH_BATCHNORM) {
+            double* var = g->tensors[node->inputs[1]].data + 3 * node->attrs[0];
+            for (size_t c = 0; c < node->attrs[0]; c++) {
+                var[c] = 0.5 + 0.25 * (double)(c % 3);
+            }
+        } else if (node->op == GRAPH_LAYERNORM) {
+            double* scale = g->tensors[node->inputs[1]].data;
+            for (size_t c = 0; c < node->attrs[1]; c++) {
+                scale[c] = 1.0 + 0.05 * (double)(c % 5);
+            }
+        } else if (node->op == GRAPH_ARGMAX) {
+            m->classes_output = node->output;
+        }
+    }
+
+    int ret = graph_plan(g);
+    printf("model %s: %d nodes, plan %d: L1 pool %d bytes, global pool %d bytes (allocate per intermediate: %d bytes)\n",
+           name, g->num_nodes, ret, g->l1_bytes, g->global_bytes, g->unplanned_bytes);
+
+    graph_run_baseline(g);
+    for (size_t t = 0; t < g->num_tensors; t++) {
+        graph_tensor_t* tensor = &g->tensors[t];
+        if (tensor->kind == GRAPH_INTERMEDIATE || tensor->kind == GRAPH_OUTPUT) {
+            m->buf[t] = allocate(tensor->size, sizeof(double));
+        } else {
+            m->buf[t] = tensor->data;
+        }
+        if (tensor->kind == GRAPH_OUTPUT) {
+            m->ref[t] = allocate(tensor->size, sizeof(double));
+            for (size_t i = 0; i < tensor->size; i++) {
+                m->ref[t][i] = tensor->data[i];
+            }
+            clear_vector(tensor->data, tensor->size);
+        }
+    }
+}
+
+/*
+ * Prints the cycles of the num layers of the last run of name (f.ex. "mlp_naive") and their sum.
+ */
+static void model_report(const char* name, const char** names, const size_t* cycles, size_t num) {
+    size_t total = 0;
+    for (size_t i = 0; i < num; i++) {
+        printf("%s layer %d %s: %lu cycles\n", name, i, names[i], cycles[i]);
+        BENCH_RECORD(name, size, snrt_cluster_core_num() - 1, " layer=%d kernel=%s cycles=%lu", i, names[i], cycles[i]);
+        total += cycles[i];
+    }
+    printf("%s: %d layers, %lu cycles in the layers\n", name, num, total);
+}
+
+static void model_report_graph(const char* name, const graph_t* g) {
+    const char* names[MODEL_MAX_LAYERS];
+    size_t num = g->num_nodes < MODEL_MAX_LAYERS ? g->num_nodes : MODEL_MAX_LAYERS;
+    for (size_t i = 0; i < num; i++) {
+        names[i] = graph_op_name(g->nodes[i].op);
+    }
+    model_report(name, names, g->cycles, num);
+}
+
+/*
+ * Checks the outputs in buf (the naive and fused versions) or in the graph tensors against the baseline.
+ */
+static void model_verify(const model_t* m, int from_graph) {
+    const graph_t* g = m->graph;
+    for (size_t t = 0; t < g->num_tensors; t++) {
+        const graph_tensor_t* tensor = &g->tensors[t];
+        if (tensor->kind != GRAPH_OUTPUT) {
+            continue;
+        }
+        double* value = from_graph ? tensor->data : m->buf[t];
+        if (!from_graph && (int)t == m->classes_output) {
+            for (size_t i = 0; i < tensor->size; i++) {
+                value[i] = (double)classes[i];
+            }
+        }
+        verify_vector_approx(value, m->ref[t], tensor->size);
+        clear_vector(value, tensor->size);
+    }
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    if (core_idx == 0) {
+        model_setup("mlp", &mlp);
+        model_setup("cnn", &cnn);
+        model_setup("transformer", &transformer);
+
+        mlp_b1 = broadcast_rows(mlp.buf[2], MLP_BATCH, 32);
+        mlp_b2 = broadcast_rows(mlp.buf[7], MLP_BATCH, 16);
+        mlp_b3 = broadcast_rows(mlp.buf[12], MLP_BATCH, 10);
+        transformer_b1 = broadcast_rows(transformer.buf[14], SEQ, FFN);
+        scores = allocate(SEQ * SEQ, sizeof(double));
+        probs = allocate(SEQ * SEQ, sizeof(double));
+
+        // batchnorm folded into the first conv: k = scale / sqrt(var + epsilon), b' = (b - mean) k + bias
+        double* bn = cnn.buf[4];
+        cnn_w1 = allocate(8 * 5 * 5, sizeof(double));
+        cnn_b1 = allocate(8, sizeof(double));
+        for (size_t c = 0; c < 8; c++) {
+            double k = bn[c] / sqrt(bn[24 + c] + EPSILON);
+            for (size_t i = 0; i < 5 * 5; i++) {
+                cnn_w1[c * 5 * 5 + i] = cnn.buf[1][c * 5 * 5 + i] * k;
+            }
+            cnn_b1[c] = (cnn.buf[2][c] - bn[16 + c]) * k + bn[8 + c];
+        }
+
+        mlp_graph.cycles = allocate(mlp_graph.num_nodes, sizeof(size_t));
+        cnn_graph.cycles = allocate(cnn_graph.num_nodes, sizeof(size_t));
+        transformer_graph.cycles = allocate(transformer_graph.num_nodes, sizeof(size_t));
+    }
+    snrt_cluster_hw_barrier();
+
+    size = mlp_tensors[0].size;
+    BENCH_VO_PARALLEL(mlp_naive, &mlp);
+    if (core_idx == 0) {
+        model_report("mlp_naive", layer_names, layer_cycles, num_layers);
+        model_verify(&mlp, 0);
+    }
+    BENCH_VO_PARALLEL(mlp_fused, &mlp);
+    if (core_idx == 0) {
+        model_report("mlp_fused", layer_names, layer_cycles, num_layers);
+        model_verify(&mlp, 0);
+    }
+    BENCH_VO_PARALLEL(mlp_graph_run, &mlp);
+    if (core_idx == 0) {
+        model_report_graph("mlp_graph", &mlp_graph);
+        model_verify(&mlp, 1);
+    }
+    snrt_cluster_hw_barrier();
+
+    size = cnn_tensors[0].size;
+    BENCH_VO_PARALLEL(cnn_naive, &cnn);
+    if (core_idx == 0) {
+        model_report("cnn_naive", layer_names, layer_cycles, num_layers);
+        model_verify(&cnn, 0);
+    }
+    BENCH_VO_PARALLEL(cnn_fused, &cnn);
+    if (core_idx == 0) {
+        model_report("cnn_fused", layer_names, layer_cycles, num_layers);
+        model_verify(&cnn, 0);
+    }
+    BENCH_VO_PARALLEL(cnn_graph_run, &cnn);
+    if (core_idx == 0) {
+        model_report_graph("cnn_graph", &cnn_graph);
+        model_verify(&cnn, 1);
+    }
+    snrt_cluster_hw_barrier();
+
+    size = transformer_tensors[0].size;
+    BENCH_VO_PARALLEL(transformer_naive, &transformer);
+    if (core_idx == 0) {
+        model_report("transformer_naive", layer_names, layer_cycles, num_layers);
+        model_verify(&transformer, 0);
+    }
+    BENCH_VO_PARALLEL(transformer_fused, &transformer);
+    if (core_idx == 0) {
+        model_report("transformer_fused", layer_names, layer_cycles, num_layers);
+        model_verify(&transformer, 0);
+    }
+    BENCH_VO_PARALLEL(transformer_graph_run, &transformer);
+    if (core_idx == 0) {
+        model_report_graph("transformer_graph", &transformer_graph);
+        model_verify(&transformer, 1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "multi.h"
+#include "add.h"
+#include "relu.h"
+#include "sigmoid.h"
+#include "gemm.h"
+#include "conv.h"
+#include "sum.h"
+#include "cumsum.h"
+
+/*
+ * Scaling of the multi-cluster operators of src/lmq/multi.h: every operator runs on 1 to all clusters
+ * (banshee --num-clusters, see run_clusters in scripts/env.sh) and global core 0 prints the cycles per number
+ * of clusters as "multi_<op> (clusters c)". The global core 0 computes the references with the baselines.
+ */
+
+#define MULTI_FILTER_SIZE 5
+#define MULTI_STRIDE 2
+#define MULTI_DILATION 2
+
+double *x, *y, *filter, *result, *result_ref;
+double sum_result, sum_result_ref;
+
+static int multi_add(double* a, double* b, const size_t n, double* result) {
+    return multi_binary(add_ssr_frep, a, b, n, result);
+}
+
+static int multi_relu(double* arr, const size_t n, double* result) {
+    return multi_unary(relu_ssr_frep, arr, n, result);
+}
+
+// An fpmath kernel, every cluster uses the carry scratch in its own L1
+static int multi_sigmoid(double* arr, const size_t n, double* result) {
+    return multi_unary(sigmoid_ssr_frep, arr, n, result);
+}
+
+int main() {
+    uint32_t global_core_idx = snrt_global_core_idx();
+    size_t clusters = snrt_cluster_num();
+
+    // gemm of about LMQ_SIZE elements per matrix
+    size_t dim = 1;
+    while ((2 * dim) * (2 * dim) <= LMQ_SIZE) {
+        dim *= 2;
+    }
+    size_t m = dim / 2 > 0 ? dim / 2 : 1;
+    size_t n = dim * 2;
+    size_t k = dim / 2 > 0 ? dim / 2 : 1;
+    size_t conv_size = conv_output_size(LMQ_SIZE, MULTI_FILTER_SIZE, MULTI_STRIDE, MULTI_DILATION);
+
+    if (global_core_idx == 0) {
+        printf("Running benchmark_multi on %d clusters\n", clusters);
+
+        x = allocate(LMQ_SIZE, sizeof(double));
+        y = allocate(LMQ_SIZE, sizeof(double));
+        filter = allocate(MULTI_FILTER_SIZE, sizeof(double));
+        result = allocate(LMQ_SIZE, sizeof(double));
+        result_ref = allocate(LMQ_SIZE, sizeof(double));
+
+        srandom(2);
+        for (size_t i = 0; i < LMQ_SIZE; i++) {
+            x[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+            y[i] = 1.0 * random() / __LONG_MAX__;
+        }
+        for (size_t i = 0; i < MULTI_FILTER_SIZE; i++) {
+            filter[i] = 1.0 * random() / __LONG_MAX__;
+        }
+    }
+    snrt_global_barrier();
+
+    for (size_t c = 1; c <= clusters; c++) {
+        multi_set_clusters(c);
+
+        size = LMQ_SIZE;
+        if (global_core_idx == 0) {
+            add_baseline(x, y, LMQ_SIZE, result_ref);
+        }
+        BENCH_VO_MULTI(multi_add, c, x, y, LMQ_SIZE, result);
+        if (global_core_idx == 0) {
+            verify_vector(result, result_ref, LMQ_SIZE);
+            clear_vector(result, LMQ_SIZE);
+            relu_baseline(x, LMQ_SIZE, result_ref);
+        }
+        BENCH_VO_MULTI(multi_relu, c, x, LMQ_SIZE, result);
+        if (global_core_idx == 0) {
+            verify_vector(result, result_ref, LMQ_SIZE);
+            clear_vector(result, LMQ_SIZE);
+            sigmoid_baseline(x, LMQ_SIZE, result_ref);
+        }
+        BENCH_VO_MULTI(multi_sigmoid, c, x, LMQ_SIZE, result);
+        if (global_core_idx == 0) {
+            verify_vector_approx(result, result_ref, LMQ_SIZE);
+            clear_vector(result, LMQ_SIZE);
+            sum_baseline(x, LMQ_SIZE, &sum_result_ref);
+        }
+        BENCH_VO_MULTI(multi_sum, c, x, LMQ_SIZE, &sum_result);
+        if (global_core_idx == 0) {
+            // the partials are added in another order than in the baseline
+            VERIFY_INT_APPROX(sum_result, sum_result_ref, "Mismatch: expected %f but got %f\n", sum_result_ref,
+                              sum_result);
+            cumsum_baseline(x, LMQ_SIZE, result_ref);
+        }
+        BENCH_VO_MULTI(multi_cumsum, c, x, LMQ_SIZE, result);
+        if (global_core_idx == 0) {
+            verify_vector_approx(result, result_ref, LMQ_SIZE);
+            clear_vector(result, LMQ_SIZE);
+        }
+
+        size = m * n * k;
+        bench_shape(3, "M", m, "N", n, "K", k);
+        if (global_core_idx == 0) {
+            gemm_baseline(x, y, m, n, k, result_ref);
+        }
+        BENCH_VO_MULTI(multi_gemm, c, x, y, m, n, k, result);
+        if (global_core_idx == 0) {
+            verify_vector(result, result_ref, m * k);
+            clear_vector(result, m * k);
+        }
+        bench_shape(0);
+
+        size = conv_size;
+        if (global_core_idx == 0) {
+            conv_baseline(x, filter, LMQ_SIZE, MULTI_FILTER_SIZE, MULTI_STRIDE, MULTI_DILATION, result_ref);
+        }
+        BENCH_VO_MULTI(multi_conv, c, x, filter, LMQ_SIZE, MULTI_FILTER_SIZE, MULTI_STRIDE, MULTI_DILATION, result);
+        if (global_core_idx == 0) {
+            verify_vector(result, result_ref, conv_size);
+            clear_vector(result, conv_size);
+        }
+    }
+
+    return 0;
+}
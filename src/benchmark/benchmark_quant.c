@@ -0,0 +1,150 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "quant.h"
+#include "gemm.h"
+#include "conv.h"
+
+/*
+ * The int8 kernels of src/onnx/quant.h against the fp64 kernels on the same shapes: square matrices of
+ * (dim x dim) with dim * dim <= size (the printed size of the gemms is dim^3 like in benchmark_dispatch) and a
+ * 3x3 convolution of a (dim x dim) image, plus QuantizeLinear and DequantizeLinear of size elements.
+ * The footprint line gives the bytes of the operands of a gemm in both types.
+ */
+#define FILTER 3
+
+double *x, *y, *result, *result_ref, *filter;
+int8_t *qx, *qy, *qresult, *qresult_ref, *qfilter;
+int32_t *iresult, *iresult_ref;
+qlinear_params_t params;
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    // x and y in [-1, 1), the products of (d x d) matrices in [-d, d)
+    const double x_scale = 1.0 / 128;
+    const int32_t x_zero_point = 0;
+    const double w_scale = 1.0 / 128;
+    const int32_t w_zero_point = 3;
+
+    size_t arena_start = arena_mark(arena_global());
+    size_t last_dim = 0;
+    for (size_t size = LMQ_START_SIZE; core_idx == 0 && size <= LMQ_SIZE; size *= 2) {
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_quant\n");
+
+        size_t dim = 1;
+        while ((dim + 1) * (dim + 1) <= size) {
+            dim++;
+        }
+        size_t n = dim * dim;
+        x = allocate(size, sizeof(double));
+        y = allocate(size, sizeof(double));
+        filter = allocate(FILTER * FILTER, sizeof(double));
+        result = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        qx = allocate(size, sizeof(int8_t));
+        qy = allocate(size, sizeof(int8_t));
+        qfilter = allocate(FILTER * FILTER, sizeof(int8_t));
+        qresult = allocate(size, sizeof(int8_t));
+        qresult_ref = allocate(size, sizeof(int8_t));
+        iresult = allocate(n, sizeof(int32_t));
+        iresult_ref = allocate(n, sizeof(int32_t));
+
+        srandom(2);
+        for (size_t i = 0; i < size; i++) {
+            x[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+            y[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+        }
+        for (size_t i = 0; i < FILTER * FILTER; i++) {
+            filter[i] = 2.0 * random() / __LONG_MAX__ - 1.0;
+        }
+
+        BENCH_VO(quantize_linear_baseline, x, size, x_scale, x_zero_point, qresult_ref);
+        BENCH_VO(quantize_linear_ssr, x, size, x_scale, x_zero_point, qx);
+        verify_vector_i8(qx, qresult_ref, size);
+
+        BENCH_VO(dequantize_linear_baseline, qx, size, x_scale, x_zero_point, result_ref);
+        BENCH_VO(dequantize_linear_ssr, qx, size, x_scale, x_zero_point, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        quantize_linear_baseline(y, size, w_scale, w_zero_point, qy);
+        quantize_linear_baseline(filter, FILTER * FILTER, w_scale, w_zero_point, qfilter);
+        // the output covers [-dim, dim)
+        qlinear_params(x_scale, x_zero_point, w_scale, w_zero_point, dim / 128.0, 0, &params);
+
+        size_t gemm_size = size;
+        size = dim * dim * dim;
+        printf("quant footprint, size: %d: fp64 %d bytes, int8 %d bytes\n", size, 3 * n * sizeof(double),
+               3 * n * sizeof(int8_t));
+        bench_shape(3, "M", dim, "N", dim, "K", dim);
+        BENCH_VO(gemm_ssr_frep, x, y, dim, dim, dim, result);
+
+        BENCH_VO(matmul_integer_baseline, qx, qy, dim, dim, dim, &params, iresult_ref);
+        BENCH_VO(matmul_integer_blocked, qx, qy, dim, dim, dim, &params, iresult);
+        verify_vector_i32(iresult, iresult_ref, n);
+
+        BENCH_VO(qlinear_matmul_baseline, qx, qy, dim, dim, dim, &params, qresult_ref);
+        BENCH_VO(qlinear_matmul_blocked, qx, qy, dim, dim, dim, &params, qresult);
+        verify_vector_i8(qresult, qresult_ref, n);
+        BENCH_VO(qlinear_matmul_ssr_frep, qx, qy, dim, dim, dim, &params, qresult);
+        verify_vector_i8(qresult, qresult_ref, n);
+        bench_shape(0);
+
+        size_t conv_size = conv_output_size(dim, FILTER, 1, 1);
+        size = conv_size * conv_size;
+        qlinear_params(x_scale, x_zero_point, w_scale, w_zero_point, FILTER * FILTER / 128.0, 0, &params);
+        BENCH_VO(conv2d_ssr_frep, x, filter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, result);
+        BENCH_VO(qlinear_conv2d_baseline, qx, qfilter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, &params, qresult_ref);
+        BENCH_VO(qlinear_conv2d_blocked, qx, qfilter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, &params, qresult);
+        verify_vector_i8(qresult, qresult_ref, size);
+
+        size = gemm_size;
+        last_dim = dim;
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel, on the buffers of the last size */
+    if (core_idx == 0) {
+        printf("Running benchmark_quant parallel\n");
+    }
+    size_t dim = last_dim;
+    size = dim * dim;
+
+    BENCH_VO_PARALLEL(quantize_linear_ssr_parallel, x, size, x_scale, x_zero_point, qx);
+    BENCH_VO_PARALLEL(dequantize_linear_ssr_parallel, qx, size, x_scale, x_zero_point, result);
+    if (core_idx == 0) {
+        dequantize_linear_baseline(qx, size, x_scale, x_zero_point, result_ref);
+        verify_vector(result, result_ref, size);
+        qlinear_params(x_scale, x_zero_point, w_scale, w_zero_point, dim / 128.0, 0, &params);
+        qlinear_matmul_baseline(qx, qy, dim, dim, dim, &params, qresult_ref);
+    }
+    snrt_cluster_hw_barrier();
+
+    size = dim * dim * dim;
+    BENCH_VO_PARALLEL(gemm_ssr_frep_parallel, x, y, dim, dim, dim, result);
+    BENCH_VO_PARALLEL(qlinear_matmul_blocked_parallel, qx, qy, dim, dim, dim, &params, qresult);
+    if (core_idx == 0) {
+        verify_vector_i8(qresult, qresult_ref, dim * dim);
+        qlinear_params(x_scale, x_zero_point, w_scale, w_zero_point, FILTER * FILTER / 128.0, 0, &params);
+        qlinear_conv2d_baseline(qx, qfilter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, &params, qresult_ref);
+    }
+    snrt_cluster_hw_barrier();
+
+    size_t conv_size = conv_output_size(dim, FILTER, 1, 1);
+    size = conv_size * conv_size;
+    BENCH_VO_PARALLEL(conv2d_ssr_frep_parallel, x, filter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, result);
+    BENCH_VO_PARALLEL(qlinear_conv2d_blocked_parallel, qx, qfilter, dim, dim, FILTER, FILTER, 1, 1, 1, 1, &params,
+                      qresult);
+    if (core_idx == 0) {
+        verify_vector_i8(qresult, qresult_ref, size);
+    }
+
+    return 0;
+}
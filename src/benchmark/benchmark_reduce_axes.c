@@ -0,0 +1,96 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "reduce_axes.h"
+#include "benchmark.h"
+
+double *x, *result_ref, *result;
+
+/*
+ * Shape (of at most rows * cols elements) and axes of a benchmarked reduction.
+ */
+typedef struct {
+    size_t ndim;
+    size_t shape[REDUCE_AXES_MAX_DIMS];
+    size_t num_axes;
+    int axes[REDUCE_AXES_MAX_DIMS];
+} reduce_axes_config_t;
+
+#define NUM_CONFIGS 5
+#define NUM_KINDS 5
+
+/*
+ * Number of elements of the shape without the reduced axes.
+ */
+static size_t output_len(const reduce_axes_config_t* cfg) {
+    size_t len = 1;
+    for (size_t d = 0; d < cfg->ndim; d++) {
+        int reduced = cfg->num_axes == 0;
+        for (size_t i = 0; i < cfg->num_axes; i++) {
+            reduced |= (cfg->axes[i] < 0 ? cfg->axes[i] + (int)cfg->ndim : cfg->axes[i]) == (int)d;
+        }
+        len *= reduced ? 1 : cfg->shape[d];
+    }
+    return len;
+}
+
+int main() {
+    uint32_t core_idx = snrt_global_core_idx();
+
+    reduce_axes_kind_t kinds[NUM_KINDS] = {
+        REDUCE_AXES_SUM, REDUCE_AXES_MEAN, REDUCE_AXES_MAX, REDUCE_AXES_L2, REDUCE_AXES_LOG_SUM_EXP
+    };
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t cols = 8;
+        size_t rows = size / cols + 1;
+        reduce_axes_config_t configs[NUM_CONFIGS] = {
+            // Inner axis, outer axis, spatial axes of an NCHW tensor, a middle axis and everything
+            {2, {rows, cols}, 1, {-1}},
+            {2, {rows, cols}, 1, {0}},
+            {4, {2, rows / 2, 2, 4}, 2, {2, 3}},
+            {3, {2, rows / 2, cols}, 1, {1}},
+            {2, {rows, cols}, 0, {0}},
+        };
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(rows * cols, sizeof(double));
+            result_ref = allocate(rows * cols, sizeof(double));
+            result = allocate(rows * cols, sizeof(double));
+
+            // Small integers, so the sums are exact in any order
+            for (size_t i = 0; i < rows * cols; i++) {
+                x[i] = (double)((i * 7) % 13);
+            }
+        }
+
+        for (size_t c = 0; c < NUM_CONFIGS; c++) {
+            reduce_axes_config_t* cfg = &configs[c];
+            size_t out_len = output_len(cfg);
+            for (size_t k = 0; k < NUM_KINDS; k++) {
+                if (core_idx == 0) {
+                    printf("Running benchmark_reduce_axes (config %d, kind %d)\n", c, kinds[k]);
+
+                    BENCH_VO(reduce_axes_baseline, kinds[k], x, cfg->shape, cfg->ndim, cfg->axes, cfg->num_axes, result_ref);
+
+                    BENCH_VO(reduce_axes_ssr_frep, kinds[k], x, cfg->shape, cfg->ndim, cfg->axes, cfg->num_axes, result);
+                    verify_vector_approx(result, result_ref, out_len);
+                    clear_vector(result, out_len);
+                }
+                snrt_cluster_hw_barrier();
+
+                BENCH_VO_PARALLEL(reduce_axes_ssr_frep_parallel, kinds[k], x, cfg->shape, cfg->ndim, cfg->axes, cfg->num_axes, result);
+                if (core_idx == 0) {
+                    verify_vector_approx(result, result_ref, out_len);
+                    clear_vector(result, out_len);
+                }
+                snrt_cluster_hw_barrier();
+            }
+        }
+    }
+
+    return 0;
+}
@@ -5,28 +5,293 @@
 #include "relu.h"
 #include "benchmark.h"
 
+double *x, *result_ref, *result;
+float *xf, *result_ref_f, *result_f;
+
+// PRelu of x as (2, PRELU_CHANNELS, size / (2 * PRELU_CHANNELS)) with one slope per channel
+#define PRELU_CHANNELS 5
+double slope[PRELU_CHANNELS] = {0.1, 0.2, 0.5, 1.0, -0.5};
+size_t x_shape[3];
+#define PRELU_SIZE (2 * PRELU_CHANNELS * x_shape[2])
+const size_t slope_shape[2] = {PRELU_CHANNELS, 1};
+
+// Clip to [lo, hi] (relu6) and HardSigmoid with the ONNX defaults
+const double lo = 0.0, hi = 6.0;
+const double hs_alpha = 0.2, hs_beta = 0.5;
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
+    double alpha = 0.1;
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
-        double* x = allocate(size, sizeof(double));
-        double* result_ref = allocate(size, sizeof(double));
-        double* result = allocate(size, sizeof(double));
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
 
         for (size_t i = 0; i < size; i++) {
             x[i] = (double)i - (double)size / 2;
         }
 
-        double alpha = 0.1;
-
         BENCH_VO(leakyrelu_baseline, x, size, alpha, result_ref);
 
 
         BENCH_VO(leakyrelu_ssr, x, size, alpha, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        BENCH_VO(leakyrelu_ssr_frep, x, size, alpha, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(relu_baseline, x, size, result_ref);
+
+        BENCH_VO(relu_ssr, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(relu_ssr_frep, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(clip_baseline, x, size, lo, hi, result_ref);
+
+        BENCH_VO(clip_ssr, x, size, lo, hi, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(clip_ssr_frep, x, size, lo, hi, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(hardsigmoid_baseline, x, size, hs_alpha, hs_beta, result_ref);
+
+        BENCH_VO(hardsigmoid_ssr, x, size, hs_alpha, hs_beta, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(hardsigmoid_ssr_frep, x, size, hs_alpha, hs_beta, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        x_shape[0] = 2;
+        x_shape[1] = PRELU_CHANNELS;
+        x_shape[2] = size / (2 * PRELU_CHANNELS);
+        BENCH_VO(prelu_baseline, x, x_shape, 3, slope, slope_shape, 2, result_ref);
+
+        BENCH_VO(prelu_ssr, x, x_shape, 3, slope, slope_shape, 2, result);
+        verify_vector(result, result_ref, PRELU_SIZE);
+        clear_vector(result, size);
+
+        BENCH_VO(prelu_ssr_frep, x, x_shape, 3, slope, slope_shape, 2, result);
+        verify_vector(result, result_ref, PRELU_SIZE);
+        clear_vector(result, size);
+
+        // float32 (packed SIMD)
+        xf = allocate(size, sizeof(float));
+        result_ref_f = allocate(size, sizeof(float));
+        result_f = allocate(size, sizeof(float));
+
+        for (size_t i = 0; i < size; i++) {
+            xf[i] = (float)i - (float)size / 2;
+        }
+
+        BENCH_VO(leakyrelu_baseline_f32, xf, size, (float)alpha, result_ref_f);
+
+        BENCH_VO(leakyrelu_ssr_frep_f32, xf, size, (float)alpha, result_f);
+        verify_vector_f32(result_f, result_ref_f, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        if (core_idx == 0) {
+            leakyrelu_baseline(x, size, alpha, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(leakyrelu_parallel, x, size, alpha, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(leakyrelu_ssr_parallel, x, size, alpha, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(leakyrelu_ssr_frep_parallel, x, size, alpha, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(leakyrelu_ssr_tiled, x, size, alpha, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        if (core_idx == 0) {
+            relu_baseline(x, size, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(relu_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(relu_ssr_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(relu_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        if (core_idx == 0) {
+            clip_baseline(x, size, lo, hi, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(clip_parallel, x, size, lo, hi, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(clip_ssr_parallel, x, size, lo, hi, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(clip_ssr_frep_parallel, x, size, lo, hi, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        if (core_idx == 0) {
+            hardsigmoid_baseline(x, size, hs_alpha, hs_beta, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(hardsigmoid_parallel, x, size, hs_alpha, hs_beta, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(hardsigmoid_ssr_parallel, x, size, hs_alpha, hs_beta, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(hardsigmoid_ssr_frep_parallel, x, size, hs_alpha, hs_beta, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        if (core_idx == 0) {
+            x_shape[2] = size / (2 * PRELU_CHANNELS);
+            prelu_baseline(x, x_shape, 3, slope, slope_shape, 2, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(prelu_parallel, x, x_shape, 3, slope, slope_shape, 2, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, PRELU_SIZE);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(prelu_ssr_frep_parallel, x, x_shape, 3, slope, slope_shape, 2, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, PRELU_SIZE);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        leakyrelu_baseline(x, size, alpha, result_ref);
+
+        BENCH_VO_OMP(leakyrelu_omp, x, size, alpha, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(leakyrelu_ssr_omp, x, size, alpha, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(leakyrelu_ssr_frep_omp, x, size, alpha, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        relu_baseline(x, size, result_ref);
+
+        BENCH_VO_OMP(relu_omp, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(relu_ssr_omp, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(relu_ssr_frep_omp, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        clip_baseline(x, size, lo, hi, result_ref);
+
+        BENCH_VO_OMP(clip_omp, x, size, lo, hi, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(clip_ssr_omp, x, size, lo, hi, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(clip_ssr_frep_omp, x, size, lo, hi, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        hardsigmoid_baseline(x, size, hs_alpha, hs_beta, result_ref);
+
+        BENCH_VO_OMP(hardsigmoid_omp, x, size, hs_alpha, hs_beta, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(hardsigmoid_ssr_omp, x, size, hs_alpha, hs_beta, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(hardsigmoid_ssr_frep_omp, x, size, hs_alpha, hs_beta, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        x_shape[2] = size / (2 * PRELU_CHANNELS);
+        prelu_baseline(x, x_shape, 3, slope, slope_shape, 2, result_ref);
+
+        BENCH_VO_OMP(prelu_omp, x, x_shape, 3, slope, slope_shape, 2, result);
+        verify_vector(result, result_ref, PRELU_SIZE);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(prelu_ssr_frep_omp, x, x_shape, 3, slope, slope_shape, 2, result);
+        verify_vector(result, result_ref, PRELU_SIZE);
+        clear_vector(result, size);
     }
+
+    __snrt_omp_destroy(core_idx);
  
     return 0;
 }
-
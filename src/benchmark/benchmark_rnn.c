@@ -0,0 +1,137 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include <math.h>
+
+#include "lmq.h"
+#include "rnn.h"
+#include "gemm.h"
+#include "benchmark.h"
+
+/*
+ * LSTM and GRU over SEQ timesteps of BATCH sequences with INPUT features and size / 8 hidden units: the fused
+ * cells against an LSTM built from two gemv per timestep with the gates activated and combined afterwards.
+ */
+#define SEQ 8
+#define BATCH 2
+#define INPUT 16
+
+double *x, *w, *r, *b, *h0, *c0, *y, *y_h, *y_c, *y_ref, *y_h_ref, *y_c_ref, *gx, *gh, *h;
+size_t hidden;
+
+static int lstm_unfused(double* x, double* w, double* r, double* b, double* h0, double* c0, size_t seq, size_t batch,
+                        size_t input, size_t hidden, double* y, double* y_h, double* y_c) {
+    size_t rows = 4 * hidden;
+    for (size_t n = 0; n < batch; n++) {
+        for (size_t j = 0; j < hidden; j++) {
+            h[j] = h0[n * hidden + j];
+            y_c[n * hidden + j] = c0[n * hidden + j];
+        }
+        for (size_t t = 0; t < seq; t++) {
+            gemv_ssr_frep(w, x + (t * batch + n) * input, rows, input, gx);
+            gemv_ssr_frep(r, h, rows, hidden, gh);
+            for (size_t k = 0; k < rows; k++) {
+                double v = gx[k] + gh[k] + b[k] + b[rows + k];
+                gx[k] = k < 3 * hidden ? 1.0 / (1.0 + exp(-v)) : tanh(v);
+            }
+            for (size_t j = 0; j < hidden; j++) {
+                double* c = y_c + n * hidden + j;
+                *c = gx[2 * hidden + j] * *c + gx[j] * gx[3 * hidden + j];
+                h[j] = gx[hidden + j] * tanh(*c);
+                y[(t * batch + n) * hidden + j] = h[j];
+            }
+        }
+        for (size_t j = 0; j < hidden; j++) {
+            y_h[n * hidden + j] = h[j];
+        }
+    }
+    return 0;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        hidden = size / 8;
+        size_t rows = 4 * hidden;
+        size_t len_y = SEQ * BATCH * hidden;
+        size_t len_h = BATCH * hidden;
+        bench_shape(4, "seq", SEQ, "batch", BATCH, "input", INPUT, "hidden", hidden);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(SEQ * BATCH * INPUT, sizeof(double));
+            w = allocate(rows * INPUT, sizeof(double));
+            r = allocate(rows * hidden, sizeof(double));
+            b = allocate(2 * rows, sizeof(double));
+            h0 = allocate(len_h, sizeof(double));
+            c0 = allocate(len_h, sizeof(double));
+            y = allocate(len_y, sizeof(double));
+            y_h = allocate(len_h, sizeof(double));
+            y_c = allocate(len_h, sizeof(double));
+            y_ref = allocate(len_y, sizeof(double));
+            y_h_ref = allocate(len_h, sizeof(double));
+            y_c_ref = allocate(len_h, sizeof(double));
+            gx = allocate(rows, sizeof(double));
+            gh = allocate(rows, sizeof(double));
+            h = allocate(hidden, sizeof(double));
+
+            for (size_t i = 0; i < SEQ * BATCH * INPUT; i++) {
+                x[i] = (double)(i % 9) / 4.0 - 1.0;
+            }
+            for (size_t i = 0; i < rows * INPUT; i++) {
+                w[i] = (double)(i % 7) / 12.0 - 0.25;
+            }
+            for (size_t i = 0; i < rows * hidden; i++) {
+                r[i] = (double)(i % 5) / 10.0 - 0.2;
+            }
+            for (size_t i = 0; i < 2 * rows; i++) {
+                b[i] = (double)(i % 3) / 10.0 - 0.1;
+            }
+            for (size_t i = 0; i < len_h; i++) {
+                h0[i] = (double)(i % 4) / 4.0 - 0.5;
+                c0[i] = (double)(i % 6) / 6.0 - 0.5;
+            }
+
+            BENCH_VO(lstm_baseline, x, w, r, b, h0, c0, SEQ, BATCH, INPUT, hidden, y_ref, y_h_ref, y_c_ref);
+
+            // The gemv accumulate in a different order
+            BENCH_VO(lstm_unfused, x, w, r, b, h0, c0, SEQ, BATCH, INPUT, hidden, y, y_h, y_c);
+            report_accuracy("lstm_unfused", y, y_ref, len_y, 1e-12);
+            report_accuracy("lstm_unfused_c", y_c, y_c_ref, len_h, 1e-12);
+            clear_vector(y, len_y);
+
+            BENCH_VO(lstm_ssr_frep, x, w, r, b, h0, c0, SEQ, BATCH, INPUT, hidden, y, y_h, y_c);
+            report_accuracy("lstm_ssr_frep", y, y_ref, len_y, 1e-12);
+            report_accuracy("lstm_ssr_frep_c", y_c, y_c_ref, len_h, 1e-12);
+            clear_vector(y, len_y);
+            clear_vector(y_c, len_h);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(lstm_ssr_frep_parallel, x, w, r, b, h0, c0, SEQ, BATCH, INPUT, hidden, y, y_h, y_c);
+        if (core_idx == 0) {
+            report_accuracy("lstm_ssr_frep_parallel", y, y_ref, len_y, 1e-12);
+            report_accuracy("lstm_ssr_frep_parallel_c", y_c, y_c_ref, len_h, 1e-12);
+            clear_vector(y, len_y);
+            clear_vector(y_c, len_h);
+
+            // The first three gate rows of w and r and the first 6 * hidden biases serve as GRU weights
+            BENCH_VO(gru_baseline, x, w, r, b, h0, SEQ, BATCH, INPUT, hidden, 0, y_ref, y_h_ref);
+
+            BENCH_VO(gru_ssr_frep, x, w, r, b, h0, SEQ, BATCH, INPUT, hidden, 0, y, y_h);
+            report_accuracy("gru_ssr_frep", y, y_ref, len_y, 1e-12);
+            clear_vector(y, len_y);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(gru_ssr_frep_parallel, x, w, r, b, h0, SEQ, BATCH, INPUT, hidden, 0, y, y_h);
+        if (core_idx == 0) {
+            report_accuracy("gru_ssr_frep_parallel", y, y_ref, len_y, 1e-12);
+            clear_vector(y, len_y);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "unique.h"
+#include "sparse.h"
+
+/*
+ * The static splits against the chunks of src/lmq/sched.h on skewed work:
+ *   unique:     element i is compared with the n - i - 1 elements after it, the static split of
+ *               unique_parallel gives the first core about 2 * core_num - 1 times the work of the last one
+ *   spmv/spmm:  a (M, COLS) CSR matrix whose first M / HUB_FRACTION rows are dense and whose other rows have
+ *               one nonzero, like a graph with a few hubs. csr_row_split balances the nonzeros, which leaves
+ *               all short rows with their cost per row to the last core.
+ * The values are small integers, so every order of the sums is exact.
+ */
+#define COLS 64
+#define K 8
+#define HUB_FRACTION 8
+
+double *arr, *x, *b, *values, *result, *result_ref;
+uint32_t *row_ptr, *col_idx;
+csr_t csr;
+size_t M;
+
+/*
+ * The skewed CSR matrix of m rows: the hub rows have all COLS nonzeros, the others one.
+ */
+static void skewed_csr(size_t m) {
+    size_t hubs = m / HUB_FRACTION > 0 ? m / HUB_FRACTION : 1;
+    size_t nnz = 0;
+    for (size_t i = 0; i < m; i++) {
+        row_ptr[i] = nnz;
+        size_t cols = i < hubs ? COLS : 1;
+        for (size_t j = 0; j < cols; j++) {
+            col_idx[nnz] = i < hubs ? j : (i * 7) % COLS;
+            values[nnz] = (double) (1 + (i + j) % 7) * ((i + j) % 2 ? 1 : -1);
+            nnz++;
+        }
+    }
+    row_ptr[m] = nnz;
+    csr = (csr_t){m, COLS, nnz, row_ptr, col_idx, values};
+    printf("sched: %d rows, %d hub rows, nnz: %d\n", m, hubs, nnz);
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        M = size / 4 > HUB_FRACTION ? size / 4 : HUB_FRACTION;
+        size_t max_nnz = (M / HUB_FRACTION) * COLS + M;
+        bench_shape(0);
+
+        if (core_idx == 0) {
+            printf("Running benchmark_sched\n");
+
+            arena_reset(arena_global(), arena_start);
+            arr = allocate(size, sizeof(double));
+            x = allocate(COLS, sizeof(double));
+            b = allocate(COLS * K, sizeof(double));
+            values = allocate(max_nnz, sizeof(double));
+            row_ptr = allocate(M + 1, sizeof(uint32_t));
+            col_idx = allocate(max_nnz, sizeof(uint32_t));
+            result = allocate(size > M * K ? size : M * K, sizeof(double));
+            result_ref = allocate(size > M * K ? size : M * K, sizeof(double));
+
+            // Every value occurs about 4 times, so both outcomes of the comparisons occur
+            for (size_t i = 0; i < size; i++) {
+                arr[i] = (double) ((i * 37) % (size / 4 + 1));
+            }
+            for (size_t i = 0; i < COLS; i++) {
+                x[i] = (double) ((int) (i % 5) - 2);
+            }
+            for (size_t i = 0; i < COLS * K; i++) {
+                b[i] = (double) ((int) (i % 7) - 3);
+            }
+            skewed_csr(M);
+
+            BENCH_VO(unique_baseline, arr, size, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(unique_parallel, arr, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(unique_parallel_dynamic, arr, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        bench_shape(2, "M", M, "N", COLS);
+        if (core_idx == 0) {
+            BENCH_VO(spmv_baseline, &csr, x, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(spmv_ssr_frep_parallel, &csr, x, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M);
+            clear_vector(result, M);
+        }
+
+        BENCH_VO_PARALLEL(spmv_ssr_frep_parallel_dynamic, &csr, x, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M);
+            clear_vector(result, M);
+        }
+
+        bench_shape(3, "M", M, "N", COLS, "K", K);
+        if (core_idx == 0) {
+            BENCH_VO(spmm_baseline, &csr, b, K, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(spmm_ssr_frep_parallel, &csr, b, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+
+        BENCH_VO_PARALLEL(spmm_ssr_frep_parallel_dynamic, &csr, b, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+        snrt_cluster_hw_barrier();
+    }
+
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "shapes.h"
+#include "gemm.h"
+#include "conv.h"
+#include "relu.h"
+#include "cumsum.h"
+#include "dot.h"
+
+#define NUM_SHAPES(table) (sizeof(table) / sizeof(table[0]))
+
+/*
+ * Benchmarks the shapes of shapes.h instead of doubling sizes, to exercise the remainder paths and
+ * skinny or fat problems. The printed size is the number of multiply-adds of a GEMM, the output length of
+ * a convolution and the length of a vector; the records (LMQ_RECORD) carry the whole shape.
+ */
+
+double *x, *y, *result, *result_ref;
+double dot_result, dot_result_ref;
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+
+    for (size_t s = 0; s < NUM_SHAPES(gemm_shapes); s++) {
+        const gemm_shape_t* shape = &gemm_shapes[s];
+        size_t M = shape->m;
+        size_t N = shape->n;
+        size_t K = shape->k;
+        if (M * N + N * K + 2 * M * K > LMQ_SHAPES_MAX_ELEMENTS) {
+            if (core_idx == 0) {
+                printf("gemm shape %s (%d x %d x %d) skipped, over LMQ_SHAPES_MAX_ELEMENTS\n", shape->name, M, N, K);
+            }
+            continue;
+        }
+        size = M * N * K;
+        bench_shape(3, "M", M, "N", N, "K", K);
+
+        if (core_idx == 0) {
+            printf("gemm shape %s: M %d, N %d, K %d\n", shape->name, M, N, K);
+            arena_reset(arena_global(), arena_start);
+            x = allocate(M * N, sizeof(double));
+            y = allocate(N * K, sizeof(double));
+            result_ref = allocate(M * K, sizeof(double));
+            result = allocate(M * K, sizeof(double));
+            for (size_t i = 0; i < M * N; i++) {
+                x[i] = (double)(i % 13);
+            }
+            for (size_t i = 0; i < N * K; i++) {
+                y[i] = (double)(i % 7);
+            }
+
+            BENCH_VO(gemm_baseline, x, y, M, N, K, result_ref);
+
+            BENCH_VO(gemm_ssr, x, y, M, N, K, result);
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+
+            BENCH_VO(gemm_ssr_frep, x, y, M, N, K, result);
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+
+            BENCH_VO(gemm_ssr_frep_blocked, x, y, M, N, K, result);
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(gemm_parallel, x, y, M, N, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+
+        BENCH_VO_PARALLEL(gemm_ssr_frep_parallel, x, y, M, N, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+
+        BENCH_VO_PARALLEL(gemm_ssr_frep_tiled_parallel, x, y, M, N, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+
+        BENCH_VO_PARALLEL(gemm_ssr_frep_blocked_parallel, x, y, M, N, K, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+        }
+    }
+
+    for (size_t s = 0; s < NUM_SHAPES(conv_shapes); s++) {
+        const conv_shape_t* shape = &conv_shapes[s];
+        size_t input_size = (shape->n - 1) * shape->stride + 1 + (shape->filter - 1) * shape->dilation;
+        if (input_size + shape->filter + 2 * shape->n > LMQ_SHAPES_MAX_ELEMENTS) {
+            if (core_idx == 0) {
+                printf("conv shape %s (%d outputs) skipped, over LMQ_SHAPES_MAX_ELEMENTS\n", shape->name, shape->n);
+            }
+            continue;
+        }
+        size = conv_output_size(input_size, shape->filter, shape->stride, shape->dilation);
+        bench_shape(4, "n", input_size, "filter", shape->filter, "stride", shape->stride, "dilation", shape->dilation);
+
+        if (core_idx == 0) {
+            printf("conv shape %s: n %d, filter %d, stride %d, dilation %d\n",
+                   shape->name, input_size, shape->filter, shape->stride, shape->dilation);
+            arena_reset(arena_global(), arena_start);
+            x = allocate(input_size, sizeof(double));
+            y = allocate(shape->filter, sizeof(double));
+            result_ref = allocate(size, sizeof(double));
+            result = allocate(size, sizeof(double));
+            for (size_t i = 0; i < input_size; i++) {
+                x[i] = (double)(i % 11);
+            }
+            for (size_t i = 0; i < shape->filter; i++) {
+                y[i] = (double)(i % 5) - 2.0;
+            }
+
+            BENCH_VO(conv_baseline, x, y, input_size, shape->filter, shape->stride, shape->dilation, result_ref);
+
+            BENCH_VO(conv_ssr_frep, x, y, input_size, shape->filter, shape->stride, shape->dilation, result);
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(conv_ssr_frep_parallel, x, y, input_size, shape->filter, shape->stride, shape->dilation, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    for (size_t s = 0; s < NUM_SHAPES(vector_lengths); s++) {
+        size_t n = vector_lengths[s];
+        if (3 * n > LMQ_SHAPES_MAX_ELEMENTS) {
+            continue;
+        }
+        size = n;
+        bench_shape(0);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(n, sizeof(double));
+            result_ref = allocate(n, sizeof(double));
+            result = allocate(n, sizeof(double));
+            for (size_t i = 0; i < n; i++) {
+                x[i] = (double)(i % 5) - 2.0;
+            }
+
+            BENCH_VO(relu_baseline, x, n, result_ref);
+
+            BENCH_VO(relu_ssr_frep, x, n, result);
+            verify_vector(result, result_ref, n);
+            clear_vector(result, n);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(relu_ssr_frep_parallel, x, n, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, n);
+            clear_vector(result, n);
+
+            BENCH_VO(dot_baseline, x, x, n, &dot_result_ref);
+
+            BENCH_VO(dot_ssr_frep, x, x, n, &dot_result);
+            VERIFY_INT(dot_result, dot_result_ref, "Mismatch: expected %f but got %f\n", dot_result_ref, dot_result);
+            dot_result = 0.0;
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(dot_ssr_frep_parallel, x, x, n, &dot_result);
+        if (core_idx == 0) {
+            VERIFY_INT(dot_result, dot_result_ref, "Mismatch: expected %f but got %f\n", dot_result_ref, dot_result);
+            dot_result = 0.0;
+
+            BENCH_VO(cumsum_baseline, x, n, result_ref);
+
+            BENCH_VO(cumsum_ssr_frep, x, n, result);
+            verify_vector(result, result_ref, n);
+            clear_vector(result, n);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(cumsum_parallel, x, n, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, n);
+            clear_vector(result, n);
+        }
+
+        BENCH_VO_PARALLEL(cumsum_ssr_frep_parallel, x, n, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, n);
+            clear_vector(result, n);
+        }
+    }
+
+    return 0;
+}
@@ -4,18 +4,25 @@
 
 #include "lmq.h"
 #include "sigmoid.h"
+#include "lut.h"
 #include "benchmark.h"
 
+double *x, *result_ref, *result;
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_sigmoid\n");
 
         // x is input; result is output of the optimized functions
-        double* x = allocate(size, sizeof(double));
-        double* result_ref = allocate(size, sizeof(double));
-        double* result = allocate(size, sizeof(double));
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result = allocate(size, sizeof(double));
 
         srandom(2);
         x[0] = 0.0; // sigmoid(0.0) is 0.5
@@ -33,10 +40,73 @@ int main() {
         BENCH_VO(sigmoid_baseline, x, size, result_ref);
         
         BENCH_VO(sigmoid_ssr, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(sigmoid_ssr_frep, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(sigmoid_lut, x, size, result);
+        report_accuracy("sigmoid_lut", result, result_ref, size, LUT_MAX_ERROR);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        sigmoid_baseline(x, size, result_ref);
+
+        BENCH_VO_PARALLEL(sigmoid_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(sigmoid_ssr_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(sigmoid_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(sigmoid_lut_parallel, x, size, result);
+        if (core_idx == 0) {
+            report_accuracy("sigmoid_lut_parallel", result, result_ref, size, LUT_MAX_ERROR);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(sigmoid_ssr_tiled, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        sigmoid_baseline(x, size, result_ref);
+
+        BENCH_VO_OMP(sigmoid_omp, x, size, result);
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        BENCH_VO_OMP(sigmoid_ssr_omp, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(sigmoid_ssr_frep_omp, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
     }
 
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
-
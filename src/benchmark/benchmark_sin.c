@@ -15,7 +15,11 @@ double *x, *result_ref, *result;
 int main() {
     uint32_t core_idx = snrt_cluster_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_sin\n");
 
         x = allocate(size, sizeof(double)); // input
@@ -37,14 +41,69 @@ int main() {
         clear_vector(result, size);
         clear_vector(result_ref, size);
 
+        BENCH_VO(cos_baseline, x, size, result_ref);
+
+        BENCH_VO(cos_ssr_frep, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(cos_ssr_frep_fast, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
         BENCH_VO(sin_baseline, x, size, result_ref);
         
         BENCH_VO(sin_ssr, x, size, result);
-        verify_vector(result, result_ref, size);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(sin_ssr_frep, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
 
+        BENCH_VO(sin_ssr_frep_fast, x, size, result);
+        verify_vector_approx(result, result_ref, size);
         clear_vector(result, size);
     }
 
+    /* Accuracy against libm on [-100, 100] and the zeros of sin and cos */
+    if (core_idx == 0) {
+        double *x_wide = allocate(size, sizeof(double));
+        double *ref_wide = allocate(size, sizeof(double));
+        double *result_wide = allocate(size, sizeof(double));
+
+        srandom(3);
+        for (size_t i = 0; i < size; i++) {
+            if (i % 4 == 0) {
+                x_wide[i] = (double) ((int) i / 4 - (int) size / 8) * M_PI / 2.0;
+            } else {
+                x_wide[i] = 200.0 * random() / __LONG_MAX__ - 100.0;
+            }
+        }
+
+        sin_baseline(x_wide, size, ref_wide);
+        sin_ssr_frep(x_wide, size, result_wide);
+        report_accuracy("sin_ssr_frep", result_wide, ref_wide, size, 1e-14);
+        sin_ssr_frep_fast(x_wide, size, result_wide);
+        report_accuracy("sin_ssr_frep_fast", result_wide, ref_wide, size, 1e-10);
+
+        cos_baseline(x_wide, size, ref_wide);
+        cos_ssr_frep(x_wide, size, result_wide);
+        report_accuracy("cos_ssr_frep", result_wide, ref_wide, size, 1e-14);
+        cos_ssr_frep_fast(x_wide, size, result_wide);
+        report_accuracy("cos_ssr_frep_fast", result_wide, ref_wide, size, 1e-10);
+
+        // sin_approx is only valid on [-pi, pi]
+        for (size_t i = 0; i < size; i++) {
+            x_wide[i] = 2.0 * M_PI * random() / __LONG_MAX__ - M_PI;
+        }
+        sin_baseline(x_wide, size, ref_wide);
+        sin_approx_ssr(x_wide, size, result_wide);
+        report_error("sin_approx_ssr", result_wide, ref_wide, size);
+        sin_ssr_frep_fast(x_wide, size, result_wide);
+        report_accuracy("sin_ssr_frep_fast", result_wide, ref_wide, size, 1e-10);
+    }
+
     /* Benchmark bare metal parallel */
     for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
         uint32_t core_num = snrt_cluster_compute_core_num();
@@ -57,7 +116,19 @@ int main() {
         
         BENCH_VO_PARALLEL(sin_ssr_parallel, x, size, result);
         if (core_idx == 0) {
-            verify_vector(result, result_ref, size);
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(sin_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(sin_ssr_tiled, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
             clear_vector(result, size);
         }
     }
@@ -81,7 +152,7 @@ int main() {
         // for(unsigned i = 0; i < size; i++) {
         //     printf("Value of result at %d is %f\n", i, result[i]);
         // }
-        verify_vector(result, result_ref, size);
+        verify_vector_approx(result, result_ref, size);
         clear_vector(result, size);
     }
 
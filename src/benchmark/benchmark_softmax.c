@@ -0,0 +1,48 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "softmax.h"
+#include "benchmark.h"
+
+#define ROWS 8
+
+double *x, *result_ref, *result;
+
+int main() {
+    uint32_t core_idx = snrt_global_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        size_t cols = size / ROWS + 1;
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(ROWS * cols, sizeof(double));
+            result_ref = allocate(ROWS * cols, sizeof(double));
+            result = allocate(ROWS * cols, sizeof(double));
+
+            for (size_t i = 0; i < ROWS * cols; i++) {
+                x[i] = (double)((i * 7) % 13) / 4 - 1.5;
+            }
+
+            printf("Running benchmark_softmax\n");
+
+            BENCH_VO(softmax_baseline, x, ROWS, cols, result_ref);
+
+            BENCH_VO(softmax_ssr_frep, x, ROWS, cols, result);
+            verify_vector_approx(result, result_ref, ROWS * cols);
+            clear_vector(result, ROWS * cols);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(softmax_ssr_frep_parallel, x, ROWS, cols, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, ROWS * cols);
+            clear_vector(result, ROWS * cols);
+        }
+        snrt_cluster_hw_barrier();
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "softplus.h"
+#include "benchmark.h"
+
+// x is input; result is output of the optimized functions
+double *x, *result_ref, *result;
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_softplus\n");
+
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result  = allocate(size, sizeof(double));
+
+        srandom(2);
+        x[0] = 0.0; // softplus(0.0) is log(2)
+        x[1] = -40.0; // softplus(-40.0) is exp(-40.0)
+        for (size_t i = 2; i < size; i++) {
+            x[i] = -20.0 + 40.0 * random() / __LONG_MAX__;
+        }
+
+        BENCH_VO(softplus_baseline, x, size, result_ref);
+
+        BENCH_VO(softplus_ssr, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(softplus_ssr_frep, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        report_error("softplus_ssr_frep", result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        softplus_baseline(x, size, result_ref);
+
+        BENCH_VO_PARALLEL(softplus_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+
+        BENCH_VO_PARALLEL(softplus_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        softplus_baseline(x, size, result_ref);
+
+        BENCH_VO_OMP(softplus_omp, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO_OMP(softplus_ssr_frep_omp, x, size, result);
+        verify_vector_approx(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    __snrt_omp_destroy(core_idx);
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "sparse.h"
+#include "gemm.h"
+
+/*
+ * CSR times a dense vector and a dense (COLS, K) matrix against the dense gemv and gemm on the same
+ * (size / COLS + 3, COLS) matrix, pruned to 30% and 10% nonzeros (70% and 90% sparsity).
+ * The values are small integers, so every order of the sums is exact.
+ */
+#define COLS 64
+#define K 8
+
+static const int densities[] = {30, 10};
+
+double *a, *x, *b, *values, *result, *result_ref;
+uint32_t *row_ptr, *col_idx;
+csr_t csr;
+size_t M;
+
+/*
+ * A dense (m, COLS) matrix of which density percent of the elements are not zero.
+ */
+static void prune(size_t m, int density) {
+    srandom(2);
+    for (size_t i = 0; i < m * COLS; i++) {
+        a[i] = random() % 100 < density ? (double) (1 + random() % 7) * (i % 2 ? 1 : -1) : 0.0;
+    }
+    size_t nnz = csr_from_dense(a, m, COLS, row_ptr, col_idx, values, &csr);
+    printf("sparse density: %d%%, nnz: %d\n", density, nnz);
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; core_idx == 0 && size <= LMQ_SIZE; size *= 2) {
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_sparse\n");
+
+        M = size / COLS + 3;
+        a = allocate(M * COLS, sizeof(double));
+        x = allocate(COLS, sizeof(double));
+        b = allocate(COLS * K, sizeof(double));
+        values = allocate(M * COLS, sizeof(double));
+        row_ptr = allocate(M + 1, sizeof(uint32_t));
+        col_idx = allocate(M * COLS, sizeof(uint32_t));
+        result = allocate(M * K, sizeof(double));
+        result_ref = allocate(M * K, sizeof(double));
+        for (size_t i = 0; i < COLS; i++) {
+            x[i] = (double) ((int) (i % 5) - 2);
+        }
+        for (size_t i = 0; i < COLS * K; i++) {
+            b[i] = (double) ((int) (i % 7) - 3);
+        }
+
+        for (size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); d++) {
+            prune(M, densities[d]);
+
+            bench_shape(2, "M", M, "N", COLS);
+            BENCH_VO(gemv_ssr_frep, a, x, M, COLS, result_ref);
+
+            BENCH_VO(spmv_baseline, &csr, x, result);
+            verify_vector(result, result_ref, M);
+            clear_vector(result, M);
+
+            BENCH_VO(spmv_ssr_frep, &csr, x, result);
+            verify_vector(result, result_ref, M);
+            clear_vector(result, M);
+
+            bench_shape(3, "M", M, "N", COLS, "K", K);
+            BENCH_VO(gemm_ssr_frep, a, b, M, COLS, K, result_ref);
+
+            BENCH_VO(spmm_baseline, &csr, b, K, result);
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+
+            BENCH_VO(spmm_ssr_frep, &csr, b, K, result);
+            verify_vector(result, result_ref, M * K);
+            clear_vector(result, M * K);
+            bench_shape(0);
+        }
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel, on the buffers of the last size at the last density */
+    if (core_idx == 0) {
+        printf("Running benchmark_sparse parallel\n");
+    }
+    size = M * COLS;
+
+    if (core_idx == 0) {
+        gemv_ssr_frep(a, x, M, COLS, result_ref);
+    }
+    snrt_cluster_hw_barrier();
+    bench_shape(2, "M", M, "N", COLS);
+    BENCH_VO_PARALLEL(gemv_ssr_frep_parallel, a, x, M, COLS, result);
+    BENCH_VO_PARALLEL(spmv_ssr_frep_parallel, &csr, x, result);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, M);
+        clear_vector(result, M);
+        gemm_ssr_frep(a, b, M, COLS, K, result_ref);
+    }
+    snrt_cluster_hw_barrier();
+
+    bench_shape(3, "M", M, "N", COLS, "K", K);
+    BENCH_VO_PARALLEL(gemm_ssr_frep_parallel, a, b, M, COLS, K, result);
+    BENCH_VO_PARALLEL(spmm_ssr_frep_parallel, &csr, b, K, result);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, M * K);
+    }
+    bench_shape(0);
+
+    return 0;
+}
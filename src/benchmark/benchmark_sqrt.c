@@ -0,0 +1,127 @@
+#include <snrt.h>
+#include "printf.h"
+#include "stdlib.h"
+
+#include "lmq.h"
+#include "sqrt.h"
+#include "benchmark.h"
+
+// x is input; result is output of the optimized functions
+double *x, *result_ref, *result, *exact;
+
+// RSQRT_MAX_ULP ulp of results in [1, 2), relative to the results (absolute below 1)
+#define SQRT_TOLERANCE (RSQRT_MAX_ULP * 0x1p-52)
+
+/*
+ * sqrt within 0.5 ulp: the residual x - r^2 of r = sqrt_fast(x) is exact with an fmadd, one Heron step corrects r.
+ */
+static void sqrt_exact(const double* arr, const size_t n, double* out) {
+    for (size_t i = 0; i < n; i++) {
+        double r = sqrt_fast(arr[i]);
+        out[i] = r > 0 ? r + fma(-r, r, arr[i]) * 0.5 / r : r;
+    }
+}
+
+__attribute__((noinline))
+int sqrt_approx_baseline(const double* arr, const size_t n, double* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = sqrt_approx(arr[i]);
+    }
+    return 0;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_sqrt\n");
+
+        x = allocate(size, sizeof(double));
+        result_ref = allocate(size, sizeof(double));
+        result  = allocate(size, sizeof(double));
+        exact = allocate(size, sizeof(double));
+
+        // [0.5, 1.5) times 1e-8 to 1e8, sqrt_approx starts at 1 and is only accurate around it
+        srandom(2);
+        double scale = 1e-8;
+        x[0] = 0.0;
+        x[1] = 4.0;
+        for (size_t i = 2; i < size; i++) {
+            x[i] = scale * (0.5 + 1.0 * random() / __LONG_MAX__);
+            scale = scale < 1e8 ? scale * 10 : 1e-8;
+        }
+        sqrt_exact(x, size, exact);
+
+        BENCH_VO(sqrt_approx_baseline, x, size, result);
+        report_accuracy("sqrt_approx_baseline", result, exact, size, 1e-15);
+        clear_vector(result, size);
+
+        BENCH_VO(sqrt_baseline, x, size, result_ref);
+        report_accuracy("sqrt_baseline", result_ref, exact, size, SQRT_TOLERANCE);
+
+        BENCH_VO(sqrt_ssr, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+
+        BENCH_VO(sqrt_ssr_frep, x, size, result);
+        verify_vector(result, result_ref, size);
+        report_accuracy("sqrt_ssr_frep", result, exact, size, SQRT_TOLERANCE);
+        clear_vector(result, size);
+
+        // x is not 0 from here, 1 / sqrt(0) is not representable
+        x[0] = 1.0;
+        for (size_t i = 0; i < size; i++) {
+            exact[i] = 1.0 / exact[i];
+        }
+        exact[0] = 1.0;
+
+        BENCH_VO(rsqrt_baseline, x, size, result_ref);
+        report_accuracy("rsqrt_baseline", result_ref, exact, size, SQRT_TOLERANCE);
+
+        BENCH_VO(rsqrt_ssr_frep, x, size, result);
+        verify_vector(result, result_ref, size);
+        report_accuracy("rsqrt_ssr_frep", result, exact, size, SQRT_TOLERANCE);
+        clear_vector(result, size);
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        if (core_idx == 0) {
+            sqrt_baseline(x, size, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(sqrt_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+            rsqrt_baseline(x, size, result_ref);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(rsqrt_ssr_frep_parallel, x, size, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, size);
+            clear_vector(result, size);
+        }
+    }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
+        sqrt_baseline(x, size, result_ref);
+
+        BENCH_VO_OMP(sqrt_ssr_frep_omp, x, size, result);
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+    }
+
+    __snrt_omp_destroy(core_idx);
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "sum.h"
+#include "max.h"
+#include "cumsum.h"
+#include "benchmark.h"
+#include "golden.h"
+
+/*
+ * Streams a tensor of STREAM_LENGTH elements, far more than is allocated, through the streaming sum, max and
+ * cumsum in chunks of size elements. Every chunk is generated into the one chunk buffer before it is handed
+ * to the operators, like a chunk arriving from the host. The first chunk of every stream is measured, the
+ * states after the last chunk and the cumulative sums of every chunk are checked against the baselines.
+ */
+#ifndef STREAM_LENGTH
+#define STREAM_LENGTH (16 * LMQ_SIZE)
+#endif
+
+// Measures the call if timed, the chunks after the first cost the same
+#define STREAM_CALL(timed, func_name, ...)    \
+    if (timed) {                              \
+        BENCH_VO(func_name, __VA_ARGS__);     \
+    } else {                                  \
+        func_name(__VA_ARGS__);               \
+    }
+
+#define STREAM_CALL_PARALLEL(timed, func_name, ...) \
+    if (timed) {                                    \
+        BENCH_VO_PARALLEL(func_name, __VA_ARGS__);  \
+    } else {                                        \
+        func_name(__VA_ARGS__);                     \
+        snrt_cluster_hw_barrier();                  \
+    }
+
+double *chunk, *result, *result_ref;
+sum_stream_t sum_ref, sum_state, sum_state_parallel;
+max_stream_t max_ref, max_state, max_state_parallel;
+cumsum_stream_t cumsum_ref, cumsum_state, cumsum_state_parallel;
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        size_t chunks = STREAM_LENGTH / size;
+        bench_shape(2, "chunk", size, "length", chunks * size);
+
+        if (core_idx == 0) {
+            printf("Running benchmark_stream\n");
+
+            arena_reset(arena_global(), arena_start);
+            chunk = allocate(size, sizeof(double));
+            result = allocate(size, sizeof(double));
+            result_ref = allocate(size, sizeof(double));
+
+            sum_stream_init(&sum_ref);
+            sum_stream_init(&sum_state);
+            sum_stream_init(&sum_state_parallel);
+            max_stream_init(&max_ref);
+            max_stream_init(&max_state);
+            max_stream_init(&max_state_parallel);
+            cumsum_stream_init(&cumsum_ref);
+            cumsum_stream_init(&cumsum_state);
+            cumsum_stream_init(&cumsum_state_parallel);
+        }
+
+        for (size_t c = 0; c < chunks; c++) {
+            int timed = c == 0;
+
+            if (core_idx == 0) {
+                for (size_t i = 0; i < size; i++) {
+                    chunk[i] = golden_value(0, c * size + i, 1.0) - 0.5;
+                }
+
+                STREAM_CALL(timed, sum_stream_baseline, &sum_ref, chunk, size);
+                STREAM_CALL(timed, max_stream_baseline, &max_ref, chunk, size);
+                STREAM_CALL(timed, cumsum_stream_baseline, &cumsum_ref, chunk, size, result_ref);
+
+                STREAM_CALL(timed, sum_stream_ssr_frep, &sum_state, chunk, size);
+                STREAM_CALL(timed, max_stream_ssr_frep, &max_state, chunk, size);
+                STREAM_CALL(timed, cumsum_stream_ssr_frep, &cumsum_state, chunk, size, result);
+                verify_vector(result, result_ref, size);
+                clear_vector(result, size);
+            }
+            snrt_cluster_hw_barrier();
+
+            STREAM_CALL_PARALLEL(timed, sum_stream_ssr_frep_parallel, &sum_state_parallel, chunk, size);
+            STREAM_CALL_PARALLEL(timed, max_stream_ssr_frep_parallel, &max_state_parallel, chunk, size);
+            STREAM_CALL_PARALLEL(timed, cumsum_stream_ssr_frep_parallel, &cumsum_state_parallel, chunk, size, result);
+            if (core_idx == 0) {
+                verify_vector_approx(result, result_ref, size);
+                clear_vector(result, size);
+            }
+            snrt_cluster_hw_barrier();
+        }
+
+        if (core_idx == 0) {
+            // The ssr_frep sums add in a different order than the baselines
+            report_accuracy("sum_stream_ssr_frep", &sum_state.sum, &sum_ref.sum, 1, 1e-9);
+            report_accuracy("sum_stream_ssr_frep_parallel", &sum_state_parallel.sum, &sum_ref.sum, 1, 1e-9);
+            verify_vector(&max_state.max, &max_ref.max, 1);
+            verify_vector(&max_state_parallel.max, &max_ref.max, 1);
+            verify_vector(&cumsum_state.carry, &cumsum_ref.carry, 1);
+            report_accuracy("cumsum_stream_ssr_frep_parallel", &cumsum_state_parallel.carry, &cumsum_ref.carry, 1, 1e-9);
+            if (sum_state.count != sum_ref.count || max_state_parallel.count != max_ref.count ||
+                cumsum_state_parallel.count != cumsum_ref.count) {
+                printf("Error: streamed %d elements, expected %d\n", cumsum_state_parallel.count, cumsum_ref.count);
+            }
+        }
+        snrt_cluster_hw_barrier();
+    }
+
+    return 0;
+}
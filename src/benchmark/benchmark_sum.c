@@ -4,6 +4,7 @@
 #include "lmq.h"
 #include "sum.h"
 #include "benchmark.h"
+#include "golden.h"
 
 double *x;
 int main() {
@@ -14,16 +15,17 @@ int main() {
     double result_ref = -1.0;
     double result = -1.0;
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_sum\n");
 
         x = allocate(size, sizeof(double));
-        for (size_t i = 0; i < size; i++) {
-            x[i] = 1.0 * random() / __LONG_MAX__;
-            // x[i] = i;
-        }
+        golden_fill(x, size, 0, 1.0);
 
-        BENCH(sum_baseline, x, size, &result_ref);
+        BENCH_REF(&result_ref, sum_baseline, x, size, &result_ref);
         printf("Baseline: %f\n", result_ref);
 
         BENCH(sum_ssr, x, size, &result);
@@ -33,6 +35,23 @@ int main() {
         BENCH(sum_ssr_frep, x, size, &result);
         VERIFY_INT_APPROX(result, result_ref, "MISMATCH Expected %f but got %f\n", result_ref, result);
         result = -1.0;
+
+        BENCH(sum_ssr_frep_staggered, x, size, &result);
+        VERIFY_INT_APPROX(result, result_ref, "MISMATCH Expected %f but got %f\n", result_ref, result);
+        result = -1.0;
+
+        // float32 (packed SIMD)
+        float* xf = allocate(size, sizeof(float));
+        for (size_t i = 0; i < size; i++) {
+            xf[i] = (float)x[i];
+        }
+        float result_ref_f = -1.0f;
+        float result_f = -1.0f;
+
+        BENCH(sum_baseline_f32, xf, size, &result_ref_f);
+
+        BENCH(sum_ssr_frep_f32, xf, size, &result_f);
+        VERIFY_INT_APPROX(result_f, result_ref_f, "MISMATCH Expected %f but got %f\n", result_ref_f, result_f);
     }
 
     /* Benchmark parallel cores */
@@ -64,12 +83,30 @@ int main() {
             VERIFY_INT_APPROX(result, result_ref, "MISMATCH Expected %f but got %f\n", result_ref, result);
             printf("sum_ssr_frep_parallel result: %f\n", result);
         }
+
+        BENCH_VO_PARALLEL(sum_ssr_frep_tiled, x, size, &result);
+        if (core_idx == 0) {
+            VERIFY_INT_APPROX(result, result_ref, "MISMATCH Expected %f but got %f\n", result_ref, result);
+            result = -1.0;
+        }
     }
 
     __snrt_omp_bootstrap(core_idx);
 
     for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2){
-        // Not possible with current snitch version. See README.md
+        sum_baseline(x, size, &result_ref);
+
+        BENCH_VO_OMP(sum_omp, x, size, &result);
+        VERIFY_INT_APPROX(result, result_ref, "MISMATCH Expected %f but got %f\n", result_ref, result);
+        result = -1.0;
+
+        BENCH_VO_OMP(sum_ssr_omp, x, size, &result);
+        VERIFY_INT_APPROX(result, result_ref, "MISMATCH Expected %f but got %f\n", result_ref, result);
+        result = -1.0;
+
+        BENCH_VO_OMP(sum_ssr_frep_omp, x, size, &result);
+        VERIFY_INT_APPROX(result, result_ref, "MISMATCH Expected %f but got %f\n", result_ref, result);
+        result = -1.0;
     }
     __snrt_omp_destroy(core_idx);
 
@@ -0,0 +1,192 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "task.h"
+#include "gemm.h"
+#include "relu.h"
+
+/*
+ * Two dense layers Y = relu(X W1) W2 of X (m x DIM) over blocks of TASK_ROWS rows (m = size / DIM):
+ *   parallel:  gemm, relu and gemm with a cluster barrier after every parallel kernel
+ *   queue:     core 0 submits the row blocks of both layers into one queue, every compute core pulls them,
+ *              a block of the second layer waits for the flag of its block of the first layer
+ *   pipeline:  cores 0 to 3 run the first layer, cores 4 to 7 the second one from a queue of their own
+ */
+#define DIM 16
+#define TASK_ROWS 2
+
+typedef struct {
+    double* a;
+    double* w;
+    size_t m;
+    size_t n;
+    size_t k;
+    int relu;
+    double* result;
+} dense_t;
+
+double *x, *w1, *w2, *hidden, *result, *result_ref;
+dense_t layer1, layer2;
+task_queue_t *queue_a, *queue_b;
+volatile size_t* flags;
+size_t epoch = 0;
+
+static int dense_tile(const void* ctx, size_t tile) {
+    const dense_t* d = ctx;
+    size_t first = tile * TASK_ROWS;
+    size_t rows = d->m - first < TASK_ROWS ? d->m - first : TASK_ROWS;
+    double* out = d->result + first * d->k;
+
+    int ret = gemm_ssr_frep(d->a + first * d->n, d->w, rows, d->n, d->k, out);
+    if (d->relu) {
+        ret |= relu_ssr_frep(out, rows * d->k, out);
+    }
+    return ret;
+}
+
+static int dense_baseline(size_t m) {
+    int ret = gemm_baseline(x, w1, m, DIM, DIM, hidden);
+    ret |= relu_baseline(hidden, m * DIM, hidden);
+    ret |= gemm_baseline(hidden, w2, m, DIM, DIM, result_ref);
+    return ret;
+}
+
+static int dense_ssr_frep_parallel(size_t m) {
+    int ret = gemm_ssr_frep_parallel(x, w1, m, DIM, DIM, hidden);
+    snrt_cluster_hw_barrier();
+    ret |= relu_ssr_frep_parallel(hidden, m * DIM, hidden);
+    snrt_cluster_hw_barrier();
+    ret |= gemm_ssr_frep_parallel(hidden, w2, m, DIM, DIM, result);
+    snrt_cluster_hw_barrier();
+    return ret;
+}
+
+/*
+ * The queues are emptied before the first barrier, the results are complete after the second one.
+ */
+static int dense_task_queue(size_t m) {
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t tiles = (m + TASK_ROWS - 1) / TASK_ROWS;
+    int ret = 0;
+
+    if (core_idx == 0) {
+        task_queue_reset(queue_a);
+        epoch++;
+    }
+    snrt_cluster_hw_barrier();
+
+    if (core_idx == 0) {
+        for (size_t t = 0; t < tiles; t++) {
+            task_t task = {dense_tile, &layer1, t, NULL, 0, 0, &flags[t], epoch};
+            ret |= task_submit(queue_a, &task);
+        }
+        for (size_t t = 0; t < tiles; t++) {
+            task_t task = {dense_tile, &layer2, t, &flags[t], 1, epoch, NULL, 0};
+            ret |= task_submit(queue_a, &task);
+        }
+        task_close(queue_a);
+    }
+    if (!snrt_is_dm_core()) {
+        ret |= task_worker(queue_a);
+    }
+    snrt_cluster_hw_barrier();
+    return ret;
+}
+
+static int dense_task_pipeline(size_t m) {
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t tiles = (m + TASK_ROWS - 1) / TASK_ROWS;
+    int ret = 0;
+
+    if (core_idx == 0) {
+        task_queue_reset(queue_a);
+        task_queue_reset(queue_b);
+        epoch++;
+    }
+    snrt_cluster_hw_barrier();
+
+    // The second layer can start on a block as soon as the first layer finished it
+    if (core_idx == 0) {
+        for (size_t t = 0; t < tiles; t++) {
+            task_t first = {dense_tile, &layer1, t, NULL, 0, 0, &flags[t], epoch};
+            task_t second = {dense_tile, &layer2, t, &flags[t], 1, epoch, NULL, 0};
+            ret |= task_submit(queue_a, &first);
+            ret |= task_submit(queue_b, &second);
+        }
+        task_close(queue_a);
+        task_close(queue_b);
+    }
+    if (!snrt_is_dm_core()) {
+        ret |= task_worker(core_idx < core_num / 2 ? queue_a : queue_b);
+    }
+    snrt_cluster_hw_barrier();
+    return ret;
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    if (core_idx == 0) {
+        queue_a = task_queue_create();
+        queue_b = task_queue_create();
+    }
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        size_t m = size / DIM > 0 ? size / DIM : 1;
+        size_t tiles = (m + TASK_ROWS - 1) / TASK_ROWS;
+        bench_shape(3, "M", m, "N", DIM, "K", DIM);
+
+        if (core_idx == 0) {
+            arena_reset(arena_global(), arena_start);
+            x = allocate(m * DIM, sizeof(double));
+            w1 = allocate(DIM * DIM, sizeof(double));
+            w2 = allocate(DIM * DIM, sizeof(double));
+            hidden = allocate(m * DIM, sizeof(double));
+            result = allocate(m * DIM, sizeof(double));
+            result_ref = allocate(m * DIM, sizeof(double));
+            flags = allocate(tiles, sizeof(size_t));
+            for (size_t t = 0; t < tiles; t++) {
+                flags[t] = 0;
+            }
+            epoch = 0;
+
+            for (size_t i = 0; i < m * DIM; i++) {
+                x[i] = (double)(i % 13) / 4.0 - 1.5;
+            }
+            for (size_t i = 0; i < DIM * DIM; i++) {
+                w1[i] = (double)(i % 7) / 8.0 - 0.375;
+                w2[i] = (double)(i % 5) / 4.0 - 0.5;
+            }
+            layer1 = (dense_t){x, w1, m, DIM, DIM, 1, hidden};
+            layer2 = (dense_t){hidden, w2, m, DIM, DIM, 0, result};
+
+            BENCH_VO(dense_baseline, m);
+        }
+        snrt_cluster_hw_barrier();
+
+        BENCH_VO_PARALLEL(dense_ssr_frep_parallel, m);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, m * DIM);
+            clear_vector(result, m * DIM);
+        }
+
+        BENCH_VO_PARALLEL(dense_task_queue, m);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, m * DIM);
+            clear_vector(result, m * DIM);
+        }
+
+        BENCH_VO_PARALLEL(dense_task_pipeline, m);
+        if (core_idx == 0) {
+            verify_vector_approx(result, result_ref, m * DIM);
+            clear_vector(result, m * DIM);
+        }
+        snrt_cluster_hw_barrier();
+    }
+
+    return 0;
+}
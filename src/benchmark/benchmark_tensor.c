@@ -0,0 +1,223 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "tensor.h"
+#include "relu.h"
+#include "add.h"
+#include "gemm.h"
+#include "transpose.h"
+
+/*
+ * Views against copies: relu of every other column (Slice with step 2), the transpose of x plus y and
+ * x times the transpose of a weight. The *_copy variants make the view contiguous first (copy or transpose
+ * into tmp) and run the plain kernel, the *_view variants pass the descriptor of the view.
+ * x is (size / COLS, COLS), the weight (COLS, COLS).
+ * Concat of x with itself along axis 1: copies by the core into the views of tensor_concat_views against the
+ * strided DMA of tensor_concat_dma. A producer which writes into the views directly needs neither.
+ */
+#define COLS 8
+
+double *x, *y, *w, *tmp, *result, *result_ref, *cat;
+tensor_t tx, ty, tw, tresult, slice, x_t, w_t, slice_result, gemm_result, tcat;
+tensor_t cat_views[2], cat_inputs[2];
+size_t last_rows;
+
+static int tensor_slice_relu_copy(size_t rows) {
+    tensor_t contiguous;
+    tensor_init(&contiguous, tmp, TENSOR_F64, 2, slice.shape);
+    tensor_unary_ssr_frep(TENSOR_IDENTITY, &slice, &contiguous);
+    return relu_ssr_frep(tmp, rows * (COLS / 2), result);
+}
+
+static int tensor_slice_relu_view(size_t rows) {
+    return tensor_unary_ssr_frep(TENSOR_RELU, &slice, &slice_result);
+}
+
+static int tensor_transpose_add_copy(size_t rows) {
+    transpose_ssr_frep(x, rows, COLS, tmp);
+    return add_ssr_frep(tmp, y, rows * COLS, result);
+}
+
+static int tensor_transpose_add_view(size_t rows) {
+    return tensor_binary_ssr_frep(BROADCAST_ADD, &x_t, &ty, &tresult);
+}
+
+static int tensor_gemm_transposed_copy(size_t rows) {
+    transpose_ssr_frep(w, COLS, COLS, tmp);
+    return gemm_ssr_frep(x, tmp, rows, COLS, COLS, result);
+}
+
+static int tensor_gemm_transposed_view(size_t rows) {
+    return tensor_gemm_ssr_frep(&tx, &w_t, &gemm_result);
+}
+
+static int tensor_concat_copy(size_t rows) {
+    tensor_unary_ssr_frep(TENSOR_IDENTITY, &cat_inputs[0], &cat_views[0]);
+    return tensor_unary_ssr_frep(TENSOR_IDENTITY, &cat_inputs[1], &cat_views[1]);
+}
+
+static int tensor_concat_dma_views(size_t rows) {
+    return tensor_concat_dma(cat_inputs, 2, 1, &tcat);
+}
+
+static int tensor_slice_relu_view_parallel(size_t rows) {
+    return tensor_unary_ssr_frep_parallel(TENSOR_RELU, &slice, &slice_result);
+}
+
+static int tensor_transpose_add_view_parallel(size_t rows) {
+    return tensor_binary_ssr_frep_parallel(BROADCAST_ADD, &x_t, &ty, &tresult);
+}
+
+static int tensor_gemm_transposed_view_parallel(size_t rows) {
+    return tensor_gemm_ssr_frep_parallel(&tx, &w_t, &gemm_result);
+}
+
+/*
+ * The descriptors of the buffers and views for rows rows.
+ */
+static void set_views(size_t rows) {
+    size_t x_shape[2] = {rows, COLS};
+    size_t y_shape[2] = {COLS, rows};
+    size_t w_shape[2] = {COLS, COLS};
+    size_t slice_shape[2] = {rows, COLS / 2};
+    size_t cat_shape[2] = {rows, 2 * COLS};
+    size_t cat_sizes[2] = {COLS, COLS};
+
+    tensor_init(&tx, x, TENSOR_F64, 2, x_shape);
+    tensor_init(&ty, y, TENSOR_F64, 2, y_shape);
+    tensor_init(&tw, w, TENSOR_F64, 2, w_shape);
+    tensor_init(&tresult, result, TENSOR_F64, 2, y_shape);
+    tensor_init(&slice_result, result, TENSOR_F64, 2, slice_shape);
+    tensor_init(&gemm_result, result, TENSOR_F64, 2, x_shape);
+    tensor_slice(&tx, 1, 0, COLS, 2, &slice);
+    tensor_transpose(&tx, NULL, &x_t);
+    tensor_transpose(&tw, NULL, &w_t);
+    tensor_init(&tcat, cat, TENSOR_F64, 2, cat_shape);
+    tensor_concat_views(&tcat, 1, 2, cat_sizes, cat_views);
+    cat_inputs[0] = tx;
+    cat_inputs[1] = tx;
+}
+
+/*
+ * Checks that both halves of every row of cat are the row of x and clears cat.
+ */
+static void verify_concat(size_t rows) {
+    for (size_t r = 0; r < rows; r++) {
+        verify_vector(cat + r * 2 * COLS, x + r * COLS, COLS);
+        verify_vector(cat + r * 2 * COLS + COLS, x + r * COLS, COLS);
+    }
+    clear_vector(cat, rows * 2 * COLS);
+}
+
+/*
+ * The references of the three cases with the C loops, in the order of the cases.
+ */
+static void reference(size_t c, double* out) {
+    tensor_t t;
+    if (c == 0) {
+        tensor_init(&t, out, TENSOR_F64, 2, slice.shape);
+        tensor_unary_baseline(TENSOR_RELU, &slice, &t);
+    } else if (c == 1) {
+        tensor_init(&t, out, TENSOR_F64, 2, ty.shape);
+        tensor_binary_baseline(BROADCAST_ADD, &x_t, &ty, &t);
+    } else {
+        tensor_init(&t, out, TENSOR_F64, 2, tx.shape);
+        tensor_gemm_baseline(&tx, &w_t, &t);
+    }
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+
+    size_t arena_start = arena_mark(arena_global());
+    for (size_t size = LMQ_START_SIZE; core_idx == 0 && size <= LMQ_SIZE; size *= 2) {
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
+        printf("Running benchmark_tensor\n");
+
+        size_t rows = size / COLS;
+        size_t n = rows * COLS;
+        x = allocate(n, sizeof(double));
+        y = allocate(n, sizeof(double));
+        w = allocate(COLS * COLS, sizeof(double));
+        tmp = allocate(n, sizeof(double));
+        result = allocate(n, sizeof(double));
+        result_ref = allocate(n, sizeof(double));
+        cat = allocate(2 * n, sizeof(double));
+        for (size_t i = 0; i < n; i++) {
+            x[i] = (double) ((int) (i % 11) - 5);
+            y[i] = 0.5 * (double) (i % 7);
+        }
+        for (size_t i = 0; i < COLS * COLS; i++) {
+            w[i] = 0.25 * (double) ((int) (i % 5) - 2);
+        }
+        set_views(rows);
+        last_rows = rows;
+
+        reference(0, result_ref);
+        BENCH_VO(tensor_slice_relu_copy, rows);
+        verify_vector(result, result_ref, n / 2);
+        clear_vector(result, n);
+        BENCH_VO(tensor_slice_relu_view, rows);
+        verify_vector(result, result_ref, n / 2);
+        clear_vector(result, n);
+
+        reference(1, result_ref);
+        BENCH_VO(tensor_transpose_add_copy, rows);
+        verify_vector(result, result_ref, n);
+        clear_vector(result, n);
+        BENCH_VO(tensor_transpose_add_view, rows);
+        verify_vector(result, result_ref, n);
+        clear_vector(result, n);
+
+        reference(2, result_ref);
+        BENCH_VO(tensor_gemm_transposed_copy, rows);
+        verify_vector_approx(result, result_ref, n);
+        clear_vector(result, n);
+        BENCH_VO(tensor_gemm_transposed_view, rows);
+        verify_vector_approx(result, result_ref, n);
+        clear_vector(result, n);
+
+        size_t tensor_size = size;
+        size = 2 * n;
+        BENCH_VO(tensor_concat_copy, rows);
+        verify_concat(rows);
+        size = tensor_size;
+    }
+
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel, on the buffers and views of the last size */
+    size_t rows = last_rows;
+    size = rows * COLS;
+
+    if (core_idx == 0) {
+        reference(0, result_ref);
+    }
+    BENCH_VO_PARALLEL(tensor_slice_relu_view_parallel, rows);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, size / 2);
+        clear_vector(result, size);
+        reference(1, result_ref);
+    }
+    BENCH_VO_PARALLEL(tensor_transpose_add_view_parallel, rows);
+    if (core_idx == 0) {
+        verify_vector(result, result_ref, size);
+        clear_vector(result, size);
+        reference(2, result_ref);
+    }
+    BENCH_VO_PARALLEL(tensor_gemm_transposed_view_parallel, rows);
+    if (core_idx == 0) {
+        verify_vector_approx(result, result_ref, size);
+    }
+
+    size = 2 * rows * COLS;
+    BENCH_VO_PARALLEL(tensor_concat_dma_views, rows);
+    if (core_idx == 0) {
+        verify_concat(rows);
+    }
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <snrt.h>
+#include "printf.h"
+
+#include "lmq.h"
+#include "benchmark.h"
+#include "topk.h"
+#include "argmax.h"
+#include "golden.h"
+
+/*
+ * TopK of a score vector for ks[] k (at most size), the k largest and the k smallest sorted elements.
+ * The scores are rounded to multiples of 1 / 16, so many of them are equal and the order of the indices of
+ * equal elements is checked too. The argmax of the vector is measured as the cost of k = 1 without a heap.
+ */
+static const size_t ks[] = {1, 8, 32};
+
+double *x, *values, *values_ref, *scratch_values;
+size_t *indices, *indices_ref, *scratch_indices;
+int argmax_result;
+
+static void verify_topk(const char* name, size_t k) {
+    verify_vector(values, values_ref, k);
+    for (size_t i = 0; i < k; i++) {
+        if (indices[i] != indices_ref[i]) {
+            printf("%s: index %d is %d, expected %d\n", name, i, indices[i], indices_ref[i]);
+            break;
+        }
+    }
+    clear_vector(values, k);
+    for (size_t i = 0; i < k; i++) {
+        indices[i] = 0;
+    }
+}
+
+int main() {
+    uint32_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t k_max = ks[sizeof(ks) / sizeof(ks[0]) - 1];
+
+    size_t arena_start = arena_mark(arena_global());
+    size_t l1_start = arena_mark(arena_l1());
+    for (size_t size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        if (core_idx == 0) {
+            printf("Running benchmark_topk\n");
+
+            arena_reset(arena_global(), arena_start);
+            arena_reset(arena_l1(), l1_start);
+            x = allocate(size, sizeof(double));
+            values = allocate(k_max, sizeof(double));
+            values_ref = allocate(k_max, sizeof(double));
+            indices = allocate(k_max, sizeof(size_t));
+            indices_ref = allocate(k_max, sizeof(size_t));
+
+            // The partial heaps of the cores in TCDM if they fit
+            scratch_values = arena_alloc(arena_l1(), k_max * core_num, sizeof(double), LMQ_ALIGN_DOUBLE);
+            scratch_indices = arena_alloc(arena_l1(), k_max * core_num, sizeof(size_t), LMQ_ALIGN_DOUBLE);
+            if (scratch_values == NULL || scratch_indices == NULL) {
+                scratch_values = allocate(k_max * core_num, sizeof(double));
+                scratch_indices = allocate(k_max * core_num, sizeof(size_t));
+            }
+
+            for (size_t i = 0; i < size; i++) {
+                x[i] = (double) (int) (golden_value(0, i, 64.0)) / 16.0;
+            }
+        }
+        snrt_cluster_hw_barrier();
+
+        bench_shape(1, "N", size);
+        BENCH_VO_PARALLEL(argmax_ssr_frep_parallel, x, size, &argmax_result);
+
+        for (size_t t = 0; t < sizeof(ks) / sizeof(ks[0]) && ks[t] <= size; t++) {
+            size_t k = ks[t];
+            bench_shape(2, "N", size, "K", k);
+
+            for (int largest = 1; largest >= 0; largest--) {
+                if (core_idx == 0) {
+                    printf("topk: k = %d, largest = %d\n", k, largest);
+                    BENCH_VO(topk_baseline, x, size, k, largest, 1, values_ref, indices_ref);
+
+                    BENCH_VO(topk_ssr, x, size, k, largest, 1, values, indices);
+                    verify_topk("topk_ssr", k);
+                }
+                snrt_cluster_hw_barrier();
+
+                BENCH_VO_PARALLEL(topk_ssr_parallel, x, size, k, largest, 1, values, indices,
+                                  scratch_values, scratch_indices);
+                if (core_idx == 0) {
+                    verify_topk("topk_ssr_parallel", k);
+                }
+                snrt_cluster_hw_barrier();
+            }
+        }
+    }
+
+    return 0;
+}
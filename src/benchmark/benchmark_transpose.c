@@ -3,22 +3,35 @@
 #include "stdlib.h"
 
 #include "lmq.h"
+#include "transpose.h"
 #include "benchmark.h"
 
+// x is input; result is output of the optimized functions
+double *x, *result_ref, *result;
+size_t rows, cols;
+
+// 4-D and 5-D tensors of the N-D transpose
+size_t shape[5];
+const size_t perm4[4] = {2, 0, 3, 1};
+const size_t perm5[5] = {4, 1, 3, 0, 2};
+
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
 
+    size_t arena_start = arena_mark(arena_global());
     for(size_t size=LMQ_START_SIZE; core_idx == 0 && size<=LMQ_SIZE;size*=2){
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
         printf("Running benchmark_transpose\n");
         
         size_t ox = (size_t)sqrt_approx(size);
-        size_t rows = ox;
-        size_t cols = ox;
+        rows = ox;
+        cols = ox + 3; // not square, so rows and columns can not be mixed up
 
-        // x is input; result is output of the optimized functions
-        double* x = allocate(rows * cols, sizeof(double));
-        double* result_ref = allocate(rows * cols, sizeof(double));
-        double* result = allocate(rows * cols, sizeof(double));
+        x = allocate(rows * cols, sizeof(double));
+        result_ref = allocate(rows * cols, sizeof(double));
+        result = allocate(rows * cols, sizeof(double));
 
         for (size_t i = 0; i < rows; i++) {
             for (size_t j = 0; j < cols; j++) {
@@ -43,11 +56,90 @@ int main() {
         // print_matrix(result, cols, rows);
         verify_vector(result, result_ref, cols * rows);
         clear_vector(result, rows * cols);
+
+        BENCH_VO(transpose_ssr_frep_blocked, x, rows, cols, result);
+        verify_vector(result, result_ref, cols * rows);
+        clear_vector(result, rows * cols);
+
+        // The 2-D transpose as a Transpose with the default perm
+        shape[0] = rows;
+        shape[1] = cols;
+        BENCH_VO(transpose_nd_ssr_frep, x, shape, 2, NULL, result);
+        verify_vector(result, result_ref, cols * rows);
+        clear_vector(result, rows * cols);
+
+        // (2, 3, 4, n / 24) with every dimension at a new position
+        shape[0] = 2;
+        shape[1] = 3;
+        shape[2] = 4;
+        shape[3] = rows * cols / 24;
+        BENCH_VO(transpose_nd_baseline, x, shape, 4, perm4, result_ref);
+        BENCH_VO(transpose_nd_ssr_frep, x, shape, 4, perm4, result);
+        verify_vector(result, result_ref, 24 * shape[3]);
+        clear_vector(result, rows * cols);
+
+        // (2, 2, 3, 2, n / 24) has more than 4 loops after merging
+        shape[0] = 2;
+        shape[1] = 2;
+        shape[2] = 3;
+        shape[3] = 2;
+        shape[4] = rows * cols / 24;
+        BENCH_VO(transpose_nd_baseline, x, shape, 5, perm5, result_ref);
+        BENCH_VO(transpose_nd_ssr_frep, x, shape, 5, perm5, result);
+        verify_vector(result, result_ref, 24 * shape[4]);
+        clear_vector(result, rows * cols);
     }
 
+    snrt_cluster_hw_barrier();
+    /* Benchmark parallel */
     for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
-        // TODO
+        size_t ox = (size_t)sqrt_approx(size);
+        size_t r = ox;
+        size_t s = ox + 3;
+
+        if (core_idx == 0) {
+            transpose_baseline(x, r, s, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(transpose_ssr_frep_parallel, x, r, s, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, r * s);
+            clear_vector(result, r * s);
+        }
+
+        BENCH_VO_PARALLEL(transpose_tiled, x, r, s, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, r * s);
+            clear_vector(result, r * s);
+            shape[0] = 2;
+            shape[1] = 3;
+            shape[2] = 4;
+            shape[3] = r * s / 24;
+            transpose_nd_baseline(x, shape, 4, perm4, result_ref);
+        }
+
+        BENCH_VO_PARALLEL(transpose_nd_ssr_frep_parallel, x, shape, 4, perm4, result);
+        if (core_idx == 0) {
+            verify_vector(result, result_ref, 24 * shape[3]);
+            clear_vector(result, r * s);
+        }
     }
+
+    /* Benchmark OMP parallel */
+    __snrt_omp_bootstrap(core_idx);
+    for(size_t size=LMQ_START_SIZE;size<=LMQ_SIZE;size*=2) {
+        size_t ox = (size_t)sqrt_approx(size);
+        size_t r = ox;
+        size_t s = ox + 3;
+        transpose_baseline(x, r, s, result_ref);
+
+        BENCH_VO_OMP(transpose_ssr_frep_omp, x, r, s, result);
+        verify_vector(result, result_ref, r * s);
+        clear_vector(result, r * s);
+    }
+
+    __snrt_omp_destroy(core_idx);
+
     return 0;
 }
 
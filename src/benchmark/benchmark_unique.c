@@ -4,12 +4,38 @@
 
 #include "benchmark.h"
 #include "lmq.h"
-
-__attribute__((noinline)) int unique_baseline(double* arr, const size_t n, double* result);
-__attribute__((noinline)) int unique_ssr(double* arr, const size_t n, double* result);
-__attribute__((noinline)) int unique_parallel(double* arr, const size_t n, double* result);
-
-double *x, *result, *result_ref;
+#include "unique.h"
+
+double *x, *x_few, *result, *result_ref;
+// outputs of unique_sorted_* and unique_hash_*
+double *values, *values_ref;
+size_t *indices, *indices_ref, *inverse, *inverse_ref, *counts, *counts_ref, *scratch;
+size_t num_unique, num_unique_ref;
+
+/*
+ * Compares the index outputs of unique_sorted_* against the first core's reference.
+ */
+static void verify_indices(const char* name, const size_t* out, const size_t* ref, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (out[i] != ref[i]) {
+            printf("%s: index %d differs: %d != %d\n", name, i, out[i], ref[i]);
+            return;
+        }
+    }
+}
+
+/*
+ * Compares all outputs of unique_sorted_* or unique_hash_* against the reference outputs.
+ */
+static void verify_unique(size_t size) {
+    if (num_unique != num_unique_ref) {
+        printf("%d unique values, expected %d\n", num_unique, num_unique_ref);
+    }
+    verify_vector(values, values_ref, num_unique_ref);
+    verify_indices("indices", indices, indices_ref, num_unique_ref);
+    verify_indices("inverse_indices", inverse, inverse_ref, size);
+    verify_indices("counts", counts, counts_ref, num_unique_ref);
+}
 
 int main() {
 
@@ -18,13 +44,21 @@ int main() {
 
     printf("Running benchmark_unique\n");
 
+    size_t arena_start = arena_mark(arena_global());
     for (size_t size = LMQ_START_SIZE; core_idx == 0 && size <= LMQ_SIZE; size *= 2) {
+        // Free the buffers of the previous size
+        arena_reset(arena_global(), arena_start);
+
 
         // Initialize the input data
         x = allocate(size, sizeof(double));
         for (size_t i = 0; i < size; i++) {
             x[i] = random() % (size / 2);  // add every element multiple times
         }
+        x_few = allocate(size, sizeof(double));
+        for (size_t i = 0; i < size; i++) {
+            x_few[i] = random() % (64 * size);  // few duplicates
+        }
 
         // Count number of unique elements (so we know the size of the result):
         /*size_t n_unique = 0;
@@ -59,6 +93,56 @@ int main() {
 
         verify_vector(result, result_ref, size);
         clear_vector(result, size);
+
+        values = allocate(size, sizeof(double));
+        values_ref = allocate(size, sizeof(double));
+        indices = allocate(size, sizeof(size_t));
+        indices_ref = allocate(size, sizeof(size_t));
+        inverse = allocate(size, sizeof(size_t));
+        inverse_ref = allocate(size, sizeof(size_t));
+        counts = allocate(size, sizeof(size_t));
+        counts_ref = allocate(size, sizeof(size_t));
+        scratch = allocate(UNIQUE_HASH_SCRATCH(size, core_num), sizeof(size_t));
+
+        BENCH_VO(unique_sorted_baseline, x, size, values_ref, indices_ref, inverse_ref, counts_ref,
+                 &num_unique_ref, scratch);
+
+        // unique_baseline keeps the last occurrence of every value
+        size_t n_unique = 0;
+        for (size_t i = 0; i < size; i++) {
+            n_unique += result_ref[i] != -1.0;
+        }
+        if (n_unique != num_unique_ref) {
+            printf("unique_sorted_baseline: %d unique values, expected %d\n", num_unique_ref, n_unique);
+        }
+        for (size_t i = 0; i < size; i++) {
+            if (values_ref[inverse_ref[i]] != x[i] || x[indices_ref[inverse_ref[i]]] != x[i]) {
+                printf("unique_sorted_baseline: wrong inverse index of %d\n", i);
+                break;
+            }
+        }
+
+        // The hash kernel keeps the order of the first occurrence, so its values are the sorted ones permuted
+        BENCH_VO(unique_hash_baseline, x, size, values, indices, inverse, counts, &num_unique, scratch);
+        if (num_unique != num_unique_ref) {
+            printf("unique_hash_baseline: %d unique values, expected %d\n", num_unique, num_unique_ref);
+        }
+        for (size_t k = 0; k < num_unique; k++) {
+            if (x[indices[k]] != values[k] || counts[k] != counts_ref[inverse_ref[indices[k]]]
+                    || (k > 0 && indices[k] <= indices[k - 1])) {
+                printf("unique_hash_baseline: wrong value %d\n", k);
+                break;
+            }
+        }
+
+        printf("Few duplicates\n");
+        BENCH_VO(unique_baseline, x_few, size, result_ref);
+        BENCH_VO(unique_sorted_baseline, x_few, size, values_ref, indices_ref, inverse_ref, counts_ref,
+                 &num_unique_ref, scratch);
+        BENCH_VO(unique_hash_baseline, x_few, size, values, indices, inverse, counts, &num_unique, scratch);
+        if (num_unique != num_unique_ref) {
+            printf("unique_hash_baseline: %d unique values, expected %d\n", num_unique, num_unique_ref);
+        }
         clear_vector(result_ref, size);
     }
 
@@ -75,6 +159,7 @@ int main() {
              * run the baseline by core 0:
              */
             unique_baseline(x, size, result_ref);
+            unique_sorted_baseline(x, size, values_ref, indices_ref, inverse_ref, counts_ref, &num_unique_ref, scratch);
 
         }
 
@@ -88,6 +173,32 @@ int main() {
             clear_vector(result, size);
 
         }
+
+        BENCH_VO_PARALLEL(unique_sorted_parallel, x, size, values, indices, inverse, counts, &num_unique, scratch);
+        if (core_idx == 0) {
+            verify_unique(size);
+            unique_hash_baseline(x, size, values_ref, indices_ref, inverse_ref, counts_ref, &num_unique_ref, scratch);
+        }
+
+        BENCH_VO_PARALLEL(unique_hash_parallel, x, size, values, indices, inverse, counts, &num_unique, scratch);
+        if (core_idx == 0) {
+            verify_unique(size);
+            printf("Few duplicates\n");
+            unique_sorted_baseline(x_few, size, values_ref, indices_ref, inverse_ref, counts_ref, &num_unique_ref, scratch);
+        }
+
+        BENCH_VO_PARALLEL(unique_parallel, x_few, size, result);
+
+        BENCH_VO_PARALLEL(unique_sorted_parallel, x_few, size, values, indices, inverse, counts, &num_unique, scratch);
+        if (core_idx == 0) {
+            verify_unique(size);
+            unique_hash_baseline(x_few, size, values_ref, indices_ref, inverse_ref, counts_ref, &num_unique_ref, scratch);
+        }
+
+        BENCH_VO_PARALLEL(unique_hash_parallel, x_few, size, values, indices, inverse, counts, &num_unique, scratch);
+        if (core_idx == 0) {
+            verify_unique(size);
+        }
     }
 
     return 0;
@@ -0,0 +1,88 @@
+#ifndef LMQ_SHAPES_H
+#define LMQ_SHAPES_H
+
+#include <stddef.h>
+
+/*
+ * Shapes of benchmark_shapes: instead of doubling the size it runs every entry of these tables.
+ * A generated header with the same three tables (f.ex. the layers of a model) replaces the defaults
+ * when it is given with -DLMQ_SHAPES_FILE=<path>.
+ */
+typedef struct {
+    const char* name;
+    size_t m;
+    size_t n;
+    size_t k;
+} gemm_shape_t;
+
+/*
+ * 1D convolution producing n outputs, the input size follows from filter, stride and dilation.
+ */
+typedef struct {
+    const char* name;
+    size_t n;
+    size_t filter;
+    size_t stride;
+    size_t dilation;
+} conv_shape_t;
+
+/*
+ * Shapes with more elements in all their buffers together are skipped (the default keeps the
+ * simulation time close to the one of the doubling benchmarks).
+ */
+#ifndef LMQ_SHAPES_MAX_ELEMENTS
+#define LMQ_SHAPES_MAX_ELEMENTS (4 * LMQ_SIZE)
+#endif
+
+#ifdef LMQ_SHAPES_FILE
+#include LMQ_SHAPES_FILE
+#else
+
+// a (m x n) times b (n x k)
+static const gemm_shape_t gemm_shapes[] = {
+    // layers: dense with batch 1 and 4, attention of 16 tokens with a head dimension of 8, 1x1 and 3x3 convolution
+    // of a 6x6 feature map as GEMM (im2col)
+    {"dense_b1", 1, 128, 16},
+    {"dense_b4", 4, 64, 32},
+    {"attention_qk", 16, 8, 16},
+    {"attention_v", 16, 16, 8},
+    {"pointwise_conv", 36, 16, 24},
+    {"im2col_3x3", 36, 72, 16},
+    // odd and prime dimensions, remainders of GEMM_BLOCK, GEMM_TILE_M/K and of the split over the cores
+    {"unit", 1, 1, 1},
+    {"prime_7_13_5", 7, 13, 5},
+    {"prime_17_31_3", 17, 31, 3},
+    {"odd_9", 9, 9, 9},
+    {"block_plus_one", 9, 16, 5},
+    {"column", 3, 127, 1},
+    // aspect ratios of the result at m * k = 256, then of the inner dimension
+    {"skinny_2x128", 2, 16, 128},
+    {"skinny_8x32", 8, 16, 32},
+    {"fat_32x8", 32, 16, 8},
+    {"fat_128x2", 128, 16, 2},
+    {"inner_4", 8, 4, 8},
+    {"inner_64", 8, 64, 8},
+    {"inner_128", 8, 128, 8},
+};
+
+static const conv_shape_t conv_shapes[] = {
+    // layers: keyword spotting (strided 10 wide filter), a long 3 wide filter
+    {"kws", 98, 10, 2, 1},
+    {"long_3", 1021, 3, 1, 1},
+    // odd, prime, strided and dilated
+    {"unit", 1, 1, 1, 1},
+    {"odd", 13, 3, 1, 1},
+    {"prime_strided", 61, 7, 2, 1},
+    {"dilated", 127, 5, 1, 3},
+    {"strided_dilated", 31, 11, 3, 2},
+    // the filter is longer than the output
+    {"wide_filter", 8, 64, 1, 1},
+};
+
+// Lengths of the elementwise kernels, reductions and scans: fewer elements than cores, just around
+// a multiple of the cores and primes
+static const size_t vector_lengths[] = {1, 2, 3, 7, 8, 9, 13, 31, 61, 127, 257, 509, 1021, 1023, 1025};
+
+#endif
+
+#endif
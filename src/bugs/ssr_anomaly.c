@@ -10,6 +10,9 @@
  * 
  * We write up to index 2 (so 3 write instructions) the value '0.0'.
  * We expect that the value at index 3 is untouched but it's '-inf'.
+ *
+ * The float32 kernels (*_f32) avoid this by streaming packed pairs as 64 bit words
+ * and writing an odd last element from the core.
  */
 int main() {
     uint32_t core_idx = snrt_global_core_idx();
@@ -84,6 +84,80 @@ int copy_ssr_frep(double* source, const size_t n, double* target) {
     return 0;
 }
 
+/*
+ * Issues the copy of rows rows of row_len elements in transfers of at most COPY_DMA_CHUNK bytes each
+ * (at least one row). Returns the id of the last transfer.
+ */
+static snrt_dma_txid_t copy_dma_rows(double* source, size_t row_len, size_t rows, size_t source_stride,
+                                     size_t target_stride, double* target) {
+    snrt_dma_txid_t id = 0;
+    size_t row_bytes = row_len * sizeof(double);
+
+    // Contiguous rows are one 1D copy, cut into chunks
+    if (rows == 1 || (source_stride == row_len && target_stride == row_len)) {
+        size_t bytes = rows * row_bytes;
+        for (size_t offset = 0; offset < bytes; offset += COPY_DMA_CHUNK) {
+            size_t len = bytes - offset < COPY_DMA_CHUNK ? bytes - offset : COPY_DMA_CHUNK;
+            id = snrt_dma_start_1d((char*) target + offset, (char*) source + offset, len);
+        }
+        return id;
+    }
+
+    size_t chunk_rows = row_bytes < COPY_DMA_CHUNK ? COPY_DMA_CHUNK / row_bytes : 1;
+    for (size_t r = 0; r < rows; r += chunk_rows) {
+        size_t count = rows - r < chunk_rows ? rows - r : chunk_rows;
+        id = snrt_dma_start_2d(target + r * target_stride, source + r * source_stride, row_bytes,
+                               target_stride * sizeof(double), source_stride * sizeof(double), count);
+    }
+    return id;
+}
+
+snrt_dma_txid_t copy_dma_start_3d(double* source, const size_t row_len, const size_t rows, const size_t planes,
+                                  const size_t source_stride, const size_t target_stride,
+                                  const size_t source_plane_stride, const size_t target_plane_stride, double* target) {
+    snrt_dma_txid_t id = 0;
+
+    if (row_len == 0 || rows == 0) {
+        return id;
+    }
+
+    // Planes which follow each other in both buffers are one block of rows
+    if (planes > 1 && source_plane_stride == rows * source_stride && target_plane_stride == rows * target_stride) {
+        return copy_dma_rows(source, row_len, rows * planes, source_stride, target_stride, target);
+    }
+
+    for (size_t p = 0; p < planes; p++) {
+        id = copy_dma_rows(source + p * source_plane_stride, row_len, rows, source_stride, target_stride,
+                           target + p * target_plane_stride);
+    }
+    return id;
+}
+
+__attribute__((noinline))
+int copy_dma_3d(double* source, const size_t row_len, const size_t rows, const size_t planes,
+                const size_t source_stride, const size_t target_stride,
+                const size_t source_plane_stride, const size_t target_plane_stride, double* target) {
+    if (snrt_is_dm_core()) {
+        copy_dma_start_3d(source, row_len, rows, planes, source_stride, target_stride,
+                          source_plane_stride, target_plane_stride, target);
+        snrt_dma_wait_all();
+    }
+    snrt_cluster_hw_barrier();
+
+    return 0;
+}
+
+__attribute__((noinline))
+int copy_dma_2d(double* source, const size_t row_len, const size_t rows, const size_t source_stride,
+                const size_t target_stride, double* target) {
+    return copy_dma_3d(source, row_len, rows, 1, source_stride, target_stride, 0, 0, target);
+}
+
+__attribute__((noinline))
+int copy_dma(double* source, const size_t n, double* target) {
+    return copy_dma_3d(source, n, 1, 1, n, n, 0, 0, target);
+}
+
 __attribute__((noinline))
 int copy_parallel(double* source, const size_t n, double* target) {
     size_t core_num = snrt_cluster_core_num() - 1;
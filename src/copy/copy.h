@@ -17,6 +17,38 @@ int copy_parallel(double* source, const size_t n, double* target);
 int copy_ssr_parallel(double* source, const size_t n, double* target);
 int copy_ssr_frep_parallel(double* source, const size_t n, double* target);
 
+/*
+ * Copy engine on the DM core. The copies must be called by all cores of the cluster, only the DM core moves
+ * data and all cores return once the copy is complete (cluster barrier), so target can be read right away.
+ * Transfers are cut into chunks of at most COPY_DMA_CHUNK bytes (whole rows for the strided copies) which are all
+ * in flight before the DM core waits, so the DMA engine is never idle while the next transfer is issued.
+ */
+#ifndef COPY_DMA_CHUNK
+#define COPY_DMA_CHUNK 8192
+#endif
+
+int copy_dma(double* source, const size_t n, double* target);
+
+/*
+ * Strided sub-tensor copies (f.ex. for Slice, Concat and Pad), strides are in elements.
+ * copy_dma_2d copies rows rows of row_len contiguous elements, row i starts at source + i * source_stride and at
+ * target + i * target_stride. copy_dma_3d copies planes such blocks, plane p starts at source + p * source_plane_stride
+ * and target + p * target_plane_stride. Contiguous rows are merged into a single transfer.
+ */
+int copy_dma_2d(double* source, const size_t row_len, const size_t rows, const size_t source_stride,
+                const size_t target_stride, double* target);
+int copy_dma_3d(double* source, const size_t row_len, const size_t rows, const size_t planes,
+                const size_t source_stride, const size_t target_stride,
+                const size_t source_plane_stride, const size_t target_plane_stride, double* target);
+
+/*
+ * Asynchronous version of copy_dma_3d for the DM core only: issues the transfers and returns the id of the last one.
+ * The copy is complete after snrt_dma_wait(id) (or snrt_dma_wait_all()), f.ex. to overlap it with other transfers.
+ */
+snrt_dma_txid_t copy_dma_start_3d(double* source, const size_t row_len, const size_t rows, const size_t planes,
+                                  const size_t source_stride, const size_t target_stride,
+                                  const size_t source_plane_stride, const size_t target_plane_stride, double* target);
+
 int copy_omp(double* source, const size_t n, double* target);
 int copy_ssr_omp(double* source, const size_t n, double* target);
 int copy_ssr_frep_omp(double* source, const size_t n, double* target);
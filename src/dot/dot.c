@@ -1,10 +1,15 @@
-
 #include <dot.h>
+#include "lmq.h"
 #include <snrt.h>
 
 #include <float.h>
 #include <math.h>
 
+#ifndef LMQ_HOST
+#include "reduce.h"
+#include "tile.h"
+#endif
+
 /*
  * Naive implementation of dot product.
  * Calculates the dotproduct of a and b (each containing n elements).
@@ -26,6 +31,8 @@ int dot_baseline(const double* a,
     return 0;
 }
 
+#ifndef LMQ_HOST
+
 __attribute__((noinline))
 int dot_ssr(const double* a,
             const double* b,
@@ -102,6 +109,152 @@ int dot_ssr_frep(const double* a,
     return 0;
 }
 
+/*
+ * dot_ssr_frep with REDUCE_ACCUMULATORS staggered accumulators.
+ */
+__attribute__((noinline))
+int dot_ssr_frep_staggered(const double* a,
+                           const double* b,
+                           const size_t n,
+                           double* result) {
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*b));
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, b);
+
+    snrt_ssr_enable();
+
+    double out = reduce_dot_ssr_frep(n);
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+
+    *result = out;
+
+    return 0;
+}
+
+/*
+ * Every core computes the dot product of a contiguous range, the partial results are combined by reduce_cluster.
+ */
+__attribute__((noinline))
+int dot_parallel(const double* a,
+                 const double* b,
+                 const size_t n,
+                 double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    double priv = 0.0;
+    if (!snrt_is_dm_core()) {
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+        for (size_t i = first; i < first + local_n; i++) {
+            priv += a[i] * b[i];
+        }
+    }
+
+    double out = reduce_cluster(REDUCE_SUM, priv, 0, NULL);
+    if (core_idx == 0) {
+        *result = out;
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int dot_ssr_frep_parallel(const double* a,
+                          const double* b,
+                          const size_t n,
+                          double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    double priv = 0.0;
+    if (!snrt_is_dm_core()) {
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+        dot_ssr_frep_staggered(a + first, b + first, local_n, &priv);
+    }
+
+    double out = reduce_cluster(REDUCE_SUM, priv, 0, NULL);
+    if (core_idx == 0) {
+        *result = out;
+    }
+
+    return 0;
+}
+
+/*
+ * The DM core fetches the next tiles of a and b into L1 while the compute cores reduce the current ones.
+ */
+__attribute__((noinline))
+int dot_ssr_frep_tiled(const double* a,
+                       const double* b,
+                       const size_t n,
+                       double* result) {
+    return tile_reduce_binary(dot_ssr_frep_staggered, REDUCE_SUM, a, b, n, result);
+}
+
+/*
+ * The DM core does not take part in the OMP team, so reduce_cluster cannot be used.
+ * The partial results are combined by reduce_team inside the parallel region instead.
+ */
+__attribute__((noinline))
+int dot_omp(const double* a,
+            const double* b,
+            const size_t n,
+            double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        size_t core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+        double priv = 0.0;
+        for (size_t i = first; i < first + local_n; i++) {
+            priv += a[i] * b[i];
+        }
+
+        double out = reduce_team(REDUCE_SUM, priv, 0, NULL);
+        if (core_idx == 0) {
+            *result = out;
+        }
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int dot_ssr_frep_omp(const double* a,
+                     const double* b,
+                     const size_t n,
+                     double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        size_t core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+        double priv = 0.0;
+        if (local_n > 0) {
+            dot_ssr_frep_staggered(a + first, b + first, local_n, &priv);
+        }
+
+        double out = reduce_team(REDUCE_SUM, priv, 0, NULL);
+        if (core_idx == 0) {
+            *result = out;
+        }
+    }
+
+    return 0;
+}
+
 __attribute__((noinline))
 int ssr_dvec_dvec_dotpf(const double* const vals_a,
                         const double* const vals_b,
@@ -203,3 +356,60 @@ int ssr_dvec_dvec_dotp(const double* const vals_a,
 
     return 0;
 }
+
+__attribute__((noinline))
+int dot_baseline_f32(const float* a,
+                     const float* b,
+                     const size_t n,
+                     float* result) {
+    float sum = 0.0f;
+
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+
+    *result = sum;
+
+    return 0;
+}
+
+/*
+ * float32 dot product with a packed multiply accumulate (vfmac.s).
+ * Both lanes of the accumulator are summed up at the end.
+ */
+__attribute__((noinline))
+int dot_ssr_frep_f32(const float* a,
+                     const float* b,
+                     const size_t n,
+                     float* result) {
+    size_t pairs = n / 2;
+    f32x2_t acc = { .d = 0.0 };
+
+    if (pairs > 0) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, pairs, sizeof(f32x2_t));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, pairs, sizeof(f32x2_t));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, b);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n], 1, 0, 0\n"
+            "vfmac.s %[acc], ft1, ft0\n"
+            : [acc] "+f"(acc.d)
+            : [n] "r"(pairs - 1)
+            : "ft0", "ft1");
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+
+    *result = acc.f[0] + acc.f[1] + (n % 2 ? a[n - 1] * b[n - 1] : 0.0f);
+
+    return 0;
+}
+
+#endif // LMQ_HOST
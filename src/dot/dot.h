@@ -25,6 +25,59 @@ int dot_ssr_frep(const double* a,
                  const size_t n,
                  double* result);
 
+/*
+ * Accumulates into REDUCE_ACCUMULATORS staggered accumulators (see reduce.h).
+ */
+int dot_ssr_frep_staggered(const double* a,
+                           const double* b,
+                           const size_t n,
+                           double* result);
+
+/*
+ * Parallel dot products, the parallel versions must be called by all cores of the cluster.
+ * The OMP versions combine the partials with reduce_team. The result is written by core 0.
+ */
+int dot_parallel(const double* a,
+                 const double* b,
+                 const size_t n,
+                 double* result);
+
+int dot_ssr_frep_parallel(const double* a,
+                          const double* b,
+                          const size_t n,
+                          double* result);
+
+/*
+ * Streams a and b through L1 in double buffered tiles (src/lmq/tile.h), must be called by all cores of the cluster.
+ */
+int dot_ssr_frep_tiled(const double* a,
+                       const double* b,
+                       const size_t n,
+                       double* result);
+
+int dot_omp(const double* a,
+            const double* b,
+            const size_t n,
+            double* result);
+
+int dot_ssr_frep_omp(const double* a,
+                     const double* b,
+                     const size_t n,
+                     double* result);
+
+/*
+ * float32 versions, ssr_frep works on packed pairs.
+ */
+int dot_baseline_f32(const float* a,
+                     const float* b,
+                     const size_t n,
+                     float* result);
+
+int dot_ssr_frep_f32(const float* a,
+                     const float* b,
+                     const size_t n,
+                     float* result);
+
 int ssr_dvec_dvec_dotp(const double* const vals_a,
                        const double* const vals_b,
                        const size_t len,
@@ -0,0 +1,57 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "dispatch.h"
+#include "add.h"
+#include "relu.h"
+#include "sigmoid.h"
+#include "dot.h"
+#include "gemm.h"
+
+// Returns the call of the variant of op for size, see dispatch.h
+#define DISPATCH(op, size, parallel, ssr_frep, ssr, baseline)  \
+    do {                                                        \
+        if ((size) >= DISPATCH_##op##_PARALLEL) {               \
+            return parallel;                                    \
+        }                                                       \
+        if (snrt_cluster_core_idx() != 0) {                     \
+            return 0;                                           \
+        }                                                       \
+        if ((size) >= DISPATCH_##op##_SSR_FREP) {               \
+            return ssr_frep;                                    \
+        }                                                       \
+        if ((size) >= DISPATCH_##op##_SSR) {                    \
+            return ssr;                                         \
+        }                                                       \
+        return baseline;                                        \
+    } while (0)
+
+__attribute__((noinline))
+int add_dispatch(double* a, double* b, const size_t n, double* result) {
+    DISPATCH(ADD, n, add_ssr_frep_parallel(a, b, n, result), add_ssr_frep(a, b, n, result),
+             add_ssr(a, b, n, result), add_baseline(a, b, n, result));
+}
+
+__attribute__((noinline))
+int relu_dispatch(double* arr, const size_t n, double* result) {
+    DISPATCH(RELU, n, relu_ssr_frep_parallel(arr, n, result), relu_ssr_frep(arr, n, result),
+             relu_ssr(arr, n, result), relu_baseline(arr, n, result));
+}
+
+__attribute__((noinline))
+int sigmoid_dispatch(double* arr, const size_t n, double* result) {
+    DISPATCH(SIGMOID, n, sigmoid_ssr_frep_parallel(arr, n, result), sigmoid_ssr_frep(arr, n, result),
+             sigmoid_ssr(arr, n, result), sigmoid_baseline(arr, n, result));
+}
+
+__attribute__((noinline))
+int dot_dispatch(const double* a, const double* b, const size_t n, double* result) {
+    DISPATCH(DOT, n, dot_ssr_frep_parallel(a, b, n, result), dot_ssr_frep(a, b, n, result),
+             dot_ssr(a, b, n, result), dot_baseline(a, b, n, result));
+}
+
+__attribute__((noinline))
+int gemm_dispatch(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    DISPATCH(GEMM, m * n * k, gemm_ssr_frep_parallel(a, b, m, n, k, result), gemm_ssr_frep(a, b, m, n, k, result),
+             gemm_ssr(a, b, m, n, k, result), gemm_baseline(a, b, m, n, k, result));
+}
@@ -0,0 +1,22 @@
+#ifndef LMQ_DISPATCH_H
+#define LMQ_DISPATCH_H
+
+#include <snrt.h>
+
+#include "dispatch_table.h"
+
+/*
+ * Size aware dispatch: the variant of an op is picked from the thresholds in dispatch_table.h,
+ * baseline below DISPATCH_<OP>_SSR, then ssr, ssr_frep and ssr_frep_parallel from DISPATCH_<OP>_PARALLEL on.
+ * The size is n for the elementwise ops and dot and the number of multiply-adds m * n * k for gemm.
+ * Must be called by all cores of the cluster, like the parallel kernels. Below the parallel threshold core 0
+ * runs the single core variant and the other cores return at once, the caller synchronises as after a
+ * parallel kernel. The result of dot is written by core 0.
+ */
+int add_dispatch(double* a, double* b, const size_t n, double* result);
+int relu_dispatch(double* arr, const size_t n, double* result);
+int sigmoid_dispatch(double* arr, const size_t n, double* result);
+int dot_dispatch(const double* a, const double* b, const size_t n, double* result);
+int gemm_dispatch(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+
+#endif
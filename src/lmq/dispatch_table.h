@@ -0,0 +1,60 @@
+#ifndef LMQ_DISPATCH_TABLE_H
+#define LMQ_DISPATCH_TABLE_H
+
+/*
+ * Thresholds of the *_dispatch kernels (src/lmq/dispatch.h): the size from which a variant is used.
+ * Written by plots/tune_dispatch.py from the crossover points benchmark_dispatch measures; these defaults
+ * are estimates for banshee with 8 compute cores. Every value may be overridden with -D.
+ */
+
+#ifndef DISPATCH_ADD_SSR
+#define DISPATCH_ADD_SSR 8
+#endif
+#ifndef DISPATCH_ADD_SSR_FREP
+#define DISPATCH_ADD_SSR_FREP 16
+#endif
+#ifndef DISPATCH_ADD_PARALLEL
+#define DISPATCH_ADD_PARALLEL 256
+#endif
+
+#ifndef DISPATCH_RELU_SSR
+#define DISPATCH_RELU_SSR 8
+#endif
+#ifndef DISPATCH_RELU_SSR_FREP
+#define DISPATCH_RELU_SSR_FREP 16
+#endif
+#ifndef DISPATCH_RELU_PARALLEL
+#define DISPATCH_RELU_PARALLEL 256
+#endif
+
+#ifndef DISPATCH_SIGMOID_SSR
+#define DISPATCH_SIGMOID_SSR 4
+#endif
+#ifndef DISPATCH_SIGMOID_SSR_FREP
+#define DISPATCH_SIGMOID_SSR_FREP 8
+#endif
+#ifndef DISPATCH_SIGMOID_PARALLEL
+#define DISPATCH_SIGMOID_PARALLEL 32
+#endif
+
+#ifndef DISPATCH_DOT_SSR
+#define DISPATCH_DOT_SSR 8
+#endif
+#ifndef DISPATCH_DOT_SSR_FREP
+#define DISPATCH_DOT_SSR_FREP 16
+#endif
+#ifndef DISPATCH_DOT_PARALLEL
+#define DISPATCH_DOT_PARALLEL 512
+#endif
+
+#ifndef DISPATCH_GEMM_SSR
+#define DISPATCH_GEMM_SSR 64
+#endif
+#ifndef DISPATCH_GEMM_SSR_FREP
+#define DISPATCH_GEMM_SSR_FREP 64
+#endif
+#ifndef DISPATCH_GEMM_PARALLEL
+#define DISPATCH_GEMM_PARALLEL 512
+#endif
+
+#endif
@@ -0,0 +1,471 @@
+#include "fpmath.h"
+
+#include <snrt.h>
+
+// Carry scratch of all cores of every cluster in its L1, FPMATH_CARRY * FPMATH_BLOCK doubles per core
+static double* fpmath_scratch[FPMATH_MAX_CLUSTERS];
+
+double* fpmath_carry() {
+    size_t cluster = snrt_cluster_idx();
+
+    // Any core of the cluster may be the first one to call, so allocate only once
+    if (fpmath_scratch[cluster] == NULL) {
+        snrt_mutex_lock(snrt_mutex());
+        if (fpmath_scratch[cluster] == NULL) {
+            fpmath_scratch[cluster] =
+                snrt_l1alloc(snrt_cluster_core_num() * FPMATH_CARRY * FPMATH_BLOCK * sizeof(double));
+        }
+        snrt_mutex_release(snrt_mutex());
+    }
+    return fpmath_scratch[cluster] + snrt_cluster_core_idx() * FPMATH_CARRY * FPMATH_BLOCK;
+}
+
+void fpmath_pass_begin(const double* x, double* carry, size_t num_in, size_t num_out, double* result, size_t count) {
+    if (x != NULL) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*x));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) x);
+    }
+
+    // num_in consecutive values of every element, starting at the slot carry points to
+    if (num_in > 0) {
+        snrt_ssr_loop_2d(SNRT_SSR_DM1, num_in, count, sizeof(*carry), sizeof(*carry) * FPMATH_CARRY);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, carry);
+    }
+
+    if (result != NULL) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM2, count, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
+    } else {
+        snrt_ssr_loop_2d(SNRT_SSR_DM2, num_out, count, sizeof(*carry), sizeof(*carry) * FPMATH_CARRY);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, carry);
+    }
+
+    snrt_ssr_enable();
+}
+
+void fpmath_pass_end() {
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+/*
+ * Pade [4/4] of exp(v) = (E + O) / (E - O) with E = 1 + e2 x^2 + e4 x^4 and O = o1 x + o3 x^3 for v = x / 4096.
+ */
+#define EXP_SCALE 4096.0
+#define EXP_E2 (3.0 / (28.0 * EXP_SCALE * EXP_SCALE))
+#define EXP_E4 (1.0 / (1680.0 * EXP_SCALE * EXP_SCALE * EXP_SCALE * EXP_SCALE))
+#define EXP_O1 (1.0 / (2.0 * EXP_SCALE))
+#define EXP_O3 (1.0 / (84.0 * EXP_SCALE * EXP_SCALE * EXP_SCALE))
+
+void fpmath_exp(const double* x, int negate, double* carry, size_t count, double* result, int frep) {
+    double sign = negate ? -1.0 : 1.0;
+
+    // The first six of the twelve squarings
+    fpmath_pass_begin(x, carry, 0, 1, NULL, count);
+    FPMATH_PASS(frep, count, 16,
+        "fmax.d ft3, ft0, %[lo] \n"
+        "fmin.d ft3, ft3, %[hi] \n"
+        "fmul.d ft4, ft3, ft3 \n"
+        "fmadd.d ft5, ft4, %[e4], %[e2] \n"
+        "fmadd.d ft5, ft5, ft4, %[one] \n"
+        "fmadd.d ft6, ft4, %[o3], %[o1] \n"
+        "fmul.d ft6, ft6, ft3 \n"
+        "fadd.d ft7, ft5, ft6 \n"
+        "fsub.d ft5, ft5, ft6 \n"
+        "fdiv.d ft3, ft7, ft5 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft2, ft3, ft3 \n",
+        [lo] "f"(-708.0), [hi] "f"(708.0), [one] "f"(1.0), [e2] "f"(EXP_E2), [e4] "f"(EXP_E4),
+        [o1] "f"(sign * EXP_O1), [o3] "f"(sign * EXP_O3));
+    fpmath_pass_end();
+
+    fpmath_pass_begin(NULL, carry, 1, 1, result, count);
+    FPMATH_PASS(frep, count, 7,
+        "fmv.d ft3, ft1 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft3, ft3, ft3 \n"
+        "fmul.d ft2, ft3, ft3 \n",
+        [one] "f"(1.0));
+    fpmath_pass_end();
+}
+
+/*
+ * The accurate exponentials start from the Pade approximant at v = x / 8192 in the form
+ * expm1(v) = 2 O / (E - O) and undo the scaling with expm1(2 v) = d * (d + 2) for d = expm1(v).
+ * Unlike squaring exp(v), this step does not round 1 + d, so small and negative arguments keep their precision.
+ */
+#define EXPM1_SCALE 8192.0
+#define EXPM1_E2 (3.0 / (28.0 * EXPM1_SCALE * EXPM1_SCALE))
+#define EXPM1_E4 (1.0 / (1680.0 * EXPM1_SCALE * EXPM1_SCALE * EXPM1_SCALE * EXPM1_SCALE))
+#define EXPM1_O1 (1.0 / (2.0 * EXPM1_SCALE))
+#define EXPM1_O3 (1.0 / (84.0 * EXPM1_SCALE * EXPM1_SCALE * EXPM1_SCALE))
+
+// One of the 13 doubling steps on d in ft3
+#define EXPM1_STEP                  \
+    "fadd.d ft4, ft3, %[two] \n"    \
+    "fmul.d ft3, ft3, ft4 \n"
+
+void fpmath_expm1(double* carry, size_t count, int frep) {
+    // The approximant and three doubling steps
+    fpmath_pass_begin(NULL, carry, 1, 1, NULL, count);
+    FPMATH_PASS(frep, count, 16,
+        "fmax.d ft3, ft1, %[lo] \n"
+        "fmin.d ft3, ft3, %[hi] \n"
+        "fmul.d ft4, ft3, ft3 \n"
+        "fmadd.d ft5, ft4, %[e4], %[e2] \n"
+        "fmadd.d ft5, ft5, ft4, %[one] \n"
+        "fmadd.d ft6, ft4, %[o3], %[o1] \n"
+        "fmul.d ft6, ft6, ft3 \n"
+        "fsub.d ft5, ft5, ft6 \n"
+        "fadd.d ft6, ft6, ft6 \n"
+        "fdiv.d ft3, ft6, ft5 \n"
+        EXPM1_STEP
+        EXPM1_STEP
+        "fadd.d ft4, ft3, %[two] \n"
+        "fmul.d ft2, ft3, ft4 \n",
+        [lo] "f"(-708.0), [hi] "f"(708.0), [one] "f"(1.0), [two] "f"(2.0), [e2] "f"(EXPM1_E2), [e4] "f"(EXPM1_E4),
+        [o1] "f"(EXPM1_O1), [o3] "f"(EXPM1_O3));
+    fpmath_pass_end();
+
+    fpmath_pass_begin(NULL, carry, 1, 1, NULL, count);
+    FPMATH_PASS(frep, count, 15,
+        "fmv.d ft3, ft1 \n"
+        EXPM1_STEP
+        EXPM1_STEP
+        EXPM1_STEP
+        EXPM1_STEP
+        EXPM1_STEP
+        EXPM1_STEP
+        "fadd.d ft4, ft3, %[two] \n"
+        "fmul.d ft2, ft3, ft4 \n",
+        [two] "f"(2.0));
+    fpmath_pass_end();
+
+    fpmath_pass_begin(NULL, carry, 1, 1, NULL, count);
+    FPMATH_PASS(frep, count, 7,
+        "fmv.d ft3, ft1 \n"
+        EXPM1_STEP
+        EXPM1_STEP
+        "fadd.d ft4, ft3, %[two] \n"
+        "fmul.d ft2, ft3, ft4 \n",
+        [two] "f"(2.0));
+    fpmath_pass_end();
+}
+
+/*
+ * erfc(y) = exp(-y^2) * t * R(t) with t = 1 / (1 + p y) for y in [0, ERF_Y_MAX], erf(y) = y * Q(y^2) below ERF_T.
+ */
+#define ERF_Y_MAX 6.0
+#define ERF_P 0.3
+#define ERF_T 0.5
+
+// exp(y^2) erfc(y) / t in t, Chebyshev fit
+static const double erfc_poly[] = {
+    0.16925577030054026, 0.16927703110194742, 0.16150534932493413, 0.14657739990291824,
+    0.12806550660526575, 0.06893884197579042, 0.1975977542328025, -0.3233191904968084,
+    0.7715129054783728, -1.1030634417350023, 1.1748912892093757, -0.8732499208235565,
+    0.4057218199937606, -0.10553327246224693, 0.011822157391921948
+};
+
+// erf(y) / y in y^2 on [0, ERF_T^2], Chebyshev fit
+static const double erf_poly[] = {
+    1.1283791670955112, -0.3761263890314073, 0.11283791667923505, -0.026866169736996053,
+    0.005223963531889194, -0.0008547107316373995, 0.00011996023532314729, -1.3404453109605658e-05
+};
+
+void fpmath_erf(const double* x, double scale, double* carry, size_t count, double* result, int frep) {
+    // (t, y^2, erf(y_small)) with y = min(|scale x|, ERF_Y_MAX) and y_small = min(|scale x|, ERF_T)
+    fpmath_pass_begin(x, carry, 0, 3, NULL, count);
+    FPMATH_PASS(frep, count, 16,
+        "fmul.d ft3, ft0, %[scale] \n"
+        "fsgnj.d ft3, ft3, %[one] \n"
+        "fmin.d ft4, ft3, %[y_max] \n"
+        "fmadd.d ft5, ft4, %[p], %[one] \n"
+        "fdiv.d ft2, %[one], ft5 \n"
+        "fmul.d ft2, ft4, ft4 \n"
+        "fmin.d ft3, ft3, %[t] \n"
+        "fmul.d ft4, ft3, ft3 \n"
+        "fmadd.d ft5, ft4, %[q7], %[q6] \n"
+        "fmadd.d ft5, ft5, ft4, %[q5] \n"
+        "fmadd.d ft5, ft5, ft4, %[q4] \n"
+        "fmadd.d ft5, ft5, ft4, %[q3] \n"
+        "fmadd.d ft5, ft5, ft4, %[q2] \n"
+        "fmadd.d ft5, ft5, ft4, %[q1] \n"
+        "fmadd.d ft5, ft5, ft4, %[q0] \n"
+        "fmul.d ft2, ft5, ft3 \n",
+        [scale] "f"(scale), [one] "f"(1.0), [y_max] "f"(ERF_Y_MAX), [p] "f"(ERF_P), [t] "f"(ERF_T),
+        [q0] "f"(erf_poly[0]), [q1] "f"(erf_poly[1]), [q2] "f"(erf_poly[2]), [q3] "f"(erf_poly[3]),
+        [q4] "f"(erf_poly[4]), [q5] "f"(erf_poly[5]), [q6] "f"(erf_poly[6]), [q7] "f"(erf_poly[7]));
+    fpmath_pass_end();
+
+    // t -> t * R(t)
+    fpmath_pass_begin(NULL, carry, 1, 1, NULL, count);
+    FPMATH_PASS(frep, count, 16,
+        "fmv.d ft3, ft1 \n"
+        "fmadd.d ft4, ft3, %[r14], %[r13] \n"
+        "fmadd.d ft4, ft4, ft3, %[r12] \n"
+        "fmadd.d ft4, ft4, ft3, %[r11] \n"
+        "fmadd.d ft4, ft4, ft3, %[r10] \n"
+        "fmadd.d ft4, ft4, ft3, %[r9] \n"
+        "fmadd.d ft4, ft4, ft3, %[r8] \n"
+        "fmadd.d ft4, ft4, ft3, %[r7] \n"
+        "fmadd.d ft4, ft4, ft3, %[r6] \n"
+        "fmadd.d ft4, ft4, ft3, %[r5] \n"
+        "fmadd.d ft4, ft4, ft3, %[r4] \n"
+        "fmadd.d ft4, ft4, ft3, %[r3] \n"
+        "fmadd.d ft4, ft4, ft3, %[r2] \n"
+        "fmadd.d ft4, ft4, ft3, %[r1] \n"
+        "fmadd.d ft4, ft4, ft3, %[r0] \n"
+        "fmul.d ft2, ft4, ft3 \n",
+        [r0] "f"(erfc_poly[0]), [r1] "f"(erfc_poly[1]), [r2] "f"(erfc_poly[2]), [r3] "f"(erfc_poly[3]),
+        [r4] "f"(erfc_poly[4]), [r5] "f"(erfc_poly[5]), [r6] "f"(erfc_poly[6]), [r7] "f"(erfc_poly[7]),
+        [r8] "f"(erfc_poly[8]), [r9] "f"(erfc_poly[9]), [r10] "f"(erfc_poly[10]), [r11] "f"(erfc_poly[11]),
+        [r12] "f"(erfc_poly[12]), [r13] "f"(erfc_poly[13]), [r14] "f"(erfc_poly[14]));
+    fpmath_pass_end();
+
+    // y^2 -> expm1(y^2), so exp(-y^2) = 1 / (1 + expm1(y^2))
+    fpmath_expm1(carry + 1, count, frep);
+
+    // erf = 1 - erfc(y) from ERF_T on (w = 1) and erf(y_small) below (w = 0), with the sign of x
+    fpmath_pass_begin(x, carry, 3, 1, result, count);
+    FPMATH_PASS(frep, count, 13,
+        "fmv.d ft3, ft1 \n"
+        "fadd.d ft4, ft1, %[one] \n"
+        "fdiv.d ft3, ft3, ft4 \n"
+        "fmv.d ft4, ft1 \n"
+        "fsub.d ft3, %[one], ft3 \n"
+        "fmv.d ft6, ft0 \n"
+        "fsgnj.d ft5, ft6, %[one] \n"
+        "fsub.d ft5, ft5, %[t_x] \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmax.d ft5, ft5, %[zero] \n"
+        "fsub.d ft3, ft3, ft4 \n"
+        "fmadd.d ft3, ft5, ft3, ft4 \n"
+        "fsgnj.d ft2, ft3, ft6 \n",
+        [one] "f"(1.0), [zero] "f"(0.0), [t_x] "f"(ERF_T / scale));
+    fpmath_pass_end();
+}
+
+/*
+ * A stage of the square root multiplies y by 4^k and H by 2^-k if y < 4^-k: with s = sign(4^-k - y)
+ * the factors are s * yc + yk and s * hc + hk. sqrt(t) = H * sqrt(y) after all stages.
+ */
+typedef struct {
+    double t, yc, yk, hc, hk;
+} sqrt_stage_t;
+
+#define SQRT_STAGE(k) {                     \
+    1.0 / (1ull << 2 * (k)),                \
+    ((double) (1ull << 2 * (k)) - 1) / 2,   \
+    ((double) (1ull << 2 * (k)) + 1) / 2,   \
+    (1.0 / (1ull << (k)) - 1) / 2,          \
+    (1.0 / (1ull << (k)) + 1) / 2           \
+}
+
+static const sqrt_stage_t sqrt_stages[] = {
+    SQRT_STAGE(16), SQRT_STAGE(8), SQRT_STAGE(4), SQRT_STAGE(2), SQRT_STAGE(1)
+};
+
+// 1 / sqrt(y) on [1/4, 1], Chebyshev fit
+static const double rsqrt_poly[] = {
+    3.0743311272572007, -5.6930794268269516, 5.8615237643560745, -2.2478966491330747
+};
+
+/*
+ * Two stages of the reduction, (y, H) -> (y, H).
+ */
+static inline void sqrt_stages_pass(double* carry, size_t count, const sqrt_stage_t* hi, const sqrt_stage_t* lo, int frep) {
+    fpmath_pass_begin(NULL, carry, 2, 2, NULL, count);
+    FPMATH_PASS(frep, count, 13,
+        "fmv.d ft3, ft1 \n"
+        "fsub.d ft5, %[t_hi], ft3 \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmadd.d ft6, ft5, %[yc_hi], %[yk_hi] \n"
+        "fmul.d ft3, ft3, ft6 \n"
+        "fmadd.d ft6, ft5, %[hc_hi], %[hk_hi] \n"
+        "fmul.d ft4, ft1, ft6 \n"
+        "fsub.d ft5, %[t_lo], ft3 \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmadd.d ft6, ft5, %[yc_lo], %[yk_lo] \n"
+        "fmul.d ft2, ft3, ft6 \n"
+        "fmadd.d ft6, ft5, %[hc_lo], %[hk_lo] \n"
+        "fmul.d ft2, ft4, ft6 \n",
+        [one] "f"(1.0),
+        [t_hi] "f"(hi->t), [yc_hi] "f"(hi->yc), [yk_hi] "f"(hi->yk), [hc_hi] "f"(hi->hc), [hk_hi] "f"(hi->hk),
+        [t_lo] "f"(lo->t), [yc_lo] "f"(lo->yc), [yk_lo] "f"(lo->yk), [hc_lo] "f"(lo->hc), [hk_lo] "f"(lo->hk));
+    fpmath_pass_end();
+}
+
+void fpmath_sqrt(double* carry, size_t count, double* result, int frep) {
+    const sqrt_stage_t* last = &sqrt_stages[4];
+
+    sqrt_stages_pass(carry, count, &sqrt_stages[0], &sqrt_stages[1], frep);
+    sqrt_stages_pass(carry, count, &sqrt_stages[2], &sqrt_stages[3], frep);
+
+    // The last stage, (y, H) -> (w = y * H^2 = t, R ~ 1 / (H * sqrt(y)))
+    fpmath_pass_begin(NULL, carry, 2, 2, NULL, count);
+    FPMATH_PASS(frep, count, 13,
+        "fmv.d ft3, ft1 \n"
+        "fsub.d ft5, %[t_lo], ft3 \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmadd.d ft6, ft5, %[yc_lo], %[yk_lo] \n"
+        "fmul.d ft3, ft3, ft6 \n"
+        "fmadd.d ft6, ft5, %[hc_lo], %[hk_lo] \n"
+        "fmul.d ft4, ft1, ft6 \n"
+        "fmul.d ft5, ft3, ft4 \n"
+        "fmul.d ft2, ft5, ft4 \n"
+        "fmadd.d ft6, ft3, %[r3], %[r2] \n"
+        "fmadd.d ft6, ft6, ft3, %[r1] \n"
+        "fmadd.d ft6, ft6, ft3, %[r0] \n"
+        "fdiv.d ft2, ft6, ft4 \n",
+        [one] "f"(1.0),
+        [t_lo] "f"(last->t), [yc_lo] "f"(last->yc), [yk_lo] "f"(last->yk), [hc_lo] "f"(last->hc), [hk_lo] "f"(last->hk),
+        [r0] "f"(rsqrt_poly[0]), [r1] "f"(rsqrt_poly[1]), [r2] "f"(rsqrt_poly[2]), [r3] "f"(rsqrt_poly[3]));
+    fpmath_pass_end();
+
+    // Three Newton steps for 1 / sqrt(w), sqrt(w) = w * R
+    fpmath_pass_begin(NULL, carry, 2, 1, result, count);
+    FPMATH_PASS(frep, count, 13,
+        "fmv.d ft3, ft1 \n"
+        "fmv.d ft4, ft1 \n"
+        "fmul.d ft5, ft3, %[half] \n"
+        "fmul.d ft6, ft4, ft4 \n"
+        "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+        "fmul.d ft4, ft4, ft6 \n"
+        "fmul.d ft6, ft4, ft4 \n"
+        "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+        "fmul.d ft4, ft4, ft6 \n"
+        "fmul.d ft6, ft4, ft4 \n"
+        "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+        "fmul.d ft4, ft4, ft6 \n"
+        "fmul.d ft2, ft4, ft3 \n",
+        [half] "f"(0.5), [three_halves] "f"(1.5));
+    fpmath_pass_end();
+}
+
+/*
+ * A stage of the logarithm divides 1 + u by 2^k and adds k / 2 to E if 1 + u >= 2^k / sqrt(2):
+ * with s = sign(u - t) the new u is u * (s * c + d) + (s * c + c) and E += s * h.
+ * log(1 + u) = log(1 + u') + E * log(2) after all stages (E starts at the sum of k / 2).
+ */
+typedef struct {
+    double t, c, d, h;
+} log_stage_t;
+
+#define LOG_STAGE(k) {                                      \
+    (double) (1ull << (k)) * 0.70710678118654752440 - 1,    \
+    (1.0 / (1ull << (k)) - 1) / 2,                          \
+    (1.0 / (1ull << (k)) + 1) / 2,                          \
+    (k) / 2.0                                               \
+}
+
+static const log_stage_t log_stages[] = {
+    LOG_STAGE(32), LOG_STAGE(16), LOG_STAGE(8), LOG_STAGE(4), LOG_STAGE(2), LOG_STAGE(1)
+};
+
+// Sum of k / 2 over the stages
+#define LOG_E_BIAS 31.5
+
+// 2 atanh(sqrt(q)) / sqrt(q) on [0, ((sqrt(2) - 1) / (sqrt(2) + 1))^2], Chebyshev fit
+static const double log_poly[] = {
+    1.9999999999999993, 0.66666666666582897, 0.40000000052958862, 0.28571417277461136,
+    0.22223355767489247, 0.18124102864670111, 0.16816115986373129
+};
+
+#define LOG_STAGE_OPERANDS(name, stage)                                          \
+    [t_##name] "f"((stage)->t), [c_##name] "f"((stage)->c), [d_##name] "f"((stage)->d), \
+    [h_##name] "f"((stage)->h)
+
+// z * P(z^2) + E * log(2) in ft5 from the carry (z, E)
+#define LOG_FINISH_BODY                         \
+    "fmv.d ft3, ft1 \n"                         \
+    "fmul.d ft4, ft3, ft3 \n"                   \
+    "fmadd.d ft5, ft4, %[l6], %[l5] \n"         \
+    "fmadd.d ft5, ft5, ft4, %[l4] \n"           \
+    "fmadd.d ft5, ft5, ft4, %[l3] \n"           \
+    "fmadd.d ft5, ft5, ft4, %[l2] \n"           \
+    "fmadd.d ft5, ft5, ft4, %[l1] \n"           \
+    "fmadd.d ft5, ft5, ft4, %[l0] \n"           \
+    "fmul.d ft5, ft5, ft3 \n"                   \
+    "fmadd.d ft5, ft1, %[ln2], ft5 \n"
+
+#define LOG_FINISH_OPERANDS                                                                         \
+    [l0] "f"(log_poly[0]), [l1] "f"(log_poly[1]), [l2] "f"(log_poly[2]), [l3] "f"(log_poly[3]),     \
+    [l4] "f"(log_poly[4]), [l5] "f"(log_poly[5]), [l6] "f"(log_poly[6]), [ln2] "f"(0.6931471805599453)
+
+/*
+ * Two stages of the reduction, (u, E) -> (u, E).
+ */
+static inline void log_stages_pass(double* carry, size_t count, const log_stage_t* hi, const log_stage_t* lo, int frep) {
+    fpmath_pass_begin(NULL, carry, 2, 2, NULL, count);
+    FPMATH_PASS(frep, count, 13,
+        "fmv.d ft3, ft1 \n"
+        "fsub.d ft5, ft3, %[t_hi] \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmadd.d ft6, ft5, %[c_hi], %[d_hi] \n"
+        "fmadd.d ft7, ft5, %[c_hi], %[c_hi] \n"
+        "fmadd.d ft3, ft3, ft6, ft7 \n"
+        "fmadd.d ft4, ft5, %[h_hi], ft1 \n"
+        "fsub.d ft5, ft3, %[t_lo] \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmadd.d ft6, ft5, %[c_lo], %[d_lo] \n"
+        "fmadd.d ft7, ft5, %[c_lo], %[c_lo] \n"
+        "fmadd.d ft2, ft3, ft6, ft7 \n"
+        "fmadd.d ft2, ft5, %[h_lo], ft4 \n",
+        [one] "f"(1.0), LOG_STAGE_OPERANDS(hi, hi), LOG_STAGE_OPERANDS(lo, lo));
+    fpmath_pass_end();
+}
+
+void fpmath_log1p(const double* x, double* carry, size_t count, double* result, int frep) {
+    log_stages_pass(carry, count, &log_stages[0], &log_stages[1], frep);
+    log_stages_pass(carry, count, &log_stages[2], &log_stages[3], frep);
+
+    // The last two stages, (u, E) -> (z = u / (2 + u), E + bias)
+    fpmath_pass_begin(NULL, carry, 2, 2, NULL, count);
+    FPMATH_PASS(frep, count, 16,
+        "fmv.d ft3, ft1 \n"
+        "fsub.d ft5, ft3, %[t_hi] \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmadd.d ft6, ft5, %[c_hi], %[d_hi] \n"
+        "fmadd.d ft7, ft5, %[c_hi], %[c_hi] \n"
+        "fmadd.d ft3, ft3, ft6, ft7 \n"
+        "fmadd.d ft4, ft5, %[h_hi], ft1 \n"
+        "fsub.d ft5, ft3, %[t_lo] \n"
+        "fsgnj.d ft5, %[one], ft5 \n"
+        "fmadd.d ft6, ft5, %[c_lo], %[d_lo] \n"
+        "fmadd.d ft7, ft5, %[c_lo], %[c_lo] \n"
+        "fmadd.d ft3, ft3, ft6, ft7 \n"
+        "fmadd.d ft4, ft5, %[h_lo], ft4 \n"
+        "fadd.d ft5, ft3, %[two] \n"
+        "fdiv.d ft2, ft3, ft5 \n"
+        "fadd.d ft2, ft4, %[e_bias] \n",
+        [one] "f"(1.0), [two] "f"(2.0), [e_bias] "f"(LOG_E_BIAS),
+        LOG_STAGE_OPERANDS(hi, &log_stages[4]), LOG_STAGE_OPERANDS(lo, &log_stages[5]));
+    fpmath_pass_end();
+
+    // log(1 + u) = z * P(z^2) + E * log(2), with the sign of x
+    fpmath_pass_begin(x, carry, 2, 1, result, count);
+    if (x != NULL) {
+        FPMATH_PASS(frep, count, 11,
+            LOG_FINISH_BODY
+            "fsgnj.d ft2, ft5, ft0 \n",
+            LOG_FINISH_OPERANDS);
+    } else {
+        FPMATH_PASS(frep, count, 11,
+            LOG_FINISH_BODY
+            "fmv.d ft2, ft5 \n",
+            LOG_FINISH_OPERANDS);
+    }
+    fpmath_pass_end();
+}
@@ -0,0 +1,107 @@
+#ifndef LMQ_FPMATH_H
+#define LMQ_FPMATH_H
+
+#include <snrt.h>
+
+/*
+ * Elementwise math in FP instructions only, so SSR stays enabled for the whole vector and the loops
+ * can run under FREP instead of calling libm for every element.
+ *
+ * The snitch has no fsqrt and the exponent of a double can not be read without leaving the FPU,
+ * so square roots and logarithms reduce their argument in compare free stages: fsgnj.d turns the
+ * sign of (threshold - y) into s = +-1 and an fmadd.d of s gives the scale factor of the stage or 1.
+ *
+ * The FPU sequencer holds at most FPMATH_MAX_BODY instructions, which is less than a whole function,
+ * so a function is a sequence of passes over blocks of FPMATH_BLOCK elements. A pass streams the input
+ * through ft0, the carry of the previous pass through ft1 and writes its carry (or the result) through ft2.
+ * The carry holds up to FPMATH_CARRY values per element, interleaved in a per core scratch in L1.
+ * Registers ft3-ft8 are temporaries of the pass bodies.
+ */
+#define FPMATH_MAX_BODY 16
+#define FPMATH_BLOCK 64
+#define FPMATH_CARRY 3
+
+// Clusters with a carry scratch, like MULTI_MAX_CLUSTERS of multi.h
+#define FPMATH_MAX_CLUSTERS 16
+
+#define FPMATH_CLOBBERS "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7", "ft8"
+
+/*
+ * Runs the pass body of body_len instructions for count elements, under FREP if frep is set and
+ * otherwise as a loop which issues the body once per element. The variadic arguments are the
+ * named input operands of the body.
+ */
+#define FPMATH_PASS(frep, count, body_len, body, ...)                              \
+    do {                                                                          \
+        if (frep) {                                                               \
+            asm volatile(                                                         \
+                "frep.o %[n_frep], " #body_len ", 0, 0 \n"                        \
+                body                                                              \
+                :                                                                 \
+                : [n_frep] "r"((count) - 1), __VA_ARGS__                          \
+                : FPMATH_CLOBBERS                                                 \
+            );                                                                    \
+        } else {                                                                  \
+            for (size_t fpmath_i = 0; fpmath_i < (count); ++fpmath_i) {            \
+                asm volatile(body : : __VA_ARGS__ : FPMATH_CLOBBERS);             \
+            }                                                                     \
+        }                                                                         \
+    } while (0)
+
+/*
+ * Returns the carry scratch (FPMATH_CARRY * FPMATH_BLOCK doubles) of the calling core.
+ * The scratch of all cores of a cluster is allocated in its L1 on the first call of the cluster.
+ */
+double* fpmath_carry();
+
+/*
+ * Configures the streams of a pass over count (<= FPMATH_BLOCK) elements and enables SSR.
+ * x is streamed through ft0 if it is not NULL. ft1 reads num_in (0 to FPMATH_CARRY) carry values per element.
+ * ft2 writes to result if it is not NULL and otherwise num_out (1 to FPMATH_CARRY) carry values per element.
+ * The values of an element are consecutive slots starting at slot 0, carry + k starts them at slot k.
+ * The pass may read and write the same carry.
+ */
+void fpmath_pass_begin(const double* x, double* carry, size_t num_in, size_t num_out, double* result, size_t count);
+
+/*
+ * Waits for the last writes of the pass and disables SSR.
+ */
+void fpmath_pass_end();
+
+/*
+ * exp(x) (or exp(-x) if negate is set) of count elements: a Pade approximant of exp(x / 4096)
+ * squared 12 times (the argument is clamped to [-708, 708]). Max relative error 2e-11.
+ * Writes to result, or to carry slot 0 if result is NULL.
+ */
+void fpmath_exp(const double* x, int negate, double* carry, size_t count, double* result, int frep);
+
+/*
+ * expm1(v) for the carry value v of every element (slot 0 of carry, clamped to [-708, 708]) in place:
+ * a Pade approximant at v / 8192 and 13 steps of expm1(2 v) = d * (d + 2). Max relative error 1e-15 * max(1, |v|),
+ * exp(v) = 1 + expm1(v) for v >= 0 and 1 / (1 + expm1(-v)) for v < 0 keep that precision.
+ */
+void fpmath_expm1(double* carry, size_t count, int frep);
+
+/*
+ * erf(scale * x) for scale > 0 from erfc(y) = exp(-y^2) * t * R(t) with t = 1 / (1 + 0.3 y)
+ * (|scale * x| is clamped to 6 where erf is 1 in double) and a polynomial below |scale * x| = 0.5.
+ * Max relative error 2e-14. Writes to result, or to carry slot 0 if result is NULL.
+ */
+void fpmath_erf(const double* x, double scale, double* carry, size_t count, double* result, int frep);
+
+/*
+ * Square root of t in [2^-64, 1] (or 0): the carry holds (t, 1) per element. The stages scale t to
+ * [1/4, 1], followed by a polynomial for 1/sqrt and three Newton steps. Max relative error 7e-16.
+ * Writes to result, or to carry slot 0 if result is NULL.
+ */
+void fpmath_sqrt(double* carry, size_t count, double* result, int frep);
+
+/*
+ * copysign(log1p(u), x) for u in [0, 2^63): the carry holds (u, 0) per element. The stages scale
+ * 1 + u to [1/sqrt(2), sqrt(2)) and count the exponent, log(1 + z) is a series in atanh.
+ * Max relative error 8e-16. The sign of x is skipped if x is NULL.
+ * Writes to result, or to carry slot 0 if result is NULL.
+ */
+void fpmath_log1p(const double* x, double* carry, size_t count, double* result, int frep);
+
+#endif
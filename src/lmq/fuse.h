@@ -0,0 +1,53 @@
+#ifndef LMQ_FUSE_H
+#define LMQ_FUSE_H
+
+#include <snrt.h>
+
+/*
+ * Fused elementwise chains: a list of ops applied to every element of x, f.ex. add -> leakyrelu -> sigmoid.
+ *
+ * The list is compiled into stages of five FP instructions on a value in registers:
+ *     t = fmadd(t, m, c); t = fmax(t, alpha * t); t = fmin(fmax(t, lo), hi)
+ * alpha 1 is the identity, 0 relu, -1 abs and 0 < alpha < 1 leaky relu. Consecutive ops are merged into
+ * one stage as long as they keep this order. Up to FUSE_MAX_STAGES stages with their constants in registers
+ * form the FREP body of a pass (FPMATH_PASS of src/lmq/fpmath.h over blocks of FPMATH_BLOCK elements).
+ * Only the first pass reads x and only the last pass writes the result, so a chain of up to three stages
+ * without sigmoid is one pass. Longer chains continue from a per core block in L1.
+ *
+ * A vector operand (one per pass) is streamed through ft1 into the first stage of a pass.
+ * Sigmoid starts a new pass: fpmath_exp of the value of the previous pass, 1 / (1 + e) is the first two
+ * instructions of the pass body (which leaves room for two stages).
+ */
+#define FUSE_MAX_STAGES 3
+#define FUSE_MAX_PASSES 8
+
+typedef enum {
+    FUSE_ADD,       // x + operand[i], or x + alpha if operand is NULL
+    FUSE_SUB,       // x - operand[i], or x - alpha if operand is NULL
+    FUSE_MUL,       // x * operand[i], or x * alpha if operand is NULL
+    FUSE_ABS,
+    FUSE_RELU,
+    FUSE_LEAKYRELU, // slope alpha below 0, 0 <= alpha <= 1
+    FUSE_CLIP,      // clamped to [alpha, beta]
+    FUSE_SIGMOID,
+} fuse_kind_t;
+
+typedef struct {
+    fuse_kind_t kind;
+    double alpha;
+    double beta;
+    const double* operand; // n elements or NULL (arithmetic ops only)
+} fuse_op_t;
+
+/*
+ * Apply the num_ops ops of the list to the n elements of arr. The vector operands are indexed like arr.
+ * Return -1 (and write nothing) if the list needs more than FUSE_MAX_PASSES passes or has an
+ * unsupported op (leaky relu slope outside [0, 1], clip with alpha > beta).
+ * The ssr versions compute sigmoid from fpmath_exp (max relative error 3e-11).
+ */
+int fuse_baseline(double* arr, const size_t n, const fuse_op_t* ops, size_t num_ops, double* result);
+int fuse_ssr(double* arr, const size_t n, const fuse_op_t* ops, size_t num_ops, double* result);
+int fuse_ssr_frep(double* arr, const size_t n, const fuse_op_t* ops, size_t num_ops, double* result);
+int fuse_ssr_frep_parallel(double* arr, const size_t n, const fuse_op_t* ops, size_t num_ops, double* result);
+
+#endif
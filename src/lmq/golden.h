@@ -0,0 +1,56 @@
+#ifndef LMQ_GOLDEN_H
+#define LMQ_GOLDEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rng.h"
+
+/*
+ * Golden references: the outputs of the baselines for every size of the benchmark loops, computed by the host
+ * build of the baselines (src/x86/golden.c) into golden_data.h. With LMQ_GOLDEN the benchmarks copy them instead
+ * of running the baselines on the simulator (BENCH_REF of benchmark.h).
+ * name is the baseline (f.ex. "sum_baseline"), its output for size has n elements, an index (argmax) is stored
+ * as a double.
+ */
+typedef struct {
+    const char* name;
+    size_t size;
+    size_t n;
+    const double* data;
+} golden_t;
+
+#define GOLDEN_SEED 2
+
+/*
+ * Uniform input in [0, scale) for element i of stream. The counter based generator gives the same numbers on
+ * the host and on the snitch, unlike random() of the two C libraries.
+ */
+static inline double golden_value(uint32_t stream, size_t i, double scale) {
+    return scale * (rng_draw(rng_key(GOLDEN_SEED, stream), (uint32_t) i) * (1.0 / 4294967296.0));
+}
+
+static inline void golden_fill(double* x, size_t n, uint32_t stream, double scale) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = golden_value(stream, i, scale);
+    }
+}
+
+/*
+ * The reference of the baseline name for size in the count entries of table, NULL if there is none.
+ */
+static inline const golden_t* golden_find(const golden_t* table, size_t count, const char* name, size_t size) {
+    for (size_t t = 0; t < count; t++) {
+        const char* entry = table[t].name;
+        size_t j = 0;
+        while (entry[j] != '\0' && entry[j] == name[j]) {
+            j++;
+        }
+        if (entry[j] == '\0' && name[j] == '\0' && table[t].size == size) {
+            return &table[t];
+        }
+    }
+    return NULL;
+}
+
+#endif
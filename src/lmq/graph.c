@@ -0,0 +1,362 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "graph.h"
+#include "gemm.h"
+#include "add.h"
+#include "relu.h"
+#include "sigmoid.h"
+#include "softmax.h"
+#include "conv.h"
+#include "maxpool.h"
+#include "batchnorm.h"
+#include "layernorm.h"
+#include "argmax.h"
+#include "attention.h"
+
+size_t graph_output_size(const graph_node_t* node) {
+    const size_t* a = node->attrs;
+    switch (node->op) {
+    case GRAPH_GEMM:
+        return a[0] * a[2];
+    case GRAPH_BIAS:
+    case GRAPH_SOFTMAX:
+        return a[0] * a[1];
+    case GRAPH_ADD:
+    case GRAPH_RELU:
+    case GRAPH_SIGMOID:
+    case GRAPH_LEAKYRELU:
+    case GRAPH_ARGMAX:
+        return a[0];
+    case GRAPH_BATCHNORM:
+    case GRAPH_LAYERNORM:
+        return a[0] * a[1];
+    case GRAPH_CONV:
+        return a[3] * conv_output_size(a[1], a[4], a[6], 1) * conv_output_size(a[2], a[5], a[7], 1);
+    case GRAPH_ATTENTION:
+        return a[0] * a[1] * a[4];
+    case GRAPH_CONV2D:
+        return conv_output_size(a[0], a[2], a[4], a[6]) * conv_output_size(a[1], a[3], a[5], a[7]);
+    case GRAPH_MAXPOOL2D:
+        return pool_output_size(a[0], a[2], a[4]) * pool_output_size(a[1], a[3], a[5]);
+    }
+    return 0;
+}
+
+const char* graph_op_name(graph_op_t op) {
+    static const char* names[] = {"gemm", "bias", "add", "relu", "sigmoid", "softmax", "conv2d", "maxpool2d",
+                                  "leakyrelu", "conv", "batchnorm", "layernorm", "argmax", "attention"};
+    return (size_t)op < sizeof(names) / sizeof(names[0]) ? names[op] : "unknown";
+}
+
+static int graph_overlap(const size_t* first, const size_t* last, size_t a, size_t b) {
+    return first[a] <= last[b] && first[b] <= last[a];
+}
+
+/*
+ * Offsets (in doubles) of the intermediates in order of their size, largest first. An intermediate goes to
+ * the L1 pool if it fits below l1_capacity and to the global pool otherwise. Returns the doubles of both pools.
+ */
+static void graph_place(const graph_t* g, const size_t* order, size_t num, const size_t* first, const size_t* last,
+                        size_t l1_capacity, size_t* offsets, int* in_l1, size_t* l1_used, size_t* global_used) {
+    *l1_used = 0;
+    *global_used = 0;
+    for (size_t i = 0; i < num; i++) {
+        size_t t = order[i];
+        size_t size = g->tensors[t].size + LMQ_SSR_GUARD;
+        for (int pool = 1; pool >= 0; pool--) {
+            size_t capacity = pool ? l1_capacity : (size_t)-1;
+            // the lowest of 0 and the ends of the tensors alive at the same time which is free
+            size_t best = (size_t)-1;
+            for (size_t c = 0; c <= i; c++) {
+                size_t candidate = 0;
+                if (c < i) {
+                    size_t o = order[c];
+                    if (in_l1[o] != pool || !graph_overlap(first, last, t, o)) {
+                        continue;
+                    }
+                    candidate = offsets[o] + g->tensors[o].size + LMQ_SSR_GUARD;
+                }
+                if (candidate >= best || candidate + size > capacity) {
+                    continue;
+                }
+                int free = 1;
+                for (size_t p = 0; p < i && free; p++) {
+                    size_t o = order[p];
+                    free = in_l1[o] != pool || !graph_overlap(first, last, t, o) ||
+                           candidate + size <= offsets[o] || offsets[o] + g->tensors[o].size + LMQ_SSR_GUARD <= candidate;
+                }
+                if (free) {
+                    best = candidate;
+                }
+            }
+            if (best != (size_t)-1) {
+                offsets[t] = best;
+                in_l1[t] = pool;
+                size_t* used = pool ? l1_used : global_used;
+                *used = best + size > *used ? best + size : *used;
+                break;
+            }
+        }
+    }
+}
+
+int graph_plan(graph_t* g) {
+    size_t first[GRAPH_MAX_TENSORS], last[GRAPH_MAX_TENSORS], offsets[GRAPH_MAX_TENSORS];
+    size_t order[GRAPH_MAX_TENSORS];
+    int written[GRAPH_MAX_TENSORS], in_l1[GRAPH_MAX_TENSORS];
+    if (g->num_tensors > GRAPH_MAX_TENSORS) {
+        return -1;
+    }
+    for (size_t t = 0; t < g->num_tensors; t++) {
+        written[t] = 0;
+    }
+
+    // lifetimes: from the node writing an intermediate to the last node reading it
+    for (size_t i = 0; i < g->num_nodes; i++) {
+        const graph_node_t* node = &g->nodes[i];
+        for (size_t j = 0; j < GRAPH_MAX_INPUTS; j++) {
+            int t = node->inputs[j];
+            if (t < 0) {
+                continue;
+            }
+            if ((size_t)t >= g->num_tensors) {
+                return -1;
+            }
+            if (g->tensors[t].kind == GRAPH_INTERMEDIATE) {
+                if (!written[t]) {
+                    return -1;
+                }
+                last[t] = i;
+            }
+        }
+        // attention allocates its state, it can not run on shares
+        if ((node->variant == GRAPH_SPLIT && node->op == GRAPH_ATTENTION) ||
+            (node->variant == GRAPH_CLUSTER && node->op != GRAPH_ATTENTION)) {
+            return -1;
+        }
+        int t = node->output;
+        if (t < 0 || (size_t)t >= g->num_tensors || g->tensors[t].size != graph_output_size(node) ||
+            g->tensors[t].kind == GRAPH_INPUT || g->tensors[t].kind == GRAPH_CONST) {
+            return -1;
+        }
+        if (g->tensors[t].kind == GRAPH_INTERMEDIATE && !written[t]) {
+            written[t] = 1;
+            first[t] = i;
+            last[t] = i;
+        }
+    }
+
+    size_t num = 0;
+    g->unplanned_bytes = 0;
+    for (size_t t = 0; t < g->num_tensors; t++) {
+        if (g->tensors[t].kind == GRAPH_INTERMEDIATE && written[t]) {
+            order[num++] = t;
+            g->unplanned_bytes += g->tensors[t].size * sizeof(double);
+        }
+    }
+    // largest first
+    for (size_t i = 1; i < num; i++) {
+        size_t t = order[i];
+        size_t j = i;
+        for (; j > 0 && g->tensors[order[j - 1]].size < g->tensors[t].size; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = t;
+    }
+
+    size_t l1_used, global_used;
+    graph_place(g, order, num, first, last, GRAPH_L1_SIZE / sizeof(double), offsets, in_l1, &l1_used, &global_used);
+    double* l1_pool = l1_used ? arena_alloc(arena_l1(), l1_used, sizeof(double), LMQ_ALIGN_DOUBLE) : NULL;
+    if (l1_used && l1_pool == NULL) {
+        graph_place(g, order, num, first, last, 0, offsets, in_l1, &l1_used, &global_used);
+    }
+    double* global_pool = global_used ? allocate(global_used, sizeof(double)) : NULL;
+    if (global_used && global_pool == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < num; i++) {
+        size_t t = order[i];
+        g->tensors[t].data = (in_l1[t] ? l1_pool : global_pool) + offsets[t];
+    }
+    g->l1_bytes = l1_used * sizeof(double);
+    g->global_bytes = global_used * sizeof(double);
+    return 0;
+}
+
+/*
+ * Runs the share part of parts of node, the whole node for parts = 1.
+ */
+static int graph_node_run(const graph_t* g, const graph_node_t* node, size_t part, size_t parts, int baseline) {
+    const size_t* a = node->attrs;
+    double* x = node->inputs[0] >= 0 ? g->tensors[node->inputs[0]].data : NULL;
+    double* y = node->inputs[1] >= 0 ? g->tensors[node->inputs[1]].data : NULL;
+    double* z = node->inputs[2] >= 0 ? g->tensors[node->inputs[2]].data : NULL;
+    double* result = g->tensors[node->output].data;
+    size_t first;
+    size_t count;
+    int ret = 0;
+
+    switch (node->op) {
+    case GRAPH_GEMM:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? gemm_baseline : gemm_ssr_frep)(x + first * a[1], y, count, a[1], a[2], result + first * a[2]);
+        }
+        break;
+    case GRAPH_BIAS:
+        count = local_range(a[0], part, parts, &first);
+        for (size_t r = first; r < first + count; r++) {
+            ret |= (baseline ? add_baseline : add_ssr_frep)(x + r * a[1], y, a[1], result + r * a[1]);
+        }
+        break;
+    case GRAPH_ADD:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? add_baseline : add_ssr_frep)(x + first, y + first, count, result + first);
+        }
+        break;
+    case GRAPH_RELU:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? relu_baseline : relu_ssr_frep)(x + first, count, result + first);
+        }
+        break;
+    case GRAPH_SIGMOID:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? sigmoid_baseline : sigmoid_ssr_frep)(x + first, count, result + first);
+        }
+        break;
+    case GRAPH_SOFTMAX:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? softmax_baseline : softmax_ssr_frep)(x + first * a[1], count, a[1], result + first * a[1]);
+        }
+        break;
+    case GRAPH_CONV2D: {
+        // output rows split, every share reads the input rows its outputs need
+        size_t out0 = conv_output_size(a[0], a[2], a[4], a[6]);
+        count = local_range(conv_output_size(a[1], a[3], a[5], a[7]), part, parts, &first);
+        if (count) {
+            size_t rows = (count - 1) * a[5] + 1 + (a[3] - 1) * a[7];
+            ret = (baseline ? conv2d_baseline : conv2d_ssr_frep)(x + first * a[5] * a[0], y, a[0], rows, a[2], a[3],
+                                                                 a[4], a[5], a[6], a[7], result + first * out0);
+        }
+        break;
+    }
+    case GRAPH_MAXPOOL2D: {
+        size_t out0 = pool_output_size(a[0], a[2], a[4]);
+        count = local_range(pool_output_size(a[1], a[3], a[5]), part, parts, &first);
+        if (count) {
+            size_t rows = (count - 1) * a[5] + a[3];
+            ret = (baseline ? maxpool2d_baseline : maxpool2d_ssr_frep)(x + first * a[5] * a[0], a[0], rows, a[2], a[3],
+                                                                       a[4], a[5], result + first * out0);
+        }
+        break;
+    }
+    case GRAPH_LEAKYRELU:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? leakyrelu_baseline : leakyrelu_ssr_frep)(x + first, count, node->param, result + first);
+        }
+        break;
+    case GRAPH_CONV: {
+        // output channels split, every share reads the whole input
+        size_t filter_len = a[0] * a[4] * a[5];
+        size_t out = conv_output_size(a[1], a[4], a[6], 1) * conv_output_size(a[2], a[5], a[7], 1);
+        count = local_range(a[3], part, parts, &first);
+        if (count) {
+            ret = (baseline ? conv_nchw_baseline : conv_nchw_ssr_frep)(x, y + first * filter_len, z ? z + first : NULL, 1,
+                                                                       a[0], a[1], a[2], count, 1, a[4], a[5], a[6], a[7],
+                                                                       1, 1, result + first * out);
+        }
+        break;
+    }
+    case GRAPH_BATCHNORM:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? batchnorm_nchw_inference_baseline : batchnorm_nchw_inference_ssr_frep)(
+                x + first * a[1], 1, count, a[1], y + first, y + a[0] + first, y + 2 * a[0] + first,
+                y + 3 * a[0] + first, node->param, result + first * a[1]);
+        }
+        break;
+    case GRAPH_LAYERNORM:
+        count = local_range(a[0], part, parts, &first);
+        if (count) {
+            ret = (baseline ? layernorm_baseline : layernorm_ssr_frep)(x + first * a[1], count, a[1], y, y + a[1],
+                                                                       node->param, result + first * a[1]);
+        }
+        break;
+    case GRAPH_ARGMAX:
+        count = local_range(a[0], part, parts, &first);
+        for (size_t r = first; r < first + count; r++) {
+            int index = 0;
+            ret |= (baseline ? argmax_baseline : argmax_ssr_frep)(x + r * a[1], a[1], &index);
+            result[r] = (double)index;
+        }
+        break;
+    case GRAPH_ATTENTION:
+        ret = (baseline ? attention_baseline : attention_ssr_frep)(x, y, z, a[0], a[1], a[2], a[3], a[4], node->param,
+                                                                   result);
+        break;
+    }
+    return ret;
+}
+
+/*
+ * Runs the GRAPH_CLUSTER node on all cores.
+ */
+static int graph_node_cluster(const graph_t* g, const graph_node_t* node) {
+    const size_t* a = node->attrs;
+    double* result = g->tensors[node->output].data;
+
+    switch (node->op) {
+    case GRAPH_ATTENTION:
+        return attention_ssr_frep_parallel(g->tensors[node->inputs[0]].data, g->tensors[node->inputs[1]].data,
+                                           g->tensors[node->inputs[2]].data, a[0], a[1], a[2], a[3], a[4],
+                                           node->param, result);
+    default:
+        return -1;
+    }
+}
+
+int graph_run(const graph_t* g) {
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+    int ret = 0;
+
+    size_t start = read_csr(mcycle);
+    for (size_t i = 0; i < g->num_nodes; i++) {
+        const graph_node_t* node = &g->nodes[i];
+        if (node->variant == GRAPH_SPLIT && core_idx < core_num) {
+            ret |= graph_node_run(g, node, core_idx, core_num, 0);
+        } else if (node->variant == GRAPH_SERIAL && core_idx == 0) {
+            ret |= graph_node_run(g, node, 0, 1, 0);
+        } else if (node->variant == GRAPH_CLUSTER) {
+            ret |= graph_node_cluster(g, node);
+        }
+        snrt_cluster_hw_barrier();
+        if (g->cycles != NULL && core_idx == 0) {
+            size_t end = read_csr(mcycle);
+            g->cycles[i] = end - start;
+            start = end;
+        }
+    }
+    return ret;
+}
+
+int graph_run_baseline(const graph_t* g) {
+    int ret = 0;
+    size_t start = read_csr(mcycle);
+    for (size_t i = 0; i < g->num_nodes; i++) {
+        ret |= graph_node_run(g, &g->nodes[i], 0, 1, 1);
+        if (g->cycles != NULL) {
+            size_t end = read_csr(mcycle);
+            g->cycles[i] = end - start;
+            start = end;
+        }
+    }
+    return ret;
+}
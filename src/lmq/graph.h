@@ -0,0 +1,123 @@
+#ifndef LMQ_GRAPH_H
+#define LMQ_GRAPH_H
+
+#include <snrt.h>
+
+/*
+ * Static graph executor: a list of nodes over numbered double tensors, f.ex. the layers of an MLP or
+ * a small CNN from a generated header, run in order on the cluster.
+ *
+ * Every node is one fork/join: the compute cores run the single core (SSR+FREP) kernel of the op on
+ * their share of the rows or elements (local_range) and all cores meet in one hardware barrier before the
+ * next node, instead of the barriers inside every parallel kernel. GRAPH_SERIAL nodes run on core 0 only,
+ * GRAPH_CLUSTER nodes call the parallel kernel on all cores (attention, which allocates its state).
+ *
+ * graph_plan places the intermediate tensors: two intermediates share memory if their lifetimes
+ * (from the node writing them to the last node reading them) do not overlap. The tensors are placed by size,
+ * largest first, at the lowest offset which does not overlap a placed tensor alive at the same time, into one
+ * L1 pool of at most GRAPH_L1_SIZE bytes and the ones which do not fit into one global memory pool.
+ */
+#ifndef GRAPH_L1_SIZE
+#define GRAPH_L1_SIZE (16 * 1024)
+#endif
+
+#define GRAPH_MAX_TENSORS 64
+#define GRAPH_MAX_INPUTS 3
+#define GRAPH_MAX_ATTRS 8
+
+typedef enum {
+    GRAPH_GEMM,      // inputs a (m x n) and b (n x k), attrs m, n, k; result (m x k)
+    GRAPH_BIAS,      // inputs x (rows x cols) and a bias of cols, attrs rows, cols; x + bias in every row
+    GRAPH_ADD,       // inputs a and b, attrs n
+    GRAPH_RELU,      // attrs n
+    GRAPH_SIGMOID,   // attrs n
+    GRAPH_SOFTMAX,   // attrs rows, cols; along the rows
+    GRAPH_CONV2D,    // inputs a and filter, attrs n0, n1, f0, f1, s0, s1, d0, d1 (see conv2d in conv.h)
+    GRAPH_MAXPOOL2D, // attrs n0, n1, f0, f1, s0, s1 (see maxpool2d in maxpool.h)
+    GRAPH_LEAKYRELU, // attrs n, param alpha
+    GRAPH_CONV,      // inputs x (c_in, n1, n0), w and a bias of c_out or -1, attrs c_in, n0, n1, c_out, f0, f1, s0, s1
+                     // (see conv_nchw in conv.h, one image, one group, no dilation), split over the output channels
+    GRAPH_BATCHNORM, // inputs x (c, hw) and scale, bias, mean and var of c one after the other, attrs c, hw,
+                     // param epsilon; inference mode, split over the channels
+    GRAPH_LAYERNORM, // inputs x (rows x cols) and scale and bias of cols, attrs rows, cols, param epsilon
+    GRAPH_ARGMAX,    // attrs rows, cols; the index of the maximum of every row as a double
+    GRAPH_ATTENTION, // inputs q, k and v, attrs heads, seq_q, seq_k, d, dv, param scale (see attention.h);
+                     // GRAPH_SERIAL or GRAPH_CLUSTER only
+} graph_op_t;
+
+typedef enum {
+    GRAPH_SPLIT,     // rows or elements split over the compute cores
+    GRAPH_SERIAL,    // core 0 only
+    GRAPH_CLUSTER,   // all cores run the parallel kernel of the op, which synchronises the cores itself
+} graph_variant_t;
+
+typedef struct {
+    graph_op_t op;
+    graph_variant_t variant;
+    int inputs[GRAPH_MAX_INPUTS]; // tensor ids, -1 if unused
+    int output;
+    size_t attrs[GRAPH_MAX_ATTRS];
+    double param;
+} graph_node_t;
+
+typedef enum {
+    GRAPH_INPUT,
+    GRAPH_CONST,        // weights
+    GRAPH_INTERMEDIATE, // placed by graph_plan
+    GRAPH_OUTPUT,
+} graph_tensor_kind_t;
+
+/*
+ * size is the number of doubles. data is set by the caller for all but the intermediates.
+ */
+typedef struct {
+    graph_tensor_kind_t kind;
+    size_t size;
+    double* data;
+} graph_tensor_t;
+
+typedef struct {
+    graph_tensor_t* tensors;
+    size_t num_tensors;
+    const graph_node_t* nodes;
+    size_t num_nodes;
+    // set by graph_plan
+    size_t l1_bytes;
+    size_t global_bytes;
+    size_t unplanned_bytes; // bytes of all intermediates, what one allocate per intermediate takes
+    // set by the caller: num_nodes entries for the cycles of every node on core 0 (up to the barrier after it), or NULL
+    size_t* cycles;
+} graph_t;
+
+/*
+ * Number of doubles the node writes.
+ */
+size_t graph_output_size(const graph_node_t* node);
+
+/*
+ * Lower case name of op, f.ex. for the cycles of the nodes.
+ */
+const char* graph_op_name(graph_op_t op);
+
+/*
+ * Places the intermediates of g (see above) and allocates the pools from arena_l1 and arena_global.
+ * Run once by one core before graph_run. Returns -1 if a tensor id is invalid, an intermediate is read
+ * before it is written, the size of an output tensor does not match its node or the node can not run as its variant, 1 if the global arena is
+ * exhausted and 0 otherwise. If the L1 arena is exhausted all intermediates go to global memory.
+ */
+int graph_plan(graph_t* g);
+
+/*
+ * Runs all nodes of g. Must be called by all cores of the cluster (including the DM core), records the cycles
+ * of the nodes if g->cycles is set.
+ * Returns the result codes of the kernels the calling core ran, or-ed.
+ */
+int graph_run(const graph_t* g);
+
+/*
+ * Runs all nodes of g with the baseline kernels on the calling core only, as the reference (and records the
+ * cycles of the nodes like graph_run).
+ */
+int graph_run_baseline(const graph_t* g);
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef LMQ_KERNEL_H
+#define LMQ_KERNEL_H
+
+#include <snrt.h>
+#include "omp.h"
+
+#include "lmq.h"
+#include "fpmath.h"
+#include "sched.h"
+
+/*
+ * Generators for the variants of a kernel, so the splitting over the cores is written once.
+ *
+ * KERNEL_PARALLEL and KERNEL_OMP define the function name with the parameter list params.
+ * Every compute core computes local_range(n) of the n elements or lanes and runs call
+ * (usually the single core kernel on pointers offset by first) for its range [first, first + count).
+ * Cores with an empty range skip call, the DM core returns (bare metal) or is not used (OMP).
+ */
+#define KERNEL_PARALLEL(name, params, n, call)                                              \
+    __attribute__((noinline))                                                               \
+    int name params {                                                                       \
+        if (snrt_is_dm_core()) {                                                            \
+            return 0;                                                                       \
+        }                                                                                   \
+        size_t first;                                                                       \
+        size_t count = local_range((n), snrt_cluster_core_idx(), snrt_cluster_core_num() - 1, &first); \
+        if (count > 0) {                                                                    \
+            call;                                                                           \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+/*
+ * Like KERNEL_PARALLEL, but every compute core takes chunks of chunk elements (0 for sched_chunk) from the
+ * counter of src/lmq/sched.h and runs call for every chunk [first, first + count) it got, for kernels whose
+ * cost per element depends on the data or the position. It must be called by all compute cores.
+ */
+#define KERNEL_DYNAMIC(name, params, n, chunk, call)                                        \
+    __attribute__((noinline))                                                               \
+    int name params {                                                                       \
+        if (snrt_is_dm_core()) {                                                            \
+            return 0;                                                                       \
+        }                                                                                   \
+        sched_t kernel_sched;                                                               \
+        size_t first;                                                                       \
+        size_t count;                                                                       \
+        sched_begin(&kernel_sched, (n), (chunk));                                           \
+        while ((count = sched_next(&kernel_sched, &first)) > 0) {                           \
+            call;                                                                           \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+// The last thread is not used in OpenMP, it is the DM core
+#define KERNEL_OMP(name, params, n, call)                                                   \
+    int name params {                                                                       \
+        unsigned kernel_core_num = snrt_cluster_core_num() - 1;                             \
+        _Pragma("omp parallel")                                                             \
+        {                                                                                   \
+            size_t first;                                                                   \
+            size_t count = local_range((n), snrt_cluster_core_idx(), kernel_core_num, &first); \
+            if (count > 0) {                                                                \
+                call;                                                                       \
+            }                                                                               \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+/*
+ * Reductions: call sets the double partial of the range (it starts as neutral), the partials are
+ * combined with op by reduce_cluster (src/lmq/reduce.h) or, under OMP, by reduce_team inside the parallel region.
+ * The result is written to *out by core 0.
+ */
+#define KERNEL_REDUCE_PARALLEL(name, params, n, op, neutral, call, out)                     \
+    __attribute__((noinline))                                                               \
+    int name params {                                                                       \
+        double partial = (neutral);                                                         \
+        if (!snrt_is_dm_core()) {                                                           \
+            size_t first;                                                                   \
+            size_t count = local_range((n), snrt_cluster_core_idx(), snrt_cluster_core_num() - 1, &first); \
+            if (count > 0) {                                                                \
+                call;                                                                       \
+            }                                                                               \
+        }                                                                                   \
+        double kernel_total = reduce_cluster((op), partial, 0, NULL);                       \
+        if (snrt_cluster_core_idx() == 0) {                                                 \
+            *(out) = kernel_total;                                                          \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+#define KERNEL_REDUCE_OMP(name, params, n, op, neutral, call, out)                          \
+    int name params {                                                                       \
+        unsigned kernel_core_num = snrt_cluster_core_num() - 1;                             \
+        _Pragma("omp parallel")                                                             \
+        {                                                                                   \
+            double partial = (neutral);                                                     \
+            size_t first;                                                                   \
+            size_t count = local_range((n), snrt_cluster_core_idx(), kernel_core_num, &first); \
+            if (count > 0) {                                                                \
+                call;                                                                       \
+            }                                                                               \
+            double kernel_total = reduce_team((op), partial, 0, NULL);                      \
+            if (snrt_cluster_core_idx() == 0) {                                             \
+                *(out) = kernel_total;                                                      \
+            }                                                                               \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+/*
+ * The six _parallel and _omp variants of a unary kernel (type* arr, const size_t n, double* result) from its
+ * prefix_baseline and from range(arr, n, result, frep), which the _ssr and _ssr_frep kernels run with frep 0 and 1.
+ */
+#define KERNEL_UNARY_SPLIT(prefix, type, range)                                             \
+    KERNEL_UNARY_SPLIT_CALLS(prefix, _parallel, KERNEL_PARALLEL, type, range)               \
+    KERNEL_UNARY_SPLIT_CALLS(prefix, _omp, KERNEL_OMP, type, range)
+
+#define KERNEL_UNARY_SPLIT_CALLS(prefix, suffix, split, type, range)                        \
+    split(prefix##suffix, (type* arr, const size_t n, double* result), n,                   \
+          prefix##_baseline(arr + first, count, result + first))                            \
+    split(prefix##_ssr##suffix, (type* arr, const size_t n, double* result), n,             \
+          range(arr + first, count, result + first, 0))                                     \
+    split(prefix##_ssr_frep##suffix, (type* arr, const size_t n, double* result), n,        \
+          range(arr + first, count, result + first, 1))
+
+/*
+ * Elementwise kernels from a C expression and an FP body. The families define prefix_baseline, prefix_ssr,
+ * prefix_ssr_frep and their _parallel and _omp variants (nine functions):
+ *     KERNEL_UNARY(prefix, expr, len, body)          (double* arr, const size_t n, double* result)
+ *     KERNEL_UNARY_SCALAR(prefix, expr, len, body)   (double* arr, const size_t n, double alpha, double* result)
+ *     KERNEL_UNARY_SCALARS(prefix, expr, len, body)  (double* arr, const size_t n, double alpha, double beta, double* result)
+ *     KERNEL_BINARY(prefix, expr, len, body)         (double* a, double* b, const size_t n, double* result)
+ * expr computes the result of element x (and y of b) in C. The len instructions of body read x from ft0,
+ * y from ft1 and write the result to ft2 once per element, f.ex. "fdiv.d ft2, ft0, ft1 \n".
+ * The body may use ft3-ft8 and the operands %[zero], %[one], %[alpha] and %[beta]. It runs as FPMATH_PASS
+ * (src/lmq/fpmath.h), so len is a literal of at most FPMATH_MAX_BODY.
+ */
+
+// Streams a (and b) into ft0 (and ft1) and result from ft2 and enables SSR
+static inline void kernel_streams_begin(const double* a, const double* b, size_t n, double* result) {
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) a);
+
+    if (b != NULL) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*b));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, (double*) b);
+    }
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, n, sizeof(*result));
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
+
+    snrt_ssr_enable();
+}
+
+static inline void kernel_streams_end() {
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+#define KERNEL_SSR(name, params, a, b, n, scalar, scalar2, frep, len, body, result)         \
+    __attribute__((noinline))                                                               \
+    int name params {                                                                       \
+        if ((n) == 0) {                                                                     \
+            return 0;                                                                       \
+        }                                                                                   \
+        kernel_streams_begin((a), (b), (n), (result));                                      \
+        FPMATH_PASS(frep, (n), len, body,                                                   \
+                    [zero] "f"(0.0), [one] "f"(1.0), [alpha] "f"(scalar), [beta] "f"(scalar2)); \
+        kernel_streams_end();                                                               \
+        return 0;                                                                           \
+    }
+
+#define KERNEL_UNARY_VARIANTS(prefix, params, len, body, scalar, scalar2, offset_args)      \
+    KERNEL_SSR(prefix##_ssr, params, arr, NULL, n, scalar, scalar2, 0, len, body, result)   \
+    KERNEL_SSR(prefix##_ssr_frep, params, arr, NULL, n, scalar, scalar2, 1, len, body, result) \
+    KERNEL_PARALLEL(prefix##_parallel, params, n, prefix##_baseline offset_args)            \
+    KERNEL_PARALLEL(prefix##_ssr_parallel, params, n, prefix##_ssr offset_args)             \
+    KERNEL_PARALLEL(prefix##_ssr_frep_parallel, params, n, prefix##_ssr_frep offset_args)   \
+    KERNEL_OMP(prefix##_omp, params, n, prefix##_baseline offset_args)                      \
+    KERNEL_OMP(prefix##_ssr_omp, params, n, prefix##_ssr offset_args)                       \
+    KERNEL_OMP(prefix##_ssr_frep_omp, params, n, prefix##_ssr_frep offset_args)
+
+#define KERNEL_UNARY(prefix, expr, len, body)                                               \
+    __attribute__((noinline))                                                               \
+    int prefix##_baseline(double* arr, const size_t n, double* result) {                    \
+        for (size_t i = 0; i < n; i++) {                                                    \
+            double x = arr[i];                                                              \
+            result[i] = (expr);                                                             \
+        }                                                                                   \
+        return 0;                                                                           \
+    }                                                                                       \
+    KERNEL_UNARY_VARIANTS(prefix, (double* arr, const size_t n, double* result), len, body, 0.0, 0.0, \
+                          (arr + first, count, result + first))
+
+#define KERNEL_UNARY_SCALAR(prefix, expr, len, body)                                        \
+    __attribute__((noinline))                                                               \
+    int prefix##_baseline(double* arr, const size_t n, double alpha, double* result) {      \
+        for (size_t i = 0; i < n; i++) {                                                    \
+            double x = arr[i];                                                              \
+            result[i] = (expr);                                                             \
+        }                                                                                   \
+        return 0;                                                                           \
+    }                                                                                       \
+    KERNEL_UNARY_VARIANTS(prefix, (double* arr, const size_t n, double alpha, double* result), len, body, \
+                          alpha, 0.0, (arr + first, count, alpha, result + first))
+
+#define KERNEL_UNARY_SCALARS(prefix, expr, len, body)                                       \
+    __attribute__((noinline))                                                               \
+    int prefix##_baseline(double* arr, const size_t n, double alpha, double beta, double* result) { \
+        for (size_t i = 0; i < n; i++) {                                                    \
+            double x = arr[i];                                                              \
+            result[i] = (expr);                                                             \
+        }                                                                                   \
+        return 0;                                                                           \
+    }                                                                                       \
+    KERNEL_UNARY_VARIANTS(prefix, (double* arr, const size_t n, double alpha, double beta, double* result), \
+                          len, body, alpha, beta, (arr + first, count, alpha, beta, result + first))
+
+#define KERNEL_BINARY(prefix, expr, len, body)                                              \
+    __attribute__((noinline))                                                               \
+    int prefix##_baseline(double* a, double* b, const size_t n, double* result) {           \
+        for (size_t i = 0; i < n; i++) {                                                    \
+            double x = a[i];                                                                \
+            double y = b[i];                                                                \
+            result[i] = (expr);                                                             \
+        }                                                                                   \
+        return 0;                                                                           \
+    }                                                                                       \
+    KERNEL_SSR(prefix##_ssr, (double* a, double* b, const size_t n, double* result),        \
+               a, b, n, 0.0, 0.0, 0, len, body, result)                                     \
+    KERNEL_SSR(prefix##_ssr_frep, (double* a, double* b, const size_t n, double* result),   \
+               a, b, n, 0.0, 0.0, 1, len, body, result)                                     \
+    KERNEL_BINARY_SPLIT(prefix, _parallel, KERNEL_PARALLEL)                                 \
+    KERNEL_BINARY_SPLIT(prefix, _omp, KERNEL_OMP)
+
+#define KERNEL_BINARY_SPLIT(prefix, suffix, split)                                          \
+    split(prefix##suffix, (double* a, double* b, const size_t n, double* result), n,        \
+          prefix##_baseline(a + first, b + first, count, result + first))                   \
+    split(prefix##_ssr##suffix, (double* a, double* b, const size_t n, double* result), n,  \
+          prefix##_ssr(a + first, b + first, count, result + first))                        \
+    split(prefix##_ssr_frep##suffix, (double* a, double* b, const size_t n, double* result), n, \
+          prefix##_ssr_frep(a + first, b + first, count, result + first))
+
+#endif
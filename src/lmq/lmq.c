@@ -3,21 +3,151 @@
 
 #include <snrt.h>
 
-void* cur_memory = NULL;
+#ifndef LMQ_HOST
+arena_t global_arena;
+arena_t l1_arena;
 
-void* allocate(const size_t n, const size_t element_size) {
-    if (cur_memory == NULL) {
-        cur_memory = (void*) snrt_global_memory().start;
+void arena_init(arena_t* arena, void* start, const size_t size) {
+    arena->end = (char*) start + size;
+    arena->cur = (char*) start;
+#ifdef LMQ_ARENA_DEBUG
+    arena->num_guards = 0;
+#endif
+    // Set last as a non-NULL start marks the arena as initialised
+    arena->start = (char*) start;
+}
+
+arena_t* arena_global() {
+    // Any core may be the first one to ask for the arena, so initialise it only once
+    if (global_arena.start == NULL) {
+        snrt_mutex_lock(snrt_mutex());
+        if (global_arena.start == NULL) {
+            snrt_slice_t mem = snrt_global_memory();
+            arena_init(&global_arena, (void*) mem.start, mem.end - mem.start);
+        }
+        snrt_mutex_release(snrt_mutex());
+    }
+    return &global_arena;
+}
+
+arena_t* arena_l1() {
+    if (l1_arena.start == NULL) {
+        snrt_mutex_lock(snrt_mutex());
+        if (l1_arena.start == NULL) {
+            arena_init(&l1_arena, snrt_l1alloc(LMQ_L1_ARENA_SIZE), LMQ_L1_ARENA_SIZE);
+        }
+        snrt_mutex_release(snrt_mutex());
     }
-    void* now = cur_memory;
+    return &l1_arena;
+}
+
+/*
+ * Allocates such that the returned address minus offset is aligned to alignment.
+ */
+static void* arena_alloc_offset(arena_t* arena, const size_t n, const size_t element_size,
+                                const size_t alignment, const size_t offset) {
+    size_t misalignment = ((size_t) arena->cur - offset) & (alignment - 1);
+    char* now = arena->cur + (misalignment ? alignment - misalignment : 0);
+    size_t guard_size = LMQ_SSR_GUARD * element_size;
+    char* next = now + n * element_size + guard_size;
 
-    // This is to have some spacing as SSR sometimes writes one more
-    // element to the stream which may be outide an array.
-    cur_memory += (n*element_size + element_size);
+    if (next > arena->end) {
+        printf("arena_alloc: out of memory (requested %d bytes, %d in use)\n",
+            n * element_size, arena_used(arena));
+        return NULL;
+    }
+
+#ifdef LMQ_ARENA_DEBUG
+    // Write a canary into the guard instead of silently padding so that overwrites can be detected
+    char* guard = now + n * element_size;
+    for (size_t i = 0; i < guard_size; i++) {
+        guard[i] = (char) LMQ_ARENA_CANARY;
+    }
+    if (arena->num_guards < LMQ_ARENA_MAX_GUARDS) {
+        arena->guards[arena->num_guards] = guard;
+        arena->guard_sizes[arena->num_guards] = guard_size;
+        arena->num_guards++;
+    }
+#endif
+
+    arena->cur = next;
 
     return now;
 }
 
+void* arena_alloc(arena_t* arena, const size_t n, const size_t element_size, const size_t alignment) {
+    return arena_alloc_offset(arena, n, element_size, alignment, 0);
+}
+
+size_t arena_mark(const arena_t* arena) {
+    return arena->cur - arena->start;
+}
+
+void arena_reset(arena_t* arena, const size_t mark) {
+    arena->cur = arena->start + mark;
+#ifdef LMQ_ARENA_DEBUG
+    while (arena->num_guards > 0 && arena->guards[arena->num_guards - 1] >= arena->cur) {
+        arena->num_guards--;
+    }
+#endif
+}
+
+size_t arena_used(const arena_t* arena) {
+    return arena->cur - arena->start;
+}
+
+int arena_check(const arena_t* arena) {
+    int corrupted = 0;
+#ifdef LMQ_ARENA_DEBUG
+    for (size_t g = 0; g < arena->num_guards; g++) {
+        for (size_t i = 0; i < arena->guard_sizes[g]; i++) {
+            if (arena->guards[g][i] != (char) LMQ_ARENA_CANARY) {
+                printf("arena_check: guard %d at %p was overwritten\n", g, arena->guards[g]);
+                corrupted++;
+                break;
+            }
+        }
+    }
+#else
+    (void) arena;
+#endif
+    return corrupted;
+}
+
+size_t tcdm_bank(const void* addr) {
+    return ((size_t) addr / LMQ_TCDM_BANK_WIDTH) % LMQ_TCDM_BANKS;
+}
+
+void* arena_alloc_bank(arena_t* arena, const size_t n, const size_t element_size, const size_t bank) {
+    return arena_alloc_offset(arena, n, element_size, LMQ_ALIGN_TCDM_BANK, bank * LMQ_TCDM_BANK_WIDTH);
+}
+
+int arena_alloc_streams(arena_t* arena, const size_t num_buffers, const size_t* sizes, double** buffers) {
+    size_t mark = arena_mark(arena);
+
+    for (size_t i = 0; i < num_buffers; i++) {
+        buffers[i] = arena_alloc_bank(arena, sizes[i], sizeof(double), i * LMQ_TCDM_BANKS / num_buffers);
+        if (buffers[i] == NULL) {
+            arena_reset(arena, mark);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+size_t local_range(const size_t n, const size_t core_idx, const size_t core_num, size_t* first) {
+    // The first 'leftover' cores get one more element
+    size_t local_n = n / core_num;
+    size_t leftover = n - local_n * core_num;
+    *first = core_idx * local_n + (core_idx < leftover ? core_idx : leftover);
+    return local_n + (core_idx < leftover ? 1 : 0);
+}
+
+void* allocate(const size_t n, const size_t element_size) {
+    return arena_alloc(arena_global(), n, element_size, LMQ_ALIGN_DOUBLE);
+}
+
 /*
  * Prints a matrix which is in the form [rows x columns] and row major inside arr.
  */
@@ -30,6 +160,48 @@ void print_matrix(const double* arr, const size_t rows, const size_t cols) {
     }
 }
 
+// Events of the two counters in every pass, the DMA only moves for the DM core
+static const enum snrt_perf_cnt_type perf_events[PERF_PASSES][2] = {
+    {SNRT_PERF_CNT_ISSUE_FPU_SEQ, SNRT_PERF_CNT_RETIRED_INSTR},
+    {SNRT_PERF_CNT_TCDM_ACCESSED, SNRT_PERF_CNT_TCDM_CONGESTED},
+    {SNRT_PERF_CNT_DMA_BUSY, SNRT_PERF_CNT_CYCLES},
+};
+
+void perf_start(const size_t pass, const uint32_t core_idx) {
+    snrt_reset_perf_counter(SNRT_PERF_CNT0);
+    snrt_reset_perf_counter(SNRT_PERF_CNT1);
+    snrt_start_perf_counter(SNRT_PERF_CNT0, perf_events[pass][0], core_idx);
+    snrt_start_perf_counter(SNRT_PERF_CNT1, perf_events[pass][1], core_idx);
+}
+
+void perf_stop(const size_t pass, perf_counters_t* counters) {
+    snrt_stop_perf_counter(SNRT_PERF_CNT0);
+    snrt_stop_perf_counter(SNRT_PERF_CNT1);
+    uint32_t first = snrt_get_perf_counter(SNRT_PERF_CNT0);
+    uint32_t second = snrt_get_perf_counter(SNRT_PERF_CNT1);
+
+    if (pass == 0) {
+        counters->fpu_issued += first;
+        counters->retired += second;
+    } else if (pass == 1) {
+        counters->tcdm_accessed += first;
+        counters->tcdm_congested += second;
+    } else {
+        counters->dma_busy += first;
+    }
+}
+
+void perf_print(const char* name, const size_t n, const size_t core_idx, const perf_counters_t* counters) {
+    double cycles = counters->cycles > 0 ? counters->cycles : 1;
+    double accessed = counters->tcdm_accessed > 0 ? counters->tcdm_accessed : 1;
+    printf("%s (core %d), size: %d: %lu cycles. fpu %.3f (%lu fp, %lu retired), tcdm %lu accesses (%.3f congested), "
+           "dma busy %lu, barrier wait %lu\n", name, core_idx, n, counters->cycles, counters->fpu_issued / cycles,
+           counters->fpu_issued, counters->retired, counters->tcdm_accessed, counters->tcdm_congested / accessed,
+           counters->dma_busy, counters->barrier_wait);
+}
+
+#endif // LMQ_HOST
+
 /*
  * Calculates an approximation of the square root of a.
  * Needed as the fsqrt instruction is not implemented on the snitch. 
@@ -41,3 +213,28 @@ double sqrt_approx(double a) {
     }
     return x;
 }
+
+static double rsqrt_seed(double a) {
+    union {
+        double value;
+        uint32_t words[2];
+    } bits = { .value = a };
+    uint32_t negative = -(bits.words[1] >> 31);
+    // The exponent (and the leading mantissa bits) halved and negated, a NaN for a < 0
+    bits.words[1] = ((RSQRT_MAGIC - (bits.words[1] >> 1)) & ~negative) | (0x7ff80000u & negative);
+    bits.words[0] = 0;
+    return bits.value;
+}
+
+double rsqrt_fast(double a) {
+    double y = rsqrt_seed(a);
+    double half = 0.5 * a;
+    for (int i = 0; i < RSQRT_STEPS; ++i) {
+        y = y * (1.5 - half * y * y);
+    }
+    return y;
+}
+
+double sqrt_fast(double a) {
+    return a * rsqrt_fast(a);
+}
@@ -1,4 +1,3 @@
-
 #ifndef LMQ_H
 #define LMQ_H
 
@@ -10,12 +9,135 @@
 extern int mcycle;
 
 /*
- * Pointer to the next free memory.
+ * Alignments (in bytes) that can be requested from an arena.
+ * The TCDM of the snitch cluster has 32 banks of 64 bit words. A buffer aligned to
+ * LMQ_ALIGN_TCDM_BANK starts at bank 0.
+ */
+#define LMQ_TCDM_BANKS 32
+#define LMQ_TCDM_BANK_WIDTH 8
+#define LMQ_ALIGN_DOUBLE 8
+#define LMQ_ALIGN_CACHE_LINE 64
+#define LMQ_ALIGN_TCDM_BANK (LMQ_TCDM_BANKS * LMQ_TCDM_BANK_WIDTH)
+
+/*
+ * Number of guard elements placed behind every allocation.
+ * This is to have some spacing as SSR sometimes writes one more
+ * element to the stream which may be outside an array.
+ */
+#ifndef LMQ_SSR_GUARD
+#define LMQ_SSR_GUARD 1
+#endif
+
+/*
+ * Size (in bytes) of the L1 arena. It is taken from snrt_l1alloc on first use.
+ */
+#ifndef LMQ_L1_ARENA_SIZE
+#define LMQ_L1_ARENA_SIZE (32 * 1024)
+#endif
+
+/*
+ * Maximal number of guards which are tracked in debug mode (LMQ_ARENA_DEBUG).
+ */
+#ifndef LMQ_ARENA_MAX_GUARDS
+#define LMQ_ARENA_MAX_GUARDS 64
+#endif
+
+/*
+ * Byte pattern written into the guard elements in debug mode.
+ */
+#define LMQ_ARENA_CANARY 0xA5
+
+/*
+ * A bump allocator on [start, end) which can be reset to a previous mark.
+ * Not thread safe: only one core may allocate from an arena at a time.
+ */
+typedef struct {
+    char* start;
+    char* end;
+    char* cur;
+#ifdef LMQ_ARENA_DEBUG
+    size_t num_guards;
+    char* guards[LMQ_ARENA_MAX_GUARDS];
+    size_t guard_sizes[LMQ_ARENA_MAX_GUARDS];
+#endif
+} arena_t;
+
+void arena_init(arena_t* arena, void* start, const size_t size);
+
+/*
+ * Arena on the global memory (snrt_global_memory) and on L1 (TCDM).
+ */
+arena_t* arena_global();
+arena_t* arena_l1();
+
+/*
+ * Allocates n * element_size bytes aligned to alignment (a power of two) followed by
+ * LMQ_SSR_GUARD guard elements. Returns NULL if the arena is exhausted.
+ */
+void* arena_alloc(arena_t* arena, const size_t n, const size_t element_size, const size_t alignment);
+
+/*
+ * Returns a mark of the current state. Resetting to it frees everything allocated after the mark.
+ */
+size_t arena_mark(const arena_t* arena);
+void arena_reset(arena_t* arena, const size_t mark);
+
+/*
+ * Number of bytes in use.
+ */
+size_t arena_used(const arena_t* arena);
+
+/*
+ * Debug mode only (LMQ_ARENA_DEBUG): checks that no guard element was overwritten (f.ex. by SSR)
+ * and returns the number of corrupted guards. Returns 0 otherwise.
+ */
+int arena_check(const arena_t* arena);
+
+/*
+ * Returns the TCDM bank the address addr is mapped to.
+ */
+size_t tcdm_bank(const void* addr);
+
+/*
+ * Allocates n * element_size bytes starting at the TCDM bank bank (< LMQ_TCDM_BANKS).
+ * Returns NULL if the arena is exhausted.
+ */
+void* arena_alloc_bank(arena_t* arena, const size_t n, const size_t element_size, const size_t bank);
+
+/*
+ * Allocates num_buffers buffers of sizes[i] doubles and stores them in buffers.
+ * The start banks are spread evenly over the TCDM so that SSR streams walking the
+ * buffers in lockstep (f.ex. a, b and result of add_ssr_parallel) do not hit the same bank.
+ * Returns 0 on success and 1 if the arena is exhausted.
+ */
+int arena_alloc_streams(arena_t* arena, const size_t num_buffers, const size_t* sizes, double** buffers);
+
+/*
+ * Two float32 values packed into one 64 bit FP register, as used by the packed SIMD
+ * instructions (vfadd.s, vfmac.s, ...). Packed streams read and write whole 64 bit words,
+ * so float arrays must be 8 byte aligned (allocate guarantees that).
+ */
+typedef union {
+    double d;
+    float f[2];
+} f32x2_t;
+
+/*
+ * The elementwise and activation kernels (and softmax and cumsum) may run in place, i.e. with result == arr
+ * (or with result == a or b). Partially overlapping buffers are not supported.
+ * Every pass pops an element from its read streams before it pushes the result of that element and a later
+ * pass does not read the input again once the result is written. Double streams stop at their bound, the
+ * extra element of a float stream (src/bugs/ssr_anomaly.c) is avoided by streaming packed pairs.
  */
-extern void* cur_memory;
 
 /*
- * Allocates n * element_size bytes of memory.
+ * Splits n elements into core_num contiguous ranges which differ by at most one element.
+ * Returns the length of the range of core core_idx and sets first to its first element.
+ */
+size_t local_range(const size_t n, const size_t core_idx, const size_t core_num, size_t* first);
+
+/*
+ * Allocates n * element_size bytes of memory from the global arena.
  */
 void* allocate(const size_t n, const size_t element_size);
 
@@ -24,10 +146,55 @@ void* allocate(const size_t n, const size_t element_size);
  */
 void print_matrix(const double* arr, const size_t rows, const size_t cols);
 
+/*
+ * Events of one core counted by the performance counters of the cluster peripheral (RTL only, they read 0
+ * on banshee) and cycles taken with mcycle. The cluster has two counters, so the events are counted in
+ * PERF_PASSES runs of the region, each for one core at a time.
+ */
+typedef struct {
+    uint32_t cycles;          // inside the region
+    uint32_t barrier_wait;    // from leaving the region to leaving the closing barrier
+    uint32_t retired;         // retired instructions of the integer core
+    uint32_t fpu_issued;      // FP instructions issued to the FPU, FREP repetitions included
+    uint32_t tcdm_accessed;   // TCDM accesses of the core and its SSRs
+    uint32_t tcdm_congested;  // TCDM accesses stalled by a bank conflict, they are what stalls the SSR streams
+    uint32_t dma_busy;        // cycles the DMA was busy (DM core only)
+} perf_counters_t;
+
+#define PERF_PASSES 3
+
+/*
+ * Resets the two counters and starts them on the events of pass for core core_idx.
+ * perf_stop stops them and adds the events to counters. Called by one core around the region.
+ */
+void perf_start(const size_t pass, const uint32_t core_idx);
+void perf_stop(const size_t pass, perf_counters_t* counters);
+
+/*
+ * Prints the events of core core_idx as "<name> (core c), size: <n>: <cycles> cycles. ..." with the FPU
+ * utilisation (FP instructions per cycle) and the share of congested TCDM accesses.
+ */
+void perf_print(const char* name, const size_t n, const size_t core_idx, const perf_counters_t* counters);
+
 /*
  * Calculates an approximation of the square root of a.
  * Needed as the fsqrt instruction is not implemented on the snitch. 
+ * Five Newton steps from 1, so it is only accurate for a around 1; the benchmark shapes are derived with it.
  */
 double sqrt_approx(double a);
 
+/*
+ * 1 / sqrt(a) and sqrt(a) = a / sqrt(a) without a division: the seed of 1 / sqrt(a) is RSQRT_MAGIC minus
+ * half the high word of a (the exponent and the leading mantissa bits, relative error below 3.5%, a NaN for
+ * a < 0), RSQRT_STEPS Newton steps y (3/2 - a/2 y^2) refine it to RSQRT_MAX_ULP ulp of the correctly rounded
+ * result for normal a > 0 (rsqrt_fast is within 2 ulp, the product of sqrt_fast adds one rounding).
+ * sqrt_fast(0) is 0, rsqrt_fast(0) is large but finite.
+ */
+#define RSQRT_MAGIC 0x5fe6eb50u
+#define RSQRT_STEPS 4
+#define RSQRT_MAX_ULP 3
+
+double rsqrt_fast(double a);
+double sqrt_fast(double a);
+
 #endif
@@ -0,0 +1,153 @@
+#include "lut.h"
+
+#include <snrt.h>
+
+#include <math.h>
+
+size_t lut_size(double lo, double hi, double d2_max, double max_error) {
+    double h = sqrt(8.0 * max_error / d2_max);
+    return (size_t) ceil((hi - lo) / h) + 1;
+}
+
+int lut_init(lut_t* lut, double (*f)(double), double lo, double hi, size_t size, double ramp) {
+    int status = 0;
+
+    // Any core may be the first one to call, so build only once
+    if (lut->table != NULL) {
+        return 0;
+    }
+
+    snrt_mutex_lock(snrt_mutex());
+    if (lut->table == NULL) {
+        if (ramp != 0.0 && size % 2 == 0) {
+            size++;
+        }
+
+        double* table = snrt_l1alloc(2 * size * sizeof(double));
+        if (table == NULL) {
+            status = -1;
+        } else {
+            double scale = (size - 1) / (hi - lo);
+            double previous = f(lo) - ramp * fmax(lo, 0.0);
+
+            for (size_t k = 0; k + 1 < size; k++) {
+                double knot = k + 1 == size - 1 ? hi : lo + (k + 1) / scale;
+                double value = f(knot) - ramp * fmax(knot, 0.0);
+                table[2 * k] = previous;
+                table[2 * k + 1] = value - previous;
+                previous = value;
+            }
+            // x = hi gives the last knot, its slope is never used
+            table[2 * (size - 1)] = previous;
+            table[2 * (size - 1) + 1] = 0.0;
+
+            lut->lo = lo;
+            lut->hi = hi;
+            lut->scale = scale;
+            lut->ramp = ramp;
+            lut->size = size;
+            lut->table = table;
+        }
+    }
+    snrt_mutex_release(snrt_mutex());
+
+    return status;
+}
+
+void lut_eval(const lut_t* lut, const double* x, const size_t n, double* result) {
+    if (n == 0) {
+        return;
+    }
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*x));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) x);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
+
+    snrt_ssr_enable();
+
+    // u = (clamp(x) - lo) * scale, the knot k = floor(u) is at table + 16 k
+    for (size_t i = 0; i < n; i++) {
+        size_t entry;
+        asm volatile(
+            "fmv.d ft3, ft0 \n"
+            "fmax.d ft4, ft3, %[lo] \n"
+            "fmin.d ft4, ft4, %[hi] \n"
+            "fsub.d ft4, ft4, %[lo] \n"
+            "fmul.d ft4, ft4, %[scale] \n"
+            "fcvt.w.d %[entry], ft4, rtz \n"
+            "fcvt.d.w ft5, %[entry] \n"
+            "fsub.d ft4, ft4, ft5 \n"
+            "slli %[entry], %[entry], 4 \n"
+            "add %[entry], %[entry], %[table] \n"
+            "fld ft5, 0(%[entry]) \n"
+            "fld ft6, 8(%[entry]) \n"
+            "fmadd.d ft5, ft4, ft6, ft5 \n"
+            "fmax.d ft3, ft3, %[zero] \n"
+            "fmadd.d ft1, ft3, %[ramp], ft5 \n"
+            : [entry] "=&r"(entry)
+            : [lo] "f"(lut->lo), [hi] "f"(lut->hi), [scale] "f"(lut->scale), [ramp] "f"(lut->ramp),
+              [zero] "f"(0.0), [table] "r"(lut->table)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "memory"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+void lut_eval_exp2(const lut_t* lut, const double* x, double scale, const size_t n, double* result) {
+    // 2^m is built in memory, the core has no move from two integer registers to a double
+    volatile uint32_t power[2] __attribute__((aligned(8))) = {0, 0};
+
+    if (n == 0) {
+        return;
+    }
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*x));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) x);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
+
+    snrt_ssr_enable();
+
+    // t = scale * x = m + r with m = floor(t), 2^t = 2^m * table(r)
+    for (size_t i = 0; i < n; i++) {
+        size_t entry, m;
+        asm volatile(
+            "fmul.d ft3, ft0, %[scale] \n"
+            "fmax.d ft3, ft3, %[t_lo] \n"
+            "fmin.d ft3, ft3, %[t_hi] \n"
+            "fcvt.w.d %[m], ft3, rdn \n"
+            "fcvt.d.w ft4, %[m] \n"
+            "fsub.d ft3, ft3, ft4 \n"
+            "fmul.d ft3, ft3, %[lut_scale] \n"
+            "fcvt.w.d %[entry], ft3, rtz \n"
+            "fcvt.d.w ft4, %[entry] \n"
+            "fsub.d ft3, ft3, ft4 \n"
+            "slli %[entry], %[entry], 4 \n"
+            "add %[entry], %[entry], %[table] \n"
+            "addi %[m], %[m], 1023 \n"
+            "slli %[m], %[m], 20 \n"
+            "sw %[m], 4(%[power]) \n"
+            "fld ft4, 0(%[entry]) \n"
+            "fld ft5, 8(%[entry]) \n"
+            "fld ft6, 0(%[power]) \n"
+            "fmadd.d ft4, ft3, ft5, ft4 \n"
+            "fmul.d ft1, ft4, ft6 \n"
+            : [entry] "=&r"(entry), [m] "=&r"(m)
+            : [scale] "f"(scale), [t_lo] "f"(-1022.0), [t_hi] "f"(1023.0), [lut_scale] "f"(lut->scale),
+              [table] "r"(lut->table), [power] "r"(power)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "memory"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
@@ -0,0 +1,56 @@
+#ifndef LMQ_LUT_H
+#define LMQ_LUT_H
+
+#include <snrt.h>
+
+/*
+ * Lookup table activations for inference, where a few digits are enough.
+ * A table holds size knots of f on [lo, hi] as (value, slope) pairs in L1 and is evaluated with
+ * linear interpolation. The index is computed in the integer core (fcvt.w.d), the input and the
+ * result are streamed through ft0 and ft1.
+ *
+ * Linear interpolation of f with |f''| <= d2_max and knot distance h is off by at most h^2 / 8 * d2_max,
+ * lut_size gives the number of knots for an error bound. Inputs outside [lo, hi] take the value at the border.
+ */
+
+/*
+ * Default error bound of the tables of the *_lut kernels. Their domains are wide enough for bounds down to 1e-6.
+ */
+#ifndef LUT_MAX_ERROR
+#define LUT_MAX_ERROR 1e-4
+#endif
+
+typedef struct {
+    double lo, hi;
+    double scale;           // (size - 1) / (hi - lo)
+    double ramp;            // the result is table(x) + ramp * max(x, 0)
+    size_t size;
+    double* table;          // NULL until the table is built
+} lut_t;
+
+/*
+ * Number of knots on [lo, hi] which keep the interpolation error of a function with |f''| <= d2_max
+ * below max_error.
+ */
+size_t lut_size(double lo, double hi, double d2_max, double max_error);
+
+/*
+ * Builds the table of f(x) - ramp * max(x, 0) on [lo, hi] with size >= 2 knots in L1 (f is called size times).
+ * A ramp keeps functions like gelu bounded outside of the domain, for ramp != 0 the size is made odd
+ * so a knot sits on the kink at 0 of a symmetric domain. Only the first call for lut builds,
+ * so every core can call it before using the table. Returns -1 if L1 is exhausted.
+ */
+int lut_init(lut_t* lut, double (*f)(double), double lo, double hi, size_t size, double ramp);
+
+/*
+ * result[i] = table(x[i]) for n elements.
+ */
+void lut_eval(const lut_t* lut, const double* x, const size_t n, double* result);
+
+/*
+ * result[i] = 2^(scale * x[i]) for a table of 2^r on [0, 1]: the integer part of scale * x is added
+ * to the exponent (scale * x is clamped to [-1022, 1023]), the relative error is the one of the table.
+ */
+void lut_eval_exp2(const lut_t* lut, const double* x, double scale, const size_t n, double* result);
+
+#endif
@@ -0,0 +1,311 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "multi.h"
+#include "gemm.h"
+#include "conv.h"
+#include "sum.h"
+#include "cumsum.h"
+
+static volatile size_t multi_num_clusters = 0;
+
+// L1 scratch of every cluster
+static double* multi_scratch[MULTI_MAX_CLUSTERS];
+
+// Partials of the compute cores of every cluster and of the clusters
+static double multi_core_partials[MULTI_MAX_CLUSTERS][MULTI_MAX_CORES];
+static double multi_cluster_partials[MULTI_MAX_CLUSTERS];
+
+// Doubles of the L1 scratch
+#define MULTI_L1_DOUBLES (MULTI_L1_SIZE / sizeof(double))
+
+void multi_set_clusters(size_t clusters) {
+    multi_num_clusters = clusters;
+}
+
+size_t multi_clusters() {
+    size_t all = snrt_cluster_num();
+    return multi_num_clusters > 0 && multi_num_clusters < all ? multi_num_clusters : all;
+}
+
+/*
+ * The L1 scratch of the calling cluster, allocated by its core 0 on the first call.
+ * Must be called by all cores of the cluster.
+ */
+static double* multi_l1() {
+    size_t cluster = snrt_cluster_idx();
+    if (snrt_cluster_core_idx() == 0 && multi_scratch[cluster] == NULL) {
+        multi_scratch[cluster] = snrt_l1alloc(MULTI_L1_SIZE);
+    }
+    snrt_cluster_hw_barrier();
+    return multi_scratch[cluster];
+}
+
+/*
+ * The share of the calling cluster of n items, none for the clusters after multi_clusters().
+ */
+static size_t multi_share(size_t n, size_t* first) {
+    size_t cluster = snrt_cluster_idx();
+    size_t clusters = multi_clusters();
+    *first = 0;
+    return cluster < clusters ? local_range(n, cluster, clusters, first) : 0;
+}
+
+static inline size_t multi_min(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+/*
+ * Elementwise over the share of the cluster in chunks: the DM core writes the results of the previous chunk and
+ * loads the next chunk, then the compute cores run kernel on their part of the chunk.
+ */
+static int multi_elementwise(tile_unary_kernel_t unary, tile_binary_kernel_t binary, double* a, double* b,
+                             const size_t n, double* result) {
+    double* l1 = multi_l1();
+    size_t buffers = binary ? 3 : 2;
+    size_t chunk = MULTI_L1_DOUBLES / buffers - LMQ_SSR_GUARD;
+    double* la = l1;
+    double* lb = l1 + (chunk + LMQ_SSR_GUARD);
+    double* lr = l1 + (buffers - 1) * (chunk + LMQ_SSR_GUARD);
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+    int ret = 0;
+
+    size_t first;
+    size_t count = multi_share(n, &first);
+    for (size_t done = 0; done < count; done += chunk) {
+        size_t len = multi_min(chunk, count - done);
+        if (snrt_is_dm_core()) {
+            if (done > 0) {
+                snrt_dma_start_1d(result + first + done - chunk, lr, chunk * sizeof(double));
+            }
+            snrt_dma_start_1d(la, a + first + done, len * sizeof(double));
+            if (binary) {
+                snrt_dma_start_1d(lb, b + first + done, len * sizeof(double));
+            }
+            snrt_dma_wait_all();
+        }
+        snrt_cluster_hw_barrier();
+        if (!snrt_is_dm_core()) {
+            size_t f;
+            size_t c = local_range(len, core_idx, core_num, &f);
+            if (c > 0) {
+                ret = binary ? binary(la + f, lb + f, c, lr + f) : unary(la + f, c, lr + f);
+            }
+        }
+        snrt_cluster_hw_barrier();
+    }
+    if (snrt_is_dm_core() && count > 0) {
+        size_t last = (count - 1) / chunk * chunk;
+        snrt_dma_start_1d(result + first + last, lr, (count - last) * sizeof(double));
+        snrt_dma_wait_all();
+    }
+    return ret;
+}
+
+int multi_unary(tile_unary_kernel_t kernel, double* arr, const size_t n, double* result) {
+    return multi_elementwise(kernel, NULL, arr, NULL, n, result);
+}
+
+int multi_binary(tile_binary_kernel_t kernel, double* a, double* b, const size_t n, double* result) {
+    return multi_elementwise(NULL, kernel, a, b, n, result);
+}
+
+int multi_gemm(double* a, double* b, const size_t m, const size_t n, const size_t k, double* result) {
+    double* l1 = multi_l1();
+    size_t capacity = MULTI_L1_DOUBLES - 3 * LMQ_SSR_GUARD;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+    int ret = 0;
+
+    size_t first;
+    size_t count = multi_share(m, &first);
+
+    // b next to blocks of rows of a and of the result if possible
+    int b_in_l1 = n * k + n + k <= capacity;
+    size_t block = (capacity - (b_in_l1 ? n * k : 0)) / (n + k);
+    if (block == 0) {
+        // not even a row fits, the compute cores work on global memory
+        if (!snrt_is_dm_core()) {
+            size_t f;
+            size_t c = local_range(count, core_idx, core_num, &f);
+            if (c > 0) {
+                ret = gemm_ssr_frep(a + (first + f) * n, b, c, n, k, result + (first + f) * k);
+            }
+        }
+        return ret;
+    }
+    double* lb = b_in_l1 ? l1 : b;
+    double* la = l1 + (b_in_l1 ? n * k + LMQ_SSR_GUARD : 0);
+    double* lr = la + block * n + LMQ_SSR_GUARD;
+
+    if (b_in_l1 && count > 0 && snrt_is_dm_core()) {
+        snrt_dma_start_1d(lb, b, n * k * sizeof(double));
+    }
+    for (size_t done = 0; done < count; done += block) {
+        size_t rows = multi_min(block, count - done);
+        if (snrt_is_dm_core()) {
+            if (done > 0) {
+                snrt_dma_start_1d(result + (first + done - block) * k, lr, block * k * sizeof(double));
+            }
+            snrt_dma_start_1d(la, a + (first + done) * n, rows * n * sizeof(double));
+            snrt_dma_wait_all();
+        }
+        snrt_cluster_hw_barrier();
+        if (!snrt_is_dm_core()) {
+            size_t f;
+            size_t c = local_range(rows, core_idx, core_num, &f);
+            if (c > 0) {
+                ret = gemm_ssr_frep(la + f * n, lb, c, n, k, lr + f * k);
+            }
+        }
+        snrt_cluster_hw_barrier();
+    }
+    if (snrt_is_dm_core() && count > 0) {
+        size_t last = (count - 1) / block * block;
+        snrt_dma_start_1d(result + (first + last) * k, lr, (count - last) * k * sizeof(double));
+        snrt_dma_wait_all();
+    }
+    return ret;
+}
+
+int multi_conv(double* a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result) {
+    double* l1 = multi_l1();
+    size_t capacity = MULTI_L1_DOUBLES - 3 * LMQ_SSR_GUARD;
+    size_t span = (filter_size - 1) * dilation + 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+    int ret = 0;
+
+    // chunk outputs need (chunk - 1) * stride + span inputs
+    if (filter_size + span + 1 > capacity) {
+        return -1;
+    }
+    size_t chunk = (capacity - filter_size - span + stride) / (stride + 1);
+    double* lf = l1;
+    double* la = lf + filter_size + LMQ_SSR_GUARD;
+    double* lr = la + (chunk - 1) * stride + span + LMQ_SSR_GUARD;
+
+    size_t first;
+    size_t count = multi_share(conv_output_size(n, filter_size, stride, dilation), &first);
+    if (count > 0 && snrt_is_dm_core()) {
+        snrt_dma_start_1d(lf, filter, filter_size * sizeof(double));
+    }
+    for (size_t done = 0; done < count; done += chunk) {
+        size_t len = multi_min(chunk, count - done);
+        if (snrt_is_dm_core()) {
+            if (done > 0) {
+                snrt_dma_start_1d(result + first + done - chunk, lr, chunk * sizeof(double));
+            }
+            snrt_dma_start_1d(la, a + (first + done) * stride, ((len - 1) * stride + span) * sizeof(double));
+            snrt_dma_wait_all();
+        }
+        snrt_cluster_hw_barrier();
+        if (!snrt_is_dm_core()) {
+            size_t f;
+            size_t c = local_range(len, core_idx, core_num, &f);
+            if (c > 0) {
+                ret = conv_ssr_frep(la + f * stride, lf, (c - 1) * stride + span, filter_size, stride, dilation, lr + f);
+            }
+        }
+        snrt_cluster_hw_barrier();
+    }
+    if (snrt_is_dm_core() && count > 0) {
+        size_t last = (count - 1) / chunk * chunk;
+        snrt_dma_start_1d(result + first + last, lr, (count - last) * sizeof(double));
+        snrt_dma_wait_all();
+    }
+    return ret;
+}
+
+/*
+ * Without result: the sum of the share of the cluster, in multi_cluster_partials after the global barrier
+ * it ends with. With result: the scan of the share, starting at the sum of the shares of the clusters before.
+ */
+static void multi_scan(double* arr, const size_t n, double* result) {
+    double* l1 = multi_l1();
+    size_t chunk = MULTI_L1_DOUBLES / 2 - LMQ_SSR_GUARD;
+    double* la = l1;
+    double* lr = l1 + chunk + LMQ_SSR_GUARD;
+    size_t cluster = snrt_cluster_idx();
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+
+    double offset = 0.0;
+    if (result != NULL) {
+        for (size_t c = 0; c < cluster && c < multi_clusters(); c++) {
+            offset += multi_cluster_partials[c];
+        }
+    }
+
+    double total = 0.0;
+    size_t first;
+    size_t count = multi_share(n, &first);
+    for (size_t done = 0; done < count; done += chunk) {
+        size_t len = multi_min(chunk, count - done);
+        if (snrt_is_dm_core()) {
+            if (result != NULL && done > 0) {
+                snrt_dma_start_1d(result + first + done - chunk, lr, chunk * sizeof(double));
+            }
+            snrt_dma_start_1d(la, arr + first + done, len * sizeof(double));
+            snrt_dma_wait_all();
+        }
+        snrt_cluster_hw_barrier();
+        size_t f = 0;
+        size_t c = 0;
+        if (!snrt_is_dm_core()) {
+            double partial = 0.0;
+            c = local_range(len, core_idx, core_num, &f);
+            if (c > 0) {
+                sum_ssr_frep(la + f, c, &partial);
+            }
+            multi_core_partials[cluster][core_idx] = partial;
+        }
+        snrt_cluster_hw_barrier();
+        // every core adds the partials in the same order, before is the sum up to its part
+        double before = offset + total;
+        for (size_t j = 0; j < core_num; j++) {
+            if (j < core_idx) {
+                before += multi_core_partials[cluster][j];
+            }
+            total += multi_core_partials[cluster][j];
+        }
+        if (result != NULL) {
+            if (c > 0) {
+                // the scan of the part starts at the sum of everything before it
+                la[f] += before;
+                cumsum_ssr_frep(la + f, c, lr + f);
+            }
+            snrt_cluster_hw_barrier();
+        }
+    }
+    if (result != NULL && snrt_is_dm_core() && count > 0) {
+        size_t last = (count - 1) / chunk * chunk;
+        snrt_dma_start_1d(result + first + last, lr, (count - last) * sizeof(double));
+        snrt_dma_wait_all();
+    }
+
+    if (result == NULL && core_idx == 0) {
+        multi_cluster_partials[cluster] = total;
+    }
+    snrt_global_barrier();
+}
+
+int multi_sum(double* arr, const size_t n, double* result) {
+    multi_scan(arr, n, NULL);
+    if (snrt_global_core_idx() == 0) {
+        double sum = 0.0;
+        for (size_t c = 0; c < multi_clusters(); c++) {
+            sum += multi_cluster_partials[c];
+        }
+        *result = sum;
+    }
+    return 0;
+}
+
+int multi_cumsum(double* arr, const size_t n, double* result) {
+    // the sums of the shares first, then every cluster scans its share from the sum of the shares before
+    multi_scan(arr, n, NULL);
+    multi_scan(arr, n, result);
+    return 0;
+}
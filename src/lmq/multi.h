@@ -0,0 +1,64 @@
+#ifndef LMQ_MULTI_H
+#define LMQ_MULTI_H
+
+#include <snrt.h>
+
+#include "tile.h"
+#include "fpmath.h"
+
+/*
+ * Multi-cluster execution: the work is split over the clusters (local_range over multi_clusters() clusters)
+ * and every cluster splits its share over its compute cores. The DM core of a cluster moves the share in
+ * chunks into the L1 of its cluster (MULTI_L1_SIZE bytes), the compute cores run the single core SSR+FREP
+ * kernels on the chunk in L1 and the DM core writes the results back while it loads the next chunk.
+ * Reductions and scans combine the partials of the clusters after a global barrier.
+ *
+ * The cluster level helpers of reduce.h, tile.h and arena_l1 keep their state in global memory for one
+ * cluster, so all state here is per cluster (MULTI_MAX_CLUSTERS) and only cluster barriers are used inside a
+ * cluster. The kernels of multi_unary and multi_binary must not use these helpers either, the fpmath kernels
+ * (f.ex. sigmoid_ssr_frep) may: their carry scratch is per cluster (FPMATH_MAX_CLUSTERS). All functions must be called by all cores of all clusters (including the DM cores).
+ * Except for multi_sum and multi_cumsum the results are complete after the next global barrier.
+ */
+#ifndef MULTI_L1_SIZE
+#define MULTI_L1_SIZE (32 * 1024)
+#endif
+
+#define MULTI_MAX_CLUSTERS 16
+#define MULTI_MAX_CORES 16
+
+#if MULTI_MAX_CLUSTERS > FPMATH_MAX_CLUSTERS
+#error "MULTI_MAX_CLUSTERS exceeds the clusters of the fpmath carry scratch"
+#endif
+
+/*
+ * Number of clusters the multi_* functions use, all clusters by default. The others only take part in the
+ * global barriers, f.ex. to measure the scaling in one binary. Must be set by all cores.
+ */
+void multi_set_clusters(size_t clusters);
+size_t multi_clusters();
+
+/*
+ * Elementwise kernels, f.ex. multi_binary(add_ssr_frep, a, b, n, result).
+ */
+int multi_unary(tile_unary_kernel_t kernel, double* arr, const size_t n, double* result);
+int multi_binary(tile_binary_kernel_t kernel, double* a, double* b, const size_t n, double* result);
+
+/*
+ * a (m x n) times b (n x k) with the rows of the result split over the clusters. Every cluster copies b into its
+ * L1 if b and a block of rows fit next to it and reads b from global memory otherwise.
+ */
+int multi_gemm(double* a, double* b, const size_t m, const size_t n, const size_t k, double* result);
+
+/*
+ * 1D convolution (see conv_ssr_frep in conv.h) with the outputs split over the clusters.
+ */
+int multi_conv(double* a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
+
+/*
+ * Sum and inclusive cumulative sum of n elements. The result of multi_sum is written by global core 0,
+ * both return after a global barrier.
+ */
+int multi_sum(double* arr, const size_t n, double* result);
+int multi_cumsum(double* arr, const size_t n, double* result);
+
+#endif
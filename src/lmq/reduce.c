@@ -0,0 +1,231 @@
+#include "reduce.h"
+
+#include <snrt.h>
+
+#include <math.h>
+
+typedef struct {
+    double value;
+    int index;
+} reduce_slot_t;
+
+// Shared between all cores of the cluster, two sets of slots and the number of calls of every core
+reduce_slot_t* reduce_slots = NULL;
+size_t* reduce_calls = NULL;
+
+// Two sets (by the parity of the call) of two buffers (swapped every step) of the scan
+double* scan_slots = NULL;
+
+typedef struct {
+    reduce_slot_t partial;
+    // Number of the call of which partial is complete, calls counts the calls of the own core
+    size_t ready;
+    size_t calls;
+} reduce_team_slot_t;
+
+// A slot for every compute core and one more for the result of reduce_team, then the slots of scan_team
+reduce_team_slot_t* reduce_team_slots = NULL;
+reduce_team_slot_t* scan_team_slots = NULL;
+
+static void reduce_init(size_t core_num) {
+    // Any core may be the first one to reduce, so allocate only once
+    if (reduce_slots == NULL) {
+        snrt_mutex_lock(snrt_mutex());
+        if (reduce_slots == NULL) {
+            reduce_calls = snrt_l1alloc(core_num * sizeof(size_t));
+            for (size_t i = 0; i < core_num; i++) {
+                reduce_calls[i] = 0;
+            }
+            scan_slots = snrt_l1alloc(4 * core_num * sizeof(double));
+            reduce_team_slots = snrt_l1alloc((2 * core_num + 1) * sizeof(reduce_team_slot_t));
+            scan_team_slots = reduce_team_slots + core_num + 1;
+            for (size_t i = 0; i < 2 * core_num + 1; i++) {
+                reduce_team_slots[i].ready = 0;
+                reduce_team_slots[i].calls = 0;
+            }
+            // Set last, the other cores skip the initialization once it is set
+            reduce_slots = snrt_l1alloc(2 * core_num * sizeof(reduce_slot_t));
+        }
+        snrt_mutex_release(snrt_mutex());
+    }
+}
+
+/*
+ * Combines b into a.
+ */
+static inline void reduce_combine(reduce_op_t op, reduce_slot_t* a, const reduce_slot_t* b) {
+    switch (op) {
+    case REDUCE_SUM:
+        a->value += b->value;
+        break;
+    case REDUCE_MAX:
+        a->value = fmax(a->value, b->value);
+        break;
+    case REDUCE_MIN:
+        a->value = fmin(a->value, b->value);
+        break;
+    // Equal values keep the smaller (the larger for REDUCE_ARGMAX_LAST) index, whichever core holds it
+    case REDUCE_ARGMAX:
+        if (b->index >= 0 && (a->index < 0 || b->value > a->value || (b->value == a->value && b->index < a->index))) {
+            a->value = b->value;
+            a->index = b->index;
+        }
+        break;
+    case REDUCE_ARGMAX_LAST:
+        if (b->index >= 0 && (a->index < 0 || b->value > a->value || (b->value == a->value && b->index > a->index))) {
+            a->value = b->value;
+            a->index = b->index;
+        }
+        break;
+    }
+}
+
+double reduce_cluster(reduce_op_t op, double value, int index, int* result_index) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    int is_dm = snrt_is_dm_core();
+
+    reduce_init(core_num);
+
+    /*
+     * Consecutive calls use the other set of slots: a core which already left the last combine step
+     * may write its next partial while core 0 is still reading the partial of core core_num / 2.
+     */
+    reduce_slot_t* slots = reduce_slots;
+    if (!is_dm) {
+        slots += (reduce_calls[core_idx]++ % 2) * core_num;
+        slots[core_idx].value = value;
+        slots[core_idx].index = index;
+    }
+
+    // In step s core i (a multiple of 2 * stride) combines the partial of core i + stride into its own
+    for (size_t stride = 1; stride < core_num; stride *= 2) {
+        snrt_cluster_hw_barrier();
+        if (!is_dm && core_idx % (2 * stride) == 0 && core_idx + stride < core_num) {
+            reduce_combine(op, &slots[core_idx], &slots[core_idx + stride]);
+        }
+    }
+
+    if (core_idx != 0) {
+        return 0.0;
+    }
+
+    if (result_index != NULL) {
+        *result_index = slots[0].index;
+    }
+
+    return slots[0].value;
+}
+
+double reduce_team(reduce_op_t op, double value, int index, int* result_index) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    reduce_init(core_num);
+
+    volatile reduce_team_slot_t* slots = reduce_team_slots;
+    volatile reduce_team_slot_t* done = &reduce_team_slots[core_num];
+    size_t call = ++slots[core_idx].calls;
+
+    // Like reduce_cluster, but core i combines the partial of core i + stride as soon as it is complete
+    reduce_slot_t partial = {value, index};
+    for (size_t stride = 1; stride < core_num && core_idx % (2 * stride) == 0; stride *= 2) {
+        size_t partner = core_idx + stride;
+        if (partner < core_num) {
+            while (slots[partner].ready != call) {
+            }
+            reduce_slot_t other = {slots[partner].partial.value, slots[partner].partial.index};
+            reduce_combine(op, &partial, &other);
+        }
+    }
+
+    volatile reduce_team_slot_t* own = core_idx == 0 ? done : &slots[core_idx];
+    own->partial.value = partial.value;
+    own->partial.index = partial.index;
+    // The FPU stores asynchronously, the flag must not become visible before the value
+    snrt_fpu_fence();
+    own->ready = call;
+
+    // Every partial of this call has been read once core 0 published the result
+    while (done->ready != call) {
+    }
+
+    if (result_index != NULL) {
+        *result_index = done->partial.index;
+    }
+    return done->partial.value;
+}
+
+double scan_cluster(double value, double* total) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    int is_dm = snrt_is_dm_core();
+
+    reduce_init(core_num);
+
+    // Both calls share reduce_calls, every call of one of them advances the parity
+    double* cur = scan_slots;
+    double* next = scan_slots + core_num;
+    if (!is_dm) {
+        size_t set = (reduce_calls[core_idx]++ % 2) * 2 * core_num;
+        cur += set;
+        next += set;
+        cur[core_idx] = value;
+    }
+
+    // After step s cur holds the sums of the 2 * stride values up to every core
+    for (size_t stride = 1; stride < core_num; stride *= 2) {
+        snrt_cluster_hw_barrier();
+        if (!is_dm) {
+            if (core_idx >= stride) {
+                value += cur[core_idx - stride];
+            }
+            next[core_idx] = value;
+        }
+        double* tmp = cur;
+        cur = next;
+        next = tmp;
+    }
+    snrt_cluster_hw_barrier();
+
+    if (is_dm) {
+        return 0.0;
+    }
+
+    if (total != NULL) {
+        *total = cur[core_num - 1];
+    }
+    return core_idx > 0 ? cur[core_idx - 1] : 0.0;
+}
+
+double scan_team(double value, double* total) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    reduce_init(core_num);
+
+    volatile reduce_team_slot_t* slots = scan_team_slots;
+    size_t call = ++slots[core_idx].calls;
+
+    slots[core_idx].partial.value = value;
+    snrt_fpu_fence();
+    slots[core_idx].ready = call;
+
+    // For a cluster of a few cores summing the lower slots in order beats the flags of a tree
+    double prefix = 0.0;
+    for (size_t i = 0; i < core_idx; i++) {
+        while (slots[i].ready != call) {
+        }
+        prefix += slots[i].partial.value;
+    }
+
+    /*
+     * reduce_team returns once all cores called it, i.e. after all cores read the slots of this call,
+     * so the next call may overwrite them.
+     */
+    double sum = reduce_team(REDUCE_SUM, value, 0, NULL);
+    if (total != NULL) {
+        *total = sum;
+    }
+    return prefix;
+}
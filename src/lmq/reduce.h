@@ -0,0 +1,159 @@
+#ifndef LMQ_REDUCE_H
+#define LMQ_REDUCE_H
+
+#include <snrt.h>
+
+#include <math.h>
+
+/*
+ * Reductions over SSR streams with REDUCE_ACCUMULATORS independent accumulators.
+ * A single accumulator has to wait for the previous add in every iteration, so the FPU only
+ * retires one element per FPU latency. FREP register staggering renames the accumulator of
+ * iteration i to ft(3 + i % 4), which keeps four adds in flight. The accumulators are combined
+ * pairwise after the loop. Staggering assigns the iterations round robin, so n does not need
+ * to be a multiple of REDUCE_ACCUMULATORS: the accumulators which get fewer elements (or none)
+ * just keep their neutral element.
+ *
+ * The caller configures the streams, enables SSR before and calls snrt_fpu_fence and
+ * snrt_ssr_disable after. The stream registers and the accumulators ft3-ft6
+ * are clobbered, so the result is never placed in a stream register.
+ */
+#define REDUCE_ACCUMULATORS 4
+
+/*
+ * Returns the sum of the n elements streamed through ft0.
+ */
+static inline double reduce_sum_ssr_frep(size_t n) {
+    double s = 0.0;
+
+    if (n == 0) {
+        return s;
+    }
+
+    asm volatile(
+        "fcvt.d.w ft3, zero \n"
+        "fcvt.d.w ft4, zero \n"
+        "fcvt.d.w ft5, zero \n"
+        "fcvt.d.w ft6, zero \n"
+        "frep.o %[n_frep], 1, 3, 0b0101 \n"
+        "fadd.d ft3, ft0, ft3 \n"
+        "fadd.d ft3, ft3, ft4 \n"
+        "fadd.d ft5, ft5, ft6 \n"
+        "fadd.d %[s], ft3, ft5 \n"
+        : [s] "=f"(s)
+        : [n_frep] "r"(n - 1)
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+    );
+
+    return s;
+}
+
+/*
+ * Returns the dot product of the n elements streamed through ft0 and ft1.
+ */
+static inline double reduce_dot_ssr_frep(size_t n) {
+    double s = 0.0;
+
+    if (n == 0) {
+        return s;
+    }
+
+    asm volatile(
+        "fcvt.d.w ft3, zero \n"
+        "fcvt.d.w ft4, zero \n"
+        "fcvt.d.w ft5, zero \n"
+        "fcvt.d.w ft6, zero \n"
+        "frep.o %[n_frep], 1, 3, 0b1001 \n"
+        "fmadd.d ft3, ft0, ft1, ft3 \n"
+        "fadd.d ft3, ft3, ft4 \n"
+        "fadd.d ft5, ft5, ft6 \n"
+        "fadd.d %[s], ft3, ft5 \n"
+        : [s] "=f"(s)
+        : [n_frep] "r"(n - 1)
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+    );
+
+    return s;
+}
+
+/*
+ * Returns the maximum of the n elements streamed through ft0 (-INFINITY for n = 0).
+ */
+static inline double reduce_max_ssr_frep(size_t n) {
+    double m = -INFINITY;
+
+    if (n == 0) {
+        return m;
+    }
+
+    asm volatile(
+        "fmv.d ft3, %[init] \n"
+        "fmv.d ft4, %[init] \n"
+        "fmv.d ft5, %[init] \n"
+        "fmv.d ft6, %[init] \n"
+        "frep.o %[n_frep], 1, 3, 0b0101 \n"
+        "fmax.d ft3, ft0, ft3 \n"
+        "fmax.d ft3, ft3, ft4 \n"
+        "fmax.d ft5, ft5, ft6 \n"
+        "fmax.d %[m], ft3, ft5 \n"
+        : [m] "=f"(m)
+        : [n_frep] "r"(n - 1), [init] "f"(m)
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+    );
+
+    return m;
+}
+
+/*
+ * Operations of reduce_cluster. REDUCE_SUM also combines the partial results of a dot product.
+ */
+typedef enum {
+    REDUCE_SUM,
+    REDUCE_MAX,
+    REDUCE_MIN,
+    REDUCE_ARGMAX,
+    REDUCE_ARGMAX_LAST
+} reduce_op_t;
+
+/*
+ * Combines the partial results of the compute cores of the cluster with op.
+ * Compute core i passes its partial value (and for REDUCE_ARGMAX the index of it, -1 if the core had no elements).
+ * The partials are kept in a fixed slot in L1 which is allocated on the first call and combined as a
+ * tree in log2(#cores) steps, so no call allocates and core 0 does not fold the partials serially.
+ * On ties REDUCE_ARGMAX keeps the smaller index and REDUCE_ARGMAX_LAST the larger one, so the result is the
+ * first (last) maximum even if the cores do not reduce consecutive ranges (f.ex. the tiles of tile_argmax).
+ * Must be called by all cores of the cluster, the DM core only takes part in the barriers.
+ * Returns the result (and sets *result_index for REDUCE_ARGMAX* if it is not NULL) on core 0,
+ * the return value of the other cores is undefined.
+ */
+double reduce_cluster(reduce_op_t op, double value, int index, int* result_index);
+
+/*
+ * reduce_cluster for the threads of an OpenMP team, called inside the parallel region by every compute core.
+ * The DM core is not part of the team, so the hardware barrier can not be used and LLVM lowers
+ * reduction(...) to __kmpc_reduce_nowait, which the snRuntime does not provide. The cores combine the
+ * same tree in L1 slots instead, but wait for their partners with flags tagged by the number of the call:
+ * a core waits for the slot of core i + stride, combines it into its partial and publishes the partial once
+ * its subtree is complete. Core 0 publishes the result, which all cores wait for and return (and set
+ * *result_index to for REDUCE_ARGMAX*), so consecutive calls can reuse the slots.
+ * Must be called by all compute cores (bare metal the DM core must not call it).
+ */
+double reduce_team(reduce_op_t op, double value, int index, int* result_index);
+
+/*
+ * Exclusive prefix sum over the values of the compute cores: returns the sum of the values of
+ * the cores with a lower index (0 on core 0) and sets *total to the sum of all values if it is not NULL.
+ * Uses a Hillis-Steele scan in log2(#cores) steps on L1 slots like reduce_cluster, every compute
+ * core gets its result. Must be called by all cores of the cluster, the DM core returns 0.
+ */
+double scan_cluster(double value, double* total);
+
+/*
+ * scan_cluster for the compute cores only, like reduce_team (inside an OMP parallel region or while the
+ * DM core is busy with something else). Every core publishes its value with a flag of the call and sums the
+ * values of the lower cores, the total comes from reduce_team.
+ * Must be called by all compute cores (bare metal the DM core must not call it).
+ */
+double scan_team(double value, double* total);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef LMQ_RNG_H
+#define LMQ_RNG_H
+
+#include <stdint.h>
+
+/*
+ * Counter based random numbers: the number for counter i of a stream is a hash of (key, i), so every
+ * element can be drawn without the ones before it and without shared state. A kernel which draws
+ * element i with counter i gives the same numbers for any split over the cores.
+ * Only integer instructions are used, the FPU (and its SSR streams) keeps running while they issue.
+ */
+
+/*
+ * The lowbias32 integer hash of C. Wellons (two multiplications and three xorshifts).
+ */
+static inline uint32_t rng_mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/*
+ * Key of the independent stream of a seed, f.ex. one stream per core.
+ */
+static inline uint32_t rng_key(uint32_t seed, uint32_t stream) {
+    return rng_mix(seed * 0x9e3779b9u + rng_mix(stream));
+}
+
+/*
+ * Uniform 32 bit number for counter of the stream with key.
+ */
+static inline uint32_t rng_draw(uint32_t key, uint32_t counter) {
+    return rng_mix((counter * 0x9e3779b9u) ^ key);
+}
+
+#endif
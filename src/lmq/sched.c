@@ -0,0 +1,82 @@
+#include <snrt.h>
+
+#include "sched.h"
+
+typedef struct {
+    volatile uint32_t next;     // chunks handed out (and one ticket past the end per core)
+    volatile uint32_t finished; // cores which found no chunk left
+    volatile uint32_t call;     // the call the set is ready for
+} sched_set_t;
+
+// Shared between all cores of the cluster, two sets by the parity of the call and the calls of every core
+sched_set_t* sched_sets = NULL;
+size_t* sched_calls = NULL;
+
+static void sched_init(size_t core_num) {
+    // Any core may be the first one to schedule, so allocate only once
+    if (sched_sets == NULL) {
+        snrt_mutex_lock(snrt_mutex());
+        if (sched_sets == NULL) {
+            sched_calls = snrt_l1alloc(core_num * sizeof(size_t));
+            for (size_t i = 0; i < core_num; i++) {
+                sched_calls[i] = 0;
+            }
+            // The counters must be in TCDM, the atomics are executed there
+            sched_set_t* sets = snrt_l1alloc(2 * sizeof(sched_set_t));
+            for (size_t i = 0; i < 2; i++) {
+                sets[i].next = 0;
+                sets[i].finished = 0;
+                sets[i].call = i;
+            }
+            // Set last, the other cores skip the initialization once it is set
+            sched_sets = sets;
+        }
+        snrt_mutex_release(snrt_mutex());
+    }
+}
+
+static inline uint32_t sched_fetch_add(volatile uint32_t* counter, uint32_t value) {
+    uint32_t old;
+    asm volatile("amoadd.w %0, %2, (%1)" : "=r"(old) : "r"(counter), "r"(value) : "memory");
+    return old;
+}
+
+void sched_begin(sched_t* sched, const size_t n, const size_t chunk) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    sched_init(core_num);
+
+    size_t call = sched_calls[core_idx]++;
+    sched_set_t* set = &sched_sets[call % 2];
+    sched->n = n;
+    sched->chunk = chunk > 0 ? chunk : sched_chunk(n, core_num);
+    sched->call = call;
+    sched->cores = core_num;
+    sched->set = set;
+
+    // A core two calls ahead waits until the slowest core of the previous call on this set has reset it
+    while (set->call != (uint32_t) call) {
+    }
+}
+
+size_t sched_next(sched_t* sched, size_t* first) {
+    sched_set_t* set = sched->set;
+
+    size_t start = (size_t) sched_fetch_add(&set->next, 1) * sched->chunk;
+    if (start < sched->n) {
+        *first = start;
+        return sched->n - start < sched->chunk ? sched->n - start : sched->chunk;
+    }
+
+    // Every core takes exactly one ticket past the end, the last one makes the set ready for the call after next
+    if (sched_fetch_add(&set->finished, 1) == sched->cores - 1) {
+        set->next = 0;
+        set->finished = 0;
+        // The counters must be reset before a core of the call after next can see the set ready
+        asm volatile("" ::: "memory");
+        set->call = (uint32_t) (sched->call + 2);
+    }
+    *first = sched->n;
+    return 0;
+}
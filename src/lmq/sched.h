@@ -0,0 +1,56 @@
+#ifndef LMQ_SCHED_H
+#define LMQ_SCHED_H
+
+#include <snrt.h>
+
+/*
+ * Dynamic chunk scheduling for kernels whose cost depends on the data (f.ex. unique, whose element i costs
+ * n - i comparisons, or sparse rows of very different lengths). Instead of the static split of local_range,
+ * every compute core takes the next chunk of chunk elements from a counter in TCDM with an atomic fetch-and-add
+ * (amoadd.w) until the n elements are handed out, so a core which got cheap chunks takes more of them.
+ *
+ * Every compute core calls sched_begin with the same n and chunk, then sched_next until it returns 0:
+ *     sched_t sched;
+ *     size_t first, count;
+ *     sched_begin(&sched, n, chunk);
+ *     while ((count = sched_next(&sched, &first)) > 0) {
+ *         kernel(arr + first, count, result + first);
+ *     }
+ * The counters are shared by the cluster, consecutive calls use two sets by the parity of the call, so no
+ * barrier is needed between them: the last core which finds the counter exhausted resets its set for the
+ * call after the next one. Not for the DM core, and not for calls which only a part of the compute cores make.
+ */
+typedef struct {
+    size_t n;
+    size_t chunk;
+    size_t call;
+    size_t cores;
+    void* set;
+} sched_t;
+
+// Chunks per core picked by sched_chunk, more balance the load better but cost more atomics
+#ifndef SCHED_CHUNKS_PER_CORE
+#define SCHED_CHUNKS_PER_CORE 8
+#endif
+
+/*
+ * The chunk size for n elements on cores cores: about SCHED_CHUNKS_PER_CORE chunks per core, at least 1.
+ */
+static inline size_t sched_chunk(const size_t n, const size_t cores) {
+    size_t chunks = SCHED_CHUNKS_PER_CORE * cores;
+    size_t chunk = (n + chunks - 1) / chunks;
+    return chunk > 0 ? chunk : 1;
+}
+
+/*
+ * Starts a call over n elements in chunks of chunk elements (0 for sched_chunk).
+ */
+void sched_begin(sched_t* sched, const size_t n, const size_t chunk);
+
+/*
+ * Takes the next chunk: returns its length and sets first to its first element, or returns 0 once all
+ * chunks are taken. Must be called until it returned 0.
+ */
+size_t sched_next(sched_t* sched, size_t* first);
+
+#endif
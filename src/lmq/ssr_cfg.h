@@ -0,0 +1,64 @@
+#ifndef LMQ_SSR_CFG_H
+#define LMQ_SSR_CFG_H
+
+#include <snrt.h>
+#include <stdint.h>
+
+/*
+ * SSR configuration from constants, f.ex. for the shape specialized kernels of src/onnx/fixed.h.
+ * The macros take the arguments of snrt_ssr_loop_*d, snrt_ssr_repeat, snrt_ssr_read and snrt_ssr_write, but dm
+ * and dim must be constants. With constant bounds and strides the register addresses and the stride deltas of
+ * every dimension fold at compile time, and a configuration is a fixed sequence of scfgwi of immediates
+ * (plus the pointers).
+ */
+
+// Configuration registers of a data mover, scfgwi writes the address dm | reg << 5
+#define SSR_REG_REPEAT 1
+#define SSR_REG_BOUNDS 2
+#define SSR_REG_STRIDES 6
+#define SSR_REG_RPTR 24
+#define SSR_REG_WPTR 28
+
+#define SSR_CFG_SET(dm, reg, value)                                                         \
+    asm volatile("scfgwi %[v], %[d] | %[r] << 5 \n"                                         \
+                 :: [v] "r"((uint32_t)(value)), [d] "i"(dm), [r] "i"(reg) : "memory")
+
+/*
+ * The strides are the increments of the address per dimension (in bytes), the data mover applies the
+ * differences to the end of the inner dimensions.
+ */
+#define SSR_CFG_LOOP_1D(dm, b0, i0)                                                         \
+    do {                                                                                    \
+        SSR_CFG_SET(dm, SSR_REG_BOUNDS + 0, (b0) - 1);                                      \
+        SSR_CFG_SET(dm, SSR_REG_STRIDES + 0, (i0));                                         \
+    } while (0)
+
+#define SSR_CFG_LOOP_2D(dm, b0, b1, i0, i1)                                                 \
+    do {                                                                                    \
+        SSR_CFG_LOOP_1D(dm, b0, i0);                                                        \
+        SSR_CFG_SET(dm, SSR_REG_BOUNDS + 1, (b1) - 1);                                      \
+        SSR_CFG_SET(dm, SSR_REG_STRIDES + 1, (i1) - (i0) * ((b0) - 1));                     \
+    } while (0)
+
+#define SSR_CFG_LOOP_3D(dm, b0, b1, b2, i0, i1, i2)                                         \
+    do {                                                                                    \
+        SSR_CFG_LOOP_2D(dm, b0, b1, i0, i1);                                                \
+        SSR_CFG_SET(dm, SSR_REG_BOUNDS + 2, (b2) - 1);                                      \
+        SSR_CFG_SET(dm, SSR_REG_STRIDES + 2, (i2) - (i0) * ((b0) - 1) - (i1) * ((b1) - 1)); \
+    } while (0)
+
+#define SSR_CFG_LOOP_4D(dm, b0, b1, b2, b3, i0, i1, i2, i3)                                 \
+    do {                                                                                    \
+        SSR_CFG_LOOP_3D(dm, b0, b1, b2, i0, i1, i2);                                        \
+        SSR_CFG_SET(dm, SSR_REG_BOUNDS + 3, (b3) - 1);                                      \
+        SSR_CFG_SET(dm, SSR_REG_STRIDES + 3,                                                \
+                    (i3) - (i0) * ((b0) - 1) - (i1) * ((b1) - 1) - (i2) * ((b2) - 1));      \
+    } while (0)
+
+#define SSR_CFG_REPEAT(dm, count) SSR_CFG_SET(dm, SSR_REG_REPEAT, (count) - 1)
+
+// Writing the pointer starts the data mover, dim is SNRT_SSR_1D to SNRT_SSR_4D
+#define SSR_CFG_READ(dm, dim, ptr) SSR_CFG_SET(dm, SSR_REG_RPTR + (dim), (uintptr_t)(ptr))
+#define SSR_CFG_WRITE(dm, dim, ptr) SSR_CFG_SET(dm, SSR_REG_WPTR + (dim), (uintptr_t)(ptr))
+
+#endif
@@ -0,0 +1,103 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "task.h"
+
+task_queue_t* task_queue_create() {
+    task_queue_t* q = arena_alloc(arena_l1(), 1, sizeof(task_queue_t), LMQ_ALIGN_DOUBLE);
+    if (q == NULL) {
+        q = arena_alloc(arena_global(), 1, sizeof(task_queue_t), LMQ_ALIGN_DOUBLE);
+    }
+    if (q != NULL) {
+        task_queue_reset(q);
+    }
+    return q;
+}
+
+void task_queue_reset(task_queue_t* q) {
+    q->head = 0;
+    q->tail = 0;
+    q->closed = 0;
+}
+
+void task_wait(const volatile size_t* flags, size_t num, size_t value) {
+    for (size_t i = 0; i < num; i++) {
+        while (flags[i] < value) {
+        }
+    }
+}
+
+static int task_run(const task_t* task) {
+    if (task->wait != NULL) {
+        task_wait(task->wait, task->wait_num, task->wait_value);
+    }
+    int ret = task->fn(task->ctx, task->tile);
+    if (task->done != NULL) {
+        // The FPU stores asynchronously, the flag must not become visible before the results
+        snrt_fpu_fence();
+        *task->done = task->done_value;
+    }
+    return ret;
+}
+
+/*
+ * Copies the oldest task of q into task and returns 1, 0 if q is empty.
+ */
+static int task_take(task_queue_t* q, task_t* task) {
+    // Look without the lock first, the idle workers spin here
+    if (q->head == q->tail) {
+        return 0;
+    }
+
+    int taken = 0;
+    snrt_mutex_lock(snrt_mutex());
+    size_t head = q->head;
+    if (head != q->tail) {
+        *task = q->slots[head % TASK_QUEUE_SIZE];
+        q->head = head + 1;
+        taken = 1;
+    }
+    snrt_mutex_release(snrt_mutex());
+    return taken;
+}
+
+int task_submit(task_queue_t* q, const task_t* task) {
+    int ret = 0;
+    if (q->closed) {
+        return -1;
+    }
+
+    // The slot of the oldest task is free as soon as it is taken
+    while (q->tail - q->head >= TASK_QUEUE_SIZE) {
+        task_t oldest;
+        if (task_take(q, &oldest)) {
+            ret |= task_run(&oldest);
+        }
+    }
+
+    size_t tail = q->tail;
+    q->slots[tail % TASK_QUEUE_SIZE] = *task;
+    // The slot must be written before a worker can see it
+    asm volatile("" ::: "memory");
+    q->tail = tail + 1;
+    return ret;
+}
+
+void task_close(task_queue_t* q) {
+    q->closed = 1;
+}
+
+int task_worker(task_queue_t* q) {
+    int ret = 0;
+    task_t task;
+
+    for (;;) {
+        if (task_take(q, &task)) {
+            ret |= task_run(&task);
+        } else if (q->closed && q->head == q->tail) {
+            // tail is final once closed is set, it is written before
+            break;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,84 @@
+#ifndef LMQ_TASK_H
+#define LMQ_TASK_H
+
+#include <snrt.h>
+
+/*
+ * Asynchronous tasks: instead of a fork/join of every kernel over all compute cores with a hardware barrier
+ * after it, one core (f.ex. core 0) submits the tiles of the operators as tasks into a queue in L1 and the
+ * compute cores pull them as soon as they are free, so small layers do not wait for the slowest core.
+ *
+ * The order between tasks is given by completion flags instead of barriers: a task waits until the wait_num
+ * flags at wait (f.ex. the flags of the tiles of the previous layer it reads) have reached wait_value, and
+ * sets its own flag done to done_value once it returned. The values are epochs (f.ex. the number of the run),
+ * so the flags do not have to be cleared between runs. A task may only wait for tasks submitted before it.
+ *
+ * Several queues split the cores into groups, f.ex. a two stage pipeline in which cores 0 to 3 compute the
+ * tiles of one layer and cores 4 to 7 the tiles of the next layer as soon as the tiles they read are done.
+ *
+ * A queue has one submitting core. The queue and the flags must be shared by the cores, i.e. in L1 or global
+ * memory (not on the stack of a core).
+ */
+#ifndef TASK_QUEUE_SIZE
+#define TASK_QUEUE_SIZE 64
+#endif
+
+/*
+ * Runs tile of the operator with the arguments ctx, returns like a kernel (0 on success).
+ */
+typedef int (*task_fn_t)(const void* ctx, size_t tile);
+
+typedef struct {
+    task_fn_t fn;
+    const void* ctx;
+    size_t tile;
+    const volatile size_t* wait; // wait_num flags, or NULL
+    size_t wait_num;
+    size_t wait_value;
+    volatile size_t* done;       // or NULL
+    size_t done_value;
+} task_t;
+
+typedef struct {
+    task_t slots[TASK_QUEUE_SIZE];
+    volatile size_t head;   // tasks taken by a worker, under snrt_mutex
+    volatile size_t tail;   // tasks submitted
+    volatile int closed;
+} task_queue_t;
+
+/*
+ * Allocates an empty queue from arena_l1 (or global memory if L1 is exhausted). Called by one core, the
+ * other cores get the queue f.ex. through a pointer in global memory after a barrier. NULL if both are
+ * exhausted.
+ */
+task_queue_t* task_queue_create();
+
+/*
+ * Empties q for the next run. Only while no core runs task_worker on it.
+ */
+void task_queue_reset(task_queue_t* q);
+
+/*
+ * Appends task to q. If q is full the submitting core runs the oldest task itself, which waits for its flags
+ * like on any worker: the tasks it waits for must be taken by other cores.
+ * Returns -1 if q is closed and the result of the tasks the submitting core ran otherwise.
+ */
+int task_submit(task_queue_t* q, const task_t* task);
+
+/*
+ * No more tasks are submitted to q, task_worker returns once all of them are taken.
+ */
+void task_close(task_queue_t* q);
+
+/*
+ * Runs the tasks of q until q is closed and empty. Called by every core of the group of q, f.ex. by the
+ * submitting core after task_close. Returns the results of the tasks it ran, or-ed.
+ */
+int task_worker(task_queue_t* q);
+
+/*
+ * Waits until the num flags at flags have reached value.
+ */
+void task_wait(const volatile size_t* flags, size_t num, size_t value);
+
+#endif
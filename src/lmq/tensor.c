@@ -0,0 +1,729 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "fpmath.h"
+#include "tensor.h"
+#include "copy.h"
+
+int tensor_init(tensor_t* t, void* data, tensor_dtype_t dtype, size_t ndim, const size_t* shape) {
+    if (ndim > TENSOR_MAX_DIMS) {
+        return -1;
+    }
+    t->data = data;
+    t->dtype = dtype;
+    t->ndim = ndim;
+    ptrdiff_t stride = 1;
+    for (size_t d = ndim; d-- > 0;) {
+        t->shape[d] = shape[d];
+        t->strides[d] = stride;
+        stride *= (ptrdiff_t) shape[d];
+    }
+    return 0;
+}
+
+size_t tensor_numel(const tensor_t* t) {
+    size_t numel = 1;
+    for (size_t d = 0; d < t->ndim; d++) {
+        numel *= t->shape[d];
+    }
+    return numel;
+}
+
+size_t tensor_element_size(const tensor_t* t) {
+    return t->dtype == TENSOR_F32 ? sizeof(float) : sizeof(double);
+}
+
+int tensor_is_contiguous(const tensor_t* t) {
+    ptrdiff_t expected = 1;
+    for (size_t d = t->ndim; d-- > 0;) {
+        if (t->shape[d] != 1 && t->strides[d] != expected) {
+            return 0;
+        }
+        expected *= (ptrdiff_t) t->shape[d];
+    }
+    return 1;
+}
+
+static inline ptrdiff_t tensor_clamp(ptrdiff_t value, ptrdiff_t low, ptrdiff_t high) {
+    return value < low ? low : value > high ? high : value;
+}
+
+int tensor_slice(const tensor_t* t, size_t dim, ptrdiff_t start, ptrdiff_t end, ptrdiff_t step, tensor_t* view) {
+    if (dim >= t->ndim || step == 0) {
+        return -1;
+    }
+    ptrdiff_t n = (ptrdiff_t) t->shape[dim];
+    start = start < 0 ? start + n : start;
+    end = end < 0 ? end + n : end;
+
+    // forwards start and end are in [0, n], backwards in [-1, n - 1]
+    size_t count = 0;
+    if (step > 0) {
+        start = tensor_clamp(start, 0, n);
+        end = tensor_clamp(end, 0, n);
+        count = end > start ? (size_t) ((end - start + step - 1) / step) : 0;
+    } else {
+        start = tensor_clamp(start, -1, n - 1);
+        end = tensor_clamp(end, -1, n - 1);
+        count = start > end ? (size_t) ((start - end - step - 1) / -step) : 0;
+    }
+
+    ptrdiff_t stride = t->strides[dim];
+    char* data = (char*) t->data;
+    if (count > 0) {
+        data += start * stride * (ptrdiff_t) tensor_element_size(t);
+    }
+    *view = *t;
+    view->data = data;
+    view->shape[dim] = count;
+    view->strides[dim] = stride * step;
+    return 0;
+}
+
+int tensor_transpose(const tensor_t* t, const size_t* perm, tensor_t* view) {
+    size_t shape[TENSOR_MAX_DIMS];
+    ptrdiff_t strides[TENSOR_MAX_DIMS];
+    int used[TENSOR_MAX_DIMS] = {0};
+
+    for (size_t d = 0; d < t->ndim; d++) {
+        size_t p = perm ? perm[d] : t->ndim - 1 - d;
+        if (p >= t->ndim || used[p]) {
+            return -1;
+        }
+        used[p] = 1;
+        shape[d] = t->shape[p];
+        strides[d] = t->strides[p];
+    }
+    *view = *t;
+    for (size_t d = 0; d < t->ndim; d++) {
+        view->shape[d] = shape[d];
+        view->strides[d] = strides[d];
+    }
+    return 0;
+}
+
+int tensor_reshape(const tensor_t* t, size_t ndim, const size_t* shape, tensor_t* view) {
+    size_t old_shape[TENSOR_MAX_DIMS];
+    ptrdiff_t old_strides[TENSOR_MAX_DIMS];
+    ptrdiff_t strides[TENSOR_MAX_DIMS];
+    size_t old_ndim = 0;
+
+    if (ndim > TENSOR_MAX_DIMS) {
+        return -1;
+    }
+    size_t numel = 1;
+    for (size_t d = 0; d < ndim; d++) {
+        numel *= shape[d];
+        strides[d] = 1;
+    }
+    if (numel != tensor_numel(t)) {
+        return -1;
+    }
+
+    // dimensions of size 1 have no stride to keep
+    for (size_t d = 0; d < t->ndim; d++) {
+        if (t->shape[d] != 1) {
+            old_shape[old_ndim] = t->shape[d];
+            old_strides[old_ndim++] = t->strides[d];
+        }
+    }
+
+    if (numel == 0) {
+        for (size_t d = ndim; d-- > 1;) {
+            strides[d - 1] = strides[d] * (ptrdiff_t) shape[d];
+        }
+    } else {
+        // groups of old and new dimensions with the same number of elements, the old ones of a group must be
+        // contiguous in each other and the new ones get their strides from the innermost old one
+        size_t oi = 0, oj = 1, ni = 0, nj = 1;
+        while (ni < ndim && oi < old_ndim) {
+            size_t np = shape[ni];
+            size_t op = old_shape[oi];
+            while (np != op) {
+                if (np < op) {
+                    np *= shape[nj++];
+                } else {
+                    op *= old_shape[oj++];
+                }
+            }
+            for (size_t ok = oi; ok + 1 < oj; ok++) {
+                if (old_strides[ok] != (ptrdiff_t) old_shape[ok + 1] * old_strides[ok + 1]) {
+                    return -1;
+                }
+            }
+            strides[nj - 1] = old_strides[oj - 1];
+            for (size_t nk = nj - 1; nk > ni; nk--) {
+                strides[nk - 1] = strides[nk] * (ptrdiff_t) shape[nk];
+            }
+            ni = nj++;
+            oi = oj++;
+        }
+    }
+
+    *view = *t;
+    view->ndim = ndim;
+    for (size_t d = 0; d < ndim; d++) {
+        view->shape[d] = shape[d];
+        view->strides[d] = strides[d];
+    }
+    return 0;
+}
+
+int tensor_broadcast_to(const tensor_t* t, size_t ndim, const size_t* shape, tensor_t* view) {
+    ptrdiff_t strides[TENSOR_MAX_DIMS];
+
+    if (ndim > TENSOR_MAX_DIMS || t->ndim > ndim) {
+        return -1;
+    }
+    for (size_t d = 0; d < ndim; d++) {
+        // dimension d from the back, missing dimensions are 1
+        size_t k = ndim - 1 - d;
+        size_t dim = d < t->ndim ? t->shape[t->ndim - 1 - d] : 1;
+        if (dim == shape[k]) {
+            strides[k] = d < t->ndim ? t->strides[t->ndim - 1 - d] : 0;
+        } else if (dim == 1) {
+            strides[k] = 0;
+        } else {
+            return -1;
+        }
+    }
+    *view = *t;
+    view->ndim = ndim;
+    for (size_t d = 0; d < ndim; d++) {
+        view->shape[d] = shape[d];
+        view->strides[d] = strides[d];
+    }
+    return 0;
+}
+
+static int tensor_same_shape(const tensor_t* a, const tensor_t* b) {
+    if (a->ndim != b->ndim) {
+        return 0;
+    }
+    for (size_t d = 0; d < a->ndim; d++) {
+        if (a->shape[d] != b->shape[d]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * The dimensions of the last operand (the result), innermost first, with the strides (in elements)
+ * of every operand. Dimensions of size 1 are dropped and a dimension is merged into the loop inside it
+ * if it continues that loop in all operands.
+ */
+#define TENSOR_MAX_OPERANDS 3
+
+typedef struct {
+    size_t loops;
+    size_t bounds[TENSOR_MAX_DIMS];
+    ptrdiff_t strides[TENSOR_MAX_OPERANDS][TENSOR_MAX_DIMS];
+} tensor_loops_t;
+
+static void tensor_loops(const tensor_t* const* ts, size_t num, tensor_loops_t* l) {
+    const tensor_t* result = ts[num - 1];
+    l->loops = 0;
+    for (size_t d = result->ndim; d-- > 0;) {
+        size_t bound = result->shape[d];
+        if (bound == 1) {
+            continue;
+        }
+        size_t k = l->loops;
+        int merge = k > 0;
+        for (size_t i = 0; i < num && merge; i++) {
+            merge = ts[i]->strides[d] == l->strides[i][k - 1] * (ptrdiff_t) l->bounds[k - 1];
+        }
+        if (merge) {
+            l->bounds[k - 1] *= bound;
+            continue;
+        }
+        l->bounds[k] = bound;
+        for (size_t i = 0; i < num; i++) {
+            l->strides[i][k] = ts[i]->strides[d];
+        }
+        l->loops++;
+    }
+}
+
+/*
+ * Configures the stream dm on the loops of l with the strides of operand, without the direction.
+ */
+static enum snrt_ssr_dim tensor_ssr_loops(enum snrt_ssr_dm dm, const tensor_loops_t* l, size_t operand) {
+    size_t b[TENSOR_MAX_DIMS] = {1, 1, 1, 1};
+    size_t s[TENSOR_MAX_DIMS] = {0, 0, 0, 0};
+    for (size_t k = 0; k < l->loops; k++) {
+        b[k] = l->bounds[k];
+        // negative strides wrap around like the address arithmetic of the stream
+        s[k] = (size_t) (l->strides[operand][k] * (ptrdiff_t) sizeof(double));
+    }
+    snrt_ssr_repeat(dm, 1);
+    switch (l->loops) {
+    case 0:
+    case 1:
+        snrt_ssr_loop_1d(dm, b[0], s[0]);
+        return SNRT_SSR_1D;
+    case 2:
+        snrt_ssr_loop_2d(dm, b[0], b[1], s[0], s[1]);
+        return SNRT_SSR_2D;
+    case 3:
+        snrt_ssr_loop_3d(dm, b[0], b[1], b[2], s[0], s[1], s[2]);
+        return SNRT_SSR_3D;
+    default:
+        snrt_ssr_loop_4d(dm, b[0], b[1], b[2], b[3], s[0], s[1], s[2], s[3]);
+        return SNRT_SSR_4D;
+    }
+}
+
+void tensor_ssr_read(const tensor_t* t, enum snrt_ssr_dm dm) {
+    tensor_loops_t l;
+    tensor_loops(&t, 1, &l);
+    snrt_ssr_read(dm, tensor_ssr_loops(dm, &l, 0), t->data);
+}
+
+void tensor_ssr_write(const tensor_t* t, enum snrt_ssr_dm dm) {
+    tensor_loops_t l;
+    tensor_loops(&t, 1, &l);
+    snrt_ssr_write(dm, tensor_ssr_loops(dm, &l, 0), t->data);
+}
+
+int tensor_concat_views(const tensor_t* result, size_t axis, size_t num, const size_t* sizes, tensor_t* views) {
+    if (axis >= result->ndim) {
+        return -1;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < num; i++) {
+        if (offset + sizes[i] > result->shape[axis]) {
+            return -1;
+        }
+        tensor_slice(result, axis, (ptrdiff_t) offset, (ptrdiff_t) (offset + sizes[i]), 1, &views[i]);
+        offset += sizes[i];
+    }
+    return offset == result->shape[axis] ? 0 : -1;
+}
+
+/*
+ * 1 if x can be copied into the view result by tensor_dma_start.
+ */
+static int tensor_dma_check(const tensor_t* x, const tensor_t* result) {
+    if (x->dtype != TENSOR_F64 || result->dtype != TENSOR_F64 || !tensor_same_shape(x, result)) {
+        return 0;
+    }
+    for (size_t d = 0; d < x->ndim; d++) {
+        if (x->shape[d] > 1 && (x->strides[d] < 0 || result->strides[d] < 0)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Issues the transfers which copy x into result (checked by tensor_dma_check) on the DM core and returns the id of
+ * the last one. The dimensions are merged like the loops of an SSR stream, the innermost loop is the row of the
+ * transfers if it is contiguous in both. copy_dma_start_3d copies the next two loops as rows and planes,
+ * the DM core iterates over the ones outside of them.
+ */
+static snrt_dma_txid_t tensor_dma_start(const tensor_t* x, const tensor_t* result) {
+    const tensor_t* ts[2] = {x, result};
+    tensor_loops_t l;
+    tensor_loops(ts, 2, &l);
+
+    size_t row_len = 1;
+    size_t k = 0;
+    if (l.loops > 0 && l.strides[0][0] == 1 && l.strides[1][0] == 1) {
+        row_len = l.bounds[0];
+        k = 1;
+    }
+
+    size_t bounds[TENSOR_MAX_DIMS] = {1, 1, 1, 1};
+    size_t x_strides[TENSOR_MAX_DIMS] = {0, 0, 0, 0};
+    size_t result_strides[TENSOR_MAX_DIMS] = {0, 0, 0, 0};
+    for (size_t i = 0; k < l.loops; i++, k++) {
+        bounds[i] = l.bounds[k];
+        x_strides[i] = (size_t) l.strides[0][k];
+        result_strides[i] = (size_t) l.strides[1][k];
+    }
+
+    snrt_dma_txid_t id = 0;
+    for (size_t i3 = 0; i3 < bounds[3]; i3++) {
+        for (size_t i2 = 0; i2 < bounds[2]; i2++) {
+            double* source = (double*) x->data + i3 * x_strides[3] + i2 * x_strides[2];
+            double* target = (double*) result->data + i3 * result_strides[3] + i2 * result_strides[2];
+            id = copy_dma_start_3d(source, row_len, bounds[0], bounds[1], x_strides[0], result_strides[0],
+                                   x_strides[1], result_strides[1], target);
+        }
+    }
+    return id;
+}
+
+__attribute__((noinline))
+int tensor_concat_dma(const tensor_t* inputs, size_t num, size_t axis, const tensor_t* result) {
+    tensor_t view;
+
+    // Every core checks, so all of them return -1 without the barrier
+    if (axis >= result->ndim) {
+        return -1;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < num; i++) {
+        size_t n = axis < inputs[i].ndim ? inputs[i].shape[axis] : 0;
+        if (offset + n > result->shape[axis]) {
+            return -1;
+        }
+        tensor_slice(result, axis, (ptrdiff_t) offset, (ptrdiff_t) (offset + n), 1, &view);
+        if (!tensor_dma_check(&inputs[i], &view)) {
+            return -1;
+        }
+        offset += n;
+    }
+    if (offset != result->shape[axis]) {
+        return -1;
+    }
+
+    if (snrt_is_dm_core()) {
+        offset = 0;
+        for (size_t i = 0; i < num; i++) {
+            tensor_slice(result, axis, (ptrdiff_t) offset, (ptrdiff_t) (offset + inputs[i].shape[axis]), 1, &view);
+            tensor_dma_start(&inputs[i], &view);
+            offset += inputs[i].shape[axis];
+        }
+        snrt_dma_wait_all();
+    }
+    snrt_cluster_hw_barrier();
+
+    return 0;
+}
+
+static inline double tensor_load(const char* data, tensor_dtype_t dtype, ptrdiff_t i) {
+    return dtype == TENSOR_F32 ? (double) ((const float*) data)[i] : ((const double*) data)[i];
+}
+
+static inline void tensor_store(char* data, tensor_dtype_t dtype, ptrdiff_t i, double value) {
+    if (dtype == TENSOR_F32) {
+        ((float*) data)[i] = (float) value;
+    } else {
+        ((double*) data)[i] = value;
+    }
+}
+
+static inline double tensor_apply(int binary, int kind, double a, double b) {
+    if (binary) {
+        switch ((broadcast_kind_t) kind) {
+        case BROADCAST_SUB:
+            return a - b;
+        case BROADCAST_MUL:
+            return a * b;
+        case BROADCAST_DIV:
+            return a / b;
+        case BROADCAST_PRELU:
+            return a < 0 ? a * b : a;
+        default:
+            return a + b;
+        }
+    }
+    switch ((tensor_unary_t) kind) {
+    case TENSOR_NEG:
+        return -a;
+    case TENSOR_ABS:
+        return a < 0 ? -a : a;
+    case TENSOR_RELU:
+        return a > 0 ? a : 0.0;
+    default:
+        return a;
+    }
+}
+
+/*
+ * One instruction on the streams under FREP, %[zero] is 0.0.
+ */
+#define TENSOR_STREAM(insn, n)                                              \
+    asm volatile(                                                           \
+        "frep.o %[n_frep], 1, 0, 0 \n"                                      \
+        insn " \n"                                                          \
+        :: [n_frep] "r"((n) - 1), [zero] "f"(0.0) : "ft0", "ft1", "ft2", "memory")
+
+/*
+ * The part of core core_idx (of core_num) of the outermost loop of the elementwise kind on the num operands
+ * ts (inputs, then the result).
+ */
+static void tensor_elementwise(int binary, int kind, const tensor_t* const* ts, size_t num, int ssr,
+                               size_t core_idx, size_t core_num) {
+    tensor_loops_t l;
+    char* data[TENSOR_MAX_OPERANDS];
+    int f64 = 1;
+
+    if (tensor_numel(ts[num - 1]) == 0) {
+        return;
+    }
+    tensor_loops(ts, num, &l);
+    for (size_t i = 0; i < num; i++) {
+        data[i] = (char*) ts[i]->data;
+        f64 &= ts[i]->dtype == TENSOR_F64;
+    }
+
+    // A single element has no loop to split
+    if (l.loops == 0 && core_idx != 0) {
+        return;
+    }
+    if (l.loops > 0) {
+        size_t top = l.loops - 1;
+        size_t first;
+        l.bounds[top] = local_range(l.bounds[top], core_idx, core_num, &first);
+        if (l.bounds[top] == 0) {
+            return;
+        }
+        for (size_t i = 0; i < num; i++) {
+            data[i] += (ptrdiff_t) first * l.strides[i][top] * (ptrdiff_t) tensor_element_size(ts[i]);
+        }
+    }
+
+    size_t count = 1;
+    for (size_t k = 0; k < l.loops; k++) {
+        count *= l.bounds[k];
+    }
+
+    if (!ssr || !f64) {
+        size_t b[TENSOR_MAX_DIMS] = {1, 1, 1, 1};
+        ptrdiff_t s[TENSOR_MAX_OPERANDS][TENSOR_MAX_DIMS] = {{0}};
+        for (size_t k = 0; k < l.loops; k++) {
+            b[k] = l.bounds[k];
+            for (size_t i = 0; i < num; i++) {
+                s[i][k] = l.strides[i][k];
+            }
+        }
+        const tensor_t* result = ts[num - 1];
+        for (size_t i3 = 0; i3 < b[3]; i3++) {
+            for (size_t i2 = 0; i2 < b[2]; i2++) {
+                for (size_t i1 = 0; i1 < b[1]; i1++) {
+                    for (size_t i0 = 0; i0 < b[0]; i0++) {
+                        ptrdiff_t o[TENSOR_MAX_OPERANDS];
+                        for (size_t i = 0; i < num; i++) {
+                            o[i] = (ptrdiff_t) i0 * s[i][0] + (ptrdiff_t) i1 * s[i][1] + (ptrdiff_t) i2 * s[i][2] +
+                                   (ptrdiff_t) i3 * s[i][3];
+                        }
+                        double x = tensor_load(data[0], ts[0]->dtype, o[0]);
+                        double y = binary ? tensor_load(data[1], ts[1]->dtype, o[1]) : 0.0;
+                        tensor_store(data[num - 1], result->dtype, o[num - 1], tensor_apply(binary, kind, x, y));
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // the inputs are read through ft0 (and ft1), the result is written through the next stream
+    for (size_t i = 0; i < num; i++) {
+        enum snrt_ssr_dm dm = (enum snrt_ssr_dm) i;
+        enum snrt_ssr_dim dim = tensor_ssr_loops(dm, &l, i);
+        if (i < num - 1) {
+            snrt_ssr_read(dm, dim, data[i]);
+        } else {
+            snrt_ssr_write(dm, dim, data[i]);
+        }
+    }
+
+    snrt_ssr_enable();
+
+    if (binary) {
+        switch ((broadcast_kind_t) kind) {
+        case BROADCAST_SUB:
+            TENSOR_STREAM("fsub.d ft2, ft0, ft1", count);
+            break;
+        case BROADCAST_MUL:
+            TENSOR_STREAM("fmul.d ft2, ft0, ft1", count);
+            break;
+        case BROADCAST_DIV:
+            TENSOR_STREAM("fdiv.d ft2, ft0, ft1", count);
+            break;
+        case BROADCAST_PRELU:
+            // max(a, 0) + b * min(a, 0) without a branch
+            FPMATH_PASS(1, count, 4,
+                "fmv.d ft3, ft0 \n"
+                "fmin.d ft4, ft3, %[zero] \n"
+                "fmax.d ft3, ft3, %[zero] \n"
+                "fmadd.d ft2, ft4, ft1, ft3 \n",
+                [zero] "f"(0.0));
+            break;
+        default:
+            TENSOR_STREAM("fadd.d ft2, ft0, ft1", count);
+            break;
+        }
+    } else {
+        switch ((tensor_unary_t) kind) {
+        case TENSOR_NEG:
+            TENSOR_STREAM("fneg.d ft1, ft0", count);
+            break;
+        case TENSOR_ABS:
+            TENSOR_STREAM("fabs.d ft1, ft0", count);
+            break;
+        case TENSOR_RELU:
+            TENSOR_STREAM("fmax.d ft1, ft0, %[zero]", count);
+            break;
+        default:
+            TENSOR_STREAM("fmv.d ft1, ft0", count);
+            break;
+        }
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+static int tensor_unary(tensor_unary_t kind, const tensor_t* x, const tensor_t* result, int ssr, int parallel) {
+    const tensor_t* ts[2] = {x, result};
+    if (!tensor_same_shape(x, result)) {
+        return -1;
+    }
+    size_t core_idx = parallel ? snrt_cluster_core_idx() : 0;
+    size_t core_num = parallel ? snrt_cluster_core_num() - 1 : 1;
+    if (core_idx < core_num) {
+        tensor_elementwise(0, kind, ts, 2, ssr, core_idx, core_num);
+    }
+    return 0;
+}
+
+static int tensor_binary(broadcast_kind_t kind, const tensor_t* a, const tensor_t* b, const tensor_t* result,
+                         int ssr, int parallel) {
+    const tensor_t* ts[3] = {a, b, result};
+    if (!tensor_same_shape(a, result) || !tensor_same_shape(b, result)) {
+        return -1;
+    }
+    size_t core_idx = parallel ? snrt_cluster_core_idx() : 0;
+    size_t core_num = parallel ? snrt_cluster_core_num() - 1 : 1;
+    if (core_idx < core_num) {
+        tensor_elementwise(1, kind, ts, 3, ssr, core_idx, core_num);
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int tensor_unary_baseline(tensor_unary_t kind, const tensor_t* x, const tensor_t* result) {
+    return tensor_unary(kind, x, result, 0, 0);
+}
+
+__attribute__((noinline))
+int tensor_unary_ssr_frep(tensor_unary_t kind, const tensor_t* x, const tensor_t* result) {
+    return tensor_unary(kind, x, result, 1, 0);
+}
+
+__attribute__((noinline))
+int tensor_unary_ssr_frep_parallel(tensor_unary_t kind, const tensor_t* x, const tensor_t* result) {
+    return tensor_unary(kind, x, result, 1, 1);
+}
+
+__attribute__((noinline))
+int tensor_binary_baseline(broadcast_kind_t kind, const tensor_t* a, const tensor_t* b, const tensor_t* result) {
+    return tensor_binary(kind, a, b, result, 0, 0);
+}
+
+__attribute__((noinline))
+int tensor_binary_ssr_frep(broadcast_kind_t kind, const tensor_t* a, const tensor_t* b, const tensor_t* result) {
+    return tensor_binary(kind, a, b, result, 1, 0);
+}
+
+__attribute__((noinline))
+int tensor_binary_ssr_frep_parallel(broadcast_kind_t kind, const tensor_t* a, const tensor_t* b,
+                                    const tensor_t* result) {
+    return tensor_binary(kind, a, b, result, 1, 1);
+}
+
+/*
+ * Rows first to first + rows of result = a times b.
+ */
+static void tensor_gemm_rows(const tensor_t* a, const tensor_t* b, const tensor_t* result, size_t first,
+                             size_t rows, int ssr) {
+    size_t n = a->shape[1];
+    size_t k = b->shape[1];
+    const char* pa = (const char*) a->data + (ptrdiff_t) first * a->strides[0] * (ptrdiff_t) tensor_element_size(a);
+    char* pr = (char*) result->data + (ptrdiff_t) first * result->strides[0] * (ptrdiff_t) tensor_element_size(result);
+
+    if (rows == 0 || k == 0) {
+        return;
+    }
+    if (!ssr || n == 0 || a->dtype != TENSOR_F64 || b->dtype != TENSOR_F64 || result->dtype != TENSOR_F64) {
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t j = 0; j < k; j++) {
+                double sum = 0.0;
+                for (size_t p = 0; p < n; p++) {
+                    sum += tensor_load(pa, a->dtype, (ptrdiff_t) i * a->strides[0] + (ptrdiff_t) p * a->strides[1]) *
+                           tensor_load(b->data, b->dtype, (ptrdiff_t) p * b->strides[0] + (ptrdiff_t) j * b->strides[1]);
+                }
+                tensor_store(pr, result->dtype, (ptrdiff_t) i * result->strides[0] + (ptrdiff_t) j * result->strides[1],
+                             sum);
+            }
+        }
+        return;
+    }
+
+    // the streams of gemm_ssr_frep with the strides of the descriptors
+    const ptrdiff_t e = sizeof(double);
+    snrt_ssr_loop_3d(SNRT_SSR_DM0, n, k, rows, (size_t) (e * a->strides[1]), 0, (size_t) (e * a->strides[0]));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, (void*) pa);
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM1, n, k, rows, (size_t) (e * b->strides[0]), (size_t) (e * b->strides[1]), 0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, b->data);
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM2, k, rows, (size_t) (e * result->strides[1]), (size_t) (e * result->strides[0]));
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, pr);
+
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < rows * k; ++i) {
+        asm volatile(
+            "fcvt.d.w ft3, zero \n"
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "fmadd.d ft3, ft0, ft1, ft3 \n"
+            "fmv.d ft2, ft3 \n"
+            :
+            : [n_frep] "r"(n - 1)
+            : "ft0", "ft1", "ft2", "ft3"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+static int tensor_gemm_check(const tensor_t* a, const tensor_t* b, const tensor_t* result) {
+    if (a->ndim != 2 || b->ndim != 2 || result->ndim != 2 || a->shape[1] != b->shape[0] ||
+        result->shape[0] != a->shape[0] || result->shape[1] != b->shape[1]) {
+        return -1;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int tensor_gemm_baseline(const tensor_t* a, const tensor_t* b, const tensor_t* result) {
+    if (tensor_gemm_check(a, b, result)) {
+        return -1;
+    }
+    tensor_gemm_rows(a, b, result, 0, a->shape[0], 0);
+    return 0;
+}
+
+__attribute__((noinline))
+int tensor_gemm_ssr_frep(const tensor_t* a, const tensor_t* b, const tensor_t* result) {
+    if (tensor_gemm_check(a, b, result)) {
+        return -1;
+    }
+    tensor_gemm_rows(a, b, result, 0, a->shape[0], 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int tensor_gemm_ssr_frep_parallel(const tensor_t* a, const tensor_t* b, const tensor_t* result) {
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t core_num = snrt_cluster_core_num() - 1;
+    if (tensor_gemm_check(a, b, result)) {
+        return -1;
+    }
+    if (core_idx < core_num) {
+        size_t first;
+        size_t rows = local_range(a->shape[0], core_idx, core_num, &first);
+        tensor_gemm_rows(a, b, result, first, rows, 1);
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+#ifndef LMQ_TENSOR_H
+#define LMQ_TENSOR_H
+
+#include <snrt.h>
+#include <stddef.h>
+
+#include "broadcast.h"
+
+/*
+ * Maximal number of dimensions of a tensor descriptor, one per loop of an SSR 4D stream.
+ */
+#define TENSOR_MAX_DIMS 4
+
+typedef enum {
+    TENSOR_F64,
+    TENSOR_F32
+} tensor_dtype_t;
+
+/*
+ * A view of data: element (i0, ..., i_ndim-1) is data[i0 * strides[0] + ... + i_ndim-1 * strides[ndim - 1]].
+ * The strides are in elements and may be 0 (broadcast) or negative (reversed slice).
+ * The descriptors are small and passed by pointer, views share the data of the tensor they are taken from.
+ */
+typedef struct {
+    void* data;
+    tensor_dtype_t dtype;
+    size_t ndim;
+    size_t shape[TENSOR_MAX_DIMS];
+    ptrdiff_t strides[TENSOR_MAX_DIMS];
+} tensor_t;
+
+/*
+ * A contiguous row major tensor on data. Returns -1 if ndim > TENSOR_MAX_DIMS.
+ */
+int tensor_init(tensor_t* t, void* data, tensor_dtype_t dtype, size_t ndim, const size_t* shape);
+
+size_t tensor_numel(const tensor_t* t);
+size_t tensor_element_size(const tensor_t* t);
+
+/*
+ * 1 if t is row major without gaps, so it can be passed as a plain array to the other kernels.
+ */
+int tensor_is_contiguous(const tensor_t* t);
+
+/*
+ * Views, they only compute the descriptor of view (which may be t).
+ *
+ * tensor_slice: ONNX Slice of dimension dim from start (inclusive) to end (exclusive) in steps of step,
+ * a negative step goes backwards from start. start and end are clamped like in ONNX (negative indices count
+ * from the end). Returns -1 if dim >= ndim or step == 0.
+ *
+ * tensor_transpose: dimension d of view is dimension perm[d] of t (reversed if perm is NULL).
+ * Returns -1 if perm is not a permutation.
+ *
+ * tensor_reshape: t with shape, without a copy if the dimensions of t merge or split into the new ones with
+ * their strides (always the case for contiguous tensors). Returns -1 if the number of elements differs or
+ * the reshape needs a copy (f.ex. of a transposed view), copy it with tensor_unary(TENSOR_IDENTITY) first.
+ *
+ * tensor_broadcast_to: ONNX Expand, t with its dimensions aligned at the last one and every dimension of
+ * size 1 (or missing) repeated to shape by a zero stride. Returns -1 if the shapes do not broadcast.
+ */
+int tensor_slice(const tensor_t* t, size_t dim, ptrdiff_t start, ptrdiff_t end, ptrdiff_t step, tensor_t* view);
+int tensor_transpose(const tensor_t* t, const size_t* perm, tensor_t* view);
+int tensor_reshape(const tensor_t* t, size_t ndim, const size_t* shape, tensor_t* view);
+int tensor_broadcast_to(const tensor_t* t, size_t ndim, const size_t* shape, tensor_t* view);
+
+/*
+ * ONNX Concat along axis into result. tensor_concat_views is the copy free Concat: it fills views with the num
+ * slices of result of sizes[i] elements of axis each, in which the producers of the inputs write their outputs
+ * directly. Returns -1 if axis >= ndim or the sizes do not add up to the axis of result.
+ *
+ * tensor_concat_dma is the Concat of inputs which already exist: the DM core writes every input into its slice
+ * of result with strided DMA transfers while the compute cores stay free. It must be called by all cores of the
+ * cluster and returns once all transfers completed (cluster barrier). F64 only, without negative strides (take
+ * tensor_unary(TENSOR_IDENTITY) into the views of tensor_concat_views otherwise); returns -1 for those and
+ * if the shapes do not match.
+ */
+int tensor_concat_views(const tensor_t* result, size_t axis, size_t num, const size_t* sizes, tensor_t* views);
+int tensor_concat_dma(const tensor_t* inputs, size_t num, size_t axis, const tensor_t* result);
+
+/*
+ * Configures the SSR stream dm to read (or write) the elements of the F64 tensor t in row major order,
+ * dimensions of size 1 are dropped and dimensions which are contiguous in each other merged.
+ */
+void tensor_ssr_read(const tensor_t* t, enum snrt_ssr_dm dm);
+void tensor_ssr_write(const tensor_t* t, enum snrt_ssr_dm dm);
+
+typedef enum {
+    TENSOR_IDENTITY, // copy, f.ex. to make a view contiguous or to write into a sub-tensor
+    TENSOR_NEG,
+    TENSOR_ABS,
+    TENSOR_RELU
+} tensor_unary_t;
+
+/*
+ * Elementwise kernels on descriptors: x (and y) and result have the same shape and any strides, every
+ * operand is one SSR stream with its strides as the loop strides (broadcast with tensor_broadcast_to).
+ * The loops are the dimensions of result, merged where all operands are contiguous.
+ * F32 operands (and casts between F64 and F32) take the C loops of the baseline, SSR streams whole 64 bit words.
+ * Returns -1 if the shapes differ.
+ * The parallel versions split the outermost loop among the compute cores.
+ */
+int tensor_unary_baseline(tensor_unary_t kind, const tensor_t* x, const tensor_t* result);
+int tensor_unary_ssr_frep(tensor_unary_t kind, const tensor_t* x, const tensor_t* result);
+int tensor_unary_ssr_frep_parallel(tensor_unary_t kind, const tensor_t* x, const tensor_t* result);
+
+int tensor_binary_baseline(broadcast_kind_t kind, const tensor_t* a, const tensor_t* b, const tensor_t* result);
+int tensor_binary_ssr_frep(broadcast_kind_t kind, const tensor_t* a, const tensor_t* b, const tensor_t* result);
+int tensor_binary_ssr_frep_parallel(broadcast_kind_t kind, const tensor_t* a, const tensor_t* b,
+                                    const tensor_t* result);
+
+/*
+ * result (m x k) = a (m x n) times b (n x k) on 2D descriptors, like gemm_ssr_frep with the strides of the
+ * operands in the read streams, f.ex. a transposed weight without a transpose. The parallel version splits
+ * the rows of result among the compute cores. Returns -1 if the shapes do not match.
+ */
+int tensor_gemm_baseline(const tensor_t* a, const tensor_t* b, const tensor_t* result);
+int tensor_gemm_ssr_frep(const tensor_t* a, const tensor_t* b, const tensor_t* result);
+int tensor_gemm_ssr_frep_parallel(const tensor_t* a, const tensor_t* b, const tensor_t* result);
+
+#endif
@@ -0,0 +1,347 @@
+#include "tile.h"
+
+#include <snrt.h>
+
+#include <math.h>
+
+// Shared between all cores of the cluster
+double* tile_l1_buffer = NULL;
+
+double* tile_l1_scratch() {
+    if (snrt_is_dm_core() && tile_l1_buffer == NULL) {
+        tile_l1_buffer = snrt_l1alloc(LMQ_TILE_L1_SIZE);
+    }
+    snrt_cluster_hw_barrier();
+
+    return tile_l1_buffer;
+}
+
+__attribute__((noinline))
+int tile_pipeline_run(const tile_pipeline_t* p) {
+    size_t num_tiles = p->num_tiles;
+    int is_dm = snrt_is_dm_core();
+
+    if (num_tiles == 0) {
+        return 0;
+    }
+
+    // Prologue: fetch the first tile
+    if (is_dm) {
+        p->load(p, 0, 0);
+        snrt_dma_wait_all();
+    }
+    snrt_cluster_hw_barrier();
+
+    for (size_t t = 0; t < num_tiles; t++) {
+        if (is_dm) {
+            // Fetch tile t+1 and write back tile t-1 while tile t is computed
+            if (t + 1 < num_tiles) {
+                p->load(p, t + 1, (t + 1) % LMQ_TILE_SLOTS);
+            }
+            if (t > 0 && p->store != NULL) {
+                p->store(p, t - 1, (t - 1) % LMQ_TILE_SLOTS);
+            }
+            snrt_dma_wait_all();
+        } else {
+            p->compute(p, t, t % LMQ_TILE_SLOTS);
+        }
+        snrt_cluster_hw_barrier();
+    }
+
+    // Epilogue: write back the last tile
+    if (is_dm && p->store != NULL) {
+        p->store(p, num_tiles - 1, (num_tiles - 1) % LMQ_TILE_SLOTS);
+        snrt_dma_wait_all();
+    }
+    snrt_cluster_hw_barrier();
+
+    return 0;
+}
+
+/*
+ * Context of an elementwise pipeline. Every core builds its own (identical) copy.
+ */
+typedef struct {
+    size_t num_inputs;
+    tile_unary_kernel_t unary;
+    tile_unary_scalar_kernel_t unary_scalar;
+    tile_binary_kernel_t binary;
+    tile_reduce_kernel_t reduce;
+    tile_reduce_binary_kernel_t reduce_binary;
+    tile_argmax_kernel_t argmax;
+    tile_scan_kernel_t scan;
+    reduce_op_t op;
+    double scalar;
+
+    // Result of the own core over the tiles so far (index -1 if it had no elements yet), the carry of a scan
+    double partial;
+    int partial_index;
+
+    double* inputs[LMQ_TILE_MAX_INPUTS];
+    double* result;
+    size_t n;
+    size_t tile_n;
+    int has_result;
+
+    double* l1_inputs[LMQ_TILE_SLOTS][LMQ_TILE_MAX_INPUTS];
+    double* l1_result[LMQ_TILE_SLOTS];
+} tile_elementwise_t;
+
+static size_t elementwise_tile_len(const tile_elementwise_t* e, size_t tile) {
+    size_t start = tile * e->tile_n;
+    return e->n - start < e->tile_n ? e->n - start : e->tile_n;
+}
+
+static void elementwise_load(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    const tile_elementwise_t* e = p->ctx;
+    size_t offset = tile * e->tile_n;
+    size_t len = elementwise_tile_len(e, tile);
+
+    for (size_t i = 0; i < e->num_inputs; i++) {
+        snrt_dma_start_1d(e->l1_inputs[slot][i], e->inputs[i] + offset, len * sizeof(double));
+    }
+}
+
+static void elementwise_store(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    const tile_elementwise_t* e = p->ctx;
+    size_t offset = tile * e->tile_n;
+    size_t len = elementwise_tile_len(e, tile);
+
+    snrt_dma_start_1d(e->result + offset, e->l1_result[slot], len * sizeof(double));
+}
+
+/*
+ * Combines the result of a part into the partial of a core for REDUCE_SUM, REDUCE_MAX and REDUCE_MIN.
+ */
+static inline double tile_combine(reduce_op_t op, double partial, double value) {
+    switch (op) {
+    case REDUCE_MAX:
+        return fmax(partial, value);
+    case REDUCE_MIN:
+        return fmin(partial, value);
+    default:
+        return partial + value;
+    }
+}
+
+static void elementwise_compute(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    // The partials are updated, every core has its own context
+    tile_elementwise_t* e = p->ctx;
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t len = elementwise_tile_len(e, tile);
+    size_t local_n = len / core_num;
+    size_t leftover = len - local_n * core_num;
+
+    // The first 'leftover' cores do one more element
+    size_t start = core_idx * local_n + (core_idx < leftover ? core_idx : leftover);
+    size_t count = local_n + (core_idx < leftover ? 1 : 0);
+
+    double* a = e->l1_inputs[slot][0] + start;
+
+    // All compute cores take part in the scan of the sums of the parts, also with an empty part
+    if (e->scan) {
+        double sum = 0.0;
+        if (count > 0) {
+            e->reduce(a, count, &sum);
+        }
+        double total;
+        double offset = scan_team(sum, &total);
+        if (count > 0) {
+            e->scan(a, count, e->partial + offset, e->l1_result[slot] + start);
+        }
+        e->partial += total;
+        return;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    if (e->argmax) {
+        int index;
+        e->argmax(a, count, &index);
+        // The tiles and the parts of a core come in order, so a strict compare keeps the first maximum of the
+        // core, reduce_cluster keeps the smaller index of equal maxima of the cores
+        if (e->partial_index < 0 || a[index] > e->partial) {
+            e->partial = a[index];
+            e->partial_index = tile * e->tile_n + start + index;
+        }
+        return;
+    }
+
+    if (e->reduce || e->reduce_binary) {
+        double value;
+        if (e->reduce_binary) {
+            e->reduce_binary(a, e->l1_inputs[slot][1] + start, count, &value);
+        } else {
+            e->reduce(a, count, &value);
+        }
+        e->partial = tile_combine(e->op, e->partial, value);
+        return;
+    }
+
+    double* result = e->l1_result[slot] + start;
+
+    if (e->binary) {
+        e->binary(a, e->l1_inputs[slot][1] + start, count, result);
+    } else if (e->unary_scalar) {
+        e->unary_scalar(a, count, e->scalar, result);
+    } else {
+        e->unary(a, count, result);
+    }
+}
+
+static int tile_elementwise(tile_elementwise_t* e) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    double* l1 = tile_l1_scratch();
+
+    // Each slot holds num_inputs buffers and the one of the result. Every buffer gets one
+    // guard element as SSR sometimes writes one more element than requested.
+    size_t buffers = LMQ_TILE_SLOTS * (e->num_inputs + (e->has_result ? 1 : 0));
+    size_t tile_n = LMQ_TILE_L1_SIZE / sizeof(double) / buffers - 1;
+
+    // Keep tiles a multiple of the core count so that every core gets the same work
+    if (tile_n > core_num) {
+        tile_n -= tile_n % core_num;
+    }
+    e->tile_n = tile_n;
+
+    for (size_t s = 0; s < LMQ_TILE_SLOTS; s++) {
+        for (size_t i = 0; i < e->num_inputs; i++) {
+            e->l1_inputs[s][i] = l1;
+            l1 += tile_n + 1;
+        }
+        if (e->has_result) {
+            e->l1_result[s] = l1;
+            l1 += tile_n + 1;
+        }
+    }
+
+    tile_pipeline_t p = {
+        .num_tiles = (e->n + tile_n - 1) / tile_n,
+        .load = elementwise_load,
+        .compute = elementwise_compute,
+        .store = e->has_result ? elementwise_store : NULL,
+        .ctx = e,
+    };
+
+    return tile_pipeline_run(&p);
+}
+
+__attribute__((noinline))
+int tile_unary(tile_unary_kernel_t kernel, double* arr, const size_t n, double* result) {
+    tile_elementwise_t e = {
+        .num_inputs = 1,
+        .unary = kernel,
+        .inputs = { arr },
+        .result = result,
+        .n = n,
+        .has_result = 1,
+    };
+    return tile_elementwise(&e);
+}
+
+__attribute__((noinline))
+int tile_unary_scalar(tile_unary_scalar_kernel_t kernel, double* arr, const size_t n, double scalar, double* result) {
+    tile_elementwise_t e = {
+        .num_inputs = 1,
+        .unary_scalar = kernel,
+        .scalar = scalar,
+        .inputs = { arr },
+        .result = result,
+        .n = n,
+        .has_result = 1,
+    };
+    return tile_elementwise(&e);
+}
+
+__attribute__((noinline))
+int tile_binary(tile_binary_kernel_t kernel, double* a, double* b, const size_t n, double* result) {
+    tile_elementwise_t e = {
+        .num_inputs = 2,
+        .binary = kernel,
+        .inputs = { a, b },
+        .result = result,
+        .n = n,
+        .has_result = 1,
+    };
+    return tile_elementwise(&e);
+}
+
+/*
+ * The DM core and the compute cores without elements reduce their neutral partial.
+ */
+__attribute__((noinline))
+int tile_reduce(tile_reduce_kernel_t kernel, reduce_op_t op, const double* arr, const size_t n, double* result) {
+    tile_elementwise_t e = {
+        .num_inputs = 1,
+        .reduce = kernel,
+        .op = op,
+        .partial = op == REDUCE_MAX ? -INFINITY : op == REDUCE_MIN ? INFINITY : 0.0,
+        .inputs = { (double*) arr },
+        .n = n,
+    };
+    tile_elementwise(&e);
+
+    double value = reduce_cluster(op, e.partial, 0, NULL);
+    if (snrt_cluster_core_idx() == 0) {
+        *result = value;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int tile_reduce_binary(tile_reduce_binary_kernel_t kernel, reduce_op_t op, const double* a, const double* b,
+                       const size_t n, double* result) {
+    tile_elementwise_t e = {
+        .num_inputs = 2,
+        .reduce_binary = kernel,
+        .op = op,
+        .partial = op == REDUCE_MAX ? -INFINITY : op == REDUCE_MIN ? INFINITY : 0.0,
+        .inputs = { (double*) a, (double*) b },
+        .n = n,
+    };
+    tile_elementwise(&e);
+
+    double value = reduce_cluster(op, e.partial, 0, NULL);
+    if (snrt_cluster_core_idx() == 0) {
+        *result = value;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int tile_argmax(tile_argmax_kernel_t kernel, const double* arr, const size_t n, int* result) {
+    tile_elementwise_t e = {
+        .num_inputs = 1,
+        .argmax = kernel,
+        .partial = -INFINITY,
+        .partial_index = -1,
+        .inputs = { (double*) arr },
+        .n = n,
+    };
+    tile_elementwise(&e);
+
+    int index;
+    reduce_cluster(REDUCE_ARGMAX, e.partial, e.partial_index, &index);
+    if (snrt_cluster_core_idx() == 0) {
+        *result = index;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int tile_scan(tile_reduce_kernel_t sum, tile_scan_kernel_t scan, const double* arr, const size_t n, double* result) {
+    tile_elementwise_t e = {
+        .num_inputs = 1,
+        .reduce = sum,
+        .scan = scan,
+        .partial = 0.0,
+        .inputs = { (double*) arr },
+        .result = result,
+        .n = n,
+        .has_result = 1,
+    };
+    return tile_elementwise(&e);
+}
@@ -0,0 +1,92 @@
+#ifndef LMQ_TILE_H
+#define LMQ_TILE_H
+
+#include <snrt.h>
+
+#include "reduce.h"
+
+/*
+ * Size (in bytes) of the L1 scratch buffer used by the tiling engine.
+ */
+#ifndef LMQ_TILE_L1_SIZE
+#define LMQ_TILE_L1_SIZE (32 * 1024)
+#endif
+
+/*
+ * Number of L1 buffer slots per stream (2 = ping-pong).
+ */
+#define LMQ_TILE_SLOTS 2
+
+/*
+ * Maximal number of input streams of an elementwise kernel.
+ */
+#define LMQ_TILE_MAX_INPUTS 2
+
+typedef struct tile_pipeline tile_pipeline_t;
+
+/*
+ * A double buffered pipeline over num_tiles tiles.
+ * load and store are called on the DM core and only start DMA transfers
+ * (the pipeline waits for them). compute is called on every compute core
+ * for the tile residing in the given slot while the DM core moves the
+ * next tile in and the previous one out. store may be NULL if nothing is written back.
+ */
+struct tile_pipeline {
+    size_t num_tiles;
+    void (*load)(const tile_pipeline_t* p, size_t tile, size_t slot);
+    void (*compute)(const tile_pipeline_t* p, size_t tile, size_t slot);
+    void (*store)(const tile_pipeline_t* p, size_t tile, size_t slot);
+    void* ctx;
+};
+
+/*
+ * Returns the L1 scratch buffer of LMQ_TILE_L1_SIZE bytes.
+ * Must be called by all cores of the cluster (the first call allocates it).
+ */
+double* tile_l1_scratch();
+
+/*
+ * Runs the pipeline p. Must be called by all cores of the cluster (including the DM core).
+ */
+int tile_pipeline_run(const tile_pipeline_t* p);
+
+typedef int (*tile_unary_kernel_t)(double* arr, const size_t n, double* result);
+typedef int (*tile_unary_scalar_kernel_t)(double* arr, const size_t n, double scalar, double* result);
+typedef int (*tile_binary_kernel_t)(double* a, double* b, const size_t n, double* result);
+
+/*
+ * Runs a single core elementwise kernel (f.ex. fabs_ssr_frep) on all compute cores
+ * while the inputs are streamed through L1 in tiles.
+ * Must be called by all cores of the cluster (including the DM core).
+ */
+int tile_unary(tile_unary_kernel_t kernel, double* arr, const size_t n, double* result);
+int tile_unary_scalar(tile_unary_scalar_kernel_t kernel, double* arr, const size_t n, double scalar, double* result);
+int tile_binary(tile_binary_kernel_t kernel, double* a, double* b, const size_t n, double* result);
+
+typedef int (*tile_reduce_kernel_t)(const double* arr, const size_t n, double* result);
+typedef int (*tile_reduce_binary_kernel_t)(const double* a, const double* b, const size_t n, double* result);
+typedef int (*tile_argmax_kernel_t)(const double* arr, const size_t n, int* result);
+typedef int (*tile_scan_kernel_t)(const double* arr, const size_t n, double offset, volatile double* result);
+
+/*
+ * Reductions of the inputs streamed through L1 like tile_unary: kernel reduces the part of a tile of a
+ * compute core (f.ex. max_ssr_frep_staggered), every core combines the results of its parts with op and
+ * after the last tile the partials are combined by reduce_cluster. Nothing is written back, so the DM core
+ * only fetches and the tiles use all of L1 for the inputs. tile_reduce_binary reduces two inputs
+ * (f.ex. a dot product with REDUCE_SUM), tile_argmax keeps the first maximum of all tiles.
+ * The result is written by core 0. Must be called by all cores of the cluster (including the DM core).
+ */
+int tile_reduce(tile_reduce_kernel_t kernel, reduce_op_t op, const double* arr, const size_t n, double* result);
+int tile_reduce_binary(tile_reduce_binary_kernel_t kernel, reduce_op_t op, const double* a, const double* b,
+                       const size_t n, double* result);
+int tile_argmax(tile_argmax_kernel_t kernel, const double* arr, const size_t n, int* result);
+
+/*
+ * Inclusive scan through L1 like tile_unary: every compute core sums its part of the tile with sum,
+ * the sums are scanned by scan_team (the DM core is moving the next tile meanwhile) and scan writes the
+ * scan of the part starting at the sum of everything before it. The carry of all previous tiles is kept
+ * on every core. Must be called by all cores of the cluster (including the DM core).
+ */
+int tile_scan(tile_reduce_kernel_t sum, tile_scan_kernel_t scan, const double* arr, const size_t n, double* result);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <math.h>
 #include "lmq.h"
+#include "tile.h"
 
 /*
  * Naive implementation of abs. Calculates for each element in x its absolute value and stores it in result
@@ -258,3 +259,59 @@ int fabs_ssr_frep_omp(double *arr, const size_t n, double *result) {
 
     return 0;
 }
+
+/*
+ * Streams arr through L1 in double buffered tiles (moved by the DM core)
+ * while the compute cores run fabs_ssr_frep on the current tile.
+ */
+__attribute__((noinline))
+int fabs_ssr_frep_tiled(double *arr, const size_t n, double *result) {
+    return tile_unary(fabs_ssr_frep, arr, n, result);
+}
+
+__attribute__((noinline))
+int fabs_baseline_f32(float *arr, const size_t n, float* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = fabsf(arr[i]);
+    }
+
+    return 0;
+}
+
+/*
+ * float32 abs on packed pairs (vfsgnjx.s clears both sign bits).
+ * An odd last element is done by the core as a float stream would overwrite
+ * the element behind it (see src/bugs/ssr_anomaly.c).
+ */
+__attribute__((noinline))
+int fabs_ssr_frep_f32(float *x, const size_t n, float* result) {
+    size_t pairs = n / 2;
+
+    if (pairs > 0) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, pairs, sizeof(f32x2_t));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, x);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, pairs, sizeof(f32x2_t));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n], 1, 0, 0\n"
+            "vfsgnjx.s ft1, ft0, ft0 \n"
+            :: [n]"r"(pairs - 1)
+            : "ft0", "ft1"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+
+    if (n % 2) {
+        result[n - 1] = fabsf(x[n - 1]);
+    }
+
+    return 0;
+}
@@ -15,4 +15,9 @@ int fabs_omp(double *arr, const size_t n, double *result);
 int fabs_ssr_omp(double *arr, const size_t n, double *result);
 int fabs_ssr_frep_omp(double *arr, const size_t n, double *result);
 
+int fabs_ssr_frep_tiled(double *arr, const size_t n, double *result);
+
+int fabs_baseline_f32(float *arr, const size_t n, float *result);
+int fabs_ssr_frep_f32(float *arr, const size_t n, float *result);
+
 #endif
@@ -1,9 +1,16 @@
-
 #include <snrt.h>
 
 #include <math.h>
 #include <acos.h>
 
+#include "lmq.h"
+#include "fpmath.h"
+#include "kernel.h"
+
+#ifndef M_PI
+#   define M_PI 3.14159265358979323846
+#endif
+
 /*
  * Naive implementation of acos. Calculates the acos of n elements starting at arr.
  */
@@ -16,76 +23,89 @@ int acos_baseline(double* arr, const size_t n, double* result) {
     return 0;
 }
 
-__attribute__((noinline))
-int acos_ssr(double* arr, const size_t n, double* result) {
-    register volatile double ft0 asm("ft0");
-    register volatile double ft1 asm("ft1");
-
-    asm volatile("" : "=f"(ft0));
-
-    // stream arr into ft0
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
-
-    // stream from ft1 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
-
-    snrt_ssr_enable();
-
-    for (size_t i = 0; i < n; i++) {
-        asm volatile(
-            "fmv.d fa0, ft0\n" // fa0 <- ft0
-            ::: "fa0", "ft0"
-        );
+// acos(a) / sqrt(1 - a) on [0, 1], Chebyshev fit
+static const double acos_poly[] = {
+    1.5707963267948444, -0.21460183657910584, 0.089048620781648186, -0.050792761639411786,
+    0.033680450206154927, -0.02436627851037277, 0.018621081884354376, -0.014658985731390808,
+    0.011487814056211694, -0.008492698836683606, 0.0055096956183357786, -0.0028846709989011287,
+    0.0011055984223882357, -0.00026987443367640178, 3.1081338723500572e-05
+};
 
-        /*
-         * We disable SSR as every read to 'ft0' will fetch the
-         * next element from the defined stream. And any called function
-         * may use the ft0 register (as it is caller saved)
-         */
-        __builtin_ssr_disable();
+/*
+ * acos(x) = sqrt(1 - |x|) * P(|x|) for x >= 0 and pi minus that for x < 0.
+ * Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void acos_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    // (1 - |x|, 1) for the square root
+    fpmath_pass_begin(arr, carry, 0, 2, NULL, count);
+    FPMATH_PASS(frep, count, 3,
+        "fsgnj.d ft3, ft0, %[one] \n"
+        "fsub.d ft2, %[one], ft3 \n"
+        "fmv.d ft2, %[one] \n",
+        [one] "f"(1.0));
+    fpmath_pass_end();
+
+    fpmath_sqrt(carry, count, NULL, frep);
+
+    fpmath_pass_begin(arr, carry, 1, 1, NULL, count);
+    FPMATH_PASS(frep, count, 16,
+        "fsgnj.d ft3, ft0, %[one] \n"
+        "fmadd.d ft4, ft3, %[c14], %[c13] \n"
+        "fmadd.d ft4, ft4, ft3, %[c12] \n"
+        "fmadd.d ft4, ft4, ft3, %[c11] \n"
+        "fmadd.d ft4, ft4, ft3, %[c10] \n"
+        "fmadd.d ft4, ft4, ft3, %[c9] \n"
+        "fmadd.d ft4, ft4, ft3, %[c8] \n"
+        "fmadd.d ft4, ft4, ft3, %[c7] \n"
+        "fmadd.d ft4, ft4, ft3, %[c6] \n"
+        "fmadd.d ft4, ft4, ft3, %[c5] \n"
+        "fmadd.d ft4, ft4, ft3, %[c4] \n"
+        "fmadd.d ft4, ft4, ft3, %[c3] \n"
+        "fmadd.d ft4, ft4, ft3, %[c2] \n"
+        "fmadd.d ft4, ft4, ft3, %[c1] \n"
+        "fmadd.d ft4, ft4, ft3, %[c0] \n"
+        "fmul.d ft2, ft4, ft1 \n",
+        [one] "f"(1.0),
+        [c0] "f"(acos_poly[0]), [c1] "f"(acos_poly[1]), [c2] "f"(acos_poly[2]), [c3] "f"(acos_poly[3]),
+        [c4] "f"(acos_poly[4]), [c5] "f"(acos_poly[5]), [c6] "f"(acos_poly[6]), [c7] "f"(acos_poly[7]),
+        [c8] "f"(acos_poly[8]), [c9] "f"(acos_poly[9]), [c10] "f"(acos_poly[10]), [c11] "f"(acos_poly[11]),
+        [c12] "f"(acos_poly[12]), [c13] "f"(acos_poly[13]), [c14] "f"(acos_poly[14]));
+    fpmath_pass_end();
+
+    // r + w * (pi - 2 r) with w = 1 for negative x and 0 otherwise
+    fpmath_pass_begin(arr, carry, 1, 1, result, count);
+    FPMATH_PASS(frep, count, 5,
+        "fmv.d ft3, ft1 \n"
+        "fsgnjn.d ft4, %[one], ft0 \n"
+        "fmax.d ft4, ft4, %[zero] \n"
+        "fnmsub.d ft5, ft3, %[two], %[pi] \n"
+        "fmadd.d ft2, ft4, ft5, ft3 \n",
+        [one] "f"(1.0), [zero] "f"(0.0), [two] "f"(2.0), [pi] "f"(M_PI));
+    fpmath_pass_end();
+}
 
-        /*
-         * As this is a function call we MUST have "ra" in the clobber.
-         * Else the compiler does not know that this function needs to 
-         * store 'ra' on the stack (or in some caller saved register) as it
-         * may get modified in the call.
-         * Same for all other caller saved registers below (in the clobber).
-        */
-        asm volatile(
-            "call %[add_one]\n"
-            :: [add_one] "i"(acosf)
-            : 
-            "fa0", "fa1", "fa2", "fa3", "fa4", "fa5", "fa6", "fa7",
-            "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", 
-            "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
-            "ra"
-        );
+static inline void acos_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
 
-        __builtin_ssr_enable();
-        
-        asm volatile(
-            "fmv.d ft1, fa0" // ft1 <- fa0
-            ::: "ft1", "fa0"
-        );
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        acos_block(arr + i, count, result + i, carry, frep);
     }
+}
 
-    snrt_ssr_disable();
-    asm volatile("" :: "f"(ft1));
-
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int acos_ssr(double* arr, const size_t n, double* result) {
+    acos_range(arr, n, result, 0);
     return 0;
 }
 
 __attribute__((noinline))
 int acos_ssr_frep(double* arr, const size_t n, double* result) {
-    (void) arr, (void) n, (void) result;
-    /*
-     * I do not think we can optimize anything with FREP.
-     * As we have a call to another function which consists of many more
-     * assembly instructions.
-     */
+    acos_range(arr, n, result, 1);
     return 0;
 }
+
+KERNEL_UNARY_SPLIT(acos, double, acos_range)
@@ -1,9 +1,15 @@
-
 #include <snrt.h>
 
 #include <math.h>
 #include <acosh.h>
 
+#include "lmq.h"
+#include "fpmath.h"
+#include "kernel.h"
+
+// Larger inputs are clamped, x + sqrt(x^2 - 1) has to stay below the range of fpmath_log1p
+#define ACOSH_X_MAX 0x1p62
+
 /*
  * Naive implementation of acosh. Calculates the acos of n elements starting at arr.
  */
@@ -16,57 +22,60 @@ int acosh_baseline(double* arr, const size_t n, double* result) {
     return 0;
 }
 
-__attribute__((noinline))
-int acosh_ssr(double* arr, const size_t n, double* result) {
-    register volatile double ft0 asm("ft0");
-    register volatile double ft1 asm("ft1");
+/*
+ * acosh(x) = log1p(x - 1 + x * sqrt(1 - 1 / x^2)), where 1 - 1 / x^2 = (1 - 1 / x) * (1 + 1 / x)
+ * keeps the precision close to 1. Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void acosh_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    // (1 - 1 / x^2, 1) for the square root
+    fpmath_pass_begin(arr, carry, 0, 2, NULL, count);
+    FPMATH_PASS(frep, count, 6,
+        "fmin.d ft3, ft0, %[x_max] \n"
+        "fsub.d ft4, ft3, %[one] \n"
+        "fdiv.d ft5, %[one], ft3 \n"
+        "fmul.d ft4, ft4, ft5 \n"
+        "fmadd.d ft2, ft4, ft5, ft4 \n"
+        "fmv.d ft2, %[one] \n",
+        [one] "f"(1.0), [x_max] "f"(ACOSH_X_MAX));
+    fpmath_pass_end();
 
-    asm volatile("" : "=f"(ft0));
+    fpmath_sqrt(carry, count, NULL, frep);
 
-    // stream arr into ft0
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
+    // (x - 1 + x * sqrt(1 - 1 / x^2), 0) for the logarithm
+    fpmath_pass_begin(arr, carry, 1, 2, NULL, count);
+    FPMATH_PASS(frep, count, 4,
+        "fmin.d ft3, ft0, %[x_max] \n"
+        "fsub.d ft4, ft3, %[one] \n"
+        "fmadd.d ft2, ft3, ft1, ft4 \n"
+        "fmv.d ft2, %[zero] \n",
+        [one] "f"(1.0), [zero] "f"(0.0), [x_max] "f"(ACOSH_X_MAX));
+    fpmath_pass_end();
 
-    // stream from ft1 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
+    fpmath_log1p(arr, carry, count, result, frep);
+}
 
-    snrt_ssr_enable();
+static inline void acosh_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
 
-    for (size_t i = 0; i < n; i++) {
-        volatile register double d;
-        asm volatile(
-            "fmv.d %[var], ft0\n" // d <- ft0
-            : [var]"=f"(d)
-            :: "ft0", "memory"
-        );
-
-        __builtin_ssr_disable();
-        d = acosh(d);
-        __builtin_ssr_enable();
-        
-        asm volatile(
-            "fmv.d ft1, %[var]" // ft1 <- d
-            :: [var]"f"(d)
-            : "ft1", "memory"
-        );
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        acosh_block(arr + i, count, result + i, carry, frep);
     }
+}
 
-    snrt_ssr_disable();
-    asm volatile("" :: "f"(ft1));
-
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int acosh_ssr(double* arr, const size_t n, double* result) {
+    acosh_range(arr, n, result, 0);
     return 0;
 }
 
 __attribute__((noinline))
 int acosh_ssr_frep(double* arr, const size_t n, double* result) {
-    (void) arr, (void) n, (void) result;
-    /*
-     * I do not think we can optimize anything with FREP.
-     * As we have a call to another function which consists of many more
-     * assembly instructions.
-     */
+    acosh_range(arr, n, result, 1);
     return 0;
 }
+
+KERNEL_UNARY_SPLIT(acosh, double, acosh_range)
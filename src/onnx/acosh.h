@@ -1,6 +1,5 @@
-
-#ifndef LMQ_ACOS_H
-#define LMQ_ACOS_H
+#ifndef LMQ_ACOSH_H
+#define LMQ_ACOSH_H
 
 #include <snrt.h>
 
@@ -8,9 +7,17 @@
 
 /*
  * Naive implementation of acosh. Calculates the acosh of n elements starting at arr.
+ * The ssr versions run the FP only passes of fpmath (max relative error 2e-15 for x >= 1,
+ * inputs above 2^62 give acosh(2^62)), the parallel and OMP versions split the elements over the compute cores.
  */
 int acosh_baseline(double* arr, const size_t n, double* result);
 int acosh_ssr(double* arr, const size_t n, double* result);
 int acosh_ssr_frep(double* arr, const size_t n, double* result);
+int acosh_parallel(double* arr, const size_t n, double* result);
+int acosh_ssr_parallel(double* arr, const size_t n, double* result);
+int acosh_ssr_frep_parallel(double* arr, const size_t n, double* result);
+int acosh_omp(double* arr, const size_t n, double* result);
+int acosh_ssr_omp(double* arr, const size_t n, double* result);
+int acosh_ssr_frep_omp(double* arr, const size_t n, double* result);
 
 #endif
@@ -1,9 +1,13 @@
 #include "printf.h"
 #include <snrt.h>
-#include "omp.h"
 
 #include "lmq.h"
 
+#ifndef LMQ_HOST
+#include "omp.h"
+#include "tile.h"
+#endif
+
 /*
  * Naive implementation of add. Adds a and b element wise into result.
  */
@@ -15,6 +19,8 @@ int add_baseline(double *a, double* b, const size_t n, double* result) {
     return 0;
 }
 
+#ifndef LMQ_HOST
+
 
 __attribute__((noinline))
 int add_ssr(double *a, double* b, const size_t n, double* result) {
@@ -290,3 +296,98 @@ int add_ssr_frep_omp(double *a, double *b, const size_t n, double *result) {
 
     return 0;
 }
+
+/*
+ * Streams a and b through L1 in double buffered tiles (moved by the DM core)
+ * while the compute cores run add_ssr_frep on the current tile.
+ */
+__attribute__((noinline))
+int add_ssr_frep_tiled(double *a, double *b, const size_t n, double *result) {
+    return tile_binary(add_ssr_frep, a, b, n, result);
+}
+
+/*
+ * float32 versions. Pairs of elements are streamed as one 64 bit word and added with
+ * a single packed instruction. An odd last element is added by the core as a float
+ * stream would overwrite the element behind it (see src/bugs/ssr_anomaly.c).
+ */
+__attribute__((noinline))
+int add_baseline_f32(float *a, float* b, const size_t n, float* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = a[i] + b[i];
+    }
+    return 0;
+}
+
+/*
+ * Adds pairs pairs of elements starting at a, b and result with SSR and FREP.
+ */
+static inline void add_pairs_f32(float *a, float* b, const size_t pairs, float* result) {
+    if (pairs == 0) {
+        return;
+    }
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, pairs, sizeof(f32x2_t));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, pairs, sizeof(f32x2_t));
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, b);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, pairs, sizeof(f32x2_t));
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
+
+    snrt_ssr_enable();
+
+    asm volatile(
+        "frep.o %[n_frep], 1, 0, 0 \n"
+        "vfadd.s ft2, ft0, ft1 \n"
+        :: [n_frep] "r"(pairs - 1) : "ft0", "ft1", "ft2"
+    );
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+__attribute__((noinline))
+int add_ssr_frep_f32(float *a, float* b, const size_t n, float* result) {
+    add_pairs_f32(a, b, n / 2, result);
+
+    if (n % 2) {
+        result[n - 1] = a[n - 1] + b[n - 1];
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int add_ssr_frep_parallel_f32(float *a, float *b, const size_t n, float *result) {
+    unsigned core_num = snrt_cluster_core_num() - 1;
+    unsigned core_idx = snrt_cluster_core_idx();
+    size_t pairs = n / 2;
+    size_t local_pairs = pairs / core_num;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t offset = 2 * core_idx * local_pairs;
+    add_pairs_f32(a + offset, b + offset, local_pairs, result + offset);
+
+    // Leftover pairs, one per core
+    if (core_idx < pairs - local_pairs * core_num) {
+        size_t i = 2 * (local_pairs * core_num + core_idx);
+        result[i] = a[i] + b[i];
+        result[i + 1] = a[i + 1] + b[i + 1];
+    }
+
+    if (core_idx == 0 && n % 2) {
+        result[n - 1] = a[n - 1] + b[n - 1];
+    }
+
+    return 0;
+}
+
+#endif // LMQ_HOST
@@ -16,4 +16,10 @@ int add_omp(double *a, double *b, const size_t n, double *result);
 int add_ssr_omp(double *a, double *b, const size_t n, double *result);
 int add_ssr_frep_omp(double *a, double *b, const size_t n, double *result);
 
+int add_ssr_frep_tiled(double *a, double *b, const size_t n, double *result);
+
+int add_baseline_f32(float *a, float *b, const size_t n, float *result);
+int add_ssr_frep_f32(float *a, float *b, const size_t n, float *result);
+int add_ssr_frep_parallel_f32(float *a, float *b, const size_t n, float *result);
+
 #endif
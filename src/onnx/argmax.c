@@ -1,9 +1,15 @@
-
 #include <snrt.h>
 
 #include <argmax.h>
+#include "lmq.h"
 #include <printf.h>
 #include <float.h>
+#include <math.h>
+
+#ifndef LMQ_HOST
+#include "reduce.h"
+#include "tile.h"
+#endif
 
 /*
  * Naive implementation of argmax. Calculates the argmax of n elements starting at arr.
@@ -25,6 +31,8 @@ int argmax_baseline(const double* arr, const size_t n, int* result) {
     return 0;
 }
 
+#ifndef LMQ_HOST
+
 __attribute__((noinline))
 int argmax_ssr(const double* arr, const size_t n, int* result) {
     register double max asm("ft1");
@@ -66,149 +74,364 @@ int argmax_ssr(const double* arr, const size_t n, int* result) {
     return 0;
 }
 
+/*
+ * Index of the first (or with last the last) element of the n elements base[i * stride] which is equal to max.
+ */
+static inline int argmax_locate(const double* base, size_t n, size_t stride, double max, int last) {
+    if (last) {
+        for (size_t i = n; i-- > 0;) {
+            if (base[i * stride] == max) {
+                return i;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            if (base[i * stride] == max) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+/*
+ * Using FREP we would need the same code repeated, but argmax
+ * needs a branch each iteration which is not possible.
+ * So the maximum is found by a staggered FREP reduction and its index by a
+ * second scan which stops at the first match (branches, but no FP dependency chain).
+ */
 __attribute__((noinline))
 int argmax_ssr_frep(const double* arr, const size_t n, int* result) {
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
+
+    snrt_ssr_enable();
+
+    double max = reduce_max_ssr_frep(n);
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+
+    *result = argmax_locate(arr, n, 1, max, 0);
 
-    /**
-     * Using FREP we would need the same code repeated, but argmax
-     * needs a branch each iteration this is not possible.
-     * This branch makes pipelining impossible.
-    */
     return 0;
 }
 
-// To allow IPC
-double* shared_max;
-size_t* shared_indices;
+/*
+ * Every core finds the maximum of a contiguous range, the partial maxima are combined by reduce_cluster.
+ */
 int argmax_parallel(double* arr, const size_t n, int* result) {
     size_t core_num = snrt_cluster_core_num() - 1;
     size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
 
-    int do_extra = 0;
-    if (core_idx < n - local_n * core_num) {
-        do_extra = 1;
+    double priv_max = -INFINITY;
+    int priv_max_index = -1;
+    if (!snrt_is_dm_core()) {
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+        for (size_t i = first; i < first + local_n; i++) {
+            if (priv_max_index < 0 || arr[i] > priv_max) {
+                priv_max = arr[i];
+                priv_max_index = i;
+            }
+        }
     }
-    double priv_max = FLT_MIN;
-    size_t priv_max_index = -1;
 
+    int index;
+    reduce_cluster(REDUCE_ARGMAX, priv_max, priv_max_index, &index);
     if (core_idx == 0) {
-        shared_max = allocate(core_num , sizeof(double));
-        shared_indices = allocate(core_num , sizeof(size_t));
+        *result = index;
     }
-    snrt_cluster_hw_barrier();
 
-    for (size_t i = local_n * core_idx; i < local_n * (core_idx + 1); i++) {
-        if (arr[i] > priv_max) {
-            priv_max = arr[i];
-            priv_max_index = i;
-        }
+    return 0;
+}
+
+int argmax_ssr_parallel(double* arr, const size_t n, int* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    double priv_max = -INFINITY;
+    volatile int priv_max_index = -1;
+
+    size_t first;
+    size_t local_n = local_range(n, core_idx, core_num, &first);
+    if (!snrt_is_dm_core() && local_n > 0) {
+        // stream arr into ft0
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + first);
+
+        snrt_ssr_enable();
+
+        // Strict compare so that the first maximum of the range is kept
+        asm volatile(
+            "add a0, %[index], zero\n"     // a0 <- first; a0 is the index
+            "addi a1, %[index], 1\n"       // a1 stores the max_index (+1), first if all are -inf
+            "1:\n"
+                "addi a0, a0, 1\n"
+                "fmv.d fa0, ft0\n"
+                "flt.d a2, %[max], fa0\n"
+                "beqz a2, 3f\n"
+                "fmv.d %[max], fa0\n"
+                "mv a1, a0\n"
+            "3:"
+            "blt a0, %[n], 1b\n"
+            "2:\n" // exit
+            "add %[max_index], a1, -1\n"        // as a1 is one too high
+            : [max] "+f" (priv_max), [max_index] "=r" (priv_max_index)
+            : [n] "r"(first + local_n), [index] "r" (first)
+            : "ft0", "fa0", "a0", "a1", "a2"
+        );
+
+        snrt_ssr_disable();
     }
-    if (do_extra) {
-        if (arr[local_n * core_num + core_idx] > priv_max) {
-            priv_max = arr[local_n * core_num + core_idx];
-            priv_max_index = local_n * core_num + core_idx;
-        }
+
+    int index;
+    reduce_cluster(REDUCE_ARGMAX, priv_max, priv_max_index, &index);
+    if (core_idx == 0) {
+        *result = index;
     }
 
-    snrt_cluster_hw_barrier();
-    shared_max[core_idx] = priv_max;
-    shared_indices[core_idx] = priv_max_index;
-    snrt_cluster_hw_barrier();
+    return 0;
+}
+
+int argmax_ssr_frep_parallel(double* arr, const size_t n, int* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
 
+    double priv_max = -INFINITY;
+    int priv_max_index = -1;
+
+    size_t first = 0;
+    size_t local_n = 0;
+    if (!snrt_is_dm_core()) {
+        local_n = local_range(n, core_idx, core_num, &first);
+    }
+    if (local_n > 0) {
+        argmax_ssr_frep(arr + first, local_n, &priv_max_index);
+        priv_max = arr[first + priv_max_index];
+        priv_max_index += first;
+    }
+
+    int index;
+    reduce_cluster(REDUCE_ARGMAX, priv_max, priv_max_index, &index);
     if (core_idx == 0) {
-        double max = FLT_MIN;
-        size_t index = -1;
-        for (size_t i = 0; i < core_num; i++) {
-            if (shared_max[i] > max) {
-                max = shared_max[i];
-                index = shared_indices[i];
+        *result = index;
+    }
+
+    return 0;
+}
+
+/*
+ * The DM core fetches the next tile into L1 while the compute cores search the current one.
+ */
+int argmax_ssr_frep_tiled(double* arr, const size_t n, int* result) {
+    return tile_argmax(argmax_ssr_frep, arr, n, result);
+}
+
+/*
+ * argmax_parallel and argmax_ssr_frep_parallel in an OMP team, the partial maxima are combined by reduce_team.
+ */
+int argmax_omp(double* arr, const size_t n, int* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        size_t core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+
+        double priv_max = -INFINITY;
+        int priv_max_index = -1;
+        for (size_t i = first; i < first + local_n; i++) {
+            if (priv_max_index < 0 || arr[i] > priv_max) {
+                priv_max = arr[i];
+                priv_max_index = i;
             }
         }
-        *result = index;
+
+        int index;
+        reduce_team(REDUCE_ARGMAX, priv_max, priv_max_index, &index);
+        if (core_idx == 0) {
+            *result = index;
+        }
     }
 
     return 0;
 }
 
-int argmax_ssr_parallel(double* arr, const size_t n, int* result) {
+int argmax_ssr_frep_omp(double* arr, const size_t n, int* result) {
     size_t core_num = snrt_cluster_core_num() - 1;
-    size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
 
-    if (snrt_is_dm_core()) {
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        return 0;
+#pragma omp parallel
+    {
+        size_t core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+
+        double priv_max = -INFINITY;
+        int priv_max_index = -1;
+        if (local_n > 0) {
+            argmax_ssr_frep(arr + first, local_n, &priv_max_index);
+            priv_max = arr[first + priv_max_index];
+            priv_max_index += first;
+        }
+
+        int index;
+        reduce_team(REDUCE_ARGMAX, priv_max, priv_max_index, &index);
+        if (core_idx == 0) {
+            *result = index;
+        }
     }
 
-    int do_extra = 0;
-    if (core_idx < n - local_n * core_num) {
-        do_extra = 1;
+    return 0;
+}
+
+/*
+ * The input viewed as (outer, n, inner) with n the length of axis.
+ * Returns -1 if the axis is out of range.
+ */
+static int argmax_axis_layout(const size_t* shape, size_t ndim, int axis, size_t* outer, size_t* n, size_t* inner) {
+    if (axis < 0) {
+        axis += ndim;
+    }
+    if (axis < 0 || axis >= (int)ndim) {
+        return -1;
     }
 
-    double priv_max = FLT_MIN;
-    volatile int priv_max_index = -1;
+    *outer = 1;
+    *inner = 1;
+    for (size_t d = 0; d < ndim; d++) {
+        if ((int)d < axis) {
+            *outer *= shape[d];
+        } else if ((int)d > axis) {
+            *inner *= shape[d];
+        }
+    }
+    *n = shape[axis];
+    return 0;
+}
 
-    if (core_idx == 0) {
-        shared_max = allocate(core_num , sizeof(double));
-        shared_indices = allocate(core_num , sizeof(size_t));
+__attribute__((noinline))
+int argmax_axis_baseline(const double* a, const size_t* shape, size_t ndim, int axis, int select_last_index, int* result) {
+    size_t outer, n, inner;
+    if (argmax_axis_layout(shape, ndim, axis, &outer, &n, &inner)) {
+        return -1;
     }
-    snrt_cluster_hw_barrier();
 
-    // stream arr into ft0
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + local_n * core_idx);
+    for (size_t o = 0; o < outer * inner; o++) {
+        const double* base = a + (o / inner) * n * inner + o % inner;
+        double max = base[0];
+        int index = 0;
+        for (size_t i = 1; i < n; i++) {
+            double v = base[i * inner];
+            if (v > max || (select_last_index && v == max)) {
+                max = v;
+                index = i;
+            }
+        }
+        result[o] = index;
+    }
+    return 0;
+}
 
-    snrt_ssr_enable();
+/*
+ * The outputs [o_first, o_first + o_count) in chunks of at most ARGMAX_CHUNK outputs with the same outer index.
+ * A 2D pattern (n, chunk) streams the chunk, the maxima are kept on the stack until the scans for the indices.
+ */
+#define ARGMAX_CHUNK 16
+static void argmax_axis_outputs(const double* a, size_t n, size_t inner, size_t o_first, size_t o_count,
+                                int select_last_index, int* result) {
+    double max[ARGMAX_CHUNK];
+
+    for (size_t o = o_first; o < o_first + o_count;) {
+        size_t run = inner - o % inner;
+        if (run > o_first + o_count - o) {
+            run = o_first + o_count - o;
+        }
+        if (run > ARGMAX_CHUNK) {
+            run = ARGMAX_CHUNK;
+        }
+        const double* base = a + (o / inner) * n * inner + o % inner;
 
-    asm volatile(
-        "add a0, %[index], zero\n"            // a0 <- 0; a0 is the index
-        "addi a1, zero, -1\n"           // a1 stores the max_index
-        "1:\n"
-            "addi a0, a0, 1\n"
-            "fmv.d fa0, ft0\n"
-            "fle.d a2, %[max], fa0\n"
-            "beqz a2, 3f\n"
-            "fmv.d %[max], fa0\n"
-            "mv a1, a0\n"
-        "3:"
-        "blt a0, %[n], 1b\n"
-        "2:\n" // exit
-        "add %[max_index], a1, -1\n"        // as a1 is one too high
-        : [max] "+f" (priv_max), [max_index] "=r" (priv_max_index)
-        : [n] "r"(local_n * (core_idx + 1)), [index] "r" (local_n * core_idx)
-        : "ft0", "ft2", "a0", "a1", "a2"
-    );
+        snrt_ssr_loop_2d(SNRT_SSR_DM0, n, run, sizeof(*a) * inner, sizeof(*a));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, base);
 
-    snrt_ssr_disable();
+        snrt_ssr_enable();
 
-    if (do_extra) {
-        if (arr[local_n * core_num + core_idx] > priv_max) {
-            priv_max = arr[local_n * core_num + core_idx];
-            priv_max_index = local_n * core_num + core_idx;
+        for (size_t i = 0; i < run; i++) {
+            max[i] = reduce_max_ssr_frep(n);
         }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+
+        for (size_t i = 0; i < run; i++) {
+            result[o + i] = argmax_locate(base + i, n, inner, max[i], select_last_index);
+        }
+
+        o += run;
     }
+}
 
-    snrt_cluster_hw_barrier();
-    shared_max[core_idx] = priv_max;
-    shared_indices[core_idx] = priv_max_index;
-    snrt_cluster_hw_barrier();
+__attribute__((noinline))
+int argmax_axis_ssr_frep(const double* a, const size_t* shape, size_t ndim, int axis, int select_last_index, int* result) {
+    size_t outer, n, inner;
+    if (argmax_axis_layout(shape, ndim, axis, &outer, &n, &inner)) {
+        return -1;
+    }
 
-    // This is not using SSR, but this is O(#cores) which is low
-    if (core_idx == 0) {
-        double max = FLT_MIN;
-        size_t index = -1;
-        for (size_t i = 0; i < core_num; i++) {
-            if (shared_max[i] > max) {
-                max = shared_max[i];
-                index = shared_indices[i];
-            }
+    argmax_axis_outputs(a, n, inner, 0, outer * inner, select_last_index, result);
+    return 0;
+}
+
+/*
+ * The outputs are split over the cores. A single output (f.ex. a batch of one) is split along the axis
+ * instead and the partial results are combined with reduce_cluster.
+ */
+__attribute__((noinline))
+int argmax_axis_ssr_frep_parallel(const double* a, const size_t* shape, size_t ndim, int axis, int select_last_index, int* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    size_t outer, n, inner;
+    if (argmax_axis_layout(shape, ndim, axis, &outer, &n, &inner)) {
+        return -1;
+    }
+
+    if (outer * inner == 1) {
+        double priv_max = -INFINITY;
+        int priv_max_index = -1;
+
+        size_t first = 0;
+        size_t local_n = 0;
+        if (!snrt_is_dm_core()) {
+            local_n = local_range(n, core_idx, core_num, &first);
         }
-        *result = index;
+        if (local_n > 0) {
+            argmax_axis_outputs(a + first, local_n, 1, 0, 1, select_last_index, &priv_max_index);
+            priv_max = a[first + priv_max_index];
+            priv_max_index += first;
+        }
+
+        int index;
+        reduce_cluster(select_last_index ? REDUCE_ARGMAX_LAST : REDUCE_ARGMAX, priv_max, priv_max_index, &index);
+        if (core_idx == 0) {
+            *result = index;
+        }
+        return 0;
     }
 
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t o_first;
+    size_t o_count = local_range(outer * inner, core_idx, core_num, &o_first);
+    argmax_axis_outputs(a, n, inner, o_first, o_count, select_last_index, result);
     return 0;
 }
+
+#endif // LMQ_HOST
@@ -15,5 +15,28 @@ int argmax_ssr_frep(const double* arr, const size_t n, int* result);
 
 int argmax_parallel(double* arr, const size_t n, int* result);
 int argmax_ssr_parallel(double* arr, const size_t n, int* result);
+int argmax_ssr_frep_parallel(double* arr, const size_t n, int* result);
+/*
+ * Streams arr through L1 in double buffered tiles (src/lmq/tile.h), must be called by all cores of the cluster.
+ */
+int argmax_ssr_frep_tiled(double* arr, const size_t n, int* result);
+
+/*
+ * The OMP versions combine the maxima of the cores with reduce_team, core 0 writes the result.
+ */
+int argmax_omp(double* arr, const size_t n, int* result);
+int argmax_ssr_frep_omp(double* arr, const size_t n, int* result);
+
+/*
+ * ONNX ArgMax of the row major tensor a of shape (shape[0], ..., shape[ndim - 1]) along axis
+ * (negative counts from the back). result holds the index along axis for every element of the
+ * other dimensions in their order, which is the same for keepdims 0 and 1.
+ * The first maximum is taken, or the last one with select_last_index.
+ * Returns -1 if the axis is out of range.
+ * The parallel version must be called by all cores of the cluster.
+ */
+int argmax_axis_baseline(const double* a, const size_t* shape, size_t ndim, int axis, int select_last_index, int* result);
+int argmax_axis_ssr_frep(const double* a, const size_t* shape, size_t ndim, int axis, int select_last_index, int* result);
+int argmax_axis_ssr_frep_parallel(const double* a, const size_t* shape, size_t ndim, int axis, int select_last_index, int* result);
 
 #endif
@@ -1,9 +1,20 @@
-
 #include <snrt.h>
 
 #include <math.h>
 #include <asinh.h>
 
+#include "lmq.h"
+#include "fpmath.h"
+#include "kernel.h"
+
+// Larger inputs are clamped, 2 |x| has to stay below the range of fpmath_log1p
+#define ASINH_X_MAX 0x1p62
+
+// 1 / sqrt(y) on [1, 2], Chebyshev fit
+static const double asinh_rsqrt_poly[] = {
+    2.0667909317008886, -1.9215547389288727, 1.1878777222580352, -0.38289165950731241, 0.049693280667011661
+};
+
 /*
  * Naive implementation of asinh. Calculates the acos of n elements starting at arr.
  */
@@ -16,60 +27,80 @@ int asinh_baseline(const double* arr, const size_t n, double* result) {
     return 0;
 }
 
-__attribute__((noinline))
-int asinh_ssr(const double* arr, const size_t n, double* result) {
-    // stream arr into ft0
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
-
-    // stream from ft1 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
-
-    snrt_ssr_enable();
-
-    for (size_t i = 0; i < n; i++) {
-        asm volatile(
-            "fcvt.s.d fa0, ft0\n" // fa0 <- ft0
-            ::: "fa0", "ft0"
-        );
-
-        __builtin_ssr_disable();
+/*
+ * With a = |x| and m = min(a, 1 / a), S = sqrt(1 + m^2) is in [1, sqrt(2)] and
+ * asinh(a) = log1p(a + M * m^2 / (1 + S) + M - 1) with M = max(a, 1).
+ * Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void asinh_block(const double* arr, size_t count, double* result, double* carry, int frep) {
+    // S by a polynomial and two Newton steps for 1 / S
+    fpmath_pass_begin(arr, carry, 0, 1, NULL, count);
+    FPMATH_PASS(frep, count, 16,
+        "fsgnj.d ft3, ft0, %[one] \n"
+        "fdiv.d ft4, %[one], ft3 \n"
+        "fmin.d ft3, ft3, ft4 \n"
+        "fmadd.d ft3, ft3, ft3, %[one] \n"
+        "fmadd.d ft4, ft3, %[q4], %[q3] \n"
+        "fmadd.d ft4, ft4, ft3, %[q2] \n"
+        "fmadd.d ft4, ft4, ft3, %[q1] \n"
+        "fmadd.d ft4, ft4, ft3, %[q0] \n"
+        "fmul.d ft5, ft3, %[half] \n"
+        "fmul.d ft6, ft4, ft4 \n"
+        "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+        "fmul.d ft4, ft4, ft6 \n"
+        "fmul.d ft6, ft4, ft4 \n"
+        "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+        "fmul.d ft4, ft4, ft6 \n"
+        "fmul.d ft2, ft4, ft3 \n",
+        [one] "f"(1.0), [half] "f"(0.5), [three_halves] "f"(1.5),
+        [q0] "f"(asinh_rsqrt_poly[0]), [q1] "f"(asinh_rsqrt_poly[1]), [q2] "f"(asinh_rsqrt_poly[2]),
+        [q3] "f"(asinh_rsqrt_poly[3]), [q4] "f"(asinh_rsqrt_poly[4]));
+    fpmath_pass_end();
+
+    // (a + M * m^2 / (1 + S) + M - 1, 0) for the logarithm
+    fpmath_pass_begin(arr, carry, 1, 2, NULL, count);
+    FPMATH_PASS(frep, count, 12,
+        "fsgnj.d ft3, ft0, %[one] \n"
+        "fmin.d ft3, ft3, %[x_max] \n"
+        "fdiv.d ft4, %[one], ft3 \n"
+        "fmin.d ft4, ft4, ft3 \n"
+        "fmul.d ft4, ft4, ft4 \n"
+        "fadd.d ft5, ft1, %[one] \n"
+        "fdiv.d ft4, ft4, ft5 \n"
+        "fmax.d ft5, ft3, %[one] \n"
+        "fsub.d ft6, ft5, %[one] \n"
+        "fmadd.d ft5, ft5, ft4, ft6 \n"
+        "fadd.d ft2, ft5, ft3 \n"
+        "fmv.d ft2, %[zero] \n",
+        [one] "f"(1.0), [zero] "f"(0.0), [x_max] "f"(ASINH_X_MAX));
+    fpmath_pass_end();
+
+    // The sign of x is applied by the logarithm
+    fpmath_log1p(arr, carry, count, result, frep);
+}
 
-        /*
-         * We have to use asinhf as asinh results in an endless loop.
-         * No idea why.
-        */
-        asm volatile(
-            "call %[add_one]\n"
-            :: [add_one] "i"(asinhf)
-            : 
-            "fa0", "fa1", "fa2", "fa3", "fa4", "fa5", "fa6", "fa7",
-            "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", 
-            "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
-            "ra"
-        );
+static inline void asinh_range(const double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
 
-        __builtin_ssr_enable();
-        
-        asm volatile(
-            "fcvt.d.s ft1, fa0" // ft1 <- fa0
-            ::: "ft1", "fa0"
-        );
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        asinh_block(arr + i, count, result + i, carry, frep);
     }
+}
 
-    snrt_ssr_disable();
-
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int asinh_ssr(const double* arr, const size_t n, double* result) {
+    asinh_range(arr, n, result, 0);
     return 0;
 }
 
 __attribute__((noinline))
 int asinh_ssr_frep(const double* arr, const size_t n, double* result) {
-    (void) arr, (void)n, (void) result;
-
-    // Not possible as this needs a function call
-
+    asinh_range(arr, n, result, 1);
     return 0;
 }
+
+KERNEL_UNARY_SPLIT(asinh, const double, asinh_range)
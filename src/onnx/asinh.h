@@ -1,14 +1,21 @@
-
-#ifndef LMQ_ACOS_H
-#define LMQ_ACOS_H
+#ifndef LMQ_ASINH_H
+#define LMQ_ASINH_H
 
 #include <snrt.h>
 
 /*
- * Naive implementation of acosh. Calculates the acosh of n elements starting at arr.
+ * Naive implementation of asinh. Calculates the asinh of n elements starting at arr.
+ * The ssr versions run the FP only passes of fpmath (max relative error 1e-15 for normal inputs,
+ * |x| above 2^62 gives asinh(+-2^62)), the parallel and OMP versions split the elements over the compute cores.
  */
-int ainh_baseline(const double* arr, const size_t n, double* result);
+int asinh_baseline(const double* arr, const size_t n, double* result);
 int asinh_ssr(const double* arr, const size_t n, double* result);
 int asinh_ssr_frep(const double* arr, const size_t n, double* result);
+int asinh_parallel(const double* arr, const size_t n, double* result);
+int asinh_ssr_parallel(const double* arr, const size_t n, double* result);
+int asinh_ssr_frep_parallel(const double* arr, const size_t n, double* result);
+int asinh_omp(const double* arr, const size_t n, double* result);
+int asinh_ssr_omp(const double* arr, const size_t n, double* result);
+int asinh_ssr_frep_omp(const double* arr, const size_t n, double* result);
 
 #endif
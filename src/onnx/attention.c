@@ -0,0 +1,378 @@
+#include <snrt.h>
+
+#include <math.h>
+
+#include "lmq.h"
+#include "tile.h"
+#include "attention.h"
+
+__attribute__((noinline))
+int attention_baseline(const double* q, const double* k, const double* v, size_t heads, size_t seq_q, size_t seq_k,
+                       size_t d, size_t dv, double scale, double* result) {
+    if (seq_k == 0 || d == 0) {
+        return -1;
+    }
+
+    for (size_t h = 0; h < heads; h++) {
+        for (size_t i = 0; i < seq_q; i++) {
+            const double* qi = q + (h * seq_q + i) * d;
+            double* out = result + (h * seq_q + i) * dv;
+
+            double max = -INFINITY;
+            for (size_t j = 0; j < seq_k; j++) {
+                double s = 0.0;
+                for (size_t e = 0; e < d; e++) {
+                    s += qi[e] * k[(h * seq_k + j) * d + e];
+                }
+                max = scale * s > max ? scale * s : max;
+            }
+
+            double sum = 0.0;
+            for (size_t e = 0; e < dv; e++) {
+                out[e] = 0.0;
+            }
+            for (size_t j = 0; j < seq_k; j++) {
+                double s = 0.0;
+                for (size_t e = 0; e < d; e++) {
+                    s += qi[e] * k[(h * seq_k + j) * d + e];
+                }
+                double p = exp(scale * s - max);
+                sum += p;
+                for (size_t e = 0; e < dv; e++) {
+                    out[e] += p * v[(h * seq_k + j) * dv + e];
+                }
+            }
+
+            for (size_t e = 0; e < dv; e++) {
+                out[e] /= sum;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * The online softmax state of rows query rows: the outputs scaled by exp(-max) (rows, dv), the running maxima
+ * and sums and the scores of one block of query rows against a tile.
+ */
+typedef struct {
+    double* out;
+    double* max;
+    double* sum;
+    double* scores;
+} attention_state_t;
+
+// Number of doubles of the state of rows query rows with tiles of tile_rows rows
+static inline size_t attention_state_len(size_t rows, size_t dv, size_t tile_rows) {
+    return rows * (dv + 2) + ATTENTION_BLOCK_Q * tile_rows;
+}
+
+static inline attention_state_t attention_state(double* mem, size_t rows, size_t dv) {
+    attention_state_t s = {
+        .out = mem,
+        .max = mem + rows * dv,
+        .sum = mem + rows * (dv + 1),
+        .scores = mem + rows * (dv + 2),
+    };
+    return s;
+}
+
+static inline void attention_state_init(attention_state_t* s, size_t rows, size_t dv) {
+    for (size_t i = 0; i < rows; i++) {
+        s->max[i] = -INFINITY;
+        s->sum[i] = 0.0;
+    }
+    for (size_t e = 0; e < rows * dv; e++) {
+        s->out[e] = 0.0;
+    }
+}
+
+/*
+ * Folds the tile of nk key rows k and value rows v into the state of the nq <= ATTENTION_BLOCK_Q query rows q,
+ * whose outputs, maxima and sums start at out, max and sum.
+ */
+static void attention_block(const double* q, const double* k, const double* v, size_t nq, size_t nk, size_t d, size_t dv,
+                            double scale, double* scores, double* out, double* max, double* sum) {
+    double corr[ATTENTION_BLOCK_Q];
+
+    // Scores: a dot product of a query and a key row per element, scaled before it is written
+    snrt_ssr_loop_3d(SNRT_SSR_DM0, d, nk, nq, sizeof(*q), 0, sizeof(*q) * d);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, (double*) q);
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM1, d, nk, nq, sizeof(*k), sizeof(*k) * d, 0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, (double*) k);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, nq * nk, sizeof(*scores));
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, scores);
+
+    snrt_ssr_enable();
+
+    for (size_t e = 0; e < nq * nk; e++) {
+        asm volatile(
+            "fcvt.d.w ft3, zero \n"
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "fmadd.d ft3, ft0, ft1, ft3 \n"
+            "fmul.d ft2, ft3, %[scale] \n"
+            :
+            : [n_frep] "r"(d - 1), [scale] "f"(scale)
+            : "ft0", "ft1", "ft2", "ft3"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+
+    // Online softmax, exp is a call so the streams are disabled
+    for (size_t i = 0; i < nq; i++) {
+        double* row = scores + i * nk;
+        double m = max[i];
+        for (size_t j = 0; j < nk; j++) {
+            m = row[j] > m ? row[j] : m;
+        }
+
+        double s = 0.0;
+        for (size_t j = 0; j < nk; j++) {
+            row[j] = exp(row[j] - m);
+            s += row[j];
+        }
+        corr[i] = exp(max[i] - m);
+        sum[i] = sum[i] * corr[i] + s;
+        max[i] = m;
+    }
+
+    // out = out * corr + p v, out is read just before its element is written
+    snrt_ssr_loop_3d(SNRT_SSR_DM0, nk, dv, nq, sizeof(*scores), 0, sizeof(*scores) * nk);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, scores);
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM1, nk, dv, nq, sizeof(*v) * dv, sizeof(*v), 0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, (double*) v);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, nq * dv, sizeof(*out));
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, out);
+
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < nq; i++) {
+        for (size_t e = 0; e < dv; e++) {
+            asm volatile(
+                "fmul.d ft3, %[o], %[c] \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "fmadd.d ft3, ft0, ft1, ft3 \n"
+                "fmv.d ft2, ft3 \n"
+                :
+                : [n_frep] "r"(nk - 1), [o] "f"(out[i * dv + e]), [c] "f"(corr[i])
+                : "ft0", "ft1", "ft2", "ft3", "memory"
+            );
+        }
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+/*
+ * Folds a tile of nk key and value rows into the state of the query rows q (rows of them), in blocks of
+ * ATTENTION_BLOCK_Q rows.
+ */
+static void attention_tile(const double* q, const double* k, const double* v, size_t rows, size_t nk, size_t d, size_t dv,
+                           double scale, attention_state_t* s) {
+    for (size_t i = 0; i < rows; i += ATTENTION_BLOCK_Q) {
+        size_t nq = rows - i < ATTENTION_BLOCK_Q ? rows - i : ATTENTION_BLOCK_Q;
+        attention_block(q + i * d, k, v, nq, nk, d, dv, scale, s->scores, s->out + i * dv, s->max + i, s->sum + i);
+    }
+}
+
+// Divides the outputs by their sums
+static void attention_finish(const attention_state_t* s, size_t rows, size_t dv, double* result) {
+    for (size_t i = 0; i < rows; i++) {
+        double inv = 1.0 / s->sum[i];
+        for (size_t e = 0; e < dv; e++) {
+            result[i * dv + e] = s->out[i * dv + e] * inv;
+        }
+    }
+}
+
+/*
+ * Allocates len doubles in L1, or in the global arena if they do not fit. Sets *arena and *mark for the reset.
+ */
+static double* attention_alloc(size_t len, arena_t** arena, size_t* mark) {
+    *arena = arena_l1();
+    *mark = arena_mark(*arena);
+    double* mem = arena_alloc(*arena, len, sizeof(double), LMQ_ALIGN_DOUBLE);
+    if (mem == NULL) {
+        arena_reset(*arena, *mark);
+        *arena = arena_global();
+        *mark = arena_mark(*arena);
+        mem = arena_alloc(*arena, len, sizeof(double), LMQ_ALIGN_DOUBLE);
+    }
+    return mem;
+}
+
+__attribute__((noinline))
+int attention_ssr_frep(const double* q, const double* k, const double* v, size_t heads, size_t seq_q, size_t seq_k,
+                       size_t d, size_t dv, double scale, double* result) {
+    if (seq_k == 0 || d == 0) {
+        return -1;
+    }
+
+    arena_t* arena;
+    size_t mark;
+    double* mem = attention_alloc(attention_state_len(seq_q, dv, ATTENTION_BLOCK_K), &arena, &mark);
+    if (mem == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+    attention_state_t s = attention_state(mem, seq_q, dv);
+
+    for (size_t h = 0; h < heads; h++) {
+        attention_state_init(&s, seq_q, dv);
+        for (size_t j = 0; j < seq_k; j += ATTENTION_BLOCK_K) {
+            size_t nk = seq_k - j < ATTENTION_BLOCK_K ? seq_k - j : ATTENTION_BLOCK_K;
+            attention_tile(q + h * seq_q * d, k + (h * seq_k + j) * d, v + (h * seq_k + j) * dv, seq_q, nk, d, dv, scale, &s);
+        }
+        attention_finish(&s, seq_q, dv, result + h * seq_q * dv);
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+
+/*
+ * Context of the parallel attention, tile t is the tile t % tiles of head t / tiles.
+ */
+typedef struct {
+    const double* q;
+    const double* k;
+    const double* v;
+    double* result;
+    size_t seq_q;
+    size_t seq_k;
+    size_t d;
+    size_t dv;
+    double scale;
+    size_t rows;
+    size_t tiles;
+
+    double* l1_k[LMQ_TILE_SLOTS];
+    double* l1_v[LMQ_TILE_SLOTS];
+    // The state of compute core c starts at state + c * state_len
+    double* state;
+    size_t state_len;
+} attention_tiled_t;
+
+// Shared between all cores of the cluster
+static double* attention_shared_state = NULL;
+
+static size_t attention_tile_rows(const attention_tiled_t* t, size_t tile) {
+    size_t start = (tile % t->tiles) * t->rows;
+    return t->seq_k - start < t->rows ? t->seq_k - start : t->rows;
+}
+
+static void attention_tile_load(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    const attention_tiled_t* t = p->ctx;
+    size_t row = (tile / t->tiles) * t->seq_k + (tile % t->tiles) * t->rows;
+    size_t rows = attention_tile_rows(t, tile);
+
+    snrt_dma_start_1d(t->l1_k[slot], (double*) t->k + row * t->d, rows * t->d * sizeof(double));
+    snrt_dma_start_1d(t->l1_v[slot], (double*) t->v + row * t->dv, rows * t->dv * sizeof(double));
+}
+
+static void attention_tile_compute(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    const attention_tiled_t* t = p->ctx;
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t h = tile / t->tiles;
+
+    size_t first;
+    size_t rows = local_range(t->seq_q, core_idx, core_num, &first);
+    attention_state_t s = attention_state(t->state + core_idx * t->state_len, rows, t->dv);
+    if (rows == 0) {
+        return;
+    }
+
+    if (tile % t->tiles == 0) {
+        attention_state_init(&s, rows, t->dv);
+    }
+    attention_tile(t->q + (h * t->seq_q + first) * t->d, t->l1_k[slot], t->l1_v[slot], rows, attention_tile_rows(t, tile),
+                   t->d, t->dv, t->scale, &s);
+    if (tile % t->tiles == t->tiles - 1) {
+        attention_finish(&s, rows, t->dv, t->result + (h * t->seq_q + first) * t->dv);
+    }
+}
+
+__attribute__((noinline))
+int attention_ssr_frep_parallel(const double* q, const double* k, const double* v, size_t heads, size_t seq_q, size_t seq_k,
+                                size_t d, size_t dv, double scale, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+
+    if (seq_k == 0 || d == 0) {
+        return -1;
+    }
+
+    // Two slots of a key and a value tile, every buffer gets one guard element
+    double* l1 = tile_l1_scratch();
+    size_t fit = (LMQ_TILE_L1_SIZE / sizeof(double) / LMQ_TILE_SLOTS - 2) / (d + dv);
+    size_t rows = fit < ATTENTION_BLOCK_K ? fit : ATTENTION_BLOCK_K;
+    if (rows == 0) {
+        return -1;
+    }
+
+    size_t core_rows = (seq_q + core_num - 1) / core_num;
+    attention_tiled_t t = {
+        .q = q,
+        .k = k,
+        .v = v,
+        .result = result,
+        .seq_q = seq_q,
+        .seq_k = seq_k,
+        .d = d,
+        .dv = dv,
+        .scale = scale,
+        .rows = rows,
+        .tiles = (seq_k + rows - 1) / rows,
+        .state_len = attention_state_len(core_rows, dv, rows),
+    };
+    for (size_t slot = 0; slot < LMQ_TILE_SLOTS; slot++) {
+        t.l1_k[slot] = l1;
+        l1 += rows * d + 1;
+        t.l1_v[slot] = l1;
+        l1 += rows * dv + 1;
+    }
+
+    // The DM core allocates the states of all compute cores
+    arena_t* arena = NULL;
+    size_t mark = 0;
+    if (snrt_is_dm_core()) {
+        attention_shared_state = attention_alloc(core_num * t.state_len, &arena, &mark);
+    }
+    snrt_cluster_hw_barrier();
+    t.state = attention_shared_state;
+    if (t.state == NULL) {
+        if (snrt_is_dm_core()) {
+            arena_reset(arena, mark);
+        }
+        return -1;
+    }
+
+    tile_pipeline_t p = {
+        .num_tiles = heads * t.tiles,
+        .load = attention_tile_load,
+        .compute = attention_tile_compute,
+        .store = NULL,
+        .ctx = &t,
+    };
+    tile_pipeline_run(&p);
+
+    if (snrt_is_dm_core()) {
+        arena_reset(arena, mark);
+        attention_shared_state = NULL;
+    }
+    snrt_cluster_hw_barrier();
+    return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef LMQ_ATTENTION_H
+#define LMQ_ATTENTION_H
+
+#include <snrt.h>
+
+/*
+ * Number of query rows whose scores are computed at once.
+ */
+#ifndef ATTENTION_BLOCK_Q
+#define ATTENTION_BLOCK_Q 4
+#endif
+
+/*
+ * Maximal number of key and value rows of a tile.
+ */
+#ifndef ATTENTION_BLOCK_K
+#define ATTENTION_BLOCK_K 32
+#endif
+
+/*
+ * Scaled dot product attention of every head: result[h] = softmax(scale * q[h] k[h]^T) v[h] with q (heads, seq_q, d),
+ * k (heads, seq_k, d), v (heads, seq_k, dv) and result (heads, seq_q, dv), f.ex. scale = 1 / sqrt(d).
+ * The fused versions never store the (seq_q, seq_k) scores: ATTENTION_BLOCK_Q query rows are multiplied with a
+ * tile of at most ATTENTION_BLOCK_K key rows (an SSR+FREP dot product per score), and an online softmax keeps
+ * the running maximum and sum of every query row and rescales its accumulated output when the maximum grows.
+ * The output rows are divided by their sums after the last tile.
+ * The ssr_frep version reads k and v in place. The parallel version must be called by all cores of the cluster:
+ * the DM core moves the key and value tiles of all heads one after the other into L1 (double buffered, the
+ * first tile of the next head is loaded while the last one of the current head is computed), the compute cores
+ * split the query rows of the head and keep their outputs, maxima and sums in L1 (or in global memory if they
+ * do not fit). q is read in place.
+ * All versions return -1 if seq_k or d is 0 (or if the state can not be allocated).
+ */
+int attention_baseline(const double* q, const double* k, const double* v, size_t heads, size_t seq_q, size_t seq_k,
+                       size_t d, size_t dv, double scale, double* result);
+int attention_ssr_frep(const double* q, const double* k, const double* v, size_t heads, size_t seq_q, size_t seq_k,
+                       size_t d, size_t dv, double scale, double* result);
+int attention_ssr_frep_parallel(const double* q, const double* k, const double* v, size_t heads, size_t seq_q, size_t seq_k,
+                                size_t d, size_t dv, double scale, double* result);
+
+#endif
@@ -0,0 +1,227 @@
+#include "printf.h"
+#include <snrt.h>
+
+#include "lmq.h"
+#include "maxpool.h"
+#include "avgpool.h"
+
+/*
+ * Gives every core a contiguous range of channels, the ranges differ by at most one channel.
+ * Returns the number of channels and sets first to the first channel of the core.
+ */
+static inline size_t pool_local_channels(size_t channels, size_t core_idx, size_t core_num, size_t* first) {
+    // The first 'leftover' cores do one more channel
+    size_t local_channels = channels / core_num;
+    size_t leftover = channels - local_channels * core_num;
+    *first = core_idx * local_channels + (core_idx < leftover ? core_idx : leftover);
+    return local_channels + (core_idx < leftover ? 1 : 0);
+}
+
+__attribute__((noinline))
+int avgpool2d_baseline(double *a, size_t channels, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
+    size_t outn0 = pool_output_size(n0, f0, s0);
+    size_t outn1 = pool_output_size(n1, f1, s1);
+    double scale = 1.0 / (f0 * f1);
+
+    for (size_t c = 0; c < channels; ++c) {
+        double* plane = a + c * n0 * n1;
+        for (size_t i = 0; i < outn1; ++i) {
+            for (size_t j = 0; j < outn0; ++j) {
+                double acc = 0;
+                for (size_t k = 0; k < f1; ++k) {
+                    for (size_t l = 0; l < f0; ++l) {
+                        acc += plane[n0 * (s1 * i + k) + s0 * j + l];
+                    }
+                }
+                result[(c * outn1 + i) * outn0 + j] = acc * scale;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Pools the channels [first, first + count) with the 4D pattern of maxpool2d_ssr.
+ * The window is summed under FREP and scaled by 1 / (f0 * f1) when it is written back.
+ */
+static inline void avgpool2d_channels(double *a, size_t first, size_t count, size_t n0, size_t n1,
+                                      size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
+    size_t outn0 = pool_output_size(n0, f0, s0);
+    size_t outn1 = pool_output_size(n1, f1, s1);
+    double scale = 1.0 / (f0 * f1);
+
+    for (size_t c = first; c < first + count; ++c) {
+        snrt_ssr_loop_4d(SNRT_SSR_DM0, f0, f1, outn0, outn1, sizeof(*a), sizeof(*a) * n0, sizeof(*a) * s0, sizeof(*a) * s1 * n0);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, a + c * n0 * n1);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, outn0 * outn1, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result + c * outn0 * outn1);
+
+        snrt_ssr_enable();
+
+        for (size_t i = 0; i < outn0 * outn1; ++i) {
+            asm volatile(
+                "fcvt.d.w ft2, zero \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "fadd.d ft2, ft2, ft0 \n"
+                "fmul.d ft1, ft2, %[scale] \n"
+                :
+                : [n_frep] "r"(f0 * f1 - 1), [scale] "f"(scale)
+                : "ft0", "ft1", "ft2"
+            );
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int avgpool2d_ssr_frep(double *a, size_t channels, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
+    avgpool2d_channels(a, 0, channels, n0, n1, f0, f1, s0, s1, result);
+    return 0;
+}
+
+/*
+ * The channels are split over the compute cores.
+ */
+__attribute__((noinline))
+int avgpool2d_ssr_frep_parallel(double *a, size_t channels, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = pool_local_channels(channels, core_idx, core_num, &first);
+    avgpool2d_channels(a, first, count, n0, n1, f0, f1, s0, s1, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int global_avgpool_baseline(double *a, size_t channels, size_t n, double* result) {
+    for (size_t c = 0; c < channels; ++c) {
+        double acc = 0;
+        for (size_t i = 0; i < n; ++i) {
+            acc += a[c * n + i];
+        }
+        result[c] = acc / n;
+    }
+    return 0;
+}
+
+/*
+ * Reduces the channels [first, first + count) with one 2D pattern over all of them.
+ * If max is set, the reduction is a max, otherwise a sum scaled by 1 / n.
+ */
+static inline void global_pool_channels(double *a, size_t first, size_t count, size_t n, int max, double* result) {
+    double scale = 1.0 / n;
+
+    if (count == 0) {
+        return;
+    }
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM0, n, count, sizeof(*a), sizeof(*a) * n);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, a + first * n);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, count, sizeof(*result));
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result + first);
+
+    snrt_ssr_enable();
+
+    for (size_t c = 0; c < count; ++c) {
+        if (max && n > 1) {
+            asm volatile(
+                "fmv.d ft2, ft0 \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "fmax.d ft2, ft2, ft0 \n"
+                "fmv.d ft1, ft2 \n"
+                :
+                : [n_frep] "r"(n - 2)
+                : "ft0", "ft1", "ft2"
+            );
+        } else if (max) {
+            asm volatile(
+                "fmv.d ft1, ft0 \n"
+                :
+                :
+                : "ft0", "ft1", "ft2"
+            );
+        } else {
+            asm volatile(
+                "fcvt.d.w ft2, zero \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "fadd.d ft2, ft2, ft0 \n"
+                "fmul.d ft1, ft2, %[scale] \n"
+                :
+                : [n_frep] "r"(n - 1), [scale] "f"(scale)
+                : "ft0", "ft1", "ft2"
+            );
+        }
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+__attribute__((noinline))
+int global_avgpool_ssr_frep(double *a, size_t channels, size_t n, double* result) {
+    global_pool_channels(a, 0, channels, n, 0, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int global_avgpool_ssr_frep_parallel(double *a, size_t channels, size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = pool_local_channels(channels, core_idx, core_num, &first);
+    global_pool_channels(a, first, count, n, 0, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int global_maxpool_baseline(double *a, size_t channels, size_t n, double* result) {
+    for (size_t c = 0; c < channels; ++c) {
+        double max = a[c * n];
+        for (size_t i = 1; i < n; ++i) {
+            if (a[c * n + i] > max) {
+                max = a[c * n + i];
+            }
+        }
+        result[c] = max;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int global_maxpool_ssr_frep(double *a, size_t channels, size_t n, double* result) {
+    global_pool_channels(a, 0, channels, n, 1, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int global_maxpool_ssr_frep_parallel(double *a, size_t channels, size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = pool_local_channels(channels, core_idx, core_num, &first);
+    global_pool_channels(a, first, count, n, 1, result);
+    return 0;
+}
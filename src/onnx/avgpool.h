@@ -0,0 +1,25 @@
+#ifndef LMQ_AVGPOOL_H
+#define LMQ_AVGPOOL_H
+
+#include <snrt.h>
+
+/*
+ * AveragePool (no padding) of channels images of (n1, n0) each with a window of (f1, f0).
+ * a is (channels, n1, n0), i.e. an NCHW tensor with channels = N * C. Index 0 is the innermost dimension.
+ */
+int avgpool2d_baseline(double *a, size_t channels, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+int avgpool2d_ssr_frep(double *a, size_t channels, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+int avgpool2d_ssr_frep_parallel(double *a, size_t channels, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+
+/*
+ * GlobalAveragePool and GlobalMaxPool: one result per channel of n elements each (n = n0 * n1).
+ */
+int global_avgpool_baseline(double *a, size_t channels, size_t n, double* result);
+int global_avgpool_ssr_frep(double *a, size_t channels, size_t n, double* result);
+int global_avgpool_ssr_frep_parallel(double *a, size_t channels, size_t n, double* result);
+
+int global_maxpool_baseline(double *a, size_t channels, size_t n, double* result);
+int global_maxpool_ssr_frep(double *a, size_t channels, size_t n, double* result);
+int global_maxpool_ssr_frep_parallel(double *a, size_t channels, size_t n, double* result);
+
+#endif
@@ -2,6 +2,8 @@
 #include <snrt.h>
 
 #include "lmq.h"
+#include "reduce.h"
+#include "batchnorm.h"
 
 __attribute__((noinline))
 int batchnorm_baseline(double *a, const size_t n, double* result) {
@@ -16,7 +18,7 @@ int batchnorm_baseline(double *a, const size_t n, double* result) {
         square_sum += (a[i] - mean) * (a[i] - mean);
     }
     double variance = square_sum / n;
-    double stddev = sqrt_approx(variance);
+    double stddev = sqrt_fast(variance);
 
     // printf("%.10f %.10f %.10f %.10f %.10f\n", sum, mean, square_sum, variance, stddev);
 
@@ -87,7 +89,7 @@ int batchnorm_ssr(double *a, const size_t n, double* result) {
         snrt_ssr_disable();
     }
     volatile double variance = square_sum / n;
-    volatile double stddev = sqrt_approx(variance);
+    volatile double stddev = sqrt_fast(variance);
     
     // printf("%.10f %.10f %.10f %.10f %.10f\n", sum, mean, square_sum, variance, stddev);
     {
@@ -161,7 +163,7 @@ int batchnorm_ssr_frep(double *a, const size_t n, double* result) {
         snrt_ssr_disable();
     }
     volatile double variance = square_sum / n;
-    volatile double stddev = sqrt_approx(variance);
+    volatile double stddev = sqrt_fast(variance);
     {
         snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
         snrt_ssr_repeat(SNRT_SSR_DM0, 1);
@@ -185,4 +187,378 @@ int batchnorm_ssr_frep(double *a, const size_t n, double* result) {
         snrt_ssr_disable();
     }
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+ * batchnorm_ssr_frep with the sum of the first pass split over REDUCE_ACCUMULATORS staggered accumulators.
+ * The second pass keeps the single accumulator: FREP staggers the same operands of every instruction
+ * in the loop and the difference is read from ft0 by fsub.d but from a temporary by fmadd.d.
+ */
+__attribute__((noinline))
+int batchnorm_ssr_frep_staggered(double *a, const size_t n, double* result) {
+    volatile double sum = 0;
+    {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, 0, 0);
+
+        snrt_ssr_enable();
+
+        sum = reduce_sum_ssr_frep(n);
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+    volatile double mean = sum / n;
+    volatile double square_sum = 0;
+    {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, 0, 0);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 2, 0, 0 \n"
+            "fsub.d ft1, ft0, %[mean] \n"
+            "fmadd.d %[s], ft1, ft1, %[s] \n"
+            : [s] "+f"(square_sum) 
+            : [mean] "f"(mean), [n_frep] "r"(n - 1)
+            : "ft0", "ft1"
+        );
+
+        snrt_ssr_disable();
+    }
+    volatile double variance = square_sum / n;
+    volatile double stddev = sqrt_fast(variance);
+    {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 2, 0, 0 \n"
+            "fsub.d ft2, ft0, %[mean] \n"
+            "fdiv.d ft1, ft2, %[stddev] \n"
+            :
+            : [mean] "f"(mean), [stddev] "f"(stddev), [n_frep] "r"(n - 1)
+            : "ft0", "ft1", "ft2"
+        );
+
+        snrt_ssr_disable();
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int batchnorm_nchw_inference_baseline(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                      const double* mean, const double* var, double epsilon, double* result) {
+    for (size_t ch = 0; ch < c; ch++) {
+        double stddev = sqrt_fast(var[ch] + epsilon);
+        for (size_t b = 0; b < n; b++) {
+            for (size_t i = 0; i < hw; i++) {
+                size_t idx = (b * c + ch) * hw + i;
+                result[idx] = (x[idx] - mean[ch]) / stddev * scale[ch] + bias[ch];
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Writes result = x * k + b for the elements [first, first + count) of every plane of channel ch.
+ * A 2D pattern (count, n) streams the planes of the channel in all batches, the fmadd.d are independent.
+ */
+static inline void batchnorm_planes_fma(const double* x, size_t n, size_t c, size_t hw, size_t ch, size_t first,
+                                        size_t count, double k, double b, double* result) {
+    if (n * count == 0) {
+        return;
+    }
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM0, count, n, sizeof(*x), sizeof(*x) * c * hw);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, x + ch * hw + first);
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM1, count, n, sizeof(*result), sizeof(*result) * c * hw);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_2D, result + ch * hw + first);
+
+    snrt_ssr_enable();
+
+    asm volatile(
+        "frep.o %[n_frep], 1, 0, 0 \n"
+        "fmadd.d ft1, ft0, %[k], %[b] \n"
+        :
+        : [n_frep] "r"(n * count - 1), [k] "f"(k), [b] "f"(b)
+        : "ft0", "ft1", "ft2"
+    );
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+/*
+ * Writes result = x * k + b for the n * hw elements of channel ch.
+ */
+static inline void batchnorm_channel_fma(const double* x, size_t n, size_t c, size_t hw, size_t ch,
+                                         double k, double b, double* result) {
+    batchnorm_planes_fma(x, n, c, hw, ch, 0, hw, k, b, result);
+}
+
+/*
+ * Sets *sum and *square_sum to the sum and the sum of squares of x - shift over the elements
+ * [first, first + count) of every plane of channel ch.
+ * Every FREP iteration takes two elements, so the sums of the even and the odd elements are
+ * independent and each accumulator is only updated every sixth instruction.
+ */
+static inline void batchnorm_planes_sums(const double* x, size_t n, size_t c, size_t hw, size_t ch, size_t first,
+                                         size_t count, double shift, double* sum_out, double* square_sum_out) {
+    size_t m = n * count;
+    double sum = 0.0;
+    double square_sum = 0.0;
+    if (m == 0) {
+        *sum_out = sum;
+        *square_sum_out = square_sum;
+        return;
+    }
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM0, count, n, sizeof(*x), sizeof(*x) * c * hw);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, x + ch * hw + first);
+
+    // The write stream of the previous channel must not stay active
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, 0, 0);
+
+    snrt_ssr_enable();
+
+    if (m / 2 > 0) {
+        asm volatile(
+            "fcvt.d.w ft3, zero \n"
+            "fcvt.d.w ft4, zero \n"
+            "fcvt.d.w ft5, zero \n"
+            "fcvt.d.w ft6, zero \n"
+            "frep.o %[n_frep], 6, 0, 0 \n"
+            "fsub.d ft7, ft0, %[shift] \n"
+            "fsub.d ft8, ft0, %[shift] \n"
+            "fadd.d ft3, ft3, ft7 \n"
+            "fmadd.d ft5, ft7, ft7, ft5 \n"
+            "fadd.d ft4, ft4, ft8 \n"
+            "fmadd.d ft6, ft8, ft8, ft6 \n"
+            "fadd.d %[s], ft3, ft4 \n"
+            "fadd.d %[q], ft5, ft6 \n"
+            : [s] "=f"(sum), [q] "=f"(square_sum)
+            : [n_frep] "r"(m / 2 - 1), [shift] "f"(shift)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7", "ft8"
+        );
+    }
+    if (m % 2) {
+        asm volatile(
+            "fsub.d ft7, ft0, %[shift] \n"
+            "fadd.d %[s], %[s], ft7 \n"
+            "fmadd.d %[q], ft7, ft7, %[q] \n"
+            : [s] "+f"(sum), [q] "+f"(square_sum)
+            : [shift] "f"(shift)
+            : "ft0", "ft1", "ft2", "ft7"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+
+    *sum_out = sum;
+    *square_sum_out = square_sum;
+}
+
+/*
+ * Sets *mean and *var to the mean and the population variance of the m elements with the sums of
+ * batchnorm_planes_sums around shift.
+ */
+static inline void batchnorm_moments(double sum, double square_sum, size_t m, double shift, double* mean, double* var) {
+    if (m == 0) {
+        *mean = 0.0;
+        *var = 0.0;
+        return;
+    }
+
+    double shifted_mean = sum / m;
+    double variance = square_sum / m - shifted_mean * shifted_mean;
+    *mean = shift + shifted_mean;
+    *var = variance > 0.0 ? variance : 0.0;
+}
+
+/*
+ * Sets *mean and *var to the mean and the population variance of the n * hw elements of channel ch.
+ */
+static inline void batchnorm_channel_stats(const double* x, size_t n, size_t c, size_t hw, size_t ch,
+                                           double* mean, double* var) {
+    double shift = n * hw > 0 ? x[ch * hw] : 0.0;
+    double sum, square_sum;
+    batchnorm_planes_sums(x, n, c, hw, ch, 0, hw, shift, &sum, &square_sum);
+    batchnorm_moments(sum, square_sum, n * hw, shift, mean, var);
+}
+
+/*
+ * Inference mode for the channels [first, first + count).
+ */
+static inline void batchnorm_inference_channels(const double* x, size_t n, size_t c, size_t hw, size_t first, size_t count,
+                                                const double* scale, const double* bias, const double* mean, const double* var,
+                                                double epsilon, double* result) {
+    for (size_t ch = first; ch < first + count; ch++) {
+        double k = scale[ch] * rsqrt_fast(var[ch] + epsilon);
+        batchnorm_channel_fma(x, n, c, hw, ch, k, bias[ch] - mean[ch] * k, result);
+    }
+}
+
+/*
+ * Training mode for the channels [first, first + count).
+ */
+static inline void batchnorm_training_channels(const double* x, size_t n, size_t c, size_t hw, size_t first, size_t count,
+                                               const double* scale, const double* bias, const double* input_mean,
+                                               const double* input_var, double epsilon, double momentum,
+                                               double* result, double* running_mean, double* running_var) {
+    for (size_t ch = first; ch < first + count; ch++) {
+        double mean, var;
+        batchnorm_channel_stats(x, n, c, hw, ch, &mean, &var);
+        running_mean[ch] = input_mean[ch] * momentum + mean * (1.0 - momentum);
+        running_var[ch] = input_var[ch] * momentum + var * (1.0 - momentum);
+
+        double k = scale[ch] * rsqrt_fast(var + epsilon);
+        batchnorm_channel_fma(x, n, c, hw, ch, k, bias[ch] - mean * k, result);
+    }
+}
+
+__attribute__((noinline))
+int batchnorm_nchw_inference_ssr_frep(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                      const double* mean, const double* var, double epsilon, double* result) {
+    batchnorm_inference_channels(x, n, c, hw, 0, c, scale, bias, mean, var, epsilon, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int batchnorm_nchw_inference_ssr_frep_parallel(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                               const double* mean, const double* var, double epsilon, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(c, core_idx, core_num, &first);
+    batchnorm_inference_channels(x, n, c, hw, first, count, scale, bias, mean, var, epsilon, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int batchnorm_nchw_training_baseline(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                     const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                     double* result, double* running_mean, double* running_var) {
+    size_t m = n * hw;
+
+    for (size_t ch = 0; ch < c; ch++) {
+        double sum = 0;
+        for (size_t b = 0; b < n; b++) {
+            for (size_t i = 0; i < hw; i++) {
+                sum += x[(b * c + ch) * hw + i];
+            }
+        }
+        double mean = sum / m;
+
+        double square_sum = 0;
+        for (size_t b = 0; b < n; b++) {
+            for (size_t i = 0; i < hw; i++) {
+                double d = x[(b * c + ch) * hw + i] - mean;
+                square_sum += d * d;
+            }
+        }
+        double var = square_sum / m;
+
+        running_mean[ch] = input_mean[ch] * momentum + mean * (1.0 - momentum);
+        running_var[ch] = input_var[ch] * momentum + var * (1.0 - momentum);
+
+        double stddev = sqrt_fast(var + epsilon);
+        for (size_t b = 0; b < n; b++) {
+            for (size_t i = 0; i < hw; i++) {
+                size_t idx = (b * c + ch) * hw + i;
+                result[idx] = (x[idx] - mean) / stddev * scale[ch] + bias[ch];
+            }
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int batchnorm_nchw_training_ssr_frep(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                     const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                     double* result, double* running_mean, double* running_var) {
+    batchnorm_training_channels(x, n, c, hw, 0, c, scale, bias, input_mean, input_var, epsilon, momentum,
+                                result, running_mean, running_var);
+    return 0;
+}
+
+__attribute__((noinline))
+int batchnorm_nchw_training_ssr_frep_parallel(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                              const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                              double* result, double* running_mean, double* running_var) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(c, core_idx, core_num, &first);
+    batchnorm_training_channels(x, n, c, hw, first, count, scale, bias, input_mean, input_var, epsilon, momentum,
+                                result, running_mean, running_var);
+    return 0;
+}
+
+/*
+ * Every core of the team takes the same part of the planes of every channel, the sums of the statistics
+ * are combined by reduce_team, so every core gets the mean and the variance of the whole channel.
+ */
+__attribute__((noinline))
+int batchnorm_nchw_training_ssr_frep_omp(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                         const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                         double* result, double* running_mean, double* running_var) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        size_t core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t count = local_range(hw, core_idx, core_num, &first);
+
+        for (size_t ch = 0; ch < c; ch++) {
+            double shift = n * hw > 0 ? x[ch * hw] : 0.0;
+            double sum, square_sum;
+            batchnorm_planes_sums(x, n, c, hw, ch, first, count, shift, &sum, &square_sum);
+            sum = reduce_team(REDUCE_SUM, sum, 0, NULL);
+            square_sum = reduce_team(REDUCE_SUM, square_sum, 0, NULL);
+
+            double mean, var;
+            batchnorm_moments(sum, square_sum, n * hw, shift, &mean, &var);
+            if (core_idx == 0) {
+                running_mean[ch] = input_mean[ch] * momentum + mean * (1.0 - momentum);
+                running_var[ch] = input_var[ch] * momentum + var * (1.0 - momentum);
+            }
+
+            double k = scale[ch] * rsqrt_fast(var + epsilon);
+            batchnorm_planes_fma(x, n, c, hw, ch, first, count, k, bias[ch] - mean * k, result);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef LMQ_BATCHNORM_H
+#define LMQ_BATCHNORM_H
+
+#include <snrt.h>
+
+/*
+ * Normalizes the n elements of a with their mean and standard deviation.
+ */
+int batchnorm_baseline(double *a, const size_t n, double* result);
+int batchnorm_ssr(double *a, const size_t n, double* result);
+int batchnorm_ssr_frep(double *a, const size_t n, double* result);
+int batchnorm_ssr_frep_staggered(double *a, const size_t n, double* result);
+
+/*
+ * ONNX BatchNormalization of the NCHW tensor x of (n, c, hw) with hw = H * W and the per channel
+ * scale, bias, mean and var. Inference mode computes y = (x - mean) / sqrt(var + epsilon) * scale + bias.
+ * The SSR versions fold this into k = scale / sqrt(var + epsilon) and b = bias - mean * k once per channel,
+ * so every element is a single fused multiply-add instead of a subtraction and a division.
+ */
+int batchnorm_nchw_inference_baseline(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                      const double* mean, const double* var, double epsilon, double* result);
+int batchnorm_nchw_inference_ssr_frep(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                      const double* mean, const double* var, double epsilon, double* result);
+int batchnorm_nchw_inference_ssr_frep_parallel(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                               const double* mean, const double* var, double epsilon, double* result);
+
+/*
+ * Training mode: y is normalized with the mean and (population) variance of every channel over n and hw,
+ * running_mean = input_mean * momentum + mean * (1 - momentum) and running_var likewise.
+ * The SSR versions get the statistics of a channel in one pass: the sum and the sum of squares of
+ * x - x[first element of the channel] in two accumulators each (the shift avoids the cancellation of
+ * the sum of squares), followed by the fused multiply-add pass of inference mode.
+ * The parallel versions split the channels over the compute cores. The OMP version splits the planes of every
+ * channel instead and combines the statistics with reduce_team (src/lmq/reduce.h), so it also
+ * uses all cores for fewer channels than cores.
+ */
+int batchnorm_nchw_training_baseline(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                     const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                     double* result, double* running_mean, double* running_var);
+int batchnorm_nchw_training_ssr_frep(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                     const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                     double* result, double* running_mean, double* running_var);
+int batchnorm_nchw_training_ssr_frep_parallel(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                              const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                              double* result, double* running_mean, double* running_var);
+int batchnorm_nchw_training_ssr_frep_omp(const double* x, size_t n, size_t c, size_t hw, const double* scale, const double* bias,
+                                         const double* input_mean, const double* input_var, double epsilon, double momentum,
+                                         double* result, double* running_mean, double* running_var);
+
+#endif
@@ -0,0 +1,320 @@
+#include "printf.h"
+#include <snrt.h>
+#include "omp.h"
+
+#include "lmq.h"
+#include "fpmath.h"
+#include "broadcast.h"
+
+/*
+ * The loops over result, innermost first, with the strides (in elements) of both inputs.
+ * result is contiguous in the order of the loops.
+ */
+typedef struct {
+    size_t loops;
+    size_t bounds[BROADCAST_MAX_DIMS];
+    size_t a_strides[BROADCAST_MAX_DIMS];
+    size_t b_strides[BROADCAST_MAX_DIMS];
+} broadcast_layout_t;
+
+static int broadcast_layout(const size_t* a_shape, size_t a_ndim, const size_t* b_shape, size_t b_ndim,
+                            broadcast_layout_t* l) {
+    size_t ndim = a_ndim > b_ndim ? a_ndim : b_ndim;
+    size_t a_stride = 1;
+    size_t b_stride = 1;
+
+    if (ndim > BROADCAST_MAX_DIMS) {
+        return -1;
+    }
+
+    l->loops = 0;
+    for (size_t d = 0; d < ndim; d++) {
+        // Dimension d from the back, missing dimensions are 1
+        size_t a_dim = d < a_ndim ? a_shape[a_ndim - 1 - d] : 1;
+        size_t b_dim = d < b_ndim ? b_shape[b_ndim - 1 - d] : 1;
+        if (a_dim != b_dim && a_dim != 1 && b_dim != 1) {
+            return -1;
+        }
+
+        size_t bound = a_dim > b_dim ? a_dim : b_dim;
+        if (a_dim == 0 || b_dim == 0) {
+            bound = 0;
+        }
+        size_t as = a_dim == 1 ? 0 : a_stride;
+        size_t bs = b_dim == 1 ? 0 : b_stride;
+        a_stride *= a_dim;
+        b_stride *= b_dim;
+
+        if (bound == 1) {
+            continue;
+        }
+        size_t k = l->loops;
+        if (k > 0 && as == l->a_strides[k - 1] * l->bounds[k - 1] && bs == l->b_strides[k - 1] * l->bounds[k - 1]) {
+            l->bounds[k - 1] *= bound;
+        } else {
+            l->bounds[k] = bound;
+            l->a_strides[k] = as;
+            l->b_strides[k] = bs;
+            l->loops++;
+        }
+    }
+    return 0;
+}
+
+static inline double broadcast_apply(broadcast_kind_t kind, double a, double b) {
+    switch (kind) {
+    case BROADCAST_SUB:
+        return a - b;
+    case BROADCAST_MUL:
+        return a * b;
+    case BROADCAST_DIV:
+        return a / b;
+    case BROADCAST_PRELU:
+        return a < 0 ? a * b : a;
+    default:
+        return a + b;
+    }
+}
+
+/*
+ * Applies insn to the n elements streamed through ft0 and ft1 into ft2, under FREP if frep is set.
+ */
+#define BROADCAST_STREAM(insn, n, frep)                                       \
+    do {                                                                      \
+        if (frep) {                                                           \
+            asm volatile(                                                     \
+                "frep.o %[n_frep], 1, 0, 0 \n"                                \
+                insn " ft2, ft0, ft1 \n"                                      \
+                :: [n_frep] "r"((n) - 1) : "ft0", "ft1", "ft2", "memory"      \
+            );                                                                \
+        } else {                                                              \
+            for (size_t broadcast_i = 0; broadcast_i < (n); broadcast_i++) {  \
+                asm volatile(insn " ft2, ft0, ft1 \n" ::: "ft0", "ft1", "ft2", "memory"); \
+            }                                                                 \
+        }                                                                     \
+    } while (0)
+
+/*
+ * Computes the elements of result which the loops of l reach from a, b and result. The inner (up to)
+ * 4 loops are the streams of one pass, the outer loops iterate the passes. Without ssr a pass is a C loop,
+ * with frep the streams are consumed under FREP.
+ */
+static void broadcast_range(broadcast_kind_t kind, const double* a, const double* b, const broadcast_layout_t* l,
+                            int ssr, int frep, double* result) {
+    size_t inner = l->loops < 4 ? l->loops : 4;
+    size_t bounds[4] = {1, 1, 1, 1};
+    size_t a_strides[4] = {0, 0, 0, 0};
+    size_t b_strides[4] = {0, 0, 0, 0};
+    size_t inner_count = 1;
+    size_t outer_count = 1;
+
+    for (size_t k = 0; k < l->loops; k++) {
+        if (k < inner) {
+            bounds[k] = l->bounds[k];
+            a_strides[k] = l->a_strides[k];
+            b_strides[k] = l->b_strides[k];
+            inner_count *= l->bounds[k];
+        } else {
+            outer_count *= l->bounds[k];
+        }
+    }
+    if (inner_count == 0 || outer_count == 0) {
+        return;
+    }
+
+    for (size_t o = 0; o < outer_count; o++) {
+        size_t a_offset = 0;
+        size_t b_offset = 0;
+        size_t rest = o;
+        for (size_t k = inner; k < l->loops; k++) {
+            a_offset += (rest % l->bounds[k]) * l->a_strides[k];
+            b_offset += (rest % l->bounds[k]) * l->b_strides[k];
+            rest /= l->bounds[k];
+        }
+        double* out = result + o * inner_count;
+
+        if (!ssr) {
+            size_t i = 0;
+            for (size_t i3 = 0; i3 < bounds[3]; i3++) {
+                for (size_t i2 = 0; i2 < bounds[2]; i2++) {
+                    for (size_t i1 = 0; i1 < bounds[1]; i1++) {
+                        for (size_t i0 = 0; i0 < bounds[0]; i0++) {
+                            size_t ia = i0 * a_strides[0] + i1 * a_strides[1] + i2 * a_strides[2] + i3 * a_strides[3];
+                            size_t ib = i0 * b_strides[0] + i1 * b_strides[1] + i2 * b_strides[2] + i3 * b_strides[3];
+                            out[i++] = broadcast_apply(kind, a[a_offset + ia], b[b_offset + ib]);
+                        }
+                    }
+                }
+            }
+            continue;
+        }
+
+        snrt_ssr_loop_4d(SNRT_SSR_DM0, bounds[0], bounds[1], bounds[2], bounds[3],
+                         sizeof(double) * a_strides[0], sizeof(double) * a_strides[1],
+                         sizeof(double) * a_strides[2], sizeof(double) * a_strides[3]);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, (double*) a + a_offset);
+
+        snrt_ssr_loop_4d(SNRT_SSR_DM1, bounds[0], bounds[1], bounds[2], bounds[3],
+                         sizeof(double) * b_strides[0], sizeof(double) * b_strides[1],
+                         sizeof(double) * b_strides[2], sizeof(double) * b_strides[3]);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_4D, (double*) b + b_offset);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM2, inner_count, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, out);
+
+        snrt_ssr_enable();
+
+        switch (kind) {
+        case BROADCAST_SUB:
+            BROADCAST_STREAM("fsub.d", inner_count, frep);
+            break;
+        case BROADCAST_MUL:
+            BROADCAST_STREAM("fmul.d", inner_count, frep);
+            break;
+        case BROADCAST_DIV:
+            BROADCAST_STREAM("fdiv.d", inner_count, frep);
+            break;
+        case BROADCAST_PRELU:
+            // max(a, 0) + b * min(a, 0) without a branch
+            FPMATH_PASS(frep, inner_count, 4,
+                "fmv.d ft3, ft0 \n"
+                "fmin.d ft4, ft3, %[zero] \n"
+                "fmax.d ft3, ft3, %[zero] \n"
+                "fmadd.d ft2, ft4, ft1, ft3 \n",
+                [zero] "f"(0.0));
+            break;
+        default:
+            BROADCAST_STREAM("fadd.d", inner_count, frep);
+            break;
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+/*
+ * The part of core core_idx (of core_num) of the outermost loop.
+ */
+static void broadcast_core(broadcast_kind_t kind, const double* a, const double* b, const broadcast_layout_t* l,
+                           size_t core_idx, size_t core_num, int ssr, int frep, double* result) {
+    // A single element has no loop to split
+    if (l->loops == 0) {
+        if (core_idx == 0) {
+            result[0] = broadcast_apply(kind, a[0], b[0]);
+        }
+        return;
+    }
+
+    broadcast_layout_t local = *l;
+    size_t top = l->loops - 1;
+    size_t slice = 1;
+    for (size_t k = 0; k < top; k++) {
+        slice *= l->bounds[k];
+    }
+
+    size_t first;
+    local.bounds[top] = local_range(l->bounds[top], core_idx, core_num, &first);
+    broadcast_range(kind, a + first * l->a_strides[top], b + first * l->b_strides[top], &local,
+                    ssr, frep, result + first * slice);
+}
+
+__attribute__((noinline))
+int broadcast_baseline(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                       double* b, const size_t* b_shape, size_t b_ndim, double* result) {
+    broadcast_layout_t l;
+    if (broadcast_layout(a_shape, a_ndim, b_shape, b_ndim, &l)) {
+        return -1;
+    }
+    broadcast_core(kind, a, b, &l, 0, 1, 0, 0, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int broadcast_ssr(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                  double* b, const size_t* b_shape, size_t b_ndim, double* result) {
+    broadcast_layout_t l;
+    if (broadcast_layout(a_shape, a_ndim, b_shape, b_ndim, &l)) {
+        return -1;
+    }
+    broadcast_core(kind, a, b, &l, 0, 1, 1, 0, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int broadcast_ssr_frep(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                       double* b, const size_t* b_shape, size_t b_ndim, double* result) {
+    broadcast_layout_t l;
+    if (broadcast_layout(a_shape, a_ndim, b_shape, b_ndim, &l)) {
+        return -1;
+    }
+    broadcast_core(kind, a, b, &l, 0, 1, 1, 1, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int broadcast_parallel(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                       double* b, const size_t* b_shape, size_t b_ndim, double* result) {
+    broadcast_layout_t l;
+    if (broadcast_layout(a_shape, a_ndim, b_shape, b_ndim, &l)) {
+        return -1;
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+    broadcast_core(kind, a, b, &l, snrt_cluster_core_idx(), snrt_cluster_core_num() - 1, 0, 0, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int broadcast_ssr_frep_parallel(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                                double* b, const size_t* b_shape, size_t b_ndim, double* result) {
+    broadcast_layout_t l;
+    if (broadcast_layout(a_shape, a_ndim, b_shape, b_ndim, &l)) {
+        return -1;
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+    broadcast_core(kind, a, b, &l, snrt_cluster_core_idx(), snrt_cluster_core_num() - 1, 1, 1, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int broadcast_omp(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                  double* b, const size_t* b_shape, size_t b_ndim, double* result) {
+    // The last thread is not used in OpenMP.
+    unsigned core_num = snrt_cluster_core_num() - 1;
+    broadcast_layout_t l;
+    if (broadcast_layout(a_shape, a_ndim, b_shape, b_ndim, &l)) {
+        return -1;
+    }
+
+#pragma omp parallel
+    {
+        broadcast_core(kind, a, b, &l, snrt_cluster_core_idx(), core_num, 0, 0, result);
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int broadcast_ssr_frep_omp(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                           double* b, const size_t* b_shape, size_t b_ndim, double* result) {
+    // The last thread is not used in OpenMP.
+    unsigned core_num = snrt_cluster_core_num() - 1;
+    broadcast_layout_t l;
+    if (broadcast_layout(a_shape, a_ndim, b_shape, b_ndim, &l)) {
+        return -1;
+    }
+
+#pragma omp parallel
+    {
+        broadcast_core(kind, a, b, &l, snrt_cluster_core_idx(), core_num, 1, 1, result);
+    }
+
+    return 0;
+}
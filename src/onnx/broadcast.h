@@ -0,0 +1,48 @@
+#ifndef LMQ_BROADCAST_H
+#define LMQ_BROADCAST_H
+
+#include <snrt.h>
+
+/*
+ * Maximal number of dimensions of the inputs of broadcast_*.
+ */
+#define BROADCAST_MAX_DIMS 8
+
+/*
+ * ONNX Add, Sub, Mul and Div. BROADCAST_PRELU is a if a >= 0 and a * b otherwise (PRelu with the slope b).
+ */
+typedef enum {
+    BROADCAST_ADD,
+    BROADCAST_SUB,
+    BROADCAST_MUL,
+    BROADCAST_DIV,
+    BROADCAST_PRELU
+} broadcast_kind_t;
+
+/*
+ * result = a (op) b with ONNX multidirectional broadcasting: the shapes are aligned at the last dimension
+ * and every pair of dimensions is equal or one of them is 1 (or missing). result has the shape of the
+ * larger dimensions. A broadcast dimension is a zero stride of the read stream of its input, dimensions of
+ * size 1 are dropped and dimensions which are contiguous in both inputs merged. Up to 4 of the remaining
+ * dimensions are the loops of one pass, further dimensions iterate the passes.
+ * Returns -1 if an input has more than BROADCAST_MAX_DIMS dimensions or the shapes do not broadcast.
+ * The parallel and omp versions split the outermost remaining dimension among the compute cores.
+ */
+int broadcast_baseline(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                       double* b, const size_t* b_shape, size_t b_ndim, double* result);
+int broadcast_ssr(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                  double* b, const size_t* b_shape, size_t b_ndim, double* result);
+int broadcast_ssr_frep(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                       double* b, const size_t* b_shape, size_t b_ndim, double* result);
+
+int broadcast_parallel(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                       double* b, const size_t* b_shape, size_t b_ndim, double* result);
+int broadcast_ssr_frep_parallel(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                                double* b, const size_t* b_shape, size_t b_ndim, double* result);
+
+int broadcast_omp(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                  double* b, const size_t* b_shape, size_t b_ndim, double* result);
+int broadcast_ssr_frep_omp(broadcast_kind_t kind, double* a, const size_t* a_shape, size_t a_ndim,
+                           double* b, const size_t* b_shape, size_t b_ndim, double* result);
+
+#endif
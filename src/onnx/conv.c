@@ -1,13 +1,96 @@
 #include "printf.h"
 #include <snrt.h>
 
+#include <math.h>
+
 #include "lmq.h"
+#include "conv.h"
+#include "depthwise.h"
 
 size_t conv_output_size(size_t n, size_t filter_size, size_t stride, size_t dilation) {
     size_t effective_filter_size = 1 + (filter_size - 1) * dilation;
     return 1 + (n - effective_filter_size) / stride;
 }
 
+void conv_auto_pads(size_t n, size_t filter_size, size_t stride, size_t dilation, conv_auto_pad_t auto_pad,
+                    size_t* pad_begin, size_t* pad_end) {
+    if (auto_pad != CONV_AUTO_PAD_SAME_UPPER && auto_pad != CONV_AUTO_PAD_SAME_LOWER) {
+        *pad_begin = 0;
+        *pad_end = 0;
+        return;
+    }
+
+    size_t effective_filter_size = 1 + (filter_size - 1) * dilation;
+    size_t out = (n + stride - 1) / stride;
+    size_t needed = (out - 1) * stride + effective_filter_size;
+    size_t total = needed > n ? needed - n : 0;
+    // SAME_UPPER puts the odd element at the end, SAME_LOWER at the beginning
+    *pad_begin = auto_pad == CONV_AUTO_PAD_SAME_UPPER ? total / 2 : total - total / 2;
+    *pad_end = total - *pad_begin;
+}
+
+double conv_activation(double v, const conv_activation_t* act) {
+    if (act == NULL) {
+        return v;
+    }
+
+    switch (act->kind) {
+    case CONV_ACT_RELU:
+        return v > 0 ? v : 0;
+    case CONV_ACT_LEAKYRELU:
+        return v > 0 ? v : act->alpha * v;
+    case CONV_ACT_SIGMOID:
+        return 1 / (1 + exp(-v));
+    case CONV_ACT_CLIP:
+        return v < act->min ? act->min : (v > act->max ? act->max : v);
+    default:
+        return v;
+    }
+}
+
+// The accumulators of the SSR kernels are ft3 - ft6, ft0 - ft2 are the streams
+#define CONV_ACC_CLOBBERS "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+
+/*
+ * Applies relu, leaky relu or clip to the accumulator in the FP register reg (e.g. "ft3").
+ * Is used between the FREP of a kernel and the write back of reg, so the SSRs stay enabled.
+ * Sigmoid needs a call to exp and is applied by the kernels themselves.
+ */
+#define CONV_ACTIVATE_REG(reg, act)                                                             \
+    do {                                                                                        \
+        double _tmp_;                                                                           \
+        switch ((act)->kind) {                                                                  \
+        case CONV_ACT_RELU:                                                                     \
+            asm volatile(                                                                       \
+                "fcvt.d.w %[tmp], zero \n"                                                      \
+                "fmax.d " reg ", " reg ", %[tmp] \n"                                            \
+                : [tmp] "=&f"(_tmp_) : : CONV_ACC_CLOBBERS);                                    \
+            break;                                                                              \
+        case CONV_ACT_LEAKYRELU:                                                                \
+            /* max(x, alpha * x) for alpha <= 1, min(x, alpha * x) otherwise */                 \
+            if ((act)->alpha <= 1.0) {                                                          \
+                asm volatile(                                                                   \
+                    "fmul.d %[tmp], " reg ", %[alpha] \n"                                       \
+                    "fmax.d " reg ", " reg ", %[tmp] \n"                                        \
+                    : [tmp] "=&f"(_tmp_) : [alpha] "f"((act)->alpha) : CONV_ACC_CLOBBERS);      \
+            } else {                                                                            \
+                asm volatile(                                                                   \
+                    "fmul.d %[tmp], " reg ", %[alpha] \n"                                       \
+                    "fmin.d " reg ", " reg ", %[tmp] \n"                                        \
+                    : [tmp] "=&f"(_tmp_) : [alpha] "f"((act)->alpha) : CONV_ACC_CLOBBERS);      \
+            }                                                                                   \
+            break;                                                                              \
+        case CONV_ACT_CLIP:                                                                     \
+            asm volatile(                                                                       \
+                "fmax.d " reg ", " reg ", %[lo] \n"                                             \
+                "fmin.d " reg ", " reg ", %[hi] \n"                                             \
+                : : [lo] "f"((act)->min), [hi] "f"((act)->max) : CONV_ACC_CLOBBERS);            \
+            break;                                                                              \
+        default:                                                                                \
+            break;                                                                              \
+        }                                                                                       \
+    } while (0)
+
 __attribute__((noinline))
 int conv_baseline(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result) {
     size_t out_size = conv_output_size(n, filter_size, stride, dilation);
@@ -170,11 +253,168 @@ int conv2d_ssr(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_
     return 0;
 }
 
+/*
+ * The outn0 * outn1 outputs of conv2d_ssr_frep on the rows of row_len elements (not necessarily n0) of a,
+ * written to rows of result which are result_stride elements apart. All streams are configured once.
+ */
+static void conv2d_region_ssr_frep(double *a, double* filter, size_t row_len, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                                   size_t outn0, size_t outn1, double* result, size_t result_stride) {
+    if (outn0 == 0 || outn1 == 0) {
+        return;
+    }
+
+    snrt_ssr_loop_4d(SNRT_SSR_DM0, f0, f1, outn0, outn1, sizeof(*a) * d0, sizeof(*a) * row_len * d1, sizeof(*a) * s0, sizeof(*a) * s1 * row_len);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, a);
+
+    snrt_ssr_loop_4d(SNRT_SSR_DM1, f0, f1, outn0, outn1, sizeof(*a), sizeof(*a) * f0, 0, 0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_4D, filter);
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM2, outn0, outn1, sizeof(*result), sizeof(*result) * result_stride);
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, result);
+
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < outn0 * outn1; ++i) {
+        asm volatile(
+            "fmv.w.x ft4, zero \n"
+            "fcvt.d.s ft3, ft4 \n"
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "fmadd.d ft3, ft0, ft1, ft3 \n"
+            "fmv.d ft2, ft3 \n"
+            :
+            : [n_frep] "r"(f0 * f1 - 1)
+            : "ft0", "ft1", "ft2", "ft3"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
 __attribute__((noinline))
 int conv2d_ssr_frep(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
     size_t outn0 = conv_output_size(n0, f0, s0, d0);
     size_t outn1 = conv_output_size(n1, f1, s1, d1);
 
+    conv2d_region_ssr_frep(a, filter, n0, f0, f1, s0, s1, d0, d1, outn0, outn1, result, outn0);
+    return 0;
+}
+
+/*
+ * Same as conv2d_ssr_frep, but CONV2D_BLOCK neighbouring outputs of a row share one FREP body.
+ * Every filter weight is streamed once per block and repeated for the CONV2D_BLOCK accumulators
+ * instead of once per output. The last outn0 % CONV2D_BLOCK outputs of a row are computed without SSR.
+ */
+__attribute__((noinline))
+int conv2d_ssr_frep_blocked(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    size_t blocks = outn0 / CONV2D_BLOCK;
+
+    for (size_t i = 0; i < outn1; ++i) {
+        double* row = a + n0 * s1 * i;
+
+        if (blocks > 0) {
+            snrt_ssr_loop_4d(SNRT_SSR_DM0, CONV2D_BLOCK, f0, f1, blocks,
+                sizeof(*a) * s0, sizeof(*a) * d0, sizeof(*a) * n0 * d1, sizeof(*a) * s0 * CONV2D_BLOCK);
+            snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+            snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, row);
+
+            snrt_ssr_loop_2d(SNRT_SSR_DM1, f0 * f1, blocks, sizeof(*filter), 0);
+            snrt_ssr_repeat(SNRT_SSR_DM1, CONV2D_BLOCK);
+            snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, filter);
+
+            snrt_ssr_loop_1d(SNRT_SSR_DM2, blocks * CONV2D_BLOCK, sizeof(*result));
+            snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+            snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + i * outn0);
+
+            snrt_ssr_enable();
+
+            for (size_t j = 0; j < blocks; ++j) {
+                asm volatile(
+                    "fcvt.d.w ft3, zero \n"
+                    "fcvt.d.w ft4, zero \n"
+                    "fcvt.d.w ft5, zero \n"
+                    "fcvt.d.w ft6, zero \n"
+                    "frep.o %[n_frep], 4, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    "fmadd.d ft4, ft0, ft1, ft4 \n"
+                    "fmadd.d ft5, ft0, ft1, ft5 \n"
+                    "fmadd.d ft6, ft0, ft1, ft6 \n"
+                    "fmv.d ft2, ft3 \n"
+                    "fmv.d ft2, ft4 \n"
+                    "fmv.d ft2, ft5 \n"
+                    "fmv.d ft2, ft6 \n"
+                    :
+                    : [n_frep] "r"(f0 * f1 - 1)
+                    : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+                );
+            }
+
+            snrt_ssr_disable();
+        }
+
+        for (size_t j = blocks * CONV2D_BLOCK; j < outn0; ++j) {
+            double acc = 0;
+            for (size_t k = 0; k < f1; ++k) {
+                for (size_t l = 0; l < f0; ++l) {
+                    acc += row[n0 * k * d1 + s0 * j + l * d0] * filter[k * f0 + l];
+                }
+            }
+            result[i * outn0 + j] = acc;
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int conv_baseline_fused(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                        double bias, const conv_activation_t* act, double* result) {
+    size_t out_size = conv_output_size(n, filter_size, stride, dilation);
+    for (size_t i = 0; i < out_size; ++i) {
+        double acc = bias;
+        for (size_t j = 0; j < filter_size; ++j) {
+            acc += a[stride * i + dilation * j] * filter[j];
+        }
+        result[i] = conv_activation(acc, act);
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int conv2d_baseline_fused(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                          double bias, const conv_activation_t* act, double* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+
+    for (size_t i = 0; i < outn1; ++i) {
+        for (size_t j = 0; j < outn0; ++j) {
+            double acc = bias;
+            for (size_t k = 0; k < f1; ++k) {
+                for (size_t l = 0; l < f0; ++l) {
+                    acc += a[n0 * (s1 * i + k * d1) + s0 * j + l * d0] * filter[k * f0 + l];
+                }
+            }
+            result[i * outn0 + j] = conv_activation(acc, act);
+        }
+    }
+    return 0;
+}
+
+/*
+ * conv2d_ssr_frep with the bias as initial value of the accumulator and the activation
+ * applied to the accumulator before it is written back.
+ */
+__attribute__((noinline))
+int conv2d_ssr_frep_fused(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                          double bias, const conv_activation_t* act, double* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    conv_act_kind_t kind = act ? act->kind : CONV_ACT_NONE;
+
     snrt_ssr_loop_4d(SNRT_SSR_DM0, f0, f1, outn0, outn1, sizeof(*a) * d0, sizeof(*a) * n0 * d1, sizeof(*a) * s0, sizeof(*a) * s1 * n0);
     snrt_ssr_repeat(SNRT_SSR_DM0, 1);
     snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, a);
@@ -191,21 +431,126 @@ int conv2d_ssr_frep(double *a, double* filter, size_t n0, size_t n1, size_t f0,
 
     for (size_t i = 0; i < outn0 * outn1; ++i) {
         asm volatile(
-            "fmv.w.x ft4, zero \n"
-            "fcvt.d.s ft3, ft4 \n"
+            "fmv.d ft3, %[bias] \n"
             "frep.o %[n_frep], 1, 0, 0 \n"
             "fmadd.d ft3, ft0, ft1, ft3 \n"
-            "fmv.d ft2, ft3 \n"
             :
-            : [n_frep] "r"(f0 * f1 - 1)
-            : "ft0", "ft1", "ft2", "ft3"
+            : [n_frep] "r"(f0 * f1 - 1), [bias] "f"(bias)
+            : CONV_ACC_CLOBBERS
         );
+
+        if (kind == CONV_ACT_SIGMOID) {
+            // exp is a call, which may use the stream registers
+            double v;
+            asm volatile("fmv.d %[v], ft3 \n" : [v] "=f"(v) : : CONV_ACC_CLOBBERS);
+            snrt_fpu_fence();
+            snrt_ssr_disable();
+            v = conv_activation(v, act);
+            snrt_ssr_enable();
+            asm volatile("fmv.d ft2, %[v] \n" : : [v] "f"(v) : CONV_ACC_CLOBBERS);
+            continue;
+        }
+
+        if (kind != CONV_ACT_NONE) {
+            CONV_ACTIVATE_REG("ft3", act);
+        }
+        asm volatile("fmv.d ft2, ft3 \n" : : : CONV_ACC_CLOBBERS);
     }
 
     snrt_ssr_disable();
     return 0;
 }
 
+/*
+ * The 1D convolution is a 2D convolution of a single row.
+ */
+__attribute__((noinline))
+int conv_ssr_frep_fused(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                        double bias, const conv_activation_t* act, double* result) {
+    return conv2d_ssr_frep_fused(a, filter, n, 1, filter_size, 1, stride, 1, dilation, 1, bias, act, result);
+}
+
+/*
+ * Gives every core a contiguous range of output rows, the ranges differ by at most one row.
+ * Returns the number of rows and sets first to the first row of the core.
+ */
+static inline size_t conv2d_local_rows(size_t outn1, size_t core_idx, size_t core_num, size_t* first) {
+    // The first 'leftover' cores do one more row
+    size_t local_rows = outn1 / core_num;
+    size_t leftover = outn1 - local_rows * core_num;
+    *first = core_idx * local_rows + (core_idx < leftover ? core_idx : leftover);
+    return local_rows + (core_idx < leftover ? 1 : 0);
+}
+
+/*
+ * The parallel conv2d variants split the output rows over the compute cores.
+ * A core runs the single core kernel on the input rows its output rows depend on,
+ * i.e. its rows plus the halo of (f1 - 1) * d1 rows below them, so it gets its own 4D SSR pattern.
+ */
+#define CONV2D_PARALLEL_ROWS(kernel)                                                            \
+    do {                                                                                        \
+        size_t outn0 = conv_output_size(n0, f0, s0, d0);                                        \
+        size_t outn1 = conv_output_size(n1, f1, s1, d1);                                        \
+        size_t first;                                                                           \
+        size_t rows = conv2d_local_rows(outn1, core_idx, core_num, &first);                     \
+        if (rows > 0) {                                                                         \
+            size_t local_n1 = (rows - 1) * s1 + (1 + (f1 - 1) * d1);                            \
+            kernel(a + first * s1 * n0, filter, n0, local_n1, f0, f1, s0, s1, d0, d1,           \
+                   result + first * outn0);                                                     \
+        }                                                                                       \
+    } while (0)
+
+__attribute__((noinline))
+int conv2d_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    CONV2D_PARALLEL_ROWS(conv2d_baseline);
+    return 0;
+}
+
+__attribute__((noinline))
+int conv2d_ssr_frep_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    CONV2D_PARALLEL_ROWS(conv2d_ssr_frep);
+    return 0;
+}
+
+__attribute__((noinline))
+int conv2d_ssr_frep_blocked_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    CONV2D_PARALLEL_ROWS(conv2d_ssr_frep_blocked);
+    return 0;
+}
+
+int conv2d_ssr_frep_omp(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+#pragma omp parallel
+    {
+        size_t core_num = snrt_cluster_core_num() - 1;
+        size_t core_idx = snrt_cluster_core_idx();
+
+        CONV2D_PARALLEL_ROWS(conv2d_ssr_frep);
+    }
+
+    return 0;
+}
+
 __attribute__((noinline))
 int conv_parallel(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result) {
     size_t core_num = snrt_cluster_core_num() - 1;
@@ -366,3 +711,473 @@ int conv_ssr_frep_parallel(double *a, double* filter, size_t n, size_t filter_si
 
     return 0;
 }
+
+__attribute__((noinline))
+int conv_nchw_baseline(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    return conv_nchw_baseline_fused(x, w, bias, batch, c_in, n0, n1, c_out, groups, f0, f1, s0, s1, d0, d1, NULL, result);
+}
+
+__attribute__((noinline))
+int conv_nchw_baseline_fused(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                             size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, const conv_activation_t* act, double* result) {
+    if (groups == 0 || c_in % groups || c_out % groups) {
+        return -1;
+    }
+
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    size_t in_per_group = c_in / groups;
+    size_t out_per_group = c_out / groups;
+
+    for (size_t b = 0; b < batch; ++b) {
+        for (size_t co = 0; co < c_out; ++co) {
+            size_t g = co / out_per_group;
+            for (size_t i = 0; i < outn1; ++i) {
+                for (size_t j = 0; j < outn0; ++j) {
+                    double acc = bias ? bias[co] : 0.0;
+                    for (size_t ci = 0; ci < in_per_group; ++ci) {
+                        double* plane = x + ((b * c_in) + g * in_per_group + ci) * n0 * n1;
+                        double* filter = w + (co * in_per_group + ci) * f0 * f1;
+                        for (size_t k = 0; k < f1; ++k) {
+                            for (size_t l = 0; l < f0; ++l) {
+                                acc += plane[n0 * (s1 * i + k * d1) + s0 * j + l * d0] * filter[k * f0 + l];
+                            }
+                        }
+                    }
+                    result[((b * c_out + co) * outn1 + i) * outn0 + j] = conv_activation(acc, act);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Computes CONV_BLOCK output channels (or a single one if channels is 1) of one image.
+ * This is a gemm of the filters (channels, in_per_group * f1 * f0) with the im2col matrix of x,
+ * but the im2col matrix is never stored: DM0 generates it on the fly with a 4D loop over
+ * (f0, f1, input channel, output column) and repeats every element for the CONV_BLOCK filters.
+ * The accumulators are initialised with the bias and the activation act (may be NULL)
+ * is applied before they are written back.
+ */
+static inline void conv_nchw_block(double *x, double* w, double* bias, const size_t channels, size_t in_per_group, size_t n0, size_t n1,
+                                   size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                                   const conv_activation_t* act, double* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    size_t filter_len = in_per_group * f0 * f1;
+    conv_act_kind_t kind = act ? act->kind : CONV_ACT_NONE;
+    double b[CONV_BLOCK] = { 0.0 };
+
+    for (size_t c = 0; bias && c < channels; ++c) {
+        b[c] = bias[c];
+    }
+
+    // One output row per SSR configuration as its start depends on the stride s1
+    for (size_t i = 0; i < outn1; ++i) {
+        snrt_ssr_loop_4d(SNRT_SSR_DM0, f0, f1, in_per_group, outn0,
+            sizeof(*x) * d0, sizeof(*x) * n0 * d1, sizeof(*x) * n0 * n1, sizeof(*x) * s0);
+        snrt_ssr_repeat(SNRT_SSR_DM0, channels);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, x + i * s1 * n0);
+
+        if (channels == CONV_BLOCK) {
+            snrt_ssr_loop_3d(SNRT_SSR_DM1, CONV_BLOCK, filter_len, outn0, sizeof(*w) * filter_len, sizeof(*w), 0);
+            snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, w);
+
+            snrt_ssr_loop_2d(SNRT_SSR_DM2, CONV_BLOCK, outn0, sizeof(*result) * outn0 * outn1, sizeof(*result));
+        } else {
+            snrt_ssr_loop_2d(SNRT_SSR_DM1, filter_len, outn0, sizeof(*w), 0);
+            snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, w);
+
+            snrt_ssr_loop_2d(SNRT_SSR_DM2, 1, outn0, 0, sizeof(*result));
+        }
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, result + i * outn0);
+
+        snrt_ssr_enable();
+
+        for (size_t j = 0; j < outn0 && kind != CONV_ACT_NONE; ++j) {
+            if (channels == CONV_BLOCK) {
+                asm volatile(
+                    "fmv.d ft3, %[b0] \n"
+                    "fmv.d ft4, %[b1] \n"
+                    "fmv.d ft5, %[b2] \n"
+                    "fmv.d ft6, %[b3] \n"
+                    "frep.o %[n_frep], 4, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    "fmadd.d ft4, ft0, ft1, ft4 \n"
+                    "fmadd.d ft5, ft0, ft1, ft5 \n"
+                    "fmadd.d ft6, ft0, ft1, ft6 \n"
+                    :
+                    : [n_frep] "r"(filter_len - 1), [b0] "f"(b[0]), [b1] "f"(b[1]), [b2] "f"(b[2]), [b3] "f"(b[3])
+                    : CONV_ACC_CLOBBERS
+                );
+            } else {
+                asm volatile(
+                    "fmv.d ft3, %[b0] \n"
+                    "frep.o %[n_frep], 1, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    :
+                    : [n_frep] "r"(filter_len - 1), [b0] "f"(b[0])
+                    : CONV_ACC_CLOBBERS
+                );
+            }
+
+            if (kind == CONV_ACT_SIGMOID) {
+                // exp is a call, which may use the stream and the accumulator registers
+                double v[CONV_BLOCK];
+                asm volatile(
+                    "fmv.d %[v0], ft3 \n"
+                    "fmv.d %[v1], ft4 \n"
+                    "fmv.d %[v2], ft5 \n"
+                    "fmv.d %[v3], ft6 \n"
+                    : [v0] "=f"(v[0]), [v1] "=f"(v[1]), [v2] "=f"(v[2]), [v3] "=f"(v[3])
+                    :
+                    : CONV_ACC_CLOBBERS
+                );
+                snrt_fpu_fence();
+                snrt_ssr_disable();
+                for (size_t c = 0; c < channels; ++c) {
+                    v[c] = conv_activation(v[c], act);
+                }
+                snrt_ssr_enable();
+                for (size_t c = 0; c < channels; ++c) {
+                    asm volatile("fmv.d ft2, %[v] \n" : : [v] "f"(v[c]) : CONV_ACC_CLOBBERS);
+                }
+                continue;
+            }
+
+            CONV_ACTIVATE_REG("ft3", act);
+            if (channels == CONV_BLOCK) {
+                CONV_ACTIVATE_REG("ft4", act);
+                CONV_ACTIVATE_REG("ft5", act);
+                CONV_ACTIVATE_REG("ft6", act);
+                asm volatile(
+                    "fmv.d ft2, ft3 \n"
+                    "fmv.d ft2, ft4 \n"
+                    "fmv.d ft2, ft5 \n"
+                    "fmv.d ft2, ft6 \n"
+                    : : : CONV_ACC_CLOBBERS
+                );
+            } else {
+                asm volatile("fmv.d ft2, ft3 \n" : : : CONV_ACC_CLOBBERS);
+            }
+        }
+
+        for (size_t j = 0; j < outn0 && kind == CONV_ACT_NONE; ++j) {
+            if (channels == CONV_BLOCK) {
+                asm volatile(
+                    "fmv.d ft3, %[b0] \n"
+                    "fmv.d ft4, %[b1] \n"
+                    "fmv.d ft5, %[b2] \n"
+                    "fmv.d ft6, %[b3] \n"
+                    "frep.o %[n_frep], 4, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    "fmadd.d ft4, ft0, ft1, ft4 \n"
+                    "fmadd.d ft5, ft0, ft1, ft5 \n"
+                    "fmadd.d ft6, ft0, ft1, ft6 \n"
+                    "fmv.d ft2, ft3 \n"
+                    "fmv.d ft2, ft4 \n"
+                    "fmv.d ft2, ft5 \n"
+                    "fmv.d ft2, ft6 \n"
+                    :
+                    : [n_frep] "r"(filter_len - 1), [b0] "f"(b[0]), [b1] "f"(b[1]), [b2] "f"(b[2]), [b3] "f"(b[3])
+                    : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+                );
+            } else {
+                asm volatile(
+                    "fmv.d ft3, %[b0] \n"
+                    "frep.o %[n_frep], 1, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    "fmv.d ft2, ft3 \n"
+                    :
+                    : [n_frep] "r"(filter_len - 1), [b0] "f"(b[0])
+                    : "ft0", "ft1", "ft2", "ft3"
+                );
+            }
+        }
+
+        snrt_ssr_disable();
+    }
+}
+
+/*
+ * Computes the work units first, first + step, ... of the convolution.
+ * A unit is a block of CONV_BLOCK output channels of one image. If the output channels
+ * of a group are not divisible by CONV_BLOCK, the last unit of the group does the rest one by one.
+ */
+static inline int conv_nchw_units(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                                  size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                                  const conv_activation_t* act, double* result,
+                                  const size_t first, const size_t step) {
+    if (groups == 0 || c_in % groups || c_out % groups) {
+        return -1;
+    }
+
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    size_t in_per_group = c_in / groups;
+    size_t out_per_group = c_out / groups;
+    size_t blocks_per_group = (out_per_group + CONV_BLOCK - 1) / CONV_BLOCK;
+    size_t filter_len = in_per_group * f0 * f1;
+    size_t units = batch * groups * blocks_per_group;
+
+    for (size_t u = first; u < units; u += step) {
+        size_t b = u / (groups * blocks_per_group);
+        size_t g = (u / blocks_per_group) % groups;
+        size_t co = g * out_per_group + (u % blocks_per_group) * CONV_BLOCK;
+        size_t left = (g + 1) * out_per_group - co;
+        size_t channels = left < CONV_BLOCK ? left : CONV_BLOCK;
+        double* in = x + (b * c_in + g * in_per_group) * n0 * n1;
+
+        // A full block at once, otherwise the channels one by one
+        size_t block = channels == CONV_BLOCK ? CONV_BLOCK : 1;
+        for (size_t c = co; c < co + channels; c += block) {
+            conv_nchw_block(in, w + c * filter_len, bias ? bias + c : NULL, block, in_per_group, n0, n1,
+                f0, f1, s0, s1, d0, d1, act, result + (b * c_out + c) * outn0 * outn1);
+        }
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int conv_nchw_ssr_frep(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    if (groups > 1 && groups == c_in && groups == c_out) {
+        return conv_depthwise_ssr_frep(x, w, bias, batch, c_in, n0, n1, f0, f1, s0, s1, d0, d1, result);
+    }
+    return conv_nchw_units(x, w, bias, batch, c_in, n0, n1, c_out, groups, f0, f1, s0, s1, d0, d1, NULL, result, 0, 1);
+}
+
+__attribute__((noinline))
+int conv_nchw_ssr_frep_fused(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                             size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, const conv_activation_t* act, double* result) {
+    return conv_nchw_units(x, w, bias, batch, c_in, n0, n1, c_out, groups, f0, f1, s0, s1, d0, d1, act, result, 0, 1);
+}
+
+/*
+ * The units (blocks of output channels) are spread over the compute cores round robin.
+ */
+__attribute__((noinline))
+int conv_nchw_ssr_frep_parallel(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                                size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (groups > 1 && groups == c_in && groups == c_out) {
+        return conv_depthwise_ssr_frep_parallel(x, w, bias, batch, c_in, n0, n1, f0, f1, s0, s1, d0, d1, result);
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    return conv_nchw_units(x, w, bias, batch, c_in, n0, n1, c_out, groups, f0, f1, s0, s1, d0, d1, NULL, result, core_idx, core_num);
+}
+
+__attribute__((noinline))
+int conv_nchw_ssr_frep_parallel_fused(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                                      size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, const conv_activation_t* act, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    return conv_nchw_units(x, w, bias, batch, c_in, n0, n1, c_out, groups, f0, f1, s0, s1, d0, d1, act, result, core_idx, core_num);
+}
+
+/*
+ * The taps [lo, hi) of a filter of f taps (dilation d) at output o (stride s) which read the input of n elements
+ * instead of the pad elements of zero padding before it (or the padding after it).
+ */
+static inline void conv_pad_taps(size_t o, size_t s, size_t d, size_t pad, size_t n, size_t f, size_t* lo, size_t* hi) {
+    size_t start = o * s;
+    size_t l = start >= pad ? 0 : (pad - start + d - 1) / d;
+    size_t h = start < n + pad ? (n + pad - start + d - 1) / d : 0;
+    h = h < f ? h : f;
+    *lo = l < h ? l : h;
+    *hi = h;
+}
+
+__attribute__((noinline))
+int conv2d_pad_baseline(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                        size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, double* result) {
+    size_t outn0 = conv_output_size(n0 + p0_begin + p0_end, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1 + p1_begin + p1_end, f1, s1, d1);
+
+    for (size_t i = 0; i < outn1; ++i) {
+        for (size_t j = 0; j < outn0; ++j) {
+            double acc = 0;
+            for (size_t k = 0; k < f1; ++k) {
+                size_t y = s1 * i + k * d1;
+                if (y < p1_begin || y >= p1_begin + n1) {
+                    continue;
+                }
+                for (size_t l = 0; l < f0; ++l) {
+                    size_t x = s0 * j + l * d0;
+                    if (x >= p0_begin && x < p0_begin + n0) {
+                        acc += a[n0 * (y - p1_begin) + x - p0_begin] * filter[k * f0 + l];
+                    }
+                }
+            }
+            result[i * outn0 + j] = acc;
+        }
+    }
+    return 0;
+}
+
+/*
+ * The outputs [lo, hi) of out outputs whose windows are entirely inside the n input elements,
+ * i.e. which have all f taps (conv_pad_taps gives [0, f)).
+ */
+static inline void conv_pad_interior(size_t n, size_t f, size_t s, size_t d, size_t pad, size_t out, size_t* lo, size_t* hi) {
+    size_t effective_filter_size = 1 + (f - 1) * d;
+    size_t l = (pad + s - 1) / s;
+    size_t h = n + pad >= effective_filter_size ? (n + pad - effective_filter_size) / s + 1 : 0;
+    l = l < out ? l : out;
+    h = h < out ? h : out;
+    *lo = l;
+    *hi = h > l ? h : l;
+}
+
+/*
+ * The outputs [j_first, j_end) of the output rows [first, first + rows) of conv2d_pad. The outputs of a row are
+ * cut into runs with the same taps inside the input (one per output close to the borders). A run is one
+ * configuration of the streams of conv2d_ssr_frep with the bounds clamped to these taps and the filter offset
+ * to the first of them.
+ */
+static void conv2d_pad_rows(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                            size_t p0_begin, size_t p1_begin, size_t outn0, size_t first, size_t rows, size_t j_first, size_t j_end,
+                            double* result) {
+    for (size_t i = first; i < first + rows; ++i) {
+        size_t k_lo, k_hi;
+        conv_pad_taps(i, s1, d1, p1_begin, n1, f1, &k_lo, &k_hi);
+        double* out = result + i * outn0;
+
+        for (size_t j = j_first; j < j_end;) {
+            size_t l_lo, l_hi, lo, hi;
+            conv_pad_taps(j, s0, d0, p0_begin, n0, f0, &l_lo, &l_hi);
+            size_t run = 1;
+            while (j + run < j_end) {
+                conv_pad_taps(j + run, s0, d0, p0_begin, n0, f0, &lo, &hi);
+                if (lo != l_lo || hi != l_hi) {
+                    break;
+                }
+                run++;
+            }
+
+            // Windows which only cover padding
+            size_t taps = (l_hi - l_lo) * (k_hi - k_lo);
+            if (taps == 0) {
+                for (size_t r = 0; r < run; ++r) {
+                    out[j + r] = 0.0;
+                }
+                j += run;
+                continue;
+            }
+
+            double* window = a + n0 * (s1 * i + k_lo * d1 - p1_begin) + (s0 * j + l_lo * d0 - p0_begin);
+            snrt_ssr_loop_3d(SNRT_SSR_DM0, l_hi - l_lo, k_hi - k_lo, run, sizeof(*a) * d0, sizeof(*a) * n0 * d1, sizeof(*a) * s0);
+            snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+            snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, window);
+
+            snrt_ssr_loop_3d(SNRT_SSR_DM1, l_hi - l_lo, k_hi - k_lo, run, sizeof(*filter), sizeof(*filter) * f0, 0);
+            snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+            snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, filter + k_lo * f0 + l_lo);
+
+            snrt_ssr_loop_1d(SNRT_SSR_DM2, run, sizeof(*result));
+            snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+            snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, out + j);
+
+            snrt_ssr_enable();
+
+            for (size_t r = 0; r < run; ++r) {
+                asm volatile(
+                    "fcvt.d.w ft3, zero \n"
+                    "frep.o %[n_frep], 1, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    "fmv.d ft2, ft3 \n"
+                    :
+                    : [n_frep] "r"(taps - 1)
+                    : "ft0", "ft1", "ft2", "ft3"
+                );
+            }
+
+            snrt_fpu_fence();
+            snrt_ssr_disable();
+            j += run;
+        }
+    }
+}
+
+/*
+ * Output rows [first, first + rows) of conv2d_pad. The interior rectangle of outputs with all taps inside a is a
+ * single conv2d_ssr_frep stream configuration on a (rows n0 apart), only the thin border of rows and columns
+ * above, below, left and right of it goes through the clamped runs of conv2d_pad_rows.
+ */
+static void conv2d_pad_block(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                             size_t p0_begin, size_t p1_begin, size_t outn0, size_t outn1, size_t first, size_t rows, double* result) {
+    size_t i_lo, i_hi, j_lo, j_hi;
+    conv_pad_interior(n1, f1, s1, d1, p1_begin, outn1, &i_lo, &i_hi);
+    conv_pad_interior(n0, f0, s0, d0, p0_begin, outn0, &j_lo, &j_hi);
+
+    // The interior rows of [first, first + rows)
+    size_t last = first + rows;
+    i_lo = i_lo > first ? i_lo : first;
+    i_hi = i_hi < last ? i_hi : last;
+    if (i_hi <= i_lo || j_hi == j_lo) {
+        conv2d_pad_rows(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, outn0, first, rows, 0, outn0, result);
+        return;
+    }
+
+    conv2d_pad_rows(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, outn0, first, i_lo - first, 0, outn0, result);
+    conv2d_pad_rows(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, outn0, i_lo, i_hi - i_lo, 0, j_lo, result);
+    conv2d_region_ssr_frep(a + n0 * (s1 * i_lo - p1_begin) + (s0 * j_lo - p0_begin), filter, n0, f0, f1, s0, s1, d0, d1,
+                           j_hi - j_lo, i_hi - i_lo, result + i_lo * outn0 + j_lo, outn0);
+    conv2d_pad_rows(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, outn0, i_lo, i_hi - i_lo, j_hi, outn0, result);
+    conv2d_pad_rows(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, outn0, i_hi, last - i_hi, 0, outn0, result);
+}
+
+__attribute__((noinline))
+int conv2d_pad_ssr_frep(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                        size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, double* result) {
+    size_t outn0 = conv_output_size(n0 + p0_begin + p0_end, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1 + p1_begin + p1_end, f1, s1, d1);
+
+    conv2d_pad_block(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, outn0, outn1, 0, outn1, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int conv2d_pad_ssr_frep_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                                 size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t outn0 = conv_output_size(n0 + p0_begin + p0_end, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1 + p1_begin + p1_end, f1, s1, d1);
+    size_t first;
+    size_t rows = conv2d_local_rows(outn1, core_idx, core_num, &first);
+    conv2d_pad_block(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, outn0, outn1, first, rows, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int conv_pad_baseline(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                      size_t pad_begin, size_t pad_end, double* result) {
+    return conv2d_pad_baseline(a, filter, n, 1, filter_size, 1, stride, 1, dilation, 1, pad_begin, 0, pad_end, 0, result);
+}
+
+__attribute__((noinline))
+int conv_pad_ssr_frep(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                      size_t pad_begin, size_t pad_end, double* result) {
+    return conv2d_pad_ssr_frep(a, filter, n, 1, filter_size, 1, stride, 1, dilation, 1, pad_begin, 0, pad_end, 0, result);
+}
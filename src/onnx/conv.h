@@ -0,0 +1,145 @@
+#ifndef LMQ_CONV_H
+#define LMQ_CONV_H
+
+#include <snrt.h>
+
+/*
+ * Number of output elements which is produced by a 1D convolution of an input of n elements.
+ */
+size_t conv_output_size(size_t n, size_t filter_size, size_t stride, size_t dilation);
+
+/*
+ * ONNX Conv auto_pad attribute.
+ */
+typedef enum {
+    CONV_AUTO_PAD_NOTSET,
+    CONV_AUTO_PAD_VALID,
+    CONV_AUTO_PAD_SAME_UPPER,
+    CONV_AUTO_PAD_SAME_LOWER,
+} conv_auto_pad_t;
+
+/*
+ * Sets the pads of one dimension of n elements for auto_pad: SAME_UPPER and SAME_LOWER pad to ceil(n / stride)
+ * outputs, with the odd pad element at the end (or at the beginning), NOTSET and VALID give no padding
+ * (explicit ONNX pads are passed to the *_pad convolutions as they are).
+ */
+void conv_auto_pads(size_t n, size_t filter_size, size_t stride, size_t dilation, conv_auto_pad_t auto_pad,
+                    size_t* pad_begin, size_t* pad_end);
+
+int conv_baseline(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
+int conv_ssr(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
+int conv_ssr_frep(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
+
+int conv_parallel(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
+int conv_ssr_parallel(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
+int conv_ssr_frep_parallel(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation, double* result);
+
+/*
+ * 2D convolution of a single channel image a of (n1, n0) with a filter of (f1, f0).
+ * Index 0 is the innermost (contiguous) dimension.
+ */
+int conv2d_baseline(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv2d_ssr(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv2d_ssr_frep(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+
+/*
+ * Number of neighbouring outputs of a row conv2d_ssr_frep_blocked computes at once.
+ */
+#define CONV2D_BLOCK 4
+
+int conv2d_ssr_frep_blocked(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+
+/*
+ * conv2d with the output rows split over the compute cores.
+ */
+int conv2d_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv2d_ssr_frep_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv2d_ssr_frep_blocked_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv2d_ssr_frep_omp(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+
+/*
+ * conv2d of a with the zero padding of an ONNX Pad (or of the pads of Conv) in front of it: pads
+ * (p0_begin, p1_begin, p0_end, p1_end), the output has conv_output_size(n + pad_begin + pad_end) elements per
+ * dimension. No padded copy of a is made: the interior outputs, whose windows are inside a, are one
+ * conv2d_ssr_frep stream configuration, only for the border outputs the SSR bounds are clamped to the taps
+ * inside a. The parallel version splits the output rows.
+ */
+int conv2d_pad_baseline(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                        size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, double* result);
+int conv2d_pad_ssr_frep(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                        size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, double* result);
+int conv2d_pad_ssr_frep_parallel(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                                 size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, double* result);
+
+/*
+ * 1D conv with pad_begin and pad_end zeros around a, as conv2d_pad of a single row.
+ */
+int conv_pad_baseline(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                      size_t pad_begin, size_t pad_end, double* result);
+int conv_pad_ssr_frep(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                      size_t pad_begin, size_t pad_end, double* result);
+
+/*
+ * Activation of the *_fused convolutions. alpha is the slope of leaky relu for negative inputs,
+ * min and max are the bounds of clip.
+ */
+typedef enum {
+    CONV_ACT_NONE,
+    CONV_ACT_RELU,
+    CONV_ACT_LEAKYRELU,
+    CONV_ACT_SIGMOID,
+    CONV_ACT_CLIP,
+} conv_act_kind_t;
+
+typedef struct {
+    conv_act_kind_t kind;
+    double alpha;
+    double min;
+    double max;
+} conv_activation_t;
+
+/*
+ * Applies the activation act (may be NULL) to v.
+ */
+double conv_activation(double v, const conv_activation_t* act);
+
+/*
+ * Convolutions with the bias and the activation act (may be NULL) applied to the accumulator
+ * before it is written, so conv -> add bias -> activation is a single pass over the output.
+ */
+int conv_baseline_fused(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                        double bias, const conv_activation_t* act, double* result);
+int conv_ssr_frep_fused(double *a, double* filter, size_t n, size_t filter_size, size_t stride, size_t dilation,
+                        double bias, const conv_activation_t* act, double* result);
+int conv2d_baseline_fused(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                          double bias, const conv_activation_t* act, double* result);
+int conv2d_ssr_frep_fused(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                          double bias, const conv_activation_t* act, double* result);
+
+/*
+ * Number of output channels the NCHW convolution computes at once.
+ */
+#define CONV_BLOCK 4
+
+/*
+ * ONNX Conv on NCHW tensors: x is (batch, c_in, n1, n0), w is (c_out, c_in / groups, f1, f0),
+ * bias is (c_out) or NULL and result is (batch, c_out, outn1, outn0).
+ * c_in and c_out must be divisible by groups. Returns -1 otherwise.
+ * Depthwise convolutions (groups == c_in == c_out) run conv_depthwise_* (src/onnx/depthwise.h) in the ssr_frep
+ * versions without an activation.
+ */
+int conv_nchw_baseline(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv_nchw_ssr_frep(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv_nchw_ssr_frep_parallel(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                                size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+
+int conv_nchw_baseline_fused(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                             size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, const conv_activation_t* act, double* result);
+int conv_nchw_ssr_frep_fused(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                             size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, const conv_activation_t* act, double* result);
+int conv_nchw_ssr_frep_parallel_fused(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                                      size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, const conv_activation_t* act, double* result);
+
+#endif
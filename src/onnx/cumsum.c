@@ -1,4 +1,3 @@
-
 #include <snrt.h>
 
 #include <cumsum.h>
@@ -6,6 +5,11 @@
 #include "lmq.h"
 #include "printf.h"
 
+#ifndef LMQ_HOST
+#include "reduce.h"
+#include "tile.h"
+#endif
+
 /*
  * Naive implementation of cumulative sum. Calculates the cumulative sum of n elements starting at arr.
  */
@@ -22,349 +26,526 @@ int cumsum_baseline(const double* arr, const size_t n, double* result) {
     return 0;
 }
 
-__attribute__((noinline))
-int cumsum_ssr(const double* arr, const size_t n, volatile double* result) {
-    register volatile double ft0 asm("ft0");
-    register volatile double ft2 asm("ft2");
+#ifndef LMQ_HOST
 
-    // ft0 is input
-    asm volatile("" : "=f"(ft0));
+/*
+ * Scans the count elements starting at arr + first in C, starting with the sum offset.
+ */
+static inline void cumsum_block_baseline(const double* arr, size_t first, size_t count, double offset,
+                                         int exclusive, int reverse, volatile double* result) {
+    double sum = offset;
+
+    for (size_t j = 0; j < count; j++) {
+        size_t i = reverse ? first + count - 1 - j : first + j;
+
+        if (exclusive) {
+            result[i] = sum;
+            sum += arr[i];
+        } else {
+            sum += arr[i];
+            result[i] = sum;
+        }
+    }
+}
+
+/*
+ * Scans the count elements starting at arr + first, starting with the sum offset.
+ * arr is streamed through ft0 and the result through ft2, the running sum is kept in ft3.
+ * For reverse both streams start at the last element and use a negative stride.
+ * With frep the loop is a 2 instruction FREP body, otherwise a branch loop.
+ * The exclusive scan pops arr[i] (into ft4) before it pushes result[i], so it may run in place.
+ * Returns offset plus the sum of the elements, the carry of the next block.
+ */
+static inline double cumsum_block_ssr(const double* arr, size_t first, size_t count, double offset,
+                                      int exclusive, int reverse, int frep, volatile double* result) {
+    if (count == 0) {
+        return offset;
+    }
+
+    size_t start = reverse ? first + count - 1 : first;
+    size_t stride = reverse ? -sizeof(*arr) : sizeof(*arr);
 
     // stream arr into ft0
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, count, stride);
     snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + start);
 
-    // // stream from register ft2 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM2, n, sizeof(*result));
+    // stream from register ft2 into result
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, count, stride);
     snrt_ssr_repeat(SNRT_SSR_DM2, 1);
-    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + start);
 
     snrt_ssr_enable();
 
-    // i need my own loop
-    asm volatile(
-        "addi a0, zero, 0\n"      // a0 counts
-        "addi a1, zero, 0\n"
-        "fcvt.d.w ft1, a1\n"     // ft1 stores the cumulative sum. Set it to 0.0
-        "1:\n"
-            "addi a0, a0, 1\n"
-            "fadd.d ft1, ft0, ft1\n" // ft1 <- ft0 (streamed arr[i]) + ft1
-            "fmv.d ft2, ft1\n"
-        "3:"
-        "blt a0, %[n], 1b\n"
-        :: [n] "r"(n) 
-        : "ft0", "ft1", "ft2", "a0", "a1"
-    );
+    double sum;
+    if (frep && exclusive) {
+        asm volatile(
+            "fmv.d ft3, %[offset] \n"
+            "frep.o %[n_frep], 3, 0, 0 \n"
+                "fmv.d ft4, ft0 \n"
+                "fmv.d ft2, ft3 \n"
+                "fadd.d ft3, ft4, ft3 \n"
+            "fmv.d %[sum], ft3 \n"
+            : [sum] "=f"(sum)
+            : [n_frep] "r"(count - 1), [offset] "f"(offset)
+            : "ft0", "ft1", "ft2", "ft3", "ft4"
+        );
+    } else if (frep) {
+        asm volatile(
+            "fmv.d ft3, %[offset] \n"
+            "frep.o %[n_frep], 2, 0, 0 \n"
+                "fadd.d ft3, ft0, ft3 \n"
+                "fmv.d ft2, ft3 \n"
+            "fmv.d %[sum], ft3 \n"
+            : [sum] "=f"(sum)
+            : [n_frep] "r"(count - 1), [offset] "f"(offset)
+            : "ft0", "ft1", "ft2", "ft3"
+        );
+    } else if (exclusive) {
+        asm volatile(
+            "addi a0, zero, 0 \n"
+            "fmv.d ft3, %[offset] \n"
+            "1: \n"
+                "addi a0, a0, 1 \n"
+                "fmv.d ft4, ft0 \n"
+                "fmv.d ft2, ft3 \n"
+                "fadd.d ft3, ft4, ft3 \n"
+            "blt a0, %[n], 1b \n"
+            "fmv.d %[sum], ft3 \n"
+            : [sum] "=f"(sum)
+            : [n] "r"(count), [offset] "f"(offset)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "a0"
+        );
+    } else {
+        asm volatile(
+            "addi a0, zero, 0 \n"
+            "fmv.d ft3, %[offset] \n"
+            "1: \n"
+                "addi a0, a0, 1 \n"
+                "fadd.d ft3, ft0, ft3 \n"
+                "fmv.d ft2, ft3 \n"
+            "blt a0, %[n], 1b \n"
+            "fmv.d %[sum], ft3 \n"
+            : [sum] "=f"(sum)
+            : [n] "r"(count), [offset] "f"(offset)
+            : "ft0", "ft1", "ft2", "ft3", "a0"
+        );
+    }
 
+    snrt_fpu_fence();
     snrt_ssr_disable();
 
-    asm volatile("" :: "f"(ft2));
-
-    return 0;
+    return sum;
 }
 
-__attribute__((noinline))
-int cumsum_ssr_frep(const double* arr, const size_t n, volatile double* result) {
-    register volatile double ft0 asm("ft0");
-    register volatile double ft2 asm("ft2");
+/*
+ * Returns the sum of the count elements starting at arr + first.
+ * The SSR version only reads, so it keeps REDUCE_ACCUMULATORS adds in flight instead of the dependent chain of the scan.
+ */
+static inline double cumsum_block_sum(const double* arr, size_t first, size_t count, int ssr) {
+    double sum = 0.0;
 
-    // ft0 is input
-    asm volatile("" : "=f"(ft0));
+    if (!ssr) {
+        for (size_t i = first; i < first + count; i++) {
+            sum += arr[i];
+        }
+        return sum;
+    }
 
-    // stream arr into ft0
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*arr));
     snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
-
-    // stream from register ft2 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM2, n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
-    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + first);
 
     snrt_ssr_enable();
-
-    asm volatile(
-        "addi a1, zero, 0\n"
-        "fcvt.d.w ft1, a1\n"        // ft1 stores the cumulative sum. set it to 0.0
-        "frep.o %[n], 2, 0, 0 \n"
-            "fadd.d ft1, ft0, ft1\n" // ft1 <- fa0 + ft1
-            "fmv.d ft2, ft1\n"
-        :: [n] "r"(n-1)
-        : "ft0", "ft1", "ft2", "a0", "a1"
-    );
-
+    sum = reduce_sum_ssr_frep(count);
+    snrt_fpu_fence();
     snrt_ssr_disable();
-    
-    asm volatile("" :: "f"(ft2));
 
-    return 0;
+    return sum;
 }
 
-double* shared;
-int cumsum_parallel(const double* arr, const size_t n, double* result) {
+/*
+ * Reduce-then-scan over the compute cores: the input is read by the block sums and the scan,
+ * the output only written by the scan. For reverse core i takes block #cores - 1 - i,
+ * so the exclusive prefix of scan_cluster is the sum of the blocks after it.
+ * All sums start at carry, the sum of all blocks is written to *total on core 0 if total is not NULL.
+ */
+static inline void cumsum_parallel_scan(const double* arr, size_t n, double carry, int exclusive, int reverse,
+                                        int ssr, int frep, volatile double* result, double* total) {
     size_t core_num = snrt_cluster_core_num() - 1;
     size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
-    
-    // The DM core should not do anything
-    if (snrt_is_dm_core()) {
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        return 0;
-    }
-
-    volatile double my_sum = arr[core_idx * local_n];
-
-    if (core_idx == 0) {
-        shared = allocate(core_num, sizeof(double));
-    }
-    snrt_cluster_hw_barrier();
+    size_t first = 0;
+    size_t count = 0;
+    double sum = 0.0;
 
-    /* In this case do_extra works different; The core 0 does all the work */
-    int do_extra = 0;
-    if (0 != n - local_n * core_num && core_idx == 0) {
-        do_extra = 1;
+    if (!snrt_is_dm_core()) {
+        size_t block = reverse ? core_num - 1 - core_idx : core_idx;
+        count = local_range(n, block, core_num, &first);
+        sum = cumsum_block_sum(arr, first, count, ssr);
     }
 
-    // let each calc it's prefix sum
-    result[core_idx * local_n] = my_sum;
-    for (unsigned i = 1; i < local_n; i++) {
-        my_sum += arr[core_idx * local_n + i];
-        result[core_idx * local_n + i] = my_sum;
+    // The DM core only takes part in the barriers of the scan
+    double blocks_total = 0.0;
+    double offset = carry + scan_cluster(sum, &blocks_total);
+    if (snrt_is_dm_core()) {
+        return;
     }
-
-    shared[core_idx] = my_sum;
-    snrt_cluster_hw_barrier();
-
-    if (core_idx == 0) {
-        for (size_t i = 1; i < core_num; i++) {
-            // printf("intermediate sums at %d is %f\n", i, shared[i]);
-            shared[i] = shared[i-1] + shared[i];
-        }
+    if (total != NULL && core_idx == 0) {
+        *total = blocks_total;
     }
-    // if (core_idx == 0) {
-    //     for (size_t i = 0; i < core_num; i++) {
-    //         printf("calculated sums at %d is %f\n", i, shared[i]);
-    //     }
-    // }
-    snrt_cluster_hw_barrier();
 
-    /* Now every core adds the global stuff */
-    // printf("Core %d adds %f\n", core_idx, shared[core_idx-1]);
-    for (unsigned i = 0; i < local_n && core_idx > 0; i++) {
-        result[core_idx * local_n + i] = result[core_idx * local_n + i] + shared[core_idx-1];
-        // printf("Setting result to %f\n", result[core_idx * local_n + i]);
+    if (ssr) {
+        cumsum_block_ssr(arr, first, count, offset, exclusive, reverse, frep, result);
+    } else {
+        cumsum_block_baseline(arr, first, count, offset, exclusive, reverse, result);
     }
-    snrt_cluster_hw_barrier();
+}
 
-    if (do_extra) {
-        my_sum = shared[core_num - 1];
-        for (unsigned i = 0; i < n - local_n * core_num; i++) {
-            my_sum += arr[core_num * local_n + i];
+__attribute__((noinline))
+int cumsum_ssr(const double* arr, const size_t n, volatile double* result) {
+    cumsum_block_ssr(arr, 0, n, 0.0, 0, 0, 0, result);
+    return 0;
+}
 
-            result[core_num * local_n + i] = my_sum;
-        }
-    }
+__attribute__((noinline))
+int cumsum_ssr_frep(const double* arr, const size_t n, volatile double* result) {
+    cumsum_block_ssr(arr, 0, n, 0.0, 0, 0, 1, result);
+    return 0;
+}
 
+__attribute__((noinline))
+int cumsum_parallel(const double* arr, const size_t n, double* result) {
+    cumsum_parallel_scan(arr, n, 0.0, 0, 0, 0, 0, result, NULL);
     return 0;
 }
 
+__attribute__((noinline))
 int cumsum_ssr_parallel(const double* arr, const size_t n, volatile double* result) {
-    size_t core_num = snrt_cluster_core_num() - 1;
-    size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
-    
-    // The DM core should not do anything
-    if (snrt_is_dm_core()) {
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        return 0;
-    }
+    cumsum_parallel_scan(arr, n, 0.0, 0, 0, 1, 0, result, NULL);
+    return 0;
+}
 
-    snrt_cluster_hw_barrier();
-    if (core_idx == 0) {
-        shared = allocate(core_num, sizeof(double));
-    }
-    snrt_cluster_hw_barrier();
+__attribute__((noinline))
+int cumsum_ssr_frep_parallel(const double* arr, const size_t n, volatile double* result) {
+    cumsum_parallel_scan(arr, n, 0.0, 0, 0, 1, 1, result, NULL);
+    return 0;
+}
 
-    /* In this case do_extra works different; The core 0 does all the work */
-    int do_extra = 0;
-    if (0 != n - local_n * core_num && core_idx == 0) {
-        do_extra = 1;
-    }
+static int cumsum_tile_sum(const double* arr, const size_t n, double* result) {
+    *result = cumsum_block_sum(arr, 0, n, 1);
+    return 0;
+}
 
-    // stream arr into ft0
-    // disable ft1 stream
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, 0, 0);
+static int cumsum_tile_scan(const double* arr, const size_t n, double offset, volatile double* result) {
+    cumsum_block_ssr(arr, 0, n, offset, 0, 0, 1, result);
+    return 0;
+}
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, 4);
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + core_idx * local_n);
- 
-    // stream from register ft2 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM2, local_n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
-    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + core_idx * local_n);
+/*
+ * The reduce-then-scan of cumsum_ssr_frep_parallel on every tile, while the DM core fetches the next tile
+ * and writes back the previous scan.
+ */
+__attribute__((noinline))
+int cumsum_ssr_frep_tiled(const double* arr, const size_t n, double* result) {
+    return tile_scan(cumsum_tile_sum, cumsum_tile_scan, arr, n, result);
+}
 
-    snrt_ssr_enable();
+__attribute__((noinline))
+int cumsum_stream_baseline(cumsum_stream_t* state, const double* chunk, const size_t n, double* result) {
+    double sum = state->carry;
 
-    // // i need my own loop
-    volatile register double my_sum = 0.0;
-    asm volatile(
-        "addi a0, zero, 0\n"      // a0 counts
-        "addi a1, zero, 0\n"
-        "fcvt.d.w ft1, a1\n"     // ft1 stores the cumulative sum. Set it to 0.0
-        "1:\n"
-            "addi a0, a0, 1\n"
-            "fadd.d ft1, ft0, ft1\n" // ft1 <- ft0 (streamed arr[i]) + ft1
-            "fmv.d ft2, ft1\n"
-        "3:"
-        "blt a0, %[n], 1b\n"
-        "fmv.d %[target], ft1\n"
-        : [target] "=f"(my_sum)
-        : [n] "r"(local_n) 
-        : "ft0", "ft1", "ft2", "a0", "a1"
-    );
+    for (size_t i = 0; i < n; i++) {
+        sum += chunk[i];
+        result[i] = sum;
+    }
 
-    snrt_ssr_disable();
+    state->carry = sum;
+    state->count += n;
+    return 0;
+}
 
-    // printf("I'm core %d and have sum %f\n", core_idx, my_sum);
+__attribute__((noinline))
+int cumsum_stream_ssr_frep(cumsum_stream_t* state, const double* chunk, const size_t n, volatile double* result) {
+    state->carry = cumsum_block_ssr(chunk, 0, n, state->carry, 0, 0, 1, result);
+    state->count += n;
+    return 0;
+}
 
-    snrt_cluster_hw_barrier();
-    shared[core_idx] = my_sum;
-    snrt_cluster_hw_barrier();
+/*
+ * All cores read the carry before the scan_cluster barrier of the scan, core 0 adds the chunk after it.
+ */
+__attribute__((noinline))
+int cumsum_stream_ssr_frep_parallel(cumsum_stream_t* state, const double* chunk, const size_t n, volatile double* result) {
+    double total = 0.0;
 
-    if (core_idx == 0) {
-        // printf("intermediate sums at %d is %f\n", 0, shared[0]);
-        for (size_t i = 1; i < core_num; i++) {
-            // printf("intermediate sums at %d is %f\n", i, shared[i]);
-            shared[i] = shared[i-1] + shared[i];
-        }
-    }
-    // if (core_idx == 0) {
-    //     for (size_t i = 0; i < core_num; i++) {
-    //         printf("calculated sums at %d is %f\n", i, shared[i]);
-    //     }
-    // }
-
-    /* Now every core adds the global stuff */
-    // printf("Core %d adds %f\n", core_idx, shared[core_idx-1]);
-    for (unsigned i = 0; i < local_n && core_idx > 0; i++) {
-        result[core_idx * local_n + i] = result[core_idx * local_n + i] + shared[core_idx-1];
-        // printf("Setting result to %f\n", result[core_idx * local_n + i]);
+    cumsum_parallel_scan(chunk, n, state->carry, 0, 0, 1, 1, result, &total);
+    if (snrt_cluster_core_idx() == 0) {
+        state->carry += total;
+        state->count += n;
     }
     snrt_cluster_hw_barrier();
+    return 0;
+}
 
-    if (do_extra) {
-        my_sum = shared[core_num - 1];
-        for (unsigned i = 0; i < n - local_n * core_num; i++) {
-            my_sum += arr[core_num * local_n + i];
+__attribute__((noinline))
+int cumsum_onnx_baseline(const double* arr, const size_t n, int exclusive, int reverse, double* result) {
+    cumsum_block_baseline(arr, 0, n, 0.0, exclusive, reverse, result);
+    return 0;
+}
 
-            result[core_num * local_n + i] = my_sum;
-        }
-    }
+__attribute__((noinline))
+int cumsum_onnx_ssr_frep(const double* arr, const size_t n, int exclusive, int reverse, volatile double* result) {
+    cumsum_block_ssr(arr, 0, n, 0.0, exclusive, reverse, 1, result);
+    return 0;
+}
 
+__attribute__((noinline))
+int cumsum_onnx_ssr_frep_parallel(const double* arr, const size_t n, int exclusive, int reverse, volatile double* result) {
+    cumsum_parallel_scan(arr, n, 0.0, exclusive, reverse, 1, 1, result, NULL);
     return 0;
 }
 
-int cumsum_ssr_frep_parallel(const double* arr, const size_t n, volatile double* result) {
-    size_t core_num = snrt_cluster_core_num() - 1;
-    size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
-    
-    // The DM core should not do anything
-    if (snrt_is_dm_core()) {
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        snrt_cluster_hw_barrier();
-        return 0;
+/*
+ * Splits the tensor into (outer, n, inner) around axis, n being the length of the scanned axis.
+ */
+static int cumsum_axis_layout(const size_t* shape, size_t ndim, int axis, size_t* outer, size_t* n, size_t* inner) {
+    if (axis < 0) {
+        axis += ndim;
+    }
+    if (axis < 0 || axis >= (int)ndim) {
+        return -1;
     }
 
-    snrt_cluster_hw_barrier();
-    if (core_idx == 0) {
-        shared = allocate(core_num, sizeof(double));
+    *outer = 1;
+    *inner = 1;
+    for (size_t d = 0; d < ndim; d++) {
+        if ((int)d < axis) {
+            *outer *= shape[d];
+        } else if ((int)d > axis) {
+            *inner *= shape[d];
+        }
     }
-    snrt_cluster_hw_barrier();
+    *n = shape[axis];
+    return 0;
+}
 
-    /* In this case do_extra works different; The core 0 does all the work */
-    int do_extra = 0;
-    if (0 != n - local_n * core_num && core_idx == 0) {
-        do_extra = 1;
+__attribute__((noinline))
+int cumsum_axis_baseline(const double* arr, const size_t* shape, size_t ndim, int axis, int exclusive, int reverse, double* result) {
+    size_t outer, n, inner;
+    if (cumsum_axis_layout(shape, ndim, axis, &outer, &n, &inner)) {
+        return -1;
     }
 
-    // stream arr into ft0
-    // disable ft1 stream
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, 0, 0);
+    for (size_t l = 0; l < outer * inner; l++) {
+        size_t base = (l / inner) * n * inner + l % inner;
+        double sum = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            size_t i = base + (reverse ? n - 1 - j : j) * inner;
+            if (exclusive) {
+                result[i] = sum;
+                sum += arr[i];
+            } else {
+                sum += arr[i];
+                result[i] = sum;
+            }
+        }
+    }
+    return 0;
+}
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, 4);
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + core_idx * local_n);
- 
-    // stream from register ft2 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM2, local_n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
-    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + core_idx * local_n);
+/*
+ * Scans the groups [g_first, g_first + g_count) of CUMSUM_LANES neighbouring lanes, group g being the
+ * lanes g % chunks * CUMSUM_LANES + [0, CUMSUM_LANES) of the outer index g / chunks.
+ * A 3D pattern (lanes, n, groups) streams the groups of one outer index, the running sums of the
+ * lanes are kept in ft3-ft6 and every add has at least three independent instructions until its next use.
+ * Exclusive scans pop every element (into ft7) before they push its result, so they may run in place.
+ */
+static void cumsum_axis_groups(const double* arr, size_t n, size_t inner, size_t g_first, size_t g_count,
+                               int exclusive, int reverse, volatile double* result) {
+    size_t chunks = inner / CUMSUM_LANES;
+    size_t step = reverse ? -(inner * sizeof(*arr)) : inner * sizeof(*arr);
+    size_t back = reverse ? (n - 1) * inner : 0;
+
+    for (size_t g = g_first; g < g_first + g_count;) {
+        size_t c = g % chunks;
+        size_t run = chunks - c;
+        if (run > g_first + g_count - g) {
+            run = g_first + g_count - g;
+        }
+        size_t offset = (g / chunks) * n * inner + c * CUMSUM_LANES + back;
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM0, CUMSUM_LANES, n, run, sizeof(*arr), step, CUMSUM_LANES * sizeof(*arr));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, arr + offset);
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM2, CUMSUM_LANES, n, run, sizeof(*result), step, CUMSUM_LANES * sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_3D, result + offset);
+
+        snrt_ssr_enable();
+
+        for (size_t r = 0; r < run; r++) {
+            if (exclusive) {
+                asm volatile(
+                    "fcvt.d.w ft3, zero \n"
+                    "fcvt.d.w ft4, zero \n"
+                    "fcvt.d.w ft5, zero \n"
+                    "fcvt.d.w ft6, zero \n"
+                    "frep.o %[n_frep], 12, 0, 0 \n"
+                        "fmv.d ft7, ft0 \n"
+                        "fmv.d ft2, ft3 \n"
+                        "fadd.d ft3, ft7, ft3 \n"
+                        "fmv.d ft7, ft0 \n"
+                        "fmv.d ft2, ft4 \n"
+                        "fadd.d ft4, ft7, ft4 \n"
+                        "fmv.d ft7, ft0 \n"
+                        "fmv.d ft2, ft5 \n"
+                        "fadd.d ft5, ft7, ft5 \n"
+                        "fmv.d ft7, ft0 \n"
+                        "fmv.d ft2, ft6 \n"
+                        "fadd.d ft6, ft7, ft6 \n"
+                    :
+                    : [n_frep] "r"(n - 1)
+                    : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7"
+                );
+            } else {
+                asm volatile(
+                    "fcvt.d.w ft3, zero \n"
+                    "fcvt.d.w ft4, zero \n"
+                    "fcvt.d.w ft5, zero \n"
+                    "fcvt.d.w ft6, zero \n"
+                    "frep.o %[n_frep], 8, 0, 0 \n"
+                        "fadd.d ft3, ft0, ft3 \n"
+                        "fmv.d ft2, ft3 \n"
+                        "fadd.d ft4, ft0, ft4 \n"
+                        "fmv.d ft2, ft4 \n"
+                        "fadd.d ft5, ft0, ft5 \n"
+                        "fmv.d ft2, ft5 \n"
+                        "fadd.d ft6, ft0, ft6 \n"
+                        "fmv.d ft2, ft6 \n"
+                    :
+                    : [n_frep] "r"(n - 1)
+                    : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+                );
+            }
+        }
 
-    snrt_ssr_enable();
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+        g += run;
+    }
+}
 
-    // // i need my own loop
-    volatile register double my_sum = 0.0;
-    asm volatile(
-        "addi a1, zero, 0\n"
-        "fcvt.d.w ft1, a1\n"     // ft1 stores the cumulative sum. Set it to 0.0
-        "frep.o %[n], 2, 0, 0 \n"
-            "fadd.d ft1, ft0, ft1\n" // ft1 <- ft0 (streamed arr[i]) + ft1
-            "fmv.d ft2, ft1\n"
-        "fmv.d %[target], ft1\n"
-        : [target] "=f"(my_sum)
-        : [n] "r"(local_n - 1) 
-        : "ft0", "ft1", "ft2", "a1"
-    );
+/*
+ * Scans the single lanes [l_first, l_first + l_count) which are left over by the groups, lane l being the
+ * lane chunks * CUMSUM_LANES + l % tail of the outer index l / tail. A 2D pattern (n, lanes) streams the
+ * lanes of one outer index, for the innermost axis (inner = 1) the lanes are rows and all of them are one pattern.
+ */
+static void cumsum_axis_lanes(const double* arr, size_t n, size_t inner, size_t l_first, size_t l_count,
+                              int exclusive, int reverse, volatile double* result) {
+    size_t chunks = inner / CUMSUM_LANES;
+    size_t tail = inner - chunks * CUMSUM_LANES;
+    size_t step = reverse ? -(inner * sizeof(*arr)) : inner * sizeof(*arr);
+    size_t back = reverse ? (n - 1) * inner : 0;
+
+    for (size_t l = l_first; l < l_first + l_count;) {
+        size_t run = inner == 1 ? l_count : tail - l % tail;
+        if (run > l_first + l_count - l) {
+            run = l_first + l_count - l;
+        }
+        size_t lane_stride = inner == 1 ? n * sizeof(*arr) : sizeof(*arr);
+        size_t offset = (l / tail) * n * inner + chunks * CUMSUM_LANES + l % tail + back;
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM0, n, run, step, lane_stride);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, arr + offset);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM2, n, run, step, lane_stride);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, result + offset);
+
+        snrt_ssr_enable();
+
+        for (size_t r = 0; r < run; r++) {
+            if (exclusive) {
+                asm volatile(
+                    "fcvt.d.w ft3, zero \n"
+                    "frep.o %[n_frep], 3, 0, 0 \n"
+                        "fmv.d ft4, ft0 \n"
+                        "fmv.d ft2, ft3 \n"
+                        "fadd.d ft3, ft4, ft3 \n"
+                    :
+                    : [n_frep] "r"(n - 1)
+                    : "ft0", "ft1", "ft2", "ft3", "ft4"
+                );
+            } else {
+                asm volatile(
+                    "fcvt.d.w ft3, zero \n"
+                    "frep.o %[n_frep], 2, 0, 0 \n"
+                        "fadd.d ft3, ft0, ft3 \n"
+                        "fmv.d ft2, ft3 \n"
+                    :
+                    : [n_frep] "r"(n - 1)
+                    : "ft0", "ft1", "ft2", "ft3"
+                );
+            }
+        }
 
-    snrt_ssr_disable();
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+        l += run;
+    }
+}
+
+__attribute__((noinline))
+int cumsum_axis_ssr_frep(const double* arr, const size_t* shape, size_t ndim, int axis, int exclusive, int reverse, volatile double* result) {
+    size_t outer, n, inner;
+    if (cumsum_axis_layout(shape, ndim, axis, &outer, &n, &inner)) {
+        return -1;
+    }
+    if (n == 0) {
+        return 0;
+    }
 
-    // printf("I'm core %d and have sum %f\n", core_idx, my_sum);
+    size_t chunks = inner / CUMSUM_LANES;
+    size_t tail = inner - chunks * CUMSUM_LANES;
+    cumsum_axis_groups(arr, n, inner, 0, outer * chunks, exclusive, reverse, result);
+    cumsum_axis_lanes(arr, n, inner, 0, outer * tail, exclusive, reverse, result);
+    return 0;
+}
 
-    snrt_cluster_hw_barrier();
-    shared[core_idx] = my_sum;
-    snrt_cluster_hw_barrier();
+/*
+ * The groups and the left over lanes are split over the compute cores separately, so both are balanced.
+ */
+__attribute__((noinline))
+int cumsum_axis_ssr_frep_parallel(const double* arr, const size_t* shape, size_t ndim, int axis, int exclusive, int reverse, volatile double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
 
-    if (core_idx == 0) {
-        // printf("intermediate sums at %d is %f\n", 0, shared[0]);
-        for (size_t i = 1; i < core_num; i++) {
-            // printf("intermediate sums at %d is %f\n", i, shared[i]);
-            shared[i] = shared[i-1] + shared[i];
-        }
+    size_t outer, n, inner;
+    if (cumsum_axis_layout(shape, ndim, axis, &outer, &n, &inner)) {
+        return -1;
     }
-    // if (core_idx == 0) {
-    //     for (size_t i = 0; i < core_num; i++) {
-    //         printf("calculated sums at %d is %f\n", i, shared[i]);
-    //     }
-    // }
-
-    /* Now every core adds the global stuff */
-    // printf("Core %d adds %f\n", core_idx, shared[core_idx-1]);
-    for (unsigned i = 0; i < local_n && core_idx > 0; i++) {
-        result[core_idx * local_n + i] = result[core_idx * local_n + i] + shared[core_idx-1];
-        // printf("Setting result to %f\n", result[core_idx * local_n + i]);
-    }
-    snrt_cluster_hw_barrier();
 
-    if (do_extra) {
-        my_sum = shared[core_num - 1];
-        for (unsigned i = 0; i < n - local_n * core_num; i++) {
-            my_sum += arr[core_num * local_n + i];
+    // A single lane is a 1D scan, which is split along the axis instead
+    if (outer * inner == 1) {
+        cumsum_parallel_scan(arr, n, 0.0, exclusive, reverse, 1, 1, result, NULL);
+        return 0;
+    }
 
-            result[core_num * local_n + i] = my_sum;
-        }
+    if (snrt_is_dm_core() || n == 0) {
+        return 0;
     }
 
+    size_t chunks = inner / CUMSUM_LANES;
+    size_t tail = inner - chunks * CUMSUM_LANES;
+    size_t first;
+    size_t count = local_range(outer * chunks, core_idx, core_num, &first);
+    cumsum_axis_groups(arr, n, inner, first, count, exclusive, reverse, result);
+
+    count = local_range(outer * tail, core_idx, core_num, &first);
+    cumsum_axis_lanes(arr, n, inner, first, count, exclusive, reverse, result);
     return 0;
 }
+
+#endif // LMQ_HOST
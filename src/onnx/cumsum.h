@@ -1,4 +1,3 @@
-
 #ifndef LMQ_CUMSUM_H
 #define LMQ_CUMSUM_H
 
@@ -11,8 +10,65 @@ int cumsum_baseline(const double* arr, const size_t n, double* result);
 int cumsum_ssr(const double* arr, const size_t n, volatile double* result);
 int cumsum_ssr_frep(const double* arr, const size_t n, volatile double* result);
 
+/*
+ * The parallel versions give every compute core a contiguous block (the sizes differ by at most one element).
+ * Each core sums its block, the block sums are scanned with scan_cluster and each core scans its block
+ * again starting at the sum of the blocks before it. The output is written once, there is no fix-up pass.
+ * Must be called by all cores of the cluster.
+ */
 int cumsum_parallel(const double* arr, const size_t n, double* result);
 int cumsum_ssr_parallel(const double* arr, const size_t n, volatile double* result);
 int cumsum_ssr_frep_parallel(const double* arr, const size_t n, volatile double* result);
 
+/*
+ * cumsum_ssr_frep_parallel with arr and result streamed through L1 in double buffered tiles (src/lmq/tile.h),
+ * the block sums are scanned by scan_team. Must be called by all cores of the cluster.
+ */
+int cumsum_ssr_frep_tiled(const double* arr, const size_t n, double* result);
+
+/*
+ * Streaming cumulative sum over a tensor handed in chunk by chunk (f.ex. as it arrives from the host, the chunks
+ * may have any sizes), so the whole tensor never has to be in memory. result gets the n cumulative sums of the
+ * chunk, which continue the sums of the chunks before it: state carries their sum and the number of elements so
+ * far, cumsum_stream_init starts a new tensor. The scans start at the carry, there is no fix-up pass.
+ * The parallel version must be called by all cores of the cluster with the same state, core 0 updates it
+ * before the call returns on any core.
+ */
+typedef struct {
+    double carry;
+    size_t count;
+} cumsum_stream_t;
+
+static inline void cumsum_stream_init(cumsum_stream_t* state) {
+    state->carry = 0.0;
+    state->count = 0;
+}
+
+int cumsum_stream_baseline(cumsum_stream_t* state, const double* chunk, const size_t n, double* result);
+int cumsum_stream_ssr_frep(cumsum_stream_t* state, const double* chunk, const size_t n, volatile double* result);
+int cumsum_stream_ssr_frep_parallel(cumsum_stream_t* state, const double* chunk, const size_t n, volatile double* result);
+
+/*
+ * ONNX CumSum of a 1D tensor. If exclusive is set, result[i] does not include arr[i] (result[0] = 0);
+ * if reverse is set, the sums run from the end, i.e. result[i] is the sum of arr[i..n-1].
+ * The reversed stream uses a negative SSR stride, there is no separate reverse pass.
+ */
+int cumsum_onnx_baseline(const double* arr, const size_t n, int exclusive, int reverse, double* result);
+int cumsum_onnx_ssr_frep(const double* arr, const size_t n, int exclusive, int reverse, volatile double* result);
+int cumsum_onnx_ssr_frep_parallel(const double* arr, const size_t n, int exclusive, int reverse, volatile double* result);
+
+/*
+ * ONNX CumSum along axis (negative counts from the back) of the row major tensor arr of shape
+ * (shape[0], ..., shape[ndim - 1]), with exclusive and reverse as above. Returns -1 if the axis is out of range.
+ * Every lane (a fixed index of all other axes) is scanned independently. For the innermost axis a lane is a
+ * contiguous row, otherwise CUMSUM_LANES neighbouring lanes keep their running sums in registers
+ * and the SSR walks down the axis, so every row of the scanned axis is read contiguously and nothing is transposed.
+ * The parallel version splits the lanes over the compute cores (a single lane uses cumsum_onnx_ssr_frep_parallel)
+ * and must be called by all cores of the cluster.
+ */
+#define CUMSUM_LANES 4
+int cumsum_axis_baseline(const double* arr, const size_t* shape, size_t ndim, int axis, int exclusive, int reverse, double* result);
+int cumsum_axis_ssr_frep(const double* arr, const size_t* shape, size_t ndim, int axis, int exclusive, int reverse, volatile double* result);
+int cumsum_axis_ssr_frep_parallel(const double* arr, const size_t* shape, size_t ndim, int axis, int exclusive, int reverse, volatile double* result);
+
 #endif
@@ -0,0 +1,272 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "conv.h"
+#include "depthwise.h"
+
+__attribute__((noinline))
+int conv_depthwise_baseline(double *x, double* w, double* bias, size_t batch, size_t c, size_t n0, size_t n1,
+                            size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    return conv_nchw_baseline(x, w, bias, batch, c, n0, n1, c, c, f0, f1, s0, s1, d0, d1, result);
+}
+
+/*
+ * Output rows [first, first + rows) of the channels [0, channels) of one image, one stream configuration
+ * per row: DM0 runs over (f0, f1, outn0, channel) of x, DM1 over the filter of every channel (repeated for
+ * the outputs of a row) and DM2 writes the row of every channel, the rows of a channel are out_stride apart.
+ */
+static void depthwise_rows(double *x, double* w, double* bias, size_t channels, size_t n0, size_t n1,
+                           size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                           size_t outn0, size_t first, size_t rows, double* out, size_t out_stride) {
+    for (size_t i = first; i < first + rows; ++i) {
+        snrt_ssr_loop_4d(SNRT_SSR_DM0, f0, f1, outn0, channels,
+            sizeof(*x) * d0, sizeof(*x) * n0 * d1, sizeof(*x) * s0, sizeof(*x) * n0 * n1);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, x + i * s1 * n0);
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM1, f0 * f1, outn0, channels, sizeof(*w), 0, sizeof(*w) * f0 * f1);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, w);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM2, outn0, channels, sizeof(*out), sizeof(*out) * out_stride);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, out + (i - first) * outn0);
+
+        snrt_ssr_enable();
+
+        for (size_t ch = 0; ch < channels; ++ch) {
+            double b = bias ? bias[ch] : 0.0;
+            for (size_t j = 0; j < outn0; ++j) {
+                asm volatile(
+                    "fmv.d ft3, %[b] \n"
+                    "frep.o %[n_frep], 1, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    "fmv.d ft2, ft3 \n"
+                    :
+                    : [n_frep] "r"(f0 * f1 - 1), [b] "f"(b)
+                    : "ft0", "ft1", "ft2", "ft3"
+                );
+            }
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+/*
+ * All output rows of the channels [0, channels) of one image, one stream configuration per channel over
+ * (f0, f1, outn0, outn1) like conv2d_ssr_frep.
+ */
+static void depthwise_channels(double *x, double* w, double* bias, size_t channels, size_t n0, size_t n1,
+                               size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                               size_t outn0, size_t outn1, double* out) {
+    for (size_t ch = 0; ch < channels; ++ch) {
+        double b = bias ? bias[ch] : 0.0;
+
+        snrt_ssr_loop_4d(SNRT_SSR_DM0, f0, f1, outn0, outn1,
+            sizeof(*x) * d0, sizeof(*x) * n0 * d1, sizeof(*x) * s0, sizeof(*x) * s1 * n0);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, x + ch * n0 * n1);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM1, f0 * f1, outn0 * outn1, sizeof(*w), 0);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, w + ch * f0 * f1);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM2, outn0 * outn1, sizeof(*out));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, out + ch * outn0 * outn1);
+
+        snrt_ssr_enable();
+
+        for (size_t i = 0; i < outn0 * outn1; ++i) {
+            asm volatile(
+                "fmv.d ft3, %[b] \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "fmadd.d ft3, ft0, ft1, ft3 \n"
+                "fmv.d ft2, ft3 \n"
+                :
+                : [n_frep] "r"(f0 * f1 - 1), [b] "f"(b)
+                : "ft0", "ft1", "ft2", "ft3"
+            );
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+/*
+ * The channels [first, first + channels) of every image, with the cheaper of the two stream layouts.
+ */
+static void depthwise_images(double *x, double* w, double* bias, size_t batch, size_t c, size_t n0, size_t n1,
+                             size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                             size_t first, size_t channels, double* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    if (channels == 0) {
+        return;
+    }
+
+    for (size_t b = 0; b < batch; ++b) {
+        double* in = x + (b * c + first) * n0 * n1;
+        double* out = result + (b * c + first) * outn0 * outn1;
+        double* cb = bias ? bias + first : NULL;
+
+        if (channels >= outn1) {
+            depthwise_rows(in, w + first * f0 * f1, cb, channels, n0, n1, f0, f1, s0, s1, d0, d1,
+                           outn0, 0, outn1, out, outn0 * outn1);
+        } else {
+            depthwise_channels(in, w + first * f0 * f1, cb, channels, n0, n1, f0, f1, s0, s1, d0, d1,
+                               outn0, outn1, out);
+        }
+    }
+}
+
+__attribute__((noinline))
+int conv_depthwise_ssr_frep(double *x, double* w, double* bias, size_t batch, size_t c, size_t n0, size_t n1,
+                            size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    depthwise_images(x, w, bias, batch, c, n0, n1, f0, f1, s0, s1, d0, d1, 0, c, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int conv_depthwise_ssr_frep_parallel(double *x, double* w, double* bias, size_t batch, size_t c, size_t n0, size_t n1,
+                                     size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t channels = local_range(c, core_idx, core_num, &first);
+    depthwise_images(x, w, bias, batch, c, n0, n1, f0, f1, s0, s1, d0, d1, first, channels, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int conv_depthwise_pointwise_baseline(double *x, double* dw, double* dw_bias, const conv_activation_t* act, double* pw, double* pw_bias,
+                                      size_t batch, size_t c, size_t n0, size_t n1, size_t c_out,
+                                      size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+
+    for (size_t b = 0; b < batch; ++b) {
+        for (size_t i = 0; i < outn1; ++i) {
+            for (size_t j = 0; j < outn0; ++j) {
+                for (size_t co = 0; co < c_out; ++co) {
+                    result[((b * c_out + co) * outn1 + i) * outn0 + j] = pw_bias ? pw_bias[co] : 0.0;
+                }
+                for (size_t ch = 0; ch < c; ++ch) {
+                    double* plane = x + (b * c + ch) * n0 * n1;
+                    double acc = dw_bias ? dw_bias[ch] : 0.0;
+                    for (size_t k = 0; k < f1; ++k) {
+                        for (size_t l = 0; l < f0; ++l) {
+                            acc += plane[n0 * (s1 * i + k * d1) + s0 * j + l * d0] * dw[(ch * f1 + k) * f0 + l];
+                        }
+                    }
+                    acc = conv_activation(acc, act);
+                    for (size_t co = 0; co < c_out; ++co) {
+                        result[((b * c_out + co) * outn1 + i) * outn0 + j] += pw[co * c + ch] * acc;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * The output rows u = b * outn1 + i in [first, first + rows) of conv_depthwise_pointwise. The depthwise row of
+ * all c channels goes to row (c, outn0), the pointwise conv reads pw (c_out, c) row by row (repeated for the
+ * outputs) and the columns of row.
+ */
+static void depthwise_pointwise_rows(double *x, double* dw, double* dw_bias, const conv_activation_t* act, double* pw, double* pw_bias,
+                                     size_t c, size_t n0, size_t n1, size_t c_out,
+                                     size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                                     size_t first, size_t rows, double* row, double* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+
+    for (size_t u = first; u < first + rows; ++u) {
+        size_t b = u / outn1;
+        size_t i = u % outn1;
+
+        depthwise_rows(x + b * c * n0 * n1, dw, dw_bias, c, n0, n1, f0, f1, s0, s1, d0, d1, outn0, i, 1, row, outn0);
+        for (size_t e = 0; act && e < c * outn0; ++e) {
+            row[e] = conv_activation(row[e], act);
+        }
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM0, c, outn0, c_out, sizeof(*pw), 0, sizeof(*pw) * c);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, pw);
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM1, c, outn0, c_out, sizeof(*row) * outn0, sizeof(*row), 0);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, row);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM2, outn0, c_out, sizeof(*result), sizeof(*result) * outn0 * outn1);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, result + (b * c_out * outn1 + i) * outn0);
+
+        snrt_ssr_enable();
+
+        for (size_t co = 0; co < c_out; ++co) {
+            double pb = pw_bias ? pw_bias[co] : 0.0;
+            for (size_t j = 0; j < outn0; ++j) {
+                asm volatile(
+                    "fmv.d ft3, %[b] \n"
+                    "frep.o %[n_frep], 1, 0, 0 \n"
+                    "fmadd.d ft3, ft0, ft1, ft3 \n"
+                    "fmv.d ft2, ft3 \n"
+                    :
+                    : [n_frep] "r"(c - 1), [b] "f"(pb)
+                    : "ft0", "ft1", "ft2", "ft3"
+                );
+            }
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int conv_depthwise_pointwise_ssr_frep(double *x, double* dw, double* dw_bias, const conv_activation_t* act, double* pw, double* pw_bias,
+                                      size_t batch, size_t c, size_t n0, size_t n1, size_t c_out,
+                                      size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* scratch, double* result) {
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+
+    if (c == 0) {
+        return -1;
+    }
+
+    depthwise_pointwise_rows(x, dw, dw_bias, act, pw, pw_bias, c, n0, n1, c_out, f0, f1, s0, s1, d0, d1,
+                             0, batch * outn1, scratch, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int conv_depthwise_pointwise_ssr_frep_parallel(double *x, double* dw, double* dw_bias, const conv_activation_t* act, double* pw, double* pw_bias,
+                                               size_t batch, size_t c, size_t n0, size_t n1, size_t c_out,
+                                               size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* scratch, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+
+    if (c == 0) {
+        return -1;
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t rows = local_range(batch * outn1, core_idx, core_num, &first);
+    depthwise_pointwise_rows(x, dw, dw_bias, act, pw, pw_bias, c, n0, n1, c_out, f0, f1, s0, s1, d0, d1,
+                             first, rows, scratch + core_idx * DEPTHWISE_SCRATCH(c, outn0, 1), result);
+    return 0;
+}
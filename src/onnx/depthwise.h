@@ -0,0 +1,49 @@
+#ifndef LMQ_DEPTHWISE_H
+#define LMQ_DEPTHWISE_H
+
+#include <snrt.h>
+
+#include "conv.h"
+
+/*
+ * Depthwise ONNX Conv (groups == c_in == c_out) on NCHW tensors: x is (batch, c, n1, n0), w is (c, f1, f0),
+ * bias is (c) or NULL and result is (batch, c, outn1, outn0).
+ * The ssr_frep version keeps the channels in the outermost SSR dimension: the 4D streams run over
+ * (f0, f1, outn0, channel) and are configured once per output row for all channels, or, if there are fewer
+ * channels than output rows, over (f0, f1, outn0, outn1) once per channel. Either way there are
+ * min(c, outn1) configurations per image instead of one per channel and row.
+ * The parallel version splits the channels over the compute cores.
+ */
+int conv_depthwise_baseline(double *x, double* w, double* bias, size_t batch, size_t c, size_t n0, size_t n1,
+                            size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv_depthwise_ssr_frep(double *x, double* w, double* bias, size_t batch, size_t c, size_t n0, size_t n1,
+                            size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv_depthwise_ssr_frep_parallel(double *x, double* w, double* bias, size_t batch, size_t c, size_t n0, size_t n1,
+                                     size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+
+/*
+ * Number of doubles of the scratch of conv_depthwise_pointwise_* with c channels, outn0 outputs per row
+ * and #cores cores (1 for the single core versions). It should be in TCDM.
+ */
+#define DEPTHWISE_SCRATCH(c, outn0, cores) ((c) * (outn0) * (cores))
+
+/*
+ * A depthwise conv followed by a pointwise (1x1) conv, as in a MobileNet block: the depthwise conv as above
+ * with dw_bias (may be NULL) and the activation act (may be NULL), then result (batch, c_out, outn1, outn0) is
+ * pw (c_out, c) times the depthwise output plus pw_bias (may be NULL).
+ * The depthwise output is never stored: one output row of all channels is computed into the scratch, and the
+ * pointwise conv of that row is a single stream configuration which multiplies it with pw.
+ * The parallel version splits the output rows of all images over the compute cores, every core has its own
+ * part of the scratch.
+ */
+int conv_depthwise_pointwise_baseline(double *x, double* dw, double* dw_bias, const conv_activation_t* act, double* pw, double* pw_bias,
+                                      size_t batch, size_t c, size_t n0, size_t n1, size_t c_out,
+                                      size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv_depthwise_pointwise_ssr_frep(double *x, double* dw, double* dw_bias, const conv_activation_t* act, double* pw, double* pw_bias,
+                                      size_t batch, size_t c, size_t n0, size_t n1, size_t c_out,
+                                      size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* scratch, double* result);
+int conv_depthwise_pointwise_ssr_frep_parallel(double *x, double* dw, double* dw_bias, const conv_activation_t* act, double* pw, double* pw_bias,
+                                               size_t batch, size_t c, size_t n0, size_t n1, size_t c_out,
+                                               size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* scratch, double* result);
+
+#endif
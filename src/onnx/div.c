@@ -1,78 +1,118 @@
 #include "printf.h"
 #include <snrt.h>
+#include "omp.h"
 
 #include "lmq.h"
+#include "div.h"
+#include "kernel.h"
+#include "fpmath.h"
 
 /*
- * Naive implementation of div. Divides a and b element wise into result.
+ * Divides a and b element wise into result.
  */
-__attribute__((noinline))
-int div_baseline(double *a, double* b, const size_t n, double* result) {
-    for (size_t i = 0; i < n; i++) {
-        result[i] = a[i] / b[i];
-    }
-    return 0;
-}
+KERNEL_BINARY(div, x / y, 1,
+    "fdiv.d ft2, ft0, ft1 \n")
 
+/*
+ * div_ssr_frep_newton issues one fdiv.d per DIV_GROUP elements: r = 1 / (b1 b2) gives 1 / b1 = r b2 and
+ * 1 / b2 = r b1. The quotient q = a / b is then corrected with one Newton step on the residual,
+ * q' = q + (1 / b) (a - b q), where a - b q is exact in an fnmsub.d.
+ */
+#define DIV_GROUP 2
 
-__attribute__((noinline))
-int div_ssr(double *a, double* b, const size_t n, double* result) {
-
-    register volatile double ft0 asm("ft0");
-    register volatile double ft1 asm("ft1");
-    register volatile double ft2 asm("ft2");
-    asm volatile("" : "=f"(ft0), "=f"(ft1));
+/*
+ * Divides the block of count (even, <= FPMATH_BLOCK) elements in two FREP passes over the carry scratch.
+ */
+static inline void div_newton_block(double* a, double* b, size_t count, double* result, double* carry) {
+    size_t groups = count / DIV_GROUP;
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*b));
     snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
-
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*b));
-    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, b);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, b);
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM2, n, sizeof(*result));
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, 3 * groups, sizeof(*carry));
     snrt_ssr_repeat(SNRT_SSR_DM2, 1);
-    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, carry);
 
     snrt_ssr_enable();
 
-    for (size_t i = 0; i < n; i++) {
-        asm volatile(
-            "fdiv.d ft2, ft0, ft1 \n"
-            ::: "ft0", "ft1", "ft2"
-        );
-    }
+    // (1 / (b1 b2), b1, b2) per group, the fdiv.d of a group runs while the next group is read
+    asm volatile(
+        "frep.o %[n_frep], 6, 0, 0 \n"
+        "fmv.d ft3, ft0 \n"
+        "fmv.d ft4, ft0 \n"
+        "fmul.d ft5, ft3, ft4 \n"
+        "fdiv.d ft2, %[one], ft5 \n"
+        "fmv.d ft2, ft3 \n"
+        "fmv.d ft2, ft4 \n"
+        :: [n_frep] "r"(groups - 1), [one] "f"(1.0)
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5"
+    );
 
+    snrt_fpu_fence();
     snrt_ssr_disable();
-    asm volatile("" :: "f"(ft2));
-
-    return 0;
-}
 
-__attribute__((noinline))
-int div_ssr_frep(double *a, double* b, const size_t n, double* result) {
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*a));
     snrt_ssr_repeat(SNRT_SSR_DM0, 1);
     snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a);
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*b));
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, 3 * groups, sizeof(*carry));
     snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, b);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, carry);
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM2, n, sizeof(*result));
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, count, sizeof(*result));
     snrt_ssr_repeat(SNRT_SSR_DM2, 1);
     snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
 
     snrt_ssr_enable();
 
+    // r1 = r b2, r2 = r b1, q = a * ri and q' = q + ri * (a - b q) for both elements of a group
     asm volatile(
-        "frep.o %[n_frep], 1, 0, 0 \n"
-        "fdiv.d ft2, ft0, ft1 \n"
-        :: [n_frep] "r"(n - 1) : "ft0", "ft1", "ft2"
+        "frep.o %[n_frep], 13, 0, 0 \n"
+        "fmv.d ft3, ft1 \n"
+        "fmv.d ft4, ft1 \n"
+        "fmv.d ft5, ft1 \n"
+        "fmul.d ft6, ft3, ft5 \n"
+        "fmul.d ft3, ft3, ft4 \n"
+        "fmv.d ft7, ft0 \n"
+        "fmul.d ft8, ft7, ft6 \n"
+        "fnmsub.d ft7, ft4, ft8, ft7 \n"
+        "fmadd.d ft2, ft6, ft7, ft8 \n"
+        "fmv.d ft4, ft0 \n"
+        "fmul.d ft6, ft4, ft3 \n"
+        "fnmsub.d ft4, ft5, ft6, ft4 \n"
+        "fmadd.d ft2, ft3, ft4, ft6 \n"
+        :: [n_frep] "r"(groups - 1)
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7", "ft8"
     );
 
+    snrt_fpu_fence();
     snrt_ssr_disable();
+}
 
+static inline void div_newton_range(double* a, double* b, const size_t n, double* result) {
+    double* carry = fpmath_carry();
+    size_t paired = n - n % DIV_GROUP;
+
+    for (size_t i = 0; i < paired; i += FPMATH_BLOCK) {
+        size_t count = paired - i < FPMATH_BLOCK ? paired - i : FPMATH_BLOCK;
+        div_newton_block(a + i, b + i, count, result + i, carry);
+    }
+
+    // The element without a partner
+    if (paired < n) {
+        result[n - 1] = a[n - 1] / b[n - 1];
+    }
+}
+
+__attribute__((noinline))
+int div_ssr_frep_newton(double *a, double* b, const size_t n, double* result) {
+    div_newton_range(a, b, n, result);
     return 0;
 }
+
+KERNEL_PARALLEL(div_ssr_frep_newton_parallel, (double* a, double* b, const size_t n, double* result), n,
+                div_newton_range(a + first, b + first, count, result + first))
+
+KERNEL_OMP(div_ssr_frep_newton_omp, (double* a, double* b, const size_t n, double* result), n,
+           div_newton_range(a + first, b + first, count, result + first))
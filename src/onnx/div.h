@@ -1,11 +1,28 @@
-
 #ifndef LMQ_DIV_H
 #define LMQ_DIV_H
 
 #include <snrt.h>
 
-double div_baseline(double *x, double *y, const size_t n, double *result);
-double div_ssr(double *x, double *y, const size_t n, double *result);
-double div_ssr_frep(double *x, double *y, const size_t n, double *result);
+/*
+ * Generated by KERNEL_BINARY (src/lmq/kernel.h).
+ */
+int div_baseline(double *x, double *y, const size_t n, double *result);
+int div_ssr(double *x, double *y, const size_t n, double *result);
+int div_ssr_frep(double *x, double *y, const size_t n, double *result);
+int div_parallel(double *x, double *y, const size_t n, double *result);
+int div_ssr_parallel(double *x, double *y, const size_t n, double *result);
+int div_ssr_frep_parallel(double *x, double *y, const size_t n, double *result);
+int div_omp(double *x, double *y, const size_t n, double *result);
+int div_ssr_omp(double *x, double *y, const size_t n, double *result);
+int div_ssr_frep_omp(double *x, double *y, const size_t n, double *result);
+
+/*
+ * One fdiv.d for every two elements and a Newton step on the quotient (max error about 1/2 ulp).
+ * x and y must be finite and |y| in [2^-511, 2^511], as the product of two divisors must not overflow.
+ */
+int div_ssr_frep_newton(double *x, double *y, const size_t n, double *result);
+
+int div_ssr_frep_newton_parallel(double *x, double *y, const size_t n, double *result);
+int div_ssr_frep_newton_omp(double *x, double *y, const size_t n, double *result);
 
 #endif
@@ -3,6 +3,11 @@
 #include <stdlib.h>
 
 #include "printf.h"
+#include "lmq.h"
+#include "rng.h"
+#include "dropout.h"
+#include "fpmath.h"
+#include "kernel.h"
 #include <math.h>
 
 /*
@@ -78,6 +83,7 @@ int dropout_ssr_frep(const double* arr, const size_t n, double ratio, double* re
     
     asm volatile("" : "=f"(ft0));
     
+    size_t mark = arena_mark(arena_global());
     double* mask = allocate(n, sizeof(double));
 
     for (size_t i = 0; i < n; i++) {
@@ -120,5 +126,181 @@ int dropout_ssr_frep(const double* arr, const size_t n, double ratio, double* re
     snrt_ssr_disable();
     asm volatile("" :: "f"(ft2));
 
+    arena_reset(arena_global(), mark);
+
+    return 0;
+}
+
+/*
+ * Elements of the mask block which the integer core draws while the FPU works on the previous one.
+ */
+#define DROPOUT_BLOCK FPMATH_BLOCK
+
+/*
+ * Drop probability ratio as a threshold on the 32 bit draws (drop if the draw is below).
+ */
+static inline uint32_t dropout_threshold(double ratio) {
+    return (uint32_t) (ratio * 4294967296.0);
+}
+
+__attribute__((noinline))
+int dropout_counter_baseline(const double* arr, const size_t n, const double ratio, uint32_t seed, double* result) {
+    uint32_t key = rng_key(seed, 0);
+    uint32_t threshold = dropout_threshold(ratio);
+    double scale = 1.0 / (1.0 - ratio);
+
+    for (size_t i = 0; i < n; i++) {
+        if (rng_draw(key, i) < threshold) {
+            result[i] = 0;
+        } else {
+            result[i] = arr[i] * scale;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Writes scale or 0 for the count elements from counter on into mask. The double is assembled from its
+ * two words in integer registers, so drawing the mask issues no FP instruction.
+ * If bits is not NULL the keep bits are packed into it as well, bit j % 32 of word j / 32 for element j of the block.
+ */
+static inline void dropout_mask(uint32_t* mask, uint32_t* bits, uint32_t key, uint32_t counter, size_t count,
+                                uint32_t threshold, uint32_t scale_lo, uint32_t scale_hi) {
+    uint32_t word = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t keep = -(uint32_t) (rng_draw(key, counter + i) >= threshold);
+        mask[2 * i] = scale_lo & keep;
+        mask[2 * i + 1] = scale_hi & keep;
+        word |= (keep & 1) << (i % 32);
+        if (bits && (i % 32 == 31 || i == count - 1)) {
+            bits[i / 32] = word;
+            word = 0;
+        }
+    }
+}
+
+/*
+ * Dropout of the n elements with the counters [counter, counter + n). The mask blocks are double buffered
+ * in the carry scratch of fpmath: FREP multiplies a block by its mask while the integer core draws the next one.
+ * The packed keep bits of the n elements are written to bits if it is not NULL.
+ */
+static inline void dropout_counter_range(const double* arr, const size_t n, uint32_t counter, const double ratio,
+                                         uint32_t seed, double* result, uint32_t* bits) {
+    union {
+        double value;
+        uint32_t words[2];
+    } scale = { .value = 1.0 / (1.0 - ratio) };
+    uint32_t key = rng_key(seed, 0);
+    uint32_t threshold = dropout_threshold(ratio);
+    double* carry = fpmath_carry();
+    uint32_t* masks[2] = { (uint32_t*) carry, (uint32_t*) (carry + DROPOUT_BLOCK) };
+
+    if (n == 0) {
+        return;
+    }
+
+    dropout_mask(masks[0], bits, key, counter, n < DROPOUT_BLOCK ? n : DROPOUT_BLOCK,
+                 threshold, scale.words[0], scale.words[1]);
+
+    for (size_t i = 0, buffer = 0; i < n; i += DROPOUT_BLOCK, buffer ^= 1) {
+        size_t count = n - i < DROPOUT_BLOCK ? n - i : DROPOUT_BLOCK;
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*arr));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) arr + i);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, count, sizeof(double));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, masks[buffer]);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM2, count, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + i);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "fmul.d ft2, ft0, ft1 \n"
+            :: [n_frep] "r"(count - 1)
+            : "ft0", "ft1", "ft2", "memory"
+        );
+
+        // The FPU sequencer runs the FREP on its own, the integer core draws the next mask meanwhile
+        if (i + count < n) {
+            size_t next = n - i - count < DROPOUT_BLOCK ? n - i - count : DROPOUT_BLOCK;
+            dropout_mask(masks[buffer ^ 1], bits ? bits + (i + count) / 32 : NULL, key, counter + i + count, next,
+                         threshold, scale.words[0], scale.words[1]);
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int dropout_counter_ssr_frep(const double* arr, const size_t n, const double ratio, uint32_t seed, double* result) {
+    dropout_counter_range(arr, n, 0, ratio, seed, result, NULL);
+    return 0;
+}
+
+// Element i always has counter i, so the result does not depend on the number of cores
+KERNEL_PARALLEL(dropout_counter_ssr_frep_parallel,
+                (const double* arr, const size_t n, const double ratio, uint32_t seed, double* result), n,
+                dropout_counter_range(arr + first, count, first, ratio, seed, result + first, NULL))
+
+KERNEL_OMP(dropout_counter_ssr_frep_omp,
+           (const double* arr, const size_t n, const double ratio, uint32_t seed, double* result), n,
+           dropout_counter_range(arr + first, count, first, ratio, seed, result + first, NULL))
+
+__attribute__((noinline))
+int dropout_counter_mask_baseline(const double* arr, const size_t n, const double ratio, uint32_t seed,
+                                  double* result, uint32_t* mask) {
+    uint32_t key = rng_key(seed, 0);
+    uint32_t threshold = dropout_threshold(ratio);
+    double scale = 1.0 / (1.0 - ratio);
+
+    for (size_t i = 0; i < n; i++) {
+        if (i % 32 == 0) {
+            mask[i / 32] = 0;
+        }
+        if (rng_draw(key, i) < threshold) {
+            result[i] = 0;
+        } else {
+            result[i] = arr[i] * scale;
+            mask[i / 32] |= 1u << (i % 32);
+        }
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int dropout_counter_mask_ssr_frep(const double* arr, const size_t n, const double ratio, uint32_t seed,
+                                  double* result, uint32_t* mask) {
+    dropout_counter_range(arr, n, 0, ratio, seed, result, mask);
+    return 0;
+}
+
+__attribute__((noinline))
+int dropout_counter_mask_ssr_frep_parallel(const double* arr, const size_t n, const double ratio, uint32_t seed,
+                                           double* result, uint32_t* mask) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    // Cores split the mask words, so no two cores write bits of the same word
+    size_t first_word;
+    size_t words = local_range((n + 31) / 32, core_idx, core_num, &first_word);
+    if (words == 0) {
+        return 0;
+    }
+    size_t first = first_word * 32;
+    size_t count = n - first < words * 32 ? n - first : words * 32;
+    dropout_counter_range(arr + first, count, first, ratio, seed, result + first, mask + first_word);
     return 0;
 }
@@ -15,4 +15,25 @@ int dropout_ssr(const double* arr, const size_t n, const double ratio, double* r
 int dropout_ssr_test(const double* arr, const size_t n, const double ratio, double* result);
 int dropout_ssr_frep(const double* arr, const size_t n, const double ratio, double* result);
 
-#endif
\ No newline at end of file
+/*
+ * Dropout with the counter based generator of src/lmq/rng.h: element i is dropped if draw i of the seed
+ * is below ratio (in [0, 1)) * 2^32. The ssr version draws the mask in integer registers while FREP
+ * applies the previous block, the result is the same for any number of cores.
+ */
+int dropout_counter_baseline(const double* arr, const size_t n, const double ratio, uint32_t seed, double* result);
+int dropout_counter_ssr_frep(const double* arr, const size_t n, const double ratio, uint32_t seed, double* result);
+int dropout_counter_ssr_frep_parallel(const double* arr, const size_t n, const double ratio, uint32_t seed, double* result);
+int dropout_counter_ssr_frep_omp(const double* arr, const size_t n, const double ratio, uint32_t seed, double* result);
+
+/*
+ * Counter based dropout which also writes the ONNX mask output bit packed: bit i % 32 of mask[i / 32] is set
+ * if element i is kept ((n + 31) / 32 words). The bits are packed in integer registers while the mask is drawn.
+ */
+int dropout_counter_mask_baseline(const double* arr, const size_t n, const double ratio, uint32_t seed,
+                                  double* result, uint32_t* mask);
+int dropout_counter_mask_ssr_frep(const double* arr, const size_t n, const double ratio, uint32_t seed,
+                                  double* result, uint32_t* mask);
+int dropout_counter_mask_ssr_frep_parallel(const double* arr, const size_t n, const double ratio, uint32_t seed,
+                                           double* result, uint32_t* mask);
+
+#endif
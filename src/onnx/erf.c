@@ -0,0 +1,107 @@
+#include <snrt.h>
+
+#include <math.h>
+#include "omp.h"
+#include "lmq.h"
+#include "erf.h"
+#include "fpmath.h"
+
+/*
+ * Naive implementation of erf. Calculates the erf of n elements starting at arr.
+ */
+__attribute__((noinline))
+int erf_baseline(double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = erf(arr[i]);
+    }
+
+    return 0;
+}
+
+/*
+ * Runs fpmath_erf for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void erf_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    fpmath_erf(arr, 1.0, carry, count, result, frep);
+}
+
+static inline void erf_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
+
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        erf_block(arr + i, count, result + i, carry, frep);
+    }
+}
+
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int erf_ssr(double* arr, const size_t n, double* result) {
+    erf_range(arr, n, result, 0);
+    return 0;
+}
+
+__attribute__((noinline))
+int erf_ssr_frep(double* arr, const size_t n, double* result) {
+    erf_range(arr, n, result, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int erf_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    erf_baseline(arr + first, count, result + first);
+    return 0;
+}
+
+__attribute__((noinline))
+int erf_ssr_frep_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    erf_range(arr + first, count, result + first, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int erf_omp(double* arr, const size_t n, double* result) {
+#pragma omp parallel for
+    for (size_t i = 0; i < n; i++) {
+        result[i] = erf(arr[i]);
+    }
+
+    return 0;
+}
+
+int erf_ssr_frep_omp(double* arr, const size_t n, double* result) {
+    // The last thread is not used in OpenMP.
+    // This is probably the DM core.
+    unsigned core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        unsigned core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t count = local_range(n, core_idx, core_num, &first);
+
+        erf_range(arr + first, count, result + first, 1);
+    }
+
+    return 0;
+}
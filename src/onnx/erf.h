@@ -0,0 +1,23 @@
+#ifndef LMQ_ERF_H
+#define LMQ_ERF_H
+
+#include <snrt.h>
+
+#include <math.h>
+
+/*
+ * Naive implementation of erf. Calculates the erf of n elements starting at arr.
+ * The ssr versions run fpmath_erf (max relative error 2e-14), the parallel versions split
+ * the elements over the compute cores.
+ */
+int erf_baseline(double* arr, const size_t n, double* result);
+int erf_ssr(double* arr, const size_t n, double* result);
+int erf_ssr_frep(double* arr, const size_t n, double* result);
+
+int erf_parallel(double* arr, const size_t n, double* result);
+int erf_ssr_frep_parallel(double* arr, const size_t n, double* result);
+
+int erf_omp(double* arr, const size_t n, double* result);
+int erf_ssr_frep_omp(double* arr, const size_t n, double* result);
+
+#endif
@@ -0,0 +1,172 @@
+#include <snrt.h>
+
+#include <math.h>
+#include "omp.h"
+#include "lmq.h"
+#include "exp.h"
+#include "fpmath.h"
+#include "lut.h"
+
+/*
+ * Naive implementation of exp. Calculates the exp of n elements starting at arr.
+ */
+__attribute__((noinline))
+int exp_baseline(double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = exp(arr[i]);
+    }
+
+    return 0;
+}
+
+/*
+ * exp(x) = 1 + expm1(|x|) for x >= 0 and 1 / (1 + expm1(|x|)) for x < 0, so no value close to 1
+ * is rounded before the division. Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void exp_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    fpmath_pass_begin(arr, carry, 0, 1, NULL, count);
+    FPMATH_PASS(frep, count, 1,
+        "fsgnj.d ft2, ft0, %[one] \n",
+        [one] "f"(1.0));
+    fpmath_pass_end();
+
+    fpmath_expm1(carry, count, frep);
+
+    // D = 1 + expm1(|x|) and a = sign(x): exp(x) = max(1, D (1 + a) / 2) / max(1, D (1 - a) / 2)
+    fpmath_pass_begin(arr, carry, 1, 1, result, count);
+    FPMATH_PASS(frep, count, 9,
+        "fadd.d ft3, ft1, %[one] \n"
+        "fsgnj.d ft4, %[one], ft0 \n"
+        "fmadd.d ft5, ft4, %[half], %[half] \n"
+        "fnmsub.d ft6, ft4, %[half], %[half] \n"
+        "fmul.d ft5, ft5, ft3 \n"
+        "fmul.d ft6, ft6, ft3 \n"
+        "fmax.d ft5, ft5, %[one] \n"
+        "fmax.d ft6, ft6, %[one] \n"
+        "fdiv.d ft2, ft5, ft6 \n",
+        [one] "f"(1.0), [half] "f"(0.5));
+    fpmath_pass_end();
+}
+
+static inline void exp_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
+
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        exp_block(arr + i, count, result + i, carry, frep);
+    }
+}
+
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int exp_ssr(double* arr, const size_t n, double* result) {
+    exp_range(arr, n, result, 0);
+    return 0;
+}
+
+__attribute__((noinline))
+int exp_ssr_frep(double* arr, const size_t n, double* result) {
+    exp_range(arr, n, result, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int exp_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    exp_baseline(arr + first, count, result + first);
+    return 0;
+}
+
+__attribute__((noinline))
+int exp_ssr_frep_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    exp_range(arr + first, count, result + first, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int exp_omp(double* arr, const size_t n, double* result) {
+#pragma omp parallel for
+    for (size_t i = 0; i < n; i++) {
+        result[i] = exp(arr[i]);
+    }
+
+    return 0;
+}
+
+int exp_ssr_frep_omp(double* arr, const size_t n, double* result) {
+    // The last thread is not used in OpenMP.
+    // This is probably the DM core.
+    unsigned core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        unsigned core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t count = local_range(n, core_idx, core_num, &first);
+
+        exp_range(arr + first, count, result + first, 1);
+    }
+
+    return 0;
+}
+
+// max |(2^r)''| on [0, 1] = 2 log(2)^2, relative to 2^r at most log(2)^2
+#define EXP_LUT_D2 0.9609060278364028
+#define EXP_LUT_LOG2E 1.4426950408889634
+
+static lut_t exp_table;
+
+static inline int exp_lut_init() {
+    return lut_init(&exp_table, exp2, 0.0, 1.0, lut_size(0.0, 1.0, EXP_LUT_D2, LUT_MAX_ERROR), 0.0);
+}
+
+/*
+ * exp(x) = 2^(x log2(e)) with a table of 2^r on [0, 1] in L1, which is built on the first call.
+ */
+__attribute__((noinline))
+int exp_lut(double* arr, const size_t n, double* result) {
+    if (exp_lut_init() != 0) {
+        return -1;
+    }
+
+    lut_eval_exp2(&exp_table, arr, EXP_LUT_LOG2E, n, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int exp_lut_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    if (exp_lut_init() != 0) {
+        return -1;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    lut_eval_exp2(&exp_table, arr + first, EXP_LUT_LOG2E, count, result + first);
+    return 0;
+}
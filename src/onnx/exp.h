@@ -0,0 +1,30 @@
+#ifndef LMQ_EXP_H
+#define LMQ_EXP_H
+
+#include <snrt.h>
+
+#include <math.h>
+
+/*
+ * Naive implementation of exp. Calculates the exp of n elements starting at arr.
+ * The ssr versions run the FP only passes of fpmath on expm1(|x|) (max relative error 1e-15 * max(1, |x|),
+ * x is clamped to [-708, 708]), the parallel versions split the elements over the compute cores.
+ */
+int exp_baseline(double* arr, const size_t n, double* result);
+int exp_ssr(double* arr, const size_t n, double* result);
+int exp_ssr_frep(double* arr, const size_t n, double* result);
+
+int exp_parallel(double* arr, const size_t n, double* result);
+int exp_ssr_frep_parallel(double* arr, const size_t n, double* result);
+
+int exp_omp(double* arr, const size_t n, double* result);
+int exp_ssr_frep_omp(double* arr, const size_t n, double* result);
+
+/*
+ * Lookup table versions (src/lmq/lut.h) with max relative error LUT_MAX_ERROR (x log2(e) is clamped to [-1022, 1023]).
+ * The table is built in L1 on the first call.
+ */
+int exp_lut(double* arr, const size_t n, double* result);
+int exp_lut_parallel(double* arr, const size_t n, double* result);
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef LMQ_FIXED_H
+#define LMQ_FIXED_H
+
+#include <snrt.h>
+
+#include "ssr_cfg.h"
+#include "gemm.h"
+
+/*
+ * Generators of shape specialized kernels for the layers of a fixed model: every dimension is a constant, so the
+ * loop bounds, the FREP repetitions and the remainder paths fold at compile time and the SSR configuration is
+ * the precomputed scfgwi sequence of src/lmq/ssr_cfg.h instead of the stride arithmetic of snrt_ssr_loop_*d.
+ * They are expanded once per shape in a .c file, f.ex. from a generated list of the layers:
+ *     GEMM_FIXED(gemm_fc1, 1, 256, 64)
+ * defines int gemm_fc1(double* a, double* b, double* result). The results are the ones of the generic kernel
+ * named in each comment, all dimensions must be larger than 0 (checked at compile time).
+ */
+
+/*
+ * FREP bodies: GEMM_BLOCK outputs over n products each, or one output.
+ */
+#define FIXED_BLOCK_BODY(n)                                                                 \
+    asm volatile(                                                                           \
+        "fcvt.d.w ft3, zero \n"                                                             \
+        "fcvt.d.w ft4, zero \n"                                                             \
+        "fcvt.d.w ft5, zero \n"                                                             \
+        "fcvt.d.w ft6, zero \n"                                                             \
+        "frep.o %[n_frep], 4, 0, 0 \n"                                                      \
+        "fmadd.d ft3, ft0, ft1, ft3 \n"                                                     \
+        "fmadd.d ft4, ft0, ft1, ft4 \n"                                                     \
+        "fmadd.d ft5, ft0, ft1, ft5 \n"                                                     \
+        "fmadd.d ft6, ft0, ft1, ft6 \n"                                                     \
+        "fmv.d ft2, ft3 \n"                                                                 \
+        "fmv.d ft2, ft4 \n"                                                                 \
+        "fmv.d ft2, ft5 \n"                                                                 \
+        "fmv.d ft2, ft6 \n"                                                                 \
+        :                                                                                   \
+        : [n_frep] "r"((n) - 1)                                                             \
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"                                   \
+    )
+
+#define FIXED_DOT_BODY(n)                                                                   \
+    asm volatile(                                                                           \
+        "fcvt.d.w ft3, zero \n"                                                             \
+        "frep.o %[n_frep], 1, 0, 0 \n"                                                      \
+        "fmadd.d ft3, ft0, ft1, ft3 \n"                                                     \
+        "fmv.d ft2, ft3 \n"                                                                 \
+        :                                                                                   \
+        : [n_frep] "r"((n) - 1)                                                             \
+        : "ft0", "ft1", "ft2", "ft3"                                                        \
+    )
+
+/*
+ * gemm_ssr_frep_blocked of a (M, N) and b (N, K): GEMM_BLOCK columns of a row share one FREP body, the
+ * K % GEMM_BLOCK last columns of all rows are one more stream configuration with a single accumulator.
+ */
+#define GEMM_FIXED(name, M, N, K)                                                           \
+    __attribute__((noinline))                                                               \
+    int name(double* a, double* b, double* __restrict__ result) {                           \
+        _Static_assert((M) > 0 && (N) > 0 && (K) > 0, #name ": empty shape");               \
+        enum { blocks = (K) / GEMM_BLOCK, rest = (K) % GEMM_BLOCK };                        \
+                                                                                            \
+        if (blocks > 0) {                                                                   \
+            SSR_CFG_LOOP_3D(SNRT_SSR_DM0, N, blocks, M, sizeof(double), 0, sizeof(double) * (N)); \
+            SSR_CFG_REPEAT(SNRT_SSR_DM0, GEMM_BLOCK);                                       \
+            SSR_CFG_READ(SNRT_SSR_DM0, SNRT_SSR_3D, a);                                     \
+                                                                                            \
+            SSR_CFG_LOOP_4D(SNRT_SSR_DM1, GEMM_BLOCK, N, blocks, M, sizeof(double),         \
+                            sizeof(double) * (K), sizeof(double) * GEMM_BLOCK, 0);          \
+            SSR_CFG_REPEAT(SNRT_SSR_DM1, 1);                                                \
+            SSR_CFG_READ(SNRT_SSR_DM1, SNRT_SSR_4D, b);                                     \
+                                                                                            \
+            SSR_CFG_LOOP_3D(SNRT_SSR_DM2, GEMM_BLOCK, blocks, M, sizeof(double),            \
+                            sizeof(double) * GEMM_BLOCK, sizeof(double) * (K));             \
+            SSR_CFG_REPEAT(SNRT_SSR_DM2, 1);                                                \
+            SSR_CFG_WRITE(SNRT_SSR_DM2, SNRT_SSR_3D, result);                               \
+                                                                                            \
+            snrt_ssr_enable();                                                              \
+            for (size_t i = 0; i < (M) * blocks; ++i) {                                     \
+                FIXED_BLOCK_BODY(N);                                                        \
+            }                                                                               \
+            snrt_fpu_fence();                                                               \
+            snrt_ssr_disable();                                                             \
+        }                                                                                   \
+                                                                                            \
+        if (rest > 0) {                                                                     \
+            SSR_CFG_LOOP_3D(SNRT_SSR_DM0, N, rest, M, sizeof(double), 0, sizeof(double) * (N)); \
+            SSR_CFG_REPEAT(SNRT_SSR_DM0, 1);                                                \
+            SSR_CFG_READ(SNRT_SSR_DM0, SNRT_SSR_3D, a);                                     \
+                                                                                            \
+            SSR_CFG_LOOP_3D(SNRT_SSR_DM1, N, rest, M, sizeof(double) * (K), sizeof(double), 0); \
+            SSR_CFG_REPEAT(SNRT_SSR_DM1, 1);                                                \
+            SSR_CFG_READ(SNRT_SSR_DM1, SNRT_SSR_3D, b + blocks * GEMM_BLOCK);               \
+                                                                                            \
+            SSR_CFG_LOOP_2D(SNRT_SSR_DM2, rest, M, sizeof(double), sizeof(double) * (K));   \
+            SSR_CFG_REPEAT(SNRT_SSR_DM2, 1);                                                \
+            SSR_CFG_WRITE(SNRT_SSR_DM2, SNRT_SSR_2D, result + blocks * GEMM_BLOCK);         \
+                                                                                            \
+            snrt_ssr_enable();                                                              \
+            for (size_t i = 0; i < (M) * rest; ++i) {                                       \
+                FIXED_DOT_BODY(N);                                                          \
+            }                                                                               \
+            snrt_fpu_fence();                                                               \
+            snrt_ssr_disable();                                                             \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+/*
+ * gemv_ssr_frep of a (M, N) and x (N): GEMM_BLOCK rows share one FREP body, the M % GEMM_BLOCK last rows are
+ * one more stream configuration instead of one per row.
+ */
+#define GEMV_FIXED(name, M, N)                                                              \
+    __attribute__((noinline))                                                               \
+    int name(double* a, double* x, double* __restrict__ result) {                           \
+        _Static_assert((M) > 0 && (N) > 0, #name ": empty shape");                          \
+        enum { blocks = (M) / GEMM_BLOCK, rest = (M) % GEMM_BLOCK };                        \
+                                                                                            \
+        if (blocks > 0) {                                                                   \
+            SSR_CFG_LOOP_3D(SNRT_SSR_DM0, GEMM_BLOCK, N, blocks, sizeof(double) * (N),      \
+                            sizeof(double), sizeof(double) * (N) * GEMM_BLOCK);             \
+            SSR_CFG_REPEAT(SNRT_SSR_DM0, 1);                                                \
+            SSR_CFG_READ(SNRT_SSR_DM0, SNRT_SSR_3D, a);                                     \
+                                                                                            \
+            SSR_CFG_LOOP_2D(SNRT_SSR_DM1, N, blocks, sizeof(double), 0);                    \
+            SSR_CFG_REPEAT(SNRT_SSR_DM1, GEMM_BLOCK);                                       \
+            SSR_CFG_READ(SNRT_SSR_DM1, SNRT_SSR_2D, x);                                     \
+                                                                                            \
+            SSR_CFG_LOOP_1D(SNRT_SSR_DM2, blocks * GEMM_BLOCK, sizeof(double));             \
+            SSR_CFG_REPEAT(SNRT_SSR_DM2, 1);                                                \
+            SSR_CFG_WRITE(SNRT_SSR_DM2, SNRT_SSR_1D, result);                               \
+                                                                                            \
+            snrt_ssr_enable();                                                              \
+            for (size_t i = 0; i < blocks; ++i) {                                           \
+                FIXED_BLOCK_BODY(N);                                                        \
+            }                                                                               \
+            snrt_fpu_fence();                                                               \
+            snrt_ssr_disable();                                                             \
+        }                                                                                   \
+                                                                                            \
+        if (rest > 0) {                                                                     \
+            SSR_CFG_LOOP_2D(SNRT_SSR_DM0, N, rest, sizeof(double), sizeof(double) * (N));   \
+            SSR_CFG_REPEAT(SNRT_SSR_DM0, 1);                                                \
+            SSR_CFG_READ(SNRT_SSR_DM0, SNRT_SSR_2D, a + blocks * GEMM_BLOCK * (N));         \
+                                                                                            \
+            SSR_CFG_LOOP_2D(SNRT_SSR_DM1, N, rest, sizeof(double), 0);                      \
+            SSR_CFG_REPEAT(SNRT_SSR_DM1, 1);                                                \
+            SSR_CFG_READ(SNRT_SSR_DM1, SNRT_SSR_2D, x);                                     \
+                                                                                            \
+            SSR_CFG_LOOP_1D(SNRT_SSR_DM2, rest, sizeof(double));                            \
+            SSR_CFG_REPEAT(SNRT_SSR_DM2, 1);                                                \
+            SSR_CFG_WRITE(SNRT_SSR_DM2, SNRT_SSR_1D, result + blocks * GEMM_BLOCK);         \
+                                                                                            \
+            snrt_ssr_enable();                                                              \
+            for (size_t i = 0; i < rest; ++i) {                                             \
+                FIXED_DOT_BODY(N);                                                          \
+            }                                                                               \
+            snrt_fpu_fence();                                                               \
+            snrt_ssr_disable();                                                             \
+        }                                                                                   \
+        return 0;                                                                           \
+    }
+
+/*
+ * Number of outputs of a convolution along one dimension, as a constant expression (conv_output_size).
+ */
+#define FIXED_CONV_OUTPUT_SIZE(n, f, s, d) (1 + ((n) - 1 - ((f) - 1) * (d)) / (s))
+
+/*
+ * conv2d_ssr_frep of a (N1, N0) with filter (F1, F0), strides (S0, S1) and dilations (D0, D1).
+ */
+#define CONV2D_FIXED(name, N0, N1, F0, F1, S0, S1, D0, D1)                                  \
+    __attribute__((noinline))                                                               \
+    int name(double* a, double* filter, double* result) {                                   \
+        _Static_assert((F0) > 0 && (F1) > 0 && (S0) > 0 && (S1) > 0 && (D0) > 0 && (D1) > 0 \
+                       && (N0) > ((F0) - 1) * (D0) && (N1) > ((F1) - 1) * (D1), #name ": empty shape"); \
+        enum {                                                                              \
+            outn0 = FIXED_CONV_OUTPUT_SIZE(N0, F0, S0, D0),                                 \
+            outn1 = FIXED_CONV_OUTPUT_SIZE(N1, F1, S1, D1),                                 \
+        };                                                                                  \
+                                                                                            \
+        SSR_CFG_LOOP_4D(SNRT_SSR_DM0, F0, F1, outn0, outn1, sizeof(double) * (D0),          \
+                        sizeof(double) * (N0) * (D1), sizeof(double) * (S0), sizeof(double) * (S1) * (N0)); \
+        SSR_CFG_REPEAT(SNRT_SSR_DM0, 1);                                                    \
+        SSR_CFG_READ(SNRT_SSR_DM0, SNRT_SSR_4D, a);                                         \
+                                                                                            \
+        SSR_CFG_LOOP_4D(SNRT_SSR_DM1, F0, F1, outn0, outn1, sizeof(double),                 \
+                        sizeof(double) * (F0), 0, 0);                                       \
+        SSR_CFG_REPEAT(SNRT_SSR_DM1, 1);                                                    \
+        SSR_CFG_READ(SNRT_SSR_DM1, SNRT_SSR_4D, filter);                                    \
+                                                                                            \
+        SSR_CFG_LOOP_1D(SNRT_SSR_DM2, outn0 * outn1, sizeof(double));                       \
+        SSR_CFG_REPEAT(SNRT_SSR_DM2, 1);                                                    \
+        SSR_CFG_WRITE(SNRT_SSR_DM2, SNRT_SSR_1D, result);                                   \
+                                                                                            \
+        snrt_ssr_enable();                                                                  \
+        for (size_t i = 0; i < outn0 * outn1; ++i) {                                        \
+            FIXED_DOT_BODY((F0) * (F1));                                                    \
+        }                                                                                   \
+        snrt_fpu_fence();                                                                   \
+        snrt_ssr_disable();                                                                 \
+        return 0;                                                                           \
+    }
+
+#endif
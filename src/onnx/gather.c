@@ -0,0 +1,252 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "gather.h"
+#include "copy.h"
+
+/*
+ * Returns -1 if one of the n indices is not within [-axis_dim, axis_dim).
+ */
+static int gather_check(const int32_t* indices, const size_t n, const size_t axis_dim) {
+    for (size_t j = 0; j < n; j++) {
+        if (indices[j] < -(int32_t) axis_dim || indices[j] >= (int32_t) axis_dim) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// The index as a position on the axis, after gather_check
+static inline size_t gather_index(const int32_t index, const size_t axis_dim) {
+    return index < 0 ? (size_t) (index + (int32_t) axis_dim) : (size_t) index;
+}
+
+__attribute__((noinline))
+int gather_baseline(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                    const int32_t* indices, const size_t n, double* result) {
+    if (gather_check(indices, n, axis_dim) != 0) {
+        return -1;
+    }
+
+    for (size_t o = 0; o < outer; o++) {
+        for (size_t j = 0; j < n; j++) {
+            const double* row = data + (o * axis_dim + gather_index(indices[j], axis_dim)) * inner;
+            for (size_t i = 0; i < inner; i++) {
+                result[(o * n + j) * inner + i] = row[i];
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Copies the rows of count indices into result, whose rows of one o are row_stride indices apart. For every index
+ * DM0 reads the (outer, inner) rows of it and DM2 writes them, both as a 2D stream.
+ */
+static inline void gather_rows(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                               const int32_t* indices, const size_t count, const size_t row_stride, double* result) {
+    if (outer * inner == 0) {
+        return;
+    }
+
+    for (size_t j = 0; j < count; j++) {
+        snrt_ssr_loop_2d(SNRT_SSR_DM0, inner, outer, sizeof(*data), sizeof(*data) * axis_dim * inner);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, (double*) data + gather_index(indices[j], axis_dim) * inner);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM2, inner, outer, sizeof(*result), sizeof(*result) * row_stride * inner);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, result + j * inner);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "fmv.d ft2, ft0 \n"
+            :
+            : [n_frep] "r"(outer * inner - 1)
+            : "ft0", "ft1", "ft2", "memory"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int gather_ssr_frep(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                    const int32_t* indices, const size_t n, double* result) {
+    if (gather_check(indices, n, axis_dim) != 0) {
+        return -1;
+    }
+
+    gather_rows(data, outer, axis_dim, inner, indices, n, n, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int gather_ssr_frep_parallel(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                             const int32_t* indices, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (gather_check(indices, n, axis_dim) != 0) {
+        return -1;
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    gather_rows(data, outer, axis_dim, inner, indices + first, count, n, result + first * inner);
+    return 0;
+}
+
+__attribute__((noinline))
+int gather_dma(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+               const int32_t* indices, const size_t n, double* result) {
+    if (gather_check(indices, n, axis_dim) != 0) {
+        return -1;
+    }
+
+    if (snrt_is_dm_core()) {
+        // All transfers are in flight before the DM core waits
+        for (size_t j = 0; j < n; j++) {
+            copy_dma_start_3d((double*) data + gather_index(indices[j], axis_dim) * inner, inner, outer, 1,
+                              axis_dim * inner, n * inner, 0, 0, result + j * inner);
+        }
+        snrt_dma_wait_all();
+    }
+    snrt_cluster_hw_barrier();
+
+    return 0;
+}
+
+__attribute__((noinline))
+int gather_elements_baseline(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                             const int32_t* indices, const size_t n, double* result) {
+    if (gather_check(indices, outer * n * inner, axis_dim) != 0) {
+        return -1;
+    }
+
+    for (size_t o = 0; o < outer; o++) {
+        for (size_t j = 0; j < n; j++) {
+            for (size_t i = 0; i < inner; i++) {
+                size_t e = (o * n + j) * inner + i;
+                result[e] = data[(o * axis_dim + gather_index(indices[e], axis_dim)) * inner + i];
+            }
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int gather_elements_parallel(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                             const int32_t* indices, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (gather_check(indices, outer * n * inner, axis_dim) != 0) {
+        return -1;
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    // The doubles are moved as two words in integer registers, no load waits in the FPU
+    const uint32_t* words = (const uint32_t*) data;
+    uint32_t* out = (uint32_t*) result;
+
+    size_t first;
+    size_t rows = local_range(outer * n, core_idx, core_num, &first);
+    for (size_t r = first; r < first + rows; r++) {
+        size_t base = (r / n) * axis_dim * inner;
+        for (size_t i = 0; i < inner; i++) {
+            size_t e = r * inner + i;
+            size_t source = base + gather_index(indices[e], axis_dim) * inner + i;
+            out[2 * e] = words[2 * source];
+            out[2 * e + 1] = words[2 * source + 1];
+        }
+    }
+    return 0;
+}
+
+static inline double scatter_apply(scatter_reduction_t reduction, double value, double update) {
+    switch (reduction) {
+        case SCATTER_ADD:
+            return value + update;
+        case SCATTER_MUL:
+            return value * update;
+        case SCATTER_MAX:
+            return update > value ? update : value;
+        case SCATTER_MIN:
+            return update < value ? update : value;
+        default:
+            return update;
+    }
+}
+
+/*
+ * Applies the updates of the columns [first, first + count) of the outer * inner columns (o, i) to result.
+ */
+static inline void scatter_columns(const size_t axis_dim, const size_t inner, const int32_t* indices,
+                                   const double* updates, const size_t n, scatter_reduction_t reduction,
+                                   const size_t first, const size_t count, double* result) {
+    for (size_t c = first; c < first + count; c++) {
+        size_t o = c / inner;
+        size_t i = c % inner;
+        double* column = result + o * axis_dim * inner + i;
+        for (size_t j = 0; j < n; j++) {
+            size_t e = (o * n + j) * inner + i;
+            double* target = column + gather_index(indices[e], axis_dim) * inner;
+            *target = scatter_apply(reduction, *target, updates[e]);
+        }
+    }
+}
+
+__attribute__((noinline))
+int scatter_elements_baseline(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                              const int32_t* indices, const double* updates, const size_t n,
+                              scatter_reduction_t reduction, double* result) {
+    if (gather_check(indices, outer * n * inner, axis_dim) != 0) {
+        return -1;
+    }
+
+    if (result != data) {
+        for (size_t e = 0; e < outer * axis_dim * inner; e++) {
+            result[e] = data[e];
+        }
+    }
+    scatter_columns(axis_dim, inner, indices, updates, n, reduction, 0, outer * inner, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int scatter_elements_parallel(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                              const int32_t* indices, const double* updates, const size_t n,
+                              scatter_reduction_t reduction, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t first;
+
+    if (gather_check(indices, outer * n * inner, axis_dim) != 0) {
+        return -1;
+    }
+
+    if (result != data && !snrt_is_dm_core()) {
+        size_t count = local_range(outer * axis_dim * inner, core_idx, core_num, &first);
+        for (size_t e = first; e < first + count; e++) {
+            result[e] = data[e];
+        }
+    }
+    snrt_cluster_hw_barrier();
+
+    if (!snrt_is_dm_core()) {
+        size_t count = local_range(outer * inner, core_idx, core_num, &first);
+        scatter_columns(axis_dim, inner, indices, updates, n, reduction, first, count, result);
+    }
+    snrt_cluster_hw_barrier();
+
+    return 0;
+}
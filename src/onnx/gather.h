@@ -0,0 +1,68 @@
+#ifndef LMQ_GATHER_H
+#define LMQ_GATHER_H
+
+#include <snrt.h>
+#include <stdint.h>
+
+/*
+ * ONNX Gather, GatherElements and ScatterElements along one axis. data is row major and viewed as
+ * (outer, axis_dim, inner): outer is the product of the dimensions before the axis and inner the product of the
+ * ones after it. The indices are int32, negative ones count from the back of the axis. All versions return -1
+ * (and write nothing) if an index is not within [-axis_dim, axis_dim).
+ */
+
+/*
+ * Gather: result (outer, n, inner) with result[o, j, :] = data[o, indices[j], :] for the n indices (of any shape,
+ * flattened), f.ex. the rows of an embedding table (outer 1).
+ * The runtime has no indirect SSR configuration, so the ssr_frep version configures the streams once per index:
+ * the rows of all outer for one index are a 2D read and write, which FREP copies. The parallel version splits
+ * the indices (the output rows) over the compute cores.
+ * The dma version must be called by all cores of the cluster: the DM core issues a 2D transfer per index, so the
+ * table can stay in global memory and the rows go straight to result (f.ex. in L1). It returns once all rows
+ * are copied (cluster barrier).
+ */
+int gather_baseline(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                    const int32_t* indices, const size_t n, double* result);
+int gather_ssr_frep(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                    const int32_t* indices, const size_t n, double* result);
+int gather_ssr_frep_parallel(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                             const int32_t* indices, const size_t n, double* result);
+int gather_dma(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+               const int32_t* indices, const size_t n, double* result);
+
+/*
+ * GatherElements: indices and result are (outer, n, inner) and result[o, j, i] = data[o, indices[o, j, i], i].
+ * Every element has its own index, so the parallel version copies the elements as words on the integer core
+ * of every compute core, split over the rows (o, j) of the result.
+ */
+int gather_elements_baseline(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                             const int32_t* indices, const size_t n, double* result);
+int gather_elements_parallel(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                             const int32_t* indices, const size_t n, double* result);
+
+/*
+ * ONNX ScatterElements reduction attribute.
+ */
+typedef enum {
+    SCATTER_NONE,
+    SCATTER_ADD,
+    SCATTER_MUL,
+    SCATTER_MAX,
+    SCATTER_MIN
+} scatter_reduction_t;
+
+/*
+ * ScatterElements: result (like data) is a copy of data in which result[o, indices[o, j, i], i] is replaced by
+ * (or for a reduction combined with) updates[o, j, i], indices and updates are (outer, n, inner). The updates are
+ * applied in the order of j, so with SCATTER_NONE the last one of duplicate indices wins. result may be data.
+ * The parallel version must be called by all cores of the cluster: the compute cores copy data, then every core
+ * applies all updates of its range of the outer * inner columns (o, i), which no other core writes.
+ */
+int scatter_elements_baseline(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                              const int32_t* indices, const double* updates, const size_t n,
+                              scatter_reduction_t reduction, double* result);
+int scatter_elements_parallel(const double* data, const size_t outer, const size_t axis_dim, const size_t inner,
+                              const int32_t* indices, const double* updates, const size_t n,
+                              scatter_reduction_t reduction, double* result);
+
+#endif
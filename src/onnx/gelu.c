@@ -0,0 +1,169 @@
+#include <snrt.h>
+
+#include <math.h>
+#include "omp.h"
+#include "lmq.h"
+#include "gelu.h"
+#include "fpmath.h"
+#include "lut.h"
+
+#define GELU_SQRT1_2 0.70710678118654752440
+
+/*
+ * Gelu with the exact erf form of ONNX (approximate = "none").
+ */
+static inline double gelu(double x) {
+    return 0.5 * x * (1.0 + erf(x * GELU_SQRT1_2));
+}
+
+/*
+ * Naive implementation of gelu. Calculates the gelu of n elements starting at arr.
+ */
+__attribute__((noinline))
+int gelu_baseline(double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = gelu(arr[i]);
+    }
+
+    return 0;
+}
+
+/*
+ * x / 2 * (1 + erf(x / sqrt(2))). Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void gelu_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    fpmath_erf(arr, GELU_SQRT1_2, carry, count, NULL, frep);
+
+    fpmath_pass_begin(arr, carry, 1, 1, result, count);
+    FPMATH_PASS(frep, count, 3,
+        "fadd.d ft3, ft1, %[one] \n"
+        "fmul.d ft3, ft3, ft0 \n"
+        "fmul.d ft2, ft3, %[half] \n",
+        [one] "f"(1.0), [half] "f"(0.5));
+    fpmath_pass_end();
+}
+
+static inline void gelu_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
+
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        gelu_block(arr + i, count, result + i, carry, frep);
+    }
+}
+
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int gelu_ssr(double* arr, const size_t n, double* result) {
+    gelu_range(arr, n, result, 0);
+    return 0;
+}
+
+__attribute__((noinline))
+int gelu_ssr_frep(double* arr, const size_t n, double* result) {
+    gelu_range(arr, n, result, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int gelu_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    gelu_baseline(arr + first, count, result + first);
+    return 0;
+}
+
+__attribute__((noinline))
+int gelu_ssr_frep_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    gelu_range(arr + first, count, result + first, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int gelu_omp(double* arr, const size_t n, double* result) {
+#pragma omp parallel for
+    for (size_t i = 0; i < n; i++) {
+        result[i] = gelu(arr[i]);
+    }
+
+    return 0;
+}
+
+int gelu_ssr_frep_omp(double* arr, const size_t n, double* result) {
+    // The last thread is not used in OpenMP.
+    // This is probably the DM core.
+    unsigned core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        unsigned core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t count = local_range(n, core_idx, core_num, &first);
+
+        gelu_range(arr + first, count, result + first, 1);
+    }
+
+    return 0;
+}
+
+// Outside of [-GELU_LUT_X, GELU_LUT_X] gelu is within 1e-6 of 0 or x (the ramp)
+#define GELU_LUT_X 5.5
+// max |gelu''| = 2 / sqrt(2 pi) at 0
+#define GELU_LUT_D2 0.7978845608028654
+
+static lut_t gelu_table;
+
+static inline int gelu_lut_init() {
+    return lut_init(&gelu_table, gelu, -GELU_LUT_X, GELU_LUT_X,
+                    lut_size(-GELU_LUT_X, GELU_LUT_X, GELU_LUT_D2, LUT_MAX_ERROR), 1.0);
+}
+
+/*
+ * Linear interpolation in a table of gelu in L1, which is built on the first call.
+ */
+__attribute__((noinline))
+int gelu_lut(double* arr, const size_t n, double* result) {
+    if (gelu_lut_init() != 0) {
+        return -1;
+    }
+
+    lut_eval(&gelu_table, arr, n, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int gelu_lut_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    if (gelu_lut_init() != 0) {
+        return -1;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    lut_eval(&gelu_table, arr + first, count, result + first);
+    return 0;
+}
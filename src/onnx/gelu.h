@@ -0,0 +1,31 @@
+#ifndef LMQ_GELU_H
+#define LMQ_GELU_H
+
+#include <snrt.h>
+
+#include <math.h>
+
+/*
+ * Naive implementation of Gelu (x / 2 * (1 + erf(x / sqrt(2))), approximate = "none").
+ * Calculates the Gelu of n elements starting at arr.
+ * The ssr versions run fpmath_erf (max absolute error 5e-15, for x > -3 max relative error 4e-14),
+ * the parallel versions split the elements over the compute cores.
+ */
+int gelu_baseline(double* arr, const size_t n, double* result);
+int gelu_ssr(double* arr, const size_t n, double* result);
+int gelu_ssr_frep(double* arr, const size_t n, double* result);
+
+int gelu_parallel(double* arr, const size_t n, double* result);
+int gelu_ssr_frep_parallel(double* arr, const size_t n, double* result);
+
+int gelu_omp(double* arr, const size_t n, double* result);
+int gelu_ssr_frep_omp(double* arr, const size_t n, double* result);
+
+/*
+ * Lookup table versions (src/lmq/lut.h) with max absolute error LUT_MAX_ERROR.
+ * The table is built in L1 on the first call.
+ */
+int gelu_lut(double* arr, const size_t n, double* result);
+int gelu_lut_parallel(double* arr, const size_t n, double* result);
+
+#endif
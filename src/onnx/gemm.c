@@ -3,8 +3,13 @@
 #include <stddef.h>
 
 #include "gemm.h"
+#include "lmq.h"
 #include "printf.h"
 
+#ifndef LMQ_HOST
+#include "reduce.h"
+#endif
+
 /*
  * Naive implementation of gemm.
  * arr is in row major format and has dimensions (m, k)
@@ -23,6 +28,8 @@ int gemm_baseline(double* a, double* b, const size_t m, const size_t n, const si
     return 0;
 }
 
+#ifndef LMQ_HOST
+
 int print_other_gemm_pattern(const double* b, size_t m, size_t n, size_t k, double* result, size_t result_len) {
     snrt_ssr_loop_3d(SNRT_SSR_DM1, n, m, k, sizeof(*b) * k, sizeof(*b), 0);
     snrt_ssr_repeat(SNRT_SSR_DM1, 1);
@@ -149,6 +156,74 @@ int gemm_ssr_frep(double* a, double* b, const size_t m, const size_t n, const si
     return 0;
 }
 
+/*
+ * Computes rows rows of result with the register blocked micro kernel.
+ * GEMM_BLOCK outputs of a row are accumulated at once (in ft3 - ft6), so the FMAs
+ * inside the FREP body do not depend on each other and the FPU pipeline stays full.
+ * Every element of a is streamed once and repeated for the GEMM_BLOCK columns of b.
+ */
+static inline void gemm_block_rows(double* a, double* b, const size_t rows, const size_t n, const size_t k, double* __restrict__ result) {
+    size_t blocks = k / GEMM_BLOCK;
+
+    if (rows > 0 && blocks > 0) {
+        snrt_ssr_loop_3d(SNRT_SSR_DM0, n, blocks, rows, sizeof(*a), 0, sizeof(*a) * n);
+        snrt_ssr_repeat(SNRT_SSR_DM0, GEMM_BLOCK);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, a);
+
+        snrt_ssr_loop_4d(SNRT_SSR_DM1, GEMM_BLOCK, n, blocks, rows,
+            sizeof(*b), sizeof(*b) * k, sizeof(*b) * GEMM_BLOCK, 0);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_4D, b);
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM2, GEMM_BLOCK, blocks, rows,
+            sizeof(*result), sizeof(*result) * GEMM_BLOCK, sizeof(*result) * k);
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_3D, result);
+
+        snrt_ssr_enable();
+
+        for (size_t i = 0; i < rows * blocks; ++i) {
+            asm volatile(
+                "fcvt.d.w ft3, zero \n"
+                "fcvt.d.w ft4, zero \n"
+                "fcvt.d.w ft5, zero \n"
+                "fcvt.d.w ft6, zero \n"
+                "frep.o %[n_frep], 4, 0, 0 \n"
+                "fmadd.d ft3, ft0, ft1, ft3 \n"
+                "fmadd.d ft4, ft0, ft1, ft4 \n"
+                "fmadd.d ft5, ft0, ft1, ft5 \n"
+                "fmadd.d ft6, ft0, ft1, ft6 \n"
+                "fmv.d ft2, ft3 \n"
+                "fmv.d ft2, ft4 \n"
+                "fmv.d ft2, ft5 \n"
+                "fmv.d ft2, ft6 \n"
+                :
+                : [n_frep] "r"(n - 1)
+                : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+            );
+        }
+
+        snrt_ssr_disable();
+    }
+
+    // Columns which do not fill a whole block
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = blocks * GEMM_BLOCK; j < k; ++j) {
+            double acc = 0;
+            for (size_t l = 0; l < n; ++l) {
+                acc += a[i * n + l] * b[l * k + j];
+            }
+            result[i * k + j] = acc;
+        }
+    }
+}
+
+__attribute__((noinline))
+int gemm_ssr_frep_blocked(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    gemm_block_rows(a, b, m, n, k, result);
+    return 0;
+}
+
 __attribute__((noinline))
 int gemm_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
     size_t core_num = snrt_cluster_core_num() - 1;
@@ -297,6 +372,27 @@ int gemm_ssr_frep_parallel(double* a, double* b, const size_t m, const size_t n,
     return 0;
 }
 
+__attribute__((noinline))
+int gemm_ssr_frep_blocked_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t local_m = m / core_num;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    gemm_block_rows(a + local_m * core_idx * n, b, local_m, n, k, result + local_m * core_idx * k);
+
+    // The leftover rows are blocked as well
+    if (core_idx < m - local_m * core_num) {
+        size_t row = core_num * local_m + core_idx;
+        gemm_block_rows(a + row * n, b, 1, n, k, result + row * k);
+    }
+
+    return 0;
+}
+
 int gemm_omp(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
 #pragma omp parallel for collapse(1)
     for (size_t i = 0; i < m; ++i) {
@@ -430,3 +526,489 @@ int gemm_ssr_frep_omp(double* a, double* b, const size_t m, const size_t n, cons
 
     return 0;
 }
+
+int gemm_ssr_frep_blocked_omp(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+#pragma omp parallel
+    {
+        size_t core_num = snrt_cluster_core_num() - 1;
+        size_t core_idx = snrt_cluster_core_idx();
+        size_t local_m = m / core_num;
+
+        gemm_block_rows(a + local_m * core_idx * n, b, local_m, n, k, result + local_m * core_idx * k);
+
+        if (core_idx < m - local_m * core_num) {
+            size_t row = core_num * local_m + core_idx;
+            gemm_block_rows(a + row * n, b, 1, n, k, result + row * k);
+        }
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int gemv_baseline(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result) {
+    for (size_t i = 0; i < m; ++i) {
+        double acc = 0;
+        for (size_t l = 0; l < n; ++l) {
+            acc += a[i * n + l] * x[l];
+        }
+        result[i] = acc;
+    }
+    return 0;
+}
+
+/*
+ * Computes rows rows of the matrix vector product.
+ * GEMM_BLOCK rows are accumulated at once (in ft3 - ft6): a is streamed column by column over the
+ * rows of a block and every element of x is repeated for them. The SSRs are set up once for all
+ * blocks. The rows which do not fill a whole block use the staggered dot product.
+ */
+static inline void gemv_block_rows(double* a, double* x, const size_t rows, const size_t n, double* __restrict__ result) {
+    size_t blocks = rows / GEMM_BLOCK;
+
+    if (n == 0) {
+        for (size_t i = 0; i < rows; ++i) {
+            result[i] = 0.0;
+        }
+        return;
+    }
+
+    if (blocks > 0) {
+        snrt_ssr_loop_3d(SNRT_SSR_DM0, GEMM_BLOCK, n, blocks,
+            sizeof(*a) * n, sizeof(*a), sizeof(*a) * n * GEMM_BLOCK);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, a);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM1, n, blocks, sizeof(*x), 0);
+        snrt_ssr_repeat(SNRT_SSR_DM1, GEMM_BLOCK);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, x);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM2, blocks * GEMM_BLOCK, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result);
+
+        snrt_ssr_enable();
+
+        for (size_t i = 0; i < blocks; ++i) {
+            asm volatile(
+                "fcvt.d.w ft3, zero \n"
+                "fcvt.d.w ft4, zero \n"
+                "fcvt.d.w ft5, zero \n"
+                "fcvt.d.w ft6, zero \n"
+                "frep.o %[n_frep], 4, 0, 0 \n"
+                "fmadd.d ft3, ft0, ft1, ft3 \n"
+                "fmadd.d ft4, ft0, ft1, ft4 \n"
+                "fmadd.d ft5, ft0, ft1, ft5 \n"
+                "fmadd.d ft6, ft0, ft1, ft6 \n"
+                "fmv.d ft2, ft3 \n"
+                "fmv.d ft2, ft4 \n"
+                "fmv.d ft2, ft5 \n"
+                "fmv.d ft2, ft6 \n"
+                :
+                : [n_frep] "r"(n - 1)
+                : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+            );
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+
+    for (size_t i = blocks * GEMM_BLOCK; i < rows; ++i) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*a));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a + i * n);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*x));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, x);
+
+        snrt_ssr_enable();
+
+        double acc = reduce_dot_ssr_frep(n);
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+
+        result[i] = acc;
+    }
+}
+
+__attribute__((noinline))
+int gemv_ssr_frep(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result) {
+    gemv_block_rows(a, x, m, n, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int gemv_ssr_frep_parallel(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t rows = local_range(m, core_idx, core_num, &first);
+    gemv_block_rows(a + first * n, x, rows, n, result + first);
+    return 0;
+}
+
+int gemv_ssr_frep_omp(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result) {
+#pragma omp parallel
+    {
+        size_t core_num = snrt_cluster_core_num() - 1;
+        size_t core_idx = snrt_cluster_core_idx();
+
+        size_t first;
+        size_t rows = local_range(m, core_idx, core_num, &first);
+        gemv_block_rows(a + first * n, x, rows, n, result + first);
+    }
+
+    return 0;
+}
+
+/*
+ * Naive implementation of the ONNX Gemm operator: result = alpha * op(a) * op(b) + beta * c
+ */
+__attribute__((noinline))
+int gemm_onnx_baseline(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                       int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result) {
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            double acc = 0;
+            for (size_t l = 0; l < n; ++l) {
+                double a_il = trans_a ? a[l * m + i] : a[i * n + l];
+                double b_lj = trans_b ? b[j * n + l] : b[l * k + j];
+                acc += a_il * b_lj;
+            }
+            result[i * k + j] = alpha * acc + (c ? beta * c[i * k + j] : 0.0);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Configures DM0 and DM1 to stream op(a) and op(b) for rows [row, row + rows) of the result
+ * and DM2 to write these rows. The transposes only change the strides.
+ */
+static inline void gemm_onnx_ssr_setup(double* a, double* b, const size_t row, const size_t rows, const size_t m,
+                                       const size_t n, const size_t k, int trans_a, int trans_b, double* result) {
+    size_t a_stride_l = trans_a ? sizeof(*a) * m : sizeof(*a);
+    size_t a_stride_i = trans_a ? sizeof(*a) : sizeof(*a) * n;
+    size_t b_stride_l = trans_b ? sizeof(*b) : sizeof(*b) * k;
+    size_t b_stride_j = trans_b ? sizeof(*b) * n : sizeof(*b);
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM0, n, k, rows, a_stride_l, 0, a_stride_i);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, trans_a ? a + row : a + row * n);
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM1, n, k, rows, b_stride_l, b_stride_j, 0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, b);
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, rows * k, sizeof(*result));
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + row * k);
+}
+
+/*
+ * Computes rows [row, row + rows) of the result with SSR and FREP.
+ * alpha and beta * c are applied with a single fmadd when the result is written back.
+ */
+static inline void gemm_onnx_frep_rows(double* a, double* b, double* c, const size_t row, const size_t rows,
+                                       const size_t m, const size_t n, const size_t k, int trans_a, int trans_b,
+                                       double alpha, double beta, double* __restrict__ result) {
+    if (rows == 0) {
+        return;
+    }
+
+    gemm_onnx_ssr_setup(a, b, row, rows, m, n, k, trans_a, trans_b, result);
+    snrt_ssr_enable();
+
+    for (size_t i = row * k; i < (row + rows) * k; ++i) {
+        volatile register double temp = 0.0;
+        register double bias = c ? beta * c[i] : 0.0;
+        asm volatile(
+            "frep.o %[n], 1, 0, 0\n"
+            "fmadd.d %[temp], ft0, ft1, %[temp] \n"
+            "fmadd.d ft2, %[temp], %[alpha], %[bias]"
+            : [temp] "+f" (temp)
+            : [n] "r"(n-1), [alpha] "f"(alpha), [bias] "f"(bias)
+            : "ft0", "ft1", "ft2"
+        );
+    }
+
+    snrt_ssr_disable();
+}
+
+__attribute__((noinline))
+int gemm_onnx_ssr(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                  int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result) {
+    gemm_onnx_ssr_setup(a, b, 0, m, m, n, k, trans_a, trans_b, result);
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < m * k; ++i) {
+        register double temp = 0.0;
+        register double bias = c ? beta * c[i] : 0.0;
+        for (size_t j = 0; j < n; ++j) {
+            asm volatile(
+                "fmadd.d %[temp], ft0, ft1, %[temp] \n"
+                : [temp] "+f" (temp)
+                :
+                : "ft0", "ft1"
+            );
+        }
+        asm volatile(
+            "fmadd.d ft2, %[temp], %[alpha], %[bias] \n"
+            :
+            : [temp] "f"(temp), [alpha] "f"(alpha), [bias] "f"(bias)
+            : "ft0", "ft2"
+        );
+    }
+
+    snrt_ssr_disable();
+    return 0;
+}
+
+__attribute__((noinline))
+int gemm_onnx_ssr_frep(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                       int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result) {
+    gemm_onnx_frep_rows(a, b, c, 0, m, m, n, k, trans_a, trans_b, alpha, beta, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int gemm_onnx_ssr_frep_parallel(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                                int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t local_m = m / core_num;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    gemm_onnx_frep_rows(a, b, c, local_m * core_idx, local_m, m, n, k, trans_a, trans_b, alpha, beta, result);
+
+    if (core_idx < m - local_m * core_num) {
+        gemm_onnx_frep_rows(a, b, c, core_num * local_m + core_idx, 1, m, n, k, trans_a, trans_b, alpha, beta, result);
+    }
+
+    return 0;
+}
+
+/*
+ * Naive implementation of a batched gemm.
+ * Problem p multiplies a + p * stride_a with b + p * stride_b into result + p * stride_result
+ * (strides in elements).
+ */
+__attribute__((noinline))
+int gemm_batched_baseline(double* a, double* b, const size_t batch, const size_t stride_a, const size_t stride_b,
+                          const size_t stride_result, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    for (size_t p = 0; p < batch; ++p) {
+        gemm_baseline(a + p * stride_a, b + p * stride_b, m, n, k, result + p * stride_result);
+    }
+    return 0;
+}
+
+/*
+ * Computes the problems first, first + step, ... < batch.
+ * The batch is the outermost SSR loop, so the streams are configured once for all problems.
+ */
+static inline void gemm_batched_frep(double* a, double* b, const size_t first, const size_t step, const size_t batch,
+                                     const size_t stride_a, const size_t stride_b, const size_t stride_result,
+                                     const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    if (first >= batch) {
+        return;
+    }
+    size_t problems = (batch - first + step - 1) / step;
+
+    snrt_ssr_loop_4d(SNRT_SSR_DM0, n, k, m, problems, sizeof(*a), 0, sizeof(*a) * n, sizeof(*a) * stride_a * step);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, a + first * stride_a);
+
+    snrt_ssr_loop_4d(SNRT_SSR_DM1, n, k, m, problems, sizeof(*b) * k, sizeof(*b), 0, sizeof(*b) * stride_b * step);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_4D, b + first * stride_b);
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM2, m * k, problems, sizeof(*result), sizeof(*result) * stride_result * step);
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, result + first * stride_result);
+
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < problems * m * k; ++i) {
+        volatile register double temp = 0.0;
+        asm volatile(
+            "frep.o %[n], 1, 0, 0\n"
+            "fmadd.d %[temp], ft0, ft1, %[temp] \n"
+            "fmv.d ft2, %[temp]"
+            : [temp] "+f" (temp)
+            : [n] "r"(n-1)
+            : "ft0", "ft1", "ft2"
+        );
+    }
+
+    snrt_ssr_disable();
+}
+
+__attribute__((noinline))
+int gemm_batched_ssr_frep(double* a, double* b, const size_t batch, const size_t stride_a, const size_t stride_b,
+                          const size_t stride_result, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    gemm_batched_frep(a, b, 0, 1, batch, stride_a, stride_b, stride_result, m, n, k, result);
+    return 0;
+}
+
+/*
+ * Every core computes whole problems (core_idx, core_idx + core_num, ...).
+ */
+__attribute__((noinline))
+int gemm_batched_ssr_frep_parallel(double* a, double* b, const size_t batch, const size_t stride_a, const size_t stride_b,
+                                   const size_t stride_result, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    gemm_batched_frep(a, b, core_idx, core_num, batch, stride_a, stride_b, stride_result, m, n, k, result);
+    return 0;
+}
+
+/*
+ * Computes the tile of the result starting at (row, col) with tile_m rows and tile_k columns.
+ */
+static inline void gemm_tile_frep(double* a, double* b, const size_t row, const size_t col, const size_t tile_m,
+                                  const size_t tile_k, const size_t n, const size_t k, double* __restrict__ result) {
+    snrt_ssr_loop_3d(SNRT_SSR_DM0, n, tile_k, tile_m, sizeof(*a), 0, sizeof(*a) * n);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, a + row * n);
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM1, n, tile_k, tile_m, sizeof(*b) * k, sizeof(*b), 0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, b + col);
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM2, tile_k, tile_m, sizeof(*result), sizeof(*result) * k);
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_2D, result + row * k + col);
+
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < tile_m * tile_k; ++i) {
+        volatile register double temp = 0.0;
+        asm volatile(
+            "frep.o %[n], 1, 0, 0\n"
+            "fmadd.d %[temp], ft0, ft1, %[temp] \n"
+            "fmv.d ft2, %[temp]"
+            : [temp] "+f" (temp)
+            : [n] "r"(n-1)
+            : "ft0", "ft1", "ft2"
+        );
+    }
+
+    snrt_ssr_disable();
+}
+
+/*
+ * Partitions the result into GEMM_TILE_M x GEMM_TILE_K tiles (the last tile row and column may be smaller)
+ * and gives every core a contiguous range of tiles. The ranges differ by at most one tile.
+ */
+__attribute__((noinline))
+int gemm_ssr_frep_tiled_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t tiles_m = (m + GEMM_TILE_M - 1) / GEMM_TILE_M;
+    size_t tiles_k = (k + GEMM_TILE_K - 1) / GEMM_TILE_K;
+    size_t num_tiles = tiles_m * tiles_k;
+
+    // The first 'leftover' cores do one more tile
+    size_t local_tiles = num_tiles / core_num;
+    size_t leftover = num_tiles - local_tiles * core_num;
+    size_t first = core_idx * local_tiles + (core_idx < leftover ? core_idx : leftover);
+    size_t last = first + local_tiles + (core_idx < leftover ? 1 : 0);
+
+    for (size_t t = first; t < last; ++t) {
+        size_t row = (t / tiles_k) * GEMM_TILE_M;
+        size_t col = (t % tiles_k) * GEMM_TILE_K;
+        size_t tile_m = m - row < GEMM_TILE_M ? m - row : GEMM_TILE_M;
+        size_t tile_k = k - col < GEMM_TILE_K ? k - col : GEMM_TILE_K;
+
+        gemm_tile_frep(a, b, row, col, tile_m, tile_k, n, k, result);
+    }
+
+    return 0;
+}
+
+/*
+ * float32 gemm. bt is b transposed (k, n), as with transB in ONNX Gemm.
+ */
+__attribute__((noinline))
+int gemm_baseline_f32(float* a, float* bt, const size_t m, const size_t n, const size_t k, float* __restrict__ result) {
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+            float acc = 0;
+            for (size_t l = 0; l < n; ++l) {
+                acc += a[i * n + l] * bt[j * n + l];
+            }
+            result[i * k + j] = acc;
+        }
+    }
+    return 0;
+}
+
+/*
+ * float32 gemm on packed pairs along n: with bt transposed consecutive elements of a row
+ * of a and of a column of b are adjacent, so one vfmac.s does two multiply accumulates.
+ * The rows of a and bt are only 8 byte aligned if n is even, otherwise the baseline is used.
+ */
+__attribute__((noinline))
+int gemm_ssr_frep_f32(float* a, float* bt, const size_t m, const size_t n, const size_t k, float* __restrict__ result) {
+    size_t pairs = n / 2;
+
+    if (n % 2 || m * k == 0) {
+        return gemm_baseline_f32(a, bt, m, n, k, result);
+    }
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM0, pairs, k, m, sizeof(f32x2_t), 0, sizeof(*a) * n);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, a);
+
+    snrt_ssr_loop_3d(SNRT_SSR_DM1, pairs, k, m, sizeof(f32x2_t), sizeof(*bt) * n, 0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, bt);
+
+    snrt_ssr_enable();
+
+    // The lanes are summed up in asm, so that the compiler cannot place
+    // temporaries into the stream registers while SSR is enabled
+    f32x2_t lanes;
+    for (size_t i = 0; i < m * k; ++i) {
+        asm volatile(
+            "fcvt.d.w ft3, zero \n"
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "vfmac.s ft3, ft0, ft1 \n"
+            "fsd ft3, 0(%[lanes]) \n"
+            "flw ft4, 0(%[lanes]) \n"
+            "flw ft5, 4(%[lanes]) \n"
+            "fadd.s ft4, ft4, ft5 \n"
+            "fsw ft4, 0(%[res]) \n"
+            :
+            : [n_frep] "r"(pairs - 1), [lanes] "r"(&lanes), [res] "r"(result + i)
+            : "ft0", "ft1", "ft3", "ft4", "ft5", "memory"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+    return 0;
+}
+
+#endif // LMQ_HOST
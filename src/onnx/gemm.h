@@ -4,16 +4,76 @@
 
 #include <snrt.h>
 
+/*
+ * Number of outputs the register blocked kernels (gemm_ssr_frep_blocked*) accumulate at once.
+ */
+#define GEMM_BLOCK 4
+
+/*
+ * Tile size (rows x columns of the result) of gemm_ssr_frep_tiled_parallel.
+ */
+#ifndef GEMM_TILE_M
+#define GEMM_TILE_M 2
+#endif
+#ifndef GEMM_TILE_K
+#define GEMM_TILE_K 4
+#endif
+
 int gemm_baseline(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 int gemm_ssr(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 int gemm_ssr_frep(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+int gemm_ssr_frep_blocked(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 
 int gemm_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 int gemm_ssr_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 int gemm_ssr_frep_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+int gemm_ssr_frep_blocked_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+int gemm_ssr_frep_tiled_parallel(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 
 int gemm_omp(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 int gemm_ssr_omp(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 int gemm_ssr_frep_omp(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+int gemm_ssr_frep_blocked_omp(double* a, double* b, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+
+/*
+ * Matrix vector product result = a * x with a (m, n), f.ex. a fully connected layer at batch size 1.
+ * The SSR+FREP versions accumulate GEMM_BLOCK rows at once.
+ */
+int gemv_baseline(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result);
+int gemv_ssr_frep(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result);
+int gemv_ssr_frep_parallel(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result);
+int gemv_ssr_frep_omp(double* a, double* x, const size_t m, const size_t n, double* __restrict__ result);
+
+/*
+ * float32 gemm. bt is b transposed, i.e. (k, n).
+ */
+int gemm_baseline_f32(float* a, float* bt, const size_t m, const size_t n, const size_t k, float* __restrict__ result);
+int gemm_ssr_frep_f32(float* a, float* bt, const size_t m, const size_t n, const size_t k, float* __restrict__ result);
+
+/*
+ * ONNX Gemm: result = alpha * op(a) * op(b) + beta * c
+ * op(a) is (m, n) and op(b) is (n, k). If trans_a is set, a is stored as (n, m), if trans_b
+ * is set, b is stored as (k, n). c is (m, k) or NULL.
+ */
+int gemm_onnx_baseline(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                       int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result);
+int gemm_onnx_ssr(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                  int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result);
+int gemm_onnx_ssr_frep(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                       int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result);
+int gemm_onnx_ssr_frep_parallel(double* a, double* b, double* c, const size_t m, const size_t n, const size_t k,
+                                int trans_a, int trans_b, double alpha, double beta, double* __restrict__ result);
+
+/*
+ * Batched gemm of batch problems (m, n) x (n, k). Problem p reads a + p * stride_a and
+ * b + p * stride_b and writes result + p * stride_result (strides in elements).
+ * The parallel version spreads whole problems over the cores.
+ */
+int gemm_batched_baseline(double* a, double* b, const size_t batch, const size_t stride_a, const size_t stride_b,
+                          const size_t stride_result, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+int gemm_batched_ssr_frep(double* a, double* b, const size_t batch, const size_t stride_a, const size_t stride_b,
+                          const size_t stride_result, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
+int gemm_batched_ssr_frep_parallel(double* a, double* b, const size_t batch, const size_t stride_a, const size_t stride_b,
+                                   const size_t stride_result, const size_t m, const size_t n, const size_t k, double* __restrict__ result);
 
 #endif
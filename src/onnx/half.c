@@ -0,0 +1,253 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "conv.h"
+#include "half.h"
+
+static inline int half_is_storage(half_format_t format) {
+    return format == HALF_FP16 || format == HALF_BF16;
+}
+
+/*
+ * count doubles of scratch in L1, or in global memory if they do not fit. The caller resets *arena to *mark.
+ */
+static double* half_scratch(const size_t count, arena_t** arena, size_t* mark) {
+    *arena = arena_l1();
+    *mark = arena_mark(*arena);
+    double* scratch = arena_alloc(*arena, count, sizeof(double), LMQ_ALIGN_DOUBLE);
+    if (scratch == NULL) {
+        *arena = arena_global();
+        *mark = arena_mark(*arena);
+        scratch = arena_alloc(*arena, count, sizeof(double), LMQ_ALIGN_DOUBLE);
+    }
+    return scratch;
+}
+
+__attribute__((noinline))
+int cast_to_half_baseline(const double* x, const size_t n, half_format_t format, half_t* y) {
+    if (!half_is_storage(format)) {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        y[i] = half_from_double(x[i], format);
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int cast_from_half_baseline(const half_t* x, const size_t n, half_format_t format, double* y) {
+    if (!half_is_storage(format)) {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        y[i] = half_to_double(x[i], format);
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int gemm_half_baseline(const half_t* a, const half_t* bt, const size_t m, const size_t n, const size_t k,
+                       half_format_t format, half_format_t out, void* result) {
+    if (!half_is_storage(format)) {
+        return -1;
+    }
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < k; j++) {
+            double acc = 0.0;
+            for (size_t l = 0; l < n; l++) {
+                acc += half_to_double(a[i * n + l], format) * half_to_double(bt[j * n + l], format);
+            }
+            half_store(result, i * k + j, acc, out);
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int gemm_half_ssr_frep(const half_t* a, const half_t* bt, const size_t m, const size_t n, const size_t k,
+                       half_format_t format, half_format_t out, void* result) {
+    if (!half_is_storage(format)) {
+        return -1;
+    }
+    if (m == 0 || k == 0) {
+        return 0;
+    }
+    if (n == 0) {
+        for (size_t i = 0; i < m * k; i++) {
+            half_store(result, i, 0.0, out);
+        }
+        return 0;
+    }
+
+    // bt, one row of a and one row of the result as doubles
+    arena_t* arena;
+    size_t mark;
+    double* btd = half_scratch(n * k + n + k, &arena, &mark);
+    if (btd == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+    double* row = btd + n * k;
+    double* sums = row + n;
+    cast_from_half_baseline(bt, n * k, format, btd);
+
+    // the row is repeated for every column, bt is read row by row
+    snrt_ssr_loop_2d(SNRT_SSR_DM0, n, k, sizeof(double), 0);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_loop_2d(SNRT_SSR_DM1, n, k, sizeof(double), sizeof(double) * n);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+
+    for (size_t i = 0; i < m; i++) {
+        cast_from_half_baseline(a + i * n, n, format, row);
+
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, row);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, btd);
+        snrt_ssr_enable();
+
+        // The sums are stored in asm, the conversion to out needs FP registers which SSR still maps
+        for (size_t j = 0; j < k; j++) {
+            asm volatile(
+                "fcvt.d.w ft3, zero \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "fmadd.d ft3, ft0, ft1, ft3 \n"
+                "fsd ft3, 0(%[sum]) \n"
+                :
+                : [n_frep] "r"(n - 1), [sum] "r"(sums + j)
+                : "ft0", "ft1", "ft3", "memory"
+            );
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+
+        for (size_t j = 0; j < k; j++) {
+            half_store(result, i * k + j, sums[j], out);
+        }
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+
+#ifdef LMQ_XFDOTP
+__attribute__((noinline))
+int gemm_half_ssr_frep_dotp(const half_t* a, const half_t* bt, const size_t m, const size_t n, const size_t k,
+                            half_format_t format, half_format_t out, void* result) {
+    size_t words = n / 4;
+
+    if (format != HALF_FP16 || n % 4 || n == 0 || m * k == 0) {
+        return gemm_half_ssr_frep(a, bt, m, n, k, format, out, result);
+    }
+
+    // One row of the result as floats
+    arena_t* arena;
+    size_t mark;
+    float* sums = (float*) half_scratch((k + 1) / 2, &arena, &mark);
+    if (sums == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM0, words, k, sizeof(uint64_t), 0);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_loop_2d(SNRT_SSR_DM1, words, k, sizeof(uint64_t), sizeof(*bt) * n);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+
+    f32x2_t lanes;
+    for (size_t i = 0; i < m; i++) {
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, (void*) (a + i * n));
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, (void*) bt);
+        snrt_ssr_enable();
+
+        // Lane 0 accumulates the products of halves 0 and 1 of every word, lane 1 those of halves 2 and 3
+        for (size_t j = 0; j < k; j++) {
+            asm volatile(
+                "fcvt.d.w ft3, zero \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "vfdotpex.s.h ft3, ft0, ft1 \n"
+                "fsd ft3, 0(%[lanes]) \n"
+                "flw ft4, 0(%[lanes]) \n"
+                "flw ft5, 4(%[lanes]) \n"
+                "fadd.s ft4, ft4, ft5 \n"
+                "fsw ft4, 0(%[sum]) \n"
+                :
+                : [n_frep] "r"(words - 1), [lanes] "r"(&lanes), [sum] "r"(sums + j)
+                : "ft0", "ft1", "ft3", "ft4", "ft5", "memory"
+            );
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+
+        for (size_t j = 0; j < k; j++) {
+            half_store(result, i * k + j, sums[j], out);
+        }
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+#endif
+
+__attribute__((noinline))
+int conv2d_half_baseline(const half_t* a, const half_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                         size_t s0, size_t s1, size_t d0, size_t d1, half_format_t format, half_format_t out,
+                         void* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+
+    if (!half_is_storage(format)) {
+        return -1;
+    }
+    for (size_t i = 0; i < outn1; ++i) {
+        for (size_t j = 0; j < outn0; ++j) {
+            double acc = 0;
+            for (size_t k = 0; k < f1; ++k) {
+                for (size_t l = 0; l < f0; ++l) {
+                    acc += half_to_double(a[n0 * (s1 * i + k * d1) + s0 * j + l * d0], format) *
+                           half_to_double(filter[k * f0 + l], format);
+                }
+            }
+            half_store(result, i * outn0 + j, acc, out);
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int conv2d_half_ssr_frep(const half_t* a, const half_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                         size_t s0, size_t s1, size_t d0, size_t d1, half_format_t format, half_format_t out,
+                         void* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    size_t outputs = outn0 * outn1;
+
+    if (!half_is_storage(format)) {
+        return -1;
+    }
+
+    // a, the filter and (unless out is HALF_FP64) the result as doubles
+    arena_t* arena;
+    size_t mark;
+    size_t result_count = out == HALF_FP64 ? 0 : outputs;
+    double* ad = half_scratch(n0 * n1 + f0 * f1 + result_count, &arena, &mark);
+    if (ad == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+    double* fd = ad + n0 * n1;
+    double* rd = out == HALF_FP64 ? (double*) result : fd + f0 * f1;
+
+    cast_from_half_baseline(a, n0 * n1, format, ad);
+    cast_from_half_baseline(filter, f0 * f1, format, fd);
+    int ret = conv2d_ssr_frep(ad, fd, n0, n1, f0, f1, s0, s1, d0, d1, rd);
+
+    if (out != HALF_FP64) {
+        for (size_t i = 0; i < outputs; i++) {
+            half_store(result, i, rd[i], out);
+        }
+    }
+
+    arena_reset(arena, mark);
+    return ret;
+}
@@ -0,0 +1,165 @@
+#ifndef LMQ_HALF_H
+#define LMQ_HALF_H
+
+#include <snrt.h>
+#include <stdint.h>
+
+/*
+ * 16 bit storage of tensors: IEEE binary16 (fp16, 5 exponent and 10 mantissa bits) or bfloat16 (bf16, the upper
+ * half of a float: 8 exponent and 7 mantissa bits), a quarter of the bytes of the doubles of the other kernels.
+ * HALF_FP32 and HALF_FP64 are only output formats of the mixed precision kernels.
+ */
+typedef uint16_t half_t;
+
+typedef enum {
+    HALF_FP16,
+    HALF_BF16,
+    HALF_FP32,
+    HALF_FP64
+} half_format_t;
+
+/*
+ * x of the 16 bit format (HALF_FP16 or HALF_BF16) as a double, which is exact. On the integer core,
+ * so it needs no half precision FPU.
+ */
+static inline double half_to_double(half_t x, half_format_t format) {
+    union {
+        double d;
+        uint64_t u;
+    } v;
+
+    if (format == HALF_BF16) {
+        union {
+            float f;
+            uint32_t u;
+        } f = {.u = (uint32_t) x << 16};
+        return f.f;
+    }
+
+    uint64_t sign = (uint64_t) (x & 0x8000) << 48;
+    uint32_t exponent = (x >> 10) & 0x1f;
+    uint64_t mantissa = x & 0x3ff;
+    if (exponent == 0x1f) {
+        v.u = sign | (0x7ffull << 52) | (mantissa << 42);
+    } else if (exponent == 0) {
+        // zero or subnormal: mantissa * 2^-24
+        double d = (double) mantissa * 0x1p-24;
+        return sign ? -d : d;
+    } else {
+        v.u = sign | ((uint64_t) (exponent - 15 + 1023) << 52) | (mantissa << 42);
+    }
+    return v.d;
+}
+
+/*
+ * x rounded to the nearest value of the 16 bit format (ties to even), overflows to infinity, NaN stays NaN.
+ */
+static inline half_t half_from_double(double x, half_format_t format) {
+    const uint32_t mantissa_bits = format == HALF_BF16 ? 7 : 10;
+    const uint32_t exponent_bits = format == HALF_BF16 ? 8 : 5;
+    const int32_t bias = (1 << (exponent_bits - 1)) - 1;
+    const uint32_t infinity = ((1u << exponent_bits) - 1) << mantissa_bits;
+
+    union {
+        double d;
+        uint64_t u;
+    } v = {.d = x};
+    half_t sign = (v.u >> 48) & 0x8000;
+    int32_t exponent = (v.u >> 52) & 0x7ff;
+    uint64_t mantissa = v.u & ((1ull << 52) - 1);
+
+    if (exponent == 0x7ff) {
+        return sign | infinity | (mantissa ? 1u << (mantissa_bits - 1) : 0);
+    }
+    // The subnormal doubles are far below the smallest subnormal of both formats
+    if (exponent == 0) {
+        return sign;
+    }
+
+    // The target exponent, below 1 the result is subnormal and loses one more bit per step
+    int32_t e = exponent - 1023 + bias;
+    uint32_t shift = 52 - mantissa_bits;
+    if (e <= 0) {
+        shift += 1 - e;
+        e = 0;
+    }
+    if (shift > 53) {
+        return sign;
+    }
+
+    mantissa |= 1ull << 52;
+    uint64_t q = mantissa >> shift;
+    uint64_t rest = mantissa & ((1ull << shift) - 1);
+    uint64_t halfway = 1ull << (shift - 1);
+    if (rest > halfway || (rest == halfway && (q & 1))) {
+        q++;
+    }
+
+    // q has the implicit bit of a normal result, a carry out of the mantissa increments the exponent
+    uint32_t bits = e > 0 ? ((uint32_t) (e - 1) << mantissa_bits) + (uint32_t) q : (uint32_t) q;
+    if (bits >= infinity) {
+        return sign | infinity;
+    }
+    return sign | bits;
+}
+
+/*
+ * Writes value to element i of result in format.
+ */
+static inline void half_store(void* result, size_t i, double value, half_format_t format) {
+    switch (format) {
+    case HALF_FP64:
+        ((double*) result)[i] = value;
+        break;
+    case HALF_FP32:
+        ((float*) result)[i] = (float) value;
+        break;
+    default:
+        ((half_t*) result)[i] = half_from_double(value, format);
+        break;
+    }
+}
+
+/*
+ * ONNX Cast of n doubles to FLOAT16 or BFLOAT16 (format) and back.
+ */
+int cast_to_half_baseline(const double* x, const size_t n, half_format_t format, half_t* y);
+int cast_from_half_baseline(const half_t* x, const size_t n, half_format_t format, double* y);
+
+/*
+ * Mixed precision gemm: result (m, k) = a (m, n) * b (n, k) with a and bt = b transposed (k, n) stored in
+ * format (HALF_FP16 or HALF_BF16) and result written in out (any format), rounded once at the end.
+ * The baseline converts every operand and accumulates in double. The ssr_frep version expands bt and one row
+ * of a at a time into doubles in L1 (global memory if they do not fit, like qlinear_matmul_ssr_frep), so only
+ * the 16 bit operands are moved into the cluster, and accumulates in double like gemm_ssr_frep. The products
+ * of two 16 bit values are exact in a double, so it computes the same sums as the baseline.
+ * They return -1 if format is not a 16 bit format or the scratch can not be allocated.
+ *
+ * With LMQ_XFDOTP (an FPU with the half precision formats and the expanding dot products of the Xfdotp
+ * extension, which the default snitch_cluster configuration has) the dotp version streams the packed fp16
+ * operands (four per 64 bit word) through SSR and accumulates in two float lanes with vfdotpex.s.h, four
+ * multiply accumulates per instruction without expanding. It needs HALF_FP16, n a multiple of 4 and 8 byte
+ * aligned a and bt, otherwise it returns the result of gemm_half_ssr_frep.
+ */
+int gemm_half_baseline(const half_t* a, const half_t* bt, const size_t m, const size_t n, const size_t k,
+                       half_format_t format, half_format_t out, void* result);
+int gemm_half_ssr_frep(const half_t* a, const half_t* bt, const size_t m, const size_t n, const size_t k,
+                       half_format_t format, half_format_t out, void* result);
+#ifdef LMQ_XFDOTP
+int gemm_half_ssr_frep_dotp(const half_t* a, const half_t* bt, const size_t m, const size_t n, const size_t k,
+                            half_format_t format, half_format_t out, void* result);
+#endif
+
+/*
+ * Mixed precision conv2d of a single channel image a of (n1, n0) with a filter of (f1, f0) like conv2d_baseline,
+ * a and filter in format and the result in out. The ssr_frep version expands a and the filter into doubles in
+ * L1 (global memory if they do not fit) and runs conv2d_ssr_frep on them. Returns -1 like gemm_half_*.
+ */
+int conv2d_half_baseline(const half_t* a, const half_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                         size_t s0, size_t s1, size_t d0, size_t d1, half_format_t format, half_format_t out,
+                         void* result);
+int conv2d_half_ssr_frep(const half_t* a, const half_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                         size_t s0, size_t s1, size_t d0, size_t d1, half_format_t format, half_format_t out,
+                         void* result);
+
+#endif
@@ -0,0 +1,159 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "layernorm.h"
+
+__attribute__((noinline))
+int layernorm_baseline(const double* x, size_t rows, size_t cols, const double* scale, const double* bias,
+                       double epsilon, double* result) {
+    for (size_t i = 0; i < rows; i++) {
+        const double* row = x + i * cols;
+        double sum = 0;
+        for (size_t j = 0; j < cols; j++) {
+            sum += row[j];
+        }
+        double mean = sum / cols;
+
+        double square_sum = 0;
+        for (size_t j = 0; j < cols; j++) {
+            square_sum += (row[j] - mean) * (row[j] - mean);
+        }
+        double stddev = sqrt_fast(square_sum / cols + epsilon);
+
+        for (size_t j = 0; j < cols; j++) {
+            result[i * cols + j] = (row[j] - mean) / stddev * scale[j] + bias[j];
+        }
+    }
+    return 0;
+}
+
+/*
+ * Sets *mean and *var to the mean and the variance of the n elements of row.
+ * Every FREP iteration takes two elements, so each of the four accumulators is only updated every sixth instruction.
+ */
+static inline void layernorm_row_stats(const double* row, size_t n, double* mean, double* var) {
+    double shift = row[0];
+    double sum = 0.0;
+    double square_sum = 0.0;
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*row));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, row);
+
+    // The streams of the previous row must not stay active
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, 0, 0);
+    snrt_ssr_loop_1d(SNRT_SSR_DM2, 0, 0);
+
+    snrt_ssr_enable();
+
+    if (n / 2 > 0) {
+        asm volatile(
+            "fcvt.d.w ft3, zero \n"
+            "fcvt.d.w ft4, zero \n"
+            "fcvt.d.w ft5, zero \n"
+            "fcvt.d.w ft6, zero \n"
+            "frep.o %[n_frep], 6, 0, 0 \n"
+            "fsub.d ft7, ft0, %[shift] \n"
+            "fsub.d ft8, ft0, %[shift] \n"
+            "fadd.d ft3, ft3, ft7 \n"
+            "fmadd.d ft5, ft7, ft7, ft5 \n"
+            "fadd.d ft4, ft4, ft8 \n"
+            "fmadd.d ft6, ft8, ft8, ft6 \n"
+            "fadd.d %[s], ft3, ft4 \n"
+            "fadd.d %[q], ft5, ft6 \n"
+            : [s] "=f"(sum), [q] "=f"(square_sum)
+            : [n_frep] "r"(n / 2 - 1), [shift] "f"(shift)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7", "ft8"
+        );
+    }
+    if (n % 2) {
+        asm volatile(
+            "fsub.d ft7, ft0, %[shift] \n"
+            "fadd.d %[s], %[s], ft7 \n"
+            "fmadd.d %[q], ft7, ft7, %[q] \n"
+            : [s] "+f"(sum), [q] "+f"(square_sum)
+            : [shift] "f"(shift)
+            : "ft0", "ft1", "ft2", "ft7"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+
+    double shifted_mean = sum / n;
+    double variance = square_sum / n - shifted_mean * shifted_mean;
+    *mean = shift + shifted_mean;
+    *var = variance > 0.0 ? variance : 0.0;
+}
+
+/*
+ * LayerNormalization of the rows [first, first + count).
+ * ft1 alternates between scale[j] and bias[j]: a 2D pattern (2, cols) whose inner stride is the distance of bias to scale.
+ */
+static inline void layernorm_rows(const double* x, size_t cols, const double* scale, const double* bias,
+                                  double epsilon, size_t first, size_t count, double* result) {
+    if (cols == 0) {
+        return;
+    }
+
+    size_t params_stride = (const char*)bias - (const char*)scale;
+
+    for (size_t i = first; i < first + count; i++) {
+        const double* row = x + i * cols;
+        double mean, var;
+        layernorm_row_stats(row, cols, &mean, &var);
+
+        double inv_stddev = rsqrt_fast(var + epsilon);
+        double shift = -mean * inv_stddev;
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, cols, sizeof(*x));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, row);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM1, 2, cols, params_stride, sizeof(*scale));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, scale);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM2, cols, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + i * cols);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 3, 0, 0 \n"
+            "fmadd.d ft3, ft0, %[inv], %[shift] \n"
+            "fmul.d ft4, ft3, ft1 \n"
+            "fadd.d ft2, ft4, ft1 \n"
+            :
+            : [n_frep] "r"(cols - 1), [inv] "f"(inv_stddev), [shift] "f"(shift)
+            : "ft0", "ft1", "ft2", "ft3", "ft4"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int layernorm_ssr_frep(const double* x, size_t rows, size_t cols, const double* scale, const double* bias,
+                       double epsilon, double* result) {
+    layernorm_rows(x, cols, scale, bias, epsilon, 0, rows, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int layernorm_ssr_frep_parallel(const double* x, size_t rows, size_t cols, const double* scale, const double* bias,
+                                double epsilon, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(rows, core_idx, core_num, &first);
+    layernorm_rows(x, cols, scale, bias, epsilon, first, count, result);
+    return 0;
+}
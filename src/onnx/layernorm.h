@@ -0,0 +1,21 @@
+#ifndef LMQ_LAYERNORM_H
+#define LMQ_LAYERNORM_H
+
+#include <snrt.h>
+
+/*
+ * ONNX LayerNormalization along the last axis of a row major (rows, cols) matrix (axis = -1 with rows
+ * the product of the other dimensions) with the per column scale and bias:
+ * result[i][j] = (x[i][j] - mean_i) / sqrt(var_i + epsilon) * scale[j] + bias[j].
+ * The SSR version gets the mean and the variance of a row in one pass (the sum and the sum of squares
+ * of x - x[i][0] in two accumulators each) and normalizes in a second pass which streams scale and bias
+ * interleaved through a single 2D pattern. The parallel version splits the rows over the compute cores.
+ */
+int layernorm_baseline(const double* x, size_t rows, size_t cols, const double* scale, const double* bias,
+                       double epsilon, double* result);
+int layernorm_ssr_frep(const double* x, size_t rows, size_t cols, const double* scale, const double* bias,
+                       double epsilon, double* result);
+int layernorm_ssr_frep_parallel(const double* x, size_t rows, size_t cols, const double* scale, const double* bias,
+                                double epsilon, double* result);
+
+#endif
@@ -3,6 +3,9 @@
 #include <stdlib.h>
 
 #include "printf.h"
+#include "lmq.h"
+#include "fpmath.h"
+#include "masked_dropout.h"
 #include <math.h>
 
 /*
@@ -98,3 +101,113 @@ int masked_dropout_ssr_frep(const double* arr, const double* mask, const size_t
 
     return 0;
 }
+
+/*
+ * Elements of the expanded mask block which the integer core writes while the FPU works on the previous one.
+ */
+#define MASKED_DROPOUT_BLOCK FPMATH_BLOCK
+
+__attribute__((noinline))
+int masked_dropout_bits_baseline(const double* arr, const uint32_t* mask, const size_t n, const double ratio, double* result) {
+    double scale = 1.0 / (1.0 - ratio);
+
+    for (size_t i = 0; i < n; i++) {
+        result[i] = (mask[i / 32] >> (i % 32)) & 1 ? arr[i] * scale : 0;
+    }
+
+    return 0;
+}
+
+/*
+ * Expands the bits of count elements into scale or 0, assembled from the two words of the double in integer registers.
+ */
+static inline void masked_dropout_expand(uint32_t* expanded, const uint32_t* bits, size_t count,
+                                         uint32_t scale_lo, uint32_t scale_hi) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t keep = -((bits[i / 32] >> (i % 32)) & 1);
+        expanded[2 * i] = scale_lo & keep;
+        expanded[2 * i + 1] = scale_hi & keep;
+    }
+}
+
+/*
+ * Applies the bit packed mask to n elements. As in the counter based dropout the expanded mask blocks are double
+ * buffered in the carry scratch of fpmath, FREP multiplies a block while the integer core expands the next one.
+ */
+static inline void masked_dropout_bits_range(const double* arr, const uint32_t* mask, const size_t n,
+                                             const double ratio, double* result) {
+    union {
+        double value;
+        uint32_t words[2];
+    } scale = { .value = 1.0 / (1.0 - ratio) };
+    double* carry = fpmath_carry();
+    uint32_t* expanded[2] = { (uint32_t*) carry, (uint32_t*) (carry + MASKED_DROPOUT_BLOCK) };
+
+    if (n == 0) {
+        return;
+    }
+
+    masked_dropout_expand(expanded[0], mask, n < MASKED_DROPOUT_BLOCK ? n : MASKED_DROPOUT_BLOCK,
+                          scale.words[0], scale.words[1]);
+
+    for (size_t i = 0, buffer = 0; i < n; i += MASKED_DROPOUT_BLOCK, buffer ^= 1) {
+        size_t count = n - i < MASKED_DROPOUT_BLOCK ? n - i : MASKED_DROPOUT_BLOCK;
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*arr));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) arr + i);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, count, sizeof(double));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, expanded[buffer]);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM2, count, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+        snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_1D, result + i);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "fmul.d ft2, ft0, ft1 \n"
+            :: [n_frep] "r"(count - 1)
+            : "ft0", "ft1", "ft2", "memory"
+        );
+
+        if (i + count < n) {
+            size_t next = n - i - count < MASKED_DROPOUT_BLOCK ? n - i - count : MASKED_DROPOUT_BLOCK;
+            masked_dropout_expand(expanded[buffer ^ 1], mask + (i + count) / 32, next, scale.words[0], scale.words[1]);
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int masked_dropout_bits_ssr_frep(const double* arr, const uint32_t* mask, const size_t n, const double ratio, double* result) {
+    masked_dropout_bits_range(arr, mask, n, ratio, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int masked_dropout_bits_ssr_frep_parallel(const double* arr, const uint32_t* mask, const size_t n, const double ratio,
+                                          double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    // Split at whole mask words so every core starts at bit 0 of its first word
+    size_t first_word;
+    size_t words = local_range((n + 31) / 32, core_idx, core_num, &first_word);
+    if (words == 0) {
+        return 0;
+    }
+    size_t first = first_word * 32;
+    size_t count = n - first < words * 32 ? n - first : words * 32;
+    masked_dropout_bits_range(arr + first, mask + first_word, count, ratio, result + first);
+    return 0;
+}
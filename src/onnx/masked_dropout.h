@@ -10,4 +10,13 @@ int masked_dropout_baseline(const double* arr, const double* mask, const size_t
 int masked_dropout_ssr(const double* arr, const double* mask, const size_t n, const double ratio, double* result);
 int masked_dropout_ssr_frep(const double* arr, const double* mask, const size_t n, const double ratio, double* result);
 
+/*
+ * Masked dropout with the bit packed mask of dropout_counter_mask_*: element i is kept if bit i % 32 of mask[i / 32]
+ * is set. The ssr version expands the bits in integer registers while FREP applies the previous block.
+ */
+int masked_dropout_bits_baseline(const double* arr, const uint32_t* mask, const size_t n, const double ratio, double* result);
+int masked_dropout_bits_ssr_frep(const double* arr, const uint32_t* mask, const size_t n, const double ratio, double* result);
+int masked_dropout_bits_ssr_frep_parallel(const double* arr, const uint32_t* mask, const size_t n, const double ratio,
+                                          double* result);
+
 #endif
\ No newline at end of file
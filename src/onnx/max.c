@@ -1,10 +1,15 @@
-
 #include <snrt.h>
 
 #include <max.h>
 #include <float.h>
 #include <math.h>
 
+#ifndef LMQ_HOST
+#include "reduce.h"
+#include "kernel.h"
+#include "tile.h"
+#endif
+
 /*
  * Naive implementation of max. Calculates the argmax of n elements starting at arr.
  */
@@ -21,6 +26,8 @@ int max_baseline(const double* arr, const size_t n, double* result) {
     return 0;
 }
 
+#ifndef LMQ_HOST
+
 __attribute__((noinline))
 int max_ssr(const double* arr, const size_t n, double* result) {
     register volatile double ft0 asm("ft0");
@@ -90,3 +97,88 @@ int max_ssr_frep(const double* arr, const size_t n, double* result) {
 
     return 0;
 }
+
+/*
+ * max_ssr_frep with REDUCE_ACCUMULATORS staggered accumulators.
+ */
+__attribute__((noinline))
+int max_ssr_frep_staggered(const double* arr, const size_t n, double* result) {
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
+
+    snrt_ssr_enable();
+
+    double max = reduce_max_ssr_frep(n);
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+
+    *result = max;
+
+    return 0;
+}
+
+/*
+ * The parallel versions combine the maxima of the cores with reduce_cluster, the OMP versions with reduce_team.
+ */
+KERNEL_REDUCE_PARALLEL(max_parallel, (const double* arr, const size_t n, double* result), n, REDUCE_MAX, -INFINITY,
+                       max_baseline(arr + first, count, &partial), result)
+KERNEL_REDUCE_PARALLEL(max_ssr_parallel, (const double* arr, const size_t n, double* result), n, REDUCE_MAX, -INFINITY,
+                       max_ssr(arr + first, count, &partial), result)
+KERNEL_REDUCE_PARALLEL(max_ssr_frep_parallel, (const double* arr, const size_t n, double* result), n, REDUCE_MAX,
+                       -INFINITY, max_ssr_frep_staggered(arr + first, count, &partial), result)
+
+KERNEL_REDUCE_OMP(max_omp, (const double* arr, const size_t n, double* result), n, REDUCE_MAX, -INFINITY,
+                  max_baseline(arr + first, count, &partial), result)
+KERNEL_REDUCE_OMP(max_ssr_omp, (const double* arr, const size_t n, double* result), n, REDUCE_MAX, -INFINITY,
+                  max_ssr(arr + first, count, &partial), result)
+KERNEL_REDUCE_OMP(max_ssr_frep_omp, (const double* arr, const size_t n, double* result), n, REDUCE_MAX, -INFINITY,
+                  max_ssr_frep_staggered(arr + first, count, &partial), result)
+
+/*
+ * The DM core fetches the next tile into L1 while the compute cores reduce the current one.
+ */
+__attribute__((noinline))
+int max_ssr_frep_tiled(const double* arr, const size_t n, double* result) {
+    return tile_reduce(max_ssr_frep_staggered, REDUCE_MAX, arr, n, result);
+}
+
+__attribute__((noinline))
+int max_stream_baseline(max_stream_t* state, const double* chunk, const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (chunk[i] > state->max) {
+            state->max = chunk[i];
+        }
+    }
+    state->count += n;
+    return 0;
+}
+
+__attribute__((noinline))
+int max_stream_ssr_frep(max_stream_t* state, const double* chunk, const size_t n) {
+    if (n == 0) {
+        return 0;
+    }
+
+    double max;
+    max_ssr_frep_staggered(chunk, n, &max);
+    state->max = max > state->max ? max : state->max;
+    state->count += n;
+    return 0;
+}
+
+__attribute__((noinline))
+int max_stream_ssr_frep_parallel(max_stream_t* state, const double* chunk, const size_t n) {
+    double max = -INFINITY;
+
+    max_ssr_frep_parallel(chunk, n, &max);
+    if (snrt_cluster_core_idx() == 0) {
+        state->max = max > state->max ? max : state->max;
+        state->count += n;
+    }
+    snrt_cluster_hw_barrier();
+    return 0;
+}
+
+#endif // LMQ_HOST
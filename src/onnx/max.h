@@ -7,12 +7,52 @@
 #include <math.h>
 
 /*
- * Naive implementation of max. Calculates the argmax of n elements starting at arr.
+ * Naive implementation of max. Calculates the max of n elements starting at arr.
  */
-int argmax_baseline(const double* arr, const size_t n, double* result);
+int max_baseline(const double* arr, const size_t n, double* result);
+int max_ssr(const double* arr, const size_t n, double* result);
+int max_ssr_frep(const double* arr, const size_t n, double* result);
 
-int argmax_ssr(const double* arr, const size_t n, double* result);
+/*
+ * Reduces into REDUCE_ACCUMULATORS staggered accumulators (see reduce.h).
+ */
+int max_ssr_frep_staggered(const double* arr, const size_t n, double* result);
+
+/*
+ * Generated by KERNEL_REDUCE_PARALLEL and KERNEL_REDUCE_OMP (src/lmq/kernel.h), core 0 writes the result.
+ * max_ssr_frep_parallel and max_ssr_frep_omp run max_ssr_frep_staggered on every core.
+ */
+int max_parallel(const double* arr, const size_t n, double* result);
+int max_ssr_parallel(const double* arr, const size_t n, double* result);
+int max_ssr_frep_parallel(const double* arr, const size_t n, double* result);
+int max_omp(const double* arr, const size_t n, double* result);
+int max_ssr_omp(const double* arr, const size_t n, double* result);
+int max_ssr_frep_omp(const double* arr, const size_t n, double* result);
+
+/*
+ * Streams arr through L1 in double buffered tiles (src/lmq/tile.h), must be called by all cores of the cluster.
+ */
+int max_ssr_frep_tiled(const double* arr, const size_t n, double* result);
+
+/*
+ * Streaming max over a tensor handed in chunk by chunk (f.ex. as it arrives from the host, the chunks may have
+ * any sizes), so the whole tensor never has to be in memory. state carries the maximum and the number of elements
+ * of the chunks so far, max_stream_init starts a new tensor (the maximum of no elements is -INFINITY).
+ * The parallel version must be called by all cores of the cluster with the same state, core 0 updates it
+ * before the call returns on any core.
+ */
+typedef struct {
+    double max;
+    size_t count;
+} max_stream_t;
+
+static inline void max_stream_init(max_stream_t* state) {
+    state->max = -INFINITY;
+    state->count = 0;
+}
 
-int argmax_ssr_frep(const double* arr, const size_t n, double* result);
+int max_stream_baseline(max_stream_t* state, const double* chunk, const size_t n);
+int max_stream_ssr_frep(max_stream_t* state, const double* chunk, const size_t n);
+int max_stream_ssr_frep_parallel(max_stream_t* state, const double* chunk, const size_t n);
 
 #endif
@@ -1,7 +1,10 @@
 #include "printf.h"
 #include <snrt.h>
 
+#include <math.h>
+
 #include "lmq.h"
+#include "maxpool.h"
 
 size_t pool_output_size(size_t n, size_t filter_size, size_t stride) {
     return 1 + (n - filter_size) / stride;
@@ -68,7 +71,8 @@ __attribute__((noinline))
 int maxpool_ssr_frep(double *a, size_t n, size_t filter_size, size_t stride, double* result) {
     size_t out_size = pool_output_size(n, filter_size, stride);
     if (filter_size == 1) {
-        return 0;
+        // The FREP needs at least two elements per window
+        return maxpool_ssr(a, n, filter_size, stride, result);
     }
     snrt_ssr_loop_2d(SNRT_SSR_DM0, filter_size, out_size, sizeof(*a), sizeof(*a) * stride);
     snrt_ssr_repeat(SNRT_SSR_DM0, 1);
@@ -164,7 +168,8 @@ int maxpool2d_ssr(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t
 __attribute__((noinline))
 int maxpool2d_ssr_frep(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
     if (f0 * f1 == 1) {
-        return 1;
+        // The FREP needs at least two elements per window
+        return maxpool2d_ssr(a, n0, n1, f0, f1, s0, s1, result);
     }
 
     size_t outn0 = pool_output_size(n0, f0, s0);
@@ -194,4 +199,304 @@ int maxpool2d_ssr_frep(double *a, size_t n0, size_t n1, size_t f0, size_t f1, si
 
     snrt_ssr_disable();
     return 0;
-}
\ No newline at end of file
+}
+/*
+ * Gives every core a contiguous range of output rows, the ranges differ by at most one row.
+ * Returns the number of rows and sets first to the first row of the core.
+ */
+static inline size_t maxpool2d_local_rows(size_t outn1, size_t core_idx, size_t core_num, size_t* first) {
+    // The first 'leftover' cores do one more row
+    size_t local_rows = outn1 / core_num;
+    size_t leftover = outn1 - local_rows * core_num;
+    *first = core_idx * local_rows + (core_idx < leftover ? core_idx : leftover);
+    return local_rows + (core_idx < leftover ? 1 : 0);
+}
+
+/*
+ * The parallel maxpool2d variants split the output rows over the compute cores.
+ * A core runs the single core kernel on its output rows plus the halo of f1 - 1 input rows below them.
+ * ret is set to the return code of the kernel.
+ */
+#define MAXPOOL2D_PARALLEL_ROWS(ret, kernel)                                                    \
+    do {                                                                                        \
+        size_t outn0 = pool_output_size(n0, f0, s0);                                            \
+        size_t outn1 = pool_output_size(n1, f1, s1);                                            \
+        size_t first;                                                                           \
+        size_t rows = maxpool2d_local_rows(outn1, core_idx, core_num, &first);                  \
+        if (rows > 0) {                                                                         \
+            size_t local_n1 = (rows - 1) * s1 + f1;                                             \
+            (ret) = kernel(a + first * s1 * n0, n0, local_n1, f0, f1, s0, s1,                   \
+                           result + first * outn0);                                             \
+        }                                                                                       \
+    } while (0)
+
+__attribute__((noinline))
+int maxpool2d_parallel(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    int ret = 0;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    MAXPOOL2D_PARALLEL_ROWS(ret, maxpool2d_baseline);
+    return ret;
+}
+
+__attribute__((noinline))
+int maxpool2d_ssr_frep_parallel(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    int ret = 0;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    MAXPOOL2D_PARALLEL_ROWS(ret, maxpool2d_ssr_frep);
+    return ret;
+}
+
+int maxpool2d_ssr_frep_omp(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result) {
+    int ret = 0;
+#pragma omp parallel
+    {
+        size_t core_num = snrt_cluster_core_num() - 1;
+        size_t core_idx = snrt_cluster_core_idx();
+        int local_ret = 0;
+
+        MAXPOOL2D_PARALLEL_ROWS(local_ret, maxpool2d_ssr_frep);
+        if (local_ret) {
+            ret = local_ret;
+        }
+    }
+
+    return ret;
+}
+
+size_t pool_output_size_onnx(size_t n, size_t filter_size, size_t stride, size_t dilation,
+                             size_t pad_begin, size_t pad_end, int ceil_mode) {
+    size_t effective_filter_size = 1 + (filter_size - 1) * dilation;
+    size_t span = n + pad_begin + pad_end - effective_filter_size;
+    size_t out = 1 + (ceil_mode ? (span + stride - 1) / stride : span / stride);
+
+    // A window has to start in the input or the begin padding
+    if (ceil_mode && (out - 1) * stride >= n + pad_begin) {
+        out--;
+    }
+    return out;
+}
+
+/*
+ * Range [lo, hi) of the taps of the window of output o which are inside the input of n elements.
+ */
+static inline void pool_taps(size_t o, size_t n, size_t f, size_t s, size_t d, size_t pad_begin, size_t* lo, size_t* hi) {
+    long start = (long)(o * s) - (long)pad_begin;
+    long first = start < 0 ? (-start + (long)d - 1) / (long)d : 0;
+    long last = start > (long)n - 1 ? 0 : ((long)n - 1 - start) / (long)d + 1;
+
+    *lo = first;
+    *hi = last < (long)f ? last : (long)f;
+    if (*hi < *lo) {
+        *hi = *lo;
+    }
+}
+
+__attribute__((noinline))
+int maxpool2d_onnx_baseline(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                            size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, int ceil_mode,
+                            double* result, int* indices) {
+    size_t outn0 = pool_output_size_onnx(n0, f0, s0, d0, p0_begin, p0_end, ceil_mode);
+    size_t outn1 = pool_output_size_onnx(n1, f1, s1, d1, p1_begin, p1_end, ceil_mode);
+
+    for (size_t i = 0; i < outn1; ++i) {
+        for (size_t j = 0; j < outn0; ++j) {
+            double max = -INFINITY;
+            int index = -1;
+            for (size_t k = 0; k < f1; ++k) {
+                long row = (long)(i * s1 + k * d1) - (long)p1_begin;
+                for (size_t l = 0; l < f0; ++l) {
+                    long col = (long)(j * s0 + l * d0) - (long)p0_begin;
+                    if (row < 0 || row >= (long)n1 || col < 0 || col >= (long)n0) {
+                        continue;
+                    }
+                    double val = a[row * n0 + col];
+                    if (index < 0 || val > max) {
+                        max = val;
+                        index = row * n0 + col;
+                    }
+                }
+            }
+            result[i * outn0 + j] = max;
+            if (indices) {
+                indices[i * outn0 + j] = index;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Pools the rectangle of rows x cols outputs starting at output (i, j), whose windows all have
+ * the taps [k0_lo, k0_hi) x [k1_lo, k1_hi) inside the input. The SSR pattern only covers these
+ * taps, so the padding is never read.
+ */
+static inline void maxpool2d_onnx_rect(double *a, size_t n0, size_t outn0, size_t s0, size_t s1, size_t d0, size_t d1,
+                                       size_t p0_begin, size_t p1_begin, size_t i, size_t j, size_t rows, size_t cols,
+                                       size_t k0_lo, size_t k0_hi, size_t k1_lo, size_t k1_hi, int use_frep,
+                                       double* result, int* indices) {
+    size_t taps0 = k0_hi - k0_lo;
+    size_t taps = taps0 * (k1_hi - k1_lo);
+    long row0 = (long)(i * s1 + k1_lo * d1) - (long)p1_begin;
+    long col0 = (long)(j * s0 + k0_lo * d0) - (long)p0_begin;
+
+    if (taps == 0) {
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < cols; ++c) {
+                result[(i + r) * outn0 + j + c] = -INFINITY;
+                if (indices) {
+                    indices[(i + r) * outn0 + j + c] = -1;
+                }
+            }
+        }
+        return;
+    }
+
+    snrt_ssr_loop_4d(SNRT_SSR_DM0, taps0, k1_hi - k1_lo, cols, rows,
+        sizeof(*a) * d0, sizeof(*a) * n0 * d1, sizeof(*a) * s0, sizeof(*a) * n0 * s1);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, a + row0 * n0 + col0);
+
+    snrt_ssr_loop_2d(SNRT_SSR_DM1, cols, rows, sizeof(*result), sizeof(*result) * outn0);
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_2D, result + i * outn0 + j);
+
+    snrt_ssr_enable();
+
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            if (indices) {
+                // The index needs a compare and branch per element, so there is no FREP
+                double max, val;
+                size_t best, tap = 1, cmp;
+                asm volatile(
+                    "fmv.d %[max], ft0 \n"
+                    "li %[best], 0 \n"
+                    "1: \n"
+                    "bge %[tap], %[taps], 2f \n"
+                    "fmv.d %[val], ft0 \n"
+                    "flt.d %[cmp], %[max], %[val] \n"
+                    "beqz %[cmp], 3f \n"
+                    "fmv.d %[max], %[val] \n"
+                    "mv %[best], %[tap] \n"
+                    "3: \n"
+                    "addi %[tap], %[tap], 1 \n"
+                    "j 1b \n"
+                    "2: \n"
+                    "fmv.d ft1, %[max] \n"
+                    : [max] "=&f"(max), [val] "=&f"(val), [best] "=&r"(best), [tap] "+r"(tap), [cmp] "=&r"(cmp)
+                    : [taps] "r"(taps)
+                    : "ft0", "ft1", "ft2"
+                );
+                long row = row0 + (long)(r * s1 + (best / taps0) * d1);
+                long col = col0 + (long)(c * s0 + (best % taps0) * d0);
+                indices[(i + r) * outn0 + j + c] = row * n0 + col;
+            } else if (use_frep && taps > 1) {
+                asm volatile(
+                    "fmv.d ft2, ft0 \n"
+                    "frep.o %[n_frep], 1, 0, 0 \n"
+                    "fmax.d ft2, ft2, ft0 \n"
+                    "fmv.d ft1, ft2 \n"
+                    :
+                    : [n_frep] "r"(taps - 2)
+                    : "ft0", "ft1", "ft2"
+                );
+            } else {
+                asm volatile(
+                    "fmv.d ft2, ft0 \n"
+                    :
+                    :
+                    : "ft0", "ft2"
+                );
+                for (size_t t = 1; t < taps; ++t) {
+                    asm volatile(
+                        "fmax.d ft2, ft2, ft0 \n"
+                        :
+                        :
+                        : "ft0", "ft2"
+                    );
+                }
+                asm volatile(
+                    "fmv.d ft1, ft2 \n"
+                    :
+                    :
+                    : "ft1", "ft2"
+                );
+            }
+        }
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+/*
+ * Splits the outputs into rectangles whose windows are clamped to the same taps
+ * (the interior and the border regions) and pools every rectangle with one SSR configuration.
+ */
+static inline int maxpool2d_onnx_regions(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                                         size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, int ceil_mode, int use_frep,
+                                         double* result, int* indices) {
+    size_t outn0 = pool_output_size_onnx(n0, f0, s0, d0, p0_begin, p0_end, ceil_mode);
+    size_t outn1 = pool_output_size_onnx(n1, f1, s1, d1, p1_begin, p1_end, ceil_mode);
+
+    for (size_t i = 0; i < outn1;) {
+        size_t k1_lo, k1_hi, lo, hi;
+        size_t rows = 1;
+        pool_taps(i, n1, f1, s1, d1, p1_begin, &k1_lo, &k1_hi);
+        while (i + rows < outn1) {
+            pool_taps(i + rows, n1, f1, s1, d1, p1_begin, &lo, &hi);
+            if (lo != k1_lo || hi != k1_hi) {
+                break;
+            }
+            rows++;
+        }
+
+        for (size_t j = 0; j < outn0;) {
+            size_t k0_lo, k0_hi;
+            size_t cols = 1;
+            pool_taps(j, n0, f0, s0, d0, p0_begin, &k0_lo, &k0_hi);
+            while (j + cols < outn0) {
+                pool_taps(j + cols, n0, f0, s0, d0, p0_begin, &lo, &hi);
+                if (lo != k0_lo || hi != k0_hi) {
+                    break;
+                }
+                cols++;
+            }
+
+            maxpool2d_onnx_rect(a, n0, outn0, s0, s1, d0, d1, p0_begin, p1_begin, i, j, rows, cols,
+                k0_lo, k0_hi, k1_lo, k1_hi, use_frep, result, indices);
+            j += cols;
+        }
+        i += rows;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int maxpool2d_onnx_ssr(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                       size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, int ceil_mode,
+                       double* result, int* indices) {
+    return maxpool2d_onnx_regions(a, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, p0_end, p1_end, ceil_mode, 0, result, indices);
+}
+
+/*
+ * With indices, the same as maxpool2d_onnx_ssr.
+ */
+__attribute__((noinline))
+int maxpool2d_onnx_ssr_frep(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                            size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, int ceil_mode,
+                            double* result, int* indices) {
+    return maxpool2d_onnx_regions(a, n0, n1, f0, f1, s0, s1, d0, d1, p0_begin, p1_begin, p0_end, p1_end, ceil_mode, 1, result, indices);
+}
@@ -0,0 +1,52 @@
+#ifndef LMQ_MAXPOOL_H
+#define LMQ_MAXPOOL_H
+
+#include <snrt.h>
+
+/*
+ * Number of output elements of a pooling of n elements (no padding, no dilation).
+ */
+size_t pool_output_size(size_t n, size_t filter_size, size_t stride);
+
+int maxpool_baseline(double *a, size_t n, size_t filter_size, size_t stride, double* result);
+int maxpool_ssr(double *a, size_t n, size_t filter_size, size_t stride, double* result);
+int maxpool_ssr_frep(double *a, size_t n, size_t filter_size, size_t stride, double* result);
+
+/*
+ * 2D max pooling of a single channel image a of (n1, n0) with a window of (f1, f0).
+ * Index 0 is the innermost (contiguous) dimension.
+ */
+int maxpool2d_baseline(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+int maxpool2d_ssr(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+int maxpool2d_ssr_frep(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+
+/*
+ * maxpool2d with the output rows split over the compute cores.
+ */
+int maxpool2d_parallel(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+int maxpool2d_ssr_frep_parallel(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+int maxpool2d_ssr_frep_omp(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, double* result);
+
+/*
+ * Number of output elements of an ONNX pooling along one dimension with pads pad_begin and pad_end.
+ * With ceil_mode the last partial window is kept, unless it starts in the end padding.
+ */
+size_t pool_output_size_onnx(size_t n, size_t filter_size, size_t stride, size_t dilation,
+                             size_t pad_begin, size_t pad_end, int ceil_mode);
+
+/*
+ * ONNX MaxPool of a single channel image a of (n1, n0) with dilations d0, d1, pads (p0_begin, p1_begin, p0_end, p1_end)
+ * and ceil_mode. Padded elements are ignored. If indices is not NULL, it gets the flattened index
+ * (row * n0 + column) into a of every maximum (the first one on ties), or -1 if a window only covers padding.
+ */
+int maxpool2d_onnx_baseline(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                            size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, int ceil_mode,
+                            double* result, int* indices);
+int maxpool2d_onnx_ssr(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                       size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, int ceil_mode,
+                       double* result, int* indices);
+int maxpool2d_onnx_ssr_frep(double *a, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1,
+                            size_t p0_begin, size_t p1_begin, size_t p0_end, size_t p1_end, int ceil_mode,
+                            double* result, int* indices);
+
+#endif
@@ -0,0 +1,451 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "conv.h"
+#include "quant.h"
+
+/*
+ * round(v) half to even as fcvt.w.d with the default rounding mode, v is within the int32 range.
+ */
+static inline int32_t quant_round(double v) {
+    int32_t r = (int32_t) v;
+    double frac = v - (double) r;
+    if (frac > 0.5 || (frac == 0.5 && (r & 1))) {
+        r++;
+    } else if (frac < -0.5 || (frac == -0.5 && (r & 1))) {
+        r--;
+    }
+    return r;
+}
+
+__attribute__((noinline))
+int quantize_linear_baseline(const double* x, const size_t n, const double scale, const int32_t zero_point, int8_t* y) {
+    double inv = 1.0 / scale;
+    // clamping before rounding to the integer bounds is the same as saturating after it
+    double low = -128.0 - zero_point;
+    double high = 127.0 - zero_point;
+    for (size_t i = 0; i < n; i++) {
+        double v = x[i] * inv;
+        v = v < low ? low : v > high ? high : v;
+        y[i] = (int8_t) (quant_round(v) + zero_point);
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int quantize_linear_ssr(const double* x, const size_t n, const double scale, const int32_t zero_point, int8_t* y) {
+    double inv = 1.0 / scale;
+    double low = -128.0 - zero_point;
+    double high = 127.0 - zero_point;
+    if (n == 0) {
+        return 0;
+    }
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*x));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) x);
+
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < n; i++) {
+        int32_t q;
+        asm volatile(
+            "fmul.d ft3, ft0, %[inv] \n"
+            "fmax.d ft3, ft3, %[low] \n"
+            "fmin.d ft3, ft3, %[high] \n"
+            "fcvt.w.d %[q], ft3, rne \n"
+            : [q] "=r"(q)
+            : [inv] "f"(inv), [low] "f"(low), [high] "f"(high)
+            : "ft0", "ft3"
+        );
+        y[i] = (int8_t) (q + zero_point);
+    }
+
+    snrt_ssr_disable();
+    return 0;
+}
+
+__attribute__((noinline))
+int quantize_linear_ssr_parallel(const double* x, const size_t n, const double scale, const int32_t zero_point,
+                                 int8_t* y) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t first;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+    size_t count = local_range(n, core_idx, core_num, &first);
+    return quantize_linear_ssr(x + first, count, scale, zero_point, y + first);
+}
+
+__attribute__((noinline))
+int dequantize_linear_baseline(const int8_t* x, const size_t n, const double scale, const int32_t zero_point,
+                               double* y) {
+    for (size_t i = 0; i < n; i++) {
+        y[i] = (double) (x[i] - zero_point) * scale;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int dequantize_linear_ssr(const int8_t* x, const size_t n, const double scale, const int32_t zero_point, double* y) {
+    if (n == 0) {
+        return 0;
+    }
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*y));
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, y);
+
+    snrt_ssr_enable();
+
+    for (size_t i = 0; i < n; i++) {
+        asm volatile(
+            "fcvt.d.w ft3, %[q] \n"
+            "fmul.d ft1, ft3, %[scale] \n"
+            :
+            : [q] "r"((int32_t) x[i] - zero_point), [scale] "f"(scale)
+            : "ft1", "ft3", "memory"
+        );
+    }
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+    return 0;
+}
+
+__attribute__((noinline))
+int dequantize_linear_ssr_parallel(const int8_t* x, const size_t n, const double scale, const int32_t zero_point,
+                                   double* y) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t first;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+    size_t count = local_range(n, core_idx, core_num, &first);
+    return dequantize_linear_ssr(x + first, count, scale, zero_point, y + first);
+}
+
+int qlinear_params(double a_scale, int32_t a_zero_point, double b_scale, int32_t b_zero_point, double y_scale,
+                   int32_t y_zero_point, qlinear_params_t* p) {
+    if (!(a_scale > 0.0) || !(b_scale > 0.0) || !(y_scale > 0.0)) {
+        return -1;
+    }
+
+    // scale = multiplier * 2^-(31 + shift) with the multiplier normalized to [2^30, 2^31)
+    double scale = a_scale * b_scale / y_scale;
+    int32_t shift = 0;
+    while (scale < 0.5 && shift <= 31) {
+        scale *= 2.0;
+        shift++;
+    }
+    while (scale >= 1.0 && shift >= -30) {
+        scale *= 0.5;
+        shift--;
+    }
+    int64_t multiplier = (int64_t) (scale * 2147483648.0 + 0.5);
+    if (multiplier == ((int64_t) 1 << 31)) {
+        multiplier >>= 1;
+        shift--;
+    }
+    if (shift < -30 || shift > 31) {
+        return -1;
+    }
+
+    p->a_zero_point = a_zero_point;
+    p->b_zero_point = b_zero_point;
+    p->y_zero_point = y_zero_point;
+    p->bias = 0;
+    p->multiplier = (int32_t) multiplier;
+    p->shift = shift;
+    return 0;
+}
+
+/*
+ * Rows rows of a times b, into the int32 result32 or requantized into the int8 result8 (the other one is NULL).
+ */
+static void qlinear_matmul_rows(const int8_t* a, const int8_t* b, const size_t rows, const size_t n, const size_t k,
+                                const qlinear_params_t* p, int32_t* result32, int8_t* result8) {
+    const int32_t za = p->a_zero_point;
+    const int32_t zb = p->b_zero_point;
+
+    for (size_t i = 0; i < rows; i++) {
+        const int8_t* row = a + i * n;
+
+        // the zero point of b: sum((a - za) * (b - zb)) = sum((a - za) * b) - zb * sum(a - za)
+        int32_t row_sum = 0;
+        for (size_t q = 0; q < n; q++) {
+            row_sum += row[q] - za;
+        }
+        int32_t offset = -zb * row_sum;
+
+        size_t j = 0;
+        for (; j + QLINEAR_BLOCK <= k; j += QLINEAR_BLOCK) {
+            int32_t acc0 = offset, acc1 = offset, acc2 = offset, acc3 = offset;
+            const int8_t* col = b + j;
+            for (size_t q = 0; q < n; q++, col += k) {
+                int32_t av = row[q] - za;
+                acc0 += av * col[0];
+                acc1 += av * col[1];
+                acc2 += av * col[2];
+                acc3 += av * col[3];
+            }
+            if (result8) {
+                result8[i * k + j] = qlinear_requantize(acc0, p);
+                result8[i * k + j + 1] = qlinear_requantize(acc1, p);
+                result8[i * k + j + 2] = qlinear_requantize(acc2, p);
+                result8[i * k + j + 3] = qlinear_requantize(acc3, p);
+            } else {
+                result32[i * k + j] = acc0;
+                result32[i * k + j + 1] = acc1;
+                result32[i * k + j + 2] = acc2;
+                result32[i * k + j + 3] = acc3;
+            }
+        }
+        for (; j < k; j++) {
+            int32_t acc = offset;
+            for (size_t q = 0; q < n; q++) {
+                acc += (row[q] - za) * b[q * k + j];
+            }
+            if (result8) {
+                result8[i * k + j] = qlinear_requantize(acc, p);
+            } else {
+                result32[i * k + j] = acc;
+            }
+        }
+    }
+}
+
+__attribute__((noinline))
+int matmul_integer_baseline(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                            const qlinear_params_t* p, int32_t* result) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < k; j++) {
+            int32_t acc = 0;
+            for (size_t q = 0; q < n; q++) {
+                acc += (a[i * n + q] - p->a_zero_point) * (b[q * k + j] - p->b_zero_point);
+            }
+            result[i * k + j] = acc;
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int matmul_integer_blocked(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                           const qlinear_params_t* p, int32_t* result) {
+    qlinear_matmul_rows(a, b, m, n, k, p, result, NULL);
+    return 0;
+}
+
+__attribute__((noinline))
+int qlinear_matmul_baseline(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                            const qlinear_params_t* p, int8_t* result) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < k; j++) {
+            int32_t acc = 0;
+            for (size_t q = 0; q < n; q++) {
+                acc += (a[i * n + q] - p->a_zero_point) * (b[q * k + j] - p->b_zero_point);
+            }
+            result[i * k + j] = qlinear_requantize(acc, p);
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int qlinear_matmul_blocked(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                           const qlinear_params_t* p, int8_t* result) {
+    qlinear_matmul_rows(a, b, m, n, k, p, NULL, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int qlinear_matmul_blocked_parallel(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                                    const qlinear_params_t* p, int8_t* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t first;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+    size_t rows = local_range(m, core_idx, core_num, &first);
+    qlinear_matmul_rows(a + first * n, b, rows, n, k, p, NULL, result + first * k);
+    return 0;
+}
+
+/*
+ * count int8 values of x minus zero_point as doubles into y.
+ */
+static inline void qlinear_to_double(const int8_t* x, const size_t count, const int32_t zero_point, double* y) {
+    for (size_t i = 0; i < count; i++) {
+        y[i] = (double) (x[i] - zero_point);
+    }
+}
+
+__attribute__((noinline))
+int qlinear_matmul_ssr_frep(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                            const qlinear_params_t* p, int8_t* result) {
+    if (m == 0 || k == 0) {
+        return 0;
+    }
+    if (n == 0) {
+        for (size_t i = 0; i < m * k; i++) {
+            result[i] = qlinear_requantize(0, p);
+        }
+        return 0;
+    }
+
+    // b and one row of a as doubles, in L1 if they fit
+    arena_t* arena = arena_l1();
+    size_t mark = arena_mark(arena);
+    double* bd = arena_alloc(arena, n * k, sizeof(double), LMQ_ALIGN_DOUBLE);
+    double* row = arena_alloc(arena, n, sizeof(double), LMQ_ALIGN_DOUBLE);
+    if (bd == NULL || row == NULL) {
+        arena_reset(arena, mark);
+        arena = arena_global();
+        mark = arena_mark(arena);
+        bd = arena_alloc(arena, n * k, sizeof(double), LMQ_ALIGN_DOUBLE);
+        row = arena_alloc(arena, n, sizeof(double), LMQ_ALIGN_DOUBLE);
+        if (bd == NULL || row == NULL) {
+            arena_reset(arena, mark);
+            return -1;
+        }
+    }
+    qlinear_to_double(b, n * k, p->b_zero_point, bd);
+
+    // the row is repeated for every column, b is read column by column
+    snrt_ssr_loop_2d(SNRT_SSR_DM0, n, k, sizeof(double), 0);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_loop_2d(SNRT_SSR_DM1, n, k, sizeof(double) * k, sizeof(double));
+    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+
+    for (size_t i = 0; i < m; i++) {
+        qlinear_to_double(a + i * n, n, p->a_zero_point, row);
+
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, row);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, bd);
+        snrt_ssr_enable();
+
+        for (size_t j = 0; j < k; j++) {
+            int32_t acc;
+            asm volatile(
+                "fcvt.d.w ft3, zero \n"
+                "frep.o %[n_frep], 1, 0, 0 \n"
+                "fmadd.d ft3, ft0, ft1, ft3 \n"
+                "fcvt.w.d %[acc], ft3 \n"
+                : [acc] "=r"(acc)
+                : [n_frep] "r"(n - 1)
+                : "ft0", "ft1", "ft3"
+            );
+            // requantized while the FPU starts the next column
+            result[i * k + j] = qlinear_requantize(acc, p);
+        }
+
+        snrt_ssr_disable();
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+
+/*
+ * Output rows rows of the convolution starting at row first, QLINEAR_BLOCK outputs of a row at a time if blocked.
+ */
+static void qlinear_conv2d_rows(const int8_t* a, const int8_t* filter, size_t n0, size_t f0, size_t f1, size_t s0,
+                                size_t s1, size_t d0, size_t d1, size_t outn0, size_t first, size_t rows,
+                                const qlinear_params_t* p, int8_t* result) {
+    const int32_t za = p->a_zero_point;
+    const int32_t zb = p->b_zero_point;
+
+    // sum((a - za) * (w - zb)) = sum(a * (w - zb)) - za * sum(w - zb)
+    int32_t filter_sum = 0;
+    for (size_t i = 0; i < f0 * f1; i++) {
+        filter_sum += filter[i] - zb;
+    }
+    int32_t offset = -za * filter_sum;
+
+    for (size_t i = first; i < first + rows; i++) {
+        const int8_t* top = a + n0 * s1 * i;
+        size_t j = 0;
+        for (; j + QLINEAR_BLOCK <= outn0; j += QLINEAR_BLOCK) {
+            int32_t acc0 = offset, acc1 = offset, acc2 = offset, acc3 = offset;
+            for (size_t k = 0; k < f1; k++) {
+                const int8_t* in = top + n0 * k * d1 + s0 * j;
+                const int8_t* w = filter + k * f0;
+                for (size_t l = 0; l < f0; l++, in += d0) {
+                    int32_t wv = w[l] - zb;
+                    acc0 += in[0] * wv;
+                    acc1 += in[s0] * wv;
+                    acc2 += in[2 * s0] * wv;
+                    acc3 += in[3 * s0] * wv;
+                }
+            }
+            result[i * outn0 + j] = qlinear_requantize(acc0, p);
+            result[i * outn0 + j + 1] = qlinear_requantize(acc1, p);
+            result[i * outn0 + j + 2] = qlinear_requantize(acc2, p);
+            result[i * outn0 + j + 3] = qlinear_requantize(acc3, p);
+        }
+        for (; j < outn0; j++) {
+            int32_t acc = offset;
+            for (size_t k = 0; k < f1; k++) {
+                for (size_t l = 0; l < f0; l++) {
+                    acc += top[n0 * k * d1 + s0 * j + l * d0] * (filter[k * f0 + l] - zb);
+                }
+            }
+            result[i * outn0 + j] = qlinear_requantize(acc, p);
+        }
+    }
+}
+
+__attribute__((noinline))
+int qlinear_conv2d_baseline(const int8_t* a, const int8_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                            size_t s0, size_t s1, size_t d0, size_t d1, const qlinear_params_t* p, int8_t* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+
+    for (size_t i = 0; i < outn1; ++i) {
+        for (size_t j = 0; j < outn0; ++j) {
+            int32_t acc = 0;
+            for (size_t k = 0; k < f1; ++k) {
+                for (size_t l = 0; l < f0; ++l) {
+                    acc += (a[n0 * (s1 * i + k * d1) + s0 * j + l * d0] - p->a_zero_point) *
+                           (filter[k * f0 + l] - p->b_zero_point);
+                }
+            }
+            result[i * outn0 + j] = qlinear_requantize(acc, p);
+        }
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int qlinear_conv2d_blocked(const int8_t* a, const int8_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                           size_t s0, size_t s1, size_t d0, size_t d1, const qlinear_params_t* p, int8_t* result) {
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    qlinear_conv2d_rows(a, filter, n0, f0, f1, s0, s1, d0, d1, outn0, 0, outn1, p, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int qlinear_conv2d_blocked_parallel(const int8_t* a, const int8_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                                    size_t s0, size_t s1, size_t d0, size_t d1, const qlinear_params_t* p,
+                                    int8_t* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t first;
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    size_t rows = local_range(outn1, core_idx, core_num, &first);
+    qlinear_conv2d_rows(a, filter, n0, f0, f1, s0, s1, d0, d1, outn0, first, rows, p, result);
+    return 0;
+}
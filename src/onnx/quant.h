@@ -0,0 +1,94 @@
+#ifndef LMQ_QUANT_H
+#define LMQ_QUANT_H
+
+#include <snrt.h>
+#include <stdint.h>
+
+/*
+ * ONNX QuantizeLinear and DequantizeLinear of int8 tensors with a per tensor scale and zero point:
+ * y = saturate(round(x * (1 / scale)) + zero_point) (rounded half to even) and y = (x - zero_point) * scale.
+ * The ssr versions stream the doubles and round with fcvt.w.d, the parallel versions split the elements among
+ * the compute cores.
+ */
+int quantize_linear_baseline(const double* x, const size_t n, const double scale, const int32_t zero_point, int8_t* y);
+int quantize_linear_ssr(const double* x, const size_t n, const double scale, const int32_t zero_point, int8_t* y);
+int quantize_linear_ssr_parallel(const double* x, const size_t n, const double scale, const int32_t zero_point,
+                                 int8_t* y);
+
+int dequantize_linear_baseline(const int8_t* x, const size_t n, const double scale, const int32_t zero_point, double* y);
+int dequantize_linear_ssr(const int8_t* x, const size_t n, const double scale, const int32_t zero_point, double* y);
+int dequantize_linear_ssr_parallel(const int8_t* x, const size_t n, const double scale, const int32_t zero_point,
+                                   double* y);
+
+/*
+ * Zero points and requantization of QLinearMatMul and QLinearConv: the int32 accumulator of
+ * (a - a_zero_point) * (b - b_zero_point) plus bias is scaled by a_scale * b_scale / y_scale, given as the Q31
+ * multiplier (in [2^30, 2^31)) and a right shift, rounded half up and offset by y_zero_point.
+ */
+typedef struct {
+    int32_t a_zero_point;
+    int32_t b_zero_point;
+    int32_t y_zero_point;
+    int32_t bias;
+    int32_t multiplier;
+    int32_t shift;
+} qlinear_params_t;
+
+/*
+ * Fills p from the scales and zero points, the bias is 0.
+ * Returns -1 if the scale is not positive or a_scale * b_scale / y_scale is not within [2^-32, 2^30).
+ */
+int qlinear_params(double a_scale, int32_t a_zero_point, double b_scale, int32_t b_zero_point, double y_scale,
+                   int32_t y_zero_point, qlinear_params_t* p);
+
+/*
+ * The int8 output of the accumulator acc, applied to every accumulator before it is written.
+ */
+static inline int8_t qlinear_requantize(int32_t acc, const qlinear_params_t* p) {
+    int32_t right = 31 + p->shift;
+    int64_t scaled = ((((int64_t) acc + p->bias) * p->multiplier) + ((int64_t) 1 << (right - 1))) >> right;
+    scaled += p->y_zero_point;
+    return (int8_t) (scaled < -128 ? -128 : scaled > 127 ? 127 : scaled);
+}
+
+/*
+ * ONNX MatMulInteger: a (m x n) times b (n x k) of int8 with the zero points of p into int32 (without the
+ * requantization).
+ *
+ * ONNX QLinearMatMul: the same with the int8 result requantized by p.
+ * The blocked versions run on the integer core and compute QLINEAR_BLOCK columns at once, so every element of a is
+ * loaded once per block. The ssr_frep version converts b (and one row of a at a time) without the zero points into
+ * doubles in a scratch buffer (L1 if it fits) and accumulates on the FPU like gemm_ssr_frep: the products and their
+ * sums are exact integers in a double. It returns -1 if the scratch can not be allocated.
+ * The parallel version splits the rows of the result among the compute cores.
+ */
+#define QLINEAR_BLOCK 4
+
+int matmul_integer_baseline(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                            const qlinear_params_t* p, int32_t* result);
+int matmul_integer_blocked(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                           const qlinear_params_t* p, int32_t* result);
+
+int qlinear_matmul_baseline(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                            const qlinear_params_t* p, int8_t* result);
+int qlinear_matmul_blocked(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                           const qlinear_params_t* p, int8_t* result);
+int qlinear_matmul_ssr_frep(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                            const qlinear_params_t* p, int8_t* result);
+int qlinear_matmul_blocked_parallel(const int8_t* a, const int8_t* b, const size_t m, const size_t n, const size_t k,
+                                    const qlinear_params_t* p, int8_t* result);
+
+/*
+ * ONNX QLinearConv of a single channel image a of (n1, n0) with a filter of (f1, f0), like conv2d_baseline.
+ * The blocked versions compute QLINEAR_BLOCK neighbouring outputs of a row at once, the zero point of a is
+ * taken out of the loop through the sum of the filter. The parallel version splits the output rows.
+ */
+int qlinear_conv2d_baseline(const int8_t* a, const int8_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                            size_t s0, size_t s1, size_t d0, size_t d1, const qlinear_params_t* p, int8_t* result);
+int qlinear_conv2d_blocked(const int8_t* a, const int8_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                           size_t s0, size_t s1, size_t d0, size_t d1, const qlinear_params_t* p, int8_t* result);
+int qlinear_conv2d_blocked_parallel(const int8_t* a, const int8_t* filter, size_t n0, size_t n1, size_t f0, size_t f1,
+                                    size_t s0, size_t s1, size_t d0, size_t d1, const qlinear_params_t* p,
+                                    int8_t* result);
+
+#endif
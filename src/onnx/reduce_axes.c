@@ -0,0 +1,430 @@
+#include "printf.h"
+#include <snrt.h>
+
+#include <math.h>
+
+#include "lmq.h"
+#include "reduce.h"
+#include "reduce_axes.h"
+
+/*
+ * The input viewed as five groups of merged dimensions, innermost first, which are alternating
+ * kept (k) and reduced (r). Any group may be 1. Output (q, c) with q = i_k2 * k1 + i_k1 and c = i_k0
+ * reduces the r0 * r1 elements base[i_r0 * k0 + i_r1 * k0 * r0 * k1] with base at (q, c).
+ */
+typedef struct {
+    size_t k0;
+    size_t r0;
+    size_t k1;
+    size_t r1;
+    size_t k2;
+} reduce_axes_layout_t;
+
+static int reduce_axes_layout(const size_t* shape, size_t ndim, const int* axes, size_t num_axes,
+                              reduce_axes_layout_t* layout) {
+    int reduced[REDUCE_AXES_MAX_DIMS] = {0};
+    size_t groups[5] = {1, 1, 1, 1, 1};
+
+    if (ndim > REDUCE_AXES_MAX_DIMS) {
+        return -1;
+    }
+
+    for (size_t d = 0; d < ndim; d++) {
+        reduced[d] = num_axes == 0;
+    }
+    for (size_t i = 0; i < num_axes; i++) {
+        int axis = axes[i] < 0 ? axes[i] + (int)ndim : axes[i];
+        if (axis < 0 || axis >= (int)ndim) {
+            return -1;
+        }
+        reduced[axis] = 1;
+    }
+
+    // Odd groups are reduced, a change between kept and reduced starts the next group
+    size_t g = 0;
+    for (size_t d = ndim; d-- > 0;) {
+        if ((size_t)reduced[d] != g % 2) {
+            g++;
+        }
+        groups[g] *= shape[d];
+    }
+
+    layout->k0 = groups[0];
+    layout->r0 = groups[1];
+    layout->k1 = groups[2];
+    layout->r1 = groups[3];
+    layout->k2 = groups[4];
+    return 0;
+}
+
+/*
+ * First input element of the output (q, c).
+ */
+static inline double* reduce_axes_base(double* a, const reduce_axes_layout_t* l, size_t q, size_t c) {
+    size_t i_k2 = q / l->k1;
+    size_t i_k1 = q - i_k2 * l->k1;
+    return a + i_k2 * l->k0 * l->r0 * l->k1 * l->r1 + i_k1 * l->k0 * l->r0 + c;
+}
+
+/*
+ * Turns the raw reduction (the sum, the sum of squares or the maximum) of an output into the result.
+ * LogSumExp sums exp(x - max) here, exp is a call and cannot be streamed.
+ */
+static double reduce_axes_finalize(reduce_axes_kind_t kind, double raw, const double* base, const reduce_axes_layout_t* l) {
+    switch (kind) {
+    case REDUCE_AXES_MEAN:
+        return raw / (l->r0 * l->r1);
+    case REDUCE_AXES_L2:
+        return sqrt_fast(raw);
+    case REDUCE_AXES_LOG_SUM_EXP: {
+        double s = 0;
+        for (size_t i = 0; i < l->r1; i++) {
+            for (size_t j = 0; j < l->r0; j++) {
+                s += exp(base[i * l->k0 * l->r0 * l->k1 + j * l->k0] - raw);
+            }
+        }
+        return raw + log(s);
+    }
+    default:
+        return raw;
+    }
+}
+
+__attribute__((noinline))
+int reduce_axes_baseline(reduce_axes_kind_t kind, double* a, const size_t* shape, size_t ndim,
+                         const int* axes, size_t num_axes, double* result) {
+    reduce_axes_layout_t l;
+    if (reduce_axes_layout(shape, ndim, axes, num_axes, &l)) {
+        return -1;
+    }
+
+    int is_max = kind == REDUCE_AXES_MAX || kind == REDUCE_AXES_LOG_SUM_EXP;
+    for (size_t q = 0; q < l.k1 * l.k2; q++) {
+        for (size_t c = 0; c < l.k0; c++) {
+            double* base = reduce_axes_base(a, &l, q, c);
+            double acc = is_max ? -INFINITY : 0.0;
+            for (size_t i = 0; i < l.r1; i++) {
+                for (size_t j = 0; j < l.r0; j++) {
+                    double v = base[i * l.k0 * l.r0 * l.k1 + j * l.k0];
+                    if (is_max) {
+                        acc = v > acc ? v : acc;
+                    } else if (kind == REDUCE_AXES_L2) {
+                        acc += v * v;
+                    } else {
+                        acc += v;
+                    }
+                }
+            }
+            result[q * l.k0 + c] = reduce_axes_finalize(kind, acc, base, &l);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Raw reduction of the n elements streamed through ft0 (and for L2 the same elements through ft1).
+ */
+static inline double reduce_axes_stream(reduce_axes_kind_t kind, size_t n) {
+    switch (kind) {
+    case REDUCE_AXES_MAX:
+    case REDUCE_AXES_LOG_SUM_EXP:
+        return reduce_max_ssr_frep(n);
+    case REDUCE_AXES_L2:
+        return reduce_dot_ssr_frep(n);
+    default:
+        return reduce_sum_ssr_frep(n);
+    }
+}
+
+/*
+ * Raw reduction of REDUCE_ACCUMULATORS neighbouring outputs whose n inputs are streamed interleaved
+ * through ft0 (and ft1 for L2). Every output has its own accumulator, so the chains are independent.
+ */
+static inline void reduce_axes_block(reduce_axes_kind_t kind, size_t n, double* out) {
+    if (kind == REDUCE_AXES_MAX || kind == REDUCE_AXES_LOG_SUM_EXP) {
+        asm volatile(
+            "fmv.d ft3, %[init] \n"
+            "fmv.d ft4, %[init] \n"
+            "fmv.d ft5, %[init] \n"
+            "fmv.d ft6, %[init] \n"
+            "frep.o %[n_frep], 4, 0, 0 \n"
+            "fmax.d ft3, ft0, ft3 \n"
+            "fmax.d ft4, ft0, ft4 \n"
+            "fmax.d ft5, ft0, ft5 \n"
+            "fmax.d ft6, ft0, ft6 \n"
+            "fsd ft3, 0(%[out]) \n"
+            "fsd ft4, 8(%[out]) \n"
+            "fsd ft5, 16(%[out]) \n"
+            "fsd ft6, 24(%[out]) \n"
+            :
+            : [n_frep] "r"(n - 1), [out] "r"(out), [init] "f"(-INFINITY)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "memory"
+        );
+    } else if (kind == REDUCE_AXES_L2) {
+        asm volatile(
+            "fcvt.d.w ft3, zero \n"
+            "fcvt.d.w ft4, zero \n"
+            "fcvt.d.w ft5, zero \n"
+            "fcvt.d.w ft6, zero \n"
+            "frep.o %[n_frep], 4, 0, 0 \n"
+            "fmadd.d ft3, ft0, ft1, ft3 \n"
+            "fmadd.d ft4, ft0, ft1, ft4 \n"
+            "fmadd.d ft5, ft0, ft1, ft5 \n"
+            "fmadd.d ft6, ft0, ft1, ft6 \n"
+            "fsd ft3, 0(%[out]) \n"
+            "fsd ft4, 8(%[out]) \n"
+            "fsd ft5, 16(%[out]) \n"
+            "fsd ft6, 24(%[out]) \n"
+            :
+            : [n_frep] "r"(n - 1), [out] "r"(out)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "memory"
+        );
+    } else {
+        asm volatile(
+            "fcvt.d.w ft3, zero \n"
+            "fcvt.d.w ft4, zero \n"
+            "fcvt.d.w ft5, zero \n"
+            "fcvt.d.w ft6, zero \n"
+            "frep.o %[n_frep], 4, 0, 0 \n"
+            "fadd.d ft3, ft0, ft3 \n"
+            "fadd.d ft4, ft0, ft4 \n"
+            "fadd.d ft5, ft0, ft5 \n"
+            "fadd.d ft6, ft0, ft6 \n"
+            "fsd ft3, 0(%[out]) \n"
+            "fsd ft4, 8(%[out]) \n"
+            "fsd ft5, 16(%[out]) \n"
+            "fsd ft6, 24(%[out]) \n"
+            :
+            : [n_frep] "r"(n - 1), [out] "r"(out)
+            : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "memory"
+        );
+    }
+}
+
+/*
+ * Reduction along the inner dimensions (k0 = 1): one output per row.
+ * Consecutive rows with the same i_k2 are covered by one 3D pattern (r0, r1, rows).
+ */
+static void reduce_axes_inner(reduce_axes_kind_t kind, double* a, const reduce_axes_layout_t* l,
+                              size_t q_first, size_t q_count, double* result) {
+    size_t n = l->r0 * l->r1;
+
+    for (size_t q = q_first; q < q_first + q_count;) {
+        size_t run = l->k1 - q % l->k1;
+        if (run > q_first + q_count - q) {
+            run = q_first + q_count - q;
+        }
+        double* base = reduce_axes_base(a, l, q, 0);
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM0, l->r0, l->r1, run, sizeof(*a), sizeof(*a) * l->r0 * l->k1, sizeof(*a) * l->r0);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, base);
+        if (kind == REDUCE_AXES_L2) {
+            snrt_ssr_loop_3d(SNRT_SSR_DM1, l->r0, l->r1, run, sizeof(*a), sizeof(*a) * l->r0 * l->k1, sizeof(*a) * l->r0);
+            snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+            snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_3D, base);
+        }
+
+        snrt_ssr_enable();
+
+        for (size_t i = 0; i < run; i++) {
+            result[q + i] = reduce_axes_stream(kind, n);
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+
+        q += run;
+    }
+}
+
+/*
+ * Reduction along outer dimensions (k0 > 1): the columns [c_first, c_first + c_count) of every row
+ * are reduced REDUCE_ACCUMULATORS at a time by a 4D pattern (lanes, r0, r1, blocks).
+ * The remaining columns are reduced one by one.
+ */
+static void reduce_axes_outer(reduce_axes_kind_t kind, double* a, const reduce_axes_layout_t* l,
+                              size_t q_first, size_t q_count, size_t c_first, size_t c_count, double* result) {
+    size_t n = l->r0 * l->r1;
+    size_t blocks = c_count / REDUCE_ACCUMULATORS;
+    size_t r0_stride = sizeof(*a) * l->k0;
+    size_t r1_stride = sizeof(*a) * l->k0 * l->r0 * l->k1;
+
+    for (size_t q = q_first; q < q_first + q_count; q++) {
+        double* base = reduce_axes_base(a, l, q, c_first);
+        double* out = result + q * l->k0 + c_first;
+
+        if (blocks > 0) {
+            snrt_ssr_loop_4d(SNRT_SSR_DM0, REDUCE_ACCUMULATORS, l->r0, l->r1, blocks,
+                             sizeof(*a), r0_stride, r1_stride, sizeof(*a) * REDUCE_ACCUMULATORS);
+            snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+            snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, base);
+            if (kind == REDUCE_AXES_L2) {
+                snrt_ssr_loop_4d(SNRT_SSR_DM1, REDUCE_ACCUMULATORS, l->r0, l->r1, blocks,
+                                 sizeof(*a), r0_stride, r1_stride, sizeof(*a) * REDUCE_ACCUMULATORS);
+                snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+                snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_4D, base);
+            }
+
+            snrt_ssr_enable();
+
+            for (size_t b = 0; b < blocks; b++) {
+                reduce_axes_block(kind, n, out + b * REDUCE_ACCUMULATORS);
+            }
+
+            snrt_fpu_fence();
+            snrt_ssr_disable();
+        }
+
+        for (size_t c = blocks * REDUCE_ACCUMULATORS; c < c_count; c++) {
+            snrt_ssr_loop_2d(SNRT_SSR_DM0, l->r0, l->r1, r0_stride, r1_stride);
+            snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+            snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, base + c);
+            if (kind == REDUCE_AXES_L2) {
+                snrt_ssr_loop_2d(SNRT_SSR_DM1, l->r0, l->r1, r0_stride, r1_stride);
+                snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+                snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, base + c);
+            }
+
+            snrt_ssr_enable();
+
+            out[c] = reduce_axes_stream(kind, n);
+
+            snrt_fpu_fence();
+            snrt_ssr_disable();
+        }
+    }
+}
+
+/*
+ * Raw reductions of the outputs (q, c) in the given rows and columns followed by reduce_axes_finalize.
+ */
+static void reduce_axes_outputs(reduce_axes_kind_t kind, double* a, const reduce_axes_layout_t* l,
+                                size_t q_first, size_t q_count, size_t c_first, size_t c_count, double* result) {
+    if (l->k0 == 1) {
+        reduce_axes_inner(kind, a, l, q_first, q_count, result);
+    } else {
+        reduce_axes_outer(kind, a, l, q_first, q_count, c_first, c_count, result);
+    }
+
+    if (kind == REDUCE_AXES_SUM || kind == REDUCE_AXES_MAX) {
+        return;
+    }
+    for (size_t q = q_first; q < q_first + q_count; q++) {
+        for (size_t c = c_first; c < c_first + c_count; c++) {
+            double* out = result + q * l->k0 + c;
+            *out = reduce_axes_finalize(kind, *out, reduce_axes_base(a, l, q, c), l);
+        }
+    }
+}
+
+__attribute__((noinline))
+int reduce_axes_ssr_frep(reduce_axes_kind_t kind, double* a, const size_t* shape, size_t ndim,
+                         const int* axes, size_t num_axes, double* result) {
+    reduce_axes_layout_t l;
+    if (reduce_axes_layout(shape, ndim, axes, num_axes, &l)) {
+        return -1;
+    }
+
+    reduce_axes_outputs(kind, a, &l, 0, l.k1 * l.k2, 0, l.k0, result);
+    return 0;
+}
+
+/*
+ * A reduction to a single output of n contiguous elements. Every core reduces a range and the
+ * partial results are combined with reduce_cluster (LogSumExp needs a second round for the sum).
+ */
+static void reduce_axes_scalar_parallel(reduce_axes_kind_t kind, double* a, size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    int is_max = kind == REDUCE_AXES_MAX || kind == REDUCE_AXES_LOG_SUM_EXP;
+
+    size_t first = 0;
+    size_t local_n = 0;
+    double partial = is_max ? -INFINITY : 0.0;
+    if (!snrt_is_dm_core()) {
+        local_n = local_range(n, core_idx, core_num, &first);
+    }
+    if (local_n > 0) {
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*a));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, a + first);
+        if (kind == REDUCE_AXES_L2) {
+            snrt_ssr_loop_1d(SNRT_SSR_DM1, local_n, sizeof(*a));
+            snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+            snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, a + first);
+        }
+
+        snrt_ssr_enable();
+
+        partial = reduce_axes_stream(kind, local_n);
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+
+    double raw = reduce_cluster(is_max ? REDUCE_MAX : REDUCE_SUM, partial, 0, NULL);
+
+    if (kind != REDUCE_AXES_LOG_SUM_EXP) {
+        if (core_idx == 0) {
+            result[0] = kind == REDUCE_AXES_MEAN ? raw / n : (kind == REDUCE_AXES_L2 ? sqrt_fast(raw) : raw);
+        }
+        return;
+    }
+
+    // Every core needs the maximum for its part of the sum of exp(x - max)
+    if (core_idx == 0) {
+        result[0] = raw;
+    }
+    snrt_cluster_hw_barrier();
+    double max = result[0];
+
+    double s = 0;
+    for (size_t i = first; i < first + local_n; i++) {
+        s += exp(a[i] - max);
+    }
+
+    s = reduce_cluster(REDUCE_SUM, s, 0, NULL);
+    if (core_idx == 0) {
+        result[0] = max + log(s);
+    }
+}
+
+/*
+ * The rows are split over the cores, unless there are enough columns to give every core
+ * at least one block of REDUCE_ACCUMULATORS columns (f.ex. a reduction over the first axis).
+ */
+__attribute__((noinline))
+int reduce_axes_ssr_frep_parallel(reduce_axes_kind_t kind, double* a, const size_t* shape, size_t ndim,
+                                  const int* axes, size_t num_axes, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    reduce_axes_layout_t l;
+    if (reduce_axes_layout(shape, ndim, axes, num_axes, &l)) {
+        return -1;
+    }
+
+    size_t rows = l.k1 * l.k2;
+    if (l.k0 == 1 && rows == 1) {
+        // k1 = 1, so r0 and r1 are contiguous
+        reduce_axes_scalar_parallel(kind, a, l.r0 * l.r1, result);
+        return 0;
+    }
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    if (l.k0 >= REDUCE_ACCUMULATORS * core_num) {
+        size_t c_first;
+        size_t c_count = local_range(l.k0, core_idx, core_num, &c_first);
+        reduce_axes_outputs(kind, a, &l, 0, rows, c_first, c_count, result);
+    } else {
+        size_t q_first;
+        size_t q_count = local_range(rows, core_idx, core_num, &q_first);
+        reduce_axes_outputs(kind, a, &l, q_first, q_count, 0, l.k0, result);
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef LMQ_REDUCE_AXES_H
+#define LMQ_REDUCE_AXES_H
+
+#include <snrt.h>
+
+/*
+ * Maximal number of dimensions of the input of reduce_axes_*.
+ */
+#define REDUCE_AXES_MAX_DIMS 4
+
+/*
+ * ONNX ReduceSum, ReduceMean, ReduceMax, ReduceL2 and ReduceLogSumExp.
+ */
+typedef enum {
+    REDUCE_AXES_SUM,
+    REDUCE_AXES_MEAN,
+    REDUCE_AXES_MAX,
+    REDUCE_AXES_L2,
+    REDUCE_AXES_LOG_SUM_EXP
+} reduce_axes_kind_t;
+
+/*
+ * Reduces the row major tensor a of shape (shape[0], ..., shape[ndim - 1]) along the num_axes axes
+ * (negative axes count from the back, no axes reduce all of them, as in ONNX).
+ * result holds the non-reduced dimensions in their order, which is the same for keepdims 0 and 1.
+ * Returns -1 if ndim > REDUCE_AXES_MAX_DIMS or an axis is out of range.
+ * The parallel version splits the non-reduced dimensions over the compute cores (or, for a reduction
+ * to a scalar, the elements) and must be called by all cores of the cluster.
+ */
+int reduce_axes_baseline(reduce_axes_kind_t kind, double* a, const size_t* shape, size_t ndim,
+                         const int* axes, size_t num_axes, double* result);
+int reduce_axes_ssr_frep(reduce_axes_kind_t kind, double* a, const size_t* shape, size_t ndim,
+                         const int* axes, size_t num_axes, double* result);
+int reduce_axes_ssr_frep_parallel(reduce_axes_kind_t kind, double* a, const size_t* shape, size_t ndim,
+                                  const int* axes, size_t num_axes, double* result);
+
+#endif
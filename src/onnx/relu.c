@@ -1,13 +1,88 @@
 #include "printf.h"
 #include <snrt.h>
+#include <math.h>
 
 #include "lmq.h"
+#include "kernel.h"
+#include "tile.h"
+#include "broadcast.h"
+#include "relu.h"
 
 /*
- * Naive implementation of add. Adds a and b element wise into result.
+ * relu(x) = max(x, 0).
  */
+KERNEL_UNARY(relu, x > 0 ? x : 0.0, 1,
+    "fmax.d ft2, ft0, %[zero] \n")
+
+/*
+ * leakyrelu(x) = max(x, 0) + alpha * min(x, 0), which needs no branch for any alpha and thus works with frep.
+ */
+KERNEL_UNARY_SCALAR(leakyrelu, x > 0 ? x : alpha * x, 4,
+    "fmv.d ft3, ft0 \n"
+    "fmin.d ft4, ft3, %[zero] \n"
+    "fmax.d ft3, ft3, %[zero] \n"
+    "fmadd.d ft2, ft4, %[alpha], ft3 \n")
+
+/*
+ * clip(x) = min(max(x, alpha), beta), alpha and beta are the ONNX min and max.
+ */
+KERNEL_UNARY_SCALARS(clip, fmin(fmax(x, alpha), beta), 2,
+    "fmax.d ft3, ft0, %[alpha] \n"
+    "fmin.d ft2, ft3, %[beta] \n")
+
+/*
+ * hardsigmoid(x) = max(0, min(1, alpha * x + beta)), the multiply and add are one fmadd.
+ */
+KERNEL_UNARY_SCALARS(hardsigmoid, fmax(0.0, fmin(1.0, alpha * x + beta)), 3,
+    "fmadd.d ft3, ft0, %[alpha], %[beta] \n"
+    "fmin.d ft3, ft3, %[one] \n"
+    "fmax.d ft2, ft3, %[zero] \n")
+
+/*
+ * PRelu needs the slope to broadcast to x without growing it (ONNX unidirectional broadcasting).
+ */
+static int prelu_check(const size_t* x_shape, size_t x_ndim, const size_t* slope_shape, size_t slope_ndim) {
+    if (slope_ndim > x_ndim) {
+        return -1;
+    }
+    for (size_t d = 0; d < slope_ndim; d++) {
+        size_t slope_dim = slope_shape[slope_ndim - 1 - d];
+        if (slope_dim != 1 && slope_dim != x_shape[x_ndim - 1 - d]) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+#define PRELU(suffix)                                                                       \
+    __attribute__((noinline))                                                               \
+    int prelu##suffix(double* x, const size_t* x_shape, size_t x_ndim,                      \
+                      double* slope, const size_t* slope_shape, size_t slope_ndim, double* result) { \
+        if (prelu_check(x_shape, x_ndim, slope_shape, slope_ndim)) {                        \
+            return -1;                                                                      \
+        }                                                                                   \
+        return broadcast##suffix(BROADCAST_PRELU, x, x_shape, x_ndim, slope, slope_shape, slope_ndim, result); \
+    }
+
+PRELU(_baseline)
+PRELU(_ssr)
+PRELU(_ssr_frep)
+PRELU(_parallel)
+PRELU(_ssr_frep_parallel)
+PRELU(_omp)
+PRELU(_ssr_frep_omp)
+
+/*
+ * Streams x through L1 in double buffered tiles (moved by the DM core)
+ * while the compute cores run leakyrelu_ssr on the current tile.
+ */
+__attribute__((noinline))
+int leakyrelu_ssr_tiled(double *x, const size_t n, double alpha, double* result) {
+    return tile_unary_scalar(leakyrelu_ssr, x, n, alpha, result);
+}
+
 __attribute__((noinline))
-int leakyrelu_baseline(double *x,  const size_t n, double alpha, double* result) {
+int leakyrelu_baseline_f32(float *x, const size_t n, float alpha, float* result) {
     for (size_t i = 0; i < n; i++) {
         if(x[i] > 0){
             result[i] = x[i];
@@ -18,45 +93,46 @@ int leakyrelu_baseline(double *x,  const size_t n, double alpha, double* result)
     return 0;
 }
 
-
+/*
+ * float32 leakyrelu on packed pairs. For 0 <= alpha <= 1 leakyrelu(x) = max(x, alpha * x),
+ * which needs no branch and thus works with frep. DM0 repeats every pair as it is read twice.
+ * Other values of alpha fall back to the baseline.
+ */
 __attribute__((noinline))
-int leakyrelu_ssr(double *x, const size_t n, double alpha, double* result) {
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*x));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, x);
-
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
-
-    snrt_ssr_enable();
-
-    asm volatile(
-        "beqz %[n_rep], 3f \n"
-        "fmv.w.x ft4, zero \n"
-        "fcvt.d.s ft3, ft4 \n"
-        "2: \n"
-        "fmv.d ft2, ft0 \n"
-        "flt.d t0, ft2, ft3 \n"
-        "beqz t0, 1f \n"
-        "fmul.d ft2, ft2, %[alpha] \n"
-        "1: \n"
-        "fmv.d ft1, ft2 \n"
-        "addi %[n_rep], %[n_rep], -1 \n"
-        "bgtz %[n_rep], 2b \n"
-        "3: \n"
-        :: [n_rep] "r"(n), [alpha] "f"(alpha) : "ft0", "ft1", "ft2", "ft3", "t0"
-    );
-
-    snrt_ssr_disable();
+int leakyrelu_ssr_frep_f32(float *x, const size_t n, float alpha, float* result) {
+    size_t pairs = n / 2;
 
-    return 0;
-}
+    if (alpha < 0.0f || alpha > 1.0f) {
+        return leakyrelu_baseline_f32(x, n, alpha, result);
+    }
 
-__attribute__((noinline))
-int leakyrelu_ssr_frep(double *x, const size_t n, double alpha, double* result) {
-    (void)x, (void)n, (void) alpha, (void) result;
-    // Not possible with frep
+    if (pairs > 0) {
+        f32x2_t alphas = { .f = { alpha, alpha } };
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, pairs, sizeof(f32x2_t));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 2);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, x);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, pairs, sizeof(f32x2_t));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 2, 0, 0 \n"
+            "vfmul.s ft3, ft0, %[alpha] \n"
+            "vfmax.s ft1, ft0, ft3 \n"
+            :: [n_frep] "r"(pairs - 1), [alpha] "f"(alphas.d) : "ft0", "ft1", "ft3"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+
+    if (n % 2) {
+        result[n - 1] = x[n - 1] > 0 ? x[n - 1] : alpha * x[n - 1];
+    }
 
     return 0;
-}
\ No newline at end of file
+}
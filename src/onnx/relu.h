@@ -3,8 +3,77 @@
 
 #include <snrt.h>
 
+/*
+ * Generated by KERNEL_UNARY and KERNEL_UNARY_SCALAR (src/lmq/kernel.h).
+ */
+int relu_baseline(double *arr, const size_t n, double *result);
+int relu_ssr(double *arr, const size_t n, double *result);
+int relu_ssr_frep(double *arr, const size_t n, double *result);
+int relu_parallel(double *arr, const size_t n, double *result);
+int relu_ssr_parallel(double *arr, const size_t n, double *result);
+int relu_ssr_frep_parallel(double *arr, const size_t n, double *result);
+int relu_omp(double *arr, const size_t n, double *result);
+int relu_ssr_omp(double *arr, const size_t n, double *result);
+int relu_ssr_frep_omp(double *arr, const size_t n, double *result);
+
 int leakyrelu_baseline(double *arr, const size_t n, double alpha, double *result);
 int leakyrelu_ssr(double *arr, const size_t n, double alpha, double *result);
 int leakyrelu_ssr_frep(double *arr, const size_t n, double alpha, double *result);
+int leakyrelu_parallel(double *arr, const size_t n, double alpha, double *result);
+int leakyrelu_ssr_parallel(double *arr, const size_t n, double alpha, double *result);
+int leakyrelu_ssr_frep_parallel(double *arr, const size_t n, double alpha, double *result);
+int leakyrelu_omp(double *arr, const size_t n, double alpha, double *result);
+int leakyrelu_ssr_omp(double *arr, const size_t n, double alpha, double *result);
+int leakyrelu_ssr_frep_omp(double *arr, const size_t n, double alpha, double *result);
+
+/*
+ * ONNX Clip of x to [lo, hi] (hi if lo > hi) and HardSigmoid max(0, min(1, alpha * x + beta)),
+ * ONNX uses alpha = 0.2 and beta = 0.5 by default. Generated by KERNEL_UNARY_SCALARS.
+ */
+int clip_baseline(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_ssr(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_ssr_frep(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_parallel(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_ssr_parallel(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_ssr_frep_parallel(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_omp(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_ssr_omp(double *arr, const size_t n, double lo, double hi, double *result);
+int clip_ssr_frep_omp(double *arr, const size_t n, double lo, double hi, double *result);
+
+int hardsigmoid_baseline(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_ssr(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_ssr_frep(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_parallel(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_ssr_parallel(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_ssr_frep_parallel(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_omp(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_ssr_omp(double *arr, const size_t n, double alpha, double beta, double *result);
+int hardsigmoid_ssr_frep_omp(double *arr, const size_t n, double alpha, double beta, double *result);
+
+/*
+ * ONNX PRelu: x where x >= 0, slope * x otherwise. slope broadcasts to the shape of x (f.ex. one slope per
+ * channel of shape (C, 1, 1) for x of shape (N, C, H, W)) and is streamed with zero strides, see broadcast_* in
+ * src/onnx/broadcast.h (which also splits the work of the parallel and omp versions).
+ * Returns -1 if slope does not broadcast to x.
+ */
+int prelu_baseline(double *x, const size_t *x_shape, size_t x_ndim,
+                   double *slope, const size_t *slope_shape, size_t slope_ndim, double *result);
+int prelu_ssr(double *x, const size_t *x_shape, size_t x_ndim,
+              double *slope, const size_t *slope_shape, size_t slope_ndim, double *result);
+int prelu_ssr_frep(double *x, const size_t *x_shape, size_t x_ndim,
+                   double *slope, const size_t *slope_shape, size_t slope_ndim, double *result);
+int prelu_parallel(double *x, const size_t *x_shape, size_t x_ndim,
+                   double *slope, const size_t *slope_shape, size_t slope_ndim, double *result);
+int prelu_ssr_frep_parallel(double *x, const size_t *x_shape, size_t x_ndim,
+                            double *slope, const size_t *slope_shape, size_t slope_ndim, double *result);
+int prelu_omp(double *x, const size_t *x_shape, size_t x_ndim,
+              double *slope, const size_t *slope_shape, size_t slope_ndim, double *result);
+int prelu_ssr_frep_omp(double *x, const size_t *x_shape, size_t x_ndim,
+                       double *slope, const size_t *slope_shape, size_t slope_ndim, double *result);
+
+int leakyrelu_ssr_tiled(double *arr, const size_t n, double alpha, double *result);
+
+int leakyrelu_baseline_f32(float *arr, const size_t n, float alpha, float *result);
+int leakyrelu_ssr_frep_f32(float *arr, const size_t n, float alpha, float *result);
 
 #endif
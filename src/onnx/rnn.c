@@ -0,0 +1,601 @@
+#include <snrt.h>
+
+#include <math.h>
+
+#include "lmq.h"
+#include "gemm.h"
+#include "reduce.h"
+#include "rnn.h"
+
+static inline double rnn_sigmoid(double v) {
+    return 1.0 / (1.0 + exp(-v));
+}
+
+__attribute__((noinline))
+int lstm_baseline(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                  const double* initial_c, size_t seq, size_t batch, size_t input, size_t hidden,
+                  double* y, double* y_h, double* y_c) {
+    size_t rows = 4 * hidden;
+
+    arena_t* arena = arena_global();
+    size_t mark = arena_mark(arena);
+    double* h = arena_alloc(arena, 2 * hidden + rows, sizeof(double), LMQ_ALIGN_DOUBLE);
+    if (h == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+    double* c = h + hidden;
+    double* gates = c + hidden;
+
+    for (size_t n = 0; n < batch; n++) {
+        for (size_t j = 0; j < hidden; j++) {
+            h[j] = initial_h ? initial_h[n * hidden + j] : 0.0;
+            c[j] = initial_c ? initial_c[n * hidden + j] : 0.0;
+        }
+
+        for (size_t t = 0; t < seq; t++) {
+            const double* xt = x + (t * batch + n) * input;
+            for (size_t k = 0; k < rows; k++) {
+                double acc = b ? b[k] + b[rows + k] : 0.0;
+                for (size_t e = 0; e < input; e++) {
+                    acc += w[k * input + e] * xt[e];
+                }
+                for (size_t e = 0; e < hidden; e++) {
+                    acc += r[k * hidden + e] * h[e];
+                }
+                gates[k] = k < 3 * hidden ? rnn_sigmoid(acc) : tanh(acc);
+            }
+
+            for (size_t j = 0; j < hidden; j++) {
+                c[j] = gates[2 * hidden + j] * c[j] + gates[j] * gates[3 * hidden + j];
+                h[j] = gates[hidden + j] * tanh(c[j]);
+                if (y) {
+                    y[(t * batch + n) * hidden + j] = h[j];
+                }
+            }
+        }
+
+        for (size_t j = 0; j < hidden; j++) {
+            if (y_h) {
+                y_h[n * hidden + j] = h[j];
+            }
+            if (y_c) {
+                y_c[n * hidden + j] = c[j];
+            }
+        }
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+
+__attribute__((noinline))
+int gru_baseline(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                 size_t seq, size_t batch, size_t input, size_t hidden, int linear_before_reset,
+                 double* y, double* y_h) {
+    size_t rows = 3 * hidden;
+
+    arena_t* arena = arena_global();
+    size_t mark = arena_mark(arena);
+    double* h = arena_alloc(arena, 2 * hidden + 2 * rows, sizeof(double), LMQ_ALIGN_DOUBLE);
+    if (h == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+    double* rh = h + hidden;
+    double* gx = rh + hidden;
+    double* gh = gx + rows;
+
+    for (size_t n = 0; n < batch; n++) {
+        for (size_t j = 0; j < hidden; j++) {
+            h[j] = initial_h ? initial_h[n * hidden + j] : 0.0;
+        }
+
+        for (size_t t = 0; t < seq; t++) {
+            const double* xt = x + (t * batch + n) * input;
+            // w x + wb and r h + rb of every gate
+            for (size_t k = 0; k < rows; k++) {
+                gx[k] = b ? b[k] : 0.0;
+                gh[k] = b ? b[rows + k] : 0.0;
+                for (size_t e = 0; e < input; e++) {
+                    gx[k] += w[k * input + e] * xt[e];
+                }
+                for (size_t e = 0; e < hidden; e++) {
+                    gh[k] += r[k * hidden + e] * h[e];
+                }
+            }
+
+            if (!linear_before_reset) {
+                for (size_t j = 0; j < hidden; j++) {
+                    rh[j] = rnn_sigmoid(gx[hidden + j] + gh[hidden + j]) * h[j];
+                }
+                for (size_t j = 0; j < hidden; j++) {
+                    gh[2 * hidden + j] = b ? b[rows + 2 * hidden + j] : 0.0;
+                    for (size_t e = 0; e < hidden; e++) {
+                        gh[2 * hidden + j] += r[(2 * hidden + j) * hidden + e] * rh[e];
+                    }
+                }
+            }
+
+            for (size_t j = 0; j < hidden; j++) {
+                double z = rnn_sigmoid(gx[j] + gh[j]);
+                double rt = rnn_sigmoid(gx[hidden + j] + gh[hidden + j]);
+                double candidate = linear_before_reset ? tanh(gx[2 * hidden + j] + rt * gh[2 * hidden + j])
+                                                       : tanh(gx[2 * hidden + j] + gh[2 * hidden + j]);
+                h[j] = (1.0 - z) * candidate + z * h[j];
+            }
+
+            for (size_t j = 0; y && j < hidden; j++) {
+                y[(t * batch + n) * hidden + j] = h[j];
+            }
+        }
+
+        for (size_t j = 0; y_h && j < hidden; j++) {
+            y_h[n * hidden + j] = h[j];
+        }
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+
+/*
+ * Activation of the gate rows of rnn_gemv.
+ */
+typedef enum {
+    RNN_ACT_NONE,
+    RNN_ACT_SIGMOID,
+    RNN_ACT_TANH,
+} rnn_act_t;
+
+static inline double rnn_activation(double v, rnn_act_t act) {
+    switch (act) {
+    case RNN_ACT_SIGMOID:
+        return rnn_sigmoid(v);
+    case RNN_ACT_TANH:
+        return tanh(v);
+    default:
+        return v;
+    }
+}
+
+/*
+ * out = act(w x + bias) for rows rows of n elements of w, which are lda elements apart. GEMM_BLOCK rows share one
+ * FREP body with their accumulators initialised with the bias. The accumulators are moved out of the stream
+ * registers and activated before they are written, exp and tanh are calls so the streams are disabled meanwhile.
+ */
+static void rnn_gemv(const double* w, size_t lda, const double* x, size_t rows, size_t n, const double* bias,
+                     rnn_act_t act, double* out) {
+    size_t blocks = rows / GEMM_BLOCK;
+
+    if (n == 0) {
+        for (size_t i = 0; i < rows; i++) {
+            out[i] = rnn_activation(bias[i], act);
+        }
+        return;
+    }
+
+    if (blocks > 0) {
+        snrt_ssr_loop_3d(SNRT_SSR_DM0, GEMM_BLOCK, n, blocks,
+            sizeof(*w) * lda, sizeof(*w), sizeof(*w) * lda * GEMM_BLOCK);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, (double*) w);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM1, n, blocks, sizeof(*x), 0);
+        snrt_ssr_repeat(SNRT_SSR_DM1, GEMM_BLOCK);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_2D, (double*) x);
+
+        snrt_ssr_enable();
+
+        for (size_t i = 0; i < blocks; i++) {
+            const double* bi = bias + i * GEMM_BLOCK;
+            double v[GEMM_BLOCK];
+            asm volatile(
+                "fmv.d ft3, %[b0] \n"
+                "fmv.d ft4, %[b1] \n"
+                "fmv.d ft5, %[b2] \n"
+                "fmv.d ft6, %[b3] \n"
+                "frep.o %[n_frep], 4, 0, 0 \n"
+                "fmadd.d ft3, ft0, ft1, ft3 \n"
+                "fmadd.d ft4, ft0, ft1, ft4 \n"
+                "fmadd.d ft5, ft0, ft1, ft5 \n"
+                "fmadd.d ft6, ft0, ft1, ft6 \n"
+                "fmv.d %[v0], ft3 \n"
+                "fmv.d %[v1], ft4 \n"
+                "fmv.d %[v2], ft5 \n"
+                "fmv.d %[v3], ft6 \n"
+                : [v0] "=f"(v[0]), [v1] "=f"(v[1]), [v2] "=f"(v[2]), [v3] "=f"(v[3])
+                : [n_frep] "r"(n - 1), [b0] "f"(bi[0]), [b1] "f"(bi[1]), [b2] "f"(bi[2]), [b3] "f"(bi[3])
+                : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6"
+            );
+
+            if (act != RNN_ACT_NONE) {
+                snrt_fpu_fence();
+                snrt_ssr_disable();
+                for (size_t k = 0; k < GEMM_BLOCK; k++) {
+                    v[k] = rnn_activation(v[k], act);
+                }
+                snrt_ssr_enable();
+            }
+            for (size_t k = 0; k < GEMM_BLOCK; k++) {
+                out[i * GEMM_BLOCK + k] = v[k];
+            }
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+
+    for (size_t i = blocks * GEMM_BLOCK; i < rows; i++) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*w));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) w + i * lda);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*x));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, (double*) x);
+
+        snrt_ssr_enable();
+
+        double acc = reduce_dot_ssr_frep(n);
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+
+        out[i] = rnn_activation(acc + bias[i], act);
+    }
+}
+
+/*
+ * The buffers of the ssr_frep versions. wr is (gates * hidden, lda) with lda = input + hidden, the row k is
+ * w[k] followed by r[k]. bias holds the summed wb + rb of the LSTM gates; for a GRU the summed wb + rb of z and r,
+ * then wb_h and rb_h, which are added on different sides of the reset gate. The gates have the same layout.
+ * xh[t % 2] is x_t followed by h_{t-1}, while the other one receives x_{t+1} and h_t.
+ */
+typedef struct {
+    const double* x;
+    double* y;
+    size_t batch;
+    size_t input;
+    size_t hidden;
+    size_t lda;
+
+    double* wr;
+    double* bias;
+    double* xh[2];
+    double* gates;
+    double* c;
+    double* rh;
+} rnn_t;
+
+// Number of doubles of the buffers of a cell with gates gates
+static inline size_t rnn_len(size_t gates, size_t input, size_t hidden) {
+    size_t lda = input + hidden;
+    return gates * hidden * lda + 2 * lda + 9 * hidden;
+}
+
+static inline rnn_t rnn_buffers(double* mem, size_t gates, const double* x, double* y, size_t batch, size_t input, size_t hidden) {
+    size_t lda = input + hidden;
+    rnn_t s = {
+        .x = x,
+        .y = y,
+        .batch = batch,
+        .input = input,
+        .hidden = hidden,
+        .lda = lda,
+    };
+    s.wr = mem;
+    s.bias = s.wr + gates * hidden * lda;
+    s.xh[0] = s.bias + 4 * hidden;
+    s.xh[1] = s.xh[0] + lda;
+    s.gates = s.xh[1] + lda;
+    s.c = s.gates + 4 * hidden;
+    s.rh = s.c;
+    return s;
+}
+
+/*
+ * Copies the rows [first, first + count) of w and r into wr and their biases.
+ */
+static void rnn_setup(const rnn_t* s, size_t gates, const double* w, const double* r, const double* b, int gru,
+                      size_t first, size_t count) {
+    size_t rows = gates * s->hidden;
+
+    for (size_t k = first; k < first + count; k++) {
+        double* row = s->wr + k * s->lda;
+        for (size_t e = 0; e < s->input; e++) {
+            row[e] = w[k * s->input + e];
+        }
+        for (size_t e = 0; e < s->hidden; e++) {
+            row[s->input + e] = r[k * s->hidden + e];
+        }
+
+        if (gru && k >= 2 * s->hidden) {
+            s->bias[k] = b ? b[k] : 0.0;
+            s->bias[k + s->hidden] = b ? b[rows + k] : 0.0;
+        } else {
+            s->bias[k] = b ? b[k] + b[rows + k] : 0.0;
+        }
+    }
+}
+
+/*
+ * The initial state of the units [first, first + count) and the elements [xf, xf + xc) of x_0 of sequence n.
+ */
+static void rnn_begin(const rnn_t* s, size_t seq, size_t n, const double* initial_h, const double* initial_c,
+                      size_t first, size_t count, size_t xf, size_t xc) {
+    for (size_t j = first; j < first + count; j++) {
+        s->xh[0][s->input + j] = initial_h ? initial_h[n * s->hidden + j] : 0.0;
+        s->c[j] = initial_c ? initial_c[n * s->hidden + j] : 0.0;
+    }
+    for (size_t e = xf; seq > 0 && e < xf + xc; e++) {
+        s->xh[0][e] = s->x[n * s->input + e];
+    }
+}
+
+// Stores h_t of the units and moves in the part of x_{t+1}
+static void rnn_store(const rnn_t* s, size_t seq, size_t t, size_t n, size_t first, size_t count, size_t xf, size_t xc) {
+    double* next = s->xh[(t + 1) % 2];
+    for (size_t j = first; s->y && j < first + count; j++) {
+        s->y[(t * s->batch + n) * s->hidden + j] = next[s->input + j];
+    }
+    for (size_t e = xf; t + 1 < seq && e < xf + xc; e++) {
+        next[e] = s->x[((t + 1) * s->batch + n) * s->input + e];
+    }
+}
+
+// The final state of the units of sequence n
+static void rnn_end(const rnn_t* s, size_t seq, size_t n, double* y_h, double* y_c, size_t first, size_t count) {
+    for (size_t j = first; j < first + count; j++) {
+        if (y_h) {
+            y_h[n * s->hidden + j] = s->xh[seq % 2][s->input + j];
+        }
+        if (y_c) {
+            y_c[n * s->hidden + j] = s->c[j];
+        }
+    }
+}
+
+static void lstm_step(const rnn_t* s, size_t seq, size_t t, size_t n, size_t first, size_t count, size_t xf, size_t xc) {
+    size_t hidden = s->hidden;
+    double* cur = s->xh[t % 2];
+    double* next = s->xh[(t + 1) % 2];
+
+    for (size_t g = 0; g < 4; g++) {
+        size_t k = g * hidden + first;
+        rnn_gemv(s->wr + k * s->lda, s->lda, cur, count, s->lda, s->bias + k, g < 3 ? RNN_ACT_SIGMOID : RNN_ACT_TANH,
+                 s->gates + k);
+    }
+
+    for (size_t j = first; j < first + count; j++) {
+        s->c[j] = s->gates[2 * hidden + j] * s->c[j] + s->gates[j] * s->gates[3 * hidden + j];
+        next[s->input + j] = s->gates[hidden + j] * tanh(s->c[j]);
+    }
+    rnn_store(s, seq, t, n, first, count, xf, xc);
+}
+
+/*
+ * The gates z, r and w_h x + wb_h of the units, and r_h h_{t-1} + rb_h with linear_before_reset
+ * or r * h_{t-1} (which all units need for r_h) without.
+ */
+static void gru_gates(const rnn_t* s, size_t t, int linear_before_reset, size_t first, size_t count) {
+    size_t hidden = s->hidden;
+    double* cur = s->xh[t % 2];
+
+    for (size_t g = 0; g < 2; g++) {
+        size_t k = g * hidden + first;
+        rnn_gemv(s->wr + k * s->lda, s->lda, cur, count, s->lda, s->bias + k, RNN_ACT_SIGMOID, s->gates + k);
+    }
+    size_t k = 2 * hidden + first;
+    rnn_gemv(s->wr + k * s->lda, s->lda, cur, count, s->input, s->bias + k, RNN_ACT_NONE, s->gates + k);
+
+    if (linear_before_reset) {
+        rnn_gemv(s->wr + k * s->lda + s->input, s->lda, cur + s->input, count, hidden, s->bias + k + hidden,
+                 RNN_ACT_NONE, s->gates + k + hidden);
+    } else {
+        for (size_t j = first; j < first + count; j++) {
+            s->rh[j] = s->gates[hidden + j] * cur[s->input + j];
+        }
+    }
+}
+
+static void gru_update(const rnn_t* s, size_t seq, size_t t, size_t n, int linear_before_reset,
+                       size_t first, size_t count, size_t xf, size_t xc) {
+    size_t hidden = s->hidden;
+    double* cur = s->xh[t % 2];
+    double* next = s->xh[(t + 1) % 2];
+    size_t k = 2 * hidden + first;
+
+    if (!linear_before_reset) {
+        rnn_gemv(s->wr + k * s->lda + s->input, s->lda, s->rh, count, hidden, s->bias + k + hidden,
+                 RNN_ACT_NONE, s->gates + k + hidden);
+    }
+
+    for (size_t j = first; j < first + count; j++) {
+        double z = s->gates[j];
+        double rh = s->gates[3 * hidden + j];
+        double candidate = tanh(s->gates[2 * hidden + j] + (linear_before_reset ? s->gates[hidden + j] * rh : rh));
+        next[s->input + j] = (1.0 - z) * candidate + z * cur[s->input + j];
+    }
+    rnn_store(s, seq, t, n, first, count, xf, xc);
+}
+
+/*
+ * Allocates len doubles in L1, or in the global arena if they do not fit. Sets *arena and *mark for the reset.
+ */
+static double* rnn_alloc(size_t len, arena_t** arena, size_t* mark) {
+    *arena = arena_l1();
+    *mark = arena_mark(*arena);
+    double* mem = arena_alloc(*arena, len, sizeof(double), LMQ_ALIGN_DOUBLE);
+    if (mem == NULL) {
+        arena_reset(*arena, *mark);
+        *arena = arena_global();
+        *mark = arena_mark(*arena);
+        mem = arena_alloc(*arena, len, sizeof(double), LMQ_ALIGN_DOUBLE);
+    }
+    return mem;
+}
+
+__attribute__((noinline))
+int lstm_ssr_frep(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                  const double* initial_c, size_t seq, size_t batch, size_t input, size_t hidden,
+                  double* y, double* y_h, double* y_c) {
+    arena_t* arena;
+    size_t mark;
+    double* mem = rnn_alloc(rnn_len(4, input, hidden), &arena, &mark);
+    if (mem == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+
+    rnn_t s = rnn_buffers(mem, 4, x, y, batch, input, hidden);
+    rnn_setup(&s, 4, w, r, b, 0, 0, 4 * hidden);
+
+    for (size_t n = 0; n < batch; n++) {
+        rnn_begin(&s, seq, n, initial_h, initial_c, 0, hidden, 0, input);
+        for (size_t t = 0; t < seq; t++) {
+            lstm_step(&s, seq, t, n, 0, hidden, 0, input);
+        }
+        rnn_end(&s, seq, n, y_h, y_c, 0, hidden);
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+
+__attribute__((noinline))
+int gru_ssr_frep(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                 size_t seq, size_t batch, size_t input, size_t hidden, int linear_before_reset,
+                 double* y, double* y_h) {
+    arena_t* arena;
+    size_t mark;
+    double* mem = rnn_alloc(rnn_len(3, input, hidden), &arena, &mark);
+    if (mem == NULL) {
+        arena_reset(arena, mark);
+        return -1;
+    }
+
+    rnn_t s = rnn_buffers(mem, 3, x, y, batch, input, hidden);
+    rnn_setup(&s, 3, w, r, b, 1, 0, 3 * hidden);
+
+    for (size_t n = 0; n < batch; n++) {
+        rnn_begin(&s, seq, n, initial_h, NULL, 0, hidden, 0, input);
+        for (size_t t = 0; t < seq; t++) {
+            gru_gates(&s, t, linear_before_reset, 0, hidden);
+            gru_update(&s, seq, t, n, linear_before_reset, 0, hidden, 0, input);
+        }
+        rnn_end(&s, seq, n, y_h, NULL, 0, hidden);
+    }
+
+    arena_reset(arena, mark);
+    return 0;
+}
+
+// Shared between all cores of the cluster
+static double* rnn_shared = NULL;
+
+/*
+ * Allocates the buffers on the DM core and copies the weights with all compute cores. Sets the hidden units
+ * [*first, *first + *count) and the elements [*xf, *xf + *xc) of x of the calling core (none for the DM core).
+ * Returns NULL on all cores if the buffers can not be allocated.
+ */
+static double* rnn_parallel_begin(size_t gates, const double* w, const double* r, const double* b, int gru,
+                                  const double* x, double* y, size_t batch, size_t input, size_t hidden,
+                                  arena_t** arena, size_t* mark, rnn_t* s,
+                                  size_t* first, size_t* count, size_t* xf, size_t* xc) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        rnn_shared = rnn_alloc(rnn_len(gates, input, hidden), arena, mark);
+    }
+    snrt_cluster_hw_barrier();
+    double* mem = rnn_shared;
+    if (mem == NULL) {
+        if (snrt_is_dm_core()) {
+            arena_reset(*arena, *mark);
+        }
+        return NULL;
+    }
+
+    *s = rnn_buffers(mem, gates, x, y, batch, input, hidden);
+    *count = *xc = 0;
+    *first = *xf = 0;
+    if (!snrt_is_dm_core()) {
+        size_t row_first;
+        size_t rows = local_range(gates * hidden, core_idx, core_num, &row_first);
+        rnn_setup(s, gates, w, r, b, gru, row_first, rows);
+
+        *count = local_range(hidden, core_idx, core_num, first);
+        *xc = local_range(input, core_idx, core_num, xf);
+    }
+    snrt_cluster_hw_barrier();
+    return mem;
+}
+
+static void rnn_parallel_end(arena_t* arena, size_t mark) {
+    if (snrt_is_dm_core()) {
+        arena_reset(arena, mark);
+        rnn_shared = NULL;
+    }
+    snrt_cluster_hw_barrier();
+}
+
+__attribute__((noinline))
+int lstm_ssr_frep_parallel(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                           const double* initial_c, size_t seq, size_t batch, size_t input, size_t hidden,
+                           double* y, double* y_h, double* y_c) {
+    arena_t* arena = NULL;
+    size_t mark = 0;
+    rnn_t s;
+    size_t first, count, xf, xc;
+
+    if (rnn_parallel_begin(4, w, r, b, 0, x, y, batch, input, hidden, &arena, &mark, &s, &first, &count, &xf, &xc) == NULL) {
+        return -1;
+    }
+
+    for (size_t n = 0; n < batch; n++) {
+        rnn_begin(&s, seq, n, initial_h, initial_c, first, count, xf, xc);
+        snrt_cluster_hw_barrier();
+        for (size_t t = 0; t < seq; t++) {
+            lstm_step(&s, seq, t, n, first, count, xf, xc);
+            snrt_cluster_hw_barrier();
+        }
+        rnn_end(&s, seq, n, y_h, y_c, first, count);
+    }
+
+    rnn_parallel_end(arena, mark);
+    return 0;
+}
+
+__attribute__((noinline))
+int gru_ssr_frep_parallel(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                          size_t seq, size_t batch, size_t input, size_t hidden, int linear_before_reset,
+                          double* y, double* y_h) {
+    arena_t* arena = NULL;
+    size_t mark = 0;
+    rnn_t s;
+    size_t first, count, xf, xc;
+
+    if (rnn_parallel_begin(3, w, r, b, 1, x, y, batch, input, hidden, &arena, &mark, &s, &first, &count, &xf, &xc) == NULL) {
+        return -1;
+    }
+
+    for (size_t n = 0; n < batch; n++) {
+        rnn_begin(&s, seq, n, initial_h, NULL, first, count, xf, xc);
+        snrt_cluster_hw_barrier();
+        for (size_t t = 0; t < seq; t++) {
+            gru_gates(&s, t, linear_before_reset, first, count);
+            // r_h needs r * h_{t-1} of all units
+            if (!linear_before_reset) {
+                snrt_cluster_hw_barrier();
+            }
+            gru_update(&s, seq, t, n, linear_before_reset, first, count, xf, xc);
+            snrt_cluster_hw_barrier();
+        }
+        rnn_end(&s, seq, n, y_h, NULL, first, count);
+    }
+
+    rnn_parallel_end(arena, mark);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef LMQ_RNN_H
+#define LMQ_RNN_H
+
+#include <snrt.h>
+
+/*
+ * ONNX LSTM and GRU, forward direction with the default activations (sigmoid for the gates, tanh otherwise),
+ * no peepholes and no sequence lengths. x is (seq, batch, input); w, r and b are the weights of the direction:
+ * w (gates * hidden, input), r (gates * hidden, hidden) and b (2 * gates * hidden: wb then rb) or NULL, with
+ * the gates in the ONNX order (LSTM: i, o, f, c; GRU: z, r, h). initial_h and initial_c are (batch, hidden) or
+ * NULL for zeros. The outputs y (seq, batch, hidden), y_h and y_c (batch, hidden) may be NULL.
+ * The ssr_frep versions copy w and r side by side into one (gates * hidden, input + hidden) matrix in L1 (or in
+ * global memory if it does not fit), which stays resident for all timesteps and sequences of the batch, next to
+ * the summed biases, x_t followed by h_{t-1} and the cell state. A timestep is one gemv of that matrix with
+ * (x_t, h_{t-1}): GEMM_BLOCK gate rows are accumulated at once, starting from the bias, and the gate activation
+ * is applied to the accumulators before they are written. The parallel version must be called by all cores of
+ * the cluster: the hidden units are split over the compute cores, every core computes the gate rows of its units
+ * and their new state, with one cluster barrier per timestep (two for a GRU without linear_before_reset).
+ * All versions return -1 if their buffers can not be allocated.
+ */
+int lstm_baseline(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                  const double* initial_c, size_t seq, size_t batch, size_t input, size_t hidden,
+                  double* y, double* y_h, double* y_c);
+int lstm_ssr_frep(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                  const double* initial_c, size_t seq, size_t batch, size_t input, size_t hidden,
+                  double* y, double* y_h, double* y_c);
+int lstm_ssr_frep_parallel(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                           const double* initial_c, size_t seq, size_t batch, size_t input, size_t hidden,
+                           double* y, double* y_h, double* y_c);
+
+/*
+ * linear_before_reset is the ONNX attribute: if set, the reset gate multiplies r_h h_{t-1} + rb_h,
+ * otherwise h_{t-1} before the product with r_h.
+ */
+int gru_baseline(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                 size_t seq, size_t batch, size_t input, size_t hidden, int linear_before_reset,
+                 double* y, double* y_h);
+int gru_ssr_frep(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                 size_t seq, size_t batch, size_t input, size_t hidden, int linear_before_reset,
+                 double* y, double* y_h);
+int gru_ssr_frep_parallel(const double* x, const double* w, const double* r, const double* b, const double* initial_h,
+                          size_t seq, size_t batch, size_t input, size_t hidden, int linear_before_reset,
+                          double* y, double* y_h);
+
+#endif
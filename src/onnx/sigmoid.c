@@ -1,13 +1,19 @@
-
 #include <snrt.h>
 
 #include <math.h>
 
+#include "sigmoid.h"
+#include "lmq.h"
+#include "fpmath.h"
+#include "kernel.h"
+#include "lut.h"
+#include "tile.h"
+
 /*
  * Naive implementation of sigmoid. Calculates the sigmoid of n elements starting at arr.
  */
 __attribute__((noinline))
-int sigmoid_baseline(const double* arr, const size_t n, double* result) {
+int sigmoid_baseline(double* arr, const size_t n, double* result) {
     for (size_t i = 0; i < n; i++) {
         result[i] = 1 / (1 + exp(-arr[i]));
     }
@@ -15,77 +21,100 @@ int sigmoid_baseline(const double* arr, const size_t n, double* result) {
     return 0;
 }
 
+/*
+ * 1 / (1 + exp(-x)) with exp(-x) of fpmath_exp in the carry.
+ * Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void sigmoid_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    fpmath_exp(arr, 1, carry, count, NULL, frep);
+
+    fpmath_pass_begin(NULL, carry, 1, 1, result, count);
+    FPMATH_PASS(frep, count, 2,
+        "fadd.d ft3, ft1, %[one] \n"
+        "fdiv.d ft2, %[one], ft3 \n",
+        [one] "f"(1.0));
+    fpmath_pass_end();
+}
+
+static inline void sigmoid_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
+
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        sigmoid_block(arr + i, count, result + i, carry, frep);
+    }
+}
+
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
 __attribute__((noinline))
-int sigmoid_ssr(const double* arr, const size_t n, double* result) {
-    register volatile double ft0 asm("ft0");
-    register volatile double ft1 asm("ft1");
+int sigmoid_ssr(double* arr, const size_t n, double* result) {
+    sigmoid_range(arr, n, result, 0);
+    return 0;
+}
 
-    asm volatile("" : "=f"(ft0));
+__attribute__((noinline))
+int sigmoid_ssr_frep(double* arr, const size_t n, double* result) {
+    sigmoid_range(arr, n, result, 1);
+    return 0;
+}
 
-    // stream arr into ft0
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
+KERNEL_UNARY_SPLIT(sigmoid, double, sigmoid_range)
 
-    // stream from ft1 into result
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result);
+/*
+ * Streams arr through L1 in double buffered tiles (moved by the DM core)
+ * while the compute cores run sigmoid_ssr_frep on the current tile.
+ */
+__attribute__((noinline))
+int sigmoid_ssr_tiled(double* arr, const size_t n, double* result) {
+    return tile_unary(sigmoid_ssr_frep, arr, n, result);
+}
 
-    snrt_ssr_enable();
+// Outside of [-SIGMOID_LUT_X, SIGMOID_LUT_X] sigmoid is within 1e-6 of 0 or 1
+#define SIGMOID_LUT_X 14.0
+// max |sigmoid''| = 1 / (6 sqrt(3))
+#define SIGMOID_LUT_D2 0.0962250448649376
 
-    for (size_t i = 0; i < n; i++) {
-        asm volatile(
-            "fneg.d fa0, ft0\n" // fa0 <- neg(ft0)
-            ::: "fa0", "ft0"
-        );
-
-        /*
-         * We disable SSR as every read to 'ft0' will fetch the
-         * next element from the defined stream. And any called function
-         * may use the ft0 register (as it is caller saved)
-         */
-        snrt_ssr_disable();
-
-        /*
-         * As this is a function call we MUST have "ra" in the clobber.
-         * Else the compiler does not know that this function needs to 
-         * store 'ra' on the stack (or in some caller saved register) as it
-         * may get modified in the call.
-         * Same for all other caller saved registers below (in the clobber).
-        */
-        asm volatile(
-            "call %[add_one]\n"
-            :: [add_one] "i"(exp)
-            : 
-            "fa0", "fa1", "fa2", "fa3", "fa4", "fa5", "fa6", "fa7",
-            "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", 
-            "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
-            "ra"
-        );
-
-        snrt_ssr_enable();
-        
-        asm volatile(
-            "fdiv.d ft2, fa0, fa0\n" // ft2 <- 1. TODO change it
-            "fadd.d fa0, ft2, fa0\n" // fa0 <- fa0 + 1
-            "fdiv.d ft1, ft2, fa0\n" // ft1 <- 1 / fa0
-            ::: "ft1", "fa0", "ft2"
-        );
-    }
+static lut_t sigmoid_table;
 
-    snrt_ssr_disable();
-    asm volatile("" :: "f"(ft1));
+static double sigmoid(double x) {
+    return 1 / (1 + exp(-x));
+}
+
+static inline int sigmoid_lut_init() {
+    return lut_init(&sigmoid_table, sigmoid, -SIGMOID_LUT_X, SIGMOID_LUT_X,
+                    lut_size(-SIGMOID_LUT_X, SIGMOID_LUT_X, SIGMOID_LUT_D2, LUT_MAX_ERROR), 0.0);
+}
+
+/*
+ * Linear interpolation in a table of sigmoid in L1, which is built on the first call.
+ */
+__attribute__((noinline))
+int sigmoid_lut(double* arr, const size_t n, double* result) {
+    if (sigmoid_lut_init() != 0) {
+        return -1;
+    }
 
+    lut_eval(&sigmoid_table, arr, n, result);
     return 0;
 }
 
 __attribute__((noinline))
-int sigmoid_ssr_frep(const double* arr, const size_t n, double* result) {
-    /*
-     * I do not think we can optimize anything with FREP.
-     * As we have a call to another function which consists of many more
-     * assembly instructions.
-     */
+int sigmoid_lut_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    if (sigmoid_lut_init() != 0) {
+        return -1;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    lut_eval(&sigmoid_table, arr + first, count, result + first);
     return 0;
-}
\ No newline at end of file
+}
@@ -3,8 +3,27 @@
 
 #include <snrt.h>
 
+/*
+ * The ssr versions compute exp(-x) in the FP only passes of fpmath
+ * (max relative error 3e-11, x below -708 gives sigmoid(-708)).
+ */
 int sigmoid_baseline(double *arr, const size_t n, double *result);
 int sigmoid_ssr(double *arr, const size_t n,double *result);
 int sigmoid_ssr_frep(double *arr, const size_t n, double *result);
+int sigmoid_parallel(double *arr, const size_t n, double *result);
+int sigmoid_ssr_parallel(double *arr, const size_t n, double *result);
+int sigmoid_ssr_frep_parallel(double *arr, const size_t n, double *result);
+int sigmoid_omp(double *arr, const size_t n, double *result);
+int sigmoid_ssr_omp(double *arr, const size_t n, double *result);
+int sigmoid_ssr_frep_omp(double *arr, const size_t n, double *result);
 
-#endif
\ No newline at end of file
+int sigmoid_ssr_tiled(double *arr, const size_t n, double *result);
+
+/*
+ * Lookup table versions (src/lmq/lut.h) with max absolute error LUT_MAX_ERROR.
+ * The table is built in L1 on the first call.
+ */
+int sigmoid_lut(double *arr, const size_t n, double *result);
+int sigmoid_lut_parallel(double *arr, const size_t n, double *result);
+
+#endif
@@ -2,7 +2,10 @@
 #include <math.h>
 #include <stdlib.h>
 #include "omp.h"
+#include "lmq.h"
 #include "sin.h"
+#include "fpmath.h"
+#include "tile.h"
 
 #ifndef M_PI
 #   define M_PI 3.14159265358979323846
@@ -19,86 +22,191 @@ int sin_baseline(double* arr, const size_t n, double* result) {
     return 0;
 }
 
-__attribute__((noinline)) 
-int sin_ssr(double* arr, const size_t n, double* result) {
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1); // load every element only once
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr); // read from arr
+/*
+ * Accuracy tiers of the range reduced sin and cos.
+ * TRIG_ACCURATE: degree 15, max error 1e-15. TRIG_FAST: degree 11 on two elements at once, max error 3e-11.
+ */
+typedef enum {
+    TRIG_ACCURATE,
+    TRIG_FAST
+} trig_tier_t;
+
+// sin(sqrt(q)) / sqrt(q) on [0, (pi / 2)^2], Chebyshev fits of degree 7 and 5 in q
+static const double trig_poly_accurate[] = {
+    0.99999999999999956, -0.16666666666665539, 0.0083333333332860204, -0.00019841269830662755,
+    2.7557317634415763e-06, -2.5051956414283147e-08, 1.6050624951084294e-10, -7.4048264679580554e-13
+};
+static const double trig_poly_fast[] = {
+    0.999999999982909, -0.16666666616791373, 0.0083333309732913589, -0.00019840861060277092,
+    2.7525263601101806e-06, -2.3889105790823126e-08
+};
+
+// Cody-Waite split of pi, p1 + p2 + p3 = pi to about 160 bits
+#define TRIG_P1 3.1415926535897931
+#define TRIG_P2 1.2246467991473532e-16
+#define TRIG_P3 -2.9947698097183397e-33
+#define TRIG_INV_PI 0.31830988618379069
+// Adding and subtracting 1.5 * 2^52 rounds to the nearest integer
+#define TRIG_ROUND 6755399441055744.0
+
+#define TRIG_REDUCE_OPERANDS                                                   \
+    [inv_pi] "f"(TRIG_INV_PI), [round] "f"(TRIG_ROUND), [half] "f"(0.5),       \
+    [two] "f"(2.0), [p1] "f"(TRIG_P1), [p2] "f"(TRIG_P2), [p3] "f"(TRIG_P3)
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, n, sizeof(*result));
-    snrt_ssr_repeat(SNRT_SSR_DM1, 1); // load every element only once
-    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result); // write to result
+/*
+ * Reduces x to r in [-pi / 2, pi / 2] with sin(x) = sin(r) (or cos(x) = sin(r)), the result is the polynomial in r.
+ * sin: x = k pi + r with k = round(x / pi) and sin(x) = (-1)^k sin(r).
+ * cos: x = (k + 1/2) pi + r with k = round(x / pi - 1/2) and cos(x) = (-1)^(k + 1) sin(r).
+ * The parity p = k - 2 round(k / 2) is -1, 0 or 1, so fsgnjx with 1/2 - p^2 (p^2 - 1/2 for cos) applies the sign.
+ * The products with k are exact in the fnmsubs for |x| < 2^40, larger inputs lose accuracy (up to 2^51 for the rounding).
+ * Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void trig_block(double* arr, size_t count, int cosine, trig_tier_t tier, double* result, double* carry, int frep) {
+    fpmath_pass_begin(arr, carry, 0, 1, NULL, count);
+    if (cosine) {
+        FPMATH_PASS(frep, count, 14,
+            "fmv.d ft3, ft0 \n"
+            "fmsub.d ft4, ft3, %[inv_pi], %[half] \n"
+            "fadd.d ft4, ft4, %[round] \n"
+            "fsub.d ft4, ft4, %[round] \n"
+            "fmul.d ft5, ft4, %[half] \n"
+            "fadd.d ft6, ft4, %[half] \n"
+            "fadd.d ft5, ft5, %[round] \n"
+            "fnmsub.d ft3, ft6, %[p1], ft3 \n"
+            "fsub.d ft5, ft5, %[round] \n"
+            "fnmsub.d ft3, ft6, %[p2], ft3 \n"
+            "fnmsub.d ft5, ft5, %[two], ft4 \n"
+            "fnmsub.d ft3, ft6, %[p3], ft3 \n"
+            "fmsub.d ft5, ft5, ft5, %[half] \n"
+            "fsgnjx.d ft2, ft3, ft5 \n",
+            TRIG_REDUCE_OPERANDS);
+    } else {
+        FPMATH_PASS(frep, count, 13,
+            "fmv.d ft3, ft0 \n"
+            "fmul.d ft4, ft3, %[inv_pi] \n"
+            "fadd.d ft4, ft4, %[round] \n"
+            "fsub.d ft4, ft4, %[round] \n"
+            "fmul.d ft5, ft4, %[half] \n"
+            "fnmsub.d ft3, ft4, %[p1], ft3 \n"
+            "fadd.d ft5, ft5, %[round] \n"
+            "fnmsub.d ft3, ft4, %[p2], ft3 \n"
+            "fsub.d ft5, ft5, %[round] \n"
+            "fnmsub.d ft3, ft4, %[p3], ft3 \n"
+            "fnmsub.d ft5, ft5, %[two], ft4 \n"
+            "fnmsub.d ft5, ft5, ft5, %[half] \n"
+            "fsgnjx.d ft2, ft3, ft5 \n",
+            TRIG_REDUCE_OPERANDS);
+    }
+    fpmath_pass_end();
+
+    // r * P(r^2)
+    fpmath_pass_begin(NULL, carry, 1, 1, result, count);
+    if (tier == TRIG_FAST) {
+        const double* c = trig_poly_fast;
+
+        // Two elements interleaved, so every fmadd has the latency of the other element to wait for its operand
+        if (count >= 2) {
+            FPMATH_PASS(frep, count / 2, 16,
+                "fmv.d ft3, ft1 \n"
+                "fmv.d ft6, ft1 \n"
+                "fmul.d ft4, ft3, ft3 \n"
+                "fmul.d ft7, ft6, ft6 \n"
+                "fmadd.d ft5, ft4, %[s5], %[s4] \n"
+                "fmadd.d ft8, ft7, %[s5], %[s4] \n"
+                "fmadd.d ft5, ft5, ft4, %[s3] \n"
+                "fmadd.d ft8, ft8, ft7, %[s3] \n"
+                "fmadd.d ft5, ft5, ft4, %[s2] \n"
+                "fmadd.d ft8, ft8, ft7, %[s2] \n"
+                "fmadd.d ft5, ft5, ft4, %[s1] \n"
+                "fmadd.d ft8, ft8, ft7, %[s1] \n"
+                "fmadd.d ft5, ft5, ft4, %[s0] \n"
+                "fmadd.d ft8, ft8, ft7, %[s0] \n"
+                "fmul.d ft2, ft5, ft3 \n"
+                "fmul.d ft2, ft8, ft6 \n",
+                [s0] "f"(c[0]), [s1] "f"(c[1]), [s2] "f"(c[2]), [s3] "f"(c[3]), [s4] "f"(c[4]), [s5] "f"(c[5]));
+        }
+        if (count % 2) {
+            FPMATH_PASS(frep, 1, 8,
+                "fmv.d ft3, ft1 \n"
+                "fmul.d ft4, ft3, ft3 \n"
+                "fmadd.d ft5, ft4, %[s5], %[s4] \n"
+                "fmadd.d ft5, ft5, ft4, %[s3] \n"
+                "fmadd.d ft5, ft5, ft4, %[s2] \n"
+                "fmadd.d ft5, ft5, ft4, %[s1] \n"
+                "fmadd.d ft5, ft5, ft4, %[s0] \n"
+                "fmul.d ft2, ft5, ft3 \n",
+                [s0] "f"(c[0]), [s1] "f"(c[1]), [s2] "f"(c[2]), [s3] "f"(c[3]), [s4] "f"(c[4]), [s5] "f"(c[5]));
+        }
+    } else {
+        const double* c = trig_poly_accurate;
+
+        FPMATH_PASS(frep, count, 10,
+            "fmv.d ft3, ft1 \n"
+            "fmul.d ft4, ft3, ft3 \n"
+            "fmadd.d ft5, ft4, %[s7], %[s6] \n"
+            "fmadd.d ft5, ft5, ft4, %[s5] \n"
+            "fmadd.d ft5, ft5, ft4, %[s4] \n"
+            "fmadd.d ft5, ft5, ft4, %[s3] \n"
+            "fmadd.d ft5, ft5, ft4, %[s2] \n"
+            "fmadd.d ft5, ft5, ft4, %[s1] \n"
+            "fmadd.d ft5, ft5, ft4, %[s0] \n"
+            "fmul.d ft2, ft5, ft3 \n",
+            [s0] "f"(c[0]), [s1] "f"(c[1]), [s2] "f"(c[2]), [s3] "f"(c[3]),
+            [s4] "f"(c[4]), [s5] "f"(c[5]), [s6] "f"(c[6]), [s7] "f"(c[7]));
+    }
+    fpmath_pass_end();
+}
 
-    // The SSR extension is disabled by default, as code that 
-    // does not benefit from the use of streams must have the
-    // full set of registers available (compatibility).
+static inline void trig_range(double* arr, const size_t n, int cosine, trig_tier_t tier, double* result, int frep) {
+    double* carry = fpmath_carry();
 
-    // Enabling stream semantics
-    snrt_ssr_enable();
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        trig_block(arr + i, count, cosine, tier, result + i, carry, frep);
+    }
+}
 
-    // The SSR region itself can contain any sequence of assembly instructions.
+/*
+ * The passes of sin_ssr_frep, issuing the bodies once per element instead of under FREP.
+ */
+__attribute__((noinline)) 
+int sin_ssr(double* arr, const size_t n, double* result) {
+    trig_range(arr, n, 0, TRIG_ACCURATE, result, 0);
+    return 0;
+}
 
-    // Note that while the SSR extension allows for many address stepping and
-    // data transfer instructions to be removed from the instruction stream,
-    // the program must still issue the **exact number** of compute instructions
-    // to fully exhaust the pattern in the address generator. This means that 
-    // the fundamental loop nest containing the compute instruction must still
-    // be present.
+__attribute__((noinline)) 
+int sin_ssr_frep(double* arr, const size_t n, double* result) {
+    trig_range(arr, n, 0, TRIG_ACCURATE, result, 1);
+    return 0;
+}
 
-    // Computation
+__attribute__((noinline)) 
+int sin_ssr_frep_fast(double* arr, const size_t n, double* result) {
+    trig_range(arr, n, 0, TRIG_FAST, result, 1);
+    return 0;
+}
+
+/*
+ * Naive implementation of cos. Computes the element-wise cosine and stores it in result.
+ */
+__attribute__((noinline)) 
+int cos_baseline(double* arr, const size_t n, double* result) {
     for (size_t i = 0; i < n; i++) {
-        asm volatile(
-            "fmv.d fa0, ft0\n" // fa0 <- ft0
-            ::: "fa0", "ft0"
-        );
-
-        /*
-         * We disable SSR as every read to 'ft0' will fetch the
-         * next element from the defined stream. And any called function
-         * may use the ft0 register (as it is caller saved)
-         */
-        __builtin_ssr_disable();
-
-        /*
-         * As this is a function call we MUST have "ra" in the clobber.
-         * Else the compiler does not know that this function needs to 
-         * store 'ra' on the stack (or in some caller saved register) as it
-         * may get modified in the call.
-         * Same for all other caller saved registers below (in the clobber).
-        */
-        asm volatile(
-            "call %[add_one]\n"
-            :: [add_one] "i"(sin)
-            : 
-            "fa0", "fa1", "fa2", "fa3", "fa4", "fa5", "fa6", "fa7",
-            "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", 
-            "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
-            "ra"
-        );
-
-        __builtin_ssr_enable();
-        
-        asm volatile(
-            "fmv.d ft1, fa0" // ft1 <- fa0
-            ::: "ft1", "fa0"
-        );
+        result[i] = cos(arr[i]);
     }
-
-    // Disabling stream semantics
-    snrt_ssr_disable();
-
     return 0;
 }
 
 __attribute__((noinline)) 
-int sin_ssr_frep(double* arr, const size_t n, double* result) {
-    (void) arr, (void) n, (void) result;
-    /*
-     * We cannot optimize anything with FREP.
-     * As we have a call to another function which consists of many more
-     * assembly instructions.
-     */
+int cos_ssr_frep(double* arr, const size_t n, double* result) {
+    trig_range(arr, n, 1, TRIG_ACCURATE, result, 1);
+    return 0;
+}
 
+__attribute__((noinline)) 
+int cos_ssr_frep_fast(double* arr, const size_t n, double* result) {
+    trig_range(arr, n, 1, TRIG_FAST, result, 1);
     return 0;
 }
 
@@ -128,66 +236,44 @@ __attribute__((noinline))
 int sin_ssr_parallel(double* arr, const size_t n, double* result) {
     size_t core_num = snrt_cluster_core_num() - 1;
     size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
 
-    int do_extra = 0;
-    if (core_idx < n - local_n * core_num) {
-        do_extra = 1;
+    if (snrt_is_dm_core()) {
+        return 0;
     }
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(double));
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + core_idx * local_n);
-
-    snrt_ssr_loop_1d(SNRT_SSR_DM1, local_n, sizeof(double));
-    snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result + core_idx * local_n);
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    trig_range(arr + first, count, 0, TRIG_ACCURATE, result + first, 0);
+    return 0;
+}
 
-    snrt_ssr_enable();
+__attribute__((noinline)) 
+int sin_ssr_frep_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
 
-    for (size_t i = 0; i < local_n; i++) {
-        asm volatile(
-            "fmv.d fa0, ft0\n" // fa0 <- ft0
-            ::: "fa0", "ft0"
-        );
-
-        /*
-         * We disable SSR as every read to 'ft0' will fetch the
-         * next element from the defined stream. And any called function
-         * may use the ft0 register (as it is caller saved)
-         */
-        snrt_ssr_disable();
-
-        /*
-         * As this is a function call we MUST have "ra" in the clobber.
-         * Else the compiler does not know that this function needs to 
-         * store 'ra' on the stack (or in some caller saved register) as it
-         * may get modified in the call.
-         * Same for all other caller saved registers below (in the clobber).
-        */
-        asm volatile(
-            "call %[sin]\n"
-            :: [sin] "i"(sin)
-            : 
-            "fa0", "fa1", "fa2", "fa3", "fa4", "fa5", "fa6", "fa7",
-            "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", 
-            "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
-            "ra"
-        );
-
-        snrt_ssr_enable();
-
-        asm volatile(
-            "fmv.d ft1, fa0" // ft1 <- fa0
-            ::: "ft1", "fa0"
-        );
+    if (snrt_is_dm_core()) {
+        return 0;
     }
 
-    // Disabling stream semantics
-    snrt_ssr_disable();
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    trig_range(arr + first, count, 0, TRIG_ACCURATE, result + first, 1);
+    return 0;
+}
 
-    if (do_extra) {
-        result[core_num * local_n + core_idx] = sin(arr[core_num * local_n + core_idx]);
+__attribute__((noinline)) 
+int cos_ssr_frep_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
     }
 
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    trig_range(arr + first, count, 1, TRIG_ACCURATE, result + first, 1);
     return 0;
 }
 
@@ -275,77 +361,20 @@ int sin_ssr_omp(double* arr, const size_t n, double* result) {
 #pragma omp parallel
     {
         unsigned core_idx = snrt_cluster_core_idx();
-        size_t local_n = n / core_num;
-        int do_extra = 0;
-
-        // Calculate which core does one more to account for the leftovers
-        if (core_idx < n - local_n * core_num) {
-            do_extra = 1;
-        }
+        size_t first;
+        size_t count = local_range(n, core_idx, core_num, &first);
 
-        snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
-        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + core_idx * local_n);
-
-        snrt_ssr_loop_1d(SNRT_SSR_DM1, local_n + 1, sizeof(*result));
-        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
-        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result + core_idx * local_n);
-
-        // The SSR extension is disabled by default, as code that 
-        // does not benefit from the use of streams must have the
-        // full set of registers available (compatibility).
-
-        // Enabling stream semantics
-        snrt_ssr_enable();
-
-        // The SSR region itself can contain any sequence of assembly instructions.
-
-        for (size_t i = 0; i < local_n; i++) {
-            asm volatile(
-                "fmv.d fa0, ft0\n" // fa0 <- ft0
-                ::: "fa0", "ft0"
-            );
-
-            /*
-             * We disable SSR as every read to 'ft0' will fetch the
-             * next element from the defined stream. And any called function
-             * may use the ft0 register (as it is caller saved)
-             */
-            __builtin_ssr_disable();
-
-            /*
-             * As this is a function call we MUST have "ra" in the clobber.
-             * Else the compiler does not know that this function needs to 
-             * store 'ra' on the stack (or in some caller saved register) as it
-             * may get modified in the call.
-             * Same for all other caller saved registers below (in the clobber).
-            */
-            asm volatile(
-                "call %[sin]\n"
-                :: [sin] "i"(sin)
-                : 
-                "fa0", "fa1", "fa2", "fa3", "fa4", "fa5", "fa6", "fa7",
-                "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", 
-                "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
-                "ra"
-            );
-
-            __builtin_ssr_enable();
-
-            asm volatile(
-                "fmv.d ft1, fa0" // ft1 <- fa0
-                ::: "ft1", "fa0"
-            );
-        }
-
-        // Disabling stream semantics
-        snrt_ssr_disable();
-        
-        // Could also be done in ssr, but this only adds O(number of threads) which we assume is low.
-        if (do_extra) {
-            result[local_n * core_num + core_idx] = sin(arr[local_n * core_num + core_idx]);
-        }
+        trig_range(arr + first, count, 0, TRIG_ACCURATE, result + first, 0);
     }
 
     return 0;
 }
+
+/*
+ * Streams arr through L1 in double buffered tiles (moved by the DM core)
+ * while the compute cores run sin_ssr_frep on the current tile.
+ */
+__attribute__((noinline)) 
+int sin_ssr_tiled(double* arr, const size_t n, double* result) {
+    return tile_unary(sin_ssr_frep, arr, n, result);
+}
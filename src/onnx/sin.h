@@ -1,4 +1,3 @@
-
 #ifndef LMQ_SIN_H
 #define LMQ_SIN_H
 
@@ -8,16 +7,30 @@
 
 /*
  * Naive implementation of sin. Computes the element-wise sine and stores it in result.
+ * The ssr versions reduce x by pi in three Cody-Waite steps and evaluate a degree 15 polynomial,
+ * all in FP instructions with SSR enabled (max error 1e-15 for |x| < 2^40).
+ * The fast versions use a degree 11 polynomial on two interleaved elements (max error 3e-11).
  */
 int sin_baseline(double* arr, const size_t n, double* result);
 int sin_ssr(double* arr, const size_t n, double* result);
 int sin_ssr_frep(double* arr, const size_t n, double* result);
+int sin_ssr_frep_fast(double* arr, const size_t n, double* result);
 
 int sin_parallel(double* arr, const size_t n, double* result);
 int sin_ssr_parallel(double* arr, const size_t n, double* result);
+int sin_ssr_frep_parallel(double* arr, const size_t n, double* result);
+
+/*
+ * cos with the reduction of sin shifted by pi / 2.
+ */
+int cos_baseline(double* arr, const size_t n, double* result);
+int cos_ssr_frep(double* arr, const size_t n, double* result);
+int cos_ssr_frep_fast(double* arr, const size_t n, double* result);
+int cos_ssr_frep_parallel(double* arr, const size_t n, double* result);
 
 /*
  * Naive implementation of sin using a an approximation formula.
+ * Only valid on [-pi, pi], sin_ssr_frep_fast is the range reduced replacement.
  */
 int sin_approx_baseline(double* arr, const size_t n, double* result);
 int sin_approx_ssr(double* arr, const size_t n, double* result);
@@ -25,4 +38,6 @@ int sin_approx_ssr(double* arr, const size_t n, double* result);
 int sin_omp(double* arr, const size_t n, double* result);
 int sin_ssr_omp(double* arr, const size_t n, double* result);
 
-#endif
\ No newline at end of file
+int sin_ssr_tiled(double* arr, const size_t n, double* result);
+
+#endif
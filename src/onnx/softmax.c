@@ -0,0 +1,109 @@
+#include <snrt.h>
+
+#include <math.h>
+
+#include "lmq.h"
+#include "reduce.h"
+#include "softmax.h"
+
+__attribute__((noinline))
+int softmax_baseline(const double* x, size_t rows, size_t cols, double* result) {
+    for (size_t i = 0; i < rows; i++) {
+        const double* row = x + i * cols;
+        double max = -INFINITY;
+        for (size_t j = 0; j < cols; j++) {
+            if (row[j] > max) {
+                max = row[j];
+            }
+        }
+
+        double sum = 0.0;
+        for (size_t j = 0; j < cols; j++) {
+            result[i * cols + j] = exp(row[j] - max);
+            sum += result[i * cols + j];
+        }
+
+        for (size_t j = 0; j < cols; j++) {
+            result[i * cols + j] /= sum;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Softmax of the rows [first, first + count).
+ * exp is a function call, so the exponentials are taken with the streams disabled.
+ */
+static inline void softmax_rows(const double* x, size_t cols, size_t first, size_t count, double* result) {
+    if (cols == 0) {
+        return;
+    }
+
+    for (size_t i = first; i < first + count; i++) {
+        const double* row = x + i * cols;
+        double* out = result + i * cols;
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, cols, sizeof(*x));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, row);
+
+        // The write stream of the previous row must not stay active
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, 0, 0);
+
+        snrt_ssr_enable();
+        double max = reduce_max_ssr_frep(cols);
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+
+        double sum = 0.0;
+        for (size_t j = 0; j < cols; j++) {
+            double e = exp(row[j] - max);
+            out[j] = e;
+            sum += e;
+        }
+        double inv = 1.0 / sum;
+
+        // Scales the row in place, every element is read before it is written
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, cols, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, out);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, cols, sizeof(*result));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, out);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "fmul.d ft1, ft0, %[inv] \n"
+            :
+            : [n_frep] "r"(cols - 1), [inv] "f"(inv)
+            : "ft0", "ft1", "ft2"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int softmax_ssr_frep(const double* x, size_t rows, size_t cols, double* result) {
+    softmax_rows(x, cols, 0, rows, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int softmax_ssr_frep_parallel(const double* x, size_t rows, size_t cols, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(rows, core_idx, core_num, &first);
+    softmax_rows(x, cols, first, count, result);
+    return 0;
+}
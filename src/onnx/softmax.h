@@ -0,0 +1,18 @@
+#ifndef LMQ_SOFTMAX_H
+#define LMQ_SOFTMAX_H
+
+#include <snrt.h>
+
+/*
+ * ONNX Softmax along the last axis of a row major (rows, cols) matrix (axis = -1 with rows the product
+ * of the other dimensions): result[i][j] = exp(x[i][j] - max_i) / sum_j exp(x[i][j] - max_i).
+ * The SSR version takes the row maximum in a read-only FREP pass with REDUCE_ACCUMULATORS accumulators,
+ * computes exp and the sum in a single pass which writes the exponentials and multiplies the row by
+ * the reciprocal of the sum in a FREP pass, so there is one exp and no division per element.
+ * The parallel version splits the rows over the compute cores.
+ */
+int softmax_baseline(const double* x, size_t rows, size_t cols, double* result);
+int softmax_ssr_frep(const double* x, size_t rows, size_t cols, double* result);
+int softmax_ssr_frep_parallel(const double* x, size_t rows, size_t cols, double* result);
+
+#endif
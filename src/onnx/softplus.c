@@ -0,0 +1,139 @@
+#include <snrt.h>
+
+#include <math.h>
+#include "omp.h"
+#include "lmq.h"
+#include "softplus.h"
+#include "fpmath.h"
+
+/*
+ * log(1 + exp(x)) without overflow and without rounding exp(x) for negative x.
+ */
+static inline double softplus(double x) {
+    return fmax(x, 0.0) + log1p(exp(-fabs(x)));
+}
+
+/*
+ * Naive implementation of softplus. Calculates the softplus of n elements starting at arr.
+ */
+__attribute__((noinline))
+int softplus_baseline(double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = softplus(arr[i]);
+    }
+
+    return 0;
+}
+
+/*
+ * softplus(x) = max(x, 0) + log1p(exp(-|x|)) with exp(-|x|) = 1 / (1 + expm1(|x|)).
+ * Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void softplus_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    fpmath_pass_begin(arr, carry, 0, 1, NULL, count);
+    FPMATH_PASS(frep, count, 1,
+        "fsgnj.d ft2, ft0, %[one] \n",
+        [one] "f"(1.0));
+    fpmath_pass_end();
+
+    fpmath_expm1(carry, count, frep);
+
+    // (exp(-|x|), 0) for the logarithm
+    fpmath_pass_begin(NULL, carry, 1, 2, NULL, count);
+    FPMATH_PASS(frep, count, 3,
+        "fadd.d ft3, ft1, %[one] \n"
+        "fdiv.d ft2, %[one], ft3 \n"
+        "fmv.d ft2, %[zero] \n",
+        [one] "f"(1.0), [zero] "f"(0.0));
+    fpmath_pass_end();
+
+    fpmath_log1p(NULL, carry, count, NULL, frep);
+
+    fpmath_pass_begin(arr, carry, 1, 1, result, count);
+    FPMATH_PASS(frep, count, 2,
+        "fmax.d ft3, ft0, %[zero] \n"
+        "fadd.d ft2, ft3, ft1 \n",
+        [zero] "f"(0.0));
+    fpmath_pass_end();
+}
+
+static inline void softplus_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
+
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        softplus_block(arr + i, count, result + i, carry, frep);
+    }
+}
+
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int softplus_ssr(double* arr, const size_t n, double* result) {
+    softplus_range(arr, n, result, 0);
+    return 0;
+}
+
+__attribute__((noinline))
+int softplus_ssr_frep(double* arr, const size_t n, double* result) {
+    softplus_range(arr, n, result, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int softplus_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    softplus_baseline(arr + first, count, result + first);
+    return 0;
+}
+
+__attribute__((noinline))
+int softplus_ssr_frep_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    softplus_range(arr + first, count, result + first, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int softplus_omp(double* arr, const size_t n, double* result) {
+#pragma omp parallel for
+    for (size_t i = 0; i < n; i++) {
+        result[i] = softplus(arr[i]);
+    }
+
+    return 0;
+}
+
+int softplus_ssr_frep_omp(double* arr, const size_t n, double* result) {
+    // The last thread is not used in OpenMP.
+    // This is probably the DM core.
+    unsigned core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        unsigned core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t count = local_range(n, core_idx, core_num, &first);
+
+        softplus_range(arr + first, count, result + first, 1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef LMQ_SOFTPLUS_H
+#define LMQ_SOFTPLUS_H
+
+#include <snrt.h>
+
+#include <math.h>
+
+/*
+ * Naive implementation of softplus. Calculates log(1 + exp(x)) of n elements starting at arr.
+ * The ssr versions run the FP only passes of fpmath (max relative error 1e-15 * max(1, |x|)),
+ * the parallel versions split the elements over the compute cores.
+ */
+int softplus_baseline(double* arr, const size_t n, double* result);
+int softplus_ssr(double* arr, const size_t n, double* result);
+int softplus_ssr_frep(double* arr, const size_t n, double* result);
+
+int softplus_parallel(double* arr, const size_t n, double* result);
+int softplus_ssr_frep_parallel(double* arr, const size_t n, double* result);
+
+int softplus_omp(double* arr, const size_t n, double* result);
+int softplus_ssr_frep_omp(double* arr, const size_t n, double* result);
+
+#endif
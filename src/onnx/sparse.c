@@ -0,0 +1,327 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "sparse.h"
+#include "fpmath.h"
+#include "reduce.h"
+#include "kernel.h"
+
+// Nonzeros per gathered block of spmm, SPARSE_COLS doubles each
+#define SPARSE_BLOCK_NNZ (SPARSE_BLOCK / SPARSE_COLS)
+
+size_t csr_from_dense(const double* a, const size_t m, const size_t n, uint32_t* row_ptr, uint32_t* col_idx,
+                      double* values, csr_t* csr) {
+    size_t nnz = 0;
+    for (size_t i = 0; i < m; i++) {
+        row_ptr[i] = nnz;
+        for (size_t j = 0; j < n; j++) {
+            if (a[i * n + j] != 0.0) {
+                col_idx[nnz] = j;
+                values[nnz] = a[i * n + j];
+                nnz++;
+            }
+        }
+    }
+    row_ptr[m] = nnz;
+
+    csr->m = m;
+    csr->n = n;
+    csr->nnz = nnz;
+    csr->row_ptr = row_ptr;
+    csr->col_idx = col_idx;
+    csr->values = values;
+    return nnz;
+}
+
+/*
+ * The first row of part part of parts: the first row whose nonzeros start at or after part / parts of all
+ * nonzeros. The rows after the last nonzero belong to the last part.
+ */
+static size_t csr_row_bound(const csr_t* a, const size_t part, const size_t parts) {
+    if (part >= parts) {
+        return a->m;
+    }
+
+    uint32_t target = (uint64_t) a->nnz * part / parts;
+    size_t low = 0;
+    size_t high = a->m;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (a->row_ptr[mid] < target) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+size_t csr_row_split(const csr_t* a, const size_t core_idx, const size_t core_num, size_t* first) {
+    *first = csr_row_bound(a, core_idx, core_num);
+    return csr_row_bound(a, core_idx + 1, core_num) - *first;
+}
+
+__attribute__((noinline))
+int spmv_baseline(const csr_t* a, const double* x, double* result) {
+    for (size_t i = 0; i < a->m; i++) {
+        double acc = 0;
+        for (size_t j = a->row_ptr[i]; j < a->row_ptr[i + 1]; j++) {
+            acc += a->values[j] * x[a->col_idx[j]];
+        }
+        result[i] = acc;
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int spmm_baseline(const csr_t* a, const double* b, const size_t k, double* result) {
+    for (size_t i = 0; i < a->m; i++) {
+        for (size_t c = 0; c < k; c++) {
+            double acc = 0;
+            for (size_t j = a->row_ptr[i]; j < a->row_ptr[i + 1]; j++) {
+                acc += a->values[j] * b[a->col_idx[j] * k + c];
+            }
+            result[i * k + c] = acc;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Copies x[col_idx[j]] of count nonzeros into gather. The words are copied in integer registers,
+ * so no FP instruction issues while the FPU runs the previous block.
+ */
+static inline void spmv_gather(const double* x, const uint32_t* col_idx, const size_t count, double* gather) {
+    const uint32_t* words = (const uint32_t*) x;
+    uint32_t* out = (uint32_t*) gather;
+    for (size_t j = 0; j < count; j++) {
+        uint32_t col = col_idx[j];
+        out[2 * j] = words[2 * col];
+        out[2 * j + 1] = words[2 * col + 1];
+    }
+}
+
+/*
+ * Copies the columns [c0, c0 + w) of the rows col_idx[j] of b (n, k) of count nonzeros into gather,
+ * SPARSE_COLS doubles per nonzero and zero for the columns after w. Integer registers only like spmv_gather.
+ */
+static inline void spmm_gather(const double* b, const size_t k, const size_t c0, const size_t w,
+                               const uint32_t* col_idx, const size_t count, double* gather) {
+    const uint32_t* words = (const uint32_t*) (b + c0);
+    uint32_t* out = (uint32_t*) gather;
+    for (size_t j = 0; j < count; j++) {
+        const uint32_t* row = words + 2 * k * col_idx[j];
+        for (size_t c = 0; c < SPARSE_COLS; c++) {
+            out[2 * (j * SPARSE_COLS + c)] = c < w ? row[2 * c] : 0;
+            out[2 * (j * SPARSE_COLS + c) + 1] = c < w ? row[2 * c + 1] : 0;
+        }
+    }
+}
+
+/*
+ * result[first, first + rows) of a * x. The nonzeros of the rows are processed in blocks of SPARSE_BLOCK:
+ * ft0 streams the values and ft1 the gathered elements of x of a block. A row is the staggered dot product of
+ * its segment of the block, a row which crosses into the next block keeps its partial sum in acc.
+ */
+static inline void spmv_rows(const csr_t* a, const double* x, const size_t first, const size_t rows, double* result) {
+    double* gather = fpmath_carry();
+    size_t last = first + rows;
+
+    if (rows == 0) {
+        return;
+    }
+
+    size_t begin = a->row_ptr[first];
+    size_t end = a->row_ptr[last];
+    if (begin == end) {
+        for (size_t i = first; i < last; i++) {
+            result[i] = 0.0;
+        }
+        return;
+    }
+
+    spmv_gather(x, a->col_idx + begin, end - begin < SPARSE_BLOCK ? end - begin : SPARSE_BLOCK, gather);
+
+    size_t row = first;
+    double acc = 0.0;
+    for (size_t p = begin, buffer = 0; p < end; p += SPARSE_BLOCK, buffer ^= 1) {
+        size_t count = end - p < SPARSE_BLOCK ? end - p : SPARSE_BLOCK;
+        size_t block_end = p + count;
+
+        // The gathered elements have to be in memory before the stream reads them
+        asm volatile("" ::: "memory");
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*a->values));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) a->values + p);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, count, sizeof(*gather));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, gather + buffer * SPARSE_BLOCK);
+
+        snrt_ssr_enable();
+
+        // Rows which end in this block are written, empty rows included
+        for (size_t q = p; row < last;) {
+            size_t row_end = a->row_ptr[row + 1];
+            size_t segment = (row_end < block_end ? row_end : block_end) - q;
+            acc += reduce_dot_ssr_frep(segment);
+            q += segment;
+            if (q < row_end) {
+                break;
+            }
+            result[row++] = acc;
+            acc = 0.0;
+        }
+
+        // The FPU sequencer runs the FREPs on its own, the integer core gathers the next block meanwhile
+        if (block_end < end) {
+            size_t next = end - block_end < SPARSE_BLOCK ? end - block_end : SPARSE_BLOCK;
+            spmv_gather(x, a->col_idx + block_end, next, gather + (buffer ^ 1) * SPARSE_BLOCK);
+        }
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+/*
+ * result[first, first + rows) of a * b in chunks of SPARSE_COLS columns. Like spmv_rows, with blocks of
+ * SPARSE_BLOCK_NNZ nonzeros: every value is repeated for the SPARSE_COLS gathered columns of its row of b and
+ * a row of the result accumulates in acc0 - acc3.
+ */
+static inline void spmm_rows(const csr_t* a, const double* b, const size_t k, const size_t first, const size_t rows,
+                             double* result) {
+    double* gather = fpmath_carry();
+    size_t last = first + rows;
+
+    if (rows == 0 || k == 0) {
+        return;
+    }
+
+    size_t begin = a->row_ptr[first];
+    size_t end = a->row_ptr[last];
+    if (begin == end) {
+        for (size_t i = first * k; i < last * k; i++) {
+            result[i] = 0.0;
+        }
+        return;
+    }
+
+    for (size_t c0 = 0; c0 < k; c0 += SPARSE_COLS) {
+        size_t w = k - c0 < SPARSE_COLS ? k - c0 : SPARSE_COLS;
+
+        spmm_gather(b, k, c0, w, a->col_idx + begin, end - begin < SPARSE_BLOCK_NNZ ? end - begin : SPARSE_BLOCK_NNZ,
+                    gather);
+
+        size_t row = first;
+        double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+        for (size_t p = begin, buffer = 0; p < end; p += SPARSE_BLOCK_NNZ, buffer ^= 1) {
+            size_t count = end - p < SPARSE_BLOCK_NNZ ? end - p : SPARSE_BLOCK_NNZ;
+            size_t block_end = p + count;
+
+            asm volatile("" ::: "memory");
+            snrt_ssr_loop_1d(SNRT_SSR_DM0, count, sizeof(*a->values));
+            snrt_ssr_repeat(SNRT_SSR_DM0, SPARSE_COLS);
+            snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, (double*) a->values + p);
+
+            snrt_ssr_loop_1d(SNRT_SSR_DM1, count * SPARSE_COLS, sizeof(*gather));
+            snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+            snrt_ssr_read(SNRT_SSR_DM1, SNRT_SSR_1D, gather + buffer * SPARSE_BLOCK);
+
+            snrt_ssr_enable();
+
+            for (size_t q = p; row < last;) {
+                size_t row_end = a->row_ptr[row + 1];
+                size_t segment = (row_end < block_end ? row_end : block_end) - q;
+                if (segment > 0) {
+                    asm volatile(
+                        "frep.o %[n_frep], 4, 0, 0 \n"
+                        "fmadd.d %[acc0], ft0, ft1, %[acc0] \n"
+                        "fmadd.d %[acc1], ft0, ft1, %[acc1] \n"
+                        "fmadd.d %[acc2], ft0, ft1, %[acc2] \n"
+                        "fmadd.d %[acc3], ft0, ft1, %[acc3] \n"
+                        : [acc0] "+f"(acc0), [acc1] "+f"(acc1), [acc2] "+f"(acc2), [acc3] "+f"(acc3)
+                        : [n_frep] "r"(segment - 1)
+                        : "ft0", "ft1", "ft2"
+                    );
+                }
+                q += segment;
+                if (q < row_end) {
+                    break;
+                }
+
+                double* out = result + row * k + c0;
+                out[0] = acc0;
+                if (w > 1) {
+                    out[1] = acc1;
+                }
+                if (w > 2) {
+                    out[2] = acc2;
+                }
+                if (w > 3) {
+                    out[3] = acc3;
+                }
+                acc0 = acc1 = acc2 = acc3 = 0.0;
+                row++;
+            }
+
+            if (block_end < end) {
+                size_t next = end - block_end < SPARSE_BLOCK_NNZ ? end - block_end : SPARSE_BLOCK_NNZ;
+                spmm_gather(b, k, c0, w, a->col_idx + block_end, next, gather + (buffer ^ 1) * SPARSE_BLOCK);
+            }
+
+            snrt_fpu_fence();
+            snrt_ssr_disable();
+        }
+    }
+}
+
+__attribute__((noinline))
+int spmv_ssr_frep(const csr_t* a, const double* x, double* result) {
+    spmv_rows(a, x, 0, a->m, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int spmv_ssr_frep_parallel(const csr_t* a, const double* x, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t rows = csr_row_split(a, core_idx, core_num, &first);
+    spmv_rows(a, x, first, rows, result);
+    return 0;
+}
+
+KERNEL_DYNAMIC(spmv_ssr_frep_parallel_dynamic,
+               (const csr_t* a, const double* x, double* result), a->m, 0,
+               spmv_rows(a, x, first, count, result))
+
+__attribute__((noinline))
+int spmm_ssr_frep(const csr_t* a, const double* b, const size_t k, double* result) {
+    spmm_rows(a, b, k, 0, a->m, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int spmm_ssr_frep_parallel(const csr_t* a, const double* b, const size_t k, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t rows = csr_row_split(a, core_idx, core_num, &first);
+    spmm_rows(a, b, k, first, rows, result);
+    return 0;
+}
+
+KERNEL_DYNAMIC(spmm_ssr_frep_parallel_dynamic,
+               (const csr_t* a, const double* b, const size_t k, double* result), a->m, 0,
+               spmm_rows(a, b, k, first, count, result))
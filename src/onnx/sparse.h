@@ -0,0 +1,59 @@
+#ifndef LMQ_SPARSE_H
+#define LMQ_SPARSE_H
+
+#include <snrt.h>
+#include <stdint.h>
+
+#include "fpmath.h"
+
+/*
+ * A sparse (m, n) matrix in CSR: the nonzeros of row i are values[row_ptr[i]] to values[row_ptr[i + 1] - 1]
+ * in the columns col_idx[row_ptr[i]] to col_idx[row_ptr[i + 1] - 1]. row_ptr has m + 1 entries.
+ */
+typedef struct {
+    size_t m;
+    size_t n;
+    size_t nnz;
+    const uint32_t* row_ptr;
+    const uint32_t* col_idx;
+    const double* values;
+} csr_t;
+
+/*
+ * Fills row_ptr (m + 1), col_idx and values (both up to m * n) with the nonzeros of the dense (m, n) matrix a
+ * and csr with the description of them. Returns the number of nonzeros.
+ */
+size_t csr_from_dense(const double* a, const size_t m, const size_t n, uint32_t* row_ptr, uint32_t* col_idx,
+                      double* values, csr_t* csr);
+
+/*
+ * Splits the rows of a among core_num cores such that every core gets about the same number of nonzeros
+ * (instead of rows like local_range). Returns the number of rows of core core_idx, the first one in first.
+ */
+size_t csr_row_split(const csr_t* a, const size_t core_idx, const size_t core_num, size_t* first);
+
+/*
+ * Sparse matrix times dense vector: result (m) = a * x with x (n), and sparse matrix times dense matrix:
+ * result (m, k) = a * b with b (n, k), both row major.
+ * The runtime has no indirect SSR configuration, so the SSR+FREP versions gather the operands of a block of
+ * SPARSE_BLOCK nonzeros (x[col_idx[j]], or SPARSE_COLS columns of row col_idx[j] of b) on the integer core into
+ * a double buffer in the fpmath carry scratch, while the FPU multiplies and accumulates the previous block under
+ * FREP with the values streamed next to it. spmm accumulates SPARSE_COLS columns of a row of the result at once.
+ * The parallel versions split the rows with csr_row_split. The dynamic versions hand out chunks of rows with
+ * src/lmq/sched.h, which also balances the cost per row which does not depend on its nonzeros (f.ex. many short
+ * rows next to a few dense ones), they must be called by all compute cores.
+ */
+#define SPARSE_BLOCK FPMATH_BLOCK
+#define SPARSE_COLS 4
+
+int spmv_baseline(const csr_t* a, const double* x, double* result);
+int spmv_ssr_frep(const csr_t* a, const double* x, double* result);
+int spmv_ssr_frep_parallel(const csr_t* a, const double* x, double* result);
+int spmv_ssr_frep_parallel_dynamic(const csr_t* a, const double* x, double* result);
+
+int spmm_baseline(const csr_t* a, const double* b, const size_t k, double* result);
+int spmm_ssr_frep(const csr_t* a, const double* b, const size_t k, double* result);
+int spmm_ssr_frep_parallel(const csr_t* a, const double* b, const size_t k, double* result);
+int spmm_ssr_frep_parallel_dynamic(const csr_t* a, const double* b, const size_t k, double* result);
+
+#endif
@@ -0,0 +1,138 @@
+#include <snrt.h>
+
+#include "lmq.h"
+#include "sqrt.h"
+#include "fpmath.h"
+#include "kernel.h"
+
+__attribute__((noinline))
+int sqrt_baseline(const double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = sqrt_fast(arr[i]);
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int rsqrt_baseline(const double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = rsqrt_fast(arr[i]);
+    }
+    return 0;
+}
+
+/*
+ * Writes the seeds of 1 / sqrt for count elements of arr like rsqrt_fast (RSQRT_MAGIC minus half the high word,
+ * a NaN for negative elements) into a carry slot of every element. The words are read and written in integer
+ * registers, so no FP instruction issues.
+ */
+static inline void sqrt_seed(const double* arr, size_t count, double* carry) {
+    const uint32_t* words = (const uint32_t*) arr;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t* seed = (uint32_t*) (carry + i * FPMATH_CARRY);
+        uint32_t high = words[2 * i + 1];
+        uint32_t negative = -(high >> 31);
+        seed[0] = 0;
+        seed[1] = ((RSQRT_MAGIC - (high >> 1)) & ~negative) | (0x7ff80000u & negative);
+    }
+}
+
+/*
+ * sqrt (or 1 / sqrt if reciprocal is set) of the n elements at arr. The seed blocks are double buffered in slots
+ * 0 and 1 of the carry of fpmath: while the FPU runs the Newton steps of a block the integer core seeds the next one.
+ * ft0 streams x, ft1 the seeds and ft2 the results, the steps are y = y (3/2 - x/2 y^2).
+ */
+static inline void sqrt_range(const double* arr, const size_t n, double* result, int reciprocal, int frep) {
+    double* carry = fpmath_carry();
+
+    if (n == 0) {
+        return;
+    }
+
+    sqrt_seed(arr, n < SQRT_BLOCK ? n : SQRT_BLOCK, carry);
+
+    for (size_t i = 0, buffer = 0; i < n; i += SQRT_BLOCK, buffer ^= 1) {
+        size_t count = n - i < SQRT_BLOCK ? n - i : SQRT_BLOCK;
+
+        // The seeds have to be in memory before the stream reads them
+        asm volatile("" ::: "memory");
+        fpmath_pass_begin(arr + i, carry + buffer, 1, 1, result + i, count);
+
+        if (reciprocal) {
+            FPMATH_PASS(frep, count, 14,
+                "fmul.d ft5, ft0, %[half] \n"
+                "fmv.d ft4, ft1 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft4, ft4, ft6 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft4, ft4, ft6 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft4, ft4, ft6 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft2, ft4, ft6 \n",
+                [half] "f"(0.5), [three_halves] "f"(1.5));
+        } else {
+            // sqrt(x) = x / sqrt(x)
+            FPMATH_PASS(frep, count, 16,
+                "fmv.d ft3, ft0 \n"
+                "fmul.d ft5, ft3, %[half] \n"
+                "fmv.d ft4, ft1 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft4, ft4, ft6 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft4, ft4, ft6 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft4, ft4, ft6 \n"
+                "fmul.d ft6, ft4, ft4 \n"
+                "fnmsub.d ft6, ft6, ft5, %[three_halves] \n"
+                "fmul.d ft4, ft4, ft6 \n"
+                "fmul.d ft2, ft4, ft3 \n",
+                [half] "f"(0.5), [three_halves] "f"(1.5));
+        }
+
+        // The FPU sequencer runs the FREP on its own, the integer core seeds the next block meanwhile
+        if (i + count < n) {
+            size_t next = n - i - count < SQRT_BLOCK ? n - i - count : SQRT_BLOCK;
+            sqrt_seed(arr + i + count, next, carry + (buffer ^ 1));
+        }
+
+        fpmath_pass_end();
+    }
+}
+
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int sqrt_ssr(const double* arr, const size_t n, double* result) {
+    sqrt_range(arr, n, result, 0, 0);
+    return 0;
+}
+
+__attribute__((noinline))
+int sqrt_ssr_frep(const double* arr, const size_t n, double* result) {
+    sqrt_range(arr, n, result, 0, 1);
+    return 0;
+}
+
+KERNEL_PARALLEL(sqrt_ssr_frep_parallel, (const double* arr, const size_t n, double* result), n,
+                sqrt_range(arr + first, count, result + first, 0, 1))
+
+KERNEL_OMP(sqrt_ssr_frep_omp, (const double* arr, const size_t n, double* result), n,
+           sqrt_range(arr + first, count, result + first, 0, 1))
+
+__attribute__((noinline))
+int rsqrt_ssr_frep(const double* arr, const size_t n, double* result) {
+    sqrt_range(arr, n, result, 1, 1);
+    return 0;
+}
+
+KERNEL_PARALLEL(rsqrt_ssr_frep_parallel, (const double* arr, const size_t n, double* result), n,
+                sqrt_range(arr + first, count, result + first, 1, 1))
@@ -0,0 +1,27 @@
+#ifndef LMQ_SQRT_H
+#define LMQ_SQRT_H
+
+#include <snrt.h>
+
+#include "fpmath.h"
+
+/*
+ * ONNX Sqrt and 1 / sqrt (Reciprocal of Sqrt, f.ex. of the variance of a normalization), both without a division.
+ * The baselines call sqrt_fast and rsqrt_fast of lmq.h. The ssr versions stream x and its seeds from the exponent
+ * bits through RSQRT_STEPS Newton steps, the integer core computes the seeds of the next block of SQRT_BLOCK
+ * elements while the FPU runs the current one under FREP. At most RSQRT_MAX_ULP (3) ulp for normal x > 0, x < 0
+ * gives a NaN and sqrt(0) is 0. The parallel versions split the elements over the compute cores.
+ */
+#define SQRT_BLOCK FPMATH_BLOCK
+
+int sqrt_baseline(const double* arr, const size_t n, double* result);
+int sqrt_ssr(const double* arr, const size_t n, double* result);
+int sqrt_ssr_frep(const double* arr, const size_t n, double* result);
+int sqrt_ssr_frep_parallel(const double* arr, const size_t n, double* result);
+int sqrt_ssr_frep_omp(const double* arr, const size_t n, double* result);
+
+int rsqrt_baseline(const double* arr, const size_t n, double* result);
+int rsqrt_ssr_frep(const double* arr, const size_t n, double* result);
+int rsqrt_ssr_frep_parallel(const double* arr, const size_t n, double* result);
+
+#endif
@@ -3,7 +3,13 @@
 #include "lmq.h"
 #include "sum.h"
 #include <snrt.h>
+
+#ifndef LMQ_HOST
+#include "reduce.h"
+#include "kernel.h"
+#include "tile.h"
 #include "omp.h"
+#endif
 
 __attribute__((noinline)) 
 int sum_baseline(double* arr, const size_t n, double* result) {
@@ -18,6 +24,8 @@ int sum_baseline(double* arr, const size_t n, double* result) {
     return 0;
 }
 
+#ifndef LMQ_HOST
+
 __attribute__((noinline)) 
 int sum_ssr(double *arr, const size_t n, double* result) {
     snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
@@ -65,48 +73,46 @@ int sum_ssr_frep(double *arr, const size_t n, double* result) {
     return 0;
 }
 
-double* result_arr;
+/*
+ * sum_ssr_frep with REDUCE_ACCUMULATORS staggered accumulators.
+ */
+__attribute__((noinline))
+int sum_ssr_frep_staggered(double *arr, const size_t n, double* result) {
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, n, sizeof(*arr));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
+
+    snrt_ssr_enable();
+
+    double s = reduce_sum_ssr_frep(n);
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+
+    *result = s;
+
+    return 0;
+}
+
+/*
+ * Every core sums a contiguous range, the partial sums are combined by reduce_cluster.
+ */
 __attribute__((noinline)) 
 int sum_parallel(double *arr, const size_t n, double* result) {
     size_t core_num = snrt_cluster_core_num() - 1;
     size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
 
-    if (core_idx == 0) {
-        result_arr = allocate(core_num , sizeof(double));
-    }
-
-    // sum parallel
-    int do_extra = 0;
-    if (core_idx < n - local_n * core_num) {
-        do_extra = 1;
-    }
     double priv_sum = 0.0;
-
-    for (unsigned i = local_n * core_idx; i < local_n * (core_idx + 1); i++) {
-        priv_sum += arr[i];
-        // printf("Core %d is adding %f\n", core_idx, arr[i]);
-    }
-
-    if (do_extra) {
-        priv_sum += arr[core_num * local_n + core_idx];
+    if (!snrt_is_dm_core()) {
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
+        for (size_t i = first; i < first + local_n; i++) {
+            priv_sum += arr[i];
+        }
     }
 
-    // For some reason the following barrier is needed
-    snrt_cluster_hw_barrier();
-    // printf("Core %d sets it to %f\n", core_idx, priv_sum);
-
-    result_arr[core_idx] = priv_sum;
-
-    snrt_cluster_hw_barrier();
-    
+    double sum = reduce_cluster(REDUCE_SUM, priv_sum, 0, NULL);
     if (core_idx == 0) {
-        double sum = 0.0;
-        for (uint32_t i = 0; i < core_num; i++) {
-            sum += result_arr[i];
-            // printf("Core %d has sum: %f\n", i, result_arr[i]);
-        }
-        
         *result = sum;
     }
 
@@ -117,54 +123,30 @@ __attribute__((noinline))
 int sum_ssr_parallel(double *arr, const size_t n, double* result) {
     size_t core_num = snrt_cluster_core_num() - 1;
     size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
-
-    if (core_idx == 0) {
-        result_arr = allocate(core_num , sizeof(double));
-    }
-    
-    // sum parallel
-    int do_extra = 0;
-    if (core_idx < n - local_n * core_num) {
-        do_extra = 1;
-    }
 
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + core_idx * local_n);
+    register double priv_sum = 0.0;
+    if (!snrt_is_dm_core()) {
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
 
-    snrt_ssr_enable();
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + first);
 
-    register double priv_sum = 0;
-    for (size_t i = 0; i < local_n; i++) {
-        asm volatile(
-            "fadd.d %[s], ft0, %[s] \n"
-            : [s] "+f"(priv_sum) :: "ft0"
-        );
-    }
+        snrt_ssr_enable();
 
-    snrt_ssr_disable();
+        for (size_t i = 0; i < local_n; i++) {
+            asm volatile(
+                "fadd.d %[s], ft0, %[s] \n"
+                : [s] "+f"(priv_sum) :: "ft0"
+            );
+        }
 
-    // This is only constant overhead (actually O(#cores))
-    if (do_extra) {
-        priv_sum += arr[core_num * local_n + core_idx];
+        snrt_ssr_disable();
     }
 
-    // For some reason the following barrier is needed
-    snrt_cluster_hw_barrier();
-    // printf("Core %d sets it to %f\n", core_idx, priv_sum);
-
-    result_arr[core_idx] = priv_sum;
-
-    snrt_cluster_hw_barrier();
-    
+    double sum = reduce_cluster(REDUCE_SUM, priv_sum, 0, NULL);
     if (core_idx == 0) {
-        double sum = 0.0;
-        for (size_t i = 0; i < core_num; i++) {
-            sum += result_arr[i];
-            // printf("Core %d has sum: %f\n", i, result_arr[i]);
-        }
-        
         *result = sum;
     }
 
@@ -175,170 +157,128 @@ __attribute__((noinline))
 int sum_ssr_frep_parallel(double *arr, const size_t n, double* result) {
     size_t core_num = snrt_cluster_core_num() - 1;
     size_t core_idx = snrt_cluster_core_idx();
-    size_t local_n = n / core_num;
 
-    if (core_idx == 0) {
-        result_arr = allocate(core_num , sizeof(double));
-    }
-    
-    // sum parallel
-    int do_extra = 0;
-    if (core_idx < n - local_n * core_num) {
-        do_extra = 1;
-    }
-
-    snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
-    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + core_idx * local_n);
+    double priv_sum = 0.0;
+    if (!snrt_is_dm_core()) {
+        size_t first;
+        size_t local_n = local_range(n, core_idx, core_num, &first);
 
-    snrt_ssr_enable();
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + first);
 
-    register double priv_sum;
-    asm volatile(
-        "addi x5, zero, 0\n"
-        "fcvt.d.w %[s], x5\n" // sets s to zero
-        "frep.o %[n_frep], 1, 0, 0 \n"
-        "fadd.d %[s], ft0, %[s] \n"
-        : [s] "+f"(priv_sum) : [n_frep] "r"(local_n - 1) : "ft0"
-    );
+        snrt_ssr_enable();
 
-    snrt_ssr_disable();
+        priv_sum = reduce_sum_ssr_frep(local_n);
 
-    // This is only constant overhead (actually O(#cores))
-    if (do_extra) {
-        priv_sum += arr[core_num * local_n + core_idx];
+        snrt_fpu_fence();
+        snrt_ssr_disable();
     }
 
-    // For some reason the following barrier is needed
-    snrt_cluster_hw_barrier();
-    // printf("Core %d sets it to %f\n", core_idx, priv_sum);
-
-    result_arr[core_idx] = priv_sum;
-
-    snrt_cluster_hw_barrier();
-    
+    double sum = reduce_cluster(REDUCE_SUM, priv_sum, 0, NULL);
     if (core_idx == 0) {
-        double sum = 0.0;
-        for (size_t i = 0; i < core_num; i++) {
-            sum += result_arr[i];
-            // printf("Core %d has sum: %f\n", i, result_arr[i]);
-        }
-        
         *result = sum;
     }
 
     return 0;
 }
 
-// __attribute__((noinline)) 
-// int sum_omp_fail(double *arr, const size_t n, double* result) {
-//     double sum = 0.0;
-// 
-// #pragma omp parallel for reduction(+:sum)
-//     for (unsigned i = 0; i < n; i++) {
-//         sum += arr[i];
-//     }
-// 
-//     return sum;
-// }
-
-__attribute__((noinline)) 
-int sum_omp(double *arr, const size_t n, double* result) {
-    unsigned core_num = snrt_cluster_core_num() - 1;
-    /*
-     * We need this array to store the result of each core.
-     * As a reduction cannot be compiled (results in endless loop)
-     */
-    double* result_arr = allocate(snrt_cluster_core_num(), sizeof(double));
-#pragma omp parallel
-    {
-        double priv_sum = 0.0;
-        unsigned core_idx = snrt_cluster_core_idx();
-        // printf("HERE %d\n", core_idx);
-        size_t local_n = n / core_num;
-        int do_extra = 0;
-        if (core_idx < n - local_n * core_num) {
-            do_extra = 1;
-        }
+/*
+ * reduction(+:sum) does not link against the snRuntime (__kmpc_reduce_nowait is missing), the OMP versions
+ * combine the partial sums of the cores with reduce_team inside the parallel region instead.
+ */
+KERNEL_REDUCE_OMP(sum_omp, (double *arr, const size_t n, double* result), n, REDUCE_SUM, 0.0,
+                  sum_baseline(arr + first, count, &partial), result)
+KERNEL_REDUCE_OMP(sum_ssr_omp, (double *arr, const size_t n, double* result), n, REDUCE_SUM, 0.0,
+                  sum_ssr(arr + first, count, &partial), result)
+KERNEL_REDUCE_OMP(sum_ssr_frep_omp, (double *arr, const size_t n, double* result), n, REDUCE_SUM, 0.0,
+                  sum_ssr_frep_staggered(arr + first, count, &partial), result)
+
+static int sum_tile_kernel(const double* arr, const size_t n, double* result) {
+    return sum_ssr_frep_staggered((double*) arr, n, result);
+}
 
-        for (unsigned i = local_n * core_idx; i < local_n * (core_idx + 1); i++) {
-            priv_sum += arr[i];
-        }
+/*
+ * The DM core fetches the next tile into L1 while the compute cores sum the current one.
+ */
+__attribute__((noinline))
+int sum_ssr_frep_tiled(double *arr, const size_t n, double* result) {
+    return tile_reduce(sum_tile_kernel, REDUCE_SUM, arr, n, result);
+}
 
-        if (do_extra) {
-            priv_sum += arr[core_num * local_n + core_idx];
-        }
+__attribute__((noinline))
+int sum_stream_baseline(sum_stream_t* state, double* chunk, const size_t n) {
+    double sum = 0.0;
+    sum_baseline(chunk, n, &sum);
+    state->sum += sum;
+    state->count += n;
+    return 0;
+}
 
-        result_arr[core_idx] = priv_sum;
+__attribute__((noinline))
+int sum_stream_ssr_frep(sum_stream_t* state, double* chunk, const size_t n) {
+    if (n == 0) {
+        return 0;
     }
 
-    // Core 0 is alone again, or is he not?
+    double sum;
+    sum_ssr_frep_staggered(chunk, n, &sum);
+    state->sum += sum;
+    state->count += n;
+    return 0;
+}
+
+__attribute__((noinline))
+int sum_stream_ssr_frep_parallel(sum_stream_t* state, double* chunk, const size_t n) {
     double sum = 0.0;
-    for (int i = 0; i < core_num; i++) {
-        sum += result_arr[i];
-    }
 
-    *result = sum;
+    sum_ssr_frep_parallel(chunk, n, &sum);
+    if (snrt_cluster_core_idx() == 0) {
+        state->sum += sum;
+        state->count += n;
+    }
+    snrt_cluster_hw_barrier();
+    return 0;
+}
 
+__attribute__((noinline))
+int sum_baseline_f32(float *arr, const size_t n, float* result) {
+    float s = 0;
+    for (size_t i = 0; i < n; i++) {
+        s += arr[i];
+    }
+    *result = s;
     return 0;
 }
 
-double* result_arr;
-__attribute__((noinline)) 
-int sum_ssr_omp(double *arr, const size_t n, double* result) {
-    unsigned core_num = snrt_cluster_core_num() - 1;
-    /*
-     * We need this array to store the result of each core.
-     * As a reduction cannot be compiled (results in endless loop)
-     */
-    result_arr = allocate(snrt_cluster_core_num(), sizeof(double));
-#pragma omp parallel
-    {
-        register double priv_sum = 0.0;
-        unsigned core_idx = snrt_cluster_core_idx();
-        // printf("HERE %d\n", core_idx);
-        size_t local_n = n / core_num;
-        int do_extra = 0;
-        if (core_idx < n - local_n * core_num) {
-            do_extra = 1;
-        }
+/*
+ * float32 sum. Both lanes of the packed accumulator are summed up at the end.
+ */
+__attribute__((noinline))
+int sum_ssr_frep_f32(float *arr, const size_t n, float* result) {
+    size_t pairs = n / 2;
+    f32x2_t s = { .d = 0.0 };
 
-        snrt_ssr_loop_1d(SNRT_SSR_DM0, local_n, sizeof(*arr));
+    if (pairs > 0) {
+        snrt_ssr_loop_1d(SNRT_SSR_DM0, pairs, sizeof(f32x2_t));
         snrt_ssr_repeat(SNRT_SSR_DM0, 1);
-        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr + core_idx * local_n);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
 
         snrt_ssr_enable();
 
-        for (size_t i = 0; i < local_n; i++) {
-            asm volatile(
-                "fadd.d %[s], ft0, %[s] \n"
-                : [s] "+f"(priv_sum) :: "ft0"
-            );
-        }
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0 \n"
+            "vfadd.s %[s], ft0, %[s] \n"
+            : [s] "+f"(s.d) : [n_frep] "r"(pairs - 1) : "ft0"
+        );
 
+        snrt_fpu_fence();
         snrt_ssr_disable();
-
-        if (do_extra) {
-            // priv_sum += arr[core_num * local_n + core_idx];
-        }
-
-        result_arr[core_idx] = priv_sum;
     }
 
-    // Core 0 is alone again, or is he not?
-    double sum = 0.0;
-    for (int i = 0; i < core_num; i++) {
-        printf("Core %d sum: %f\n", i, result_arr[i]);
-        sum += result_arr[i];
-    }
-
-    *result = sum;
+    *result = s.f[0] + s.f[1] + (n % 2 ? arr[n - 1] : 0.0f);
 
     return 0;
 }
 
-__attribute__((noinline)) 
-int sum_ssr_frep_omp(double *arr, const size_t n, double* result) {
-
-    return 0;
-}
+#endif // LMQ_HOST
@@ -7,14 +7,48 @@
 int sum_baseline(double *arr, const size_t n, double* result);
 int sum_ssr(double *arr, const size_t n, double* result);
 int sum_ssr_frep(double *arr, const size_t n, double* result);
+/*
+ * Sums into REDUCE_ACCUMULATORS staggered accumulators (see reduce.h).
+ */
+int sum_ssr_frep_staggered(double *arr, const size_t n, double* result);
 
 int sum_parallel(double *arr, const size_t n, double* result);
 int sum_ssr_parallel(double *arr, const size_t n, double* result);
 int sum_ssr_frep_parallel(double *arr, const size_t n, double* result);
+/*
+ * Streams arr through L1 in double buffered tiles (src/lmq/tile.h), must be called by all cores of the cluster.
+ */
+int sum_ssr_frep_tiled(double *arr, const size_t n, double* result);
 
-// int sum_omp_fail(double *arr, const size_t n, double* result);
+/*
+ * Streaming sum over a tensor handed in chunk by chunk (f.ex. as it arrives from the host, the chunks may have
+ * any sizes), so the whole tensor never has to be in memory. state carries the sum and the number of elements
+ * of the chunks so far (their mean is sum / count), sum_stream_init starts a new tensor.
+ * The parallel version must be called by all cores of the cluster with the same state, core 0 updates it
+ * before the call returns on any core.
+ */
+typedef struct {
+    double sum;
+    size_t count;
+} sum_stream_t;
+
+static inline void sum_stream_init(sum_stream_t* state) {
+    state->sum = 0.0;
+    state->count = 0;
+}
+
+int sum_stream_baseline(sum_stream_t* state, double* chunk, const size_t n);
+int sum_stream_ssr_frep(sum_stream_t* state, double* chunk, const size_t n);
+int sum_stream_ssr_frep_parallel(sum_stream_t* state, double* chunk, const size_t n);
+
+/*
+ * Generated by KERNEL_REDUCE_OMP (src/lmq/kernel.h), core 0 writes the result.
+ */
 int sum_omp(double *arr, const size_t n, double* result);
 int sum_ssr_omp(double *arr, const size_t n, double* result);
 int sum_ssr_frep_omp(double *arr, const size_t n, double* result);
 
+int sum_baseline_f32(float *arr, const size_t n, float* result);
+int sum_ssr_frep_f32(float *arr, const size_t n, float* result);
+
 #endif
@@ -0,0 +1,169 @@
+#include <snrt.h>
+
+#include <math.h>
+#include "omp.h"
+#include "lmq.h"
+#include "tanh.h"
+#include "fpmath.h"
+#include "lut.h"
+
+/*
+ * Naive implementation of tanh. Calculates the tanh of n elements starting at arr.
+ */
+__attribute__((noinline))
+int tanh_baseline(double* arr, const size_t n, double* result) {
+    for (size_t i = 0; i < n; i++) {
+        result[i] = tanh(arr[i]);
+    }
+
+    return 0;
+}
+
+/*
+ * tanh(x) = sign(x) * -d / (2 + d) with d = expm1(-2 |x|) in (-1, 0], which has no cancellation for small x
+ * and no overflow for large x. Runs the passes for the block of count <= FPMATH_BLOCK elements at arr.
+ */
+static inline void tanh_block(double* arr, size_t count, double* result, double* carry, int frep) {
+    fpmath_pass_begin(arr, carry, 0, 1, NULL, count);
+    FPMATH_PASS(frep, count, 2,
+        "fsgnjn.d ft3, ft0, %[one] \n"
+        "fadd.d ft2, ft3, ft3 \n",
+        [one] "f"(1.0));
+    fpmath_pass_end();
+
+    fpmath_expm1(carry, count, frep);
+
+    fpmath_pass_begin(arr, carry, 1, 1, result, count);
+    FPMATH_PASS(frep, count, 4,
+        "fmv.d ft3, ft1 \n"
+        "fadd.d ft4, ft3, %[two] \n"
+        "fdiv.d ft3, ft3, ft4 \n"
+        "fsgnj.d ft2, ft3, ft0 \n",
+        [two] "f"(2.0));
+    fpmath_pass_end();
+}
+
+static inline void tanh_range(double* arr, const size_t n, double* result, int frep) {
+    double* carry = fpmath_carry();
+
+    for (size_t i = 0; i < n; i += FPMATH_BLOCK) {
+        size_t count = n - i < FPMATH_BLOCK ? n - i : FPMATH_BLOCK;
+        tanh_block(arr + i, count, result + i, carry, frep);
+    }
+}
+
+/*
+ * SSR stays enabled in the passes, every pass issues its body once per element.
+ */
+__attribute__((noinline))
+int tanh_ssr(double* arr, const size_t n, double* result) {
+    tanh_range(arr, n, result, 0);
+    return 0;
+}
+
+__attribute__((noinline))
+int tanh_ssr_frep(double* arr, const size_t n, double* result) {
+    tanh_range(arr, n, result, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int tanh_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    tanh_baseline(arr + first, count, result + first);
+    return 0;
+}
+
+__attribute__((noinline))
+int tanh_ssr_frep_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    tanh_range(arr + first, count, result + first, 1);
+    return 0;
+}
+
+__attribute__((noinline))
+int tanh_omp(double* arr, const size_t n, double* result) {
+#pragma omp parallel for
+    for (size_t i = 0; i < n; i++) {
+        result[i] = tanh(arr[i]);
+    }
+
+    return 0;
+}
+
+int tanh_ssr_frep_omp(double* arr, const size_t n, double* result) {
+    // The last thread is not used in OpenMP.
+    // This is probably the DM core.
+    unsigned core_num = snrt_cluster_core_num() - 1;
+
+#pragma omp parallel
+    {
+        unsigned core_idx = snrt_cluster_core_idx();
+        size_t first;
+        size_t count = local_range(n, core_idx, core_num, &first);
+
+        tanh_range(arr + first, count, result + first, 1);
+    }
+
+    return 0;
+}
+
+// Outside of [-TANH_LUT_X, TANH_LUT_X] tanh is within 1e-6 of -1 or 1
+#define TANH_LUT_X 7.5
+// max |tanh''| = 4 / (3 sqrt(3))
+#define TANH_LUT_D2 0.769800358919501
+
+static lut_t tanh_table;
+
+static inline int tanh_lut_init() {
+    return lut_init(&tanh_table, tanh, -TANH_LUT_X, TANH_LUT_X,
+                    lut_size(-TANH_LUT_X, TANH_LUT_X, TANH_LUT_D2, LUT_MAX_ERROR), 0.0);
+}
+
+/*
+ * Linear interpolation in a table of tanh in L1, which is built on the first call.
+ */
+__attribute__((noinline))
+int tanh_lut(double* arr, const size_t n, double* result) {
+    if (tanh_lut_init() != 0) {
+        return -1;
+    }
+
+    lut_eval(&tanh_table, arr, n, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int tanh_lut_parallel(double* arr, const size_t n, double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    if (tanh_lut_init() != 0) {
+        return -1;
+    }
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    lut_eval(&tanh_table, arr + first, count, result + first);
+    return 0;
+}
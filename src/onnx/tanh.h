@@ -0,0 +1,30 @@
+#ifndef LMQ_TANH_H
+#define LMQ_TANH_H
+
+#include <snrt.h>
+
+#include <math.h>
+
+/*
+ * Naive implementation of tanh. Calculates the tanh of n elements starting at arr.
+ * The ssr versions run the FP only passes of fpmath on expm1(-2 |x|) (max relative error 1e-15),
+ * the parallel versions split the elements over the compute cores.
+ */
+int tanh_baseline(double* arr, const size_t n, double* result);
+int tanh_ssr(double* arr, const size_t n, double* result);
+int tanh_ssr_frep(double* arr, const size_t n, double* result);
+
+int tanh_parallel(double* arr, const size_t n, double* result);
+int tanh_ssr_frep_parallel(double* arr, const size_t n, double* result);
+
+int tanh_omp(double* arr, const size_t n, double* result);
+int tanh_ssr_frep_omp(double* arr, const size_t n, double* result);
+
+/*
+ * Lookup table versions (src/lmq/lut.h) with max absolute error LUT_MAX_ERROR.
+ * The table is built in L1 on the first call.
+ */
+int tanh_lut(double* arr, const size_t n, double* result);
+int tanh_lut_parallel(double* arr, const size_t n, double* result);
+
+#endif
@@ -0,0 +1,239 @@
+#include <snrt.h>
+
+#include <math.h>
+
+#include "lmq.h"
+#include "topk.h"
+#include "reduce.h"
+
+/*
+ * Whether element a (at index ia) comes before element b (at index ib) in the output.
+ */
+static inline int topk_better(int largest, double a, size_t ia, double b, size_t ib) {
+    if (a == b) {
+        return ia < ib;
+    }
+    return largest ? a > b : a < b;
+}
+
+__attribute__((noinline))
+int topk_baseline(const double* arr, const size_t n, const size_t k, int largest, int sorted,
+                  double* values, size_t* indices) {
+    if (k > n) {
+        return -1;
+    }
+    if (k == 0) {
+        return 0;
+    }
+
+    size_t len = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (len == k && !topk_better(largest, arr[i], i, values[k - 1], indices[k - 1])) {
+            continue;
+        }
+        // Shift the worse elements back, the last one drops out once the outputs are full
+        size_t j = len < k ? len++ : k - 1;
+        while (j > 0 && topk_better(largest, arr[i], i, values[j - 1], indices[j - 1])) {
+            values[j] = values[j - 1];
+            indices[j] = indices[j - 1];
+            j--;
+        }
+        values[j] = arr[i];
+        indices[j] = i;
+    }
+    return 0;
+}
+
+/*
+ * Restores the heap of len entries below entry i, in which every entry is worse than its children.
+ */
+static void topk_sift_down(double* values, size_t* indices, size_t len, size_t i, int largest) {
+    for (;;) {
+        size_t worst = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < len && topk_better(largest, values[worst], indices[worst], values[left], indices[left])) {
+            worst = left;
+        }
+        if (right < len && topk_better(largest, values[worst], indices[worst], values[right], indices[right])) {
+            worst = right;
+        }
+        if (worst == i) {
+            return;
+        }
+
+        double value = values[i];
+        size_t index = indices[i];
+        values[i] = values[worst];
+        indices[i] = indices[worst];
+        values[worst] = value;
+        indices[worst] = index;
+        i = worst;
+    }
+}
+
+/*
+ * Sorts the heap of len entries from the best entry on: the root is the worst entry, it is swapped behind
+ * the shrinking heap.
+ */
+static void topk_sort(double* values, size_t* indices, size_t len, int largest) {
+    for (size_t end = len; end-- > 1;) {
+        double value = values[0];
+        size_t index = indices[0];
+        values[0] = values[end];
+        indices[0] = indices[end];
+        values[end] = value;
+        indices[end] = index;
+        topk_sift_down(values, indices, end, 0, largest);
+    }
+}
+
+/*
+ * Streams the block elements at arr (at least one) through ft0 and writes the offsets of the elements which
+ * are better than threshold to candidates. Equal elements are skipped: they come after the root of the heap,
+ * which threshold is, so they are worse. Returns the number of candidates.
+ */
+static inline size_t topk_filter_ssr(const double* arr, size_t block, double threshold, int largest,
+                                     uint32_t* candidates) {
+    uint32_t* next = candidates;
+
+    snrt_ssr_loop_1d(SNRT_SSR_DM0, block, sizeof(*arr));
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_1D, arr);
+
+    snrt_ssr_enable();
+
+    if (largest) {
+        asm volatile(
+            "li a0, 0 \n"                           // a0 is the offset
+            "1: \n"
+            "flt.d a1, %[threshold], ft0 \n"        // threshold < arr[a0]
+            "beqz a1, 2f \n"
+            "sw a0, 0(%[next]) \n"
+            "addi %[next], %[next], 4 \n"
+            "2: \n"
+            "addi a0, a0, 1 \n"
+            "blt a0, %[block], 1b \n"
+            : [next] "+r"(next)
+            : [threshold] "f"(threshold), [block] "r"(block)
+            : "ft0", "a0", "a1", "memory"
+        );
+    } else {
+        asm volatile(
+            "li a0, 0 \n"
+            "1: \n"
+            "flt.d a1, ft0, %[threshold] \n"        // arr[a0] < threshold
+            "beqz a1, 2f \n"
+            "sw a0, 0(%[next]) \n"
+            "addi %[next], %[next], 4 \n"
+            "2: \n"
+            "addi a0, a0, 1 \n"
+            "blt a0, %[block], 1b \n"
+            : [next] "+r"(next)
+            : [threshold] "f"(threshold), [block] "r"(block)
+            : "ft0", "a0", "a1", "memory"
+        );
+    }
+
+    snrt_ssr_disable();
+
+    return next - candidates;
+}
+
+/*
+ * Builds the heap of the best min(k, count) of the count elements of arr from first in values and indices
+ * (the indices into arr), returns its length.
+ */
+static size_t topk_heap_ssr(const double* arr, const size_t first, const size_t count, const size_t k,
+                            int largest, double* values, size_t* indices) {
+    size_t len = count < k ? count : k;
+    if (len == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        values[i] = arr[first + i];
+        indices[i] = first + i;
+    }
+    for (size_t i = len / 2; i-- > 0;) {
+        topk_sift_down(values, indices, len, i, largest);
+    }
+
+    uint32_t candidates[TOPK_BLOCK];
+    for (size_t start = len; start < count; start += TOPK_BLOCK) {
+        size_t block = count - start < TOPK_BLOCK ? count - start : TOPK_BLOCK;
+        size_t num = topk_filter_ssr(arr + first + start, block, values[0], largest, candidates);
+
+        // The root may have become better than later candidates of the block
+        for (size_t c = 0; c < num; c++) {
+            size_t i = first + start + candidates[c];
+            if (topk_better(largest, arr[i], i, values[0], indices[0])) {
+                values[0] = arr[i];
+                indices[0] = i;
+                topk_sift_down(values, indices, len, 0, largest);
+            }
+        }
+    }
+    return len;
+}
+
+__attribute__((noinline))
+int topk_ssr(const double* arr, const size_t n, const size_t k, int largest, int sorted,
+             double* values, size_t* indices) {
+    if (k > n) {
+        return -1;
+    }
+
+    size_t len = topk_heap_ssr(arr, 0, n, k, largest, values, indices);
+    if (sorted) {
+        topk_sort(values, indices, len, largest);
+    }
+    return 0;
+}
+
+__attribute__((noinline))
+int topk_ssr_parallel(const double* arr, const size_t n, const size_t k, int largest, int sorted,
+                      double* values, size_t* indices, double* scratch_values, size_t* scratch_indices) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+
+    if (k > n) {
+        return -1;
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    double* heap_values = scratch_values + core_idx * k;
+    size_t* heap_indices = scratch_indices + core_idx * k;
+
+    size_t first;
+    size_t count = local_range(n, core_idx, core_num, &first);
+    size_t len = topk_heap_ssr(arr, first, count, k, largest, heap_values, heap_indices);
+    topk_sort(heap_values, heap_indices, len, largest);
+
+    /*
+     * Every round takes the best head of the sorted lists. REDUCE_ARGMAX keeps the lower index on equal values,
+     * the smallest elements are the largest negated.
+     */
+    size_t head = 0;
+    for (size_t r = 0; r < k; r++) {
+        double value = -INFINITY;
+        int index = -1;
+        if (head < len) {
+            value = largest ? heap_values[head] : -heap_values[head];
+            index = heap_indices[head];
+        }
+
+        int best_index;
+        double best = reduce_team(REDUCE_ARGMAX, value, index, &best_index);
+        if (head < len && best_index == index) {
+            head++;
+        }
+        if (core_idx == 0) {
+            values[r] = largest ? best : -best;
+            indices[r] = best_index;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef LMQ_TOPK_H
+#define LMQ_TOPK_H
+
+#include <snrt.h>
+
+/*
+ * ONNX TopK of the n elements of arr (no NaN): the k largest (or with largest 0 the k smallest) elements
+ * in values and their indices into arr in indices. Of equal elements the one with the lower index comes first.
+ * The outputs are sorted from the best element on; with sorted 0 the order is unspecified (only topk_ssr
+ * leaves them in heap order then). Returns -1 if k > n.
+ *
+ * The baseline inserts every element into the sorted outputs. The SSR versions keep a binary heap of the
+ * k best elements so far whose root is the worst of them: the elements are streamed in blocks of TOPK_BLOCK
+ * through ft0 and only compared with the root, the indices of those which beat it are collected and inserted
+ * into the heap after the block. Once the heap holds large elements almost no element is inserted.
+ *
+ * The parallel version builds the heap of a contiguous range on every compute core in scratch_values and
+ * scratch_indices (k entries per compute core, which should be in TCDM), sorts it, and merges the sorted lists
+ * in k rounds of reduce_team in which every core offers its best element not yet taken.
+ * It must be called by all cores of the cluster, core 0 writes the outputs.
+ */
+#define TOPK_BLOCK 64
+
+int topk_baseline(const double* arr, const size_t n, const size_t k, int largest, int sorted,
+                  double* values, size_t* indices);
+int topk_ssr(const double* arr, const size_t n, const size_t k, int largest, int sorted,
+             double* values, size_t* indices);
+int topk_ssr_parallel(const double* arr, const size_t n, const size_t k, int largest, int sorted,
+                      double* values, size_t* indices, double* scratch_values, size_t* scratch_indices);
+
+#endif
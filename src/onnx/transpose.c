@@ -4,6 +4,10 @@
 #include <transpose.h>
 #include <float.h>
 
+#include "lmq.h"
+#include "kernel.h"
+#include "tile.h"
+
 /*
  * Naive implementation of transpose.
  * arr is in row major format and has dimensions (r, s)
@@ -79,3 +83,342 @@ int transpose_ssr_frep(const double* arr, const size_t r, const size_t s, double
 
     return 0;
 }
+
+/*
+ * Transposes the columns [first, first + count) of the (r, s) matrix arr into the rows of result (which has r columns).
+ */
+static void transpose_columns_ssr(const double* arr, size_t r, size_t s, size_t first, size_t count, double* result) {
+    size_t tiles = r / TRANSPOSE_TILE;
+    size_t rest = r - tiles * TRANSPOSE_TILE;
+
+    if (count == 0) {
+        return;
+    }
+
+    if (tiles > 0) {
+        // Loops: row in the tile, column, tile
+        snrt_ssr_loop_3d(SNRT_SSR_DM0, TRANSPOSE_TILE, count, tiles,
+                         sizeof(double) * s, sizeof(double), sizeof(double) * s * TRANSPOSE_TILE);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_3D, (double*) arr + first);
+
+        snrt_ssr_loop_3d(SNRT_SSR_DM1, TRANSPOSE_TILE, count, tiles,
+                         sizeof(double), sizeof(double) * r, sizeof(double) * TRANSPOSE_TILE);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_3D, result + first * r);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0\n"
+            "fmv.d ft1, ft0\n"
+            :: [n_frep] "r"(TRANSPOSE_TILE * count * tiles - 1)
+            : "ft0", "ft1", "memory"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+
+    if (rest > 0) {
+        snrt_ssr_loop_2d(SNRT_SSR_DM0, rest, count, sizeof(double) * s, sizeof(double));
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_2D, (double*) arr + tiles * TRANSPOSE_TILE * s + first);
+
+        snrt_ssr_loop_2d(SNRT_SSR_DM1, rest, count, sizeof(double), sizeof(double) * r);
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_2D, result + first * r + tiles * TRANSPOSE_TILE);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0\n"
+            "fmv.d ft1, ft0\n"
+            :: [n_frep] "r"(rest * count - 1)
+            : "ft0", "ft1", "memory"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int transpose_ssr_frep_blocked(const double* arr, const size_t r, const size_t s, double* result) {
+    transpose_columns_ssr(arr, r, s, 0, s, result);
+    return 0;
+}
+
+KERNEL_PARALLEL(transpose_ssr_frep_parallel, (const double* arr, const size_t r, const size_t s, double* result), s,
+                transpose_columns_ssr(arr, r, s, first, count, result))
+
+KERNEL_OMP(transpose_ssr_frep_omp, (const double* arr, const size_t r, const size_t s, double* result), s,
+           transpose_columns_ssr(arr, r, s, first, count, result))
+
+/*
+ * Context of the tiled transpose, tile t is the band of rows [t * rows, (t + 1) * rows) of arr.
+ */
+typedef struct {
+    const double* arr;
+    double* result;
+    size_t r;
+    size_t s;
+    size_t rows;
+
+    double* l1_band[LMQ_TILE_SLOTS];
+    double* l1_transposed[LMQ_TILE_SLOTS];
+} transpose_tiled_t;
+
+static size_t transpose_tile_rows(const transpose_tiled_t* t, size_t tile) {
+    size_t start = tile * t->rows;
+    return t->r - start < t->rows ? t->r - start : t->rows;
+}
+
+static void transpose_tile_load(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    const transpose_tiled_t* t = p->ctx;
+    size_t rows = transpose_tile_rows(t, tile);
+
+    snrt_dma_start_1d(t->l1_band[slot], t->arr + tile * t->rows * t->s, rows * t->s * sizeof(double));
+}
+
+static void transpose_tile_store(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    const transpose_tiled_t* t = p->ctx;
+    size_t rows = transpose_tile_rows(t, tile);
+
+    // Row j of the transposed band is the part of row j of result from column tile * rows on
+    snrt_dma_start_2d(t->result + tile * t->rows, t->l1_transposed[slot], rows * sizeof(double),
+                      t->r * sizeof(double), rows * sizeof(double), t->s);
+}
+
+static void transpose_tile_compute(const tile_pipeline_t* p, size_t tile, size_t slot) {
+    const transpose_tiled_t* t = p->ctx;
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t rows = transpose_tile_rows(t, tile);
+
+    size_t first;
+    size_t count = local_range(t->s, core_idx, core_num, &first);
+    transpose_columns_ssr(t->l1_band[slot], rows, t->s, first, count, t->l1_transposed[slot]);
+}
+
+__attribute__((noinline))
+int transpose_tiled(const double* arr, const size_t r, const size_t s, double* result) {
+    double* l1 = tile_l1_scratch();
+
+    // Two slots of a band and its transpose, every buffer gets one guard element
+    size_t tile_n = LMQ_TILE_L1_SIZE / sizeof(double) / (2 * LMQ_TILE_SLOTS) - 1;
+    size_t rows = tile_n / (s > 0 ? s : 1);
+    if (rows == 0) {
+        return transpose_ssr_frep_parallel(arr, r, s, result);
+    }
+
+    transpose_tiled_t t = {
+        .arr = arr,
+        .result = result,
+        .r = r,
+        .s = s,
+        .rows = rows,
+    };
+    for (size_t slot = 0; slot < LMQ_TILE_SLOTS; slot++) {
+        t.l1_band[slot] = l1;
+        l1 += tile_n + 1;
+        t.l1_transposed[slot] = l1;
+        l1 += tile_n + 1;
+    }
+
+    tile_pipeline_t p = {
+        .num_tiles = s > 0 ? (r + rows - 1) / rows : 0,
+        .load = transpose_tile_load,
+        .compute = transpose_tile_compute,
+        .store = transpose_tile_store,
+        .ctx = &t,
+    };
+
+    return tile_pipeline_run(&p);
+}
+
+__attribute__((noinline))
+int transpose_nd_baseline(const double* arr, const size_t* shape, size_t ndim, const size_t* perm, double* result) {
+    size_t in_strides[TRANSPOSE_MAX_DIMS];
+    size_t index[TRANSPOSE_MAX_DIMS] = {0};
+    int used[TRANSPOSE_MAX_DIMS] = {0};
+    size_t total = 1;
+
+    if (ndim > TRANSPOSE_MAX_DIMS) {
+        return -1;
+    }
+    for (size_t d = ndim; d-- > 0;) {
+        in_strides[d] = total;
+        total *= shape[d];
+    }
+    for (size_t d = 0; d < ndim; d++) {
+        size_t p = perm != NULL ? perm[d] : ndim - 1 - d;
+        if (p >= ndim || used[p]) {
+            return -1;
+        }
+        used[p] = 1;
+    }
+
+    // index is the position in result, the last dimension changes fastest
+    for (size_t i = 0; i < total; i++) {
+        size_t offset = 0;
+        for (size_t d = 0; d < ndim; d++) {
+            offset += index[d] * in_strides[perm != NULL ? perm[d] : ndim - 1 - d];
+        }
+        result[i] = arr[offset];
+
+        for (size_t d = ndim; d-- > 0;) {
+            size_t p = perm != NULL ? perm[d] : ndim - 1 - d;
+            if (++index[d] < shape[p]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * The read loops of the transpose in the order of result, innermost first (bounds and strides in elements):
+ * drops the dimensions of size 1 and merges output dimensions which are also contiguous in arr.
+ * Returns the number of loops, -1 if ndim > TRANSPOSE_MAX_DIMS or perm is not a permutation.
+ */
+static int transpose_nd_loops(const size_t* shape, size_t ndim, const size_t* perm, size_t* bounds, size_t* strides) {
+    size_t in_strides[TRANSPOSE_MAX_DIMS];
+    int used[TRANSPOSE_MAX_DIMS] = {0};
+    size_t stride = 1;
+    int loops = 0;
+
+    if (ndim > TRANSPOSE_MAX_DIMS) {
+        return -1;
+    }
+    for (size_t d = ndim; d-- > 0;) {
+        in_strides[d] = stride;
+        stride *= shape[d];
+    }
+
+    for (size_t d = ndim; d-- > 0;) {
+        size_t p = perm != NULL ? perm[d] : ndim - 1 - d;
+        if (p >= ndim || used[p]) {
+            return -1;
+        }
+        used[p] = 1;
+
+        if (shape[p] == 1) {
+            continue;
+        }
+        if (loops > 0 && in_strides[p] == strides[loops - 1] * bounds[loops - 1]) {
+            bounds[loops - 1] *= shape[p];
+        } else {
+            bounds[loops] = shape[p];
+            strides[loops] = in_strides[p];
+            loops++;
+        }
+    }
+    return loops;
+}
+
+/*
+ * Copies the elements read by the loops to consecutive elements of result. The inner (up to) 4 loops
+ * are the read stream of one pass, the outer loops iterate the passes.
+ */
+static void transpose_nd_range(const double* arr, const size_t* bounds, const size_t* strides, size_t loops,
+                               double* result) {
+    size_t inner = loops < 4 ? loops : 4;
+    size_t b[4] = {1, 1, 1, 1};
+    size_t st[4] = {0, 0, 0, 0};
+    size_t inner_count = 1;
+    size_t outer_count = 1;
+
+    for (size_t k = 0; k < loops; k++) {
+        if (k < inner) {
+            b[k] = bounds[k];
+            st[k] = strides[k] * sizeof(double);
+            inner_count *= bounds[k];
+        } else {
+            outer_count *= bounds[k];
+        }
+    }
+    if (inner_count == 0 || outer_count == 0) {
+        return;
+    }
+
+    for (size_t o = 0; o < outer_count; o++) {
+        size_t offset = 0;
+        size_t rest = o;
+        for (size_t k = inner; k < loops; k++) {
+            offset += (rest % bounds[k]) * strides[k];
+            rest /= bounds[k];
+        }
+
+        snrt_ssr_loop_4d(SNRT_SSR_DM0, b[0], b[1], b[2], b[3], st[0], st[1], st[2], st[3]);
+        snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+        snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, (double*) arr + offset);
+
+        snrt_ssr_loop_1d(SNRT_SSR_DM1, inner_count, sizeof(double));
+        snrt_ssr_repeat(SNRT_SSR_DM1, 1);
+        snrt_ssr_write(SNRT_SSR_DM1, SNRT_SSR_1D, result + o * inner_count);
+
+        snrt_ssr_enable();
+
+        asm volatile(
+            "frep.o %[n_frep], 1, 0, 0\n"
+            "fmv.d ft1, ft0\n"
+            :: [n_frep] "r"(inner_count - 1)
+            : "ft0", "ft1", "memory"
+        );
+
+        snrt_fpu_fence();
+        snrt_ssr_disable();
+    }
+}
+
+__attribute__((noinline))
+int transpose_nd_ssr_frep(const double* arr, const size_t* shape, size_t ndim, const size_t* perm, double* result) {
+    size_t bounds[TRANSPOSE_MAX_DIMS];
+    size_t strides[TRANSPOSE_MAX_DIMS];
+    int loops = transpose_nd_loops(shape, ndim, perm, bounds, strides);
+
+    if (loops < 0) {
+        return -1;
+    }
+
+    transpose_nd_range(arr, bounds, strides, loops, result);
+    return 0;
+}
+
+__attribute__((noinline))
+int transpose_nd_ssr_frep_parallel(const double* arr, const size_t* shape, size_t ndim, const size_t* perm,
+                                   double* result) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    size_t bounds[TRANSPOSE_MAX_DIMS];
+    size_t strides[TRANSPOSE_MAX_DIMS];
+    int loops = transpose_nd_loops(shape, ndim, perm, bounds, strides);
+
+    if (loops < 0) {
+        return -1;
+    }
+    if (snrt_is_dm_core()) {
+        return 0;
+    }
+
+    // A tensor of a single element has no loop to split
+    if (loops == 0) {
+        if (core_idx == 0) {
+            result[0] = arr[0];
+        }
+        return 0;
+    }
+
+    size_t slice = 1;
+    for (int k = 0; k < loops - 1; k++) {
+        slice *= bounds[k];
+    }
+
+    size_t first;
+    bounds[loops - 1] = local_range(bounds[loops - 1], core_idx, core_num, &first);
+    transpose_nd_range(arr + first * strides[loops - 1], bounds, strides, loops, result + first * slice);
+    return 0;
+}
@@ -16,4 +16,39 @@ int transpose_ssr(const double* arr, const size_t r, const size_t s, double* res
 
 int transpose_ssr_frep(const double* arr, const size_t r, const size_t s, double* result);
 
+/*
+ * Blocked transpose: the read stream walks tiles of TRANSPOSE_TILE rows column by column, so consecutive
+ * reads stay within a few rows and the writes are runs of TRANSPOSE_TILE elements.
+ * The parallel and OMP versions split the columns of arr (the rows of result) among the compute cores.
+ */
+#define TRANSPOSE_TILE 8
+
+int transpose_ssr_frep_blocked(const double* arr, const size_t r, const size_t s, double* result);
+int transpose_ssr_frep_parallel(const double* arr, const size_t r, const size_t s, double* result);
+int transpose_ssr_frep_omp(const double* arr, const size_t r, const size_t s, double* result);
+
+/*
+ * Transpose of bands of rows through L1 with the pipeline of src/lmq/tile.h: the DM core loads a band
+ * contiguously and writes its transpose back with a 2D DMA which scatters the rows of the transposed band
+ * into the columns of result, the compute cores transpose the band in L1 meanwhile.
+ * Falls back to transpose_ssr_frep_parallel if a single row does not fit a tile.
+ * Must be called by all cores of the cluster (including the DM core).
+ */
+int transpose_tiled(const double* arr, const size_t r, const size_t s, double* result);
+
+/*
+ * ONNX Transpose of the row major tensor arr of shape (shape[0], ..., shape[ndim - 1]):
+ * dimension d of result is dimension perm[d] of arr (the dimensions are reversed if perm is NULL).
+ * Dimensions of size 1 are dropped and output dimensions which are also contiguous in the input merged,
+ * up to 4 of the remaining dimensions are the loops of one SSR 4D read stream.
+ * The parallel version splits the outermost of them among the compute cores.
+ * Returns -1 if ndim > TRANSPOSE_MAX_DIMS or perm is not a permutation.
+ */
+#define TRANSPOSE_MAX_DIMS 8
+
+int transpose_nd_baseline(const double* arr, const size_t* shape, size_t ndim, const size_t* perm, double* result);
+int transpose_nd_ssr_frep(const double* arr, const size_t* shape, size_t ndim, const size_t* perm, double* result);
+int transpose_nd_ssr_frep_parallel(const double* arr, const size_t* shape, size_t ndim, const size_t* perm,
+                                   double* result);
+
 #endif
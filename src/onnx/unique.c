@@ -5,6 +5,11 @@
 #include <unique.h>
 #include <float.h>
 
+#include "lmq.h"
+#include "kernel.h"
+#include "reduce.h"
+#include "rng.h"
+
 /*
  * Find the unique elements of the input 'arr'.
  * The output 'result' is an array of the same size, where
@@ -140,4 +145,405 @@ int unique_parallel(double* arr, const size_t n, double* result) {
     }
     
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+ * result[first, first + count) of unique, element i is compared with the n - i - 1 elements after it.
+ */
+static inline void unique_range(const double* arr, const size_t n, const size_t first, const size_t count,
+                                double* result) {
+    for (size_t i = first; i < first + count; i++) {
+        int unique = 1;
+        for (size_t j = i + 1; j < n; j++) {
+            if (arr[i] == arr[j]) {
+                unique = 0;
+            }
+        }
+        result[i] = unique ? arr[i] : -1.0;
+    }
+}
+
+// The first elements cost the most, the static split of unique_parallel leaves the last cores idle
+KERNEL_DYNAMIC(unique_parallel_dynamic, (double* arr, const size_t n, double* result), n, 0,
+               unique_range(arr, n, first, count, result))
+
+/*
+ * Stable merge of the sorted runs perm[a0, a1) and perm[a1, b1) (ordered by arr) into out[a0, b1).
+ * Writes the count outputs from position a0 + d on, the first of them is found by a binary search
+ * on the merge path: the number of elements of the first run among the d smallest.
+ */
+static inline void unique_merge(const double* arr, const size_t* perm, size_t a0, size_t a1, size_t b1,
+                                size_t d, size_t count, size_t* out) {
+    const size_t* run_a = perm + a0;
+    const size_t* run_b = perm + a1;
+    size_t len_a = a1 - a0;
+    size_t len_b = b1 - a1;
+
+    size_t lo = d > len_b ? d - len_b : 0;
+    size_t hi = d < len_a ? d : len_a;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (arr[run_a[mid]] <= arr[run_b[d - mid - 1]]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Equal values take the first run, so the first occurrence in arr stays in front
+    size_t i = lo;
+    size_t j = d - lo;
+    out += a0 + d;
+    for (size_t k = 0; k < count; k++) {
+        if (j >= len_b || (i < len_a && arr[run_a[i]] <= arr[run_b[j]])) {
+            out[k] = run_a[i++];
+        } else {
+            out[k] = run_b[j++];
+        }
+    }
+}
+
+/*
+ * Bottom up merge sort of the indices [first, first + count) into perm[first, first + count), tmp is the buffer of the passes.
+ */
+static void unique_sort_range(const double* arr, size_t first, size_t count, size_t* perm, size_t* tmp) {
+    size_t* src = perm;
+    size_t* dst = tmp;
+
+    for (size_t i = first; i < first + count; i++) {
+        perm[i] = i;
+    }
+
+    for (size_t width = 1; width < count; width *= 2) {
+        for (size_t a0 = first; a0 < first + count; a0 += 2 * width) {
+            size_t a1 = a0 + width < first + count ? a0 + width : first + count;
+            size_t b1 = a1 + width < first + count ? a1 + width : first + count;
+            unique_merge(arr, src, a0, a1, b1, 0, b1 - a0, dst);
+        }
+        size_t* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != perm) {
+        for (size_t i = first; i < first + count; i++) {
+            perm[i] = src[i];
+        }
+    }
+}
+
+/*
+ * Number of positions of sorted[first, first + count) at which a new value starts.
+ */
+static inline size_t unique_count_heads(const double* arr, const size_t* sorted, size_t first, size_t count) {
+    size_t heads = 0;
+    for (size_t i = first; i < first + count; i++) {
+        heads += i == 0 || arr[sorted[i]] != arr[sorted[i - 1]];
+    }
+    return heads;
+}
+
+/*
+ * Writes the outputs for the positions sorted[first, first + count) of the n sorted indices,
+ * k is the number of unique values which start before first.
+ */
+static void unique_emit(const double* arr, const size_t* sorted, size_t n, size_t first, size_t count, size_t k,
+                        double* values, size_t* indices, size_t* inverse_indices, size_t* counts) {
+    // The first positions may continue the value which started on the previous core
+    size_t current = k - 1;
+
+    for (size_t i = first; i < first + count; i++) {
+        double value = arr[sorted[i]];
+        if (i == 0 || value != arr[sorted[i - 1]]) {
+            current = k++;
+            values[current] = value;
+            if (indices != NULL) {
+                indices[current] = sorted[i];
+            }
+            if (counts != NULL) {
+                size_t end = i + 1;
+                while (end < n && arr[sorted[end]] == value) {
+                    end++;
+                }
+                counts[current] = end - i;
+            }
+        }
+        if (inverse_indices != NULL) {
+            inverse_indices[sorted[i]] = current;
+        }
+    }
+}
+
+__attribute__((noinline))
+int unique_sorted_baseline(const double* arr, const size_t n, double* values, size_t* indices,
+                           size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch) {
+    unique_sort_range(arr, 0, n, scratch, scratch + n);
+    unique_emit(arr, scratch, n, 0, n, 0, values, indices, inverse_indices, counts);
+    *num_unique = unique_count_heads(arr, scratch, 0, n);
+    return 0;
+}
+
+/*
+ * First element of run k of the cores' runs, n past the last run.
+ */
+static inline size_t unique_run_start(size_t n, size_t k, size_t core_num) {
+    size_t first = n;
+    if (k < core_num) {
+        local_range(n, k, core_num, &first);
+    }
+    return first;
+}
+
+__attribute__((noinline))
+int unique_sorted_parallel(const double* arr, const size_t n, double* values, size_t* indices,
+                           size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    int is_dm = snrt_is_dm_core();
+    size_t* src = scratch;
+    size_t* dst = scratch + n;
+
+    size_t first = 0;
+    size_t count = 0;
+    if (!is_dm) {
+        count = local_range(n, core_idx, core_num, &first);
+        unique_sort_range(arr, first, count, src, dst);
+    }
+
+    // In the round of width w the groups of 2 w runs are merged by the 2 w cores with the same index range
+    for (size_t width = 1; width < core_num; width *= 2) {
+        snrt_cluster_hw_barrier();
+        if (!is_dm) {
+            size_t base = core_idx / (2 * width) * (2 * width);
+            size_t parts = core_num - base < 2 * width ? core_num - base : 2 * width;
+            size_t a0 = unique_run_start(n, base, core_num);
+            size_t a1 = unique_run_start(n, base + width, core_num);
+            size_t b1 = unique_run_start(n, base + 2 * width, core_num);
+            size_t d;
+            size_t part_count = local_range(b1 - a0, core_idx - base, parts, &d);
+            unique_merge(arr, src, a0, a1, b1, d, part_count, dst);
+        }
+        size_t* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    snrt_cluster_hw_barrier();
+
+    // The unique values before a core are the heads of the cores with a lower index
+    double total;
+    size_t heads = is_dm ? 0 : unique_count_heads(arr, src, first, count);
+    size_t k = (size_t) scan_cluster((double) heads, &total);
+    if (is_dm) {
+        return 0;
+    }
+
+    unique_emit(arr, src, n, first, count, k, values, indices, inverse_indices, counts);
+    if (core_idx == 0) {
+        *num_unique = (size_t) total;
+    }
+    return 0;
+}
+
+#define UNIQUE_HASH_EMPTY ((size_t) -1)
+
+/*
+ * The hash table of one core in the scratch: a slot holds the local id of a value or UNIQUE_HASH_EMPTY,
+ * a local id has the index of its first occurrence, the number of occurrences and the id in the output.
+ */
+typedef struct {
+    size_t* table;
+    size_t mask;
+    size_t* first;
+    size_t* count;
+    size_t* id;
+} unique_hash_t;
+
+/*
+ * Places the table of the range part (of parts) of the n elements in the scratch, at most 7 indices per element
+ * and 2 per table. Returns the number of elements of the range and sets first to its first element.
+ */
+static size_t unique_hash_layout(size_t* scratch, size_t n, size_t part, size_t parts,
+                                 unique_hash_t* hash, size_t* first) {
+    size_t count = local_range(n, part, parts, first);
+    size_t size = 2;
+    while (size < 2 * count) {
+        size *= 2;
+    }
+
+    hash->table = scratch + 7 * *first + 2 * part;
+    hash->mask = size - 1;
+    hash->first = hash->table + size;
+    hash->count = hash->first + count;
+    hash->id = hash->count + count;
+    return count;
+}
+
+/*
+ * Returns the slot of value: the slot which holds it or the empty slot at which the probing stopped.
+ */
+static inline size_t* unique_hash_find(const unique_hash_t* hash, const double* arr, double value) {
+    union {
+        double value;
+        uint32_t words[2];
+    } bits = { .value = value == 0.0 ? 0.0 : value };
+    size_t slot = rng_mix(bits.words[1] ^ (bits.words[0] * 0x9e3779b9u)) & hash->mask;
+
+    while (hash->table[slot] != UNIQUE_HASH_EMPTY && arr[hash->first[hash->table[slot]]] != value) {
+        slot = (slot + 1) & hash->mask;
+    }
+    return &hash->table[slot];
+}
+
+/*
+ * Inserts the count elements from first on into the empty table, the local ids are in the order of the first occurrence.
+ * Writes the local id of every element to inverse_indices if it is not NULL. Returns the number of local ids.
+ */
+static size_t unique_hash_build(const double* arr, size_t first, size_t count, unique_hash_t* hash,
+                                size_t* inverse_indices) {
+    size_t ids = 0;
+
+    for (size_t slot = 0; slot <= hash->mask; slot++) {
+        hash->table[slot] = UNIQUE_HASH_EMPTY;
+    }
+
+    for (size_t i = first; i < first + count; i++) {
+        size_t* slot = unique_hash_find(hash, arr, arr[i]);
+        if (*slot == UNIQUE_HASH_EMPTY) {
+            *slot = ids;
+            hash->first[ids] = i;
+            hash->count[ids] = 0;
+            ids++;
+        }
+        hash->count[*slot]++;
+        if (inverse_indices != NULL) {
+            inverse_indices[i] = *slot;
+        }
+    }
+    return ids;
+}
+
+__attribute__((noinline))
+int unique_hash_baseline(const double* arr, const size_t n, double* values, size_t* indices,
+                         size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch) {
+    unique_hash_t hash;
+    size_t first;
+    unique_hash_layout(scratch, n, 0, 1, &hash, &first);
+    size_t ids = unique_hash_build(arr, 0, n, &hash, inverse_indices);
+
+    for (size_t id = 0; id < ids; id++) {
+        values[id] = arr[hash.first[id]];
+        if (indices != NULL) {
+            indices[id] = hash.first[id];
+        }
+        if (counts != NULL) {
+            counts[id] = hash.count[id];
+        }
+    }
+
+    *num_unique = ids;
+    return 0;
+}
+
+__attribute__((noinline))
+int unique_hash_parallel(const double* arr, const size_t n, double* values, size_t* indices,
+                         size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch) {
+    size_t core_num = snrt_cluster_core_num() - 1;
+    size_t core_idx = snrt_cluster_core_idx();
+    int is_dm = snrt_is_dm_core();
+    unique_hash_t hash;
+    size_t first = 0;
+    size_t count = 0;
+    size_t ids = 0;
+    size_t heads = 0;
+
+    if (!is_dm) {
+        count = unique_hash_layout(scratch, n, core_idx, core_num, &hash, &first);
+        ids = unique_hash_build(arr, first, count, &hash, inverse_indices);
+    }
+    snrt_cluster_hw_barrier();
+
+    // A local id is a head if no core before this one has the value, id holds its rank among the heads
+    if (!is_dm) {
+        for (size_t id = 0; id < ids; id++) {
+            double value = arr[hash.first[id]];
+            hash.id[id] = heads;
+            for (size_t core = 0; core < core_idx; core++) {
+                unique_hash_t other;
+                size_t other_first;
+                unique_hash_layout(scratch, n, core, core_num, &other, &other_first);
+                if (*unique_hash_find(&other, arr, value) != UNIQUE_HASH_EMPTY) {
+                    hash.id[id] = UNIQUE_HASH_EMPTY;
+                    break;
+                }
+            }
+            heads += hash.id[id] != UNIQUE_HASH_EMPTY;
+        }
+    }
+
+    double total;
+    size_t offset = (size_t) scan_cluster((double) heads, &total);
+
+    // The heads get their output ids and the occurrences on the cores after this one
+    if (!is_dm) {
+        for (size_t id = 0; id < ids; id++) {
+            if (hash.id[id] == UNIQUE_HASH_EMPTY) {
+                continue;
+            }
+            size_t out = offset + hash.id[id];
+            size_t occurrences = hash.count[id];
+            double value = arr[hash.first[id]];
+            for (size_t core = core_idx + 1; counts != NULL && core < core_num; core++) {
+                unique_hash_t other;
+                size_t other_first;
+                unique_hash_layout(scratch, n, core, core_num, &other, &other_first);
+                size_t other_id = *unique_hash_find(&other, arr, value);
+                if (other_id != UNIQUE_HASH_EMPTY) {
+                    occurrences += other.count[other_id];
+                }
+            }
+
+            hash.id[id] = out;
+            values[out] = value;
+            if (indices != NULL) {
+                indices[out] = hash.first[id];
+            }
+            if (counts != NULL) {
+                counts[out] = occurrences;
+            }
+        }
+    }
+    snrt_cluster_hw_barrier();
+
+    if (is_dm) {
+        return 0;
+    }
+
+    // The other local ids take the output id of the first core which has the value
+    for (size_t id = 0; id < ids; id++) {
+        if (hash.id[id] != UNIQUE_HASH_EMPTY) {
+            continue;
+        }
+        double value = arr[hash.first[id]];
+        for (size_t core = 0; core < core_idx; core++) {
+            unique_hash_t other;
+            size_t other_first;
+            unique_hash_layout(scratch, n, core, core_num, &other, &other_first);
+            size_t other_id = *unique_hash_find(&other, arr, value);
+            if (other_id != UNIQUE_HASH_EMPTY) {
+                hash.id[id] = other.id[other_id];
+                break;
+            }
+        }
+    }
+
+    if (inverse_indices != NULL) {
+        for (size_t i = first; i < first + count; i++) {
+            inverse_indices[i] = hash.id[inverse_indices[i]];
+        }
+    }
+
+    if (core_idx == 0) {
+        *num_unique = (size_t) total;
+    }
+    return 0;
+}
@@ -1,5 +1,5 @@
-#ifndef LMQ_SUM_H
-#define LMQ_SUM_H
+#ifndef LMQ_UNIQUE_H
+#define LMQ_UNIQUE_H
 
 #include <snrt.h>
 
@@ -19,4 +19,43 @@ int unique_ssr(double* arr, const size_t n, double* result);
 int unique_frep(double* arr, const size_t n, double* result);
 int unique_parallel(double* arr, const size_t n, double* result);
 
+/*
+ * unique_parallel with the elements handed out in chunks by src/lmq/sched.h instead of a static split:
+ * element i costs n - i comparisons. It must be called by all compute cores.
+ */
+int unique_parallel_dynamic(double* arr, const size_t n, double* result);
+
+/*
+ * ONNX Unique with sorted = 1 in O(n log n): a stable merge sort of the permutation of 'arr' (no NaN)
+ * followed by a linear pass over adjacent elements.
+ * - values: the k sorted unique values
+ * - indices: the index of the first occurrence in 'arr' of every unique value (k entries, may be NULL)
+ * - inverse_indices: the index into values of every element of 'arr' (n entries, may be NULL)
+ * - counts: the number of occurrences of every unique value (k entries, may be NULL)
+ * k is unknown in advance, so values, indices and counts must hold n entries. *num_unique is set to k.
+ * scratch holds 2 * n indices for the sort.
+ * The parallel version sorts contiguous runs on every core and merges them in log2(#cores) rounds
+ * in which all cores take part, the pairs of runs are split among the cores along the merge path.
+ * It must be called by all cores of the cluster.
+ */
+int unique_sorted_baseline(const double* arr, const size_t n, double* values, size_t* indices,
+                           size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch);
+int unique_sorted_parallel(const double* arr, const size_t n, double* values, size_t* indices,
+                           size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch);
+
+/*
+ * ONNX Unique with sorted = 0: the outputs of unique_sorted_* with the unique values in the order
+ * of their first occurrence. Open addressing hash tables on the bit pattern of the doubles (-0.0 is 0.0, no NaN).
+ * scratch holds UNIQUE_HASH_SCRATCH(n, #cores) indices (#cores is 1 for the baseline) which should be in TCDM.
+ * In the parallel version every core builds the table of a contiguous range, a unique value belongs to the first
+ * core which has it, which gets the counts of the other cores from their tables. The offsets of the values of a core
+ * are the prefix sum of the values which belong to the cores before it. It must be called by all cores of the cluster.
+ */
+#define UNIQUE_HASH_SCRATCH(n, cores) (7 * (n) + 2 * (cores))
+
+int unique_hash_baseline(const double* arr, const size_t n, double* values, size_t* indices,
+                         size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch);
+int unique_hash_parallel(const double* arr, const size_t n, double* values, size_t* indices,
+                         size_t* inverse_indices, size_t* counts, size_t* num_unique, size_t* scratch);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "printf.h"
+#include <snrt.h>
+
+#include "lmq.h"
+#include "conv.h"
+#include "gemm.h"
+#include "winograd.h"
+
+/*
+ * Winograd F(2x2, 3x3): a 4x4 input tile d gives the 2x2 output tile A^T [(G g G^T) . (B^T d B)] A,
+ * which needs 16 instead of 36 multiplications.
+ *
+ *         | 1  0 -1  0 |         | 1    0    0   |
+ *   B^T = | 0  1  1  0 |     G = | 1/2  1/2  1/2 |     A^T = | 1  1  1  0 |
+ *         | 0 -1  1  0 |         | 1/2 -1/2  1/2 |           | 0  1 -1 -1 |
+ *         | 0  1  0 -1 |         | 0    0    1   |
+ *
+ * The 2D transforms are separable, so they are done as two passes of a 1D transform, each of which
+ * is a single FREP over all tiles with the tile layout in the SSR patterns. The element-wise
+ * multiplication summed over the input channels is a batch of 16 gemms (one per tile element).
+ */
+
+#define WINOGRAD_TILE 4
+#define WINOGRAD_OUT 2
+#define WINOGRAD_ELEMS (WINOGRAD_TILE * WINOGRAD_TILE)
+
+/*
+ * Applies B^T to count vectors of 4 elements. DM0 reads the vectors with the 4D pattern
+ * in_bounds/in_strides (strides in elements), DM2 writes the results with out_bounds/out_strides.
+ */
+static inline void winograd_bt(double* in, const size_t* in_bounds, const size_t* in_strides,
+                               double* out, const size_t* out_bounds, const size_t* out_strides, const size_t count) {
+    snrt_ssr_loop_4d(SNRT_SSR_DM0, in_bounds[0], in_bounds[1], in_bounds[2], in_bounds[3],
+        sizeof(*in) * in_strides[0], sizeof(*in) * in_strides[1], sizeof(*in) * in_strides[2], sizeof(*in) * in_strides[3]);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, in);
+
+    snrt_ssr_loop_4d(SNRT_SSR_DM2, out_bounds[0], out_bounds[1], out_bounds[2], out_bounds[3],
+        sizeof(*out) * out_strides[0], sizeof(*out) * out_strides[1], sizeof(*out) * out_strides[2], sizeof(*out) * out_strides[3]);
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_4D, out);
+
+    snrt_ssr_enable();
+
+    // (x0 - x2, x1 + x2, x2 - x1, x1 - x3), x3 is only read by the last instruction
+    asm volatile(
+        "frep.o %[n_frep], 7, 0, 0 \n"
+        "fmv.d ft3, ft0 \n"
+        "fmv.d ft4, ft0 \n"
+        "fmv.d ft5, ft0 \n"
+        "fsub.d ft2, ft3, ft5 \n"
+        "fadd.d ft2, ft4, ft5 \n"
+        "fsub.d ft2, ft5, ft4 \n"
+        "fsub.d ft2, ft4, ft0 \n"
+        :
+        : [n_frep] "r"(count - 1)
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5"
+    );
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+/*
+ * Applies A^T to count vectors of 4 elements, giving 2 elements each. Same patterns as winograd_bt.
+ */
+static inline void winograd_at(double* in, const size_t* in_bounds, const size_t* in_strides,
+                               double* out, const size_t* out_bounds, const size_t* out_strides, const size_t count) {
+    snrt_ssr_loop_4d(SNRT_SSR_DM0, in_bounds[0], in_bounds[1], in_bounds[2], in_bounds[3],
+        sizeof(*in) * in_strides[0], sizeof(*in) * in_strides[1], sizeof(*in) * in_strides[2], sizeof(*in) * in_strides[3]);
+    snrt_ssr_repeat(SNRT_SSR_DM0, 1);
+    snrt_ssr_read(SNRT_SSR_DM0, SNRT_SSR_4D, in);
+
+    snrt_ssr_loop_4d(SNRT_SSR_DM2, out_bounds[0], out_bounds[1], out_bounds[2], out_bounds[3],
+        sizeof(*out) * out_strides[0], sizeof(*out) * out_strides[1], sizeof(*out) * out_strides[2], sizeof(*out) * out_strides[3]);
+    snrt_ssr_repeat(SNRT_SSR_DM2, 1);
+    snrt_ssr_write(SNRT_SSR_DM2, SNRT_SSR_4D, out);
+
+    snrt_ssr_enable();
+
+    // (x0 + x1 + x2, x1 - x2 - x3)
+    asm volatile(
+        "frep.o %[n_frep], 7, 0, 0 \n"
+        "fmv.d ft3, ft0 \n"
+        "fmv.d ft4, ft0 \n"
+        "fmv.d ft5, ft0 \n"
+        "fadd.d ft3, ft3, ft4 \n"
+        "fadd.d ft2, ft3, ft5 \n"
+        "fsub.d ft4, ft4, ft5 \n"
+        "fsub.d ft2, ft4, ft0 \n"
+        :
+        : [n_frep] "r"(count - 1)
+        : "ft0", "ft1", "ft2", "ft3", "ft4", "ft5"
+    );
+
+    snrt_fpu_fence();
+    snrt_ssr_disable();
+}
+
+/*
+ * u = G g G^T for all filters, stored as (16, c_out, c_in) so that every tile element is one gemm operand.
+ */
+static void winograd_filters(double* w, size_t c_in, size_t c_out, double* u) {
+    for (size_t co = 0; co < c_out; ++co) {
+        for (size_t ci = 0; ci < c_in; ++ci) {
+            double* g = w + (co * c_in + ci) * 9;
+            double t[WINOGRAD_TILE][3];
+
+            for (size_t c = 0; c < 3; ++c) {
+                t[0][c] = g[c];
+                t[1][c] = 0.5 * (g[c] + g[3 + c] + g[6 + c]);
+                t[2][c] = 0.5 * (g[c] - g[3 + c] + g[6 + c]);
+                t[3][c] = g[6 + c];
+            }
+
+            for (size_t r = 0; r < WINOGRAD_TILE; ++r) {
+                double* row = u + (r * WINOGRAD_TILE * c_out + co) * c_in + ci;
+                size_t elem = c_out * c_in;
+                row[0] = t[r][0];
+                row[elem] = 0.5 * (t[r][0] + t[r][1] + t[r][2]);
+                row[2 * elem] = 0.5 * (t[r][0] - t[r][1] + t[r][2]);
+                row[3 * elem] = t[r][2];
+            }
+        }
+    }
+}
+
+/*
+ * Direct computation of a single output, for the outputs which are not covered by a whole tile.
+ */
+static inline double winograd_direct(double* x, double* w, double bias, size_t c_in, size_t n0, size_t n1, size_t i, size_t j) {
+    double acc = bias;
+    for (size_t ci = 0; ci < c_in; ++ci) {
+        for (size_t k = 0; k < 3; ++k) {
+            for (size_t l = 0; l < 3; ++l) {
+                acc += x[(ci * n1 + i + k) * n0 + j + l] * w[(ci * 3 + k) * 3 + l];
+            }
+        }
+    }
+    return acc;
+}
+
+__attribute__((noinline))
+int conv_nchw_winograd(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    if (groups != 1 || f0 != 3 || f1 != 3 || s0 != 1 || s1 != 1 || d0 != 1 || d1 != 1) {
+        return -1;
+    }
+
+    size_t outn0 = conv_output_size(n0, f0, s0, d0);
+    size_t outn1 = conv_output_size(n1, f1, s1, d1);
+    size_t tiles_x = outn0 / WINOGRAD_OUT;
+    size_t tiles_y = outn1 / WINOGRAD_OUT;
+    size_t tiles = tiles_x * tiles_y;
+
+    size_t mark = arena_mark(arena_global());
+    size_t z_len = WINOGRAD_OUT * WINOGRAD_TILE * c_out * tiles;
+    size_t tmp_len = WINOGRAD_ELEMS * tiles > z_len ? WINOGRAD_ELEMS * tiles : z_len;
+    double* u = arena_alloc(arena_global(), WINOGRAD_ELEMS * c_out * c_in, sizeof(double), LMQ_ALIGN_DOUBLE);
+    double* v = arena_alloc(arena_global(), WINOGRAD_ELEMS * c_in * tiles, sizeof(double), LMQ_ALIGN_DOUBLE);
+    double* m = arena_alloc(arena_global(), WINOGRAD_ELEMS * c_out * tiles, sizeof(double), LMQ_ALIGN_DOUBLE);
+    double* tmp = arena_alloc(arena_global(), tmp_len, sizeof(double), LMQ_ALIGN_DOUBLE);
+    if (u == NULL || v == NULL || m == NULL || tmp == NULL) {
+        arena_reset(arena_global(), mark);
+        return -1;
+    }
+
+    winograd_filters(w, c_in, c_out, u);
+
+    for (size_t b = 0; tiles > 0 && b < batch; ++b) {
+        double* image = x + b * c_in * n0 * n1;
+        double* out = result + b * c_out * outn0 * outn1;
+
+        for (size_t ci = 0; ci < c_in; ++ci) {
+            // B^T d: every column of every tile, tmp is (tile, column, row)
+            size_t col_bounds[4] = { WINOGRAD_TILE, WINOGRAD_TILE, tiles_x, tiles_y };
+            size_t col_strides[4] = { n0, 1, WINOGRAD_OUT, WINOGRAD_OUT * n0 };
+            size_t tmp_bounds[4] = { WINOGRAD_TILE, WINOGRAD_TILE, tiles, 1 };
+            size_t tmp_strides[4] = { 1, WINOGRAD_TILE, WINOGRAD_ELEMS, 0 };
+            winograd_bt(image + ci * n0 * n1, col_bounds, col_strides, tmp, tmp_bounds, tmp_strides, WINOGRAD_TILE * tiles);
+
+            // (B^T d) B: every row of every tile, v is (tile element, input channel, tile)
+            size_t row_bounds[4] = { WINOGRAD_TILE, WINOGRAD_TILE, tiles, 1 };
+            size_t row_strides[4] = { WINOGRAD_TILE, 1, WINOGRAD_ELEMS, 0 };
+            size_t v_bounds[4] = { WINOGRAD_TILE, WINOGRAD_TILE, tiles, 1 };
+            size_t v_strides[4] = { c_in * tiles, WINOGRAD_TILE * c_in * tiles, 1, 0 };
+            winograd_bt(tmp, row_bounds, row_strides, v + ci * tiles, v_bounds, v_strides, WINOGRAD_TILE * tiles);
+        }
+
+        // (c_out, c_in) x (c_in, tiles) for every tile element
+        gemm_batched_ssr_frep(u, v, WINOGRAD_ELEMS, c_out * c_in, c_in * tiles, c_out * tiles, c_out, c_in, tiles, m);
+
+        // Element (1, 1) of a tile contributes once to every output, so it carries the bias
+        for (size_t co = 0; bias && co < c_out; ++co) {
+            double* m11 = m + ((WINOGRAD_TILE + 1) * c_out + co) * tiles;
+            for (size_t t = 0; t < tiles; ++t) {
+                m11[t] += bias[co];
+            }
+        }
+
+        // A^T m: every column of every tile, tmp is (output channel, tile, column, output row)
+        size_t m_bounds[4] = { WINOGRAD_TILE, WINOGRAD_TILE, tiles, c_out };
+        size_t m_strides[4] = { WINOGRAD_TILE * c_out * tiles, c_out * tiles, 1, tiles };
+        size_t z_bounds[4] = { WINOGRAD_OUT, WINOGRAD_TILE, tiles, c_out };
+        size_t z_strides[4] = { 1, WINOGRAD_OUT, WINOGRAD_OUT * WINOGRAD_TILE, WINOGRAD_OUT * WINOGRAD_TILE * tiles };
+        winograd_at(m, m_bounds, m_strides, tmp, z_bounds, z_strides, WINOGRAD_TILE * tiles * c_out);
+
+        // (A^T m) A: every output row of every tile, written into the output plane
+        for (size_t co = 0; co < c_out; ++co) {
+            size_t z_row_bounds[4] = { WINOGRAD_TILE, WINOGRAD_OUT, tiles_x, tiles_y };
+            size_t z_row_strides[4] = { WINOGRAD_OUT, 1, WINOGRAD_OUT * WINOGRAD_TILE, WINOGRAD_OUT * WINOGRAD_TILE * tiles_x };
+            size_t y_bounds[4] = { WINOGRAD_OUT, WINOGRAD_OUT, tiles_x, tiles_y };
+            size_t y_strides[4] = { 1, outn0, WINOGRAD_OUT, WINOGRAD_OUT * outn0 };
+            winograd_at(tmp + co * WINOGRAD_OUT * WINOGRAD_TILE * tiles, z_row_bounds, z_row_strides,
+                out + co * outn0 * outn1, y_bounds, y_strides, WINOGRAD_OUT * tiles);
+        }
+    }
+
+    arena_reset(arena_global(), mark);
+
+    // Odd last row and column
+    for (size_t b = 0; b < batch; ++b) {
+        double* image = x + b * c_in * n0 * n1;
+        for (size_t co = 0; co < c_out; ++co) {
+            double* plane = result + (b * c_out + co) * outn0 * outn1;
+            double* filter = w + co * c_in * 9;
+            double bias_co = bias ? bias[co] : 0.0;
+
+            for (size_t i = 0; i < outn1; ++i) {
+                size_t first = i < tiles_y * WINOGRAD_OUT ? tiles_x * WINOGRAD_OUT : 0;
+                for (size_t j = first; j < outn0; ++j) {
+                    plane[i * outn0 + j] = winograd_direct(image, filter, bias_co, c_in, n0, n1, i, j);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+__attribute__((noinline))
+int conv2d_winograd(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    return conv_nchw_winograd(a, filter, NULL, 1, 1, n0, n1, 1, 1, f0, f1, s0, s1, d0, d1, result);
+}
+
+__attribute__((noinline))
+int conv2d_dispatch(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    if (conv2d_winograd(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, result) == 0) {
+        return 0;
+    }
+    return conv2d_ssr_frep_blocked(a, filter, n0, n1, f0, f1, s0, s1, d0, d1, result);
+}
+
+__attribute__((noinline))
+int conv_nchw_dispatch(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result) {
+    if (conv_nchw_winograd(x, w, bias, batch, c_in, n0, n1, c_out, groups, f0, f1, s0, s1, d0, d1, result) == 0) {
+        return 0;
+    }
+    return conv_nchw_ssr_frep(x, w, bias, batch, c_in, n0, n1, c_out, groups, f0, f1, s0, s1, d0, d1, result);
+}
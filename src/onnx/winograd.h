@@ -0,0 +1,23 @@
+#ifndef LMQ_WINOGRAD_H
+#define LMQ_WINOGRAD_H
+
+#include <snrt.h>
+
+/*
+ * Winograd F(2x2, 3x3) convolution for 3x3 filters with stride and dilation 1.
+ * Same arguments as conv2d_* and conv_nchw_*, returns -1 for other filters, strides, dilations
+ * and groups (or if the scratch buffers do not fit into the global arena).
+ * Outputs of an odd last row or column which are not covered by a whole 2x2 tile are computed directly.
+ */
+int conv2d_winograd(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv_nchw_winograd(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+
+/*
+ * Use Winograd where it applies and the direct SSR+FREP kernels otherwise.
+ */
+int conv2d_dispatch(double *a, double* filter, size_t n0, size_t n1, size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+int conv_nchw_dispatch(double *x, double* w, double* bias, size_t batch, size_t c_in, size_t n0, size_t n1, size_t c_out, size_t groups,
+                       size_t f0, size_t f1, size_t s0, size_t s1, size_t d0, size_t d1, double* result);
+
+#endif
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lmq.h"
+#include "golden.h"
+#include "sum.h"
+#include "max.h"
+#include "argmax.h"
+#include "cumsum.h"
+#include "dot.h"
+#include "add.h"
+#include "gemm.h"
+
+/*
+ * Host build of the baselines: runs them natively for every size of the benchmark loops on the inputs of the
+ * benchmarks and writes the outputs as golden_data.h (see src/lmq/golden.h). The baselines are the ones of
+ * src/onnx and src/dot compiled with LMQ_HOST, which leaves out everything but the baseline.
+ * Only the first size loop of benchmark_sum, _max, _argmax, _cumsum, _dot, _add and _gemm has references, all
+ * other baselines (and the later loops of these benchmarks) still run on the simulator, see README.md.
+ * Usage: x86_golden golden_data.h
+ */
+
+// The defaults of src/benchmark/benchmark.h
+#ifndef LMQ_START_SIZE
+#define LMQ_START_SIZE 10
+#endif
+
+#ifndef LMQ_SIZE
+#define LMQ_SIZE 1024
+#endif
+
+#define GOLDEN_MAX_ENTRIES 128
+
+typedef struct {
+    const char* name;
+    size_t size;
+} golden_entry_t;
+
+static golden_entry_t entries[GOLDEN_MAX_ENTRIES];
+static size_t num_entries = 0;
+
+// Writes the n values of the baseline name for size as an array with exact (hexadecimal) literals
+static void write_golden(FILE* out, const char* name, size_t size, const double* data, size_t n) {
+    fprintf(out, "static const double golden_%s_%zu[%zu] = {", name, size, n);
+    for (size_t i = 0; i < n; i++) {
+        fprintf(out, "%s%s%a", i == 0 ? "" : ",", i % 4 == 0 ? "\n    " : " ", data[i]);
+    }
+    fprintf(out, "\n};\n");
+
+    if (num_entries < GOLDEN_MAX_ENTRIES) {
+        entries[num_entries].name = name;
+        entries[num_entries].size = size;
+        num_entries++;
+    } else {
+        fprintf(stderr, "x86_golden: more than %d references\n", GOLDEN_MAX_ENTRIES);
+        exit(1);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s golden_data.h\n", argv[0]);
+        return 1;
+    }
+    FILE* out = fopen(argv[1], "w");
+    if (out == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(out, "/* Generated by src/x86/golden.c, do not edit */\n");
+    fprintf(out, "#ifndef LMQ_GOLDEN_DATA_H\n#define LMQ_GOLDEN_DATA_H\n\n#include \"golden.h\"\n\n");
+
+    double* x = malloc(LMQ_SIZE * sizeof(double));
+    double* y = malloc(LMQ_SIZE * sizeof(double));
+    double* result = malloc(LMQ_SIZE * sizeof(double));
+
+    for (size_t size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        double value;
+        int index;
+
+        // benchmark_sum, benchmark_max and benchmark_cumsum
+        golden_fill(x, size, 0, 1.0);
+        sum_baseline(x, size, &value);
+        write_golden(out, "sum_baseline", size, &value, 1);
+        max_baseline(x, size, &value);
+        write_golden(out, "max_baseline", size, &value, 1);
+        cumsum_baseline(x, size, result);
+        write_golden(out, "cumsum_baseline", size, result, size);
+
+        // benchmark_argmax
+        golden_fill(x, size, 0, size);
+        argmax_baseline(x, size, &index);
+        value = index;
+        write_golden(out, "argmax_baseline", size, &value, 1);
+
+        // benchmark_dot
+        for (size_t i = 0; i < size; i++) {
+            x[i] = (double) i + 1.0;
+        }
+        dot_baseline(x, x, size, &value);
+        write_golden(out, "dot_baseline", size, &value, 1);
+
+        // benchmark_add
+        for (size_t i = 0; i < size; i++) {
+            x[i] = (double) i;
+        }
+        add_baseline(x, x, size, result);
+        write_golden(out, "add_baseline", size, result, size);
+
+        // benchmark_gemm, the shape has at most size elements in every operand
+        uint32_t sqrt = sqrt_approx(size);
+        size_t m = sqrt / 2;
+        size_t n = sqrt * 2;
+        size_t k = sqrt / 2;
+        for (size_t i = 0; i < m * n; i++) {
+            x[i] = (double) i;
+        }
+        for (size_t i = 0; i < n * k; i++) {
+            y[i] = (double) i;
+        }
+        gemm_baseline(x, y, m, n, k, result);
+        write_golden(out, "gemm_baseline", size, result, m * k);
+    }
+
+    fprintf(out, "\nstatic const golden_t golden_table[] = {\n");
+    for (size_t e = 0; e < num_entries; e++) {
+        fprintf(out, "    {\"%s\", %zu, sizeof(golden_%s_%zu) / sizeof(double), golden_%s_%zu},\n", entries[e].name,
+                entries[e].size, entries[e].name, entries[e].size, entries[e].name, entries[e].size);
+    }
+    fprintf(out, "};\n\n#define GOLDEN_COUNT %zu\n\n#endif\n", num_entries);
+
+    free(x);
+    free(y);
+    free(result);
+    return fclose(out) != 0;
+}
@@ -0,0 +1,7 @@
+#ifndef LMQ_HOST_PRINTF_H
+#define LMQ_HOST_PRINTF_H
+
+// The printf of the snitch runtime is the one of the C library in the host build
+#include <stdio.h>
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef LMQ_HOST_SNRT_H
+#define LMQ_HOST_SNRT_H
+
+/*
+ * Stands in for the snitch runtime header in the host build (LMQ_HOST, see src/x86/golden.c).
+ * Only the baselines are built on the host, they need nothing but the standard types.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#endif
@@ -2,10 +2,24 @@
 #include <x86intrin.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
 #include <omp.h>
 
+// The defaults of src/benchmark/benchmark.h, the sizes of the benchmark_gemm shapes
+#ifndef LMQ_START_SIZE
+#define LMQ_START_SIZE 10
+#endif
+
+#ifndef LMQ_SIZE
+#define LMQ_SIZE 1024
+#endif
+
+// sqrt_approx of src/lmq/lmq.c (built with LMQ_HOST), benchmark_gemm derives its shapes with it
+double sqrt_approx(double a);
+
 
 const size_t blocksize = 32;
 
@@ -13,15 +27,18 @@ size_t min(size_t a, size_t b) {
     if (a < b) return a;
     return b;
 }
+/*
+ * result (m, k) = a (m, n) * b (n, k), all row major like gemm_baseline of src/onnx/gemm.c.
+ */
 __attribute__((noinline))
-int gemm_baseline(double* __restrict__ a, double* __restrict__ b, const size_t w, const size_t h, double* __restrict__ result) {
-    for (size_t i = 0; i < h; ++i) {
-        for (size_t j = 0; j < w; ++j) {
+int gemm_baseline(double* __restrict__ a, double* __restrict__ b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < k; ++j) {
             double acc = 0.0;
-            for (size_t k = 0; k < h; ++k) {
-                acc += a[i * w + k] * b[k * w + j];
+            for (size_t l = 0; l < n; ++l) {
+                acc += a[i * n + l] * b[l * k + j];
             }
-            result[i * w + j] = acc; // result_{i, j} = acc
+            result[i * k + j] = acc; // result_{i, j} = acc
         }
     }
     return 0;
@@ -84,6 +101,199 @@ int gemm_omp_opt_blocking(double* __restrict__ a, double* __restrict__ b, const
     return 0;
 }
 
+/*
+ * Vectors of the AVX-512 or AVX2 FMA units (compiled with -march=native), scalars otherwise.
+ * The micro kernel keeps GEMM_MR x GEMM_NR results in GEMM_MR * GEMM_NR_VECS registers: 24 of the 32 zmm with
+ * AVX-512 and 12 of the 16 ymm with AVX2, the rest hold the row of b and the broadcast element of a.
+ */
+#if defined(__AVX512F__)
+#define VEC_WIDTH 8
+#define GEMM_MR 8
+#define GEMM_NR_VECS 3
+typedef __m512d vec_t;
+#define vec_zero() _mm512_setzero_pd()
+#define vec_load(p) _mm512_loadu_pd(p)
+#define vec_store(p, v) _mm512_storeu_pd(p, v)
+#define vec_broadcast(x) _mm512_set1_pd(x)
+#define vec_fma(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define vec_add(a, b) _mm512_add_pd(a, b)
+#elif defined(__AVX2__) && defined(__FMA__)
+#define VEC_WIDTH 4
+#define GEMM_MR 6
+#define GEMM_NR_VECS 2
+typedef __m256d vec_t;
+#define vec_zero() _mm256_setzero_pd()
+#define vec_load(p) _mm256_loadu_pd(p)
+#define vec_store(p, v) _mm256_storeu_pd(p, v)
+#define vec_broadcast(x) _mm256_set1_pd(x)
+#define vec_fma(a, b, c) _mm256_fmadd_pd(a, b, c)
+#define vec_add(a, b) _mm256_add_pd(a, b)
+#else
+#define VEC_WIDTH 1
+#define GEMM_MR 4
+#define GEMM_NR_VECS 4
+typedef double vec_t;
+#define vec_zero() 0.0
+#define vec_load(p) (*(p))
+#define vec_store(p, v) (*(p) = (v))
+#define vec_broadcast(x) (x)
+#define vec_fma(a, b, c) ((a) * (b) + (c))
+#define vec_add(a, b) ((a) + (b))
+#endif
+
+#define GEMM_NR (GEMM_NR_VECS * VEC_WIDTH)
+
+/*
+ * Cache blocking (the loop order of BLIS): a panel of GEMM_KC rows and GEMM_NC columns of b stays in L3,
+ * a block of GEMM_MC rows of a in L2 and a sliver of GEMM_NR columns of the b panel in L1.
+ */
+#define GEMM_KC 256
+#define GEMM_MC (GEMM_MR * 16)
+#define GEMM_NC (GEMM_NR * 64)
+
+/*
+ * Packs rows [i, i + mc) and columns [p, p + kc) of a (lda columns) into slivers of GEMM_MR rows, every sliver
+ * column by column, so that the micro kernel reads them contiguously. Rows past mc are zero.
+ */
+static void pack_a(const double* a, size_t lda, size_t i, size_t p, size_t mc, size_t kc, double* packed) {
+#pragma omp for
+    for (size_t ir = 0; ir < mc; ir += GEMM_MR) {
+        double* sliver = packed + ir * kc;
+        for (size_t l = 0; l < kc; l++) {
+            for (size_t r = 0; r < GEMM_MR; r++) {
+                sliver[l * GEMM_MR + r] = ir + r < mc ? a[(i + ir + r) * lda + p + l] : 0.0;
+            }
+        }
+    }
+}
+
+/*
+ * Packs rows [p, p + kc) and columns [j, j + nc) of b (ldb columns) into slivers of GEMM_NR columns, every sliver
+ * row by row. Columns past nc are zero.
+ */
+static void pack_b(const double* b, size_t ldb, size_t p, size_t j, size_t kc, size_t nc, double* packed) {
+#pragma omp for
+    for (size_t jr = 0; jr < nc; jr += GEMM_NR) {
+        double* sliver = packed + jr * kc;
+        for (size_t l = 0; l < kc; l++) {
+            for (size_t c = 0; c < GEMM_NR; c++) {
+                sliver[l * GEMM_NR + c] = jr + c < nc ? b[(p + l) * ldb + j + jr + c] : 0.0;
+            }
+        }
+    }
+}
+
+/*
+ * result (GEMM_MR x GEMM_NR, ldc columns) = (accumulate ? result : 0) + the product of the packed slivers.
+ */
+static inline void gemm_micro(size_t kc, const double* __restrict__ a, const double* __restrict__ b,
+                              double* __restrict__ result, size_t ldc, int accumulate) {
+    vec_t acc[GEMM_MR][GEMM_NR_VECS];
+    for (size_t r = 0; r < GEMM_MR; r++) {
+        for (size_t v = 0; v < GEMM_NR_VECS; v++) {
+            acc[r][v] = vec_zero();
+        }
+    }
+    for (size_t l = 0; l < kc; l++) {
+        vec_t row[GEMM_NR_VECS];
+        for (size_t v = 0; v < GEMM_NR_VECS; v++) {
+            row[v] = vec_load(b + l * GEMM_NR + v * VEC_WIDTH);
+        }
+        for (size_t r = 0; r < GEMM_MR; r++) {
+            vec_t x = vec_broadcast(a[l * GEMM_MR + r]);
+            for (size_t v = 0; v < GEMM_NR_VECS; v++) {
+                acc[r][v] = vec_fma(x, row[v], acc[r][v]);
+            }
+        }
+    }
+    for (size_t r = 0; r < GEMM_MR; r++) {
+        for (size_t v = 0; v < GEMM_NR_VECS; v++) {
+            double* out = result + r * ldc + v * VEC_WIDTH;
+            vec_store(out, accumulate ? vec_add(vec_load(out), acc[r][v]) : acc[r][v]);
+        }
+    }
+}
+
+/*
+ * The blocked loops of gemm_avx and gemm_avx_omp. Inside a parallel region the threads share the packing and
+ * split the slivers of the b panel, every thread writes its own column slivers of the result.
+ */
+static void gemm_avx_blocked(const double* a, const double* b, size_t m, size_t n, size_t k, double* result,
+                             double* packed_a, double* packed_b) {
+    for (size_t j = 0; j < k; j += GEMM_NC) {
+        size_t nc = min(GEMM_NC, k - j);
+        for (size_t p = 0; p < n; p += GEMM_KC) {
+            size_t kc = min(GEMM_KC, n - p);
+            pack_b(b, k, p, j, kc, nc, packed_b);
+            for (size_t i = 0; i < m; i += GEMM_MC) {
+                size_t mc = min(GEMM_MC, m - i);
+                pack_a(a, n, i, p, mc, kc, packed_a);
+#pragma omp for
+                for (size_t jr = 0; jr < nc; jr += GEMM_NR) {
+                    size_t nr = min(GEMM_NR, nc - jr);
+                    for (size_t ir = 0; ir < mc; ir += GEMM_MR) {
+                        size_t mr = min(GEMM_MR, mc - ir);
+                        double* out = result + (i + ir) * k + j + jr;
+                        if (mr == GEMM_MR && nr == GEMM_NR) {
+                            gemm_micro(kc, packed_a + ir * kc, packed_b + jr * kc, out, k, p > 0);
+                            continue;
+                        }
+                        // Edge: through a full block, only the mr x nr results are written
+                        double edge[GEMM_MR * GEMM_NR];
+                        gemm_micro(kc, packed_a + ir * kc, packed_b + jr * kc, edge, GEMM_NR, 0);
+                        for (size_t r = 0; r < mr; r++) {
+                            for (size_t c = 0; c < nr; c++) {
+                                out[r * k + c] = (p > 0 ? out[r * k + c] : 0.0) + edge[r * GEMM_NR + c];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Packing buffer for rows (or columns) in slivers of sliver of kc elements, small problems need less than a block.
+ */
+static double* pack_alloc(size_t rows, size_t sliver, size_t kc) {
+    size_t bytes = (rows + sliver - 1) / sliver * sliver * kc * sizeof(double);
+    // aligned_alloc needs a multiple of the alignment
+    return aligned_alloc(64, (bytes + 63) / 64 * 64);
+}
+
+/*
+ * Register blocked, cache tiled gemm with packed panels, result (m, k) = a (m, n) * b (n, k) like gemm_baseline.
+ * gemm_avx_omp runs the packing and the slivers of the b panel on all OpenMP threads.
+ * Returns 1 if the packing buffers can not be allocated.
+ */
+__attribute__((noinline))
+int gemm_avx(double* __restrict__ a, double* __restrict__ b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    double* packed_a = pack_alloc(min(GEMM_MC, m), GEMM_MR, min(GEMM_KC, n));
+    double* packed_b = pack_alloc(min(GEMM_NC, k), GEMM_NR, min(GEMM_KC, n));
+    if (packed_a != NULL && packed_b != NULL) {
+        gemm_avx_blocked(a, b, m, n, k, result, packed_a, packed_b);
+    }
+    int failed = packed_a == NULL || packed_b == NULL;
+    free(packed_a);
+    free(packed_b);
+    return failed;
+}
+
+__attribute__((noinline))
+int gemm_avx_omp(double* __restrict__ a, double* __restrict__ b, const size_t m, const size_t n, const size_t k, double* __restrict__ result) {
+    double* packed_a = pack_alloc(min(GEMM_MC, m), GEMM_MR, min(GEMM_KC, n));
+    double* packed_b = pack_alloc(min(GEMM_NC, k), GEMM_NR, min(GEMM_KC, n));
+    if (packed_a != NULL && packed_b != NULL) {
+#pragma omp parallel
+        gemm_avx_blocked(a, b, m, n, k, result, packed_a, packed_b);
+    }
+    int failed = packed_a == NULL || packed_b == NULL;
+    free(packed_a);
+    free(packed_b);
+    return failed;
+}
+
 /*
  * x2 must be after x1. Returns the difference in microseconds.
  */
@@ -91,7 +301,7 @@ long diff_in_us(struct timespec x1, struct timespec x2) {
 
     if (x1.tv_sec == x2.tv_sec) { return (x2.tv_nsec - x1.tv_nsec) / 1000; };
 
-     return (x2.tv_sec - x1.tv_sec) * 1000000 + 1000000 - (x1.tv_nsec / 1000) + (x2.tv_nsec / 1000);
+     return (x2.tv_sec - x1.tv_sec) * 1000000 - (x1.tv_nsec / 1000) + (x2.tv_nsec / 1000);
 }
 
 void print_matrix(double* matrix, size_t w, size_t h) {
@@ -115,6 +325,34 @@ int verify(double* a, double* b, size_t w, size_t h) {
     return 0;
 }
 
+typedef int (*gemm_t)(double* __restrict__, double* __restrict__, const size_t, const size_t, const size_t, double* __restrict__);
+
+// Minimum time of the runs of one measurement of bench_gflops
+#define BENCH_MIN_US 20000
+
+/*
+ * Runs gemm on (m, n) x (n, k) until BENCH_MIN_US passed, prints the time of one run and the GFLOP/s
+ * (2 * m * n * k flops per run) and verifies the result against reference.
+ */
+void bench_gflops(const char* name, gemm_t gemm, double* a, double* b, size_t m, size_t n, size_t k, double* result,
+                  double* reference) {
+    struct timespec start, end;
+    size_t runs = 0;
+    long us_duration;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        gemm(a, b, m, n, k, result);
+        runs++;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        us_duration = diff_in_us(start, end);
+    } while (us_duration < BENCH_MIN_US);
+
+    double us_per_run = (double) us_duration / runs;
+    printf("%s, M: %zu, N: %zu, K: %zu: %.3f us, %.3f GFLOP/s\n", name, m, n, k, us_per_run,
+           2.0 * m * n * k / (us_per_run * 1e3));
+    verify(result, reference, k, m);
+}
+
 int main(int argc, char** argv) {
     printf("Starting measurement\n");
 
@@ -143,9 +381,11 @@ int main(int argc, char** argv) {
     // print_matrix(x, w, h);
     // print_matrix(y, w, h);
     // printf("\n");
-    gemm_baseline(x, y, w, h, result_ref);
+    gemm_baseline(x, y, h, w, w, result_ref);
     
     for (size_t i = 0; i < runs; i++) {
+        // gemm_omp_opt_blocking accumulates into result
+        memset(result, 0, h * w * sizeof(double));
         clock_gettime(CLOCK_MONOTONIC, &start);
 
         // The following was used for single core
@@ -167,5 +407,42 @@ int main(int argc, char** argv) {
 //    print_matrix(result, w, h);
 //    print_matrix(result_ref, w, h);
 
+    printf("Running on %d threads\n", omp_get_max_threads());
+    bench_gflops("gemm_avx", gemm_avx, x, y, h, w, w, result, result_ref);
+    bench_gflops("gemm_avx_omp", gemm_avx_omp, x, y, h, w, w, result, result_ref);
+    free(x);
+    free(y);
+    free(result);
+    free(result_ref);
+
+    /* The shapes of benchmark_gemm with its inputs */
+    for (size = LMQ_START_SIZE; size <= LMQ_SIZE; size *= 2) {
+        uint32_t sqrt = sqrt_approx(size);
+        size_t m = sqrt / 2;
+        size_t n = sqrt * 2;
+        size_t k = sqrt / 2;
+
+        x = (double *) malloc(m * n * sizeof(double));
+        y = (double *) malloc(n * k * sizeof(double));
+        result = (double *) malloc(m * k * sizeof(double));
+        result_ref = (double *) malloc(m * k * sizeof(double));
+        for (size_t i = 0; i < m * n; i++) {
+            x[i] = (double) i;
+        }
+        for (size_t i = 0; i < n * k; i++) {
+            y[i] = (double) i;
+        }
+        gemm_baseline(x, y, m, n, k, result_ref);
+
+        bench_gflops("gemm_baseline", gemm_baseline, x, y, m, n, k, result, result_ref);
+        bench_gflops("gemm_avx", gemm_avx, x, y, m, n, k, result, result_ref);
+        bench_gflops("gemm_avx_omp", gemm_avx_omp, x, y, m, n, k, result, result_ref);
+
+        free(x);
+        free(y);
+        free(result);
+        free(result_ref);
+    }
+
     return 0;
 }